@@ -63,10 +63,12 @@ enum: Flags
     ASM_MACRONOCASE = 16, /// disable case-insensitive naming (default)
     ASM_OLDMODPARAM = 32,   ///< use old modifier parametrization (values 0 and 1 only)
     ASM_WAVE32 = 64, ///< use WAVESIZE32
+    ASM_CHECKWAITS = 128, ///< check whether wait instructions are sufficient
+    ASM_SINKWAITS = 256,  ///< find wait places by wait scheduler in sink mode
     ASM_TESTRESOLVE = (1U<<30), ///< enable resolving symbols if ASM_TESTRUN enabled
     ASM_TESTRUN = (1U<<31), ///< only for running tests
     ASM_ALL = FLAGS_ALL&~(ASM_TESTRUN|ASM_TESTRESOLVE|ASM_BUGGYFPLIT|ASM_MACRONOCASE|
-                    ASM_WAVE32|ASM_OLDMODPARAM)  ///< all flags
+                    ASM_WAVE32|ASM_OLDMODPARAM|ASM_CHECKWAITS|ASM_SINKWAITS)  ///< all flags
 };
 
 enum: Flags
@@ -123,7 +125,7 @@ public:
     { return readPos.chunkPos < chunks.size() && (readPos.chunkPos+1 != chunks.size() ||
         readPos.itemPos < chunks.back().items.size());; }
     /// get next usage
-    AsmRegVarUsage nextUsage(ReadPos& readPos);
+    AsmRegVarUsage nextUsage(ReadPos& readPos) const;
     // find position by offset
     ReadPos findPositionByOffset(size_t offset) const;
     
@@ -432,6 +434,8 @@ public:
 private:
     Assembler& assembler;
     std::vector<CodeBlock> codeBlocks;
+    // entry blocks of independent code regions (ordered by first entry block)
+    std::vector<std::vector<size_t> > codeRegions;
     SSAReplacesMap ssaReplacesMap;
     size_t regTypesNum;
     
@@ -445,6 +449,7 @@ private:
     std::unordered_map<size_t, VIdxSetEntry> vidxRoutineMap;
     // key - call block, value - set of svvregs (lv indexes) used between this call point
     std::unordered_map<size_t, VIdxSetEntry> vidxCallMap;
+    cxuint threadsNum;
     
 public:
     AsmRegAllocator(Assembler& assembler);
@@ -464,8 +469,16 @@ public:
     
     void allocateRegisters(AsmSectionId sectionId);
     
+    /// set number of threads used by parallel parts (0 - all hardware threads)
+    void setThreadsNum(cxuint _threadsNum)
+    { threadsNum = _threadsNum; }
+    cxuint getThreadsNum() const
+    { return threadsNum; }
+    
     const std::vector<CodeBlock>& getCodeBlocks() const
     { return codeBlocks; }
+    const std::vector<std::vector<size_t> >& getCodeRegions() const
+    { return codeRegions; }
     const SSAReplacesMap& getSSAReplacesMap() const
     { return ssaReplacesMap; }
     const Array<OutLiveness>* getOutLivenesses() const
@@ -476,6 +489,10 @@ public:
     
     const VarIndexMap* getVregIndexMaps() const
     { return vregIndexMaps; }
+    const InterGraph* getInterGraphs() const
+    { return interGraphs; }
+    const Array<cxuint>* getGraphColorMaps() const
+    { return graphColorMaps; }
     
     const std::unordered_map<size_t, VIdxSetEntry>& getVIdxRoutineMap() const
     { return vidxRoutineMap; }
@@ -493,6 +510,8 @@ private:
     const AsmRegAllocator::VarIndexMap* vregIndexMaps;
     const Array<cxuint>* graphColorMaps;
     bool onlyWarnings;
+    bool sinkWaits;
+    size_t blockVisitsNum;
     std::vector<AsmWaitInstr> neededWaitInstrs;
 public:
     AsmWaitScheduler(const AsmWaitConfig& asmWaitConfig, Assembler& assembler,
@@ -500,10 +519,99 @@ public:
             const AsmRegAllocator::VarIndexMap* vregIndexMaps,
             const Array<cxuint>* graphColorMaps, bool onlyWarnings);
     
+    /// set sink mode: ignore existing wait instructions and place waits
+    /// just before first instructions that use results of delayed operations
+    void setSinkWaits(bool _sinkWaits)
+    { sinkWaits = _sinkWaits; }
+    /// return true if sink mode enabled
+    bool isSinkWaits() const
+    { return sinkWaits; }
+    
     void schedule(ISAUsageHandler& usageHandler, ISAWaitHandler& waitHandler);
     
+    /// get needed wait instructions (sorted by offset, one per place)
     const std::vector<AsmWaitInstr>& getNeededWaitInstrs() const
     { return neededWaitInstrs; }
+    /// get number of code block visits done while finding fixed point
+    size_t getBlockVisitsNum() const
+    { return blockVisitsNum; }
+};
+
+/// place of wait instruction in code (found by wait scheduler in sink mode)
+struct AsmWaitPlace
+{
+    AsmSectionId sectionId; ///< section id
+    size_t instrIndex;  ///< index of instruction in section (in order of assembling)
+    bool remove;    ///< if true, then remove user wait instruction
+    AsmWaitInstr waitInstr; ///< wait instruction to insert before instruction
+};
+
+/// estimated timing of code block
+struct AsmCodeBlockTiming
+{
+    size_t start;   ///< start of code block
+    size_t end;     ///< end of code block
+    size_t instrsNum;   ///< number of instructions
+    uint64_t issueCycles;   ///< cycles needed to issue instructions
+    uint64_t stallCycles;   ///< cycles spent in waits for delayed operations
+    uint64_t pathCycles;    ///< cycles of longest path from code start to block end
+    size_t pathPrev;    ///< previous block in longest path (SIZE_MAX if none)
+};
+
+/// stall point (wait instruction that waits for outstanding operations)
+struct AsmStallPoint
+{
+    size_t offset;  ///< offset of wait instruction
+    uint32_t cycles;    ///< estimated stall cycles
+    cxuint queue;   ///< queue (counter) that causes stall (0 - vmcnt, 1 - lgkmcnt...)
+};
+
+/// static cycle estimator for GCN code
+/** estimator uses simple per-instruction issue cycles (from GCN timings)
+ * and latency classes for delayed operations. Loops are counted once and
+ * backward jumps are ignored while finding critical path */
+class AsmCycleEstimator
+{
+private:
+    GPUDeviceType deviceType;
+    std::vector<AsmCodeBlockTiming> blockTimings;
+    std::vector<AsmStallPoint> stallPoints;
+    std::vector<size_t> criticalPath;
+    uint64_t criticalPathCycles;
+
+    void estimateBlocks(const std::vector<AsmRegAllocator::CodeBlock>& codeBlocks,
+            size_t codeSize, const cxbyte* code);
+public:
+    /// constructor
+    explicit AsmCycleEstimator(GPUDeviceType deviceType);
+
+    /// estimate cycles for code with code flow (from assembler)
+    void estimate(Assembler& assembler, const std::vector<AsmCodeFlowEntry>& codeFlow,
+            size_t codeSize, const cxbyte* code);
+    /// estimate cycles for binary code (code flow will be found from jumps)
+    void estimate(size_t codeSize, const cxbyte* code);
+
+    /// get timings of code blocks
+    const std::vector<AsmCodeBlockTiming>& getBlockTimings() const
+    { return blockTimings; }
+    /// get stall points (sorted by offset)
+    const std::vector<AsmStallPoint>& getStallPoints() const
+    { return stallPoints; }
+    /// get critical path (code block indices)
+    const std::vector<size_t>& getCriticalPath() const
+    { return criticalPath; }
+    /// get estimated cycles of critical path
+    uint64_t getCriticalPathCycles() const
+    { return criticalPathCycles; }
+
+    /// print report
+    /**
+     * \param os output stream
+     * \param linePrefix prefix added to every line
+     * \param startOffset offset added to printed code positions
+     */
+    void printReport(std::ostream& os, const char* linePrefix = "",
+            size_t startOffset = 0) const;
 };
 
 /// type of clause
@@ -607,6 +715,11 @@ private:
     bool endOfAssembly;
     bool sectionDiffsPrepared;
     bool collectSourcePoses; /// collect offset->source positions data
+    bool collectInstrOffsets; /// collect offsets of instructions (for sink waits)
+    
+    std::vector<AsmWaitPlace> waitPlaces;
+    std::vector<size_t> sectionInstrsNums; // instructions number in sections
+    std::vector<std::vector<size_t> > sectionInstrOffsets;
     
     cxuint filenameIndex;
     std::stack<AsmInputFilter*> asmInputFilters;
@@ -650,6 +763,14 @@ private:
     void printError(LineCol lineCol, const char* message)
     { printError(getSourcePos(lineCol), message); }
     
+    // check wait instructions in code sections by wait scheduler
+    void checkWaitInstrs();
+    // find wait places in code sections by wait scheduler in sink mode
+    void sinkWaitInstrs();
+    // count instruction, insert wait instruction before instruction if needed.
+    // return false if instruction (user wait instruction) must be removed
+    bool placeWaitInstr();
+    
     LineCol translatePos(const char* linePtr) const
     { return currentInputFilter->translatePos(linePtr-line); }
     LineCol translatePos(size_t pos) const
@@ -897,6 +1018,12 @@ public:
     /// set policy version
     void setPolicyVersion(cxuint pv)
     { policyVersion = pv; }
+    /// get wait places found by wait scheduler (if ASM_SINKWAITS enabled)
+    const std::vector<AsmWaitPlace>& getWaitPlaces() const
+    { return waitPlaces; }
+    /// set wait places to apply while assembling (sorted by section and instruction)
+    void setWaitPlaces(const std::vector<AsmWaitPlace>& places)
+    { waitPlaces = places; }
     /// get flags
     Flags getFlags() const
     { return flags; }
@@ -966,6 +1093,8 @@ public:
     /// get ISA assembler
     const ISAAssembler* getISAAssembler() const
     { return isaAssembler; }
+    /// create ISA assembler for device type (if not created) and return it
+    ISAAssembler* createISAAssembler();
 };
 
 inline void ISAAssembler::printWarning(const char* linePtr, const char* message)
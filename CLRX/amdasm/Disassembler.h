@@ -24,15 +24,21 @@
 #define __CLRX_DISASSEMBLER_H__
 
 #include <CLRX/Config.h>
+#include <algorithm>
+#include <cstring>
 #include <string>
 #include <istream>
+#include <iterator>
 #include <ostream>
 #include <vector>
 #include <utility>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
 #include <CLRX/amdbin/AmdBinaries.h>
 #include <CLRX/amdbin/AmdCL2Binaries.h>
 #include <CLRX/amdbin/ROCmBinaries.h>
+#include <CLRX/amdbin/Amd3Binaries.h>
 #include <CLRX/amdbin/GalliumBinaries.h>
 #include <CLRX/amdbin/AmdBinGen.h>
 #include <CLRX/amdasm/Commons.h>
@@ -72,24 +78,177 @@ enum: Flags
     DISASM_HSACONFIG = 0x400,  ///< print HSA configuration
     DISASM_HSALAYOUT = 0x800,  ///< print in HSA layout (like Gallium or ROCm)
     DISASM_WAVE32 = 0x1000, ///< use WAVESIZE32
+    DISASM_ESTIMATE = 0x2000, ///< print estimated cycles after code
     
     ///< all disassembler flags (without config)
     DISASM_ALL = FLAGS_ALL&(~(DISASM_CONFIG|DISASM_BUGGYFPLIT|DISASM_WAVE32|
-                    DISASM_HSACONFIG|DISASM_HSALAYOUT))
+                    DISASM_HSACONFIG|DISASM_HSALAYOUT|DISASM_ESTIMATE))
 };
 
 struct GCNDisasmUtils;
 
+/// set of numbered labels
+/** labels at positions aligned to 4-byte code words are held in bitmap,
+ * other labels (unaligned or very far from code) are held in sorted list.
+ * Iteration goes through labels in ascending order */
+class DisasmLabelSet
+{
+private:
+    std::vector<uint64_t> bitmap;
+    std::vector<size_t> extraLabels;
+    
+    size_t findNextInBitmap(size_t wordPos) const;
+public:
+    /// label iterator (returns positions in ascending order)
+    class ConstIterator
+    {
+    private:
+        friend class DisasmLabelSet;
+        const DisasmLabelSet* set;
+        size_t wordPos; // position (in 4-byte words) of next label in bitmap
+        size_t extraIndex;
+        
+        ConstIterator(const DisasmLabelSet* _set, size_t _wordPos, size_t _extraIndex)
+            : set(_set), wordPos(_wordPos), extraIndex(_extraIndex)
+        { }
+    public:
+        typedef std::forward_iterator_tag iterator_category;    ///< iterator category
+        typedef size_t value_type;  ///< value type
+        typedef ptrdiff_t difference_type;  ///< difference type
+        typedef const size_t* pointer;  ///< pointer type
+        typedef size_t reference;   ///< reference type
+        
+        /// empty constructor
+        ConstIterator() : set(nullptr), wordPos(SIZE_MAX), extraIndex(0)
+        { }
+        
+        /// get label position
+        size_t operator*() const
+        {
+            const size_t bitmapPos = (wordPos != SIZE_MAX) ? wordPos<<2 : SIZE_MAX;
+            return (extraIndex < set->extraLabels.size()) ?
+                    std::min(bitmapPos, set->extraLabels[extraIndex]) : bitmapPos;
+        }
+        /// go to next label
+        ConstIterator& operator++();
+        /// go to next label
+        ConstIterator operator++(int)
+        {
+            ConstIterator old = *this;
+            ++(*this);
+            return old;
+        }
+        /// equal to
+        bool operator==(const ConstIterator& it) const
+        { return wordPos == it.wordPos && extraIndex == it.extraIndex; }
+        /// not equal to
+        bool operator!=(const ConstIterator& it) const
+        { return wordPos != it.wordPos || extraIndex != it.extraIndex; }
+    };
+    
+    /// clear set
+    void clear()
+    {
+        bitmap.clear();
+        extraLabels.clear();
+    }
+    /// add label
+    void insert(size_t pos)
+    {
+        /* bitmap can grow twice of current size, further labels to extra list */
+        const size_t wordPos = pos>>2;
+        if ((pos&3) == 0 && wordPos < std::max(bitmap.size()<<7, size_t(1)<<20))
+        {
+            if ((wordPos>>6) >= bitmap.size())
+                bitmap.resize((wordPos>>6)+1);
+            bitmap[wordPos>>6] |= 1ULL<<(wordPos&63);
+        }
+        else
+            extraLabels.push_back(pos);
+    }
+    /// prepare set to iteration (must be called after inserting labels)
+    void prepare();
+    /// returns true if set has label at position
+    bool contains(size_t pos) const;
+    /// get first label
+    ConstIterator begin() const
+    { return ConstIterator(this, findNextInBitmap(0), 0); }
+    /// get end of labels
+    ConstIterator end() const
+    { return ConstIterator(this, SIZE_MAX, extraLabels.size()); }
+    /// get first label not less than position
+    ConstIterator lowerBound(size_t pos) const;
+    /// returns true if set is empty
+    bool empty() const
+    { return begin() == end(); }
+};
+
+/// text of disassembled code (stored in code cache)
+struct DisasmCachedText
+{
+    std::string text;   ///< text
+    /// places of section numbers of numbered labels in text (offset and length)
+    std::vector<std::pair<size_t, size_t> > sectionFixups;
+};
+
+/// cache of disassembled code
+/** cache holds text of disassembled code keyed by all inputs that affects this text
+ * (device type, flags, code, labels and relocations), hence identical code from
+ * other kernels or binaries is not decoded again. Key does not depend on section
+ * number, because section numbers in numbered labels are replaced while writing text.
+ * Cache can be shared between many disassemblers (also in many threads) */
+class DisasmCodeCache: public NonCopyableAndNonMovable
+{
+private:
+    std::unordered_map<std::string, DisasmCachedText> entries;
+    size_t maxSize;
+    size_t size;
+    size_t hitsNum;
+    size_t missesNum;
+    mutable std::mutex mutex;
+public:
+    /// constructor
+    /**
+     * \param maxSize max size of keys and texts in bytes (further texts are not cached)
+     */
+    explicit DisasmCodeCache(size_t maxSize = size_t(256)<<20);
+    
+    /// find text for key, returns true if found
+    bool find(const std::string& key, DisasmCachedText& text);
+    /// insert text for key (if cache is not full)
+    void insert(std::string&& key, DisasmCachedText&& text);
+    /// clear cache
+    void clear();
+    
+    /// get size of keys and texts in bytes
+    size_t getSize() const;
+    /// get number of cache hits
+    size_t getHitsNum() const;
+    /// get number of cache misses
+    size_t getMissesNum() const;
+};
+
+/// piece of code disassembled by separate disassembler (in other thread)
+struct DisasmCodePiece
+{
+    size_t inputSize;   ///< size of code
+    const cxbyte* input;    ///< code
+    size_t startOffset; ///< start offset
+    size_t labelStartOffset;    ///< start offset of labels
+    bool dontPrintLabelsAfterCode;  ///< don't print labels after code
+    Flags flags;    ///< disassembler flags
+};
+
 /// main class for
 class ISADisassembler: public NonCopyableAndNonMovable
 {
 private:
     friend struct GCNDisasmUtils; // INTERNAL LOGIC
 public:
-    typedef std::vector<size_t>::const_iterator LabelIter;  ///< label iterator
+    typedef DisasmLabelSet::ConstIterator LabelIter;  ///< label iterator
     
-    /// named label iterator
-    typedef std::vector<std::pair<size_t, CString> >::const_iterator NamedLabelIter;
+    /// named label iterator (position and offset of name in name pool)
+    typedef std::vector<std::pair<size_t, size_t> >::const_iterator NamedLabelIter;
 protected:
     /// internal relocation structure
     struct Relocation
@@ -108,11 +267,15 @@ protected:
     size_t inputSize;   ///< size of input
     const cxbyte* input;    ///< input code
     bool dontPrintLabelsAfterCode;
-    std::vector<size_t> labels; ///< list of local labels
-    std::vector<std::pair<size_t, CString> > namedLabels;   ///< named labels
+    DisasmLabelSet labels; ///< local labels
+    /// named labels (position and offset of name in name pool)
+    std::vector<std::pair<size_t, size_t> > namedLabels;
+    std::vector<char> namedLabelNames;  ///< name pool of named labels
     std::vector<CString> relSymbols;    ///< symbols used by relocations
     std::vector<std::pair<size_t, Relocation> > relocations;    ///< relocations
     FastOutputBuffer output;    ///< output buffer
+    struct TextCapture;
+    std::unique_ptr<TextCapture> textCapture;   ///< current capture of output text
     
     /// constructor
     explicit ISADisassembler(Disassembler& disassembler, cxuint outBufSize = 600);
@@ -121,6 +284,8 @@ protected:
     void writeLocation(size_t pos);
     /// write relocation to current place in instruction
     bool writeRelocation(size_t pos, RelocIter& relocIter);
+    /// write section number of numbered label (and remember its place in capture)
+    size_t writeLabelSectionCount(char* buf, size_t bufPos);
     
 public:
     virtual ~ISADisassembler();
@@ -155,13 +320,30 @@ public:
     void beforeDisassemble();
     /// disassembles input code
     virtual void disassemble() = 0;
+    
+    /// get size of instruction (or single disassembled item) at code
+    /**
+     * \param codeSize size of code from instruction start to end of code
+     * \param code code
+     * \return size in bytes (not greater than codeSize)
+     */
+    virtual size_t getInstructionSize(size_t codeSize, const cxbyte* code) const = 0;
 
+    /// add numbered label to list (must be called before disassembly)
+    void addLabel(size_t pos)
+    { labels.insert(pos); }
+    /// add named label to list (must be called before disassembly)
+    void addNamedLabel(size_t pos, const char* name)
+    { addNamedLabel(pos, name, ::strlen(name)); }
     /// add named label to list (must be called before disassembly)
     void addNamedLabel(size_t pos, const CString& name)
-    { namedLabels.push_back(std::make_pair(pos, name)); }
+    { addNamedLabel(pos, name.c_str(), name.size()); }
     /// add named label to list (must be called before disassembly)
-    void addNamedLabel(size_t pos, CString&& name)
-    { namedLabels.push_back(std::make_pair(pos, name)); }
+    void addNamedLabel(size_t pos, const char* name, size_t nameSize)
+    {
+        namedLabels.push_back(std::make_pair(pos, namedLabelNames.size()));
+        namedLabelNames.insert(namedLabelNames.end(), name, name+nameSize+1);
+    }
     
     /// add symbol to relocations
     size_t addRelSymbol(const CString& symName)
@@ -180,11 +362,19 @@ public:
         relocations.clear();
     }
     /// get numbered labels
-    const std::vector<size_t>& getLabels() const
+    const DisasmLabelSet& getLabels() const
     { return labels; }
-    /// get named labels
-    const std::vector<std::pair<size_t, CString> >& getNamedLabels() const
+    /// get named labels (position and offset of name in name pool)
+    const std::vector<std::pair<size_t, size_t> >& getNamedLabels() const
     { return namedLabels; }
+    /// get name of named label
+    const char* getNamedLabelName(const std::pair<size_t, size_t>& namedLabel) const
+    { return namedLabelNames.data() + namedLabel.second; }
+    /// get first numbered label not less than position
+    LabelIter findLabel(size_t pos) const
+    { return labels.lowerBound(pos); }
+    /// get first named label not less than position
+    NamedLabelIter findNamedLabel(size_t pos) const;
     /// flush output
     void flushOutput()
     { return output.flush(); }
@@ -193,6 +383,33 @@ public:
     Flags getFlags() const;
     /// set disassemblers flags
     void setFlags(Flags flags);
+    
+    /// copy labels, relocations and results of analysis from other disassembler
+    virtual void copyAnalysisState(const ISADisassembler& src);
+    /// disassemble code pieces by many threads (with labels and relocations of this)
+    /**
+     * \param pieces code pieces
+     * \param threadsNum threads number (0 - all hardware threads)
+     * \param texts output texts in order of pieces
+     */
+    void disassemblePieces(const std::vector<DisasmCodePiece>& pieces,
+                cxuint threadsNum, std::vector<DisasmCachedText>& texts) const;
+    
+    /// append to key for code cache: state, code, labels and relocations
+    /** key is relative to start offset of code and does not include section number */
+    virtual void makeCodeCacheKey(std::string& key) const;
+    /// start capturing output text (with places of section numbers of labels)
+    void beginTextCapture();
+    /// finish capturing output text, captured text is not written to output
+    void endTextCapture(DisasmCachedText& text);
+    /// returns true if output text is captured
+    bool isTextCaptured() const
+    { return textCapture != nullptr; }
+    /// write text (replaces section numbers of labels by current section number)
+    void writeCachedText(const DisasmCachedText& text);
+    /// get disassembler
+    const Disassembler& getDisassembler() const
+    { return disassembler; }
 };
 
 /// GCN architectur dissassembler
@@ -202,6 +419,9 @@ private:
     bool instrOutOfCode;
     
     friend struct GCNDisasmUtils; // INTERNAL LOGIC
+    
+    /// disassemble code to output buffer
+    void disassembleCode();
 public:
     /// constructor
     GCNDisassembler(Disassembler& disassembler);
@@ -210,8 +430,16 @@ public:
     
     /// analyze code before disassemblying
     void analyzeBeforeDisassemble();
-    /// disassemble code
+    /// get targets of jumps in input code (unsorted, with duplicates)
+    void getJumpTargets(std::vector<size_t>& targets) const;
+    /// disassemble code (uses code cache if set in disassembler)
     void disassemble();
+    /// get size of instruction (run of zero words is single item)
+    size_t getInstructionSize(size_t codeSize, const cxbyte* code) const;
+    /// copy labels, relocations and results of analysis from other disassembler
+    void copyAnalysisState(const ISADisassembler& src);
+    /// append to key for code cache
+    void makeCodeCacheKey(std::string& key) const;
 };
 
 /// single kernel input for disassembler
@@ -273,6 +501,18 @@ struct AmdCL2DisasmKernelInput
     const cxbyte* code; ///< code of kernel
 };
 
+/// loader of kernel datas for AMD OpenCL 2.0 disassembler input
+/** loader fills code, setup, stub and text relocations of the kernel input
+ * at first use of this kernel */
+class AmdCL2DisasmKernelLoader
+{
+public:
+    /// destructor
+    virtual ~AmdCL2DisasmKernelLoader();
+    /// load datas of kernel input (only once for every kernel)
+    virtual void loadKernel(size_t index) const = 0;
+};
+
 /// whole disassembler input (for AMD Catalyst driver GPU binaries)
 /** all pointer members holds only pointers that should be freed by your routines.
  * No management of data */
@@ -300,6 +540,11 @@ struct AmdCL2DisasmInput
     /// sampler relocations
     std::vector<std::pair<size_t, size_t> > samplerRelocs;
     std::vector<AmdCL2DisasmKernelInput> kernels;    ///< kernel inputs
+    /// loader of kernel datas (if null then all kernel inputs are filled)
+    std::unique_ptr<AmdCL2DisasmKernelLoader> kernelLoader;
+    
+    /// get kernel input (loads kernel datas at first use)
+    const AmdCL2DisasmKernelInput& getKernel(size_t index) const;
 };
 
 /// disasm ROCm region
@@ -372,6 +617,144 @@ struct RawCodeInput
     const cxbyte* code;         ///< code
 };
 
+/// relocation in disassembly index
+struct DisasmIndexReloc
+{
+    size_t offset;  ///< offset in code section
+    RelocType type; ///< relocation type
+    size_t symbol;  ///< symbol index
+    int64_t addend; ///< addend
+};
+
+/// code section in disassembly index
+/** code section is piece of code with own labels (kernel code or whole code) */
+struct DisasmIndexSection
+{
+    CString name;   ///< kernel name (only for per-kernel code sections)
+    size_t size;    ///< size of code section
+    std::vector<size_t> labels; ///< numbered labels (sorted)
+    std::vector<std::pair<size_t, CString> > namedLabels;   ///< named labels (sorted)
+    std::vector<CString> relSymbols;    ///< symbols used by relocations
+    std::vector<DisasmIndexReloc> relocations;  ///< relocations (sorted by offset)
+};
+
+/// code region (disassembled part of code section) in disassembly index
+struct DisasmIndexRegion
+{
+    CString name;   ///< kernel name (empty if code is not in kernel)
+    size_t section; ///< code section index
+    size_t offset;  ///< offset of region in code section
+    size_t size;    ///< size of region
+    bool wave32;    ///< code in wave32 mode
+    std::vector<uint32_t> instrStarts;  ///< bitmap of instruction starts (bit per dword)
+    std::vector<uint32_t> instrRanks;   ///< instructions number before every 256 dwords
+};
+
+/// instruction group in code statistics
+enum class DisasmInstrGroup: cxbyte
+{
+    SALU = 0,   ///< scalar ALU (SOP1, SOP2, SOPC, SOPK)
+    VALU,       ///< vector ALU (VOP1, VOP2, VOPC, VOP3, VOP3P, VINTRP)
+    SMEM,       ///< scalar memory (SMRD, SMEM)
+    VMEM,       ///< vector memory (MUBUF, MTBUF, MIMG, FLAT)
+    LDS,        ///< local data share (DS)
+    EXPORT,     ///< export (EXP)
+    CONTROL,    ///< program control (SOPP: branches, waits, barriers)
+    MAX_VALUE = CONTROL  ///< last value
+};
+
+enum: cxuint
+{
+    DISASM_STATS_ENCODINGS_NUM = 20 ///< number of encodings in code statistics
+};
+
+/// statistics of code (collected without disassemblying to text)
+struct DisasmCodeStats
+{
+    CString name;   ///< kernel name (empty if code is not in kernel)
+    size_t codeSize;    ///< code size in bytes
+    size_t instrsNum;   ///< instructions number (without zero fills)
+    size_t illegalsNum; ///< illegal instructions number
+    size_t literalsNum; ///< number of instructions with literal constant
+    size_t waitcntsNum; ///< s_waitcnt instructions number
+    /// instructions number of groups
+    size_t groupCounts[size_t(DisasmInstrGroup::MAX_VALUE)+1];
+    /// instructions number of encodings (first is for illegal instructions)
+    size_t encodingCounts[DISASM_STATS_ENCODINGS_NUM];
+    cxint maxSGPR;  ///< highest used SGPR index (-1 if no SGPR used)
+    cxint maxVGPR;  ///< highest used VGPR index (-1 if no VGPR used)
+    
+    /// constructor
+    DisasmCodeStats();
+    /// clear statistics
+    void clear();
+};
+
+/// get name of encoding in code statistics
+extern const char* getDisasmStatsEncodingName(cxuint encoding);
+/// get name of instruction group in code statistics
+extern const char* getDisasmInstrGroupName(DisasmInstrGroup group);
+
+/// collect statistics of GCN code and add them to stats
+/** highest used register indices are determined from register fields
+ * of instruction encodings */
+extern void getGCNCodeStats(GPUDeviceType deviceType, size_t codeSize,
+            const cxbyte* code, DisasmCodeStats& stats);
+
+/// disassembly index
+/** index holds instruction boundaries, labels, relocations and kernel regions
+ * and allows to disassemble any piece of code without disassemblying whole code.
+ * Offsets given to region routines are relative to region start */
+class DisasmIndex
+{
+private:
+    friend class Disassembler;
+    GPUDeviceType deviceType;
+    std::vector<DisasmIndexSection> sections;
+    std::vector<DisasmIndexRegion> regions;
+public:
+    /// constructor
+    DisasmIndex();
+    
+    /// clear index
+    void clear();
+    
+    /// get GPU device type
+    GPUDeviceType getDeviceType() const
+    { return deviceType; }
+    /// get code sections number
+    size_t getSectionsNum() const
+    { return sections.size(); }
+    /// get code section
+    const DisasmIndexSection& getSection(size_t index) const
+    { return sections[index]; }
+    /// get regions number
+    size_t getRegionsNum() const
+    { return regions.size(); }
+    /// get region
+    const DisasmIndexRegion& getRegion(size_t index) const
+    { return regions[index]; }
+    
+    /// find region by kernel name (return SIZE_MAX if not found)
+    size_t findRegion(const char* name) const;
+    /// find region that contains offset in code section (return SIZE_MAX if not found)
+    size_t findRegion(size_t section, size_t offset) const;
+    
+    /// get number of instructions in region
+    size_t getInstrsNum(size_t region) const;
+    /// return true if instruction starts at offset
+    bool isInstrStart(size_t region, size_t offset) const;
+    /// get number of instructions that starts before offset
+    size_t getInstrIndex(size_t region, size_t offset) const;
+    /// get offset of instruction with specified index
+    size_t getInstrOffset(size_t region, size_t index) const;
+    
+    /// write index in binary form
+    void write(std::ostream& os) const;
+    /// read index in binary form
+    void read(std::istream& is);
+};
+
 /// disassembler class
 class Disassembler: public NonCopyableAndNonMovable
 {
@@ -390,6 +773,8 @@ private:
     std::ostream& output;
     Flags flags;
     size_t sectionCount;
+    DisasmCodeCache* codeCache;
+    cxuint threadsNum;
 public:
     /// constructor for 32-bit GPU binary
     /**
@@ -440,6 +825,21 @@ public:
      */
     Disassembler(const ROCmBinary& binary, std::ostream& output, bool hasGPUDeviceType,
                  GPUDeviceType deviceType, Flags flags = 0);
+    /// constructor for AMD3 GPU binary (disassembled as ROCm LLVM10 binary)
+    /**
+     * \param binary main GPU binary
+     * \param output output stream
+     * \param flags flags for disassembler
+     */
+    Disassembler(const Amd3Binary& binary, std::ostream& output, Flags flags = 0);
+    /// constructor for AMD3 GPU binary 2
+    /**
+     * \param binary main GPU binary
+     * \param output output stream
+     * \param flags flags for disassembler
+     */
+    Disassembler(const Amd3Binary& binary, std::ostream& output, bool hasGPUDeviceType,
+                 GPUDeviceType deviceType, Flags flags = 0);
     /// constructor for AMD disassembler input
     /**
      * \param disasmInput disassembler input object
@@ -494,6 +894,33 @@ public:
     /// disassembles input
     void disassemble();
     
+    /// build disassembly index for code of input
+    void buildIndex(DisasmIndex& index);
+    /// disassemble piece of code of region around instruction at offset
+    /**
+     * \param index disassembly index built for this input
+     * \param region region index
+     * \param offset offset in region
+     * \param instrsBefore number of instructions before instruction at offset
+     * \param instrsAfter number of instructions after instruction at offset
+     */
+    void disassembleWindow(const DisasmIndex& index, size_t region, size_t offset,
+                size_t instrsBefore, size_t instrsAfter);
+    /// disassemble instructions of region between offsets
+    /**
+     * \param index disassembly index built for this input
+     * \param region region index
+     * \param startOffset offset of first instruction in region
+     * \param endOffset offset after last instruction in region
+     */
+    void disassembleRange(const DisasmIndex& index, size_t region, size_t startOffset,
+                size_t endOffset);
+    /// get code of section of disassembly index
+    const cxbyte* getIndexSectionCode(const DisasmIndex& index, size_t section) const;
+    
+    /// collect statistics of code (for every kernel or whole code)
+    void getCodeStats(std::vector<DisasmCodeStats>& stats);
+    
     /// get disassemblers flags
     Flags getFlags() const
     { return flags; }
@@ -501,6 +928,21 @@ public:
     void setFlags(Flags flags)
     { this->flags = flags; }
     
+    /// get code cache (nullptr if not used)
+    DisasmCodeCache* getCodeCache() const
+    { return codeCache; }
+    /// set code cache (nullptr - disable caching), cache is not owned by disassembler
+    void setCodeCache(DisasmCodeCache* codeCache)
+    { this->codeCache = codeCache; }
+    
+    /// get number of threads used to disassemble kernels (HSA code)
+    cxuint getThreadsNum() const
+    { return threadsNum; }
+    /// set number of threads used to disassemble kernels (0 - all hardware threads)
+    /** output does not depend on number of threads */
+    void setThreadsNum(cxuint threadsNum)
+    { this->threadsNum = threadsNum; }
+    
     /// get deviceType
     GPUDeviceType getDeviceType() const;
     
@@ -520,6 +962,14 @@ public:
     const ROCmDisasmInput* getROCmInput() const
     { return rocmInput; }
     
+    /// get raw code input
+    const RawCodeInput* getRawInput() const
+    { return rawInput; }
+    
+    /// get binary format of input
+    BinaryFormat getBinaryFormat() const
+    { return binaryFormat; }
+    
     /// get output stream
     const std::ostream& getOutput() const
     { return output; }
@@ -554,10 +1004,25 @@ extern AmdCL2DisasmInput* getAmdCL2DisasmInputFromBinary64(
 /// prepare ROCM input from ROCM binary
 extern ROCmDisasmInput* getROCmDisasmInputFromBinary(
             const ROCmBinary& binary);
+/// prepare ROCM input (LLVM10 format with metadata V3) from AMD3 binary
+extern ROCmDisasmInput* getAmd3DisasmInputFromBinary(
+            const Amd3Binary& binary);
 /// prepare Gallium input from Gallium binary
 extern GalliumDisasmInput* getGalliumDisasmInputFromBinary(
             GPUDeviceType deviceType, const GalliumBinary& binary, cxuint llvmVersion);
 
+/// write instruction-level differences between codes of two disassemblers
+/** kernels are aligned by name and instructions by the longest common subsequence.
+ * jump targets are compared as relative instruction counts.
+ * Also writes differences between kernel configurations.
+ * \param disasmA first disassembler
+ * \param disasmB second disassembler
+ * \param output output stream
+ * \return number of differences
+ */
+extern size_t diffDisassemblers(const Disassembler& disasmA,
+            const Disassembler& disasmB, std::ostream& output);
+
 };
 
 #endif
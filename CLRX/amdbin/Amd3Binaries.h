@@ -46,7 +46,7 @@ enum : Flags {
     AMD3BIN_CREATE_REGIONMAP = 0x10,    ///< create region map
     AMD3BIN_CREATE_METADATAINFO = 0x20,     ///< create metadata info object
     AMD3BIN_CREATE_KERNELINFOMAP = 0x40,    ///< create kernel metadata info map
-    AMD3BIN_CREATE_KERNELDESCMAP = 0x40,    ///< create kernel metadata info map
+    AMD3BIN_CREATE_KERNELDESCMAP = 0x80,    ///< create kernel descriptor map
     AMD3BIN_CREATE_ALL = ELF_CREATE_ALL | 0xfff0 ///< all ROCm binaries flags
 };
 
@@ -64,6 +64,7 @@ struct Amd3Region
     size_t size;    ///< data size
     size_t offset;     ///< data
     Amd3RegionType type; ///< type
+    size_t kernelDesc;  ///< kernel descriptor index (SIZE_MAX if not found)
 };
 
 typedef ROCmValueKind Amd3ValueKind;
@@ -111,6 +112,7 @@ private:
     size_t regionsNum;
     std::unique_ptr<Amd3Region[]> regions;  ///< AMD metadatas
     RegionMap regionsMap;
+    NameHashIndex regionsIndex;
     size_t codeSize;
     cxbyte* code;
     size_t globalDataSize;
@@ -122,12 +124,15 @@ private:
     std::unique_ptr<Amd3Metadata> metadataInfo;
     Array<size_t> kernelDescOffsets;
     KernelDescMap kernelDescMap;
+    NameHashIndex kernelDescIndex;
     RegionMap kernelInfosMap;
+    NameHashIndex kernelInfosIndex;
     Array<size_t> gotSymbols;
 public:
     /// constructor
     Amd3Binary(size_t binaryCodeSize, cxbyte* binaryCode,
-            Flags creationFlags = AMD3BIN_CREATE_ALL);
+            Flags creationFlags = AMD3BIN_CREATE_ALL,
+            uint64_t expectedChecksum = 0);
     /// default destructor
     ~Amd3Binary() = default;
     
@@ -199,13 +204,17 @@ public:
     size_t getKernelDescsNum() const
     { return kernelDescOffsets.size(); }
     
-    /// get kernel descriptor
+    /// get kernel descriptor (points to binary, not copied)
     const Amd3KernelDescriptor& getKernelDesc(size_t index) const
     { return *reinterpret_cast<const Amd3KernelDescriptor*>(
                     kernelDescData + kernelDescOffsets[index]); }
     
-    /// get kernel metadata info by name
-    const Amd3KernelMetadata& getKernelDesc(const char* name) const;
+    /// get offset of kernel descriptor in binary
+    size_t getKernelDescOffset(size_t index) const
+    { return kernelDescOffsets[index]; }
+    
+    /// get kernel descriptor by kernel name
+    const Amd3KernelDescriptor& getKernelDesc(const char* name) const;
     
     /// get target
     const CString& getTarget() const
@@ -234,6 +243,9 @@ public:
     { return (creationFlags & AMD3BIN_CREATE_KERNELDESCMAP) != 0; }
 };
 
+/// check whether is Amd3Binary (AMDGPU HSA code object V3)
+extern bool isAmd3Binary(size_t binarySize, const cxbyte* binary);
+
 };
 
 #endif
@@ -281,9 +281,11 @@ public:
      * \param binaryCodeSize binary code size
      * \param binaryCode pointer to binary code
      * \param creationFlags flags that specified what will be created during creation
+     * \param checksumVerified checksum verified by main binary (for trusted input)
      */
     AmdInnerGPUBinary32(const CString& kernelName, size_t binaryCodeSize,
-            cxbyte* binaryCode, Flags creationFlags = ELF_CREATE_ALL);
+            cxbyte* binaryCode, Flags creationFlags = ELF_CREATE_ALL,
+            bool checksumVerified = false);
     ~AmdInnerGPUBinary32() = default;
     
     /// return true if binary has CAL notes infos
@@ -417,14 +419,20 @@ public:
     typedef Array<std::pair<CString, size_t> > KernelInfoMap;
 protected:
     AmdMainType type;   ///< type of binaries
-    Array<KernelInfo> kernelInfos;    ///< kernel informations
+    mutable Array<KernelInfo> kernelInfos;    ///< kernel informations
     KernelInfoMap kernelInfosMap;   ///< kernel informations map
+    NameHashIndex kernelInfosIndex; ///< hash index of kernel informations map
+    /// once flags for kernel informations created at first access (null if not lazy)
+    std::unique_ptr<OnceFlag[]> kernelInfoOnceFlags;
     
     CString driverInfo; ///< driver info string
     CString compileOptions; ///< compiler options string
     
     /// constructor
     explicit AmdMainBinaryBase(AmdMainType type);
+    
+    /// create kernel information at first access (called once)
+    virtual void initKernelInfo(size_t index) const;
 public:
     virtual ~AmdMainBinaryBase();
     
@@ -436,13 +444,11 @@ public:
     size_t getKernelInfosNum() const
     { return kernelInfos.size(); }
     
-    /// get kernel informations array
-    const KernelInfo* getKernelInfos() const
-    { return kernelInfos.data(); }
+    /// get kernel informations array (creates all kernel informations)
+    const KernelInfo* getKernelInfos() const;
     
     /// get kernel information with specified index
-    const KernelInfo& getKernelInfo(size_t index) const
-    { return kernelInfos[index]; }
+    const KernelInfo& getKernelInfo(size_t index) const;
     
     /// get kernel information with specified kernel name (requires kernel info map)
     const KernelInfo& getKernelInfo(const char* name) const;
@@ -480,11 +486,25 @@ public:
     /// kernel header map type
     typedef Array<std::pair<CString, size_t> > KernelHeaderMap;
 protected:
-    Array<AmdInnerGPUBinary32> innerBinaries;   ///< inner binaries
+    /// place of inner binary in main binary (to create it at first access)
+    struct InnerBinaryEntry
+    {
+        CString kernelName; ///< kernel name
+        size_t size;    ///< size of inner binary
+        cxbyte* code;   ///< inner binary code
+    };
+    
+    mutable Array<AmdInnerGPUBinary32> innerBinaries;   ///< inner binaries
+    Array<InnerBinaryEntry> innerBinaryEntries; ///< places of inner binaries
+    /// once flags for inner binaries
+    std::unique_ptr<OnceFlag[]> innerBinaryOnceFlags;
+    Flags innerCreationFlags;   ///< creation flags for inner binaries
     InnerBinaryMap innerBinaryMap;  ///< inner binary map
+    NameHashIndex innerBinaryIndex; ///< hash index of inner binary map
     std::unique_ptr<AmdGPUKernelMetadata[]> metadatas;  ///< AMD metadatas
     Array<AmdGPUKernelHeader> kernelHeaders;    ///< kernel headers
     KernelHeaderMap kernelHeaderMap;    ///< kernel header map
+    NameHashIndex kernelHeaderIndex;    ///< hash index of kernel header map
     size_t globalDataSize;  ///< global data size
     cxbyte* globalData; ///< global data content
     
@@ -493,19 +513,36 @@ protected:
     
     /// initialize main gpu binary (internal use only)
     template<typename Types>
-    void initMainGPUBinary(typename Types::ElfBinary& binary);
+    void initMainGPUBinary(typename Types::ElfBinary& binary, const BinaryIndex* index);
+    
+    /// create inner binary at first access (called once)
+    void initInnerBinary(size_t index) const;
+    /// parse kernel metadata at first access (called once)
+    void initKernelInfo(size_t index) const;
 public:
     /// get number of inner binaries
     size_t getInnerBinariesNum() const
     { return innerBinaries.size(); }
-    
-    /// get inner binary with specified index
+
+    /// get kernel name of inner binary (without creating inner binary)
+    const CString& getInnerBinaryName(size_t index) const
+    { return innerBinaryEntries[index].kernelName; }
+
+    /// get inner binary with specified index (created at first access)
     AmdInnerGPUBinary32& getInnerBinary(size_t index)
-    { return innerBinaries[index]; }
+    {
+        callOnce(innerBinaryOnceFlags[index], [this, index]()
+                { initInnerBinary(index); });
+        return innerBinaries[index];
+    }
     
-    /// get inner binary with specified index
+    /// get inner binary with specified index (created at first access)
     const AmdInnerGPUBinary32& getInnerBinary(size_t index) const
-    { return innerBinaries[index]; }
+    {
+        callOnce(innerBinaryOnceFlags[index], [this, index]()
+                { initInnerBinary(index); });
+        return innerBinaries[index];
+    }
     
     /// get inner binary with specified name (requires inner binary map)
     const AmdInnerGPUBinary32& getInnerBinary(const char* name) const;
@@ -572,9 +609,12 @@ public:
      * \param binaryCodeSize binary code size
      * \param binaryCode pointer to binary code
      * \param creationFlags flags that specified what will be created during creation
+     * \param expectedChecksum expected checksum of trusted binary
+     * \param index binary index of this binary (maps are taken from index)
      */
     AmdMainGPUBinary32(size_t binaryCodeSize, cxbyte* binaryCode,
-            Flags creationFlags = AMDBIN_CREATE_ALL);
+            Flags creationFlags = AMDBIN_CREATE_ALL,
+            uint64_t expectedChecksum = 0, const BinaryIndex* index = nullptr);
     ~AmdMainGPUBinary32() = default;
     
     // determine GPU device type from this binary
@@ -616,9 +656,12 @@ public:
      * \param binaryCodeSize binary code size
      * \param binaryCode pointer to binary code
      * \param creationFlags flags that specified what will be created during creation
+     * \param expectedChecksum expected checksum of trusted binary
+     * \param index binary index of this binary (maps are taken from index)
      */
     AmdMainGPUBinary64(size_t binaryCodeSize, cxbyte* binaryCode,
-            Flags creationFlags = AMDBIN_CREATE_ALL);
+            Flags creationFlags = AMDBIN_CREATE_ALL,
+            uint64_t expectedChecksum = 0, const BinaryIndex* index = nullptr);
     ~AmdMainGPUBinary64() = default;
     
     // determine GPU device type from this binary
@@ -664,9 +707,11 @@ public:
      * \param binaryCodeSize binary code size
      * \param binaryCode pointer to binary code
      * \param creationFlags flags that specified what will be created during creation
+     * \param expectedChecksum expected checksum of trusted binary
      */
     AmdMainX86Binary32(size_t binaryCodeSize, cxbyte* binaryCode,
-            Flags creationFlags = AMDBIN_CREATE_ALL);
+            Flags creationFlags = AMDBIN_CREATE_ALL,
+            uint64_t expectedChecksum = 0);
     ~AmdMainX86Binary32() = default;
     
     /// returns true if binary has kernel informations
@@ -709,9 +754,11 @@ public:
      * \param binaryCodeSize binary code size
      * \param binaryCode pointer to binary code
      * \param creationFlags flags that specified what will be created during creation
+     * \param expectedChecksum expected checksum of trusted binary
      */
     AmdMainX86Binary64(size_t binaryCodeSize, cxbyte* binaryCode,
-            Flags creationFlags = AMDBIN_CREATE_ALL);
+            Flags creationFlags = AMDBIN_CREATE_ALL,
+            uint64_t expectedChecksum = 0);
     ~AmdMainX86Binary64() = default;
     
     /// returns true if binary has kernel informations
@@ -741,16 +788,32 @@ public:
 /// check whether binary code is Amd Catalyst binary
 extern bool isAmdBinary(size_t binaryCodeSize, const cxbyte* binaryCode);
 
+/// get GPU device type from machine field of ELF header of AMD GPU binary
+/** throws BinException if machine field doesn't match any GPU device */
+extern GPUDeviceType getAmdGPUDeviceTypeFromElfMachine(uint16_t elfMachine);
+
+/// find CAL encoding entry for specified device type
+/**
+ * \param entriesNum number of CAL encoding entries
+ * \param entries CAL encoding entries
+ * \param deviceType specified device type
+ * \return CAL Encoding Entry index
+ */
+extern cxuint findAmdCALEncodingEntryIndex(cxuint entriesNum,
+            const CALEncodingEntry* entries, GPUDeviceType deviceType);
+
 /// create AMD binary object from binary code
 /**
  * \param binaryCodeSize binary code size
  * \param binaryCode pointer to binary code
  * \param creationFlags flags that specified what will be created during creation
+ * \param expectedChecksum expected checksum of trusted binary
  * \return binary object
  */
 extern AmdMainBinaryBase* createAmdBinaryFromCode(
             size_t binaryCodeSize, cxbyte* binaryCode,
-            Flags creationFlags = AMDBIN_CREATE_ALL);
+            Flags creationFlags = AMDBIN_CREATE_ALL,
+            uint64_t expectedChecksum = 0);
 
 };
 
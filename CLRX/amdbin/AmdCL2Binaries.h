@@ -69,27 +69,59 @@ struct AmdCL2GPUKernelStub
 class AmdCL2MainGPUBinary64;
 
 /// AMD OpenCL 2.0 inner binary base class
+/** kernel datas (and kernel stubs) are created at first access to them,
+ * kernel data map is created at first access by kernel name */
 class AmdCL2InnerGPUBinaryBase
 {
 public:
     /// inner binary map type
     typedef Array<std::pair<CString, size_t> > KernelDataMap;
 protected:
-    Array<AmdCL2GPUKernel> kernels;    ///< kernel headers
-    KernelDataMap kernelDataMap;    ///< kernel data map
+    /// place of kernel in binary (to create kernel data at first access)
+    struct KernelEntry
+    {
+        const char* name;   ///< kernel name (in symbol name)
+        size_t nameLength;  ///< kernel name length
+        cxbyte* data;   ///< kernel binary (setup or stub)
+        size_t size;    ///< kernel binary size
+    };
+    
+    mutable Array<AmdCL2GPUKernel> kernels;    ///< kernel headers
+    mutable KernelDataMap kernelDataMap;    ///< kernel data map
+    mutable NameHashIndex kernelDataIndex;  ///< hash index of kernel data map
+    bool kernelDataIndexCreated;    ///< true if hash index of kernel data map is created
+    Array<KernelEntry> kernelEntries;   ///< places of kernels
+    std::unique_ptr<OnceFlag[]> kernelOnceFlags;  ///< once flags for kernels
+    std::unique_ptr<OnceFlag> kernelDataMapOnceFlag;  ///< once flag for kernel data map
+    
+    /// allocate kernel entries and once flags (kernel data map if createMap)
+    void initKernelEntries(size_t kernelsNum, bool createMap, bool createIndex);
+    /// create kernel data (and other things) at first access (called once)
+    virtual void initKernelData(size_t index) const;
+    /// create kernel data map at first access (called once)
+    void initKernelDataMap() const;
+    
+    /// get kernel index for kernel name (requires kernel data map)
+    size_t findKernel(const char* name) const;
 public:
     virtual ~AmdCL2InnerGPUBinaryBase();
     /// get kernels number
     size_t getKernelsNum() const
     { return kernels.size(); }
     
-    /// get kernel data for specified index
+    /// get kernel data for specified index (created at first access)
     const AmdCL2GPUKernel& getKernelData(size_t index) const
-    { return kernels[index]; }
+    {
+        callOnce(kernelOnceFlags[index], [this, index]() { initKernelData(index); });
+        return kernels[index];
+    }
     
-    /// get kernel data for specified index
+    /// get kernel data for specified index (created at first access)
     AmdCL2GPUKernel& getKernelData(size_t index)
-    { return kernels[index]; }
+    {
+        callOnce(kernelOnceFlags[index], [this, index]() { initKernelData(index); });
+        return kernels[index];
+    }
     
     /// get kernel data for specified kernel name
     const AmdCL2GPUKernel& getKernelData(const char* name) const;
@@ -104,6 +136,8 @@ private:
     size_t binarySize;
     cxbyte* binary;
     std::unique_ptr<AmdCL2GPUKernelStub[]> kernelStubs;
+    
+    void initKernelData(size_t index) const;
 public:
     /// constructor
     AmdCL2OldInnerGPUBinary() = default;
@@ -140,9 +174,12 @@ public:
     bool hasKernelStubs() const
     { return creationFlags & AMDCL2BIN_CREATE_KERNELSTUBS; }
     
-    /// get kernel stub for specified index
+    /// get kernel stub for specified index (created at first access)
     const AmdCL2GPUKernelStub& getKernelStub(size_t index) const
-    { return kernelStubs[index]; }
+    {
+        callOnce(kernelOnceFlags[index], [this, index]() { initKernelData(index); });
+        return kernelStubs[index];
+    }
     
     /// get kernel stub for specified kernel name
     const AmdCL2GPUKernelStub& getKernelStub(const char* name) const;
@@ -169,6 +206,8 @@ private:
     size_t globalDataRelsNum;
     size_t globalDataRelEntrySize;
     cxbyte* globalDataRela;
+    
+    void initKernelData(size_t index) const;
 public:
     /// constructor
     AmdCL2InnerGPUBinary() = default;
@@ -177,9 +216,10 @@ public:
      * \param binaryCodeSize inner binary code size
      * \param binaryCode inner binary code
      * \param creationFlags creation's flags
+     * \param checksumVerified checksum verified by main binary (for trusted input)
      */
     AmdCL2InnerGPUBinary(size_t binaryCodeSize, cxbyte* binaryCode,
-            Flags creationFlags = AMDBIN_CREATE_ALL);
+            Flags creationFlags = AMDBIN_CREATE_ALL, bool checksumVerified = false);
     /// destructor
     ~AmdCL2InnerGPUBinary() = default;
     
@@ -383,13 +423,18 @@ protected:
     Array<AmdCL2GPUKernelMetadata> isaMetadatas;  ///< AMD metadatas
     std::unique_ptr<AmdGPUKernelHeader[]> kernelHeaders;    ///< kernel headers
     MetadataMap isaMetadataMap; ///< ISA metadata map
+    NameHashIndex isaMetadataIndex; ///< hash index of ISA metadata map
     
     CString aclVersionString; ///< acl version string
     std::unique_ptr<AmdCL2InnerGPUBinaryBase> innerBinary;  ///< inner binary pointer
     
     /// initialize binary
     template<typename Types>
-    void initMainGPUBinary(typename Types::ElfBinary& elfBin);
+    void initMainGPUBinary(typename Types::ElfBinary& elfBin,
+                const BinaryIndex* binIndex);
+    
+    /// parse kernel arguments from metadata at first access (called once)
+    void initKernelInfo(size_t index) const;
     
     /// internal method to determine GPU device type
     template<typename Types>
@@ -493,9 +538,16 @@ public:
 class AmdCL2MainGPUBinary32: public AmdCL2MainGPUBinaryBase, public ElfBinary32
 {
 public:
-    /// constructor
+    /** constructor
+     * \param binaryCodeSize binary code size
+     * \param binaryCode pointer to binary code
+     * \param creationFlags flags that specified what will be created during creation
+     * \param expectedChecksum expected checksum of trusted binary
+     * \param index binary index of this binary (maps are taken from index)
+     */
     AmdCL2MainGPUBinary32(size_t binaryCodeSize, cxbyte* binaryCode,
-            Flags creationFlags = AMDBIN_CREATE_ALL);
+            Flags creationFlags = AMDBIN_CREATE_ALL,
+            uint64_t expectedChecksum = 0, const BinaryIndex* index = nullptr);
     /// default destructor
     ~AmdCL2MainGPUBinary32() = default;
     
@@ -529,9 +581,16 @@ public:
 class AmdCL2MainGPUBinary64: public AmdCL2MainGPUBinaryBase, public ElfBinary64
 {
 public:
-    /// constructor
+    /** constructor
+     * \param binaryCodeSize binary code size
+     * \param binaryCode pointer to binary code
+     * \param creationFlags flags that specified what will be created during creation
+     * \param expectedChecksum expected checksum of trusted binary
+     * \param index binary index of this binary (maps are taken from index)
+     */
     AmdCL2MainGPUBinary64(size_t binaryCodeSize, cxbyte* binaryCode,
-            Flags creationFlags = AMDBIN_CREATE_ALL);
+            Flags creationFlags = AMDBIN_CREATE_ALL,
+            uint64_t expectedChecksum = 0, const BinaryIndex* index = nullptr);
     /// default destructor
     ~AmdCL2MainGPUBinary64() = default;
     
@@ -563,15 +622,41 @@ public:
  * \param binaryCodeSize binary code size
  * \param binaryCode pointer to binary code
  * \param creationFlags flags that specified what will be created during creation
+ * \param expectedChecksum expected checksum of trusted binary
  * \return binary object
  */
 extern AmdCL2MainGPUBinaryBase* createAmdCL2BinaryFromCode(
             size_t binaryCodeSize, cxbyte* binaryCode,
-            Flags creationFlags = AMDBIN_CREATE_ALL);
+            Flags creationFlags = AMDBIN_CREATE_ALL,
+            uint64_t expectedChecksum = 0);
 
 /// check whether is Amd OpenCL 2.0 binary
 extern bool isAmdCL2Binary(size_t binarySize, const cxbyte* binary);
 
+/// detect driver version of AMD OpenCL 2.0 binary from its ELF structures
+/** checks symbols of binary, symbols and notes of inner binary and kernel metadata
+ * headers (in the same way as binary object). Binary objects are not created.
+ * \param elfBin ELF binary (main binary)
+ * \return driver version
+ */
+extern cxuint detectAmdCL2DriverVersion(const ElfBinary32& elfBin);
+
+/// detect driver version of AMD OpenCL 2.0 binary from its ELF structures
+extern cxuint detectAmdCL2DriverVersion(const ElfBinary64& elfBin);
+
+/// determine GPU device type of AMD OpenCL 2.0 binary
+/**
+ * \param elfFlags flags field from ELF header of main binary
+ * \param driverVersion driver version
+ * \param innerBin new inner binary (with notes) or null if not present
+ * \param archMinor output architecture minor
+ * \param archStepping output architecture stepping
+ * \return device type
+ */
+extern GPUDeviceType determineAmdCL2GPUDeviceType(uint32_t elfFlags,
+            cxuint driverVersion, const ElfBinary64* innerBin,
+            uint32_t& archMinor, uint32_t& archStepping);
+
 };
 
 #endif
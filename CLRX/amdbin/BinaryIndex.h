@@ -0,0 +1,289 @@
+/*
+ *  CLRadeonExtender - Unofficial OpenCL Radeon Extensions Library
+ *  Copyright (C) 2014-2018 Mateusz Szpakowski
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/*! \file BinaryIndex.h
+ * \brief binary index (offsets of sections, symbols and kernels) saved beside binary
+ */
+
+#ifndef __CLRX_BINARYINDEX_H__
+#define __CLRX_BINARYINDEX_H__
+
+#include <CLRX/Config.h>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+#include <utility>
+#include <CLRX/utils/Utilities.h>
+#include <CLRX/utils/Containers.h>
+#include <CLRX/utils/GPUId.h>
+#include <CLRX/utils/CString.h>
+#include <CLRX/amdbin/ElfBinaries.h>
+#include <CLRX/amdbin/BinaryProbe.h>
+
+/// main namespace
+namespace CLRX
+{
+
+class AmdMainGPUBinary32;
+class AmdMainGPUBinary64;
+class AmdCL2MainGPUBinary32;
+class AmdCL2MainGPUBinary64;
+class ROCmBinary;
+class GalliumBinary;
+
+/// header of binary index file
+/** binary index file is mappable: all tables have fixed offsets given in header,
+ * entries have fixed sizes and all numbers are in little-endian.
+ * Tables are aligned to 8 bytes. Names are stored in string table and finished by zero.
+ * Nonexistent offset is stored as 2^64-1 */
+struct BinaryIndexFileHeader
+{
+    char magic[8];  ///< magic "CLRXBIDX"
+    uint32_t version;   ///< version
+    uint32_t format;    ///< binary format (BinaryProbeFormat)
+    uint32_t flags;     ///< bit 0 - 64-bit ELF, bit 1 - has device type
+    uint32_t deviceType;    ///< GPU device type
+    uint64_t binarySize;    ///< binary size
+    uint64_t checksum;      ///< binary checksum
+    uint64_t metadataOffset;    ///< offset of binary metadata
+    uint64_t metadataSize;  ///< size of binary metadata
+    uint32_t sectionsNum;   ///< sections number
+    uint32_t symbolsNum;    ///< symbols number
+    uint32_t kernelsNum;    ///< kernels number
+    uint32_t reserved;  ///< reserved (zero)
+    uint64_t sectionsOffset;    ///< offset of section table
+    uint64_t symbolsOffset;     ///< offset of symbol table
+    uint64_t kernelsOffset;     ///< offset of kernel table
+    /// offset of map table (section, symbol and kernel indices sorted by name)
+    uint64_t mapsOffset;
+    uint64_t stringsOffset; ///< offset of string table
+    uint64_t stringsSize;   ///< size of string table
+};
+
+/// section entry of binary index file
+struct BinaryIndexFileSection
+{
+    uint64_t nameOffset;    ///< offset of name in string table
+    uint64_t offset;    ///< offset of section content in binary
+    uint64_t size;      ///< size of section
+    uint32_t nameSize;  ///< size of name
+    uint32_t type;      ///< section type
+};
+
+/// symbol entry of binary index file
+struct BinaryIndexFileSymbol
+{
+    uint64_t nameOffset;    ///< offset of name in string table
+    uint64_t value;     ///< symbol value
+    uint64_t size;      ///< symbol size
+    uint32_t nameSize;  ///< size of name
+    uint16_t sectionIndex;  ///< section index
+    uint8_t info;       ///< symbol info
+    uint8_t reserved;   ///< reserved (zero)
+};
+
+/// kernel entry of binary index file
+struct BinaryIndexFileKernel
+{
+    uint64_t nameOffset;    ///< offset of name in string table
+    uint32_t nameSize;  ///< size of name
+    uint32_t reserved;  ///< reserved (zero)
+    uint64_t offset;    ///< offset of kernel region
+    uint64_t size;      ///< size of kernel region
+    uint64_t codeOffset;    ///< offset of kernel code
+    uint64_t codeSize;      ///< size of kernel code
+    uint64_t setupOffset;   ///< offset of kernel setup
+    uint64_t setupSize;     ///< size of kernel setup
+    uint64_t metadataOffset;    ///< offset of kernel metadata
+    uint64_t metadataSize;  ///< size of kernel metadata
+};
+
+/// ELF section in binary index
+struct BinaryIndexSection
+{
+    CString name;   ///< section name
+    size_t offset;  ///< offset of section content in binary
+    size_t size;    ///< size of section
+    uint32_t type;  ///< section type
+};
+
+/// ELF symbol in binary index
+struct BinaryIndexSymbol
+{
+    CString name;   ///< symbol name
+    uint64_t value; ///< symbol value
+    uint64_t size;  ///< symbol size
+    uint16_t sectionIndex;  ///< section index
+    cxbyte info;    ///< symbol info (type and binding)
+};
+
+/// kernel in binary index
+/** all offsets are offsets in binary. If data doesn't exist then offset is SIZE_MAX
+ * and size is zero */
+struct BinaryIndexKernel
+{
+    CString name;   ///< kernel name
+    size_t offset;  ///< offset of kernel region (inner binary or setup with code)
+    size_t size;    ///< size of kernel region
+    size_t codeOffset;  ///< offset of kernel code
+    size_t codeSize;    ///< size of kernel code
+    size_t setupOffset; ///< offset of kernel setup (config or kernel descriptor)
+    size_t setupSize;   ///< size of kernel setup
+    size_t metadataOffset;  ///< offset of kernel metadata
+    size_t metadataSize;    ///< size of kernel metadata
+};
+
+/// binary index
+/** index holds offsets of sections, symbols, kernel regions, kernel codes,
+ * kernel setups and metadatas and allows to access to them without loading binary.
+ * Index stores size and checksum of binary to check whether index matches to binary.
+ * Binary index for AMD OpenCL 2.0 binary requires kernel infos and kernel datas
+ * (AMDBIN_CREATE_KERNELINFO and AMDCL2BIN_INNER_CREATE_KERNELDATA).
+ *
+ * Index can be read from stream or loaded from mapped memory (load()).
+ * Index passed to constructor of binary class (AmdMainGPUBinary32/64,
+ * AmdCL2MainGPUBinary32/64, ROCmBinary and GalliumBinary) replaces creating of
+ * section and symbol maps and kernel maps (inner binary map and kernel info map):
+ * they are taken from sorted maps of index. Binary class checks whether index matches
+ * to binary and the checksum from index is expected checksum for trusted loading.
+ * Kernel metadatas are still parsed from binary (at first access
+ * or if creation flags require it). */
+class BinaryIndex
+{
+public:
+    /// kernel map type
+    typedef Array<std::pair<CString, size_t> > KernelMap;
+private:
+    BinaryProbeFormat format;
+    bool is64Bit;
+    bool hasDeviceType;
+    GPUDeviceType deviceType;
+    size_t binarySize;
+    uint64_t checksum;
+    size_t metadataOffset;
+    size_t metadataSize;
+    std::vector<BinaryIndexSection> sections;
+    std::vector<BinaryIndexSymbol> symbols;
+    std::vector<BinaryIndexKernel> kernels;
+    std::vector<uint32_t> sectionMap;
+    std::vector<uint32_t> symbolMap;
+    KernelMap kernelMap;
+    
+    void initIndex(BinaryProbeFormat format, bool is64Bit, size_t binarySize,
+                const cxbyte* binary);
+    template<typename Types>
+    void addElfBinary(const ElfBinaryTemplate<Types>& elfBin, size_t elfOffset);
+    template<typename AmdBin>
+    void buildAmd(const AmdBin& binary);
+    template<typename AmdCL2Bin>
+    void buildAmdCL2(const AmdCL2Bin& binary);
+    void buildMaps();
+public:
+    /// constructor
+    BinaryIndex();
+    
+    /// clear index
+    void clear();
+    
+    /// build index for AMD Catalyst 32-bit binary
+    void build(const AmdMainGPUBinary32& binary);
+    /// build index for AMD Catalyst 64-bit binary
+    void build(const AmdMainGPUBinary64& binary);
+    /// build index for AMD OpenCL 2.0 32-bit binary (throws if no kernel infos)
+    void build(const AmdCL2MainGPUBinary32& binary);
+    /// build index for AMD OpenCL 2.0 64-bit binary (throws if no kernel infos)
+    void build(const AmdCL2MainGPUBinary64& binary);
+    /// build index for ROCm binary
+    void build(const ROCmBinary& binary);
+    /// build index for Gallium binary
+    void build(const GalliumBinary& binary);
+    
+    /// return true if index matches to binary (compares size and checksum)
+    bool matches(size_t binarySize, const cxbyte* binary) const;
+    
+    /// get binary format
+    BinaryProbeFormat getFormat() const
+    { return format; }
+    /// return true if (main) binary is 64-bit ELF
+    bool is64BitBinary() const
+    { return is64Bit; }
+    /// return true if device type has been determined from binary
+    bool hasGPUDeviceType() const
+    { return hasDeviceType; }
+    /// get GPU device type
+    GPUDeviceType getDeviceType() const
+    { return deviceType; }
+    /// get binary size
+    size_t getBinarySize() const
+    { return binarySize; }
+    /// get binary checksum (expected checksum for trusted loading)
+    uint64_t getChecksum() const
+    { return checksum; }
+    /// get offset of binary metadata (ROCm metadata, SIZE_MAX if not exists)
+    size_t getMetadataOffset() const
+    { return metadataOffset; }
+    /// get size of binary metadata
+    size_t getMetadataSize() const
+    { return metadataSize; }
+    
+    /// get sections number
+    size_t getSectionsNum() const
+    { return sections.size(); }
+    /// get section
+    const BinaryIndexSection& getSection(size_t index) const
+    { return sections[index]; }
+    /// get symbols number
+    size_t getSymbolsNum() const
+    { return symbols.size(); }
+    /// get symbol
+    const BinaryIndexSymbol& getSymbol(size_t index) const
+    { return symbols[index]; }
+    /// get kernels number
+    size_t getKernelsNum() const
+    { return kernels.size(); }
+    /// get kernel
+    const BinaryIndexKernel& getKernel(size_t index) const
+    { return kernels[index]; }
+    
+    /// get section map (indices of sections sorted by name)
+    const std::vector<uint32_t>& getSectionMap() const
+    { return sectionMap; }
+    /// get symbol map (indices of symbols sorted by name)
+    const std::vector<uint32_t>& getSymbolMap() const
+    { return symbolMap; }
+    /// get kernel map (kernel names with indices sorted by name)
+    const KernelMap& getKernelMap() const
+    { return kernelMap; }
+    
+    /// find kernel by name (return SIZE_MAX if not found)
+    size_t findKernel(const char* name) const;
+    
+    /// write index in binary form
+    void write(std::ostream& os) const;
+    /// read index in binary form
+    void read(std::istream& is);
+    /// load index from binary form in memory (for example mapped index file)
+    /** index data must be aligned to 8 bytes */
+    void load(size_t indexSize, const cxbyte* indexData);
+};
+
+};
+
+#endif
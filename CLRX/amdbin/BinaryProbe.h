@@ -0,0 +1,88 @@
+/*
+ *  CLRadeonExtender - Unofficial OpenCL Radeon Extensions Library
+ *  Copyright (C) 2014-2018 Mateusz Szpakowski
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/*! \file BinaryProbe.h
+ * \brief fast detection of binary format and kernel summary of binaries
+ */
+
+#ifndef __CLRX_BINARYPROBE_H__
+#define __CLRX_BINARYPROBE_H__
+
+#include <CLRX/Config.h>
+#include <cstddef>
+#include <vector>
+#include <CLRX/utils/Utilities.h>
+#include <CLRX/utils/GPUId.h>
+#include <CLRX/utils/CString.h>
+
+/// main namespace
+namespace CLRX
+{
+
+/// binary format detected by probe
+enum class BinaryProbeFormat: cxbyte
+{
+    AMD = 0,        ///< AMD Catalyst OpenCL 1.2 binary
+    AMDCL2,         ///< AMD OpenCL 2.0 binary
+    ROCM,           ///< ROCm binary
+    GALLIUM         ///< Gallium (Mesa3D) binary
+};
+
+/// kernel summary returned by probe
+struct BinaryProbeKernel
+{
+    CString name;   ///< kernel name
+    /// kernel code size in bytes (for Gallium binaries size of kernel region)
+    size_t codeSize;
+};
+
+/// binary summary returned by probe
+struct BinaryProbe
+{
+    BinaryProbeFormat format;   ///< binary format
+    bool is64Bit;   ///< true if (main) binary is 64-bit ELF
+    bool hasDeviceType;     ///< true if device type has been determined from binary
+    GPUDeviceType deviceType;   ///< device type
+    std::vector<BinaryProbeKernel> kernels; ///< kernels
+};
+
+/// detect binary format
+/** checks ELF header once, in the same order as the disassembler
+ * (AMD, AMD OpenCL 2.0, ROCm). Other binaries are treated as Gallium binaries.
+ * \param binarySize binary size
+ * \param binary binary content
+ * \return binary format
+ */
+extern BinaryProbeFormat detectBinaryFormat(size_t binarySize, const cxbyte* binary);
+
+/// get name of binary format
+extern const char* getBinaryProbeFormatName(BinaryProbeFormat format);
+
+/// probe binary
+/** returns format, device type, kernel names and kernel code sizes.
+ * Binary objects are not created: only ELF headers, section headers and symbol
+ * tables (and kernel setups) are read. Kernel arguments are not parsed.
+ * \param binarySize binary size
+ * \param binary binary content
+ * \param probe output probe
+ */
+extern void probeBinary(size_t binarySize, cxbyte* binary, BinaryProbe& probe);
+
+};
+
+#endif
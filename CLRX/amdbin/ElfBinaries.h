@@ -70,7 +70,16 @@ enum : Flags {
     ELF_CREATE_SECTIONMAP = 1,  ///< create map of sections
     ELF_CREATE_SYMBOLMAP = 2,   ///< create map of symbols
     ELF_CREATE_DYNSYMMAP = 4,   ///< create map of dynamic symbols
-    ELF_CREATE_ALL = 0xf  ///< creation flags for ELF binaries
+    ELF_CREATE_ALL = 0xf,  ///< creation flags for ELF binaries
+    /// create hash indices for finding kernels (regions) by name (all binary classes)
+    BINARY_CREATE_NAMEHASHINDEX = 0x80000000U,
+    /// trusted input (all binary classes): only header is checked, bound checks of
+    /// sections, symbols, notes and kernels are skipped. Requires expected checksum
+    /// (from calculateBinaryChecksum) passed to constructor, loading of binary
+    /// with different checksum fails
+    BINARY_CREATE_TRUSTED = 0x40000000U,
+    /// creation flags common for all binary classes (passed to inner binaries)
+    BINARY_CREATE_COMMON = BINARY_CREATE_NAMEHASHINDEX | BINARY_CREATE_TRUSTED
 };
 
 /// Bin exception class
@@ -139,6 +148,8 @@ struct Elf64Types
     static const cxuint relSymShift = 32;
 };
 
+class BinaryIndex;
+
 /// ELF binary class
 /** This object doesn't copy binary code content.
  * Only it takes and uses a binary code.
@@ -180,9 +191,16 @@ public:
      * \param binaryCodeSize binary code size
      * \param binaryCode pointer to binary code
      * \param creationFlags flags that specified what will be created during creation
+     * \param expectedChecksum expected checksum of trusted binary
+     * \param checksumVerified checksum verified by containing binary (only for
+     * inner binaries created by binary classes)
+     * \param index binary index of this binary: section and symbol maps are taken
+     * from index, checksum of index replaces expected checksum
      */
     ElfBinaryTemplate(size_t binaryCodeSize, cxbyte* binaryCode,
-                Flags creationFlags = ELF_CREATE_ALL);
+                Flags creationFlags = ELF_CREATE_ALL,
+                uint64_t expectedChecksum = 0, bool checksumVerified = false,
+                const BinaryIndex* index = nullptr);
     virtual ~ElfBinaryTemplate();
     
     /// get creation flags
@@ -477,6 +495,15 @@ extern template class ElfBinaryTemplate<Elf64Types>;
 /// check whether binary data is is ELF binary
 extern bool isElfBinary(size_t binarySize, const cxbyte* binary);
 
+/// calculate checksum of whole binary (to verify binary before trusted loading)
+/** any change of single 8-byte word of binary always changes checksum */
+extern uint64_t calculateBinaryChecksum(size_t binarySize, const cxbyte* binary);
+
+/// verify checksum of trusted binary (if BINARY_CREATE_TRUSTED set)
+/** throws BinException if checksum doesn't match */
+extern void verifyTrustedBinary(size_t binarySize, const cxbyte* binary,
+                Flags creationFlags, uint64_t expectedChecksum);
+
 /// type for 32-bit ELF binary
 typedef class ElfBinaryTemplate<Elf32Types> ElfBinary32;
 /// type for 64-bit ELF binary
@@ -153,6 +153,7 @@ protected:
     uint32_t progInfosNum;  ///< program info entries number
     GalliumProgInfoEntry* progInfoEntries;  ///< program info entries
     ProgInfoEntryIndexMap progInfoEntryMap; ///< program info map
+    NameHashIndex progInfoEntryIndex;   ///< hash index of program info map
     size_t disasmSize;  ///< disassembly size
     size_t disasmOffset;    ///< disassembly offset
     bool llvm390;   ///< true if >= LLVM 3.9
@@ -230,9 +231,10 @@ private:
 public:
     /// empty constructor
     GalliumElfBinary32();
-    /// constructor
+    /// constructor (section and symbol maps are taken from index if given)
     GalliumElfBinary32(size_t binaryCodeSize, cxbyte* binaryCode, Flags creationFlags,
-            size_t kernelsNum);
+            size_t kernelsNum, bool checksumVerified = false,
+            const BinaryIndex* index = nullptr);
     /// destructor
     virtual ~GalliumElfBinary32();
     
@@ -265,9 +267,10 @@ private:
 public:
     /// empty constructor
     GalliumElfBinary64();
-    /// constructor
+    /// constructor (section and symbol maps are taken from index if given)
     GalliumElfBinary64(size_t binaryCodeSize, cxbyte* binaryCode, Flags creationFlags,
-            size_t kernelsNum);
+            size_t kernelsNum, bool checksumVerified = false,
+            const BinaryIndex* index = nullptr);
     /// destructor
     virtual ~GalliumElfBinary64();
     
@@ -307,8 +310,9 @@ private:
     bool mesa170;
     
 public:
-    /// constructor
-    GalliumBinary(size_t binaryCodeSize, cxbyte* binaryCode, Flags creationFlags);
+    /// constructor (maps of inner ELF binary are taken from index if given)
+    GalliumBinary(size_t binaryCodeSize, cxbyte* binaryCode, Flags creationFlags,
+            uint64_t expectedChecksum = 0, const BinaryIndex* index = nullptr);
     /// destructor
     ~GalliumBinary() = default;
     
@@ -26,6 +26,7 @@
 #include <CLRX/Config.h>
 #include <cstddef>
 #include <cstdint>
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <vector>
@@ -46,7 +47,11 @@ enum : Flags {
     ROCMBIN_CREATE_REGIONMAP = 0x10,    ///< create region map
     ROCMBIN_CREATE_METADATAINFO = 0x20,     ///< create metadata info object
     ROCMBIN_CREATE_KERNELINFOMAP = 0x40,    ///< create kernel metadata info map
-    ROCMBIN_CREATE_ALL = ELF_CREATE_ALL | 0xfff0 ///< all ROCm binaries flags
+    ROCMBIN_CREATE_ALL = ELF_CREATE_ALL | 0xfff0, ///< all ROCm binaries flags
+    /// parse metadata info by many threads (kernels are parsed in parallel)
+    ROCMBIN_PARALLEL_METADATAINFO = 0x10000,
+    /// create metadata view (strings point to binary, not included in ROCMBIN_CREATE_ALL)
+    ROCMBIN_CREATE_METADATAVIEW = 0x20000
 };
 
 /// ROCm region/symbol type
@@ -196,9 +201,200 @@ struct ROCmMetadata
     /// initialize metadata info
     void initialize();
     /// parse metadata info from metadata string
-    void parse(size_t metadataSize, const char* metadata);
+    /**
+     * \param metadataSize metadata size
+     * \param metadata metadata string
+     * \param threadsNum number of threads to parse kernels (0 - all hardware threads)
+     */
+    void parse(size_t metadataSize, const char* metadata, cxuint threadsNum = 1);
     /// parse metadata info from MsgPack
-    void parseMsgPack(size_t metadataSize, const cxbyte* metadata);
+    /**
+     * \param metadataSize metadata size
+     * \param metadata MsgPack metadata
+     * \param threadsNum number of threads to parse kernels (0 - all hardware threads)
+     */
+    void parseMsgPack(size_t metadataSize, const cxbyte* metadata,
+                cxuint threadsNum = 1);
+};
+
+/// reference to string in ROCm metadata (not null-terminated)
+/** string points to metadata or to arena of ROCmMetadataView */
+struct ROCmStringRef
+{
+    const char* ptr;    ///< string data
+    size_t size;        ///< string length
+    
+    /// return true if string is empty
+    bool empty() const
+    { return size == 0; }
+    /// clear string reference
+    void clear()
+    { ptr = nullptr; size = 0; }
+    /// convert to CString
+    CString toCString() const
+    { return CString(ptr, size); }
+};
+
+/// array in arena of ROCm metadata view
+template<typename T>
+struct ROCmArrayRef
+{
+    T* ptr;     ///< elements
+    size_t num; ///< number of elements
+    
+    /// return number of elements
+    size_t size() const
+    { return num; }
+    /// return true if array is empty
+    bool empty() const
+    { return num == 0; }
+    /// get element
+    const T& operator[](size_t i) const
+    { return ptr[i]; }
+    /// get element
+    T& operator[](size_t i)
+    { return ptr[i]; }
+    /// get first element
+    const T* begin() const
+    { return ptr; }
+    /// get end of array
+    const T* end() const
+    { return ptr+num; }
+    /// get first element
+    T* begin()
+    { return ptr; }
+    /// get end of array
+    T* end()
+    { return ptr+num; }
+};
+
+/// memory arena of ROCm metadata view
+/** memory is allocated in chunks, and it is freed with arena */
+class ROCmMetadataArena
+{
+private:
+    std::vector<std::unique_ptr<char[]> > chunks;
+    char* chunkPtr;
+    size_t chunkLeft;
+    size_t lastChunkSize;
+public:
+    /// constructor
+    ROCmMetadataArena() : chunkPtr(nullptr), chunkLeft(0), lastChunkSize(0)
+    { }
+    /// move constructor
+    ROCmMetadataArena(ROCmMetadataArena&& arena) noexcept;
+    /// move assignment
+    ROCmMetadataArena& operator=(ROCmMetadataArena&& arena) noexcept;
+    
+    /// free all memory and allocate first chunk for given size
+    void reset(size_t firstChunkSize = 0);
+    /// allocate memory (aligned to 8 bytes)
+    void* allocate(size_t size);
+    /// allocate array and copy elements to it
+    template<typename T>
+    ROCmArrayRef<T> copyArray(size_t num, const T* elems)
+    {
+        if (num == 0)
+            return { nullptr, 0 };
+        T* ptr = reinterpret_cast<T*>(allocate(sizeof(T)*num));
+        std::copy(elems, elems+num, ptr);
+        return { ptr, num };
+    }
+    /// get number of allocated chunks
+    size_t getChunksNum() const
+    { return chunks.size(); }
+};
+
+/// ROCm kernel argument (view)
+struct ROCmKernelArgInfoView
+{
+    ROCmStringRef name;       ///< name
+    ROCmStringRef typeName;   ///< type name
+    uint64_t size;      ///< argument size in bytes
+    union {
+        uint64_t align;     ///< argument alignment in bytes
+        uint64_t offset;
+    };
+    uint64_t pointeeAlign;      ///< alignemnt of pointed data of pointer
+    ROCmValueKind valueKind;    ///< value kind
+    ROCmValueType valueType;    ///< value type
+    ROCmAddressSpace addressSpace;  ///< pointer address space
+    ROCmAccessQual accessQual;      ///< access qualifier (for images and values)
+    ROCmAccessQual actualAccessQual;    ///< actual access qualifier
+    bool isConst;       ///< is constant
+    bool isRestrict;    ///< is restrict
+    bool isVolatile;    ///< is volatile
+    bool isPipe;        ///< is pipe
+};
+
+/// ROCm kernel metadata (view)
+struct ROCmKernelMetadataView
+{
+    ROCmStringRef name;       ///< kernel name
+    ROCmStringRef symbolName; ///< symbol name
+    ROCmArrayRef<ROCmKernelArgInfoView> argInfos;  ///< kernel arguments
+    ROCmStringRef language;       ///< language
+    cxuint langVersion[2];  ///< language version
+    cxuint reqdWorkGroupSize[3];    ///< required work group size
+    cxuint workGroupSizeHint[3];    ///< work group size hint
+    ROCmStringRef vecTypeHint;    ///< vector type hint
+    ROCmStringRef runtimeHandle;  ///< symbol of runtime handle
+    uint64_t kernargSegmentSize;    ///< kernel argument segment size
+    uint64_t groupSegmentFixedSize; ///< group segment size (fixed)
+    uint64_t privateSegmentFixedSize;   ///< private segment size (fixed)
+    uint64_t kernargSegmentAlign;       ///< alignment of kernel argument segment
+    cxuint wavefrontSize;       ///< wavefront size
+    cxuint sgprsNum;        ///< number of SGPRs
+    cxuint vgprsNum;        ///< number of VGPRs
+    uint64_t maxFlatWorkGroupSize;
+    cxuint fixedWorkGroupSize[3];
+    cxuint spilledSgprs;    ///< number of spilled SGPRs
+    cxuint spilledVgprs;    ///< number of spilled VGPRs
+    ROCmStringRef deviceEnqueueSymbol;
+    
+    void initialize();
+};
+
+/// ROCm printf call info (view)
+struct ROCmPrintfInfoView
+{
+    uint32_t id;    /// unique id of call
+    ROCmArrayRef<uint32_t> argSizes;   ///< argument sizes
+    ROCmStringRef format;     ///< printf format
+};
+
+/// ROCm binary metadata (view)
+/** strings of metadata view points to parsed metadata or to arena of
+ * this object (strings which must be decoded). Arrays of kernels, arguments and
+ * printf infos are in arena too. Metadata must live as long as this object */
+struct ROCmMetadataView
+{
+    cxuint version[2];  ///< version
+    ROCmArrayRef<ROCmPrintfInfoView> printfInfos;  ///< printf calls infos
+    ROCmArrayRef<ROCmKernelMetadataView> kernels;  ///< kernel metadatas
+    ROCmMetadataArena arena;    ///< arena for decoded strings and arrays
+    
+    /// constructor
+    ROCmMetadataView() : printfInfos{ nullptr, 0 }, kernels{ nullptr, 0 }
+    { }
+    
+    /// initialize metadata info
+    void initialize();
+    /// parse metadata info from metadata string
+    /**
+     * \param metadataSize metadata size
+     * \param metadata metadata string
+     * \param threadsNum number of threads to parse kernels (0 - all hardware threads)
+     */
+    void parse(size_t metadataSize, const char* metadata, cxuint threadsNum = 1);
+    /// parse metadata info from MsgPack
+    /**
+     * \param metadataSize metadata size
+     * \param metadata MsgPack metadata
+     * \param threadsNum number of threads to parse kernels (0 - all hardware threads)
+     */
+    void parseMsgPack(size_t metadataSize, const cxbyte* metadata,
+                cxuint threadsNum = 1);
 };
 
 struct ROCmKernelDescriptor
@@ -240,6 +436,7 @@ private:
     size_t regionsNum;
     std::unique_ptr<ROCmRegion[]> regions;  ///< AMD metadatas
     RegionMap regionsMap;
+    NameHashIndex regionsIndex;
     size_t codeSize;
     cxbyte* code;
     size_t globalDataSize;
@@ -248,16 +445,19 @@ private:
     size_t metadataSize;
     char* metadata;
     std::unique_ptr<ROCmMetadata> metadataInfo;
+    std::unique_ptr<ROCmMetadataView> metadataView;
     RegionMap kernelInfosMap;
+    NameHashIndex kernelInfosIndex;
     Array<const ROCmKernelDescriptor*> kernelDescs;
     Array<size_t> gotSymbols;
     bool newBinFormat;
     bool llvm10BinFormat;
     bool metadataV3Format;
 public:
-    /// constructor
+    /// constructor (section and symbol maps are taken from index if given)
     ROCmBinary(size_t binaryCodeSize, cxbyte* binaryCode,
-            Flags creationFlags = ROCMBIN_CREATE_ALL);
+            Flags creationFlags = ROCMBIN_CREATE_ALL,
+            uint64_t expectedChecksum = 0, const BinaryIndex* index = nullptr);
     /// default destructor
     ~ROCmBinary() = default;
     
@@ -315,6 +515,14 @@ public:
     const ROCmMetadata& getMetadataInfo() const
     { return *metadataInfo; }
     
+    /// has metadata view
+    bool hasMetadataView() const
+    { return metadataView!=nullptr; }
+    
+    /// get metadata view (strings point to metadata of this binary)
+    const ROCmMetadataView& getMetadataView() const
+    { return *metadataView; }
+    
     /// get kernel metadata infos number
     size_t getKernelInfosNum() const
     { return metadataInfo->kernels.size(); }
@@ -396,6 +604,17 @@ typedef AmdHsaKernelConfig ROCmKernelConfig;
 /// check whether is Amd OpenCL 2.0 binary
 extern bool isROCmBinary(size_t binarySize, const cxbyte* binary);
 
+/// determine GPU device type from AMD notes of ROCm binary
+/**
+ * \param elfBin ELF binary
+ * \param llvm10BinFormat true if binary in LLVM 10 format (default is Navi)
+ * \param archMinor output architecture minor
+ * \param archStepping output architecture stepping
+ * \return device type
+ */
+extern GPUDeviceType determineROCmGPUDeviceType(const ElfBinary64& elfBin,
+            bool llvm10BinFormat, uint32_t& archMinor, uint32_t& archStepping);
+
 /*
  * ROCm Binary Generator
  */
@@ -542,11 +761,27 @@ void generateROCmMetadata(const ROCmMetadata& mdInfo,
 void generateROCmMetadataMsgPack(const ROCmMetadata& mdInfo,
                     const ROCmKernelDescriptor** kdescs, std::vector<cxbyte>& output);
 
+/// parse ROCm YAML metadata
+/** if threadsNum is not 1, then kernel records are found by cheap pre-scan and
+ * they are parsed by many threads (0 - all hardware threads). Result and errors
+ * are same as in single thread parsing */
+void parseROCmMetadata(size_t metadataSize, const char* metadata,
+                ROCmMetadata& metadataInfo, cxuint threadsNum = 1);
+
+/// parse ROCm MsgPack metadata
+/** if threadsNum is not 1, then kernels are skipped at first pass and
+ * they are parsed by many threads (0 - all hardware threads). Result and errors
+ * are same as in single thread parsing */
+void parseROCmMetadataMsgPack(size_t metadataSize, const cxbyte* metadata,
+                ROCmMetadata& metadataInfo, cxuint threadsNum = 1);
+
+/// parse ROCm YAML metadata to metadata view
 void parseROCmMetadata(size_t metadataSize, const char* metadata,
-                ROCmMetadata& metadataInfo);
+                ROCmMetadataView& metadataInfo, cxuint threadsNum = 1);
 
+/// parse ROCm MsgPack metadata to metadata view
 void parseROCmMetadataMsgPack(size_t metadataSize, const cxbyte* metadata,
-                ROCmMetadata& metadataInfo);
+                ROCmMetadataView& metadataInfo, cxuint threadsNum = 1);
 
 class MsgPackMapParser;
 
@@ -565,6 +800,7 @@ public:
     uint64_t parseInteger(cxbyte signess);
     double parseFloat();
     std::string parseString();
+    ROCmStringRef parseStringRef();  // string points to parsed data
     Array<cxbyte> parseData();
     MsgPackArrayParser parseArray();
     MsgPackMapParser parseMap();
@@ -596,6 +832,7 @@ public:
     uint64_t parseKeyInteger(cxbyte signess);
     double parseKeyFloat();
     std::string parseKeyString();
+    ROCmStringRef parseKeyStringRef();  // string points to parsed data
     Array<cxbyte> parseKeyData();
     MsgPackArrayParser parseKeyArray();
     MsgPackMapParser parseKeyMap();
@@ -604,6 +841,7 @@ public:
     uint64_t parseValueInteger(cxbyte signess);
     double parseValueFloat();
     std::string parseValueString();
+    ROCmStringRef parseValueStringRef();  // string points to parsed data
     Array<cxbyte> parseValueData();
     MsgPackArrayParser parseValueArray();
     MsgPackMapParser parseValueMap();
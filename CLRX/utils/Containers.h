@@ -25,6 +25,8 @@
 
 #include <CLRX/Config.h>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <iterator>
 #include <algorithm>
 #include <vector>
@@ -494,6 +496,108 @@ void mapSort(Iter begin, Iter end, Comp comp)
        return comp(e1.first, e2.first); });
 }
 
+/// hash index of names for sorted array-map (open addressing)
+/** index holds only positions of elements in array-map, so it must be rebuilt
+ * after any change of map. For equal names index returns first element like
+ * binaryMapFind (array-map must be sorted).
+ */
+class NameHashIndex
+{
+private:
+    struct Entry
+    {
+        size_t hash;    ///< hash of name
+        size_t pos;     ///< position in array-map (SIZE_MAX - empty entry)
+    };
+    Array<Entry> table;
+    size_t mask;
+    
+    static size_t hashName(const char* name)
+    {
+        // same as std::hash<CString>
+        size_t hash = 0;
+        for (const char* p = name; *p != 0; p++)
+            hash = ((hash<<8)^(cxbyte)*p)*size_t(0xbf146a3dU);
+        return hash;
+    }
+    
+    static const char* keyName(const char* key)
+    { return key; }
+    template<typename K>
+    static const char* keyName(const K& key)
+    { return key.c_str(); }
+public:
+    /// empty constructor
+    NameHashIndex() : mask(0)
+    { }
+    
+    /// returns true if index is empty (not built or map is empty)
+    bool empty() const
+    { return table.empty(); }
+    
+    /// clear index
+    void clear()
+    {
+        table.clear();
+        mask = 0;
+    }
+    
+    /// build index for sorted array-map
+    /**
+     * \param begin iterator to first element
+     * \param end iterator to after last element
+     */
+    template<typename Iter>
+    void build(Iter begin, Iter end)
+    {
+        const size_t n = end-begin;
+        if (n == 0)
+        {
+            clear();
+            return;
+        }
+        // load factor is not greater than 0.5
+        size_t tableSize = 4;
+        while (tableSize < (n<<1))
+            tableSize <<= 1;
+        table.allocate(tableSize);
+        std::fill(table.begin(), table.end(), Entry{ 0, SIZE_MAX });
+        mask = tableSize-1;
+        for (Iter it = begin; it != end; ++it)
+        {
+            const char* name = keyName(it->first);
+            // skip next equal names, first of them is already in index
+            if (it != begin && ::strcmp(keyName((it-1)->first), name) == 0)
+                continue;
+            const size_t hash = hashName(name);
+            size_t i = hash & mask;
+            while (table[i].pos != SIZE_MAX)
+                i = (i+1) & mask;
+            table[i] = { hash, size_t(it-begin) };
+        }
+    }
+    
+    /// find name in array-map by using index
+    /**
+     * \param begin iterator to first element
+     * \param end iterator to after last element
+     * \param name name to find
+     * \return iterator to value or end
+     */
+    template<typename Iter>
+    Iter find(Iter begin, Iter end, const char* name) const
+    {
+        if (table.empty())
+            return end;
+        const size_t hash = hashName(name);
+        for (size_t i = hash & mask; table[i].pos != SIZE_MAX; i = (i+1) & mask)
+            if (table[i].hash == hash &&
+                ::strcmp(keyName(begin[table[i].pos].first), name) == 0)
+                return begin + table[i].pos;
+        return end;
+    }
+};
+
 /** Simple cache **/
 
 /// Simple cache for object. object class should have a weight method
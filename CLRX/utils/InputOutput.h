@@ -107,6 +107,8 @@ public:
 protected:
     /// overflow implementation
     int_type overflow(int_type ch);
+    /// xsputn implementation (write whole block at once)
+    std::streamsize xsputn(const char_type* s, std::streamsize n);
     /// setbuf implementation
     std::streambuf* setbuf(char_type* buffer, std::streamsize size);
 };
@@ -288,6 +290,90 @@ public:
     { return buffer.getVector(); }
 };
 
+/// output stream buffer that writes directly to file descriptor
+/** This stream buffer holds large buffer and writes its content by write system
+ * call. In double-buffered mode, the full buffer is written by background thread
+ * while the second buffer is being filled up */
+class FDStreamBuf: public std::streambuf
+{
+private:
+    struct AsyncWriter;
+    int fd;
+    bool ownFD;
+    bool failed;
+    size_t bufSize;
+    std::unique_ptr<char[]> buffer;
+    std::unique_ptr<AsyncWriter> asyncWriter;
+    
+    void initialize(bool doubleBuffered);
+    bool writeBuffer();
+    bool waitForWriter();
+public:
+    /// constructor
+    /**
+     * \param fd file descriptor (not closed by stream buffer)
+     * \param bufSize buffer size
+     * \param doubleBuffered write in background thread while next buffer is filled
+     */
+    explicit FDStreamBuf(int fd, size_t bufSize = 1U<<20, bool doubleBuffered = false);
+    /// constructor
+    /**
+     * \param filename name of file to create (or truncate)
+     * \param bufSize buffer size
+     * \param doubleBuffered write in background thread while next buffer is filled
+     */
+    explicit FDStreamBuf(const char* filename, size_t bufSize = 1U<<20,
+                bool doubleBuffered = false);
+    /// destructor
+    ~FDStreamBuf();
+    
+    /// get file descriptor
+    int getFD() const
+    { return fd; }
+    /// get buffer size
+    size_t getBufferSize() const
+    { return bufSize; }
+    /// return true if double-buffered
+    bool isDoubleBuffered() const
+    { return asyncWriter!=nullptr; }
+protected:
+    /// overflow implementation
+    int_type overflow(int_type ch);
+    /// xsputn implementation
+    std::streamsize xsputn(const char_type* s, std::streamsize n);
+    /// sync implementation
+    int sync();
+};
+
+/// output stream that writes directly to file descriptor
+class FDOStream: public std::ostream
+{
+private:
+    FDStreamBuf buffer;
+public:
+    /// constructor
+    /**
+     * \param fd file descriptor (not closed by stream)
+     * \param bufSize buffer size
+     * \param doubleBuffered write in background thread while next buffer is filled
+     */
+    explicit FDOStream(int fd, size_t bufSize = 1U<<20, bool doubleBuffered = false);
+    /// constructor
+    /**
+     * \param filename name of file to create (or truncate)
+     * \param bufSize buffer size
+     * \param doubleBuffered write in background thread while next buffer is filled
+     */
+    explicit FDOStream(const char* filename, size_t bufSize = 1U<<20,
+                bool doubleBuffered = false);
+    /// destructor
+    ~FDOStream() = default;
+    
+    /// get file descriptor
+    int getFD() const
+    { return buffer.getFD(); }
+};
+
 /*
  * adaptor
  */
@@ -375,6 +461,10 @@ public:
     uint64_t getWritten() const
     { return written; }
     
+    /// get number of bytes in buffer (not yet written to output stream)
+    cxuint getBufferedSize() const
+    { return endPos; }
+    
     /// write output buffer
     void flush()
     {
@@ -32,6 +32,8 @@
 #include <cstdint>
 #include <mutex>
 #include <atomic>
+#include <thread>
+#include <functional>
 #ifdef _MSC_VER
 #include <intrin.h>
 #endif
@@ -357,6 +359,8 @@ inline cxuint CLZ64(uint64_t v);
 inline cxuint CTZ32(uint32_t v);
 /// counts trailing zeroes for 64-bit unsigned integer. For zero behavior is undefined
 inline cxuint CTZ64(uint64_t v);
+/// counts set bits in 32-bit unsigned integer
+inline cxuint POPCNT32(uint32_t v);
 
 inline cxuint CLZ32(uint32_t v)
 {
@@ -446,6 +450,17 @@ inline cxuint CTZ64(uint64_t v)
 #endif
 }
 
+inline cxuint POPCNT32(uint32_t v)
+{
+#ifdef __GNUC__
+    return __builtin_popcount(v);
+#else
+    v = v - ((v>>1) & 0x55555555U);
+    v = (v & 0x33333333U) + ((v>>2) & 0x33333333U);
+    return (((v + (v>>4)) & 0x0f0f0f0fU) * 0x01010101U) >> 24;
+#endif
+}
+
 
 /// safely compares sum of two unsigned integers with other unsigned integer
 template<typename T, typename T2>
@@ -1054,14 +1069,52 @@ struct OnceFlag: std::atomic<int>
     { }
 };
 
+/// callOnce - other threads wait until first call finishes
 template<class Callable, class... Args>
 inline void callOnce(OnceFlag& flag, Callable&& f, Args&&... args)
 {
-    if (flag.exchange(1) == 0)
-        f(args...);
+    // states: 0 - not called, 1 - in progress, 2 - done
+    while (true)
+    {
+        int state = flag.load(std::memory_order_acquire);
+        if (state == 2)
+            return;
+        if (state == 0 && flag.compare_exchange_strong(state, 1))
+        {
+            try
+            { f(args...); }
+            catch(...)
+            {
+                flag.store(0); // call again at next time
+                throw;
+            }
+            flag.store(2, std::memory_order_release);
+            return;
+        }
+        std::this_thread::yield();
+    }
 }
 #endif
 
+/* parallel processing */
+
+/// get number of hardware threads (at least 1)
+extern cxuint getHardwareThreadsNum();
+
+/// call function for every index in range [0,count) by using many threads
+/**
+ * \param count number of items
+ * \param threadsNum number of threads (if zero then number of hardware threads)
+ * \param func function called for every item (argument - index of item)
+ *
+ * If threadsNum is 1 or count is lower than 2 then all items are processed
+ * in the calling thread. Items are fetched dynamically by threads, thus
+ * func must not depend on order of processing. After joining all threads,
+ * the first caught exception is rethrown.
+ */
+extern void parallelForEach(size_t count, cxuint threadsNum,
+                const std::function<void(size_t)>& func);
+
 };
 
 #endif
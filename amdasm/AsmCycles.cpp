@@ -0,0 +1,576 @@
+/*
+ *  CLRadeonExtender - Unofficial OpenCL Radeon Extensions Library
+ *  Copyright (C) 2014-2018 Mateusz Szpakowski
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <CLRX/Config.h>
+#include <cstring>
+#include <cstdint>
+#include <vector>
+#include <array>
+#include <deque>
+#include <sstream>
+#include <ostream>
+#include <algorithm>
+#include <CLRX/utils/Utilities.h>
+#include <CLRX/utils/GPUId.h>
+#include <CLRX/amdasm/Assembler.h>
+#include "GCNInternals.h"
+#include "GCNDisasmInternals.h"
+
+using namespace CLRX;
+
+/* rough latencies of delayed operations (in cycles). real latencies depends on
+ * memory clocks, cache hits and load of GPU, hence these values are only estimates */
+static const cxuint vmemLatency = 400;
+static const cxuint smemLatency = 128;
+static const cxuint ldsLatency = 64;
+static const cxuint expLatency = 32;
+static const cxuint sendMsgLatency = 32;
+
+// penalty for taken conditional jump (4 cycles is counted for not taken jump)
+static const cxuint takenCJumpPenalty = 16;
+
+enum : cxuint
+{
+    CYCQ_VMCNT = 0,
+    CYCQ_LGKMCNT,
+    CYCQ_EXPCNT,
+    CYCQ_MAX,
+    CYCQ_NONE = 255
+};
+
+static const char* cycleQueueNames[CYCQ_MAX] = { "vmcnt", "lgkmcnt", "expcnt" };
+
+// timing of single instruction
+struct CLRX_INTERNAL GCNInstrTiming
+{
+    cxuint issueCycles;
+    cxuint queue;   // first queue (counter)
+    cxuint queue2;  // second queue (counter)
+    cxuint latency;
+    bool isWait;
+    bool isCondJump;
+};
+
+// SOPP opcodes (these same for all GCN architectures)
+enum : uint16_t
+{
+    GCNSOPP_ENDPGM = 1,
+    GCNSOPP_BRANCH = 2,
+    GCNSOPP_ENDPGM_SAVED = 27,
+    GCNSOPP_ENDPGM_ORDERED_PS_DONE = 30
+};
+
+static bool mnemonicInList(const char* mnemonic, const char* const* list)
+{
+    for (; *list != nullptr; list++)
+        if (::strcmp(mnemonic, *list) == 0)
+            return true;
+    return false;
+}
+
+static bool isSOPPEndPgm(uint16_t code)
+{
+    return code == GCNSOPP_ENDPGM || code == GCNSOPP_ENDPGM_SAVED ||
+            code == GCNSOPP_ENDPGM_ORDERED_PS_DONE;
+}
+
+// returns true if SOP1 instruction is s_setpc_b64
+static bool isSOP1SetPC(GPUArchitecture arch, uint16_t code)
+{
+    if (arch == GPUArchitecture::GCN1_2 || arch == GPUArchitecture::GCN1_4 ||
+        arch == GPUArchitecture::GCN1_4_1)
+        return code == 29;
+    return code == 32;
+}
+
+// returns true if SOP1 instruction writes EXEC (s_XXX_saveexec_XXX, s_XXX_wrexec_XXX)
+static bool isSOP1ExecWrite(GPUArchitecture arch, uint16_t code)
+{
+    if (arch <= GPUArchitecture::GCN1_1)
+        return code >= 36 && code <= 43;
+    if (arch <= GPUArchitecture::GCN1_4_1)
+        return (code >= 32 && code <= 39) ||
+            (arch >= GPUArchitecture::GCN1_4 && code >= 51 && code <= 54);
+    return (code >= 36 && code <= 43) || (code >= 55 && code <= 58) ||
+            (code >= 60 && code <= 71);
+}
+
+// get issue cycles for vector ALU instruction (name without 'v_')
+static cxuint getVALUCycles(const char* name, Flags mode, cxuint dpFactor)
+{
+    // issue rates of these instructions are not stored in instruction table
+    static const char* const dpFactor8Instrs[] = { "rcp_f64", "rcp_clamp_f64",
+        "rsq_f64", "rsq_clamp_f64", "sqrt_f64", "fma_f64", "mul_f64",
+        "div_fmas_f64", "trig_preop_f64", nullptr };
+    static const char* const cycles16Instrs[] = { "mul_hi_u32", "mul_hi_i32",
+        "mul_lo_u32", "mul_lo_i32", "mad_u64_u32", "mad_i64_i32", "qsad_pk_u16_u8",
+        "mqsad_pk_u16_u8", "mqsad_u8", "mqsad_u32_u8", "div_fixup_f32",
+        "div_fmas_f32", "div_scale_f32", nullptr };
+    static const char* const transInstrs[] = { "exp_f32", "exp_legacy_f32",
+        "log_f32", "log_clamp_f32", "log_legacy_f32", "rcp_f32", "rcp_iflag_f32",
+        "rcp_clamp_f32", "rcp_legacy_f32", "rsq_f32", "rsq_clamp_f32", "rsq_legacy_f32",
+        "sqrt_f32", "sin_f32", "cos_f32", "exp_f16", "log_f16", "rcp_f16", "rsq_f16",
+        "sqrt_f16", "sin_f16", "cos_f16", nullptr };
+
+    if (::strcmp(name, "swap_b32") == 0)
+        return 8;
+    if (mnemonicInList(name, dpFactor8Instrs))
+        return dpFactor*8;
+    if (mnemonicInList(name, cycles16Instrs))
+        return 16;
+    // any 64-bit operand
+    if ((mode & GCN_REG_ALL_64) != 0)
+        return dpFactor*4;
+    if (mnemonicInList(name, transInstrs))
+        return 16;
+    return 4;
+}
+
+// get issue cycles for LDS instruction
+static cxuint getDSCycles(Flags mode)
+{
+    const bool is64Bit = (mode & GCN_REG_ALL_64) == GCN_REG_ALL_64;
+    if ((mode & GCN_SRC_ADDR2) != 0)
+        // ds_XXX_src2_XXX
+        return is64Bit ? 8 : 4;
+    if ((mode & GCN_ONLYDST) != 0 || (mode & (GCN_DSMASK|GCN_REG_ALL_64)) == GCN_ADDR_STD)
+        // ds_append, ds_consume, ds_nop
+        return 4;
+    if ((mode & (GCN_ADDR_DST|GCN_ADDR_SRC)) == GCN_ADDR_SRC)
+    {
+        if ((mode & GCN_NOSRC_2OFF) == GCN_NOSRC_2OFF)
+            // ds_read2
+            return is64Bit ? 16 : 8;
+        if ((mode & GCN_SRCS_MASK) == GCN_NOSRC)
+            // ds_read, ds_swizzle
+            return ((mode & (GCN_DS_96|GCN_DS_128)) != 0) ? 16 : (is64Bit ? 8 : 4);
+    }
+    if ((mode & GCN_SRCS_MASK) == GCN_2SRCS)
+        // two datas: ds_write2, ds_wrxchg2, ds_cmpst, ds_mskor
+        return is64Bit ? 20 : 12;
+    if ((mode & GCN_DS_128) != 0)
+        return 20;
+    if ((mode & GCN_DS_96) != 0)
+        return 16;
+    return is64Bit ? 12 : 8;
+}
+
+// get issue cycles for vector memory instruction
+static cxuint getVMEMCycles(cxbyte encoding, Flags mode)
+{
+    if ((mode & GCN_MATOMIC) != 0)
+        return ((mode & GCN_MCMPSWAP) == GCN_MCMPSWAP) ? 32 : 16;
+    bool isLoad, isStore;
+    if (encoding == GCNENC_FLAT)
+    {
+        isLoad = (mode & GCN_MASK1) == GCN_FLAT_NODATA;
+        isStore = (mode & GCN_MASK1) == GCN_FLAT_STORE;
+    }
+    else
+    {
+        isLoad = (mode & GCN_MLOAD) != 0;
+        isStore = !isLoad && (encoding == GCNENC_MIMG || (mode & GCN_MASK1) == 0);
+    }
+    if (isStore)
+        return 16;
+    if (isLoad && encoding != GCNENC_MIMG)
+        switch (mode & GCN_MUBUF_MX4)
+        {
+            case GCN_MUBUF_MX2:
+                return 18;
+            case GCN_MUBUF_MX3:
+            case GCN_MUBUF_MX4:
+                return 16;
+            default:
+                break;
+        }
+    return 8;
+}
+
+static void getGCNInstrTiming(const GCNInstruction* insn, cxuint instrSize,
+            GPUArchitecture arch, cxuint dpFactor, GCNInstrTiming& timing)
+{
+    timing = { 4, CYCQ_NONE, CYCQ_NONE, 0, false, false };
+    if (insn == nullptr)
+        return;
+    const Flags mode = insn->mode;
+    bool aluInstr = false;
+    switch(insn->encoding)
+    {
+        case GCNENC_SOPP:
+            if ((mode & GCN_MASK1) == GCN_IMM_LOCKS)
+                timing.isWait = true;
+            else if ((mode & GCN_MASK1) == GCN_IMM_REL)
+            {
+                if (insn->code == GCNSOPP_BRANCH)
+                    timing.issueCycles = 20;
+                else
+                    timing.isCondJump = true;
+            }
+            else if ((mode & GCN_MASK1) == GCN_IMM_MSGS)
+            {
+                timing.queue = CYCQ_LGKMCNT;
+                timing.latency = sendMsgLatency;
+            }
+            break;
+        case GCNENC_SOP1:
+            if (isSOP1ExecWrite(arch, insn->code))
+                timing.issueCycles = 8;
+            aluInstr = true;
+            break;
+        case GCNENC_SOPK:
+            // s_setreg_b32, s_setreg_imm32_b32
+            if ((mode & GCN_MASK1) == GCN_IMM_SREG && (mode & GCN_IMM_DST) != 0)
+                timing.issueCycles = 8;
+            aluInstr = true;
+            break;
+        case GCNENC_SOPC:
+        case GCNENC_SOP2:
+            aluInstr = true;
+            break;
+        case GCNENC_SMRD:
+            timing.issueCycles = ((mode & GCN_DSIZE_MASK) == GCN_MEMOP_MX16) ? 16 :
+                    (((mode & GCN_DSIZE_MASK) == GCN_MEMOP_MX8) ? 8 : 4);
+            timing.queue = CYCQ_LGKMCNT;
+            timing.latency = smemLatency;
+            break;
+        case GCNENC_VOPC:
+        case GCNENC_VOP1:
+        case GCNENC_VOP2:
+        case GCNENC_VOP3A:
+        case GCNENC_VOP3B:
+        case GCNENC_VOP3P:
+            timing.issueCycles = getVALUCycles(insn->mnemonic+2, mode, dpFactor);
+            aluInstr = true;
+            break;
+        case GCNENC_DS:
+            timing.issueCycles = getDSCycles(mode);
+            timing.queue = CYCQ_LGKMCNT;
+            timing.latency = ldsLatency;
+            break;
+        case GCNENC_MUBUF:
+        case GCNENC_MTBUF:
+        case GCNENC_MIMG:
+        case GCNENC_FLAT:
+            timing.issueCycles = getVMEMCycles(insn->encoding, mode);
+            timing.queue = CYCQ_VMCNT;
+            timing.latency = vmemLatency;
+            if (insn->encoding == GCNENC_FLAT &&
+                (mode & GCN_FLAT_MODEMASK) == GCN_FLAT_FLAT)
+                // FLAT instructions counts also lgkmcnt
+                timing.queue2 = CYCQ_LGKMCNT;
+            break;
+        case GCNENC_EXP:
+            timing.queue = CYCQ_EXPCNT;
+            timing.latency = expLatency;
+            break;
+        default:
+            break;
+    }
+    // 2-dword instructions may require 4 extra cycles (GCN 1.0/1.1)
+    if (aluInstr && instrSize == 8 && arch <= GPUArchitecture::GCN1_1 &&
+        timing.issueCycles < 8)
+        timing.issueCycles += 4;
+}
+
+// decode s_waitcnt immediate into counter values
+static void decodeWaitCnt(GPUArchitecture arch, uint32_t imm, cxuint* waits)
+{
+    waits[CYCQ_VMCNT] = imm&15;
+    if (arch >= GPUArchitecture::GCN1_4)
+        waits[CYCQ_VMCNT] |= (imm>>10)&0x30;
+    waits[CYCQ_EXPCNT] = (imm>>4)&7;
+    waits[CYCQ_LGKMCNT] = (imm>>8) & ((arch >= GPUArchitecture::GCN1_5) ? 63 : 15);
+}
+
+static cxuint getDPFactor(GPUDeviceType deviceType)
+{
+    if (deviceType == GPUDeviceType::TAHITI)
+        return 2;
+    if (deviceType == GPUDeviceType::HAWAII)
+        return 4;
+    if (getGPUArchitectureFromDeviceType(deviceType) == GPUArchitecture::GCN1_4_1)
+        return 1;
+    return 8;
+}
+
+// find code flow entries (jumps and ends) by walking through code
+static void findCodeFlowFromCode(GPUDeviceType deviceType, size_t codeSize,
+            const cxbyte* code, std::vector<AsmCodeFlowEntry>& codeFlow)
+{
+    const GPUArchitecture arch = getGPUArchitectureFromDeviceType(deviceType);
+    const uint32_t* codeWords = reinterpret_cast<const uint32_t*>(code);
+    const size_t codeWordsNum = codeSize>>2;
+    size_t pos = 0;
+    while (pos < codeWordsNum)
+    {
+        const size_t offset = pos<<2;
+        uint32_t insnCode = 0, insnCode2 = 0;
+        const GCNInstruction* insn = decodeGCNInstruction(deviceType, codeWordsNum,
+                    codeWords, pos, insnCode, insnCode2);
+        if (insn == nullptr)
+            continue;
+        if (insn->encoding == GCNENC_SOPP)
+        {
+            const size_t target = offset + 4 + (int64_t(int16_t(insnCode&0xffff))<<2);
+            if ((insn->mode & GCN_MASK1) == GCN_IMM_REL)
+            {
+                if (target < codeSize)
+                    codeFlow.push_back({ offset, target, insn->code == GCNSOPP_BRANCH ?
+                            AsmCodeFlowType::JUMP : AsmCodeFlowType::CJUMP });
+            }
+            else if (isSOPPEndPgm(insn->code))
+                // end of code is after s_endpgm (like in assembler)
+                codeFlow.push_back({ offset + 4, 0, AsmCodeFlowType::END });
+        }
+        else if (insn->encoding == GCNENC_SOP1 && isSOP1SetPC(arch, insn->code))
+            codeFlow.push_back({ offset, 0, AsmCodeFlowType::RETURN });
+    }
+}
+
+AsmCycleEstimator::AsmCycleEstimator(GPUDeviceType _deviceType)
+        : deviceType(_deviceType), criticalPathCycles(0)
+{ }
+
+void AsmCycleEstimator::estimate(Assembler& assembler,
+            const std::vector<AsmCodeFlowEntry>& codeFlow, size_t codeSize,
+            const cxbyte* code)
+{
+    AsmRegAllocator regAlloc(assembler);
+    regAlloc.createCodeStructure(codeFlow, codeSize, code);
+    estimateBlocks(regAlloc.getCodeBlocks(), codeSize, code);
+}
+
+void AsmCycleEstimator::estimate(size_t codeSize, const cxbyte* code)
+{
+    std::vector<AsmCodeFlowEntry> codeFlow;
+    findCodeFlowFromCode(deviceType, codeSize, code, codeFlow);
+    // code structure needs only an ISA assembler (to get instruction sizes)
+    std::istringstream emptyInput;
+    std::ostringstream msgStream;
+    Assembler assembler("", emptyInput, 0, BinaryFormat::RAWCODE, deviceType,
+                msgStream, msgStream);
+    assembler.createISAAssembler();
+    estimate(assembler, codeFlow, codeSize, code);
+}
+
+typedef std::deque<uint64_t> CycleQueue;
+
+// merge pending operations from two states (aligned to newest operation)
+static void mergeCycleQueue(CycleQueue& dest, const CycleQueue& src)
+{
+    if (dest.size() < src.size())
+        dest.insert(dest.begin(), src.size()-dest.size(), 0);
+    auto dit = dest.rbegin();
+    for (auto sit = src.rbegin(); sit != src.rend(); ++sit, ++dit)
+        *dit = std::max(*dit, *sit);
+}
+
+void AsmCycleEstimator::estimateBlocks(
+            const std::vector<AsmRegAllocator::CodeBlock>& codeBlocks,
+            size_t codeSize, const cxbyte* code)
+{
+    blockTimings.clear();
+    stallPoints.clear();
+    criticalPath.clear();
+    criticalPathCycles = 0;
+    if (codeBlocks.empty())
+        return;
+
+    const GPUArchitecture arch = getGPUArchitectureFromDeviceType(deviceType);
+    const cxuint dpFactor = getDPFactor(deviceType);
+    const uint32_t* codeWords = reinterpret_cast<const uint32_t*>(code);
+    const size_t codeWordsNum = codeSize>>2;
+    const size_t blocksNum = codeBlocks.size();
+
+    // pending operations (remaining cycles) at entry of blocks
+    std::vector<std::array<CycleQueue, CYCQ_MAX> > entryQueues(blocksNum);
+    std::vector<bool> endsWithCJump(blocksNum);
+    std::vector<std::vector<size_t> > prevBlocks(blocksNum);
+    blockTimings.resize(blocksNum);
+
+    for (size_t i = 0; i < blocksNum; i++)
+    {
+        const AsmRegAllocator::CodeBlock& cblock = codeBlocks[i];
+        AsmCodeBlockTiming& btiming = blockTimings[i];
+        btiming = { cblock.start, cblock.end, 0, 0, 0, 0, SIZE_MAX };
+
+        std::array<CycleQueue, CYCQ_MAX>& queues = entryQueues[i];
+        uint64_t curCycle = 0;
+        size_t pos = cblock.start>>2;
+        const size_t endPos = std::min(cblock.end>>2, codeWordsNum);
+        bool lastIsCondJump = false;
+        while (pos < endPos)
+        {
+            const size_t offset = pos<<2;
+            uint32_t insnCode = 0, insnCode2 = 0;
+            const GCNInstruction* insn = decodeGCNInstruction(deviceType, codeWordsNum,
+                        codeWords, pos, insnCode, insnCode2);
+            GCNInstrTiming timing;
+            getGCNInstrTiming(insn, (pos<<2)-offset, arch, dpFactor, timing);
+            btiming.instrsNum++;
+            lastIsCondJump = timing.isCondJump;
+
+            // remove finished operations
+            for (CycleQueue& queue: queues)
+                while (!queue.empty() && queue.front() <= curCycle)
+                    queue.pop_front();
+
+            if (timing.isWait)
+            {
+                cxuint waits[CYCQ_MAX];
+                decodeWaitCnt(arch, insnCode, waits);
+                uint64_t waitEnd = curCycle;
+                cxuint stallQueue = CYCQ_NONE;
+                for (cxuint q = 0; q < CYCQ_MAX; q++)
+                {
+                    CycleQueue& queue = queues[q];
+                    if (queue.size() <= waits[q])
+                        continue;
+                    // wait for all except last 'waits[q]' operations
+                    const uint64_t qend = queue[queue.size() - waits[q] - 1];
+                    if (qend > waitEnd)
+                    {
+                        waitEnd = qend;
+                        stallQueue = q;
+                    }
+                    queue.erase(queue.begin(), queue.end() - waits[q]);
+                }
+                if (stallQueue != CYCQ_NONE)
+                {
+                    const uint64_t stall = waitEnd - curCycle;
+                    stallPoints.push_back({ offset, uint32_t(stall), stallQueue });
+                    btiming.stallCycles += stall;
+                    curCycle = waitEnd;
+                }
+            }
+
+            curCycle += timing.issueCycles;
+            btiming.issueCycles += timing.issueCycles;
+            // push delayed operation (operations finish in order)
+            for (cxuint q: { timing.queue, timing.queue2 })
+                if (q != CYCQ_NONE)
+                {
+                    CycleQueue& queue = queues[q];
+                    uint64_t finish = curCycle + timing.latency;
+                    if (!queue.empty())
+                        finish = std::max(finish, queue.back());
+                    queue.push_back(finish);
+                }
+        }
+        endsWithCJump[i] = lastIsCondJump;
+
+        // find longest path to this block (only forward jumps)
+        uint64_t pathStart = 0;
+        for (size_t prev: prevBlocks[i])
+        {
+            const uint64_t prevCycles = blockTimings[prev].pathCycles +
+                    ((prev+1 != i && endsWithCJump[prev]) ? takenCJumpPenalty : 0);
+            if (btiming.pathPrev == SIZE_MAX || prevCycles > pathStart)
+            {
+                pathStart = prevCycles;
+                btiming.pathPrev = prev;
+            }
+        }
+        btiming.pathCycles = pathStart + curCycle;
+
+        // propagate pending operations to next blocks
+        std::vector<size_t> nexts;
+        for (const AsmRegAllocator::NextBlock& next: cblock.nexts)
+            nexts.push_back(next.block);
+        // fall-through to next block (not after end of code or return from routine)
+        if (((cblock.nexts.empty() && !cblock.haveEnd) || cblock.haveCalls) &&
+            !cblock.haveReturn)
+            nexts.push_back(i+1);
+        for (size_t next: nexts)
+        {
+            if (next <= i || next >= blocksNum)
+                continue; // ignore backward jumps
+            if (std::find(prevBlocks[next].begin(), prevBlocks[next].end(), i) !=
+                    prevBlocks[next].end())
+                continue;
+            prevBlocks[next].push_back(i);
+            for (cxuint q = 0; q < CYCQ_MAX; q++)
+            {
+                CycleQueue queue;
+                for (uint64_t finish: queues[q])
+                    if (finish > curCycle)
+                        queue.push_back(finish - curCycle);
+                mergeCycleQueue(entryQueues[next][q], queue);
+            }
+        }
+        // free pending operations of this block
+        for (CycleQueue& queue: queues)
+            CycleQueue().swap(queue);
+    }
+
+    // find critical path
+    size_t lastBlock = 0;
+    for (size_t i = 1; i < blocksNum; i++)
+        if (blockTimings[i].pathCycles > blockTimings[lastBlock].pathCycles)
+            lastBlock = i;
+    criticalPathCycles = blockTimings[lastBlock].pathCycles;
+    for (size_t b = lastBlock; b != SIZE_MAX; b = blockTimings[b].pathPrev)
+        criticalPath.push_back(b);
+    std::reverse(criticalPath.begin(), criticalPath.end());
+
+    std::stable_sort(stallPoints.begin(), stallPoints.end(),
+            [](const AsmStallPoint& s1, const AsmStallPoint& s2)
+            { return s1.offset < s2.offset; });
+}
+
+static void printHexOffset(std::ostream& os, size_t offset)
+{
+    char buf[24];
+    buf[itocstrCStyle(uint64_t(offset), buf, 24, 16, 4)] = 0;
+    os << buf;
+}
+
+void AsmCycleEstimator::printReport(std::ostream& os, const char* linePrefix,
+            size_t startOffset) const
+{
+    os << linePrefix << "Estimated cycles (" << getGPUDeviceTypeName(deviceType) <<
+            "):\n";
+    auto stallIt = stallPoints.begin();
+    for (const AsmCodeBlockTiming& btiming: blockTimings)
+    {
+        os << linePrefix << "  block ";
+        printHexOffset(os, startOffset + btiming.start);
+        os << '-';
+        printHexOffset(os, startOffset + btiming.end);
+        os << ": instrs=" << btiming.instrsNum << ", issue=" << btiming.issueCycles <<
+            ", stall=" << btiming.stallCycles << ", path=" << btiming.pathCycles << '\n';
+        for (; stallIt != stallPoints.end() && stallIt->offset < btiming.end; ++stallIt)
+        {
+            os << linePrefix << "    stall at ";
+            printHexOffset(os, startOffset + stallIt->offset);
+            os << ": " << stallIt->cycles << " cycles (" <<
+                    cycleQueueNames[stallIt->queue] << ")\n";
+        }
+    }
+    if (criticalPath.empty())
+        return;
+    os << linePrefix << "  critical path:";
+    for (size_t b: criticalPath)
+    {
+        os << ' ';
+        printHexOffset(os, startOffset + blockTimings[b].start);
+    }
+    os << ", cycles=" << criticalPathCycles << '\n';
+}
@@ -73,7 +73,7 @@ void ISAUsageHandler::pushUsage(const AsmRegVarUsage& rvu)
                 uint16_t(rvu.offset & 0xffffU) });
 }
 
-AsmRegVarUsage ISAUsageHandler::nextUsage(ReadPos& readPos)
+AsmRegVarUsage ISAUsageHandler::nextUsage(ReadPos& readPos) const
 {
     const Chunk& chunk = chunks[readPos.chunkPos];
     const RegVarUsageInt& item = chunk.items[readPos.itemPos];
@@ -142,12 +142,14 @@ ISALinearDepHandler* ISALinearDepHandler::copy() const
  * Asm register allocator stuff
  */
 
-AsmRegAllocator::AsmRegAllocator(Assembler& _assembler) : assembler(_assembler)
+AsmRegAllocator::AsmRegAllocator(Assembler& _assembler) : assembler(_assembler),
+        regTypesNum(0), threadsNum(1)
 { }
 
 AsmRegAllocator::AsmRegAllocator(Assembler& _assembler,
         const std::vector<CodeBlock>& _codeBlocks, const SSAReplacesMap& _ssaReplacesMap)
-        : assembler(_assembler), codeBlocks(_codeBlocks), ssaReplacesMap(_ssaReplacesMap)
+        : assembler(_assembler), codeBlocks(_codeBlocks), ssaReplacesMap(_ssaReplacesMap),
+          regTypesNum(0), threadsNum(1)
 { }
 
 static inline bool codeBlockStartLess(const AsmRegAllocator::CodeBlock& c1,
@@ -241,9 +243,13 @@ void AsmRegAllocator::createCodeStructure(const std::vector<AsmCodeFlowEntry>& c
                 codeStarts.begin());
     // divide to blocks
     splitIt = splits.begin();
+    size_t prevCodeEnd = 0;
     for (size_t codeStart: codeStarts)
     {
+        if (codeStart < prevCodeEnd)
+            continue; // skip codeStart already divided in previous code
         size_t codeEnd = *std::upper_bound(codeEnds.begin(), codeEnds.end(), codeStart);
+        prevCodeEnd = codeEnd;
         splitIt = std::lower_bound(splitIt, splits.end(), codeStart);
         
         if (splitIt != splits.end() && *splitIt==codeStart)
@@ -252,9 +258,10 @@ void AsmRegAllocator::createCodeStructure(const std::vector<AsmCodeFlowEntry>& c
         for (size_t start = codeStart; start < codeEnd; )
         {
             size_t end = codeEnd;
-            if (splitIt != splits.end())
+            // do not consume split after end of this code
+            if (splitIt != splits.end() && *splitIt < codeEnd)
             {
-                end = std::min(end, *splitIt);
+                end = *splitIt;
                 ++splitIt;
             }
             codeBlocks.push_back({ start, end, { }, false, false, false });
@@ -569,11 +576,11 @@ void AsmRegAllocator::applySSAReplaces()
 
 void AsmRegAllocator::createInterferenceGraph()
 {
-    /// construct liveBlockMaps
-    std::set<LiveBlock> liveBlockMaps[MAX_REGTYPES_NUM];
-    for (size_t regType = 0; regType < regTypesNum; regType++)
+    // register types have separate livenesses and graphs: build them in parallel
+    parallelForEach(regTypesNum, threadsNum, [this](size_t regType)
     {
-        std::set<LiveBlock>& liveBlockMap = liveBlockMaps[regType];
+        /// construct liveBlockMap
+        std::set<LiveBlock> liveBlockMap;
         Array<OutLiveness>& liveness = outLivenesses[regType];
         for (size_t li = 0; li < liveness.size(); li++)
         {
@@ -584,45 +591,26 @@ void AsmRegAllocator::createInterferenceGraph()
             lv.clear();
         }
         liveness.clear();
-    }
-    
-    // create interference graphs
-    for (size_t regType = 0; regType < regTypesNum; regType++)
-    {
+        
+        // create interference graph: sweep live blocks sorted by start,
+        // every live block interferes with all active live blocks
         InterGraph& interGraph = interGraphs[regType];
         interGraph.resize(graphVregsCounts[regType]);
-        std::set<LiveBlock>& liveBlockMap = liveBlockMaps[regType];
-        
-        auto lit = liveBlockMap.begin();
-        size_t rangeStart = 0;
-        if (lit != liveBlockMap.end())
-            rangeStart = lit->start;
-        while (lit != liveBlockMap.end())
+        // active live blocks: key - end, value - vidx
+        std::multimap<size_t, size_t> activeBlocks;
+        for (const LiveBlock& blk: liveBlockMap)
         {
-            const size_t blkStart = lit->start;
-            const size_t blkEnd = lit->end;
-            size_t rangeEnd = blkEnd;
-            auto liStart = liveBlockMap.lower_bound({ rangeStart, 0, 0 });
-            auto liEnd = liveBlockMap.lower_bound({ rangeEnd, 0, 0 });
-            // collect from this range, variable indices
-            std::set<size_t> varIndices;
-            for (auto lit2 = liStart; lit2 != liEnd; ++lit2)
-                varIndices.insert(lit2->vidx);
-            // push to intergraph as full subgGraph
-            for (auto vit = varIndices.begin(); vit != varIndices.end(); ++vit)
-                for (auto vit2 = varIndices.begin(); vit2 != varIndices.end(); ++vit2)
-                    if (vit != vit2)
-                        interGraph[*vit].insert(*vit2);
-            // go to next live blocks
-            rangeStart = rangeEnd;
-            for (; lit != liveBlockMap.end(); ++lit)
-                if (lit->start != blkStart && lit->end != blkEnd)
-                    break;
-            if (lit == liveBlockMap.end())
-                break; // 
-            rangeStart = std::max(rangeStart, lit->start);
+            activeBlocks.erase(activeBlocks.begin(),
+                        activeBlocks.upper_bound(blk.start));
+            for (const auto& active: activeBlocks)
+                if (active.second != blk.vidx)
+                {
+                    interGraph[blk.vidx].insert(active.second);
+                    interGraph[active.second].insert(blk.vidx);
+                }
+            activeBlocks.insert(std::make_pair(blk.end, blk.vidx));
         }
-    }
+    });
 }
 
 /* algorithm to allocate regranges:
@@ -638,8 +626,11 @@ void AsmRegAllocator::colorInterferenceGraph()
 {
     const GPUArchitecture arch = getGPUArchitectureFromDeviceType(
                     assembler.deviceType);
+    cxuint regRanges[MAX_REGTYPES_NUM*2];
+    assembler.isaAssembler->getRegisterRanges(regTypesNum, regRanges);
     
-    for (size_t regType = 0; regType < regTypesNum; regType++)
+    // every register type is colored independently
+    parallelForEach(regTypesNum, threadsNum, [this, arch, &regRanges](size_t regType)
     {
         const size_t maxColorsNum = getGPUMaxRegistersNum(arch, regType);
         InterGraph& interGraph = interGraphs[regType];
@@ -652,25 +643,27 @@ void AsmRegAllocator::colorInterferenceGraph()
         Array<size_t> sdoCounts(nodesNum);
         std::fill(sdoCounts.begin(), sdoCounts.end(), 0);
         
+        // firstly, allocate real registers: their colors are their register indices
+        for (const auto& entry: vregIndexMap)
+            if (entry.first.regVar == nullptr)
+                gcMap[entry.second[0]] = entry.first.index - regRanges[2*regType];
+        
+        // nodeSet holds only uncolored nodes, because SDO (set key) of colored
+        // nodes can be changed while they are not erased from nodeSet
         SDOLDOCompare compare(interGraph, sdoCounts);
         std::set<size_t, SDOLDOCompare> nodeSet(compare);
         for (size_t i = 0; i < nodesNum; i++)
-            nodeSet.insert(i);
+            if (gcMap[i] == UINT_MAX)
+                nodeSet.insert(i);
         
-        cxuint colorsNum = 0;
-        // firstly, allocate real registers
-        for (const auto& entry: vregIndexMap)
-            if (entry.first.regVar == nullptr)
-                gcMap[entry.second[0]] = colorsNum++;
-        
-        for (size_t colored = 0; colored < nodesNum; colored++)
+        while (!nodeSet.empty())
         {
+            // take node from set before changing its SDO (set key)
             size_t node = *nodeSet.begin();
-            if (gcMap[node] != UINT_MAX)
-                continue; // already colored
+            nodeSet.erase(nodeSet.begin());
             size_t color = 0;
             
-            for (color = 0; color <= colorsNum; color++)
+            for (color = 0; color < maxColorsNum; color++)
             {
                 // find first usable color
                 bool thisSame = false;
@@ -683,12 +676,8 @@ void AsmRegAllocator::colorInterferenceGraph()
                 if (!thisSame)
                     break;
             }
-            if (color==colorsNum) // add new color if needed
-            {
-                if (colorsNum >= maxColorsNum)
-                    throw AsmException("Too many register is needed");
-                colorsNum++;
-            }
+            if (color == maxColorsNum)
+                throw AsmException("Too many register is needed");
             
             gcMap[node] = color;
             // update SDO for node
@@ -723,13 +712,14 @@ void AsmRegAllocator::colorInterferenceGraph()
             
             gcMap[node] = color;
         }
-    }
+    });
 }
 
 void AsmRegAllocator::allocateRegisters(AsmSectionId sectionId)
 {
     // before any operation, clear all
     codeBlocks.clear();
+    codeRegions.clear();
     for (size_t i = 0; i < MAX_REGTYPES_NUM; i++)
     {
         graphVregsCounts[i] = 0;
@@ -461,11 +461,14 @@ struct CLRX_INTERNAL SDOLDOCompare
         : interGraph(_interGraph), sdoCounts(_sdoCounts)
     { }
     
+    // greater SDO first, then greater degree, then lower node index
     bool operator()(size_t a, size_t b) const
     {
-        if (sdoCounts[a] > sdoCounts[b])
-            return true;
-        return interGraph[a].size() > interGraph[b].size();
+        if (sdoCounts[a] != sdoCounts[b])
+            return sdoCounts[a] > sdoCounts[b];
+        if (interGraph[a].size() != interGraph[b].size())
+            return interGraph[a].size() > interGraph[b].size();
+        return a < b;
     }
 };
 
@@ -74,6 +74,16 @@ static cxuint getRegType(size_t regTypesNum, const cxuint* regRanges,
     return regType;
 }
 
+// get SSA vidxes of register, throw exception if register have not been indexed
+static const std::vector<size_t>& getSVRegVIdxes(const VarIndexMap& vregIndexMap,
+            const AsmSingleVReg& svreg)
+{
+    auto it = vregIndexMap.find(svreg);
+    if (it == vregIndexMap.end())
+        throw AsmException("Internal error: Register without SSA indices");
+    return it->second;
+}
+
 static void getVIdx(const AsmSingleVReg& svreg, size_t ssaIdIdx,
         const AsmRegAllocator::SSAInfo& ssaInfo, LivenessState& ls,
         cxuint& regType, size_t& vidx)
@@ -91,8 +101,8 @@ static void getVIdx(const AsmSingleVReg& svreg, size_t ssaIdIdx,
         ssaId = ssaInfo.ssaIdLast;
     
     regType = getRegType(ls.regTypesNum, ls.regRanges, svreg); // regtype
-    const VarIndexMap& vregIndexMap = ls.vregIndexMaps[regType];
-    const std::vector<size_t>& vidxes = vregIndexMap.find(svreg)->second;
+    const std::vector<size_t>& vidxes = getSVRegVIdxes(
+                ls.vregIndexMaps[regType], svreg);
     /*ARDOut << "lvn[" << regType << "][" << vidxes[ssaId] << "]. ssaIdIdx: " <<
             ssaIdIdx << ". ssaId: " << ssaId << ". svreg: " << svreg.regVar << ":" <<
             svreg.index << "\n";*/
@@ -113,8 +123,8 @@ static void getVIdx2(const AsmSingleVReg& svreg, size_t ssaId, LivenessState& ls
         cxuint& regType, size_t& vidx)
 {
     regType = getRegType(ls.regTypesNum, ls.regRanges, svreg); // regtype
-    const VarIndexMap& vregIndexMap = ls.vregIndexMaps[regType];
-    const std::vector<size_t>& vidxes = vregIndexMap.find(svreg)->second;
+    const std::vector<size_t>& vidxes = getSVRegVIdxes(
+                ls.vregIndexMaps[regType], svreg);
     /*ARDOut << "lvn[" << regType << "][" << vidxes[ssaId] << "]. ssaId: " <<
             ssaId << ". svreg: " << svreg.regVar << ":" << svreg.index << "\n";*/
     vidx = vidxes[ssaId];
@@ -1037,9 +1047,8 @@ static void createRoutineDataLv(LivenessState& ls, RoutineDataLv& rdata,
                     const SSAInfo& sinfo = sentry.second;
                     const AsmSingleVReg& svreg = sentry.first;
                     cxuint regType = getRegType(ls.regTypesNum, ls.regRanges, svreg);
-                    const VarIndexMap& vregIndexMap = ls.vregIndexMaps[regType];
-                    const std::vector<size_t>& vidxes =
-                                vregIndexMap.find(svreg)->second;
+                    const std::vector<size_t>& vidxes = getSVRegVIdxes(
+                                ls.vregIndexMaps[regType], svreg);
                     
                     // add SSA indices to allSSAs
                     if (sinfo.readBeforeWrite)
@@ -1198,6 +1207,334 @@ static inline void revertLastSVReg(LastVRegMap& lastVRegMap, const AsmSingleVReg
     }
 }
 
+/* create livenesses inside single code block (from usages and linear deps).
+ * returns number of failed linear dependencies */
+static size_t createBlockLivenesses(LivenessState& ls, CodeBlock& cblock,
+            const ISAUsageHandler& usageHandler,
+            const ISALinearDepHandler& linDepHandler, LinearDepMap* linearDepMaps)
+{
+    size_t failedLinearDeps = 0;
+    const size_t linearDepSize = linDepHandler.size();
+    SVRegMap ssaIdIdxMap;
+    std::vector<AsmRegVarUsage> instrRVUs;
+    
+    std::vector<AsmSingleVReg> readSVRegs;
+    std::vector<AsmSingleVReg> writtenSVRegs;
+    
+    ISAUsageHandler::ReadPos usagePos = cblock.usagePos;
+    size_t oldOffset = usageHandler.hasNext(usagePos) ?
+            cblock.start : cblock.end;
+    
+    size_t linearDepPos = linDepHandler.findPositionByOffset(cblock.start);
+    
+    // register in liveness
+    bool rvuFirst = true;
+    while (true)
+    {
+        AsmRegVarUsage rvu = { 0U, nullptr, 0U, 0U };
+        bool hasNext = false;
+        if (usageHandler.hasNext(usagePos) && oldOffset < cblock.end)
+        {
+            hasNext = true;
+            rvu = usageHandler.nextUsage(usagePos);
+            if (rvuFirst)
+            {
+                oldOffset = rvu.offset;
+                rvuFirst = false;
+            }
+        }
+        const size_t liveTime = oldOffset;
+        if ((!hasNext || rvu.offset > oldOffset) && oldOffset < cblock.end)
+        {
+            ARDOut << "apply to liveness. offset: " << oldOffset << "\n";
+            // apply to liveness
+            for (AsmSingleVReg svreg: readSVRegs)
+            {
+                auto svrres = ssaIdIdxMap.insert({ svreg, 0 });
+                Liveness& lv = getLiveness(svreg, svrres.first->second,
+                        binaryMapFind(cblock.ssaInfoMap.begin(),
+                            cblock.ssaInfoMap.end(), svreg)->second, ls);
+                if (svrres.second)
+                    // begin region from this block
+                    lv.insert(cblock.start, liveTime+1);
+                else
+                    lv.expand(liveTime+1);
+            }
+            for (AsmSingleVReg svreg: writtenSVRegs)
+            {
+                size_t& ssaIdIdx = ssaIdIdxMap[svreg];
+                if (svreg.regVar != nullptr)
+                    ssaIdIdx++;
+                SSAInfo& sinfo = binaryMapFind(cblock.ssaInfoMap.begin(),
+                            cblock.ssaInfoMap.end(), svreg)->second;
+                Liveness& lv = getLiveness(svreg, ssaIdIdx, sinfo, ls);
+                // works only with ISA where smallest instruction have 2 bytes!
+                // after previous read, but not after instruction.
+                // if var is not used anywhere then this liveness region
+                // blocks assignment for other vars
+                lv.insert(liveTime+1, liveTime+2);
+            }
+            
+            // collecting linear deps for instruction
+            std::vector<AsmRegVarLinearDep> instrLinDeps;
+            AsmRegVarLinearDep linDep = { 0, nullptr, 0, 0 };
+            bool haveLdep = false;
+            if (oldOffset == 0 && linearDepPos < linearDepSize)
+            {
+                // special case: if offset is zero, force get linear dep
+                linDep = linDepHandler.getLinearDep(linearDepPos++);
+                haveLdep = true;
+            }
+            while (linDep.offset < oldOffset && linearDepPos < linearDepSize)
+            {
+                linDep = linDepHandler.getLinearDep(linearDepPos++);
+                haveLdep = true;
+            }
+            // if found
+            if (haveLdep)
+                while (linDep.offset == oldOffset)
+                {
+                    // just put
+                    instrLinDeps.push_back(linDep);
+                    if (linearDepPos < linearDepSize)
+                        linDep = linDepHandler.getLinearDep(linearDepPos++);
+                    else // no data
+                        break;
+                }
+            // get linear deps and equal to
+            cxbyte lDeps[16];
+            usageHandler.getUsageDependencies(instrRVUs.size(),
+                        instrRVUs.data(), lDeps);
+            
+            if (!addUsageDeps(lDeps, instrRVUs, instrLinDeps, linearDepMaps,
+                    cblock.ssaInfoMap, ssaIdIdxMap,
+                    readSVRegs, writtenSVRegs, ls))
+                failedLinearDeps++;
+            
+            readSVRegs.clear();
+            writtenSVRegs.clear();
+            if (!hasNext)
+                break;
+            oldOffset = rvu.offset;
+            instrRVUs.clear();
+        }
+        if (hasNext && oldOffset < cblock.end && !rvu.useRegMode)
+            instrRVUs.push_back(rvu);
+        if (oldOffset >= cblock.end)
+            break;
+        
+        for (uint16_t rindex = rvu.rstart; rindex < rvu.rend; rindex++)
+        {
+            // per register/singlvreg
+            AsmSingleVReg svreg{ rvu.regVar, rindex };
+            if (checkWriteWithSSA(rvu))
+                writtenSVRegs.push_back(svreg);
+            else // read or treat as reading // expand previous region
+                readSVRegs.push_back(svreg);
+        }
+    }
+    return failedLinearDeps;
+}
+
+/* liveness by the iterative bit-vector dataflow (backward) over code blocks.
+ * dense bitsets are indexed by global vidx (vidxes of next register type follow
+ * vidxes of previous register type). Cross-block livenesses are put after
+ * finding fixed point. This method works only for code without calls. */
+
+static void setLvBit(std::vector<uint64_t>& bits, size_t wordsOffset, size_t index)
+{ bits[wordsOffset + (index>>6)] |= uint64_t(1)<<(index&63); }
+
+static size_t createLivenessesByDataflow(LivenessState& ls,
+            std::vector<CodeBlock>& codeBlocks, const ISAUsageHandler& usageHandler,
+            const ISALinearDepHandler& linDepHandler, LinearDepMap* linearDepMaps,
+            const std::vector<std::vector<size_t> >& codeRegions, cxuint threadsNum)
+{
+    const size_t blocksNum = codeBlocks.size();
+    size_t vidxOffsets[MAX_REGTYPES_NUM+1];
+    vidxOffsets[0] = 0;
+    for (size_t i = 0; i < ls.regTypesNum; i++)
+        vidxOffsets[i+1] = vidxOffsets[i] + ls.livenesses[i].size();
+    const size_t totalVidxes = vidxOffsets[ls.regTypesNum];
+    const size_t wordsNum = (totalVidxes+63)>>6;
+    
+    // svreg for every global vidx
+    std::vector<AsmSingleVReg> vidxSVRegs(totalVidxes);
+    for (size_t i = 0; i < ls.regTypesNum; i++)
+        for (const auto& entry: ls.vregIndexMaps[i])
+            for (size_t vidx: entry.second)
+                if (vidx != SIZE_MAX)
+                    vidxSVRegs[vidxOffsets[i] + vidx] = entry.first;
+    
+    // get reachable code blocks in visiting order (same as in path walking)
+    // for every code region (from its entry blocks)
+    std::vector<std::vector<size_t> > succs(blocksNum);
+    std::vector<std::vector<size_t> > preds(blocksNum);
+    std::vector<size_t> blockOrder;
+    // start of code region in blockOrder
+    std::vector<size_t> regionStarts;
+    std::vector<bool> visited(blocksNum, false);
+    std::deque<FlowStackEntry2> flowStack;
+    for (const std::vector<size_t>& entryBlocks: codeRegions)
+    {
+        regionStarts.push_back(blockOrder.size());
+        for (size_t entryBlock: entryBlocks)
+        {
+            flowStack.push_back({ entryBlock, 0 });
+            visited[entryBlock] = true;
+            blockOrder.push_back(entryBlock);
+            while (!flowStack.empty())
+            {
+                FlowStackEntry2& entry = flowStack.back();
+                const CodeBlock& cblock = codeBlocks[entry.blockIndex];
+                size_t nextBlock = SIZE_MAX;
+                if (entry.nextIndex < cblock.nexts.size())
+                    nextBlock = cblock.nexts[entry.nextIndex].block;
+                else if (entry.nextIndex==0 && cblock.nexts.empty() &&
+                        !cblock.haveReturn && !cblock.haveEnd &&
+                        entry.blockIndex+1 < blocksNum)
+                    nextBlock = entry.blockIndex+1;
+                
+                if (nextBlock != SIZE_MAX)
+                {
+                    entry.nextIndex++;
+                    succs[entry.blockIndex].push_back(nextBlock);
+                    preds[nextBlock].push_back(entry.blockIndex);
+                    if (!visited[nextBlock])
+                    {
+                        visited[nextBlock] = true;
+                        blockOrder.push_back(nextBlock);
+                        flowStack.push_back({ nextBlock, 0 });
+                    }
+                }
+                else
+                    flowStack.pop_back();
+            }
+        }
+    }
+    regionStarts.push_back(blockOrder.size());
+    
+    size_t failedLinearDeps = 0;
+    // livenesses inside code blocks
+    for (size_t bi: blockOrder)
+        failedLinearDeps += createBlockLivenesses(ls, codeBlocks[bi],
+                        usageHandler, linDepHandler, linearDepMaps);
+    
+    // use (read before write) and kill (write) sets.
+    // every code block fills own rows, hence blocks can be processed in parallel
+    std::vector<uint64_t> useBits(blocksNum*wordsNum, 0);
+    std::vector<uint64_t> killBits(blocksNum*wordsNum, 0);
+    parallelForEach(blockOrder.size(), threadsNum, [&](size_t oi)
+    {
+        const size_t bi = blockOrder[oi];
+        for (const auto& entry: codeBlocks[bi].ssaInfoMap)
+        {
+            const SSAInfo& sinfo = entry.second;
+            const cxuint regType = getRegType(ls.regTypesNum, ls.regRanges,
+                            entry.first);
+            const std::vector<size_t>& vidxes = getSVRegVIdxes(
+                        ls.vregIndexMaps[regType], entry.first);
+            const size_t vidxOffset = vidxOffsets[regType];
+            if (!sinfo.readBeforeWrite || sinfo.ssaIdChange!=0)
+                for (size_t vidx: vidxes)
+                    if (vidx != SIZE_MAX)
+                        setLvBit(killBits, bi*wordsNum, vidxOffset + vidx);
+            if (sinfo.readBeforeWrite)
+            {
+                const size_t ssaId = entry.first.regVar!=nullptr ? sinfo.ssaIdBefore : 0;
+                setLvBit(useBits, bi*wordsNum, vidxOffset + vidxes[ssaId]);
+            }
+        }
+    });
+    
+    // main dataflow loop: liveIn = use | (liveOut & ~kill)
+    // code regions have no common edges, hence they are solved in parallel
+    // (every region fills only rows of own code blocks)
+    std::vector<uint64_t> liveInBits(blocksNum*wordsNum, 0);
+    std::vector<uint64_t> liveOutBits(blocksNum*wordsNum, 0);
+    // bytes instead bits, because regions are updated concurrently
+    std::vector<cxbyte> inWorklist(blocksNum, 0);
+    parallelForEach(codeRegions.size(), threadsNum, [&](size_t r)
+    {
+        std::vector<size_t> worklist(blockOrder.begin() + regionStarts[r],
+                    blockOrder.begin() + regionStarts[r+1]);
+        for (size_t bi: worklist)
+            inWorklist[bi] = 1;
+        while (!worklist.empty())
+        {
+            const size_t bi = worklist.back();
+            worklist.pop_back();
+            inWorklist[bi] = 0;
+            uint64_t* liveOut = liveOutBits.data() + bi*wordsNum;
+            uint64_t* liveIn = liveInBits.data() + bi*wordsNum;
+            const uint64_t* use = useBits.data() + bi*wordsNum;
+            const uint64_t* kill = killBits.data() + bi*wordsNum;
+            for (size_t succ: succs[bi])
+            {
+                const uint64_t* succLiveIn = liveInBits.data() + succ*wordsNum;
+                for (size_t k = 0; k < wordsNum; k++)
+                    liveOut[k] |= succLiveIn[k];
+            }
+            bool changed = false;
+            for (size_t k = 0; k < wordsNum; k++)
+            {
+                const uint64_t newIn = use[k] | (liveOut[k] & ~kill[k]);
+                changed |= (newIn != liveIn[k]);
+                liveIn[k] = newIn;
+            }
+            if (changed)
+                for (size_t pred: preds[bi])
+                    if (!inWorklist[pred])
+                    {
+                        inWorklist[pred] = 1;
+                        worklist.push_back(pred);
+                    }
+        }
+    });
+    
+    // materialize cross-block livenesses: from last access (or block start)
+    // to end of block for all vidxes live at end of block
+    for (size_t bi: blockOrder)
+    {
+        const CodeBlock& cblock = codeBlocks[bi];
+        const uint64_t* liveOut = liveOutBits.data() + bi*wordsNum;
+        for (size_t k = 0; k < wordsNum; k++)
+            for (uint64_t word = liveOut[k]; word != 0; word &= word-1)
+            {
+                const size_t gvidx = (k<<6) + CTZ64(word);
+                const cxuint regType = std::upper_bound(vidxOffsets,
+                        vidxOffsets + ls.regTypesNum + 1, gvidx) - vidxOffsets - 1;
+                const AsmSingleVReg& svreg = vidxSVRegs[gvidx];
+                auto sinfoIt = binaryMapFind(cblock.ssaInfoMap.begin(),
+                            cblock.ssaInfoMap.end(), svreg);
+                const size_t start = (sinfoIt != cblock.ssaInfoMap.end()) ?
+                            sinfoIt->second.lastPos+1 : cblock.start;
+                ls.livenesses[regType][gvidx - vidxOffsets[regType]].insert(
+                            start, cblock.end);
+            }
+    }
+    return failedLinearDeps;
+}
+
+// move livenesses to AsmRegAllocator outLivenesses
+static void moveOutLivenesses(size_t regTypesNum, std::vector<Liveness>* livenesses,
+            Array<AsmRegAllocator::OutLiveness>* outLivenesses)
+{
+    for (size_t regType = 0; regType < regTypesNum; regType++)
+    {
+        std::vector<Liveness>& livenesses2 = livenesses[regType];
+        Array<AsmRegAllocator::OutLiveness>& outLivenesses2 = outLivenesses[regType];
+        outLivenesses2.resize(livenesses2.size());
+        for (size_t li = 0; li < livenesses2.size(); li++)
+        {
+            outLivenesses2[li].resize(livenesses2[li].l.size());
+            std::copy(livenesses2[li].l.begin(), livenesses2[li].l.end(),
+                      outLivenesses2[li].begin());
+            livenesses2[li].clear();
+        }
+        livenesses2.clear();
+    }
+}
+
 void AsmRegAllocator::createLivenesses(ISAUsageHandler& usageHandler,
                 ISALinearDepHandler& linDepHandler)
 {
@@ -1205,7 +1542,7 @@ void AsmRegAllocator::createLivenesses(ISAUsageHandler& usageHandler,
     // construct var index maps
     cxuint regRanges[MAX_REGTYPES_NUM*2];
     std::fill(graphVregsCounts, graphVregsCounts+MAX_REGTYPES_NUM, size_t(0));
-    size_t regTypesNum;
+    // register types number is used later by interference graph and coloring
     assembler.isaAssembler->getRegisterRanges(regTypesNum, regRanges);
     
     for (const CodeBlock& cblock: codeBlocks)
@@ -1281,281 +1618,225 @@ void AsmRegAllocator::createLivenesses(ISAUsageHandler& usageHandler,
     for (size_t i = 0; i < regTypesNum; i++)
         livenesses[i].resize(graphVregsCounts[i]);
     
-    // callLiveTime - call live time where routine will be called
-    // reverse counted, begin from SIZE_MAX, used for joining svreg from routines
-    // and svreg used in this time
-    size_t curLiveTime = 0;
-    flowStack.push_back({ 0, 0 });
+    // code regions created by createSSAData (or single region from first block)
+    const std::vector<std::vector<size_t> > firstCodeRegion{ { 0 } };
+    const std::vector<std::vector<size_t> >& regions = !codeRegions.empty() ?
+                codeRegions : firstCodeRegion;
     
     // structure to pass many arguments in compact pack
     LivenessState ls = { flowStack, codeBlocks, waysToCache, cblocksToCache,
         prevWaysIndexMap, livenesses, vregIndexMaps, vidxCallMap, vidxRoutineMap,
         routineMap, regTypesNum, regRanges };
     
-    const size_t linearDepSize = linDepHandler.size();
+    bool haveCalls = false;
+    for (const CodeBlock& cblock: codeBlocks)
+        if (cblock.haveCalls || cblock.haveReturn)
+        {
+            haveCalls = true;
+            break;
+        }
+    /* code without routines: just use bit-vector dataflow.
+     * code with calls or returns still uses path walking, because
+     * the dataflow does not collect per routine and per call point sets
+     * (vidxRoutineMap and vidxCallMap) required by routine handling */
+    if (!haveCalls)
+    {
+        const size_t failedLinearDeps = createLivenessesByDataflow(ls, codeBlocks,
+                    usageHandler, linDepHandler, linearDepMaps, regions, threadsNum);
+        for (size_t i = 0; i < failedLinearDeps; i++)
+            assembler.printError(nullptr, "Linear deps failed");
+        moveOutLivenesses(regTypesNum, livenesses, outLivenesses);
+        return;
+    }
     
-    while (!flowStack.empty())
+    // code regions are walked one by one, because they can share livenesses
+    // of registers and routine data maps
+    std::vector<size_t> entryBlocks;
+    for (const std::vector<size_t>& regionEntries: regions)
+        entryBlocks.insert(entryBlocks.end(), regionEntries.begin(), regionEntries.end());
+    
+    for (size_t entryBlock: entryBlocks)
     {
-        FlowStackEntry3& entry = flowStack.back();
-        CodeBlock& cblock = codeBlocks[entry.blockIndex.index];
+        flowStack.push_back({ entryBlock, 0 });
+        lastCommonCacheWayPoint = { SIZE_MAX, SIZE_MAX };
         
-        if (entry.nextIndex == 0)
+        while (!flowStack.empty())
         {
-            curLiveTime = cblock.start;
-            // process current block
-            if (!visited[entry.blockIndex])
+            FlowStackEntry3& entry = flowStack.back();
+            CodeBlock& cblock = codeBlocks[entry.blockIndex.index];
+        
+            if (entry.nextIndex == 0)
             {
-                visited[entry.blockIndex] = true;
-                ARDOut << "joinpush: " << entry.blockIndex << "\n";
-                if (flowStack.size() > 1)
-                    putCrossBlockLivenesses(ls, lastVRegMap);
-                // update last vreg position
-                for (const auto& sentry: cblock.ssaInfoMap)
+                // process current block
+                if (!visited[entry.blockIndex])
                 {
-                    // update
-                    auto res = lastVRegMap.insert({ sentry.first,
-                                { { flowStack.size()-1, false } } });
-                    if (!res.second) // if not first seen, just update
-                        // update last
-                        res.first->second.push_back({ flowStack.size()-1, false });
+                    visited[entry.blockIndex] = true;
+                    ARDOut << "joinpush: " << entry.blockIndex << "\n";
+                    if (flowStack.size() > 1)
+                        putCrossBlockLivenesses(ls, lastVRegMap);
+                    // update last vreg position
+                    for (const auto& sentry: cblock.ssaInfoMap)
+                    {
+                        // update
+                        auto res = lastVRegMap.insert({ sentry.first,
+                                    { { flowStack.size()-1, false } } });
+                        if (!res.second) // if not first seen, just update
+                            // update last
+                            res.first->second.push_back({ flowStack.size()-1, false });
                     
-                    // count read before writes (for cache weight)
-                    if (sentry.second.readBeforeWrite)
-                        rbwCount++;
-                    if (sentry.second.ssaIdChange!=0)
-                        wrCount++;
-                }
-                
-                // main routine to handle ssaInfos
-                SVRegMap ssaIdIdxMap;
-                std::vector<AsmRegVarUsage> instrRVUs;
-                
-                std::vector<AsmSingleVReg> readSVRegs;
-                std::vector<AsmSingleVReg> writtenSVRegs;
+                        // count read before writes (for cache weight)
+                        if (sentry.second.readBeforeWrite)
+                            rbwCount++;
+                        if (sentry.second.ssaIdChange!=0)
+                            wrCount++;
+                    }
                 
-                ISAUsageHandler::ReadPos usagePos = cblock.usagePos;
-                size_t oldOffset = usageHandler.hasNext(usagePos) ?
-                        cblock.start : cblock.end;
+                    // main routine to handle ssaInfos
+                    const size_t failedLinearDeps = createBlockLivenesses(ls, cblock,
+                            usageHandler, linDepHandler, linearDepMaps);
+                    for (size_t i = 0; i < failedLinearDeps; i++)
+                        assembler.printError(nullptr, "Linear deps failed");
+                }
+                else
+                {
+                    cblocksToCache.increase(entry.blockIndex);
+                    ARDOut << "jcblockToCache: " << entry.blockIndex << "=" <<
+                                cblocksToCache.count(entry.blockIndex) << "\n";
                 
-                size_t linearDepPos = linDepHandler.findPositionByOffset(cblock.start);
+                    // back, already visited
+                    flowStack.pop_back();
                 
-                // register in liveness
-                bool rvuFirst = true;
-                while (true)
-                {
-                    AsmRegVarUsage rvu = { 0U, nullptr, 0U, 0U };
-                    bool hasNext = false;
-                    if (usageHandler.hasNext(usagePos) && oldOffset < cblock.end)
-                    {
-                        hasNext = true;
-                        rvu = usageHandler.nextUsage(usagePos);
-                        if (rvuFirst)
-                        {
-                            oldOffset = rvu.offset;
-                            rvuFirst = false;
-                        }
-                    }
-                    const size_t liveTime = oldOffset;
-                    if ((!hasNext || rvu.offset > oldOffset) && oldOffset < cblock.end)
-                    {
-                        ARDOut << "apply to liveness. offset: " << oldOffset << "\n";
-                        // apply to liveness
-                        for (AsmSingleVReg svreg: readSVRegs)
-                        {
-                            auto svrres = ssaIdIdxMap.insert({ svreg, 0 });
-                            Liveness& lv = getLiveness(svreg, svrres.first->second,
-                                    binaryMapFind(cblock.ssaInfoMap.begin(),
-                                        cblock.ssaInfoMap.end(), svreg)->second, ls);
-                            if (svrres.second)
-                                // begin region from this block
-                                lv.insert(curLiveTime, liveTime+1);
-                            else
-                                lv.expand(liveTime+1);
-                        }
-                        for (AsmSingleVReg svreg: writtenSVRegs)
-                        {
-                            size_t& ssaIdIdx = ssaIdIdxMap[svreg];
-                            if (svreg.regVar != nullptr)
-                                ssaIdIdx++;
-                            SSAInfo& sinfo = binaryMapFind(cblock.ssaInfoMap.begin(),
-                                        cblock.ssaInfoMap.end(), svreg)->second;
-                            Liveness& lv = getLiveness(svreg, ssaIdIdx, sinfo, ls);
-                            // works only with ISA where smallest instruction have 2 bytes!
-                            // after previous read, but not after instruction.
-                            // if var is not used anywhere then this liveness region
-                            // blocks assignment for other vars
-                            lv.insert(liveTime+1, liveTime+2);
-                        }
-                        
-                        // collecting linear deps for instruction
-                        std::vector<AsmRegVarLinearDep> instrLinDeps;
-                        AsmRegVarLinearDep linDep = { 0, nullptr, 0, 0 };
-                        bool haveLdep = false;
-                        if (oldOffset == 0 && linearDepPos < linearDepSize)
-                        {
-                            // special case: if offset is zero, force get linear dep
-                            linDep = linDepHandler.getLinearDep(linearDepPos++);
-                            haveLdep = true;
-                        }
-                        while (linDep.offset < oldOffset && linearDepPos < linearDepSize)
-                        {
-                            linDep = linDepHandler.getLinearDep(linearDepPos++);
-                            haveLdep = true;
-                        }
-                        // if found
-                        if (haveLdep)
-                            while (linDep.offset == oldOffset)
-                            {
-                                // just put
-                                instrLinDeps.push_back(linDep);
-                                if (linearDepPos < linearDepSize)
-                                    linDep = linDepHandler.getLinearDep(linearDepPos++);
-                                else // no data
-                                    break;
-                            }
-                        // get linear deps and equal to
-                        cxbyte lDeps[16];
-                        usageHandler.getUsageDependencies(instrRVUs.size(),
-                                    instrRVUs.data(), lDeps);
-                        
-                        if (!addUsageDeps(lDeps, instrRVUs, instrLinDeps, linearDepMaps,
-                                cblock.ssaInfoMap, ssaIdIdxMap,
-                                readSVRegs, writtenSVRegs, ls))
-                            assembler.printError(nullptr, "Linear deps failed");
-                        
-                        readSVRegs.clear();
-                        writtenSVRegs.clear();
-                        if (!hasNext)
-                            break;
-                        oldOffset = rvu.offset;
-                        instrRVUs.clear();
-                    }
-                    if (hasNext && oldOffset < cblock.end && !rvu.useRegMode)
-                        instrRVUs.push_back(rvu);
-                    if (oldOffset >= cblock.end)
-                        break;
-                    
-                    for (uint16_t rindex = rvu.rstart; rindex < rvu.rend; rindex++)
+                    size_t curWayBIndex = flowStack.back().blockIndex.index;
+                    if (lastCommonCacheWayPoint.first != SIZE_MAX)
                     {
-                        // per register/singlvreg
-                        AsmSingleVReg svreg{ rvu.regVar, rindex };
-                        if (checkWriteWithSSA(rvu))
-                            writtenSVRegs.push_back(svreg);
-                        else // read or treat as reading // expand previous region
-                            readSVRegs.push_back(svreg);
+                        // mark point of way to cache (res first point)
+                        waysToCache[lastCommonCacheWayPoint.first] = true;
+                        ARDOut << "mark to pfcache " <<
+                                lastCommonCacheWayPoint.first << ", " <<
+                                curWayBIndex << "\n";
+                        prevWaysIndexMap[curWayBIndex] = lastCommonCacheWayPoint;
                     }
+                    lastCommonCacheWayPoint = { curWayBIndex, flowStack.size()-1 };
+                    ARDOut << "lastCcwP: " << curWayBIndex << "\n";
+                    continue;
                 }
             }
-            else
+        
+            if (!callStack.empty() &&
+                entry.blockIndex == callStack.back().callBlock &&
+                entry.nextIndex-1 == callStack.back().callNextIndex)
             {
-                cblocksToCache.increase(entry.blockIndex);
-                ARDOut << "jcblockToCache: " << entry.blockIndex << "=" <<
-                            cblocksToCache.count(entry.blockIndex) << "\n";
-                
-                // back, already visited
-                flowStack.pop_back();
-                
-                size_t curWayBIndex = flowStack.back().blockIndex.index;
-                if (lastCommonCacheWayPoint.first != SIZE_MAX)
+                ARDOut << " ret: " << entry.blockIndex << "\n";
+                const BlockIndex routineBlock = callStack.back().routineBlock;
+                auto res = routineMap.insert({ routineBlock.index, { } });
+            
+                // while second pass in recursion: the routine's insertion was happened
+                // later in first pass (after return from second pass)
+                // we check whether second pass happened for this routine
+                // order: create in second pass recursion
+                //           (fromSecondPass && rblock.pass==0 avoids
+                //            doubles creating in second pass)
+                //        create in first pass recursion
+                if (res.second || (res.first->second.fromSecondPass && routineBlock.pass==0))
                 {
-                    // mark point of way to cache (res first point)
-                    waysToCache[lastCommonCacheWayPoint.first] = true;
-                    ARDOut << "mark to pfcache " <<
-                            lastCommonCacheWayPoint.first << ", " <<
-                            curWayBIndex << "\n";
-                    prevWaysIndexMap[curWayBIndex] = lastCommonCacheWayPoint;
+                    res.first->second.fromSecondPass = routineBlock.pass==1;
+                    auto varRes = vidxRoutineMap.insert({ routineBlock.index, VIdxSetEntry{} });
+                    createRoutineDataLv(ls, res.first->second, varRes.first->second,
+                            routineBlock.index);
                 }
-                lastCommonCacheWayPoint = { curWayBIndex, flowStack.size()-1 };
-                ARDOut << "lastCcwP: " << curWayBIndex << "\n";
-                continue;
-            }
-        }
-        
-        if (!callStack.empty() &&
-            entry.blockIndex == callStack.back().callBlock &&
-            entry.nextIndex-1 == callStack.back().callNextIndex)
-        {
-            ARDOut << " ret: " << entry.blockIndex << "\n";
-            const BlockIndex routineBlock = callStack.back().routineBlock;
-            auto res = routineMap.insert({ routineBlock.index, { } });
-            
-            // while second pass in recursion: the routine's insertion was happened
-            // later in first pass (after return from second pass)
-            // we check whether second pass happened for this routine
-            // order: create in second pass recursion
-            //           (fromSecondPass && rblock.pass==0 avoids
-            //            doubles creating in second pass)
-            //        create in first pass recursion
-            if (res.second || (res.first->second.fromSecondPass && routineBlock.pass==0))
-            {
-                res.first->second.fromSecondPass = routineBlock.pass==1;
-                auto varRes = vidxRoutineMap.insert({ routineBlock.index, VIdxSetEntry{} });
-                createRoutineDataLv(ls, res.first->second, varRes.first->second,
-                        routineBlock.index);
-            }
-            else
-            {
-                // already added join livenesses from all readBeforeWrites
-                for (const auto& entry: res.first->second.rbwSSAIdMap)
+                else
                 {
-                    // find last
-                    auto lvrit = lastVRegMap.find(entry.first);
-                    LastVRegStackPos flowStackStart = (lvrit != lastVRegMap.end()) ?
-                            lvrit->second.back() : LastVRegStackPos{ 0, false };
+                    // already added join livenesses from all readBeforeWrites
+                    for (const auto& entry: res.first->second.rbwSSAIdMap)
+                    {
+                        // find last
+                        auto lvrit = lastVRegMap.find(entry.first);
+                        LastVRegStackPos flowStackStart = (lvrit != lastVRegMap.end()) ?
+                                lvrit->second.back() : LastVRegStackPos{ 0, false };
                     
-                    joinVRegRecur(ls, flowStackStart, entry.first, entry.second, false);
+                        joinVRegRecur(ls, flowStackStart, entry.first, entry.second, false);
+                    }
                 }
+                callBlocks.erase(routineBlock);
+                callStack.pop_back(); // just return from call
             }
-            callBlocks.erase(routineBlock);
-            callStack.pop_back(); // just return from call
-        }
         
-        if (entry.nextIndex < cblock.nexts.size())
-        {
-            BlockIndex nextBlock = cblock.nexts[entry.nextIndex].block;
-            nextBlock.pass = entry.blockIndex.pass;
-            if (cblock.nexts[entry.nextIndex].isCall)
+            if (entry.nextIndex < cblock.nexts.size())
             {
-                if (!callBlocks.insert(nextBlock).second)
+                BlockIndex nextBlock = cblock.nexts[entry.nextIndex].block;
+                nextBlock.pass = entry.blockIndex.pass;
+                if (cblock.nexts[entry.nextIndex].isCall)
                 {
-                    // just skip recursion (is good?)
-                    if (recurseBlocks.insert(nextBlock.index).second)
+                    if (!callBlocks.insert(nextBlock).second)
                     {
-                        ARDOut << "   -- recursion: " << nextBlock << "\n";
-                        nextBlock.pass = 1;
+                        // just skip recursion (is good?)
+                        if (recurseBlocks.insert(nextBlock.index).second)
+                        {
+                            ARDOut << "   -- recursion: " << nextBlock << "\n";
+                            nextBlock.pass = 1;
+                        }
+                        else if (entry.blockIndex.pass==1)
+                        {
+                            /// mark that is routine call to skip
+                            entry.nextIndex++;
+                            continue;
+                        }
                     }
-                    else if (entry.blockIndex.pass==1)
+                    else if (entry.blockIndex.pass==1 &&
+                        recurseBlocks.find(nextBlock.index) != recurseBlocks.end())
                     {
                         /// mark that is routine call to skip
                         entry.nextIndex++;
                         continue;
                     }
+                
+                    callStack.push_back({ entry.blockIndex,
+                                entry.nextIndex, nextBlock });
                 }
-                else if (entry.blockIndex.pass==1 &&
-                    recurseBlocks.find(nextBlock.index) != recurseBlocks.end())
+            
+                flowStack.push_back({ nextBlock, 0 });
+                entry.nextIndex++;
+            }
+            else if (((entry.nextIndex==0 && cblock.nexts.empty()) ||
+                    // if have any call then go to next block
+                    (cblock.haveCalls && entry.nextIndex==cblock.nexts.size())) &&
+                     !cblock.haveReturn && !cblock.haveEnd)
+            {
+                if (entry.nextIndex!=0) // if back from calls (just return from calls)
                 {
-                    /// mark that is routine call to skip
-                    entry.nextIndex++;
-                    continue;
+                    std::unordered_set<AsmSingleVReg> regSVRegs;
+                    // just add last access of svreg from call routines to lastVRegMap
+                    // and join svregs from routine with svreg used at this time
+                    for (const NextBlock& next: cblock.nexts)
+                        if (next.isCall)
+                        {
+                            auto rit = routineMap.find(next.block);
+                            if (rit == routineMap.end())
+                                continue;
+                            const RoutineDataLv& rdata = rit->second;
+                            for (const auto& entry: rdata.lastAccessMap)
+                                if (regSVRegs.insert(entry.first).second)
+                                {
+                                    auto res = lastVRegMap.insert({ entry.first,
+                                            { { flowStack.size()-1, true } } });
+                                    if (!res.second) // if not first seen, just update
+                                        // update last
+                                        res.first->second.push_back(
+                                                    { flowStack.size()-1, true });
+                                }
+                        }
                 }
-                
-                callStack.push_back({ entry.blockIndex,
-                            entry.nextIndex, nextBlock });
-            }
             
-            flowStack.push_back({ nextBlock, 0 });
-            entry.nextIndex++;
-        }
-        else if (((entry.nextIndex==0 && cblock.nexts.empty()) ||
-                // if have any call then go to next block
-                (cblock.haveCalls && entry.nextIndex==cblock.nexts.size())) &&
-                 !cblock.haveReturn && !cblock.haveEnd)
-        {
-            if (entry.nextIndex!=0) // if back from calls (just return from calls)
+                flowStack.push_back({ entry.blockIndex+1, 0 });
+                entry.nextIndex++;
+            }
+            else // back
             {
-                std::unordered_set<AsmSingleVReg> regSVRegs;
-                // just add last access of svreg from call routines to lastVRegMap
-                // and join svregs from routine with svreg used at this time
+                // revert lastSSAIdMap
+                flowStack.pop_back();
+            
+                // revert lastVRegs in call
+                std::unordered_set<AsmSingleVReg> revertedSVRegs;
                 for (const NextBlock& next: cblock.nexts)
                     if (next.isCall)
                     {
@@ -1564,52 +1845,24 @@ void AsmRegAllocator::createLivenesses(ISAUsageHandler& usageHandler,
                             continue;
                         const RoutineDataLv& rdata = rit->second;
                         for (const auto& entry: rdata.lastAccessMap)
-                            if (regSVRegs.insert(entry.first).second)
-                            {
-                                auto res = lastVRegMap.insert({ entry.first,
-                                        { { flowStack.size()-1, true } } });
-                                if (!res.second) // if not first seen, just update
-                                    // update last
-                                    res.first->second.push_back(
-                                                { flowStack.size()-1, true });
-                            }
+                            if (revertedSVRegs.insert(entry.first).second)
+                                revertLastSVReg(lastVRegMap, entry.first);
                     }
-            }
             
-            flowStack.push_back({ entry.blockIndex+1, 0 });
-            entry.nextIndex++;
-        }
-        else // back
-        {
-            // revert lastSSAIdMap
-            flowStack.pop_back();
+                for (const auto& sentry: cblock.ssaInfoMap)
+                    revertLastSVReg(lastVRegMap, sentry.first);
             
-            // revert lastVRegs in call
-            std::unordered_set<AsmSingleVReg> revertedSVRegs;
-            for (const NextBlock& next: cblock.nexts)
-                if (next.isCall)
+                if (!flowStack.empty() && lastCommonCacheWayPoint.first != SIZE_MAX &&
+                        lastCommonCacheWayPoint.second >= flowStack.size() &&
+                        flowStack.back().blockIndex.pass == 0)
                 {
-                    auto rit = routineMap.find(next.block);
-                    if (rit == routineMap.end())
-                        continue;
-                    const RoutineDataLv& rdata = rit->second;
-                    for (const auto& entry: rdata.lastAccessMap)
-                        if (revertedSVRegs.insert(entry.first).second)
-                            revertLastSVReg(lastVRegMap, entry.first);
+                    lastCommonCacheWayPoint =
+                            { flowStack.back().blockIndex.index, flowStack.size()-1 };
+                    ARDOut << "POPlastCcwP: " << lastCommonCacheWayPoint.first << "\n";
                 }
-            
-            for (const auto& sentry: cblock.ssaInfoMap)
-                revertLastSVReg(lastVRegMap, sentry.first);
-            
-            if (!flowStack.empty() && lastCommonCacheWayPoint.first != SIZE_MAX &&
-                    lastCommonCacheWayPoint.second >= flowStack.size() &&
-                    flowStack.back().blockIndex.pass == 0)
-            {
-                lastCommonCacheWayPoint =
-                        { flowStack.back().blockIndex.index, flowStack.size()-1 };
-                ARDOut << "POPlastCcwP: " << lastCommonCacheWayPoint.first << "\n";
             }
         }
+    
     }
     
     // after, that resolve joins (join with already visited code)
@@ -1621,63 +1874,52 @@ void AsmRegAllocator::createLivenesses(ISAUsageHandler& usageHandler,
     flowStack.clear();
     std::fill(visited.begin(), visited.end(), false);
     
-    flowStack.push_back({ 0, 0 });
-    
-    while (!flowStack.empty())
+    for (size_t entryBlock: entryBlocks)
     {
-        FlowStackEntry3& entry = flowStack.back();
-        CodeBlock& cblock = codeBlocks[entry.blockIndex.index];
-        
-        if (entry.nextIndex == 0)
+        flowStack.push_back({ entryBlock, 0 });
+        while (!flowStack.empty())
         {
-            // process current block
-            if (!visited[entry.blockIndex])
-                visited[entry.blockIndex] = true;
-            else
+            FlowStackEntry3& entry = flowStack.back();
+            CodeBlock& cblock = codeBlocks[entry.blockIndex.index];
+        
+            if (entry.nextIndex == 0)
             {
-                joinRegVarLivenesses(ls, joinFirstPointsCache, joinSecondPointsCache);
-                // back, already visited
-                flowStack.pop_back();
-                continue;
+                // process current block
+                if (!visited[entry.blockIndex])
+                    visited[entry.blockIndex] = true;
+                else
+                {
+                    joinRegVarLivenesses(ls, joinFirstPointsCache, joinSecondPointsCache);
+                    // back, already visited
+                    flowStack.pop_back();
+                    continue;
+                }
             }
-        }
         
-        if (entry.nextIndex < cblock.nexts.size())
-        {
-            flowStack.push_back({ cblock.nexts[entry.nextIndex].block, 0 });
-            entry.nextIndex++;
-        }
-        else if (((entry.nextIndex==0 && cblock.nexts.empty()) ||
-                // if have any call then go to next block
-                (cblock.haveCalls && entry.nextIndex==cblock.nexts.size())) &&
-                 !cblock.haveReturn && !cblock.haveEnd)
-        {
-            flowStack.push_back({ entry.blockIndex+1, 0 });
-            entry.nextIndex++;
-        }
-        else // back
-        {
-            if (cblocksToCache.count(entry.blockIndex)==2 &&
-                !joinSecondPointsCache.hasKey(entry.blockIndex.index))
-                // add to cache
-                addJoinSecCacheEntry(ls, joinSecondPointsCache, entry.blockIndex.index);
-            flowStack.pop_back();
+            if (entry.nextIndex < cblock.nexts.size())
+            {
+                flowStack.push_back({ cblock.nexts[entry.nextIndex].block, 0 });
+                entry.nextIndex++;
+            }
+            else if (((entry.nextIndex==0 && cblock.nexts.empty()) ||
+                    // if have any call then go to next block
+                    (cblock.haveCalls && entry.nextIndex==cblock.nexts.size())) &&
+                     !cblock.haveReturn && !cblock.haveEnd)
+            {
+                flowStack.push_back({ entry.blockIndex+1, 0 });
+                entry.nextIndex++;
+            }
+            else // back
+            {
+                if (cblocksToCache.count(entry.blockIndex)==2 &&
+                    !joinSecondPointsCache.hasKey(entry.blockIndex.index))
+                    // add to cache
+                    addJoinSecCacheEntry(ls, joinSecondPointsCache, entry.blockIndex.index);
+                flowStack.pop_back();
+            }
         }
-    }
     
-    // move livenesses to AsmRegAllocator outLivenesses
-    for (size_t regType = 0; regType < regTypesNum; regType++)
-    {
-        std::vector<Liveness>& livenesses2 = livenesses[regType];
-        Array<OutLiveness>& outLivenesses2 = outLivenesses[regType];
-        outLivenesses2.resize(livenesses2.size());
-        for (size_t li = 0; li < livenesses2.size(); li++)
-        {
-            outLivenesses2[li].resize(livenesses2[li].l.size());
-            std::copy(livenesses2[li].l.begin(), livenesses2[li].l.end(),
-                      outLivenesses2[li].begin());
-            livenesses2[li].clear();
-        }
-        livenesses2.clear();
     }
+    
+    moveOutLivenesses(regTypesNum, livenesses, outLivenesses);
 }
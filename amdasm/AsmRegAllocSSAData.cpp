@@ -1386,91 +1386,114 @@ static void createRoutineData(const std::vector<CodeBlock>& codeBlocks,
     ARDOut << "--------- createRoutineData end ------------\n";
 }
 
-void AsmRegAllocator::createSSAData(ISAUsageHandler& usageHandler,
-                ISALinearDepHandler& linDepHandler)
+// collect SSA infos (without SSA ids) for single code block.
+// it reads only usages of this code block, thus it can be called in parallel
+static void createCodeBlockSSAInfoMap(CodeBlock& cblock,
+                const ISAUsageHandler& usageHandler)
 {
-    if (codeBlocks.empty())
-        return;
-    auto cbit = codeBlocks.begin();
-    AsmRegVarUsage rvu;
-    ISAUsageHandler::ReadPos usagePos{ 0, 0 };
-    
-    if (!usageHandler.hasNext(usagePos))
-        return; // do nothing if no regusages
-    ISAUsageHandler::ReadPos oldReadPos = usagePos;
-    // old linear deps position
-    rvu = usageHandler.nextUsage(usagePos);
-    
-    cxuint regRanges[MAX_REGTYPES_NUM*2];
-    size_t regTypesNum;
-    assembler.isaAssembler->getRegisterRanges(regTypesNum, regRanges);
-    
-    while (true)
+    ISAUsageHandler::ReadPos usagePos = cblock.usagePos;
+    std::unordered_map<AsmSingleVReg, SSAInfo> ssaInfoMap;
+    while (usageHandler.hasNext(usagePos))
     {
-        while (cbit != codeBlocks.end() && cbit->end <= rvu.offset)
-        {
-            cbit->usagePos = oldReadPos;
-            ++cbit;
-        }
-        if (cbit == codeBlocks.end())
+        const AsmRegVarUsage rvu = usageHandler.nextUsage(usagePos);
+        if (rvu.offset >= cblock.end)
             break;
-        // skip rvu's before codeblock
-        while (rvu.offset < cbit->start && usageHandler.hasNext(usagePos))
+        // process rvu
+        // only if regVar
+        for (uint16_t rindex = rvu.rstart; rindex < rvu.rend; rindex++)
         {
-            oldReadPos = usagePos;
-            rvu = usageHandler.nextUsage(usagePos);
+            auto res = ssaInfoMap.insert(
+                    { AsmSingleVReg{ rvu.regVar, rindex }, SSAInfo() });
+            
+            SSAInfo& sinfo = res.first->second;
+            if (res.second)
+                sinfo.firstPos = rvu.offset;
+            sinfo.lastPos = rvu.offset;
+            
+            const bool writeWithSSA = checkWriteWithSSA(rvu);
+            if (!writeWithSSA && (sinfo.ssaIdChange == 0 ||
+                // if first write RVU instead read RVU
+                (sinfo.ssaIdChange == 1 && sinfo.firstPos==rvu.offset)))
+                sinfo.readBeforeWrite = true;
+            /* change SSA id only for write-only regvars -
+             *   read-write place can not have two different variables */
+            if (writeWithSSA)
+                sinfo.ssaIdChange++;
+            if (rvu.regVar==nullptr)
+                sinfo.ssaIdBefore = sinfo.ssaIdFirst =
+                        sinfo.ssaId = sinfo.ssaIdLast = 0;
         }
-        if (rvu.offset < cbit->start)
-            break;
-        
-        cbit->usagePos = oldReadPos;
-        std::unordered_map<AsmSingleVReg, SSAInfo> ssaInfoMap;
-        while (rvu.offset < cbit->end)
+    }
+    // prepping ssaInfoMap array in cblock (put and sorting)
+    cblock.ssaInfoMap.resize(ssaInfoMap.size());
+    std::copy(ssaInfoMap.begin(), ssaInfoMap.end(), cblock.ssaInfoMap.begin());
+    mapSort(cblock.ssaInfoMap.begin(), cblock.ssaInfoMap.end());
+}
+
+/* independent code regions: code blocks connected by jumps, calls or by going
+ * to next block. region is walked from its entry blocks: first block and blocks
+ * without predecessors (for example, next kernels in code). regions are ordered by
+ * their first entry block. blocks unreachable from any entry have region SIZE_MAX */
+static void findCodeRegions(const std::vector<CodeBlock>& codeBlocks,
+            std::vector<std::vector<size_t> >& regions, std::vector<size_t>& blockRegions)
+{
+    const size_t blocksNum = codeBlocks.size();
+    // union-find of code blocks (root is smallest block index)
+    std::vector<size_t> parents(blocksNum);
+    for (size_t i = 0; i < blocksNum; i++)
+        parents[i] = i;
+    auto findRoot = [&parents](size_t i)
+    {
+        while (parents[i] != i)
+            i = parents[i] = parents[parents[i]];
+        return i;
+    };
+    std::vector<bool> havePreds(blocksNum, false);
+    auto addEdge = [&parents, &havePreds, &findRoot](size_t from, size_t to)
+    {
+        havePreds[to] = true;
+        const size_t root1 = findRoot(from);
+        const size_t root2 = findRoot(to);
+        if (root1 != root2)
+            parents[std::max(root1, root2)] = std::min(root1, root2);
+    };
+    for (size_t i = 0; i < blocksNum; i++)
+    {
+        const CodeBlock& cblock = codeBlocks[i];
+        for (const NextBlock& next: cblock.nexts)
+            addEdge(i, next.block);
+        // same rule as in code flow walking
+        if ((cblock.nexts.empty() || cblock.haveCalls) &&
+            !cblock.haveReturn && !cblock.haveEnd && i+1 < blocksNum)
+            addEdge(i, i+1);
+    }
+    
+    regions.clear();
+    // region index for every root of union-find
+    std::vector<size_t> rootRegions(blocksNum, SIZE_MAX);
+    for (size_t i = 0; i < blocksNum; i++)
+        if (i == 0 || !havePreds[i])
         {
-            // process rvu
-            // only if regVar
-            for (uint16_t rindex = rvu.rstart; rindex < rvu.rend; rindex++)
+            size_t& region = rootRegions[findRoot(i)];
+            if (region == SIZE_MAX)
             {
-                auto res = ssaInfoMap.insert(
-                        { AsmSingleVReg{ rvu.regVar, rindex }, SSAInfo() });
-                
-                SSAInfo& sinfo = res.first->second;
-                if (res.second)
-                    sinfo.firstPos = rvu.offset;
-                sinfo.lastPos = rvu.offset;
-                
-                const bool writeWithSSA = checkWriteWithSSA(rvu);
-                if (!writeWithSSA && (sinfo.ssaIdChange == 0 ||
-                    // if first write RVU instead read RVU
-                    (sinfo.ssaIdChange == 1 && sinfo.firstPos==rvu.offset)))
-                    sinfo.readBeforeWrite = true;
-                /* change SSA id only for write-only regvars -
-                 *   read-write place can not have two different variables */
-                if (writeWithSSA)
-                    sinfo.ssaIdChange++;
-                if (rvu.regVar==nullptr)
-                    sinfo.ssaIdBefore = sinfo.ssaIdFirst =
-                            sinfo.ssaId = sinfo.ssaIdLast = 0;
+                region = regions.size();
+                regions.push_back({});
             }
-            
-            // get next rvusage
-            if (!usageHandler.hasNext(usagePos))
-                break;
-            oldReadPos = usagePos;
-            rvu = usageHandler.nextUsage(usagePos);
+            regions[region].push_back(i);
         }
-        // prepping ssaInfoMap array in cblock (put and sorting)
-        cbit->ssaInfoMap.resize(ssaInfoMap.size());
-        std::copy(ssaInfoMap.begin(), ssaInfoMap.end(), cbit->ssaInfoMap.begin());
-        mapSort(cbit->ssaInfoMap.begin(), cbit->ssaInfoMap.end());
-        
-        ++cbit;
-    }
-    oldReadPos = usagePos;
-    // fill up remaining codeblocks oldReadPos
-    for (; cbit != codeBlocks.end(); ++cbit)
-        cbit->usagePos = oldReadPos;
-    
+    blockRegions.resize(blocksNum);
+    for (size_t i = 0; i < blocksNum; i++)
+        blockRegions[i] = rootRegions[findRoot(i)];
+}
+
+/* create SSA data for single code region (walks from every entry block of region).
+ * SSA ids are counted from zero in every region, ssaInfos of the region's code blocks
+ * and SSA replaces are renumbered later while merging regions */
+static void createRegionSSAData(std::vector<CodeBlock>& codeBlocks,
+            const std::vector<size_t>& entryBlocks, SVRegMap& totalSSACountMap,
+            SSAReplacesMap& ssaReplacesMap)
+{
     size_t rbwCount = 0;
     size_t wrCount = 0;
     
@@ -1478,8 +1501,6 @@ void AsmRegAllocator::createSSAData(ISAUsageHandler& usageHandler,
     
     std::deque<CallStackEntry> callStack;
     std::deque<FlowStackEntry> flowStack;
-    // total SSA count
-    SVRegMap totalSSACountMap;
     // last SSA ids map from returns
     RetSSAIdMap retSSAIdMap;
     // last SSA ids in current way in code flow
@@ -1502,8 +1523,6 @@ void AsmRegAllocator::createSSAData(ISAUsageHandler& usageHandler,
     // subroutToCache - true if given block begin subroutine to cache
     ResSecondPointsToCache cblocksToCache(codeBlocks.size());
     CBlockBitPool visited(codeBlocks.size(), false);
-    flowStack.push_back({ 0, 0 });
-    flowStackBlocks[0] = true;
     std::unordered_set<BlockIndex> callBlocks;
     std::unordered_set<BlockIndex> loopBlocks;
     std::unordered_set<size_t> recurseBlocks;
@@ -1516,269 +1535,278 @@ void AsmRegAllocator::createSSAData(ISAUsageHandler& usageHandler,
     /*
      * main loop to fill up ssaInfos
      */
-    while (!flowStack.empty())
+    for (size_t entryBlock: entryBlocks)
     {
-        FlowStackEntry& entry = flowStack.back();
-        CodeBlock& cblock = codeBlocks[entry.blockIndex.index];
+        // walk from entry block (entry blocks have not predecessors, except first)
+        flowStack.push_back({ entryBlock, 0 });
+        flowStackBlocks[entryBlock] = true;
+        lastCommonCacheWayPoint = { SIZE_MAX, SIZE_MAX };
         
-        if (entry.nextIndex == 0)
+        while (!flowStack.empty())
         {
-            // process current block
-            if (!visited[entry.blockIndex])
+            FlowStackEntry& entry = flowStack.back();
+            CodeBlock& cblock = codeBlocks[entry.blockIndex.index];
+        
+            if (entry.nextIndex == 0)
             {
-                ARDOut << "proc: " << entry.blockIndex << "\n";
-                visited[entry.blockIndex] = true;
-                
-                for (auto& ssaEntry: cblock.ssaInfoMap)
+                // process current block
+                if (!visited[entry.blockIndex])
                 {
-                    SSAInfo& sinfo = ssaEntry.second;
-                    if (ssaEntry.first.regVar==nullptr)
+                    ARDOut << "proc: " << entry.blockIndex << "\n";
+                    visited[entry.blockIndex] = true;
+                
+                    for (auto& ssaEntry: cblock.ssaInfoMap)
                     {
-                        // TODO - pass registers through SSA marking and resolving
-                        sinfo.ssaIdChange = 0; // zeroing SSA changes
-                        continue; // no change for registers
-                    }
+                        SSAInfo& sinfo = ssaEntry.second;
+                        if (ssaEntry.first.regVar==nullptr)
+                        {
+                            // TODO - pass registers through SSA marking and resolving
+                            sinfo.ssaIdChange = 0; // zeroing SSA changes
+                            continue; // no change for registers
+                        }
                     
-                    if (sinfo.ssaId != SIZE_MAX)
-                    {
-                        // already initialized
-                        reduceSSAIds(curSSAIdMap, retSSAIdMap,
-                                routineMap, ssaReplacesMap, entry, ssaEntry);
-                        if (sinfo.ssaIdChange!=0)
-                            curSSAIdMap[ssaEntry.first] = sinfo.ssaIdLast+1;
+                        if (sinfo.ssaId != SIZE_MAX)
+                        {
+                            // already initialized
+                            reduceSSAIds(curSSAIdMap, retSSAIdMap,
+                                    routineMap, ssaReplacesMap, entry, ssaEntry);
+                            if (sinfo.ssaIdChange!=0)
+                                curSSAIdMap[ssaEntry.first] = sinfo.ssaIdLast+1;
                         
-                        // count read before writes (for cache weight)
-                        if (sinfo.readBeforeWrite)
-                            rbwCount++;
-                        if (sinfo.ssaIdChange!=0)
-                            wrCount++;
-                        continue;
-                    }
+                            // count read before writes (for cache weight)
+                            if (sinfo.readBeforeWrite)
+                                rbwCount++;
+                            if (sinfo.ssaIdChange!=0)
+                                wrCount++;
+                            continue;
+                        }
                     
-                    reduceSSAIds(curSSAIdMap, retSSAIdMap, routineMap, ssaReplacesMap,
-                                 entry, ssaEntry);
+                        reduceSSAIds(curSSAIdMap, retSSAIdMap, routineMap, ssaReplacesMap,
+                                     entry, ssaEntry);
                     
-                    size_t& ssaId = curSSAIdMap[ssaEntry.first];
+                        size_t& ssaId = curSSAIdMap[ssaEntry.first];
                     
-                    size_t& totalSSACount = totalSSACountMap[ssaEntry.first];
-                    if (totalSSACount == 0)
-                    {
-                        // first read before write at all, need change totalcount, ssaId
-                        ssaId++;
-                        totalSSACount++;
-                    }
+                        size_t& totalSSACount = totalSSACountMap[ssaEntry.first];
+                        if (totalSSACount == 0)
+                        {
+                            // first read before write at all, need change totalcount, ssaId
+                            ssaId++;
+                            totalSSACount++;
+                        }
                     
-                    sinfo.ssaId = totalSSACount;
-                    sinfo.ssaIdFirst = sinfo.ssaIdChange!=0 ? totalSSACount : SIZE_MAX;
-                    sinfo.ssaIdBefore = ssaId-1;
+                        sinfo.ssaId = totalSSACount;
+                        sinfo.ssaIdFirst = sinfo.ssaIdChange!=0 ? totalSSACount : SIZE_MAX;
+                        sinfo.ssaIdBefore = ssaId-1;
                     
-                    totalSSACount += sinfo.ssaIdChange;
-                    sinfo.ssaIdLast = sinfo.ssaIdChange!=0 ? totalSSACount-1 : SIZE_MAX;
-                    //totalSSACount = std::max(totalSSACount, ssaId);
-                    if (sinfo.ssaIdChange!=0)
-                        ssaId = totalSSACount;
+                        totalSSACount += sinfo.ssaIdChange;
+                        sinfo.ssaIdLast = sinfo.ssaIdChange!=0 ? totalSSACount-1 : SIZE_MAX;
+                        //totalSSACount = std::max(totalSSACount, ssaId);
+                        if (sinfo.ssaIdChange!=0)
+                            ssaId = totalSSACount;
                     
-                    // count read before writes (for cache weight)
-                    if (sinfo.readBeforeWrite)
-                        rbwCount++;
-                    if (sinfo.ssaIdChange!=0)
-                        wrCount++;
+                        // count read before writes (for cache weight)
+                        if (sinfo.readBeforeWrite)
+                            rbwCount++;
+                        if (sinfo.ssaIdChange!=0)
+                            wrCount++;
+                    }
                 }
-            }
-            else
-            {
-                size_t pass = entry.blockIndex.pass;
-                cblocksToCache.increase(entry.blockIndex);
-                ARDOut << "cblockToCache: " << entry.blockIndex << "=" <<
-                            cblocksToCache.count(entry.blockIndex) << "\n";
-                // back, already visited
-                flowStackBlocks[entry.blockIndex] = !flowStackBlocks[entry.blockIndex];
-                flowStack.pop_back();
+                else
+                {
+                    size_t pass = entry.blockIndex.pass;
+                    cblocksToCache.increase(entry.blockIndex);
+                    ARDOut << "cblockToCache: " << entry.blockIndex << "=" <<
+                                cblocksToCache.count(entry.blockIndex) << "\n";
+                    // back, already visited
+                    flowStackBlocks[entry.blockIndex] = !flowStackBlocks[entry.blockIndex];
+                    flowStack.pop_back();
                 
-                if (pass != 0)
+                    if (pass != 0)
+                        continue;
+                    size_t curWayBIndex = flowStack.back().blockIndex.index;
+                    if (lastCommonCacheWayPoint.first != SIZE_MAX)
+                    {
+                        // mark point of way to cache (res first point)
+                        waysToCache[lastCommonCacheWayPoint.first] = true;
+                        ARDOut << "mark to pfcache " <<
+                                lastCommonCacheWayPoint.first << ", " <<
+                                curWayBIndex << "\n";
+                        prevWaysIndexMap[curWayBIndex] = lastCommonCacheWayPoint;
+                    }
+                    lastCommonCacheWayPoint = { curWayBIndex, flowStack.size()-1 };
+                    ARDOut << "lastCcwP: " << curWayBIndex << "\n";
                     continue;
-                size_t curWayBIndex = flowStack.back().blockIndex.index;
-                if (lastCommonCacheWayPoint.first != SIZE_MAX)
-                {
-                    // mark point of way to cache (res first point)
-                    waysToCache[lastCommonCacheWayPoint.first] = true;
-                    ARDOut << "mark to pfcache " <<
-                            lastCommonCacheWayPoint.first << ", " <<
-                            curWayBIndex << "\n";
-                    prevWaysIndexMap[curWayBIndex] = lastCommonCacheWayPoint;
                 }
-                lastCommonCacheWayPoint = { curWayBIndex, flowStack.size()-1 };
-                ARDOut << "lastCcwP: " << curWayBIndex << "\n";
-                continue;
             }
-        }
         
-        if (!callStack.empty() &&
-            entry.blockIndex == callStack.back().callBlock &&
-            entry.nextIndex-1 == callStack.back().callNextIndex)
-        {
-            ARDOut << " ret: " << entry.blockIndex << "\n";
-            const BlockIndex routineBlock = callStack.back().routineBlock;
-            RoutineData& prevRdata = routineMap.find(routineBlock)->second;
-            if (!prevRdata.generated)
+            if (!callStack.empty() &&
+                entry.blockIndex == callStack.back().callBlock &&
+                entry.nextIndex-1 == callStack.back().callNextIndex)
             {
-                createRoutineData(codeBlocks, curSSAIdMap, loopBlocks, callBlocks,
-                            cblocksToCache, subroutinesCache, routineMap, prevRdata,
-                            routineBlock, prevCallFlowStackBlocks, callFlowStackBlocks);
-                prevRdata.generated = true;
-                
-                auto csimsmit = curSSAIdMapStateMap.find(routineBlock.index);
-                if (csimsmit != curSSAIdMapStateMap.end() && entry.blockIndex.pass==0)
+                ARDOut << " ret: " << entry.blockIndex << "\n";
+                const BlockIndex routineBlock = callStack.back().routineBlock;
+                RoutineData& prevRdata = routineMap.find(routineBlock)->second;
+                if (!prevRdata.generated)
                 {
-                    ARDOut << " get curSSAIdMap from back recur 2\n";
-                    curSSAIdMap = csimsmit->second;
-                    curSSAIdMapStateMap.erase(csimsmit);
+                    createRoutineData(codeBlocks, curSSAIdMap, loopBlocks, callBlocks,
+                                cblocksToCache, subroutinesCache, routineMap, prevRdata,
+                                routineBlock, prevCallFlowStackBlocks, callFlowStackBlocks);
+                    prevRdata.generated = true;
+                
+                    auto csimsmit = curSSAIdMapStateMap.find(routineBlock.index);
+                    if (csimsmit != curSSAIdMapStateMap.end() && entry.blockIndex.pass==0)
+                    {
+                        ARDOut << " get curSSAIdMap from back recur 2\n";
+                        curSSAIdMap = csimsmit->second;
+                        curSSAIdMapStateMap.erase(csimsmit);
+                    }
                 }
-            }
             
-            callStack.pop_back(); // just return from call
-            callBlocks.erase(routineBlock);
-        }
+                callStack.pop_back(); // just return from call
+                callBlocks.erase(routineBlock);
+            }
         
-        if (entry.nextIndex < cblock.nexts.size())
-        {
-            bool isCall = false;
-            BlockIndex nextBlock = cblock.nexts[entry.nextIndex].block;
-            nextBlock.pass = entry.blockIndex.pass;
-            if (cblock.nexts[entry.nextIndex].isCall)
+            if (entry.nextIndex < cblock.nexts.size())
             {
-                if (!callBlocks.insert(nextBlock).second)
+                bool isCall = false;
+                BlockIndex nextBlock = cblock.nexts[entry.nextIndex].block;
+                nextBlock.pass = entry.blockIndex.pass;
+                if (cblock.nexts[entry.nextIndex].isCall)
                 {
-                    // if already called (then it is recursion)
-                    if (recurseBlocks.insert(nextBlock.index).second)
+                    if (!callBlocks.insert(nextBlock).second)
                     {
-                        ARDOut << "   -- recursion: " << nextBlock << "\n";
-                        nextBlock.pass = 1;
+                        // if already called (then it is recursion)
+                        if (recurseBlocks.insert(nextBlock.index).second)
+                        {
+                            ARDOut << "   -- recursion: " << nextBlock << "\n";
+                            nextBlock.pass = 1;
                         
-                        curSSAIdMapStateMap.insert({ nextBlock.index,  curSSAIdMap });
+                            curSSAIdMapStateMap.insert({ nextBlock.index,  curSSAIdMap });
+                        }
+                        else if (entry.blockIndex.pass==1)
+                        {
+                            entry.nextIndex++;
+                            ARDOut << " NO call (rec): " << entry.blockIndex << "\n";
+                            continue;
+                        }
                     }
-                    else if (entry.blockIndex.pass==1)
+                    else if (entry.blockIndex.pass==1 &&
+                        recurseBlocks.find(nextBlock.index) != recurseBlocks.end())
                     {
                         entry.nextIndex++;
-                        ARDOut << " NO call (rec): " << entry.blockIndex << "\n";
+                        ARDOut << " NO call (rec)2: " << entry.blockIndex << "\n";
                         continue;
                     }
-                }
-                else if (entry.blockIndex.pass==1 &&
-                    recurseBlocks.find(nextBlock.index) != recurseBlocks.end())
-                {
-                    entry.nextIndex++;
-                    ARDOut << " NO call (rec)2: " << entry.blockIndex << "\n";
-                    continue;
-                }
                 
-                ARDOut << " call: " << entry.blockIndex << "\n";
+                    ARDOut << " call: " << entry.blockIndex << "\n";
                 
-                callStack.push_back({ entry.blockIndex, entry.nextIndex, nextBlock });
-                routineMap.insert({ nextBlock, { } });
-                isCall = true;
-            }
+                    callStack.push_back({ entry.blockIndex, entry.nextIndex, nextBlock });
+                    routineMap.insert({ nextBlock, { } });
+                    isCall = true;
+                }
             
-            flowStack.push_back({ nextBlock, 0, isCall });
-            if (flowStackBlocks[nextBlock])
-            {
-                if (!cblock.nexts[entry.nextIndex].isCall)
-                    loopBlocks.insert(nextBlock);
-                flowStackBlocks[nextBlock] = false; // keep to inserted in popping
+                flowStack.push_back({ nextBlock, 0, isCall });
+                if (flowStackBlocks[nextBlock])
+                {
+                    if (!cblock.nexts[entry.nextIndex].isCall)
+                        loopBlocks.insert(nextBlock);
+                    flowStackBlocks[nextBlock] = false; // keep to inserted in popping
+                }
+                else
+                    flowStackBlocks[nextBlock] = true;
+                entry.nextIndex++;
             }
-            else
-                flowStackBlocks[nextBlock] = true;
-            entry.nextIndex++;
-        }
-        else if (((entry.nextIndex==0 && cblock.nexts.empty()) ||
-                // if have any call then go to next block
-                (cblock.haveCalls && entry.nextIndex==cblock.nexts.size())) &&
-                 !cblock.haveReturn && !cblock.haveEnd)
-        {
-            if (entry.nextIndex!=0) // if back from calls (just return from calls)
+            else if (((entry.nextIndex==0 && cblock.nexts.empty()) ||
+                    // if have any call then go to next block
+                    (cblock.haveCalls && entry.nextIndex==cblock.nexts.size())) &&
+                     !cblock.haveReturn && !cblock.haveEnd)
             {
-                reduceSSAIdsForCalls(entry, codeBlocks, retSSAIdMap, routineMap,
-                                     ssaReplacesMap);
-                //
-                for (const NextBlock& next: cblock.nexts)
-                    if (next.isCall)
-                    {
-                        //ARDOut << "joincall:"<< next.block << "\n";
-                        size_t pass = 0;
-                        if (callBlocks.find(next.block) != callBlocks.end())
+                if (entry.nextIndex!=0) // if back from calls (just return from calls)
+                {
+                    reduceSSAIdsForCalls(entry, codeBlocks, retSSAIdMap, routineMap,
+                                         ssaReplacesMap);
+                    //
+                    for (const NextBlock& next: cblock.nexts)
+                        if (next.isCall)
                         {
-                            ARDOut << " is secpass: " << entry.blockIndex << " : " <<
-                                    next.block << "\n";
-                            pass = 1; // it ways second pass
-                        }
+                            //ARDOut << "joincall:"<< next.block << "\n";
+                            size_t pass = 0;
+                            if (callBlocks.find(next.block) != callBlocks.end())
+                            {
+                                ARDOut << " is secpass: " << entry.blockIndex << " : " <<
+                                        next.block << "\n";
+                                pass = 1; // it ways second pass
+                            }
                         
-                        auto it = routineMap.find({ next.block, pass }); // must find
-                        initializePrevRetSSAIds(curSSAIdMap, retSSAIdMap,
-                                    it->second, entry);
+                            auto it = routineMap.find({ next.block, pass }); // must find
+                            initializePrevRetSSAIds(curSSAIdMap, retSSAIdMap,
+                                        it->second, entry);
                         
-                        BlockIndex rblock(next.block, entry.blockIndex.pass);
-                        if (callBlocks.find(next.block) != callBlocks.end())
-                            rblock.pass = 1;
+                            BlockIndex rblock(next.block, entry.blockIndex.pass);
+                            if (callBlocks.find(next.block) != callBlocks.end())
+                                rblock.pass = 1;
                         
-                        joinRetSSAIdMap(retSSAIdMap, it->second.lastSSAIdMap, rblock);
-                    }
-            }
+                            joinRetSSAIdMap(retSSAIdMap, it->second.lastSSAIdMap, rblock);
+                        }
+                }
             
-            flowStack.push_back({ entry.blockIndex+1, 0, false });
-            if (flowStackBlocks[entry.blockIndex+1])
-            {
-                loopBlocks.insert(entry.blockIndex+1);
-                 // keep to inserted in popping
-                flowStackBlocks[entry.blockIndex+1] = false;
+                flowStack.push_back({ entry.blockIndex+1, 0, false });
+                if (flowStackBlocks[entry.blockIndex+1])
+                {
+                    loopBlocks.insert(entry.blockIndex+1);
+                     // keep to inserted in popping
+                    flowStackBlocks[entry.blockIndex+1] = false;
+                }
+                else
+                    flowStackBlocks[entry.blockIndex+1] = true;
+                entry.nextIndex++;
             }
-            else
-                flowStackBlocks[entry.blockIndex+1] = true;
-            entry.nextIndex++;
-        }
-        else // back
-        {
-            // revert retSSAIdMap
-            revertRetSSAIdMap(curSSAIdMap, retSSAIdMap, entry, nullptr);
-            //
-            
-            for (const auto& ssaEntry: cblock.ssaInfoMap)
+            else // back
             {
-                if (ssaEntry.first.regVar == nullptr)
-                    continue;
+                // revert retSSAIdMap
+                revertRetSSAIdMap(curSSAIdMap, retSSAIdMap, entry, nullptr);
+                //
+            
+                for (const auto& ssaEntry: cblock.ssaInfoMap)
+                {
+                    if (ssaEntry.first.regVar == nullptr)
+                        continue;
                 
-                size_t& curSSAId = curSSAIdMap[ssaEntry.first];
-                const size_t nextSSAId = curSSAId;
-                curSSAId = ssaEntry.second.ssaIdBefore+1;
+                    size_t& curSSAId = curSSAIdMap[ssaEntry.first];
+                    const size_t nextSSAId = curSSAId;
+                    curSSAId = ssaEntry.second.ssaIdBefore+1;
                 
-                ARDOut << "popcurnext: " << ssaEntry.first.regVar <<
-                            ":" << ssaEntry.first.index << ": " <<
-                            nextSSAId << ", " << curSSAId << "\n";
-            }
+                    ARDOut << "popcurnext: " << ssaEntry.first.regVar <<
+                                ":" << ssaEntry.first.index << ": " <<
+                                nextSSAId << ", " << curSSAId << "\n";
+                }
             
-            ARDOut << "pop: " << entry.blockIndex << "\n";
-            flowStackBlocks[entry.blockIndex] = false;
+                ARDOut << "pop: " << entry.blockIndex << "\n";
+                flowStackBlocks[entry.blockIndex] = false;
             
-            if (!flowStack.empty() && flowStack.back().isCall)
-            {
-                auto csimsmit = curSSAIdMapStateMap.find(entry.blockIndex.index);
-                if (csimsmit != curSSAIdMapStateMap.end())
+                if (!flowStack.empty() && flowStack.back().isCall)
                 {
-                    ARDOut << " get curSSAIdMap from back recur\n";
-                    curSSAIdMap = csimsmit->second;
+                    auto csimsmit = curSSAIdMapStateMap.find(entry.blockIndex.index);
+                    if (csimsmit != curSSAIdMapStateMap.end())
+                    {
+                        ARDOut << " get curSSAIdMap from back recur\n";
+                        curSSAIdMap = csimsmit->second;
+                    }
                 }
-            }
             
-            flowStack.pop_back();
+                flowStack.pop_back();
             
-            if (!flowStack.empty() && lastCommonCacheWayPoint.first != SIZE_MAX &&
-                    lastCommonCacheWayPoint.second >= flowStack.size() &&
-                    flowStack.back().blockIndex.pass == 0)
-            {
-                lastCommonCacheWayPoint =
-                        { flowStack.back().blockIndex.index, flowStack.size()-1 };
-                ARDOut << "POPlastCcwP: " << lastCommonCacheWayPoint.first << "\n";
+                if (!flowStack.empty() && lastCommonCacheWayPoint.first != SIZE_MAX &&
+                        lastCommonCacheWayPoint.second >= flowStack.size() &&
+                        flowStack.back().blockIndex.pass == 0)
+                {
+                    lastCommonCacheWayPoint =
+                            { flowStack.back().blockIndex.index, flowStack.size()-1 };
+                    ARDOut << "POPlastCcwP: " << lastCommonCacheWayPoint.first << "\n";
+                }
             }
         }
+    
     }
     
     /**********
@@ -1788,54 +1816,140 @@ void AsmRegAllocator::createSSAData(ISAUsageHandler& usageHandler,
     std::deque<FlowStackEntry2> flowStack2;
     
     std::fill(visited.begin(), visited.end(), false);
-    flowStack2.push_back({ 0, 0 });
     
     SimpleCache<size_t, LastSSAIdMap> resFirstPointsCache(wrCount<<1);
     SimpleCache<size_t, RBWSSAIdMap> resSecondPointsCache(rbwCount<<1);
     
-    while (!flowStack2.empty())
+    for (size_t entryBlock: entryBlocks)
     {
-        FlowStackEntry2& entry = flowStack2.back();
-        CodeBlock& cblock = codeBlocks[entry.blockIndex];
-        
-        if (entry.nextIndex == 0)
+        flowStack2.push_back({ entryBlock, 0 });
+        while (!flowStack2.empty())
         {
-            // process current block
-            if (!visited[entry.blockIndex])
-                visited[entry.blockIndex] = true;
-            else
+            FlowStackEntry2& entry = flowStack2.back();
+            CodeBlock& cblock = codeBlocks[entry.blockIndex];
+        
+            if (entry.nextIndex == 0)
             {
-                resolveSSAConflicts(flowStack2, routineMap, codeBlocks,
-                            prevWaysIndexMap, waysToCache, cblocksToCache,
-                            resFirstPointsCache, resSecondPointsCache, ssaReplacesMap);
+                // process current block
+                if (!visited[entry.blockIndex])
+                    visited[entry.blockIndex] = true;
+                else
+                {
+                    resolveSSAConflicts(flowStack2, routineMap, codeBlocks,
+                                prevWaysIndexMap, waysToCache, cblocksToCache,
+                                resFirstPointsCache, resSecondPointsCache, ssaReplacesMap);
                 
-                // back, already visited
-                flowStack2.pop_back();
-                continue;
+                    // back, already visited
+                    flowStack2.pop_back();
+                    continue;
+                }
             }
-        }
         
-        if (entry.nextIndex < cblock.nexts.size())
-        {
-            flowStack2.push_back({ cblock.nexts[entry.nextIndex].block, 0 });
-            entry.nextIndex++;
+            if (entry.nextIndex < cblock.nexts.size())
+            {
+                flowStack2.push_back({ cblock.nexts[entry.nextIndex].block, 0 });
+                entry.nextIndex++;
+            }
+            else if (((entry.nextIndex==0 && cblock.nexts.empty()) ||
+                    // if have any call then go to next block
+                    (cblock.haveCalls && entry.nextIndex==cblock.nexts.size())) &&
+                     !cblock.haveReturn && !cblock.haveEnd)
+            {
+                flowStack2.push_back({ entry.blockIndex+1, 0 });
+                entry.nextIndex++;
+            }
+            else // back
+            {
+                if (cblocksToCache.count(entry.blockIndex)==2 &&
+                    !resSecondPointsCache.hasKey(entry.blockIndex))
+                    // add to cache
+                    addResSecCacheEntry(routineMap, codeBlocks, resSecondPointsCache,
+                                entry.blockIndex);
+                flowStack2.pop_back();
+            }
         }
-        else if (((entry.nextIndex==0 && cblock.nexts.empty()) ||
-                // if have any call then go to next block
-                (cblock.haveCalls && entry.nextIndex==cblock.nexts.size())) &&
-                 !cblock.haveReturn && !cblock.haveEnd)
+    }
+}
+
+void AsmRegAllocator::createSSAData(ISAUsageHandler& usageHandler,
+                ISALinearDepHandler& linDepHandler)
+{
+    if (codeBlocks.empty())
+        return;
+    ISAUsageHandler::ReadPos usagePos{ 0, 0 };
+    
+    if (!usageHandler.hasNext(usagePos))
+    {
+        // do nothing if no regusages (code regions are still used by livenesses)
+        std::vector<size_t> blockRegions;
+        findCodeRegions(codeBlocks, codeRegions, blockRegions);
+        return;
+    }
+    
+    // find first usage position for every code block (first usage at or after start)
+    for (CodeBlock& cblock: codeBlocks)
+    {
+        while (usageHandler.hasNext(usagePos))
         {
-            flowStack2.push_back({ entry.blockIndex+1, 0 });
-            entry.nextIndex++;
+            ISAUsageHandler::ReadPos nextPos = usagePos;
+            if (usageHandler.nextUsage(nextPos).offset >= cblock.start)
+                break;
+            usagePos = nextPos;
         }
-        else // back
+        cblock.usagePos = usagePos;
+    }
+    
+    // code blocks are independent in this stage, results are stored in code blocks,
+    // hence result does not depend on number of threads
+    parallelForEach(codeBlocks.size(), threadsNum, [this, &usageHandler](size_t i)
+    { createCodeBlockSSAInfoMap(codeBlocks[i], usageHandler); });
+    
+    // independent code regions are walked separately, thus SSA ids are counted
+    // separately in every region
+    std::vector<size_t> blockRegions;
+    findCodeRegions(codeBlocks, codeRegions, blockRegions);
+    const size_t regionsNum = codeRegions.size();
+    std::vector<SVRegMap> regionSSACounts(regionsNum);
+    std::vector<SSAReplacesMap> regionReplaces(regionsNum);
+    parallelForEach(regionsNum, threadsNum, [&](size_t r)
+    {
+        createRegionSSAData(codeBlocks, codeRegions[r], regionSSACounts[r],
+                    regionReplaces[r]);
+    });
+    
+    /* merge regions: SSA ids of next region follow SSA ids of previous regions.
+     * regions are merged in their order, hence result does not depend on
+     * number of threads */
+    std::vector<std::vector<size_t> > regionBlocks(regionsNum);
+    for (size_t i = 0; i < codeBlocks.size(); i++)
+        if (blockRegions[i] != SIZE_MAX)
+            regionBlocks[blockRegions[i]].push_back(i);
+    SVRegMap ssaIdBases;
+    for (size_t r = 0; r < regionsNum; r++)
+    {
+        for (size_t bi: regionBlocks[r])
+            for (auto& ssaEntry: codeBlocks[bi].ssaInfoMap)
+            {
+                if (ssaEntry.first.regVar == nullptr)
+                    continue;
+                auto baseIt = ssaIdBases.find(ssaEntry.first);
+                if (baseIt == ssaIdBases.end() || baseIt->second == 0)
+                    continue;
+                const size_t base = baseIt->second;
+                SSAInfo& sinfo = ssaEntry.second;
+                for (size_t* ssaIdPtr: { &sinfo.ssaIdBefore, &sinfo.ssaIdFirst,
+                            &sinfo.ssaId, &sinfo.ssaIdLast })
+                    if (*ssaIdPtr != SIZE_MAX)
+                        *ssaIdPtr += base;
+            }
+        for (const auto& rentry: regionReplaces[r])
         {
-            if (cblocksToCache.count(entry.blockIndex)==2 &&
-                !resSecondPointsCache.hasKey(entry.blockIndex))
-                // add to cache
-                addResSecCacheEntry(routineMap, codeBlocks, resSecondPointsCache,
-                            entry.blockIndex);
-            flowStack2.pop_back();
+            const size_t base = ssaIdBases[rentry.first];
+            for (const SSAReplace& replace: rentry.second)
+                insertReplace(ssaReplacesMap, rentry.first,
+                            replace.first + base, replace.second + base);
         }
+        for (const auto& centry: regionSSACounts[r])
+            ssaIdBases[centry.first] += centry.second;
     }
 }
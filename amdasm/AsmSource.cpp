@@ -1594,7 +1594,7 @@ AsmSourcePosHandler::ReadPos AsmSourcePosHandler::findPositionByOffset(size_t of
     if (chunks[chunkPos].offsetFirst != offset)
     {
         const std::vector<Item>& items = chunks[chunkPos].items;
-        size_t itemPos = std::lower_bound(items.begin(), items.end(),
+        itemPos = std::lower_bound(items.begin(), items.end(),
                 Item{uint16_t(offset & 0xffff)}, [](const Item& a, const Item& b)
                 { return a.offsetLo < b.offsetLo; }) - items.begin();
         // fix itemPos to zero
@@ -20,9 +20,11 @@
 #include <CLRX/Config.h>
 #include <vector>
 #include <cstddef>
+#include <climits>
 #include <utility>
 #include <algorithm>
 #include <deque>
+#include <set>
 #include <unordered_set>
 #include <unordered_map>
 #include <CLRX/utils/Utilities.h>
@@ -93,7 +95,7 @@ struct QueueEntry1
     { }
     
     bool empty() const
-    { return haveDelayedOp || !regs.empty(); }
+    { return !haveDelayedOp && regs.empty(); }
     
     void join(const QueueEntry1& b)
     {
@@ -237,15 +239,21 @@ struct CLRX_INTERNAL QueueState1
         requestedQueueSize = std::min(size, requestedQueueSize);
     }
     
+    // size of ordered queue without last empty entry
+    cxuint filledSize() const
+    { return (!ordered.empty() && ordered.back().empty()) ?
+                ordered.size()-1 : ordered.size(); }
+    
+    // return number of entries after entry with register (0 if in random)
     uint16_t findMinQueueSizeForReg(uint16_t reg) const
     {
+        if (random.regs.find(reg) != random.regs.end())
+            return 0;
         auto it = regPlaces.find(reg);
         if (it == regPlaces.end())
-            // if found, then 0 otherwize not found (UINT_MAX)
-            return random.regs.find(reg) != random.regs.end() ? 0 : UINT16_MAX;
-        const uint16_t pos = std::min(
-                    int(maxQueueSize), int(it->second - orderedStartPos));
-        return ordered.size()-1 - cxuint(pos);
+            return UINT16_MAX; // not found
+        const uint16_t pos = uint16_t(it->second - orderedStartPos);
+        return filledSize()-1 - cxuint(pos);
     }
     
     void joinWay(const QueueState1& way)
@@ -278,50 +286,71 @@ struct CLRX_INTERNAL QueueState1
         for (; oit1 != ordered.end(); ++oit1, ++oit2, ++qpos)
             oit1->joinWithRegPlaces(*oit2, orderedStartPos-wayStartPos, qpos, regPlaces);
         
+        rebuildRegPlaces();
         firstFlush |= way.firstFlush;
         requestedQueueSize = std::max(requestedQueueSize, way.requestedQueueSize);
     }
     
-    bool joinNext(const QueueState1& next)
+    // join with queue state of next code block. keptSize - max number of
+    // last entries that stay in queue after waits in next block
+    void joinNext(const QueueState1& next, cxuint keptSize, bool clearRandom)
     {
-        if (!reallyFlushed)
+        const cxuint oldOrderedSize = filledSize();
+        ordered.resize(oldOrderedSize);
+        const cxuint prevOrderedSize = std::min(keptSize, oldOrderedSize);
+        ordered.erase(ordered.begin(), ordered.end()-prevOrderedSize);
+        orderedStartPos += oldOrderedSize-prevOrderedSize;
+        ordered.insert(ordered.end(), next.ordered.begin(),
+                    next.ordered.begin() + next.filledSize());
+        
+        if (ordered.size() > maxQueueSize)
         {
-            if (next.random.empty() && next.ordered.empty() &&
-                next.requestedQueueSize == maxQueueSize)
-                // no change
+            // push to first ordered
+            size_t toFirst = ordered.size() - maxQueueSize;
+            auto firstOrderedIt = ordered.begin() + toFirst;
+            for (auto it = ordered.begin(); it!=firstOrderedIt; ++it)
+                firstOrderedIt->join(*it);
+            ordered.erase(ordered.begin(), firstOrderedIt);
+            orderedStartPos += toFirst;
+        }
+        rebuildRegPlaces();
+        if (clearRandom)
+            random = QueueEntry1();
+        random.join(next.random);
+    }
+    
+    // recreate register places from ordered queue (last entry wins)
+    void rebuildRegPlaces()
+    {
+        regPlaces.clear();
+        uint16_t qpos = orderedStartPos;
+        for (auto oit = ordered.begin(); oit != ordered.end(); ++oit, ++qpos)
+            for (auto e: oit->regs)
+                regPlaces[e] = qpos;
+        minQueueIndex = orderedStartPos;
+    }
+    
+    // return true if queue states are same (ignoring absolute queue positions)
+    bool sameState(const QueueState1& b) const
+    {
+        if (ordered.size() != b.ordered.size() ||
+            requestedQueueSize != b.requestedQueueSize ||
+            firstFlush != b.firstFlush || reallyFlushed != b.reallyFlushed ||
+            random.haveDelayedOp != b.random.haveDelayedOp ||
+            random.regs != b.random.regs || regPlaces.size() != b.regPlaces.size())
+            return false;
+        for (auto oit1 = ordered.begin(), oit2 = b.ordered.begin();
+                    oit1 != ordered.end(); ++oit1, ++oit2)
+            if (oit1->haveDelayedOp != oit2->haveDelayedOp || oit1->regs != oit2->regs)
+                return false;
+        for (const auto& e: regPlaces)
+        {
+            auto bit = b.regPlaces.find(e.first);
+            if (bit == b.regPlaces.end() || uint16_t(e.second - orderedStartPos) !=
+                        uint16_t(bit->second - b.orderedStartPos))
                 return false;
-            
-            cxuint nextReqQSize = std::min(next.requestedQueueSize, requestedQueueSize);
-            const cxuint oldOrderedSize = ordered.size();
-            const cxuint prevOrderedSize = (nextReqQSize!=ordered.size() ?
-                    nextReqQSize-ordered.size() : next.ordered.size());
-            ordered.erase(ordered.begin(), ordered.end()-prevOrderedSize);
-            ordered.insert(ordered.end(), next.ordered.begin(), next.ordered.end());
-            orderedStartPos += ordered.size()-oldOrderedSize;
-            uint16_t nextStartPos = next.orderedStartPos - prevOrderedSize;
-            uint16_t qpos = orderedStartPos;
-            // update regplaces for front
-            for (auto oitx = ordered.begin() + prevOrderedSize; oitx != ordered.end();
-                        ++oitx, ++qpos)
-                updateRegPlaces(*oitx, orderedStartPos-nextStartPos, qpos, regPlaces);
-            
-            if (ordered.size() > maxQueueSize)
-            {
-                // push to first ordered
-                size_t toFirst = ordered.size() - maxQueueSize;
-                auto firstOrderedIt = ordered.begin() + toFirst;
-                for (auto it = ordered.begin(); it!=firstOrderedIt; ++it)
-                    firstOrderedIt->joinWithRegPlaces(*it, 0,
-                            orderedStartPos + toFirst, regPlaces);
-                ordered.erase(ordered.begin(), firstOrderedIt);
-                orderedStartPos += toFirst;
-            }
-            random.join(next.random);
-            requestedQueueSize = std::min(nextReqQSize, maxQueueSize);
-            return true;
         }
-        
-        return false;
+        return true;
     }
     
     size_t weight() const
@@ -333,90 +362,47 @@ struct CLRX_INTERNAL QueueState1
     }
 };
 
-struct CLRX_INTERNAL WaitFirstCacheEntry
+// queue states of all wait queues at start or at end of code block
+struct CLRX_INTERNAL WaitQueueStates
 {
     QueueState1 queues[ASM_WAIT_MAX_TYPES_NUM];
+    bool defined; // if already computed
     
-    size_t weight() const
+    WaitQueueStates() : defined(false)
+    { }
+    
+    void setMaxQueueSizes(const AsmWaitConfig& waitConfig)
     {
-        size_t w = 0;
-        for (const QueueState1& q: queues)
-            w += q.weight();
-        return w;
+        for (cxuint i = 0; i < waitConfig.waitQueuesNum; i++)
+            queues[i].setMaxQueueSize(waitConfig.waitQueueSizes[i]);
+    }
+    
+    bool sameStates(const WaitQueueStates& b, const AsmWaitConfig& waitConfig) const
+    {
+        for (cxuint i = 0; i < waitConfig.waitQueuesNum; i++)
+            if (!queues[i].sameState(b.queues[i]))
+                return false;
+        return true;
     }
 };
 
 struct CLRX_INTERNAL RRegInfo
 {
     size_t offset;  /// offset where is usage
-    uint16_t qsizes[ASM_WAIT_MAX_TYPES_NUM];  /// queue sizes in this reg usage
-    uint16_t waits[ASM_WAIT_MAX_TYPES_NUM];  /// pending waits from block to this place
+    /// number of ordered queue entries pushed in block before this reg usage
+    uint16_t pushed[ASM_WAIT_MAX_TYPES_NUM];
+    /// min queue size (minus pushed entries) from waits in block before reg usage
+    uint16_t extras[ASM_WAIT_MAX_TYPES_NUM];
+    cxuint zeroWaitMask;    /// queues flushed to zero before reg usage
 };
 
 typedef std::unordered_map<uint16_t, RRegInfo> RRegMap;
 
-struct CLRX_INTERNAL WaitSecRRegTreeEntry
-{
-    size_t blockIndex;
-    std::vector<uint16_t> firstRegs; // sorted
-    std::vector<size_t> nextBlocks;
-};
-
-struct CLRX_INTERNAL WaitSecCacheEntry
-{
-    RRegMap firstRegs;
-    // tree of first regs, first entry is start point
-    // nextBlocks points to next points of ways
-    std::vector<WaitSecCacheEntry> firstRegsOrdering;
-    
-    size_t weight() const
-    { return firstRegs.size() + firstRegsOrdering.size(); }
-};
-
-struct CLRX_INTERNAL WaitFlowStackEntry0
-{
-    size_t blockIndex;
-    size_t nextIndex;
-    bool isCall;
-    bool haveReturn;
-    
-    QueueState1 queues[ASM_WAIT_MAX_TYPES_NUM];
-    
-    WaitFlowStackEntry0(size_t _blockIndex, size_t _nextIndex,
-                        const AsmWaitConfig& waitConfig)
-            : blockIndex(_blockIndex), nextIndex(_nextIndex), isCall(false)
-    {
-        setMaxQueueSizes(waitConfig);
-    }
-    
-    WaitFlowStackEntry0(size_t _blockIndex, size_t _nextIndex, bool _isCall,
-                        const AsmWaitConfig& waitConfig)
-            : blockIndex(_blockIndex), nextIndex(_nextIndex), isCall(_isCall)
-    {
-        setMaxQueueSizes(waitConfig);
-    }
-    
-    WaitFlowStackEntry0(size_t _blockIndex, size_t _nextIndex,
-                        const WaitFlowStackEntry0& prev,
-                        const AsmWaitConfig& waitConfig)
-            : blockIndex(_blockIndex), nextIndex(_nextIndex)
-    {
-        setMaxQueueSizes(waitConfig);
-        std::copy(prev.queues, prev.queues + waitConfig.waitQueuesNum, queues);
-    }
-    
-    void setMaxQueueSizes(const AsmWaitConfig& waitConfig)
-    {
-        for (cxuint i = 0; i < waitConfig.waitQueuesNum; i++)
-            queues[i].setMaxQueueSize(waitConfig.waitQueueSizes[i]);
-    }
-};
-
 struct CLRX_INTERNAL WaitInstrXInfo
 {
     size_t offset;
     uint16_t waits[ASM_WAIT_MAX_TYPES_NUM];
-    uint16_t qsizes[ASM_WAIT_MAX_TYPES_NUM];
+    uint16_t pushed[ASM_WAIT_MAX_TYPES_NUM];
 };
 
 struct CLRX_INTERNAL WaitCodeBlock
@@ -426,6 +412,9 @@ struct CLRX_INTERNAL WaitCodeBlock
     // before wait instrs for delayed op in this block
     std::vector<WaitInstrXInfo> firstWaitInstrs;
     std::vector<std::pair<uint16_t, RRegInfo> > firstRegs; ///< first occurence of reg
+    // min queue sizes (minus pushed entries) from all waits in this block
+    uint16_t extras[ASM_WAIT_MAX_TYPES_NUM];
+    cxuint zeroWaitMask;    // queues flushed to zero in this block
     
     void setMaxQueueSizes(const AsmWaitConfig& waitConfig)
     {
@@ -498,18 +487,49 @@ static cxuint getRRegFromSVReg(const AsmSingleVReg& svreg, size_t outSSAIdIdx,
     return rreg;
 }
 
-static void processQueueBlock(const CodeBlock& cblock, WaitCodeBlock& wblock,
-        ISAWaitHandler& waitHandler, ISAWaitHandler::ReadPos& waitPos,
-        ISAUsageHandler& usageHandler, const AsmWaitConfig& waitConfig,
+// get queue register index for register usage
+static cxuint getRRegFromUsage(const AsmRegVarUsage& rvu, uint16_t rindex,
+        const CodeBlock& cblock, SVRegMap& ssaIdIdxMap, SVRegMap& svregWriteOffsets,
         const VarIndexMap* vregIndexMaps, const Array<cxuint>* graphColorMaps,
-        size_t regTypesNum, const cxuint* regRanges, bool onlyWarnings)
+        size_t regTypesNum, const cxuint* regRanges)
+{
+    AsmSingleVReg svreg{ rvu.regVar, rindex };
+    size_t outSSAIdIdx = 0;
+    if (rvu.regVar != nullptr)
+    {
+        // if regvar, get vidx and get from vidx register index
+        if (checkWriteWithSSA(rvu))
+        {
+            size_t& ssaIdIdx = ssaIdIdxMap[svreg];
+            ssaIdIdx++;
+            outSSAIdIdx = ssaIdIdx;
+            svregWriteOffsets.insert({ svreg, rvu.offset });
+        }
+        else // insert zero
+        {
+            auto svrres = ssaIdIdxMap.insert({ svreg, 0 });
+            outSSAIdIdx = svrres.first->second;
+            auto swit = svregWriteOffsets.find(svreg);
+            if (swit != svregWriteOffsets.end() && swit->second == rvu.offset)
+                outSSAIdIdx--; // before this write
+        }
+    }
+    return getRRegFromSVReg(svreg, outSSAIdIdx, cblock, vregIndexMaps, graphColorMaps,
+                regTypesNum, regRanges);
+}
+
+static void processQueueBlock(const CodeBlock& cblock, WaitCodeBlock& wblock,
+        ISAWaitHandler& waitHandler, ISAUsageHandler& usageHandler,
+        const AsmWaitConfig& waitConfig, const VarIndexMap* vregIndexMaps,
+        const Array<cxuint>* graphColorMaps, size_t regTypesNum,
+        const cxuint* regRanges, bool onlyWarnings, bool sinkWaits)
 {
     // fill usage of registers (real access) to wCblock
     ISAUsageHandler::ReadPos usagePos = cblock.usagePos;
+    ISAWaitHandler::ReadPos waitPos = waitHandler.findPositionByOffset(cblock.start);
     
     SVRegMap ssaIdIdxMap;
     SVRegMap svregWriteOffsets;
-    std::vector<AsmRegVarUsage> instrRVUs;
     
     RRegMap firstRegs;
     // process waits and delayed ops
@@ -523,312 +543,270 @@ static void processQueueBlock(const CodeBlock& cblock, WaitCodeBlock& wblock,
         instrOffset = (isWaitInstr ? waitInstr.offset : delayedOp.offset);
     }
     
-    uint16_t curQueueSizes[ASM_WAIT_MAX_TYPES_NUM];
-    uint16_t curWaits[ASM_WAIT_MAX_TYPES_NUM];
-    std::fill(curWaits, curWaits + waitConfig.waitQueuesNum, uint16_t(0));
-    // we assume that current queue size at start is not limited
-    std::fill(curQueueSizes, curQueueSizes + waitConfig.waitQueuesNum, UINT16_MAX);
-    
+    std::fill(wblock.extras, wblock.extras + waitConfig.waitQueuesNum, UINT16_MAX);
+    wblock.zeroWaitMask = 0;
+    // flushed queues - all previous queue entries has been finished
     cxuint flushedQueues = 0;
-    while (usageHandler.hasNext(usagePos))
+    
+    // apply wait instruction to queues of the block
+    auto applyWait = [&waitConfig, &wblock, &flushedQueues](const uint16_t* waits)
     {
-        const AsmRegVarUsage rvu = usageHandler.nextUsage(usagePos);
-        if (rvu.offset >= cblock.end && instrOffset >= cblock.end)
-            break;
-        
-        bool genWaitCnt = false;
-        // gwaitI - current wait instruction
-        AsmWaitInstr gwaitI { rvu.offset, { } };
         for (cxuint q = 0; q < waitConfig.waitQueuesNum; q++)
-            gwaitI.waits[q] = waitConfig.waitQueueSizes[q]-1;
-        
-        std::vector<std::pair<uint16_t, RRegInfo> > curRegs;
+        {
+            QueueState1& queue = wblock.queues[q];
+            const uint16_t pushed = queue.orderedStartPos + queue.filledSize();
+            const uint16_t extra = waits[q] > pushed ? waits[q] - pushed : 0;
+            wblock.extras[q] = std::min(wblock.extras[q], extra);
+            if (waits[q] == 0 && (wblock.zeroWaitMask & (1U<<q)) == 0)
+            {
+                wblock.zeroWaitMask |= 1U<<q;
+                flushedQueues++;
+            }
+            queue.flushTo(waits[q]);
+        }
+    };
+    
+    /* index of user wait instruction directly before current instruction.
+     * in non-sink mode, wait needed by this instruction is merged with it */
+    size_t prevUserWaitIndex = SIZE_MAX;
+    bool haveRvu = false;
+    AsmRegVarUsage rvu;
+    while (true)
+    {
+        if (!haveRvu && usageHandler.hasNext(usagePos))
+        {
+            rvu = usageHandler.nextUsage(usagePos);
+            haveRvu = true;
+        }
+        const size_t rvuOffset = (haveRvu && rvu.offset < cblock.end) ?
+                    rvu.offset : SIZE_MAX;
+        if (rvuOffset == SIZE_MAX && instrOffset >= cblock.end)
+            break;
         
-        if (rvu.offset < cblock.end && rvu.offset <= instrOffset)
+        if (rvuOffset <= instrOffset)
         {
-            // process RegVar usage
-            for (uint16_t rindex = rvu.rstart; rindex < rvu.rend; rindex++)
+            // process all register usages of instruction
+            bool genWaitCnt = false;
+            // gwaitI - current wait instruction
+            AsmWaitInstr gwaitI { rvuOffset, { } };
+            for (cxuint q = 0; q < waitConfig.waitQueuesNum; q++)
+                gwaitI.waits[q] = waitConfig.waitQueueSizes[q]-1;
+            
+            // queue registers which finish must be waited by this instruction
+            std::vector<uint16_t> curRegs;
+            while (haveRvu && rvu.offset == rvuOffset)
             {
-                AsmSingleVReg svreg{ rvu.regVar, rindex };
-                
-                size_t outSSAIdIdx = 0;
-                if (rvu.regVar != nullptr)
+                for (uint16_t rindex = rvu.rstart; rindex < rvu.rend; rindex++)
                 {
-                    // if regvar, get vidx and get from vidx register index
-                    if (checkWriteWithSSA(rvu))
-                    {
-                        size_t& ssaIdIdx = ssaIdIdxMap[svreg];
-                        if (svreg.regVar != nullptr)
-                            ssaIdIdx++;
-                        outSSAIdIdx = ssaIdIdx;
-                        svregWriteOffsets.insert({ svreg, rvu.offset });
-                    }
-                    else // insert zero
-                    {
-                        outSSAIdIdx = 0;
-                        auto svrres = ssaIdIdxMap.insert({ svreg, 0 });
-                        outSSAIdIdx = svrres.first->second;
-                        auto swit = svregWriteOffsets.find(svreg);
-                        if (swit != svregWriteOffsets.end() && swit->second == rvu.offset)
-                            outSSAIdIdx--; // before this write
-                    }
+                    const cxuint rreg = getRRegFromUsage(rvu, rindex, cblock,
+                            ssaIdIdxMap, svregWriteOffsets, vregIndexMaps,
+                            graphColorMaps, regTypesNum, regRanges);
+                    // read must wait for write, write must wait for read and write
+                    curRegs.push_back(qregVal(rreg, true));
+                    if ((rvu.rwFlags & ASMRVU_WRITE) != 0)
+                        curRegs.push_back(qregVal(rreg, false));
                 }
-                const cxuint rreg = getRRegFromSVReg(svreg, outSSAIdIdx, cblock,
-                            vregIndexMaps, graphColorMaps, regTypesNum, regRanges);
-                
-                // put to readRegs and writeRegs
-                if ((rvu.rwFlags & ASMRVU_READ) != 0)
-                    curRegs.push_back({ qregVal(rreg, false), { rvu.offset } });
-                if ((rvu.rwFlags & ASMRVU_WRITE) != 0)
-                    curRegs.push_back({ qregVal(rreg, true), { rvu.offset } });
-                
-                // rreg
-                if ((rvu.rwFlags & ASMRVU_READ) != 0)
-                    for (cxuint q = 0; q < waitConfig.waitQueuesNum; q++)
-                    {
-                        uint16_t waitCnt = wblock.queues[q]
-                            .findMinQueueSizeForReg(qregVal(rreg, false));
-                        if (waitCnt != UINT16_MAX)
-                        {
-                            if (!onlyWarnings)
-                            {
-                                gwaitI.waits[q] = std::min(gwaitI.waits[q], waitCnt);
-                                genWaitCnt = true;
-                            }
-                        }
-                    }
-                if ((rvu.rwFlags & ASMRVU_WRITE) != 0)
-                    for (cxuint q = 0; q < waitConfig.waitQueuesNum; q++)
+                haveRvu = usageHandler.hasNext(usagePos);
+                if (haveRvu)
+                    rvu = usageHandler.nextUsage(usagePos);
+            }
+            
+            for (uint16_t qreg: curRegs)
+                for (cxuint q = 0; q < waitConfig.waitQueuesNum; q++)
+                {
+                    uint16_t waitCnt = wblock.queues[q].findMinQueueSizeForReg(qreg);
+                    if (waitCnt != UINT16_MAX && !onlyWarnings)
                     {
-                        uint16_t waitCnt = wblock.queues[q]
-                            .findMinQueueSizeForReg(qregVal(rreg, true));
-                        if (waitCnt != UINT16_MAX)
-                        {
-                            if (!onlyWarnings)
-                            {
-                                gwaitI.waits[q] = std::min(gwaitI.waits[q], waitCnt);
-                                genWaitCnt = true;
-                            }
-                        }
+                        gwaitI.waits[q] = std::min(gwaitI.waits[q], waitCnt);
+                        genWaitCnt = true;
                     }
-            }
+                }
             
-            if (genWaitCnt && rvu.offset != instrOffset)
+            if (genWaitCnt && prevUserWaitIndex != SIZE_MAX)
             {
-                // generate wait instr
-                wblock.waitInstrs.push_back(gwaitI);
-                for (cxuint w = 0; w < waitConfig.waitQueuesNum; w++)
-                    wblock.queues[w].flushTo(gwaitI.waits[w]);
+                // merge with user wait instr (choose min queue sizes)
+                AsmWaitInstr& userWaitI = wblock.waitInstrs[prevUserWaitIndex];
+                for (cxuint q = 0; q < waitConfig.waitQueuesNum; q++)
+                    userWaitI.waits[q] = std::min(userWaitI.waits[q], gwaitI.waits[q]);
+                applyWait(userWaitI.waits);
             }
-        }
-        
-        if (instrOffset < cblock.end && rvu.offset >= instrOffset && isWaitInstr)
-        {
-            // process wait instr
-            if (genWaitCnt)
+            else if (genWaitCnt)
             {
-                // if user waitinstr and generate wait instr
-                // then choose min queue sizes in wait instr and generate new
-                // wait instr.
-                for (cxuint w = 0; w < waitConfig.waitQueuesNum; w++)
-                    gwaitI.waits[w] = std::min(gwaitI.waits[w], waitInstr.waits[w]);
+                // generate wait instr just before first use of register
                 wblock.waitInstrs.push_back(gwaitI);
-                for (cxuint w = 0; w < waitConfig.waitQueuesNum; w++)
-                    wblock.queues[w].flushTo(gwaitI.waits[w]);
+                applyWait(gwaitI.waits);
             }
-            else
+            prevUserWaitIndex = SIZE_MAX;
+            
+            // only if any not flushed queue
+            if (flushedQueues < waitConfig.waitQueuesNum)
             {
-                wblock.waitInstrs.push_back(waitInstr);
-                for (cxuint w = 0; w < waitConfig.waitQueuesNum; w++)
+                RRegInfo rinfo{ rvuOffset, { }, { }, wblock.zeroWaitMask };
+                for (cxuint q = 0; q < waitConfig.waitQueuesNum; q++)
                 {
-                    wblock.queues[w].flushTo(waitInstr.waits[w]);
-                    gwaitI.waits[w] = waitInstr.waits[w];
-                    genWaitCnt = true;
+                    const QueueState1& queue = wblock.queues[q];
+                    rinfo.pushed[q] = queue.orderedStartPos + queue.filledSize();
+                    rinfo.extras[q] = wblock.extras[q];
                 }
+                // put current regs to firstRegs
+                for (uint16_t qreg: curRegs)
+                    firstRegs.insert({ qreg, rinfo });
             }
+            continue;
         }
         
-        // update curQueue sizes from curent waitcnt
-        if (genWaitCnt && flushedQueues < waitConfig.waitQueuesNum)
-            for (cxuint q = 0; q < waitConfig.waitQueuesNum; q++)
+        if (isWaitInstr)
+        {
+            // in sink mode, wait instructions will be placed again
+            if (!sinkWaits)
+            {
+                prevUserWaitIndex = wblock.waitInstrs.size();
+                wblock.waitInstrs.push_back(waitInstr);
+                applyWait(waitInstr.waits);
+            }
+        }
+        else
+        {
+            prevUserWaitIndex = SIZE_MAX;
+            // delayed op
+            const AsmDelayedOpTypeEntry& delOpEntry = waitConfig.delayOpTypes[
+                            delayedOp.delayedOpType];
+            const cxuint queue1Idx = delOpEntry.waitType;
+            const cxuint queue2Idx = delayedOp.delayedOpType2!=ASMDELOP_NONE ?
+                    waitConfig.delayOpTypes[delayedOp.delayedOpType2].waitType :
+                    UINT_MAX;
+            // next entry
+            wblock.queues[queue1Idx].nextEntry();
+            if (queue2Idx != UINT_MAX)
+                wblock.queues[queue2Idx].nextEntry();
+            cxuint rcount = 0, rcount2 = 0;
+            
+            for (uint16_t rindex = delayedOp.rstart;
+                                rindex < delayedOp.rend; rindex++)
             {
-                if (!wblock.queues[q].reallyFlushed)
+                AsmSingleVReg svreg{ delayedOp.regVar, rindex };
+                // ssaIdIdx is needed only for regvars
+                const size_t ssaIdIdx = (svreg.regVar != nullptr) ?
+                        ssaIdIdxMap.find(svreg)->second : 0;
+                const cxuint rreg = getRRegFromSVReg(svreg, ssaIdIdx, cblock,
+                        vregIndexMaps, graphColorMaps, regTypesNum, regRanges);
+                
+                if ((delayedOp.rwFlags & ASMRVU_READ) != 0 &&
+                            delOpEntry.finishOnRegReadOut)
                 {
-                    // update wait after flush
-                    curQueueSizes[q] = wblock.queues[q].requestedQueueSize;
-                    curWaits[q] = std::min(curWaits[q],
-                                uint16_t(wblock.queues[q].ordered.size()));
+                    const uint16_t qreg = qregVal(rreg, false);
+                    if (delOpEntry.ordered)
+                        wblock.queues[queue1Idx].pushOrdered(qreg);
+                    else
+                        wblock.queues[queue1Idx].pushRandom(qreg);
                 }
-                else
+                if ((delayedOp.rwFlags & ASMRVU_WRITE) != 0)
                 {
-                    // increment flushQueues when queue has been flushed now
-                    if (curWaits[q] != UINT16_MAX)
-                        flushedQueues++;
-                    curWaits[q] = UINT16_MAX;
+                    const uint16_t qreg = qregVal(rreg, true);
+                    if (delOpEntry.ordered)
+                        wblock.queues[queue1Idx].pushOrdered(qreg);
+                    else
+                        wblock.queues[queue1Idx].pushRandom(qreg);
                 }
-            }
-        
-        if (instrOffset < cblock.end && rvu.offset >= instrOffset)
-        {
-            if (!isWaitInstr)
-            {
-                // delayed op
-                const AsmDelayedOpTypeEntry& delOpEntry = waitConfig.delayOpTypes[
-                                delayedOp.delayedOpType];
-                const cxuint queue1Idx = delOpEntry.waitType;
-                const cxuint queue2Idx = delayedOp.delayedOpType!=ASMDELOP_NONE ?
-                        waitConfig.delayOpTypes[delayedOp.delayedOpType].waitType :
-                        UINT_MAX;
-                // next entry
-                wblock.queues[queue1Idx].nextEntry();
+                // if queue2
                 if (queue2Idx != UINT_MAX)
-                    wblock.queues[queue2Idx].nextEntry();
-                cxuint rcount = 0, rcount2 = 0;
-                
-                for (uint16_t rindex = delayedOp.rstart;
-                                    rindex < delayedOp.rend; rindex++)
                 {
-                    AsmSingleVReg svreg{ delayedOp.regVar, rindex };
-                    const size_t ssaIdIdx = ssaIdIdxMap.find(svreg)->second;
-                    const cxuint rreg = getRRegFromSVReg(svreg, ssaIdIdx, cblock,
-                            vregIndexMaps, graphColorMaps, regTypesNum, regRanges);
-                    
-                    if ((delayedOp.rwFlags & ASMRVU_READ) != 0 &&
-                                delOpEntry.finishOnRegReadOut)
+                    const AsmDelayedOpTypeEntry& delOpEntry2 =
+                            waitConfig.delayOpTypes[delayedOp.delayedOpType2];
+                    if ((delayedOp.rwFlags2 & ASMRVU_READ) != 0 &&
+                            delOpEntry2.finishOnRegReadOut)
                     {
                         const uint16_t qreg = qregVal(rreg, false);
-                        if (delOpEntry.ordered)
-                            wblock.queues[queue1Idx].pushOrdered(qreg);
+                        if (delOpEntry2.ordered)
+                            wblock.queues[queue2Idx].pushOrdered(qreg);
                         else
-                            wblock.queues[queue1Idx].pushRandom(qreg);
+                            wblock.queues[queue2Idx].pushRandom(qreg);
                     }
-                    if ((delayedOp.rwFlags & ASMRVU_WRITE) != 0)
+                    if ((delayedOp.rwFlags2 & ASMRVU_WRITE) != 0)
                     {
                         const uint16_t qreg = qregVal(rreg, true);
-                        if (delOpEntry.ordered)
-                            wblock.queues[queue1Idx].pushOrdered(qreg);
+                        if (delOpEntry2.ordered)
+                            wblock.queues[queue2Idx].pushOrdered(qreg);
                         else
-                            wblock.queues[queue1Idx].pushRandom(qreg);
-                    }
-                    // if queue2
-                    if (queue2Idx != UINT_MAX)
-                    {
-                        const AsmDelayedOpTypeEntry& delOpEntry2 =
-                                waitConfig.delayOpTypes[delayedOp.delayedOpType2];
-                        if ((delayedOp.rwFlags2 & ASMRVU_READ) != 0 &&
-                                delOpEntry2.finishOnRegReadOut)
-                        {
-                            const uint16_t qreg = qregVal(rreg, false);
-                            if (delOpEntry2.ordered)
-                                wblock.queues[queue2Idx].pushOrdered(qreg);
-                            else
-                                wblock.queues[queue2Idx].pushRandom(qreg);
-                        }
-                        if ((delayedOp.rwFlags2 & ASMRVU_WRITE) != 0)
-                        {
-                            const uint16_t qreg = qregVal(rreg, true);
-                            if (delOpEntry2.ordered)
-                                wblock.queues[queue2Idx].pushOrdered(qreg);
-                            else
-                                wblock.queues[queue2Idx].pushRandom(qreg);
-                        }
-                        // do next queue entry if registered per element
-                        rcount2 += 4;
-                        if (delOpEntry2.counting!=255 && delOpEntry2.counting <= rcount)
-                        {
-                            // new entry
-                            wblock.queues[queue2Idx].nextEntry();
-                            rcount2 = 0;
-                        }
+                            wblock.queues[queue2Idx].pushRandom(qreg);
                     }
-                    
                     // do next queue entry if registered per element
-                    rcount += 4;
-                    if (delOpEntry.counting!=255 && delOpEntry.counting <= rcount)
+                    rcount2 += 4;
+                    if (delOpEntry2.counting!=255 && delOpEntry2.counting <= rcount2)
                     {
                         // new entry
-                        wblock.queues[queue1Idx].nextEntry();
-                        rcount = 0;
+                        wblock.queues[queue2Idx].nextEntry();
+                        rcount2 = 0;
                     }
                 }
                 
-                // update current queue sizes from last delayed ops
-                if (flushedQueues < waitConfig.waitQueuesNum)
+                // do next queue entry if registered per element
+                rcount += 4;
+                if (delOpEntry.counting!=255 && delOpEntry.counting <= rcount)
                 {
-                    curQueueSizes[queue1Idx] = wblock.queues[queue1Idx].requestedQueueSize;
-                    // increment curWait for queue1
-                    curWaits[queue1Idx] = std::min(uint16_t(curWaits[queue1Idx]+1),
-                                    waitConfig.waitQueueSizes[queue1Idx]);
-                    if (queue2Idx != UINT_MAX)
-                    {
-                        curQueueSizes[queue2Idx] =
-                                wblock.queues[queue2Idx].requestedQueueSize;
-                        // increment curWait for queue2
-                        curWaits[queue2Idx] = std::min(uint16_t(curWaits[queue2Idx]+1),
-                                    waitConfig.waitQueueSizes[queue2Idx]);
-                    }
+                    // new entry
+                    wblock.queues[queue1Idx].nextEntry();
+                    rcount = 0;
                 }
             }
-            
-            // only if any not flushed queue
-            if (flushedQueues < waitConfig.waitQueuesNum)
-            {
-                // update current queue sizes
-                for (auto& re: curRegs)
-                {
-                    std::copy(curQueueSizes, curQueueSizes + waitConfig.waitQueuesNum,
-                                re.second.qsizes);
-                    std::copy(curWaits, curWaits + waitConfig.waitQueuesNum,
-                                re.second.waits);
-                }
-                // put current regs to firstRegs
-                firstRegs.insert(curRegs.begin(), curRegs.end());
-            }
-            // get next instr
-            if (!waitHandler.hasNext(waitPos))
-                instrOffset = SIZE_MAX;
-            else
-            {
-                isWaitInstr = waitHandler.nextInstr(waitPos, delayedOp, waitInstr);
-                instrOffset = (isWaitInstr ? waitInstr.offset : delayedOp.offset);
-            }
         }
         
-        // copy to wblock as array
-        wblock.firstRegs.resize(firstRegs.size());
-        std::copy(firstRegs.begin(), firstRegs.end(), wblock.firstRegs.begin());
-        mapSort(wblock.firstRegs.begin(), wblock.firstRegs.end());
+        // get next instr
+        if (!waitHandler.hasNext(waitPos))
+            instrOffset = SIZE_MAX;
+        else
+        {
+            isWaitInstr = waitHandler.nextInstr(waitPos, delayedOp, waitInstr);
+            instrOffset = (isWaitInstr ? waitInstr.offset : delayedOp.offset);
+        }
     }
+    
+    // copy to wblock as array
+    wblock.firstRegs.resize(firstRegs.size());
+    std::copy(firstRegs.begin(), firstRegs.end(), wblock.firstRegs.begin());
+    mapSort(wblock.firstRegs.begin(), wblock.firstRegs.end());
 }
 
 static void optimizeWaitInstrs(const AsmWaitConfig& waitConfig,
                 std::vector<WaitInstrXInfo>& waitInstrs)
 {
-    uint16_t extraQSizes[ASM_WAIT_MAX_TYPES_NUM];
-    std::fill(extraQSizes, extraQSizes + waitConfig.waitQueuesNum, uint16_t(UINT16_MAX));
+    // merge wait instructions at same place
+    size_t j = 0;
+    for (size_t i = 0; i < waitInstrs.size(); i++)
+    {
+        if (j != 0 && waitInstrs[j-1].offset == waitInstrs[i].offset)
+        {
+            for (cxuint q = 0; q < waitConfig.waitQueuesNum; q++)
+                waitInstrs[j-1].waits[q] = std::min(waitInstrs[j-1].waits[q],
+                            waitInstrs[i].waits[q]);
+            continue;
+        }
+        waitInstrs[j++] = waitInstrs[i];
+    }
+    waitInstrs.resize(j);
+    
+    // remove waits that have been done by previous waits
+    int extras[ASM_WAIT_MAX_TYPES_NUM];
+    std::fill(extras, extras + waitConfig.waitQueuesNum, INT_MAX);
     for (WaitInstrXInfo& wi: waitInstrs)
     {
         cxuint toRemove = 0;
         for (cxuint q = 0; q < waitConfig.waitQueuesNum; q++)
         {
-            if (wi.waits[q] - wi.qsizes[q] >= extraQSizes[q])
+            const int extra = int(wi.waits[q]) - int(wi.pushed[q]);
+            if (wi.waits[q] == waitConfig.waitQueueSizes[q]-1 || extra >= extras[q])
             {
                 // mark to remove
-                wi.waits[q] = UINT16_MAX;
+                wi.waits[q] = waitConfig.waitQueueSizes[q]-1;
                 toRemove++;
             }
             else
-                // update new extraQSize for this queue
-                extraQSizes[q] = wi.waits[q] - wi.qsizes[q];
+                // update new extra for this queue
+                extras[q] = extra;
         }
         
         if (toRemove == waitConfig.waitQueuesNum)
             wi.offset = SIZE_MAX; // to remove
-        else
-            // correct waits
-            for (cxuint q = 0; q < waitConfig.waitQueuesNum; q++)
-                if (wi.waits[q] == UINT16_MAX)
-                    wi.waits[q] = waitConfig.waitQueueSizes[q] - 1;
     }
     
     const size_t newSize = std::remove_if(waitInstrs.begin(), waitInstrs.end(),
@@ -837,13 +815,13 @@ static void optimizeWaitInstrs(const AsmWaitConfig& waitConfig,
     waitInstrs.resize(newSize);
 }
 
+/* generate wait instructions for first usages of registers in code block
+ * for queue states at start of code block. */
 static void generateWaitInstrsWhileJoining(const AsmWaitConfig& waitConfig,
-        QueueState1* queues, const std::vector<std::pair<uint16_t, RRegInfo> >& firstRegs,
-        std::vector<WaitInstrXInfo>& waitInstrs, uint16_t* extraMinQueueSizes,
-        bool onlyWarnings)
+        const QueueState1* queues,
+        const std::vector<std::pair<uint16_t, RRegInfo> >& firstRegs,
+        std::vector<WaitInstrXInfo>& waitInstrs, bool onlyWarnings)
 {
-    std::fill(extraMinQueueSizes,
-              extraMinQueueSizes + waitConfig.waitQueuesNum, UINT16_MAX);
     for (const auto& entry: firstRegs)
     {
         bool genWaitCnt = false;
@@ -851,23 +829,34 @@ static void generateWaitInstrsWhileJoining(const AsmWaitConfig& waitConfig,
         for (cxuint q = 0; q < waitConfig.waitQueuesNum; q++)
         {
             gwaitI.waits[q] = waitConfig.waitQueueSizes[q]-1;
-            gwaitI.qsizes[q] = entry.second.qsizes[q];
+            gwaitI.pushed[q] = entry.second.pushed[q];
         }
         
         for (cxuint q = 0; q < waitConfig.waitQueuesNum; q++)
         {
-            uint16_t waitCnt = queues[q].findMinQueueSizeForReg(entry.first);
-            if (waitCnt != UINT16_MAX)
+            const QueueState1& queue = queues[q];
+            uint16_t waitCnt = UINT16_MAX;
+            if (queue.random.regs.find(entry.first) != queue.random.regs.end())
             {
-                waitCnt = std::min(gwaitI.waits[q], waitCnt);
-                if (!onlyWarnings && waitCnt < entry.second.qsizes[q])
-                {
-                    gwaitI.waits[q] = waitCnt;
-                    genWaitCnt = true;
-                }
-                extraMinQueueSizes[q] = std::min(
-                            uint16_t(entry.second.qsizes[q] - entry.second.waits[q]),
-                            extraMinQueueSizes[q]);
+                // if not already flushed to zero
+                if ((entry.second.zeroWaitMask & (1U<<q)) == 0)
+                    waitCnt = 0;
+            }
+            else
+            {
+                waitCnt = queue.findMinQueueSizeForReg(entry.first);
+                // if not finished by previous wait in this block
+                if (waitCnt != UINT16_MAX && waitCnt < entry.second.extras[q])
+                    // include entries pushed in this block
+                    waitCnt = std::min(cxuint(waitCnt) + entry.second.pushed[q],
+                                cxuint(waitConfig.waitQueueSizes[q]-1));
+                else
+                    waitCnt = UINT16_MAX;
+            }
+            if (waitCnt != UINT16_MAX && !onlyWarnings)
+            {
+                gwaitI.waits[q] = std::min(gwaitI.waits[q], waitCnt);
+                genWaitCnt = true;
             }
         }
         if (genWaitCnt)
@@ -886,11 +875,13 @@ AsmWaitScheduler::AsmWaitScheduler(const AsmWaitConfig& _asmWaitConfig,
         bool _onlyWarnings)
         : waitConfig(_asmWaitConfig), assembler(_assembler), codeBlocks(_codeBlocks),
           vregIndexMaps(_vregIndexMaps), graphColorMaps(_graphColorMaps),
-          onlyWarnings(_onlyWarnings)
+          onlyWarnings(_onlyWarnings), sinkWaits(false), blockVisitsNum(0)
 { }
 
 void AsmWaitScheduler::schedule(ISAUsageHandler& usageHandler, ISAWaitHandler& waitHandler)
 {
+    blockVisitsNum = 0;
+    neededWaitInstrs.clear();
     if (codeBlocks.empty())
         return;
     
@@ -903,180 +894,410 @@ void AsmWaitScheduler::schedule(ISAUsageHandler& usageHandler, ISAWaitHandler& w
     assembler.isaAssembler->getRegisterRanges(regTypesNum, regRanges);
     
     // fill queue states
-    ISAWaitHandler::ReadPos waitPos{ 0, 0 };
     for (size_t i = 0; i < codeBlocks.size(); i++)
-        processQueueBlock(codeBlocks[i], waitCodeBlocks[i], waitHandler, waitPos,
-                usageHandler, waitConfig, vregIndexMaps, graphColorMaps, regTypesNum,
-                regRanges, onlyWarnings);
+        processQueueBlock(codeBlocks[i], waitCodeBlocks[i], waitHandler, usageHandler,
+                waitConfig, vregIndexMaps, graphColorMaps, regTypesNum, regRanges,
+                onlyWarnings, sinkWaits);
     
-    // key - current res first key, value - previous first key and its flowStack pos
-    PrevWaysIndexMap prevWaysIndexMap;
-    // to track ways last block indices pair: block index, flowStackPos)
-    std::pair<size_t, size_t> lastCommonCacheWayPoint{ SIZE_MAX, SIZE_MAX };
-    ResSecondPointsToCache cblocksToCache(codeBlocks.size());
-    std::vector<bool> waysToCache(codeBlocks.size(), false);
-    // main loop variables
-    std::deque<CallStackEntry> callStack;
-    std::unordered_set<BlockIndex> callBlocks;
-    std::deque<WaitFlowStackEntry0> flowStack;
-    flowStack.push_back(WaitFlowStackEntry0(0, 0, waitConfig));
-    std::vector<bool> visited(codeBlocks.size(), false);
-    
-    /*
-     * main loop to fill up ssaInfos
-     */
-    while (!flowStack.empty())
+    /* forward dataflow over code blocks: queue states at start of code block are
+     * joined queue states from ends of previous code blocks. Queue states at end of
+     * code block are queue states at start joined with queue states of this block.
+     * Code blocks are processed in reverse postorder until fixed point. */
+    const size_t blocksNum = codeBlocks.size();
+    std::vector<std::vector<size_t> > succs(blocksNum);
+    std::vector<size_t> postOrder;
     {
-        WaitFlowStackEntry0& entry = flowStack.back();
-        const CodeBlock& cblock = codeBlocks[entry.blockIndex];
-        WaitCodeBlock& wblock = waitCodeBlocks[entry.blockIndex];
-        
-        if (entry.nextIndex == 0)
+        std::vector<bool> visited(blocksNum, false);
+        std::deque<FlowStackEntry2> flowStack;
+        flowStack.push_back({ 0, 0 });
+        visited[0] = true;
+        while (!flowStack.empty())
         {
-            // process current block
-            if (!visited[entry.blockIndex])
+            FlowStackEntry2& entry = flowStack.back();
+            const CodeBlock& cblock = codeBlocks[entry.blockIndex];
+            size_t nextBlock = SIZE_MAX;
+            if (entry.nextIndex < cblock.nexts.size())
+                nextBlock = cblock.nexts[entry.nextIndex].block;
+            else if (((entry.nextIndex==0 && cblock.nexts.empty()) ||
+                    // if have any call then go to next block
+                    (cblock.haveCalls && entry.nextIndex==cblock.nexts.size())) &&
+                    !cblock.haveReturn && !cblock.haveEnd &&
+                    entry.blockIndex+1 < blocksNum)
+                nextBlock = entry.blockIndex+1;
+            
+            if (nextBlock != SIZE_MAX)
             {
-                uint16_t minExtraQueueSizes[ASM_WAIT_MAX_TYPES_NUM];
-                visited[entry.blockIndex] = true;
-                std::vector<WaitInstrXInfo> thisWaitInstrs;
-                generateWaitInstrsWhileJoining(waitConfig, entry.queues, wblock.firstRegs,
-                            thisWaitInstrs, minExtraQueueSizes, onlyWarnings);
-                // insert to firstWaitInstrs in wblock
-                wblock.firstWaitInstrs.insert(wblock.firstWaitInstrs.end(),
-                            thisWaitInstrs.begin(), thisWaitInstrs.end());
-                // code to join queue state in previous with current block
-                for (cxuint q = 0; q < waitConfig.waitQueuesNum; q++)
+                entry.nextIndex++;
+                succs[entry.blockIndex].push_back(nextBlock);
+                if (!visited[nextBlock])
                 {
-                    if (minExtraQueueSizes[q]!=UINT16_MAX &&
-                        !wblock.queues[q].reallyFlushed)
-                        entry.queues[q].requestedQueueSize = std::min(
-                            size_t(entry.queues[q].requestedQueueSize),
-                            minExtraQueueSizes[q] + wblock.queues[q].ordered.size());
-                    entry.queues[q].joinNext(wblock.queues[q]);
+                    visited[nextBlock] = true;
+                    flowStack.push_back({ nextBlock, 0 });
                 }
             }
             else
             {
-                cblocksToCache.increase(entry.blockIndex);
-                ARDOut << "jcblockToCache: " << entry.blockIndex << "=" <<
-                            cblocksToCache.count(entry.blockIndex) << "\n";
-                
-                // back, already visited
+                postOrder.push_back(entry.blockIndex);
                 flowStack.pop_back();
-                
-                size_t curWayBIndex = flowStack.back().blockIndex;
-                if (lastCommonCacheWayPoint.first != SIZE_MAX)
-                {
-                    // mark point of way to cache (res first point)
-                    waysToCache[lastCommonCacheWayPoint.first] = true;
-                    ARDOut << "mark to pfcache " <<
-                            lastCommonCacheWayPoint.first << ", " <<
-                            curWayBIndex << "\n";
-                    prevWaysIndexMap[curWayBIndex] = lastCommonCacheWayPoint;
-                }
-                lastCommonCacheWayPoint = { curWayBIndex, flowStack.size()-1 };
-                ARDOut << "lastCcwP: " << curWayBIndex << "\n";
-                continue;
             }
         }
+    }
+    // order index of code block (in reverse postorder)
+    std::vector<size_t> blockOrderIndices(blocksNum, SIZE_MAX);
+    for (size_t i = 0; i < postOrder.size(); i++)
+        blockOrderIndices[postOrder[postOrder.size()-1-i]] = i;
+    
+    std::vector<WaitQueueStates> startStates(blocksNum);
+    std::vector<WaitQueueStates> endStates(blocksNum);
+    for (size_t i = 0; i < blocksNum; i++)
+    {
+        startStates[i].setMaxQueueSizes(waitConfig);
+        endStates[i].setMaxQueueSizes(waitConfig);
+    }
+    startStates[0].defined = true;
+    
+    /* queue states at start of blocks are only joined (grow), and they are bounded
+     * by queue sizes and used registers, hence iteration always reaches fixed point */
+    std::vector<bool> processedBlocks(blocksNum, false);
+    // worklist - key is order index of the code block
+    std::set<size_t> worklist;
+    worklist.insert(blockOrderIndices[0]);
+    
+    while (!worklist.empty())
+    {
+        const size_t blockIndex = postOrder[postOrder.size()-1-*worklist.begin()];
+        worklist.erase(worklist.begin());
+        blockVisitsNum++;
+        WaitCodeBlock& wblock = waitCodeBlocks[blockIndex];
         
-        if (!callStack.empty() &&
-            entry.blockIndex == callStack.back().callBlock.index &&
-            entry.nextIndex-1 == callStack.back().callNextIndex)
-        {
-            const BlockIndex routineBlock = callStack.back().routineBlock;
-            callBlocks.erase(routineBlock);
-            callStack.pop_back(); // just return from call
-        }
-        
-        if (entry.nextIndex < cblock.nexts.size())
-        {
-            size_t nextBlock = cblock.nexts[entry.nextIndex].block;
-            //nextBlock.pass = entry.blockIndex.pass;
-            
-            flowStack.push_back(WaitFlowStackEntry0(nextBlock, 0, waitConfig));
-            entry.nextIndex++;
-        }
-        
-        else if (((entry.nextIndex==0 && cblock.nexts.empty()) ||
-                // if have any call then go to next block
-                (cblock.haveCalls && entry.nextIndex==cblock.nexts.size())) &&
-                 !cblock.haveReturn && !cblock.haveEnd)
+        WaitQueueStates state = startStates[blockIndex];
+        std::vector<WaitInstrXInfo> thisWaitInstrs;
+        generateWaitInstrsWhileJoining(waitConfig, state.queues, wblock.firstRegs,
+                    thisWaitInstrs, onlyWarnings);
+        // code to join queue state in previous with current block
+        for (cxuint q = 0; q < waitConfig.waitQueuesNum; q++)
         {
-            if (entry.nextIndex!=0) // if back from calls (just return from calls)
+            // entries that stay in queue after all waits in this block
+            cxuint keptSize = wblock.extras[q];
+            bool clearRandom = (wblock.zeroWaitMask & (1U<<q)) != 0;
+            for (const WaitInstrXInfo& wi: thisWaitInstrs)
             {
+                keptSize = std::min(keptSize, cxuint(wi.waits[q] > wi.pushed[q] ?
+                            wi.waits[q] - wi.pushed[q] : 0));
+                clearRandom |= (wi.waits[q] == 0);
             }
-            flowStack.push_back(WaitFlowStackEntry0(entry.blockIndex+1, 0, waitConfig));
-            entry.nextIndex++;
+            state.queues[q].joinNext(wblock.queues[q], keptSize, clearRandom);
         }
-        else
+        
+        WaitQueueStates& endState = endStates[blockIndex];
+        processedBlocks[blockIndex] = true;
+        // stop if no change
+        if (endState.defined && endState.sameStates(state, waitConfig))
+            continue;
+        endState = state;
+        
+        // propagate to next blocks
+        for (size_t nextBlock: succs[blockIndex])
         {
-            // back
-            flowStack.pop_back();
-            
-            if (!flowStack.empty() && lastCommonCacheWayPoint.first != SIZE_MAX &&
-                    lastCommonCacheWayPoint.second >= flowStack.size())
+            WaitQueueStates& nextState = startStates[nextBlock];
+            if (!nextState.defined)
+                nextState = endState;
+            else
             {
-                lastCommonCacheWayPoint =
-                        { flowStack.back().blockIndex, flowStack.size()-1 };
-                ARDOut << "POPlastCcwP: " << lastCommonCacheWayPoint.first << "\n";
+                const WaitQueueStates oldState = nextState;
+                for (cxuint q = 0; q < waitConfig.waitQueuesNum; q++)
+                    nextState.queues[q].joinWay(endState.queues[q]);
+                if (processedBlocks[nextBlock] &&
+                    nextState.sameStates(oldState, waitConfig))
+                    continue; // no change
             }
+            worklist.insert(blockOrderIndices[nextBlock]);
         }
     }
     
-    // after, that resolve joins (join with already visited code)
-    // next loop
-    flowStack.clear();
-    std::deque<FlowStackEntry2> flowStack2;
+    // generate wait instructions at start of code blocks from final queue states
+    for (size_t blockIndex: postOrder)
+    {
+        WaitCodeBlock& wblock = waitCodeBlocks[blockIndex];
+        wblock.firstWaitInstrs.clear();
+        generateWaitInstrsWhileJoining(waitConfig, startStates[blockIndex].queues,
+                    wblock.firstRegs, wblock.firstWaitInstrs, onlyWarnings);
+    }
     
-    std::fill(visited.begin(), visited.end(), false);
-    flowStack2.push_back({ 0, 0 });
-    SimpleCache<size_t, WaitFirstCacheEntry> resFirstPointsCache(codeBlocks.size()*256);
-    SimpleCache<size_t, WaitSecCacheEntry> resSecondPointsCache(codeBlocks.size()*128);
+    /* collect all needed wait instructions. each wait is placed just before
+     * first instruction that uses a register. waits at same place are merged
+     * into one wait instruction (with all wait queues) */
+    neededWaitInstrs.clear();
+    for (const WaitCodeBlock& wblock: waitCodeBlocks)
+    {
+        for (const WaitInstrXInfo& wi: wblock.firstWaitInstrs)
+        {
+            AsmWaitInstr waitInstr{ wi.offset, { } };
+            std::copy(wi.waits, wi.waits + waitConfig.waitQueuesNum, waitInstr.waits);
+            neededWaitInstrs.push_back(waitInstr);
+        }
+        neededWaitInstrs.insert(neededWaitInstrs.end(), wblock.waitInstrs.begin(),
+                    wblock.waitInstrs.end());
+    }
+    std::stable_sort(neededWaitInstrs.begin(), neededWaitInstrs.end(),
+              [](const AsmWaitInstr& a, const AsmWaitInstr& b)
+              { return a.offset < b.offset; });
+    size_t j = 0;
+    for (size_t i = 0; i < neededWaitInstrs.size(); i++)
+    {
+        const AsmWaitInstr& wi = neededWaitInstrs[i];
+        bool noWait = true;
+        for (cxuint q = 0; q < waitConfig.waitQueuesNum; q++)
+            if (wi.waits[q] < waitConfig.waitQueueSizes[q]-1)
+                noWait = false;
+        if (noWait)
+            continue; // skip wait that does not wait for anything
+        if (j != 0 && neededWaitInstrs[j-1].offset == wi.offset)
+        {
+            // merge with previous wait instr
+            for (cxuint q = 0; q < waitConfig.waitQueuesNum; q++)
+                neededWaitInstrs[j-1].waits[q] = std::min(
+                            neededWaitInstrs[j-1].waits[q], wi.waits[q]);
+            continue;
+        }
+        neededWaitInstrs[j++] = wi;
+    }
+    neededWaitInstrs.resize(j);
+}
+
+/* Assembler::checkWaitInstrs */
+
+static const char* gcnWaitQueueNames[ASM_WAIT_MAX_TYPES_NUM] =
+{ "vmcnt", "lgkmcnt", "expcnt", "vscnt" };
+
+// get source position of instruction at offset in section
+static AsmSourcePos getSourcePosForOffset(const AsmSection& section, size_t offset)
+{
+    const AsmSourcePosHandler& posHandler = section.sourcePosHandler;
+    AsmSourcePosHandler::ReadPos readPos = posHandler.findPositionByOffset(offset);
+    if (!posHandler.hasNext(readPos))
+        return AsmSourcePos{};
+    return const_cast<AsmSourcePosHandler&>(posHandler).nextSourcePos(readPos).second;
+}
+
+/* schedule wait instructions in code section. return false if section has
+ * register variables (they have not real registers) */
+static bool scheduleSectionWaits(Assembler& assembler, const AsmSection& section,
+            bool sinkWaits, std::vector<AsmWaitInstr>& neededWaitInstrs)
+{
+    AsmRegAllocator regAlloc(assembler);
+    regAlloc.createCodeStructure(section.codeFlow, section.content.size(),
+                section.content.data());
+    regAlloc.createSSAData(*section.usageHandler, *section.linearDepHandler);
+    for (const CodeBlock& cblock: regAlloc.getCodeBlocks())
+        for (const auto& entry: cblock.ssaInfoMap)
+            if (entry.first.regVar != nullptr)
+                return false;
     
-    while (!flowStack2.empty())
+    AsmWaitScheduler waitScheduler(assembler.getISAAssembler()->getWaitConfig(),
+                assembler, regAlloc.getCodeBlocks(), regAlloc.getVregIndexMaps(),
+                nullptr, false);
+    waitScheduler.setSinkWaits(sinkWaits);
+    waitScheduler.schedule(*section.usageHandler, *section.waitHandler);
+    neededWaitInstrs = waitScheduler.getNeededWaitInstrs();
+    return true;
+}
+
+void Assembler::checkWaitInstrs()
+{
+    const AsmWaitConfig& waitConfig = isaAssembler->getWaitConfig();
+    for (AsmSection& section: sections)
     {
-        FlowStackEntry2& entry = flowStack2.back();
-        const CodeBlock& cblock = codeBlocks[entry.blockIndex];
+        if (section.type != AsmSectionType::CODE || section.content.empty() ||
+            section.usageHandler == nullptr || section.waitHandler == nullptr)
+            continue;
         
-        if (entry.nextIndex == 0)
+        std::vector<AsmWaitInstr> neededWaitInstrs;
+        try
         {
-            // process current block
-            if (!visited[entry.blockIndex])
-                visited[entry.blockIndex] = true;
-            else
-            {
-                /*resolveSSAConflicts(flowStack2, routineMap, codeBlocks,
-                            prevWaysIndexMap, waysToCache, cblocksToCache,
-                            resFirstPointsCache, resSecondPointsCache, ssaReplacesMap);*/
-                
-                // back, already visited
-                flowStack2.pop_back();
+            // register variables have not real registers, hence skip section
+            if (!scheduleSectionWaits(*this, section, false, neededWaitInstrs))
                 continue;
+        }
+        catch(const AsmException& ex)
+        {
+            std::string message = "Can't check wait instructions in section '";
+            message += section.name;
+            message += "': ";
+            message += ex.what();
+            printWarning(getSourcePosForOffset(section, 0), message.c_str());
+            continue;
+        }
+        
+        // collect user wait instructions
+        std::unordered_map<size_t, AsmWaitInstr> userWaitInstrs;
+        ISAWaitHandler::ReadPos waitPos{ 0, 0 };
+        AsmWaitInstr waitInstr;
+        AsmDelayedOp delayedOp;
+        while (section.waitHandler->hasNext(waitPos))
+            if (section.waitHandler->nextInstr(waitPos, delayedOp, waitInstr))
+                userWaitInstrs.insert({ waitInstr.offset, waitInstr });
+        
+        for (const AsmWaitInstr& neededWaitI: neededWaitInstrs)
+        {
+            auto uwit = userWaitInstrs.find(neededWaitI.offset);
+            std::string message = (uwit == userWaitInstrs.end()) ?
+                    "Missing wait instruction: s_waitcnt" :
+                    "Insufficient wait instruction, required: s_waitcnt";
+            bool sufficient = true;
+            for (cxuint q = 0; q < waitConfig.waitQueuesNum; q++)
+            {
+                if (neededWaitI.waits[q] >= waitConfig.waitQueueSizes[q]-1)
+                    continue; // no wait for this queue
+                if (uwit == userWaitInstrs.end() ||
+                    uwit->second.waits[q] > neededWaitI.waits[q])
+                    sufficient = false;
+                char buf[16];
+                itocstrCStyle(neededWaitI.waits[q], buf, 16);
+                message += ' ';
+                message += gcnWaitQueueNames[q];
+                message += '(';
+                message += buf;
+                message += ')';
             }
+            if (!sufficient)
+                printWarning(getSourcePosForOffset(section, neededWaitI.offset),
+                            message.c_str());
         }
+    }
+}
+
+/* Assembler::sinkWaitInstrs */
+
+// GCN s_barrier instruction (SOPP encoding)
+static const uint32_t gcnSBarrierCode = 0xbf8a0000U;
+
+void Assembler::sinkWaitInstrs()
+{
+    waitPlaces.clear();
+    for (AsmSectionId sectionId = 0; sectionId < sections.size(); sectionId++)
+    {
+        const AsmSection& section = sections[sectionId];
+        if (section.type != AsmSectionType::CODE || section.content.empty() ||
+            section.usageHandler == nullptr || section.waitHandler == nullptr ||
+            sectionId >= sectionInstrOffsets.size())
+            continue;
         
-        if (entry.nextIndex < cblock.nexts.size())
+        std::vector<AsmWaitInstr> neededWaitInstrs;
+        try
+        {
+            // register variables have not real registers, hence skip section
+            if (!scheduleSectionWaits(*this, section, true, neededWaitInstrs))
+                continue;
+        }
+        catch(const AsmException& ex)
         {
-            flowStack2.push_back({ cblock.nexts[entry.nextIndex].block, 0 });
-            entry.nextIndex++;
+            std::string message = "Can't sink wait instructions in section '";
+            message += section.name;
+            message += "': ";
+            message += ex.what();
+            printWarning(getSourcePosForOffset(section, 0), message.c_str());
+            continue;
         }
-        else if (((entry.nextIndex==0 && cblock.nexts.empty()) ||
-                // if have any call then go to next block
-                (cblock.haveCalls && entry.nextIndex==cblock.nexts.size())) &&
-                 !cblock.haveReturn && !cblock.haveEnd)
+        
+        const std::vector<size_t>& instrOffsets = sectionInstrOffsets[sectionId];
+        auto findInstrIndex = [&instrOffsets](size_t offset)
+        {
+            auto it = std::lower_bound(instrOffsets.begin(), instrOffsets.end(), offset);
+            return (it != instrOffsets.end() && *it == offset) ?
+                    size_t(it - instrOffsets.begin()) : SIZE_MAX;
+        };
+        
+        std::vector<AsmWaitPlace> sectWaitPlaces;
+        /* remove user wait instructions, because needed waits are placed
+         * just before first use of registers. keep waits before s_barrier, because
+         * they can order memory accesses between work-items (not registers) */
+        ISAWaitHandler::ReadPos waitPos{ 0, 0 };
+        AsmWaitInstr waitInstr;
+        AsmDelayedOp delayedOp;
+        while (section.waitHandler->hasNext(waitPos))
         {
-            flowStack2.push_back({ entry.blockIndex+1, 0 });
-            entry.nextIndex++;
+            if (!section.waitHandler->nextInstr(waitPos, delayedOp, waitInstr))
+                continue;
+            const size_t instrIndex = findInstrIndex(waitInstr.offset);
+            if (instrIndex == SIZE_MAX)
+                continue;
+            if (instrIndex+1 < instrOffsets.size())
+            {
+                const size_t nextOffset = instrOffsets[instrIndex+1];
+                if (nextOffset+4 <= section.content.size() &&
+                    ULEV(*reinterpret_cast<const uint32_t*>(
+                            section.content.data() + nextOffset)) == gcnSBarrierCode)
+                    continue;
+            }
+            sectWaitPlaces.push_back({ sectionId, instrIndex, true, waitInstr });
         }
-        else // back
+        // insert needed wait instructions
+        for (const AsmWaitInstr& neededWaitI: neededWaitInstrs)
         {
-            /*if (cblocksToCache.count(entry.blockIndex)==2 &&
-                !resSecondPointsCache.hasKey(entry.blockIndex))
-                // add to cache
-                addResSecCacheEntry(routineMap, codeBlocks, resSecondPointsCache,
-                            entry.blockIndex);*/
-            flowStack2.pop_back();
+            const size_t instrIndex = findInstrIndex(neededWaitI.offset);
+            if (instrIndex != SIZE_MAX)
+                sectWaitPlaces.push_back({ sectionId, instrIndex, false, neededWaitI });
         }
+        std::sort(sectWaitPlaces.begin(), sectWaitPlaces.end(),
+                  [](const AsmWaitPlace& a, const AsmWaitPlace& b)
+                  { return a.instrIndex < b.instrIndex; });
+        waitPlaces.insert(waitPlaces.end(), sectWaitPlaces.begin(), sectWaitPlaces.end());
+    }
+}
+
+bool Assembler::placeWaitInstr()
+{
+    if (sectionInstrsNums.size() <= currentSection)
+        sectionInstrsNums.resize(currentSection+1, 0);
+    const size_t instrIndex = sectionInstrsNums[currentSection]++;
+    if (collectInstrOffsets)
+    {
+        if (sectionInstrOffsets.size() <= currentSection)
+            sectionInstrOffsets.resize(currentSection+1);
+        sectionInstrOffsets[currentSection].push_back(currentOutPos);
+        return true;
+    }
+    
+    auto it = std::lower_bound(waitPlaces.begin(), waitPlaces.end(),
+            std::make_pair(currentSection, instrIndex),
+            [](const AsmWaitPlace& a, const std::pair<AsmSectionId, size_t>& b)
+            { return a.sectionId < b.first ||
+                    (a.sectionId == b.first && a.instrIndex < b.second); });
+    if (it == waitPlaces.end() || it->sectionId != currentSection ||
+        it->instrIndex != instrIndex)
+        return true;
+    if (it->remove)
+        return false;
+    
+    // insert wait instruction before this instruction
+    const AsmWaitConfig& waitConfig = isaAssembler->getWaitConfig();
+    std::string waitStmt = "s_waitcnt";
+    const size_t argsPos = waitStmt.size();
+    for (cxuint q = 0; q < waitConfig.waitQueuesNum; q++)
+    {
+        if (it->waitInstr.waits[q] >= waitConfig.waitQueueSizes[q]-1)
+            continue; // no wait for this queue
+        char buf[16];
+        itocstrCStyle(it->waitInstr.waits[q], buf, 16);
+        if (waitStmt.size() != argsPos)
+            waitStmt += " &";
+        waitStmt += ' ';
+        waitStmt += gcnWaitQueueNames[q];
+        waitStmt += '(';
+        waitStmt += buf;
+        waitStmt += ')';
     }
+    // instruction is parsed from current line, hence replace it temporarily
+    const char* oldLine = line;
+    const size_t oldLineSize = lineSize;
+    line = waitStmt.c_str();
+    lineSize = waitStmt.size();
+    AsmSection& section = sections[currentSection];
+    isaAssembler->assemble("s_waitcnt", line, line + argsPos, line + lineSize,
+                section.content, section.usageHandler.get(), section.waitHandler.get());
+    line = oldLine;
+    lineSize = oldLineSize;
+    currentOutPos = section.getSize();
+    return true;
 }
@@ -787,6 +787,7 @@ Assembler::Assembler(const CString& filename, std::istream& input, Flags _flags,
     good = true;
     resolvingRelocs = false;
     collectSourcePoses = false;
+    collectInstrOffsets = false;
     formatHandler = nullptr;
     input.exceptions(std::ios::badbit);
     std::unique_ptr<AsmInputFilter> thatInputFilter(
@@ -830,6 +831,7 @@ Assembler::Assembler(const Array<CString>& _filenames, Flags _flags,
     good = true;
     resolvingRelocs = false;
     collectSourcePoses = false;
+    collectInstrOffsets = false;
     formatHandler = nullptr;
     if (filenames.empty())
         throw AsmException("Filename list is empty");
@@ -2711,7 +2713,7 @@ void Assembler::initializeOutputFormat()
             formatHandler = new AsmRawCodeHandler(*this);
             break;
     }
-    isaAssembler = new GCNAssembler(*this);
+    createISAAssembler();
     // add first section
     auto info = formatHandler->getSectionInfo(currentSection);
     sections.push_back({ info.name, currentKernel, info.type, info.flags, 0,
@@ -2719,6 +2721,13 @@ void Assembler::initializeOutputFormat()
     currentOutPos = 0;
 }
 
+ISAAssembler* Assembler::createISAAssembler()
+{
+    if (isaAssembler == nullptr)
+        isaAssembler = new GCNAssembler(*this);
+    return isaAssembler;
+}
+
 bool Assembler::getRegVar(const CString& name, const AsmRegVar*& regVar)
 { 
     regVar = nullptr;
@@ -2876,6 +2885,12 @@ bool Assembler::assemble()
                     "was ignored" << std::endl;
     
     good = true;
+    // source positions are needed to print warnings about waits
+    collectSourcePoses = (flags & (ASM_CHECKWAITS|ASM_SINKWAITS)) != 0;
+    // offsets of instructions are needed to find wait places (if not given)
+    collectInstrOffsets = (flags & ASM_SINKWAITS) != 0 && waitPlaces.empty();
+    sectionInstrsNums.clear();
+    sectionInstrOffsets.clear();
     while (!endOfAssembly)
     {
         if (!lineAlreadyRead)
@@ -3061,6 +3076,9 @@ bool Assembler::assemble()
                 if (sections[currentSection].waitHandler == nullptr)
                     sections[currentSection].waitHandler.reset(new ISAWaitHandler());
                 
+                if ((collectInstrOffsets || !waitPlaces.empty()) && !placeWaitInstr())
+                    continue; // remove user wait instruction
+                
                 isaAssembler->assemble(firstName, stmtPlace, linePtr, end,
                            sections[currentSection].content,
                            sections[currentSection].usageHandler.get(),
@@ -3134,6 +3152,11 @@ bool Assembler::assemble()
     
     printUnresolvedSymbols(&globalScope);
     
+    if (good && (flags & ASM_CHECKWAITS) != 0 && isaAssembler != nullptr)
+        checkWaitInstrs();
+    if (good && collectInstrOffsets && isaAssembler != nullptr)
+        sinkWaitInstrs();
+    
     if (good && formatHandler!=nullptr)
     {
         // code opened regions for kernels
@@ -26,6 +26,8 @@
 #include <memory>
 #include <vector>
 #include <utility>
+#include <atomic>
+#include <algorithm>
 #include <CLRX/utils/Utilities.h>
 #include <CLRX/utils/MemAccess.h>
 #include <CLRX/amdbin/AmdCL2Binaries.h>
@@ -54,7 +56,151 @@ struct CLRX_INTERNAL AmdCL2Types64: Elf64Types
     static const size_t newMetadataHeaderSize = 0x110;
 };
 
+AmdCL2DisasmKernelLoader::~AmdCL2DisasmKernelLoader()
+{ }
+
+const AmdCL2DisasmKernelInput& AmdCL2DisasmInput::getKernel(size_t index) const
+{
+    if (kernelLoader)
+        kernelLoader->loadKernel(index);
+    return kernels[index];
+}
+
+// section indices of data sections of inner binary (symbols of text relocations)
+struct CLRX_INTERNAL AmdCL2DataSectionIndices
+{
+    uint16_t gData;
+    uint16_t rwData;
+    uint16_t bssData;
+};
+
+// get text relocation from inner binary
+static AmdCL2RelaEntry getAmdCL2TextReloc(const AmdCL2InnerGPUBinary& innerBin,
+            size_t relaIndex, size_t offset, const AmdCL2DataSectionIndices& dataIndices)
+{
+    const Elf64_Rela& rela = innerBin.getTextRelaEntry(relaIndex);
+    uint32_t symIndex = ELF64_R_SYM(ULEV(rela.r_info));
+    int64_t addend = ULEV(rela.r_addend);
+    // check this symbol
+    const Elf64_Sym& sym = innerBin.getSymbol(symIndex);
+    uint16_t symShndx = ULEV(sym.st_shndx);
+    if (symShndx!=dataIndices.gData && symShndx!=dataIndices.rwData &&
+        symShndx!=dataIndices.bssData)
+        throw DisasmException("Symbol is not placed in global or "
+                "rwdata data or bss is illegal");
+    addend += ULEV(sym.st_value);
+    cxuint rsym = (symShndx==dataIndices.rwData) ? 1 : 
+        ((symShndx==dataIndices.bssData) ? 2 : 0);
+    // determine relocation type
+    RelocType relocType;
+    uint32_t rtype = ELF64_R_TYPE(ULEV(rela.r_info));
+    if (rtype==1)
+        relocType = RELTYPE_LOW_32BIT;
+    else if (rtype==2)
+        relocType = RELTYPE_HIGH_32BIT;
+    else
+        throw DisasmException("Unknown relocation type");
+    return AmdCL2RelaEntry{ offset, relocType, rsym, addend };
+}
+
+/* loader of kernel code, setup, stub and text relocations from binary.
+ * errors in kernel datas are reported when kernel is used by disassembler */
+template<typename AmdCL2Types>
+class CLRX_INTERNAL AmdCL2BinaryKernelLoader: public AmdCL2DisasmKernelLoader
+{
+private:
+    const typename AmdCL2Types::AmdCL2MainBinary& binary;
+    AmdCL2DisasmInput* input;
+    bool isInnerNewBinary;
+    bool kernelRelocs;  // if text relocations are put to kernel inputs
+    std::vector<std::pair<size_t, size_t> > sortedRelocs; // by offset
+    const cxbyte* textPtr;
+    AmdCL2DataSectionIndices dataIndices;
+    std::unique_ptr<OnceFlag[]> onceFlags;
+    mutable std::atomic<size_t> loadedKernels;
+    mutable std::atomic<size_t> loadedRelocs;
+    
+    void loadKernelData(size_t index) const;
+public:
+    AmdCL2BinaryKernelLoader(const typename AmdCL2Types::AmdCL2MainBinary& _binary,
+            AmdCL2DisasmInput* _input, bool _isInnerNewBinary, bool _kernelRelocs,
+            std::vector<std::pair<size_t, size_t> >&& _sortedRelocs,
+            const cxbyte* _textPtr, const AmdCL2DataSectionIndices& _dataIndices)
+            : binary(_binary), input(_input), isInnerNewBinary(_isInnerNewBinary),
+              kernelRelocs(_kernelRelocs), sortedRelocs(std::move(_sortedRelocs)),
+              textPtr(_textPtr), dataIndices(_dataIndices),
+              onceFlags(new OnceFlag[_input->kernels.size()]),
+              loadedKernels(0), loadedRelocs(0)
+    { }
+    
+    void loadKernel(size_t index) const
+    { callOnce(onceFlags[index], [this, index]() { loadKernelData(index); }); }
+};
+
+template<typename AmdCL2Types>
+void AmdCL2BinaryKernelLoader<AmdCL2Types>::loadKernelData(size_t index) const
+{
+    AmdCL2DisasmKernelInput& kinput = input->kernels[index];
+    kinput.code = nullptr;
+    kinput.codeSize = 0;
+    kinput.setup = nullptr;
+    kinput.setupSize = 0;
+    kinput.stub = nullptr;
+    kinput.stubSize = 0;
+    kinput.textRelocs.clear();
+    if (!binary.hasInnerBinary())
+        return; // nothing else to set
+    
+    // get kernel code, setup and stub content (created by binary at first access)
+    const AmdCL2InnerGPUBinaryBase& innerBin = binary.getInnerBinaryBase();
+    const AmdCL2GPUKernel* kernelData = nullptr;
+    if (index < innerBin.getKernelsNum())
+        kernelData = &innerBin.getKernelData(index);
+    if (kernelData==nullptr || kernelData->kernelName != kinput.kernelName)
+        kernelData = &innerBin.getKernelData(kinput.kernelName.c_str());
+    
+    // if set kernel code and kernel setup (AMD HSA config)
+    kinput.code = kernelData->code;
+    kinput.codeSize = kernelData->codeSize;
+    kinput.setup = kernelData->setup;
+    kinput.setupSize = kernelData->setupSize;
+    if (!isInnerNewBinary)
+    {
+        // old drivers
+        const AmdCL2OldInnerGPUBinary& oldInnerBin = binary.getOldInnerBinary();
+        const AmdCL2GPUKernelStub* kstub = nullptr;
+        if (index < innerBin.getKernelsNum() && kernelData->kernelName == kinput.kernelName)
+            kstub = &oldInnerBin.getKernelStub(index);
+        else
+            kstub = &oldInnerBin.getKernelStub(kinput.kernelName.c_str());
+        kinput.stubSize = kstub->size;
+        kinput.stub = kstub->data;
+    }
+    
+    if (kernelRelocs)
+    {
+        // put text relocations in kernel code (offset relative to kernel code)
+        const AmdCL2InnerGPUBinary& innerBin = binary.getInnerBinary();
+        const size_t codeStart = kinput.code - textPtr;
+        const size_t codeEnd = codeStart + kinput.codeSize;
+        auto relocIt = std::lower_bound(sortedRelocs.begin(), sortedRelocs.end(),
+                std::make_pair(codeStart, size_t(0)));
+        std::vector<AmdCL2RelaEntry> textRelocs;
+        for (; relocIt != sortedRelocs.end() && relocIt->first <= codeEnd; ++relocIt)
+            textRelocs.push_back(getAmdCL2TextReloc(innerBin, relocIt->second,
+                        relocIt->first - codeStart, dataIndices));
+        kinput.textRelocs = std::move(textRelocs);
+        loadedRelocs.fetch_add(kinput.textRelocs.size());
+    }
+    // after loading all kernels check whether all relocations are in kernel code
+    if (loadedKernels.fetch_add(1)+1 == input->kernels.size() &&
+        loadedRelocs.load() < sortedRelocs.size())
+        throw DisasmException("Code relocation offset outside kernel code");
+}
+
 // generate AMD CL2.0 disasm input from main binary
+/* kernel code, setup, stub and text relocations are loaded from binary when
+ * kernel is used by disassembler */
 template<typename AmdCL2Types>
 static AmdCL2DisasmInput* getAmdCL2DisasmInputFromBinary(
             const typename AmdCL2Types::AmdCL2MainBinary& binary, cxuint driverVersion,
@@ -95,9 +241,7 @@ static AmdCL2DisasmInput* getAmdCL2DisasmInputFromBinary(
     const size_t kernelInfosNum = binary.getKernelInfosNum();
     
     // set section indices as undefined
-    uint16_t gDataSectionIdx = SHN_UNDEF;
-    uint16_t rwDataSectionIdx = SHN_UNDEF;
-    uint16_t bssDataSectionIdx = SHN_UNDEF;
+    AmdCL2DataSectionIndices dataIndices{ SHN_UNDEF, SHN_UNDEF, SHN_UNDEF };
     
     if (isInnerNewBinary)
     {
@@ -131,15 +275,15 @@ static AmdCL2DisasmInput* getAmdCL2DisasmInputFromBinary(
         
         // getting optional sections in inner binary
         try
-        { gDataSectionIdx = innerBin.getSectionIndex(".hsadata_readonly_agent"); }
+        { dataIndices.gData = innerBin.getSectionIndex(".hsadata_readonly_agent"); }
         catch(const Exception& ex)
         { }
         try
-        { rwDataSectionIdx = innerBin.getSectionIndex(".hsadata_global_agent"); }
+        { dataIndices.rwData = innerBin.getSectionIndex(".hsadata_global_agent"); }
         catch(const Exception& ex)
         { }
         try
-        { bssDataSectionIdx = innerBin.getSectionIndex(".hsabss_global_agent"); }
+        { dataIndices.bssData = innerBin.getSectionIndex(".hsabss_global_agent"); }
         catch(const Exception& ex)
         { }
         // relocations for global data section (sampler symbols)
@@ -169,55 +313,26 @@ static AmdCL2DisasmInput* getAmdCL2DisasmInputFromBinary(
                 size_t(value>>3) });
         }
         
+        if (hsaLayout)
+        {
+            // put text relocations to main input
+            for (const auto& reloc: sortedRelocs)
+                input->textRelocs.push_back(getAmdCL2TextReloc(innerBin,
+                            reloc.second, reloc.first, dataIndices));
+            sortedRelocs.clear();
+        }
     }
     else if (kernelInfosNum==0)
         return input.release();
     
+    // preparing kernel inputs (without kernel datas)
     input->kernels.resize(kernelInfosNum);
-    auto sortedRelocIter = sortedRelocs.begin();
-    if (isInnerNewBinary && hsaLayout)
-    {
-        const AmdCL2InnerGPUBinary& innerBin = binary.getInnerBinary();
-        // put textRelocations to main input
-        for (; sortedRelocIter != sortedRelocs.end(); ++sortedRelocIter)
-        {
-            // add relocations
-            const Elf64_Rela& rela = innerBin.getTextRelaEntry(
-                        sortedRelocIter->second);
-            uint32_t symIndex = ELF64_R_SYM(ULEV(rela.r_info));
-            int64_t addend = ULEV(rela.r_addend);
-            cxuint rsym = 0;
-            // check this symbol
-            const Elf64_Sym& sym = innerBin.getSymbol(symIndex);
-            uint16_t symShndx = ULEV(sym.st_shndx);
-            if (symShndx!=gDataSectionIdx && symShndx!=rwDataSectionIdx &&
-                symShndx!=bssDataSectionIdx)
-                throw DisasmException("Symbol is not placed in global or "
-                        "rwdata data or bss is illegal");
-            addend += ULEV(sym.st_value);
-            rsym = (symShndx==rwDataSectionIdx) ? 1 : 
-                ((symShndx==bssDataSectionIdx) ? 2 : 0);
-            // determine relocation type
-            RelocType relocType;
-            uint32_t rtype = ELF64_R_TYPE(ULEV(rela.r_info));
-            if (rtype==1)
-                relocType = RELTYPE_LOW_32BIT;
-            else if (rtype==2)
-                relocType = RELTYPE_HIGH_32BIT;
-            else
-                throw DisasmException("Unknown relocation type");
-            // put text relocs. compute offset by subtracting current code offset
-            input->textRelocs.push_back(AmdCL2RelaEntry{sortedRelocIter->first,
-                        relocType, rsym, addend });
-        }
-    }
-    
-    // preparing kernel inputs
     for (cxuint i = 0; i < kernelInfosNum; i++)
     {
-        const KernelInfo& kernelInfo = binary.getKernelInfo(i);
+        // kernel info (with parsed arguments) is not needed, only kernel name
+        const AmdCL2GPUKernelMetadata& metadata = binary.getMetadataEntry(i);
         AmdCL2DisasmKernelInput& kinput = input->kernels[i];
-        kinput.kernelName = kernelInfo.kernelName;
+        kinput.kernelName = metadata.kernelName;
         kinput.metadataSize = binary.getMetadataSize(i);
         kinput.metadata = binary.getMetadata(i);
         
@@ -227,12 +342,12 @@ static AmdCL2DisasmInput* getAmdCL2DisasmInputFromBinary(
         const AmdCL2GPUKernelMetadata* isaMetadata = nullptr;
         if (i < binary.getISAMetadatasNum())
             isaMetadata = &binary.getISAMetadataEntry(i);
-        if (isaMetadata == nullptr || isaMetadata->kernelName != kernelInfo.kernelName)
+        if (isaMetadata == nullptr || isaMetadata->kernelName != metadata.kernelName)
         {
             // fallback if not in order
             try
             { isaMetadata = &binary.getISAMetadataEntry(
-                            kernelInfo.kernelName.c_str()); }
+                            metadata.kernelName.c_str()); }
             catch(const Exception& ex) // failed
             { isaMetadata = nullptr; }
         }
@@ -248,113 +363,11 @@ static AmdCL2DisasmInput* getAmdCL2DisasmInputFromBinary(
         kinput.setupSize = 0;
         kinput.stub = nullptr;
         kinput.stubSize = 0;
-        if (!binary.hasInnerBinary())
-            continue; // nothing else to set
-        
-        // get kernel code, setup and stub content
-        const AmdCL2InnerGPUBinaryBase& innerBin = binary.getInnerBinaryBase();
-        const AmdCL2GPUKernel* kernelData = nullptr;
-        if (i < innerBin.getKernelsNum())
-            kernelData = &innerBin.getKernelData(i);
-        if (kernelData==nullptr || kernelData->kernelName != kernelInfo.kernelName)
-            kernelData = &innerBin.getKernelData(kernelInfo.kernelName.c_str());
-        
-        if (kernelData!=nullptr)
-        {
-            // if set kernel code and kernel setup (AMD HSA config)
-            kinput.code = kernelData->code;
-            kinput.codeSize = kernelData->codeSize;
-            kinput.setup = kernelData->setup;
-            kinput.setupSize = kernelData->setupSize;
-        }
-        if (!isInnerNewBinary)
-        {
-            // old drivers
-            const AmdCL2OldInnerGPUBinary& oldInnerBin = binary.getOldInnerBinary();
-            const AmdCL2GPUKernelStub* kstub = nullptr;
-            if (i < innerBin.getKernelsNum())
-                kstub = &oldInnerBin.getKernelStub(i);
-            if (kstub==nullptr || kernelData->kernelName != kernelInfo.kernelName)
-                kstub = &oldInnerBin.getKernelStub(kernelInfo.kernelName.c_str());
-            if (kstub!=nullptr)
-            {
-                kinput.stubSize = kstub->size;
-                kinput.stub = kstub->data;
-            }
-        }
-    }
-    
-    if (isInnerNewBinary && !hsaLayout)
-    {
-        // sort kernels by order before putting text relocations
-        Array<size_t> sortedKIndices(kernelInfosNum);
-        for (size_t i = 0; i < sortedKIndices.size(); i++)
-            sortedKIndices[i] = i;
-        
-        // sort by offset (sortedRegions is indices of sorted regions)
-        if (!sortedRelocs.empty() && !hsaLayout)
-            std::sort(sortedKIndices.begin(), sortedKIndices.end(), [&input]
-                    (size_t a, size_t b)
-                    { return input->kernels[a].setup < input->kernels[b].setup; });
-        
-        // put text relocations to kernels in offset order
-        for (cxuint i = 0; i < kernelInfosNum; i++)
-        {
-            AmdCL2DisasmKernelInput& kinput = input->kernels[sortedKIndices[i]];
-            
-            // relocations
-            const AmdCL2InnerGPUBinary& innerBin = binary.getInnerBinary();
-            
-            // skip relocation between kernels
-            for (; sortedRelocIter != sortedRelocs.end(); ++sortedRelocIter)
-                if (sortedRelocIter->first >= size_t(kinput.code-textPtr))
-                    break;
-            
-            if (sortedRelocIter != sortedRelocs.end() &&
-                    sortedRelocIter->first < size_t(kinput.code-textPtr))
-                throw DisasmException("Code relocation offset outside kernel code");
-            
-            if (sortedRelocIter != sortedRelocs.end())
-            {
-                size_t end = kinput.code+kinput.codeSize-textPtr;
-                for (; sortedRelocIter != sortedRelocs.end() &&
-                    sortedRelocIter->first<=end; ++sortedRelocIter)
-                {
-                    // add relocations
-                    const Elf64_Rela& rela = innerBin.getTextRelaEntry(
-                                sortedRelocIter->second);
-                    uint32_t symIndex = ELF64_R_SYM(ULEV(rela.r_info));
-                    int64_t addend = ULEV(rela.r_addend);
-                    cxuint rsym = 0;
-                    // check this symbol
-                    const Elf64_Sym& sym = innerBin.getSymbol(symIndex);
-                    uint16_t symShndx = ULEV(sym.st_shndx);
-                    if (symShndx!=gDataSectionIdx && symShndx!=rwDataSectionIdx &&
-                        symShndx!=bssDataSectionIdx)
-                        throw DisasmException("Symbol is not placed in global or "
-                                "rwdata data or bss is illegal");
-                    addend += ULEV(sym.st_value);
-                    rsym = (symShndx==rwDataSectionIdx) ? 1 : 
-                        ((symShndx==bssDataSectionIdx) ? 2 : 0);
-                    // determine relocation type
-                    RelocType relocType;
-                    uint32_t rtype = ELF64_R_TYPE(ULEV(rela.r_info));
-                    if (rtype==1)
-                        relocType = RELTYPE_LOW_32BIT;
-                    else if (rtype==2)
-                        relocType = RELTYPE_HIGH_32BIT;
-                    else
-                        throw DisasmException("Unknown relocation type");
-                    // put text relocs. compute offset by subtracting current code offset
-                    kinput.textRelocs.push_back(AmdCL2RelaEntry{sortedRelocIter->first-
-                        (kinput.code-textPtr), relocType, rsym, addend });
-                }
-            }
-        }
     }
     
-    if (sortedRelocIter != sortedRelocs.end())
-        throw DisasmException("Code relocation offset outside kernel code");
+    input->kernelLoader.reset(new AmdCL2BinaryKernelLoader<AmdCL2Types>(binary,
+                input.get(), isInnerNewBinary, isInnerNewBinary && !hsaLayout,
+                std::move(sortedRelocs), textPtr, dataIndices));
     return input.release();
 }
 
@@ -897,6 +910,22 @@ static void dumpAmdCL2ArgsAndSamplers(std::ostream& output,
     }
 }
 
+void CLRX::getAmdCL2HSARegions(const AmdCL2DisasmInput* amdCL2Input,
+            std::vector<ROCmDisasmRegionInput>& regions)
+{
+    regions.resize(amdCL2Input->kernels.size());
+    // preparing ROCMDIsasm region inputs for dissasemblying in AMDHSA form
+    for (size_t i = 0; i < amdCL2Input->kernels.size(); i++)
+    {
+        const AmdCL2DisasmKernelInput& kernel = amdCL2Input->getKernel(i);
+        ROCmDisasmRegionInput& region = regions[i];
+        region.regionName = kernel.kernelName;
+        region.offset = kernel.setup - amdCL2Input->code;
+        region.type = ROCmRegionType::KERNEL;
+        region.size = kernel.codeSize + kernel.setupSize;
+    }
+}
+
 void CLRX::disassembleAmdCL2(std::ostream& output, const AmdCL2DisasmInput* amdCL2Input,
        ISADisassembler* isaDisassembler, size_t& sectionCount, Flags flags)
 {
@@ -1023,8 +1052,10 @@ void CLRX::disassembleAmdCL2(std::ostream& output, const AmdCL2DisasmInput* amdC
     const GPUArchitecture arch = getGPUArchitectureFromDeviceType(amdCL2Input->deviceType);
     const cxuint maxSgprsNum = getGPUMaxRegistersNum(arch, REGTYPE_SGPR, 0);
     
-    for (const AmdCL2DisasmKernelInput& kinput: amdCL2Input->kernels)
+    for (size_t i = 0; i < amdCL2Input->kernels.size(); i++)
     {
+        // kernel datas are loaded while emitting this kernel
+        const AmdCL2DisasmKernelInput& kinput = amdCL2Input->getKernel(i);
         output.write(".kernel ", 8);
         output.write(kinput.kernelName.c_str(), kinput.kernelName.size());
         output.put('\n');
@@ -1113,18 +1144,8 @@ void CLRX::disassembleAmdCL2(std::ostream& output, const AmdCL2DisasmInput* amdC
         amdCL2Input->code != nullptr && amdCL2Input->codeSize != 0)
     {
         // print like Gallium or ROCm
-        std::vector<ROCmDisasmRegionInput> regions(amdCL2Input->kernels.size());
-        
-        // preparing ROCMDIsasm region inputs for dissasemblying in AMDHSA form
-        for (size_t i = 0; i < amdCL2Input->kernels.size(); i++)
-        {
-            const AmdCL2DisasmKernelInput& kernel = amdCL2Input->kernels[i];
-            ROCmDisasmRegionInput& region = regions[i];
-            region.regionName = kernel.kernelName;
-            region.offset = kernel.setup - amdCL2Input->code;
-            region.type = ROCmRegionType::KERNEL;
-            region.size = kernel.codeSize + kernel.setupSize;
-        }
+        std::vector<ROCmDisasmRegionInput> regions;
+        getAmdCL2HSARegions(amdCL2Input, regions);
         
         isaDisassembler->clearRelocations();
         isaDisassembler->addRelSymbol(".gdata");
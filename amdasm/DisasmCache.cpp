@@ -0,0 +1,81 @@
+/*
+ *  CLRadeonExtender - Unofficial OpenCL Radeon Extensions Library
+ *  Copyright (C) 2014-2018 Mateusz Szpakowski
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <CLRX/Config.h>
+#include <string>
+#include <mutex>
+#include <unordered_map>
+#include <CLRX/amdasm/Disassembler.h>
+
+using namespace CLRX;
+
+DisasmCodeCache::DisasmCodeCache(size_t _maxSize)
+        : maxSize(_maxSize), size(0), hitsNum(0), missesNum(0)
+{ }
+
+bool DisasmCodeCache::find(const std::string& key, DisasmCachedText& text)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(key);
+    if (it == entries.end())
+    {
+        missesNum++;
+        return false;
+    }
+    hitsNum++;
+    text = it->second;
+    return true;
+}
+
+void DisasmCodeCache::insert(std::string&& key, DisasmCachedText&& text)
+{
+    const size_t entrySize = key.size() + text.text.size() +
+            text.sectionFixups.size()*sizeof(std::pair<size_t, size_t>);
+    std::lock_guard<std::mutex> lock(mutex);
+    if (size + entrySize > maxSize)
+        return; // cache is full
+    // other thread can insert same code before us
+    if (entries.emplace(std::move(key), std::move(text)).second)
+        size += entrySize;
+}
+
+void DisasmCodeCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    size = 0;
+}
+
+size_t DisasmCodeCache::getSize() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return size;
+}
+
+size_t DisasmCodeCache::getHitsNum() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return hitsNum;
+}
+
+size_t DisasmCodeCache::getMissesNum() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return missesNum;
+}
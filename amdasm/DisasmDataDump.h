@@ -0,0 +1,295 @@
+/*
+ *  CLRadeonExtender - Unofficial OpenCL Radeon Extensions Library
+ *  Copyright (C) 2014-2018 Mateusz Szpakowski
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef __CLRX_DISASMDATADUMP_H__
+#define __CLRX_DISASMDATADUMP_H__
+
+#include <CLRX/Config.h>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <CLRX/utils/Utilities.h>
+#include <CLRX/utils/MemAccess.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define CLRX_DISASM_SSE2 1
+#endif
+
+/* data dumping routines are templates (Vectorized - use SSE2 if available),
+ * hence scalar and vectorized code can be compared in tests */
+
+namespace CLRX
+{
+
+#ifdef CLRX_DISASM_SSE2
+static const bool disasmDumpVectorized = true;
+#else
+static const bool disasmDumpVectorized = false;
+#endif
+
+// size of buffer for dumped data
+static const size_t dumpBufSize = 16384;
+// max size of single line of dumped data
+static const size_t dumpMaxLineSize = 96;
+
+static const char dumpHexDigits[16] =
+{ '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f' };
+
+// find end of repetition of byte data[p]
+template<bool Vectorized>
+static size_t findByteRunEnd(const cxbyte* data, size_t p, size_t size)
+{
+    const cxbyte value = data[p];
+    size_t i = p+1;
+#ifdef CLRX_DISASM_SSE2
+    if (Vectorized)
+    {
+        const __m128i vvec = _mm_set1_epi8(char(value));
+        for (; i+16 <= size; i += 16)
+        {
+            const cxuint mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(
+                        reinterpret_cast<const __m128i*>(data+i)), vvec));
+            if (mask != 0xffffU)
+                return i + CTZ32(~mask);
+        }
+    }
+    else
+#endif
+    {
+        const uint64_t vword = uint64_t(value) * UINT64_C(0x0101010101010101);
+        for (; i+8 <= size; i += 8)
+        {
+            uint64_t word;
+            ::memcpy(&word, data+i, 8);
+            if (word != vword)
+                break;
+        }
+    }
+    for (; i < size && data[i]==value; i++);
+    return i;
+}
+
+// find end of repetition of dword data[p]
+template<bool Vectorized>
+static size_t findDWordRunEnd(const uint32_t* data, size_t p, size_t size)
+{
+    const uint32_t value = data[p];
+    size_t i = p+1;
+#ifdef CLRX_DISASM_SSE2
+    if (Vectorized)
+    {
+        const __m128i vvec = _mm_set1_epi32(int(value));
+        for (; i+4 <= size; i += 4)
+        {
+            const cxuint mask = _mm_movemask_epi8(_mm_cmpeq_epi32(_mm_loadu_si128(
+                        reinterpret_cast<const __m128i*>(data+i)), vvec));
+            if (mask != 0xffffU)
+                return i + (CTZ32(~mask)>>2);
+        }
+    }
+#endif
+    for (; i < size && data[i]==value; i++);
+    return i;
+}
+
+// put hexadecimal digits of 8 bytes (16 characters)
+template<bool Vectorized>
+static inline void putHexBytes8(const cxbyte* data, char* out)
+{
+#ifdef CLRX_DISASM_SSE2
+    if (Vectorized)
+    {
+        const __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(data));
+        const __m128i nibbleMask = _mm_set1_epi8(0xf);
+        const __m128i lo = _mm_and_si128(v, nibbleMask);
+        const __m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), nibbleMask);
+        // interleave: high nibble first
+        __m128i digits = _mm_unpacklo_epi8(hi, lo);
+        // to ASCII: add '0' and ('a'-'0'-10) for digits greater than 9
+        const __m128i gt9 = _mm_cmpgt_epi8(digits, _mm_set1_epi8(9));
+        digits = _mm_add_epi8(_mm_add_epi8(digits, _mm_set1_epi8('0')),
+                    _mm_and_si128(gt9, _mm_set1_epi8('a'-'0'-10)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), digits);
+        return;
+    }
+#endif
+    for (cxuint i = 0; i < 8; i++)
+    {
+        out[i<<1] = dumpHexDigits[data[i]>>4];
+        out[(i<<1)+1] = dumpHexDigits[data[i]&15];
+    }
+}
+
+// print data in bytes in assembler format
+template<bool Vectorized>
+void printDisasmDataT(size_t size, const cxbyte* data, std::ostream& output,
+                bool secondAlign)
+{
+    std::unique_ptr<char[]> outBuf(new char[dumpBufSize]);
+    size_t outPos = 0;
+    /// const strings for .byte and fill pseudo-ops
+    const char* linePrefix = "    .byte ";
+    const char* fillPrefix = "    .fill ";
+    size_t prefixSize = 10;
+    if (secondAlign)
+    {
+        // const string for double alignment
+        linePrefix = "        .byte ";
+        fillPrefix = "        .fill ";
+        prefixSize += 4;
+    }
+    for (size_t p = 0; p < size;)
+    {
+        if (outPos + dumpMaxLineSize > dumpBufSize)
+        {
+            output.write(outBuf.get(), outPos);
+            outPos = 0;
+        }
+        char* buf = outBuf.get() + outPos;
+        // find max repetition of this element
+        const size_t fillEnd = (p+1 < size && data[p+1] != data[p]) ? p+1 :
+                findByteRunEnd<Vectorized>(data, p, size);
+        if (fillEnd >= p+8)
+        {
+            // if element repeated for least 1 line
+            // print .fill pseudo-op: .fill SIZE, 1, VALUE
+            ::memcpy(buf, fillPrefix, prefixSize);
+            const size_t oldP = p;
+            p = (fillEnd != size) ? fillEnd&~size_t(7) : fillEnd;
+            size_t bufPos = prefixSize;
+            bufPos += itocstrCStyle(p-oldP, buf+bufPos, 22, 10);
+            memcpy(buf+bufPos, ", 1, ", 5);
+            bufPos += 5;
+            // value to fill
+            bufPos += itocstrCStyle(data[oldP], buf+bufPos, 6, 16, 2);
+            buf[bufPos++] = '\n';
+            outPos += bufPos;
+            continue;
+        }
+
+        // print 8 or less (if end of data) bytes
+        const size_t lineSize = std::min(size-p, size_t(8));
+        char hexChars[16];
+        if (lineSize == 8)
+            putHexBytes8<Vectorized>(data+p, hexChars);
+        else
+            for (size_t i = 0; i < lineSize; i++)
+            {
+                hexChars[i<<1] = dumpHexDigits[data[p+i]>>4];
+                hexChars[(i<<1)+1] = dumpHexDigits[data[p+i]&15];
+            }
+        ::memcpy(buf, linePrefix, prefixSize);
+        char* bufPtr = buf + prefixSize;
+        for (size_t i = 0; i < lineSize; i++, bufPtr += 6)
+        {
+            // write '0xXX, ' as 8 bytes (last 2 bytes will be overwritten)
+            char elem[8] = { '0', 'x', hexChars[i<<1], hexChars[(i<<1)+1], ',', ' ', 0, 0 };
+            ::memcpy(bufPtr, elem, 8);
+        }
+        bufPtr[-2] = '\n';
+        outPos += bufPtr - buf - 1;
+        p += lineSize;
+    }
+    output.write(outBuf.get(), outPos);
+}
+
+// put hexadecimal value of dword in C-style (0x and 8 digits)
+static inline void putHexDWord(uint32_t value, char* out)
+{
+    out[0] = '0';
+    out[1] = 'x';
+    for (cxuint i = 0; i < 8; i++)
+        out[2+i] = dumpHexDigits[(value >> (28-(i<<2))) & 15];
+}
+
+// print data in 32-bit words in assembler format
+template<bool Vectorized>
+void printDisasmDataU32T(size_t size, const uint32_t* data, std::ostream& output,
+                bool secondAlign)
+{
+    std::unique_ptr<char[]> outBuf(new char[dumpBufSize]);
+    size_t outPos = 0;
+    /// const strings for .byte and fill pseudo-ops
+    const char* linePrefix = "    .int ";
+    const char* fillPrefix = "    .fill ";
+    size_t fillPrefixSize = 10;
+    if (secondAlign)
+    {
+        // const string for double alignment
+        linePrefix = "        .int ";
+        fillPrefix = "        .fill ";
+        fillPrefixSize += 4;
+    }
+    const size_t intPrefixSize = fillPrefixSize-1;
+    for (size_t p = 0; p < size;)
+    {
+        if (outPos + dumpMaxLineSize > dumpBufSize)
+        {
+            output.write(outBuf.get(), outPos);
+            outPos = 0;
+        }
+        char* buf = outBuf.get() + outPos;
+        // find max repetition of this dword
+        const size_t fillEnd = (p+1 < size && data[p+1] != data[p]) ? p+1 :
+                findDWordRunEnd<Vectorized>(data, p, size);
+        if (fillEnd >= p+4)
+        {
+            // if element repeated for least 1 line
+            // print .fill pseudo-op
+            ::memcpy(buf, fillPrefix, fillPrefixSize);
+            const size_t oldP = p;
+            p = (fillEnd != size) ? fillEnd&~size_t(3) : fillEnd;
+            size_t bufPos = fillPrefixSize;
+            bufPos += itocstrCStyle(p-oldP, buf+bufPos, 22, 10);
+            memcpy(buf+bufPos, ", 4, ", 5);
+            bufPos += 5;
+            // print fill value
+            putHexDWord(ULEV(data[oldP]), buf+bufPos);
+            bufPos += 10;
+            buf[bufPos++] = '\n';
+            outPos += bufPos;
+            continue;
+        }
+        
+        const size_t lineEnd = std::min(p+4, size);
+        ::memcpy(buf, linePrefix, intPrefixSize);
+        size_t bufPos = intPrefixSize;
+        // print four or less (if end of data) dwords
+        for (; p < lineEnd; p++)
+        {
+            putHexDWord(ULEV(data[p]), buf+bufPos);
+            bufPos += 10;
+            if (p+1 < lineEnd)
+            {
+                buf[bufPos++] = ',';
+                buf[bufPos++] = ' ';
+            }
+        }
+        buf[bufPos++] = '\n';
+        outPos += bufPos;
+    }
+    output.write(outBuf.get(), outPos);
+}
+
+};
+
+#endif
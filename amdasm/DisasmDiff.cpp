@@ -0,0 +1,551 @@
+/*
+ *  CLRadeonExtender - Unofficial OpenCL Radeon Extensions Library
+ *  Copyright (C) 2014-2018 Mateusz Szpakowski
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <CLRX/Config.h>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <ostream>
+#include <sstream>
+#include <memory>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <unordered_map>
+#include <CLRX/utils/Utilities.h>
+#include <CLRX/utils/MemAccess.h>
+#include <CLRX/utils/GPUId.h>
+#include <CLRX/amdasm/Disassembler.h>
+#include "GCNInternals.h"
+
+using namespace CLRX;
+
+/*
+ * differential disassembly
+ */
+
+// changed span: elements [aStart,aEnd) of first sequence replaced by [bStart,bEnd)
+struct CLRX_INTERNAL DiffHunk
+{
+    size_t aStart, aEnd;
+    size_t bStart, bEnd;
+};
+
+// max edit distance searched by Myers algorithm. if sequences differ more,
+// then whole middle part (between common prefix and suffix) is treated as changed
+static const size_t diffMaxEdits = 1024;
+
+/* find changed spans between two sequences (Myers O(ND) algorithm).
+ * common prefix and suffix are skipped before search */
+template<typename T>
+static void diffSequences(const std::vector<T>& a, const std::vector<T>& b,
+            std::vector<DiffHunk>& hunks)
+{
+    size_t prefix = 0;
+    while (prefix < a.size() && prefix < b.size() && a[prefix] == b[prefix])
+        prefix++;
+    size_t suffix = 0;
+    while (suffix < a.size()-prefix && suffix < b.size()-prefix &&
+            a[a.size()-1-suffix] == b[b.size()-1-suffix])
+        suffix++;
+    const ssize_t n = a.size()-prefix-suffix;
+    const ssize_t m = b.size()-prefix-suffix;
+    if (n == 0 && m == 0)
+        return;
+    if (n == 0 || m == 0)
+    {
+        hunks.push_back({ prefix, prefix+n, prefix, prefix+m });
+        return;
+    }
+
+    const T* aseq = a.data()+prefix;
+    const T* bseq = b.data()+prefix;
+    const ssize_t maxD = std::min(size_t(n+m), diffMaxEdits);
+    // furthest x for diagonal k, indexed by k+maxD+1
+    std::vector<ssize_t> v(2*maxD+3, 0);
+    // v values for every d (only diagonals -d..d) for backtracking
+    std::vector<std::vector<ssize_t> > trace;
+    ssize_t foundD = -1;
+    for (ssize_t d = 0; d <= maxD && foundD < 0; d++)
+    {
+        for (ssize_t k = -d; k <= d; k += 2)
+        {
+            ssize_t* vk = v.data() + k + maxD+1;
+            ssize_t x = (k == -d || (k != d && vk[-1] < vk[1])) ? vk[1] : vk[-1]+1;
+            ssize_t y = x-k;
+            while (x < n && y < m && aseq[x] == bseq[y])
+                x++, y++;
+            *vk = x;
+            if (x >= n && y >= m)
+            {
+                foundD = d;
+                break;
+            }
+        }
+        trace.push_back(std::vector<ssize_t>(v.begin()+maxD+1-d, v.begin()+maxD+2+d));
+    }
+    if (foundD < 0)
+    {
+        // too many differences
+        hunks.push_back({ prefix, prefix+n, prefix, prefix+m });
+        return;
+    }
+
+    // backtrack: mark changed elements
+    std::vector<bool> aChanged(n, false);
+    std::vector<bool> bChanged(m, false);
+    ssize_t x = n, y = m;
+    for (ssize_t d = foundD; d > 0; d--)
+    {
+        const std::vector<ssize_t>& vprev = trace[d-1];
+        // vprev holds diagonals -(d-1)..(d-1)
+        const ssize_t k = x-y;
+        const ssize_t* vp = vprev.data() + d-1;
+        const bool down = (k == -d || (k != d && vp[k-1] < vp[k+1]));
+        const ssize_t prevK = down ? k+1 : k-1;
+        const ssize_t prevX = vp[prevK];
+        const ssize_t prevY = prevX-prevK;
+        if (down)
+            bChanged[prevY] = true;  // inserted element
+        else
+            aChanged[prevX] = true;  // deleted element
+        x = prevX;
+        y = prevY;
+    }
+
+    // join changed elements into spans
+    ssize_t i = 0, j = 0;
+    while (i < n || j < m)
+    {
+        if ((i < n && aChanged[i]) || (j < m && bChanged[j]))
+        {
+            DiffHunk hunk{ prefix+i, 0, prefix+j, 0 };
+            while ((i < n && aChanged[i]) || (j < m && bChanged[j]))
+            {
+                while (i < n && aChanged[i]) i++;
+                while (j < m && bChanged[j]) j++;
+            }
+            hunk.aEnd = prefix+i;
+            hunk.bEnd = prefix+j;
+            hunks.push_back(hunk);
+        }
+        else
+            i++, j++;
+    }
+}
+
+// decoded instruction record compared while aligning code
+struct CLRX_INTERNAL DiffInstr
+{
+    uint32_t firstWord; // first dword (without jump offset if jump)
+    bool jump;          // if jump with resolved target
+    size_t target;      // index of jump target instruction
+    size_t wordsNum;    // number of dwords
+    const uint32_t* words;  // dwords of instruction
+
+    bool operator==(const DiffInstr& b) const
+    {
+        // jump targets are checked after alignment
+        return firstWord == b.firstWord && jump == b.jump &&
+            wordsNum == b.wordsNum && (wordsNum <= 1 ||
+            ::memcmp(words+1, b.words+1, (wordsNum-1)<<2) == 0);
+    }
+};
+
+// instruction offsets and records of region
+struct CLRX_INTERNAL DiffRegionCode
+{
+    std::vector<size_t> offsets;    // instruction offsets (with region end)
+    std::vector<DiffInstr> instrs;
+};
+
+static void getDiffRegionCode(const Disassembler& disasm, const DisasmIndex& index,
+            size_t regionIndex, DiffRegionCode& rcode)
+{
+    const DisasmIndexRegion& region = index.getRegion(regionIndex);
+    const uint32_t* codeWords = reinterpret_cast<const uint32_t*>(
+            disasm.getIndexSectionCode(index, region.section) + region.offset);
+    for (size_t offset = 0; offset < region.size; offset += 4)
+        if (index.isInstrStart(regionIndex, offset))
+            rcode.offsets.push_back(offset);
+    rcode.offsets.push_back(region.size);
+
+    const GPUArchitecture arch = getGPUArchitectureFromDeviceType(
+                disasm.getDeviceType());
+    const GCNEncodingClassTable& encTable = getGCNEncodingClassTable(arch);
+    const size_t instrsNum = rcode.offsets.size()-1;
+    rcode.instrs.resize(instrsNum);
+    for (size_t i = 0; i < instrsNum; i++)
+    {
+        DiffInstr& instr = rcode.instrs[i];
+        const size_t pos = rcode.offsets[i]>>2;
+        instr.words = codeWords + pos;
+        instr.wordsNum = (rcode.offsets[i+1]>>2) - pos;
+        instr.firstWord = 0;
+        instr.jump = false;
+        instr.target = 0;
+        if (instr.wordsNum == 0)
+            continue; // incomplete dword at end of region
+        instr.firstWord = ULEV(codeWords[pos]);
+
+        const GCNEncodingClass& encClass = encTable.classes[instr.firstWord>>23];
+        bool isJump = false;
+        if (encClass.encoding == GCNENC_SOPP)
+        {
+            const cxuint opcode = (instr.firstWord>>16)&0x7f;
+            isJump = (opcode == 2 || (opcode >= 4 && opcode <= 9) ||
+                // GCN1.1 and GCN1.2 opcodes
+                (arch != GPUArchitecture::GCN1_0 && opcode >= 23 && opcode <= 26));
+        }
+        else if ((encClass.flags & GCNLEN_SOPK_JUMP) != 0)
+            isJump = true;
+        if (!isJump)
+            continue;
+        // replace jump offset by index of target instruction
+        const ssize_t targetPos = ssize_t(pos) + int16_t(instr.firstWord&0xffff) + 1;
+        if (targetPos < 0 || size_t(targetPos)<<2 > region.size)
+            continue; // target outside region
+        const size_t targetOffset = size_t(targetPos)<<2;
+        auto it = std::lower_bound(rcode.offsets.begin(), rcode.offsets.end(),
+                    targetOffset);
+        if (*it != targetOffset)
+            continue; // target in middle of instruction
+        instr.firstWord &= 0xffff0000U;
+        instr.jump = true;
+        instr.target = it - rcode.offsets.begin();
+    }
+}
+
+/* add to changed spans aligned jumps whose targets are not aligned
+ * (jump targets are ignored while aligning instructions) */
+static void checkDiffJumps(const DiffRegionCode& codeA, const DiffRegionCode& codeB,
+            std::vector<DiffHunk>& hunks)
+{
+    const size_t instrsNumA = codeA.instrs.size();
+    // map instruction of first code to aligned instruction of second code
+    std::vector<size_t> instrMap(instrsNumA+1, SIZE_MAX);
+    size_t i = 0, j = 0;
+    for (const DiffHunk& hunk: hunks)
+    {
+        for (; i < hunk.aStart; i++, j++)
+            instrMap[i] = j;
+        i = hunk.aEnd;
+        j = hunk.bEnd;
+    }
+    for (; i < instrsNumA; i++, j++)
+        instrMap[i] = j;
+    instrMap[instrsNumA] = codeB.instrs.size();
+
+    std::vector<DiffHunk> jumpHunks;
+    for (i = 0; i < instrsNumA; i++)
+    {
+        const DiffInstr& instrA = codeA.instrs[i];
+        if (instrMap[i] == SIZE_MAX || !instrA.jump)
+            continue;
+        j = instrMap[i];
+        if (instrMap[instrA.target] != codeB.instrs[j].target)
+            jumpHunks.push_back({ i, i+1, j, j+1 });
+    }
+    if (jumpHunks.empty())
+        return;
+    // merge with changed spans
+    std::vector<DiffHunk> allHunks(hunks.size() + jumpHunks.size());
+    std::merge(hunks.begin(), hunks.end(), jumpHunks.begin(), jumpHunks.end(),
+            allHunks.begin(), [](const DiffHunk& h1, const DiffHunk& h2)
+            { return h1.aStart < h2.aStart ||
+                (h1.aStart == h2.aStart && h1.bStart < h2.bStart); });
+    hunks.clear();
+    for (const DiffHunk& hunk: allHunks)
+        if (!hunks.empty() && hunks.back().aEnd == hunk.aStart &&
+            hunks.back().bEnd == hunk.bStart)
+        {
+            // join adjacent spans
+            hunks.back().aEnd = hunk.aEnd;
+            hunks.back().bEnd = hunk.bEnd;
+        }
+        else
+            hunks.push_back(hunk);
+}
+
+// create disassembler for same input as given disassembler
+static Disassembler* createDiffDisassembler(const Disassembler& disasm,
+            std::ostream& output, Flags flags)
+{
+    switch(disasm.getBinaryFormat())
+    {
+        case BinaryFormat::AMD:
+            return new Disassembler(disasm.getAmdInput(), output, flags);
+        case BinaryFormat::AMDCL2:
+            return new Disassembler(disasm.getAmdCL2Input(), output, flags);
+        case BinaryFormat::GALLIUM:
+            return new Disassembler(disasm.getGalliumInput(), output, flags);
+        case BinaryFormat::ROCM:
+            return new Disassembler(disasm.getROCmInput(), output, flags);
+        default:
+        {
+            const RawCodeInput* rawInput = disasm.getRawInput();
+            return new Disassembler(rawInput->deviceType, rawInput->codeSize,
+                        rawInput->code, output, flags);
+        }
+    }
+}
+
+// lines of kernel configurations (".kernel" blocks) and of binary header
+struct CLRX_INTERNAL DiffConfig
+{
+    std::vector<CString> names; // kernel names (first is empty - binary header)
+    std::vector<std::vector<std::string> > blocks;
+};
+
+static void getDiffConfig(const Disassembler& disasm, DiffConfig& config)
+{
+    config.names.push_back(CString());
+    config.blocks.push_back({});
+    if (disasm.getBinaryFormat() == BinaryFormat::RAWCODE)
+        return;
+    std::ostringstream oss;
+    {
+        // print only configuration
+        std::unique_ptr<Disassembler> cdisasm(createDiffDisassembler(disasm, oss,
+                DISASM_CONFIG | (disasm.getFlags() & (DISASM_HSACONFIG|
+                DISASM_HSALAYOUT|DISASM_BUGGYFPLIT|DISASM_WAVE32))));
+        cdisasm->disassemble();
+    }
+    const std::string text = oss.str();
+    bool inKernel = false;
+    for (size_t pos = 0; pos < text.size();)
+    {
+        size_t lineEnd = text.find('\n', pos);
+        if (lineEnd == std::string::npos)
+            lineEnd = text.size();
+        const std::string line = text.substr(pos, lineEnd-pos);
+        pos = lineEnd+1;
+        if (line.compare(0, 8, ".kernel ") == 0)
+        {
+            config.names.push_back(CString(line.c_str()+8));
+            config.blocks.push_back({});
+            inKernel = true;
+        }
+        else if (!line.empty() && (line[0] == ' ' || line[0] == '\t'))
+        {
+            if (inKernel)
+                config.blocks.back().push_back(line);
+        }
+        else if (!line.empty() && line.back() != ':')
+        {
+            // global directive (labels are skipped)
+            inKernel = false;
+            config.blocks[0].push_back(line);
+        }
+        else
+            inKernel = false;
+    }
+}
+
+// print lines with prefix (without labels after last instruction)
+static void printDiffLines(std::ostream& output, const std::string& text, char prefix)
+{
+    size_t textEnd = text.size();
+    while (textEnd >= 2)
+    {
+        const size_t lineStart = text.rfind('\n', textEnd-2);
+        const size_t pos = (lineStart != std::string::npos) ? lineStart+1 : 0;
+        if (text[pos] == ' ' || text[pos] == '/' || text[textEnd-2] != ':')
+            break;
+        textEnd = pos;
+    }
+    for (size_t pos = 0; pos < textEnd;)
+    {
+        size_t lineEnd = text.find('\n', pos);
+        if (lineEnd == std::string::npos)
+            lineEnd = textEnd;
+        output.put(prefix);
+        output.write(text.data()+pos, lineEnd-pos);
+        output.put('\n');
+        pos = lineEnd+1;
+    }
+}
+
+static void printDiffKernelHeader(std::ostream& output, const CString& name,
+            bool& printed)
+{
+    if (printed)
+        return;
+    if (name.empty())
+        output << "/* code */\n";
+    else
+        output << "/* kernel: " << name << " */\n";
+    printed = true;
+}
+
+size_t CLRX::diffDisassemblers(const Disassembler& disasmA,
+            const Disassembler& disasmB, std::ostream& output)
+{
+    std::ostringstream ossA, ossB;
+    std::unique_ptr<Disassembler> dA(createDiffDisassembler(disasmA, ossA,
+                disasmA.getFlags()));
+    std::unique_ptr<Disassembler> dB(createDiffDisassembler(disasmB, ossB,
+                disasmB.getFlags()));
+    DisasmIndex indexA, indexB;
+    dA->buildIndex(indexA);
+    dB->buildIndex(indexB);
+    DiffConfig configA, configB;
+    getDiffConfig(disasmA, configA);
+    getDiffConfig(disasmB, configB);
+
+    size_t diffsNum = 0;
+    // header of binaries
+    {
+        std::vector<DiffHunk> hunks;
+        diffSequences(configA.blocks[0], configB.blocks[0], hunks);
+        if (!hunks.empty())
+            output << "/* header */\n";
+        for (const DiffHunk& hunk: hunks)
+        {
+            output << "@@ header @@\n";
+            for (size_t i = hunk.aStart; i < hunk.aEnd; i++)
+                output << '-' << configA.blocks[0][i] << '\n';
+            for (size_t i = hunk.bStart; i < hunk.bEnd; i++)
+                output << '+' << configB.blocks[0][i] << '\n';
+        }
+        diffsNum += hunks.size();
+    }
+
+    /* kernel order: kernels of first binary, next kernels only in second binary.
+     * unnamed code regions are aligned by order */
+    std::vector<CString> kernelNames;
+    std::unordered_map<CString, size_t> kernelMap;
+    auto addKernel = [&kernelNames, &kernelMap](const CString& name)
+    {
+        if (kernelMap.insert(std::make_pair(name, kernelNames.size())).second)
+            kernelNames.push_back(name);
+    };
+    for (size_t i = 0; i < indexA.getRegionsNum(); i++)
+        if (!indexA.getRegion(i).name.empty())
+            addKernel(indexA.getRegion(i).name);
+    for (size_t i = 1; i < configA.names.size(); i++)
+        addKernel(configA.names[i]);
+    for (size_t i = 0; i < indexB.getRegionsNum(); i++)
+        if (!indexB.getRegion(i).name.empty())
+            addKernel(indexB.getRegion(i).name);
+    for (size_t i = 1; i < configB.names.size(); i++)
+        addKernel(configB.names[i]);
+
+    const size_t kernelsNum = kernelNames.size();
+    std::vector<size_t> regionsA(kernelsNum, SIZE_MAX), regionsB(kernelsNum, SIZE_MAX);
+    std::vector<size_t> unnamedA, unnamedB;
+    for (size_t i = 0; i < indexA.getRegionsNum(); i++)
+        if (!indexA.getRegion(i).name.empty())
+            regionsA[kernelMap[indexA.getRegion(i).name]] = i;
+        else
+            unnamedA.push_back(i);
+    for (size_t i = 0; i < indexB.getRegionsNum(); i++)
+        if (!indexB.getRegion(i).name.empty())
+            regionsB[kernelMap[indexB.getRegion(i).name]] = i;
+        else
+            unnamedB.push_back(i);
+    std::vector<size_t> configsA(kernelsNum, SIZE_MAX), configsB(kernelsNum, SIZE_MAX);
+    for (size_t i = 1; i < configA.names.size(); i++)
+        configsA[kernelMap[configA.names[i]]] = i;
+    for (size_t i = 1; i < configB.names.size(); i++)
+        configsB[kernelMap[configB.names[i]]] = i;
+    // unnamed regions are placed after kernels
+    for (size_t i = 0; i < std::max(unnamedA.size(), unnamedB.size()); i++)
+    {
+        kernelNames.push_back(CString());
+        regionsA.push_back(i < unnamedA.size() ? unnamedA[i] : SIZE_MAX);
+        regionsB.push_back(i < unnamedB.size() ? unnamedB[i] : SIZE_MAX);
+        configsA.push_back(SIZE_MAX);
+        configsB.push_back(SIZE_MAX);
+    }
+
+    for (size_t k = 0; k < kernelNames.size(); k++)
+    {
+        const CString& name = kernelNames[k];
+        bool headerPrinted = false;
+        const bool inA = regionsA[k] != SIZE_MAX || configsA[k] != SIZE_MAX;
+        const bool inB = regionsB[k] != SIZE_MAX || configsB[k] != SIZE_MAX;
+        if (!inA || !inB)
+        {
+            printDiffKernelHeader(output, name, headerPrinted);
+            output << (inA ? "/* only in first binary */\n" :
+                    "/* only in second binary */\n");
+            diffsNum++;
+            continue;
+        }
+
+        // kernel configuration (register usage and other setup)
+        {
+            static const std::vector<std::string> emptyConfig;
+            std::vector<DiffHunk> hunks;
+            const std::vector<std::string>& cA = (configsA[k] != SIZE_MAX) ?
+                    configA.blocks[configsA[k]] : emptyConfig;
+            const std::vector<std::string>& cB = (configsB[k] != SIZE_MAX) ?
+                    configB.blocks[configsB[k]] : emptyConfig;
+            diffSequences(cA, cB, hunks);
+            for (const DiffHunk& hunk: hunks)
+            {
+                printDiffKernelHeader(output, name, headerPrinted);
+                output << "@@ config @@\n";
+                for (size_t i = hunk.aStart; i < hunk.aEnd; i++)
+                    output << '-' << cA[i] << '\n';
+                for (size_t i = hunk.bStart; i < hunk.bEnd; i++)
+                    output << '+' << cB[i] << '\n';
+            }
+            diffsNum += hunks.size();
+        }
+
+        // code
+        DiffRegionCode codeA, codeB;
+        if (regionsA[k] != SIZE_MAX)
+            getDiffRegionCode(*dA, indexA, regionsA[k], codeA);
+        if (regionsB[k] != SIZE_MAX)
+            getDiffRegionCode(*dB, indexB, regionsB[k], codeB);
+        std::vector<DiffHunk> hunks;
+        diffSequences(codeA.instrs, codeB.instrs, hunks);
+        checkDiffJumps(codeA, codeB, hunks);
+        for (const DiffHunk& hunk: hunks)
+        {
+            printDiffKernelHeader(output, name, headerPrinted);
+            const size_t startA = hunk.aStart < codeA.offsets.size() ?
+                    codeA.offsets[hunk.aStart] : 0;
+            const size_t startB = hunk.bStart < codeB.offsets.size() ?
+                    codeB.offsets[hunk.bStart] : 0;
+            output << "@@ -0x" << std::hex << startA << std::dec << "," <<
+                    (hunk.aEnd-hunk.aStart) << " +0x" << std::hex << startB <<
+                    std::dec << "," << (hunk.bEnd-hunk.bStart) << " @@\n";
+            if (hunk.aStart != hunk.aEnd)
+            {
+                ossA.str("");
+                dA->disassembleRange(indexA, regionsA[k], startA,
+                            codeA.offsets[hunk.aEnd]);
+                printDiffLines(output, ossA.str(), '-');
+            }
+            if (hunk.bStart != hunk.bEnd)
+            {
+                ossB.str("");
+                dB->disassembleRange(indexB, regionsB[k], startB,
+                            codeB.offsets[hunk.bEnd]);
+                printDiffLines(output, ossB.str(), '+');
+            }
+        }
+        diffsNum += hunks.size();
+    }
+    return diffsNum;
+}
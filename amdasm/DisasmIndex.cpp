@@ -0,0 +1,740 @@
+/*
+ *  CLRadeonExtender - Unofficial OpenCL Radeon Extensions Library
+ *  Copyright (C) 2014-2018 Mateusz Szpakowski
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <CLRX/Config.h>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <memory>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <CLRX/utils/Utilities.h>
+#include <CLRX/utils/MemAccess.h>
+#include <CLRX/utils/GPUId.h>
+#include <CLRX/amdasm/Disassembler.h>
+#include "DisasmInternals.h"
+
+using namespace CLRX;
+
+/*
+ * disassembly index
+ */
+
+// number of bitmap words per rank entry (256 dwords)
+static const size_t instrRankWords = 8;
+
+// compute number of instructions before every block of bitmap words
+static void computeInstrRanks(DisasmIndexRegion& region)
+{
+    const size_t wordsNum = region.instrStarts.size();
+    region.instrRanks.resize((wordsNum + instrRankWords-1) / instrRankWords);
+    uint32_t count = 0;
+    for (size_t i = 0; i < wordsNum; i++)
+    {
+        if ((i % instrRankWords) == 0)
+            region.instrRanks[i / instrRankWords] = count;
+        count += POPCNT32(region.instrStarts[i]);
+    }
+}
+
+DisasmIndex::DisasmIndex() : deviceType(GPUDeviceType::CAPE_VERDE)
+{ }
+
+void DisasmIndex::clear()
+{
+    sections.clear();
+    regions.clear();
+}
+
+size_t DisasmIndex::findRegion(const char* name) const
+{
+    for (size_t i = 0; i < regions.size(); i++)
+        if (regions[i].name == name)
+            return i;
+    return SIZE_MAX;
+}
+
+size_t DisasmIndex::findRegion(size_t section, size_t offset) const
+{
+    for (size_t i = 0; i < regions.size(); i++)
+    {
+        const DisasmIndexRegion& region = regions[i];
+        if (region.section == section && region.offset <= offset &&
+            offset < region.offset + region.size)
+            return i;
+    }
+    return SIZE_MAX;
+}
+
+size_t DisasmIndex::getInstrsNum(size_t region) const
+{
+    return getInstrIndex(region, regions[region].size);
+}
+
+bool DisasmIndex::isInstrStart(size_t regionIndex, size_t offset) const
+{
+    const DisasmIndexRegion& region = regions[regionIndex];
+    if ((offset & 3) != 0 || (offset>>7) >= region.instrStarts.size())
+        return false;
+    return (region.instrStarts[offset>>7] & (1U<<((offset>>2)&31))) != 0;
+}
+
+size_t DisasmIndex::getInstrIndex(size_t regionIndex, size_t offset) const
+{
+    const DisasmIndexRegion& region = regions[regionIndex];
+    // dword positions before offset
+    const size_t dwords = std::min((offset+3)>>2, region.instrStarts.size()<<5);
+    const size_t wordIndex = dwords>>5;
+    if (region.instrRanks.empty())
+        return 0;
+    const size_t block = std::min(wordIndex / instrRankWords, region.instrRanks.size()-1);
+    size_t count = region.instrRanks[block];
+    for (size_t i = block*instrRankWords; i < wordIndex; i++)
+        count += POPCNT32(region.instrStarts[i]);
+    if ((dwords&31) != 0)
+        count += POPCNT32(region.instrStarts[wordIndex] & ((1U<<(dwords&31))-1U));
+    return count;
+}
+
+size_t DisasmIndex::getInstrOffset(size_t regionIndex, size_t index) const
+{
+    const DisasmIndexRegion& region = regions[regionIndex];
+    if (region.instrRanks.empty())
+        return region.size;
+    // find last block whose rank is not greater than index
+    const size_t block = std::upper_bound(region.instrRanks.begin(),
+            region.instrRanks.end(), uint32_t(index)) - region.instrRanks.begin() - 1;
+    size_t count = region.instrRanks[block];
+    for (size_t i = block*instrRankWords; i < region.instrStarts.size(); i++)
+    {
+        uint32_t word = region.instrStarts[i];
+        const cxuint wordCount = POPCNT32(word);
+        if (count + wordCount > index)
+        {
+            // instruction in this word
+            for (; count < index; count++)
+                word &= word-1; // remove lowest bit
+            return ((i<<5) + CTZ32(word))<<2;
+        }
+        count += wordCount;
+    }
+    return region.size;
+}
+
+/* binary form of index:
+ * magic "CLRXDIDX", version (32-bit), device type (32-bit),
+ * sections (with labels and relocations), regions (with instruction bitmap).
+ * All numbers are in little-endian */
+
+static const char disasmIndexMagic[8] = { 'C', 'L', 'R', 'X', 'D', 'I', 'D', 'X' };
+static const uint32_t disasmIndexVersion = 1;
+
+static void writeIndexU32(std::ostream& os, uint32_t v)
+{
+    v = LEV(v);
+    os.write(reinterpret_cast<const char*>(&v), 4);
+}
+
+static void writeIndexU64(std::ostream& os, uint64_t v)
+{
+    v = LEV(v);
+    os.write(reinterpret_cast<const char*>(&v), 8);
+}
+
+static void writeIndexString(std::ostream& os, const CString& str)
+{
+    writeIndexU64(os, str.size());
+    os.write(str.c_str(), str.size());
+}
+
+static uint32_t readIndexU32(std::istream& is)
+{
+    uint32_t v;
+    if (!is.read(reinterpret_cast<char*>(&v), 4))
+        throw DisasmException("Disassembly index is truncated");
+    return LEV(v);
+}
+
+static uint64_t readIndexU64(std::istream& is)
+{
+    uint64_t v;
+    if (!is.read(reinterpret_cast<char*>(&v), 8))
+        throw DisasmException("Disassembly index is truncated");
+    return LEV(v);
+}
+
+static CString readIndexString(std::istream& is)
+{
+    const uint64_t size = readIndexU64(is);
+    if (size > 0x10000U)
+        throw DisasmException("Disassembly index has too long name");
+    CString str(size);
+    if (size != 0 && !is.read(str.begin(), size))
+        throw DisasmException("Disassembly index is truncated");
+    return str;
+}
+
+void DisasmIndex::write(std::ostream& os) const
+{
+    os.write(disasmIndexMagic, 8);
+    writeIndexU32(os, disasmIndexVersion);
+    writeIndexU32(os, cxuint(deviceType));
+    writeIndexU64(os, sections.size());
+    for (const DisasmIndexSection& section: sections)
+    {
+        writeIndexString(os, section.name);
+        writeIndexU64(os, section.size);
+        writeIndexU64(os, section.labels.size());
+        for (size_t label: section.labels)
+            writeIndexU64(os, label);
+        writeIndexU64(os, section.namedLabels.size());
+        for (const auto& label: section.namedLabels)
+        {
+            writeIndexU64(os, label.first);
+            writeIndexString(os, label.second);
+        }
+        writeIndexU64(os, section.relSymbols.size());
+        for (const CString& symName: section.relSymbols)
+            writeIndexString(os, symName);
+        writeIndexU64(os, section.relocations.size());
+        for (const DisasmIndexReloc& reloc: section.relocations)
+        {
+            writeIndexU64(os, reloc.offset);
+            writeIndexU32(os, reloc.type);
+            writeIndexU64(os, reloc.symbol);
+            writeIndexU64(os, reloc.addend);
+        }
+    }
+    writeIndexU64(os, regions.size());
+    for (const DisasmIndexRegion& region: regions)
+    {
+        writeIndexString(os, region.name);
+        writeIndexU64(os, region.section);
+        writeIndexU64(os, region.offset);
+        writeIndexU64(os, region.size);
+        writeIndexU32(os, region.wave32);
+        // instruction ranks are not written, they will be recomputed
+        for (uint32_t word: region.instrStarts)
+            writeIndexU32(os, word);
+    }
+}
+
+void DisasmIndex::read(std::istream& is)
+{
+    clear();
+    char magic[8];
+    if (!is.read(magic, 8) || ::memcmp(magic, disasmIndexMagic, 8) != 0)
+        throw DisasmException("This is not disassembly index");
+    if (readIndexU32(is) != disasmIndexVersion)
+        throw DisasmException("Unsupported disassembly index version");
+    const uint32_t devType = readIndexU32(is);
+    if (devType > cxuint(GPUDeviceType::GPUDEVICE_MAX))
+        throw DisasmException("Wrong GPU device type in disassembly index");
+    deviceType = GPUDeviceType(devType);
+
+    const uint64_t sectionsNum = readIndexU64(is);
+    for (uint64_t i = 0; i < sectionsNum; i++)
+    {
+        DisasmIndexSection section;
+        section.name = readIndexString(is);
+        section.size = readIndexU64(is);
+        const uint64_t labelsNum = readIndexU64(is);
+        for (uint64_t j = 0; j < labelsNum; j++)
+            section.labels.push_back(readIndexU64(is));
+        const uint64_t namedLabelsNum = readIndexU64(is);
+        for (uint64_t j = 0; j < namedLabelsNum; j++)
+        {
+            const size_t pos = readIndexU64(is);
+            section.namedLabels.push_back(std::make_pair(pos, readIndexString(is)));
+        }
+        const uint64_t relSymbolsNum = readIndexU64(is);
+        for (uint64_t j = 0; j < relSymbolsNum; j++)
+            section.relSymbols.push_back(readIndexString(is));
+        const uint64_t relocsNum = readIndexU64(is);
+        for (uint64_t j = 0; j < relocsNum; j++)
+        {
+            DisasmIndexReloc reloc;
+            reloc.offset = readIndexU64(is);
+            reloc.type = readIndexU32(is);
+            reloc.symbol = readIndexU64(is);
+            reloc.addend = readIndexU64(is);
+            if (reloc.symbol >= section.relSymbols.size())
+                throw DisasmException("Wrong relocation symbol in disassembly index");
+            section.relocations.push_back(reloc);
+        }
+        sections.push_back(std::move(section));
+    }
+
+    const uint64_t regionsNum = readIndexU64(is);
+    for (uint64_t i = 0; i < regionsNum; i++)
+    {
+        DisasmIndexRegion region;
+        region.name = readIndexString(is);
+        region.section = readIndexU64(is);
+        region.offset = readIndexU64(is);
+        region.size = readIndexU64(is);
+        region.wave32 = readIndexU32(is) != 0;
+        if (region.section >= sections.size() ||
+            region.offset > sections[region.section].size ||
+            region.size > sections[region.section].size - region.offset)
+            throw DisasmException("Wrong region in disassembly index");
+        const size_t wordsNum = ((region.size>>2) + 31)>>5;
+        region.instrStarts.resize(wordsNum);
+        for (size_t j = 0; j < wordsNum; j++)
+            region.instrStarts[j] = readIndexU32(is);
+        computeInstrRanks(region);
+        regions.push_back(std::move(region));
+    }
+}
+
+/*
+ * building index and disassemblying window
+ */
+
+namespace
+{
+
+// range of code disassembled in single pass
+struct IndexCodeRange
+{
+    CString name;
+    size_t offset;
+    size_t size;
+    bool wave32;
+    // kernel offsets inside range where region can be split
+    std::vector<std::pair<size_t, CString> > splits;
+};
+
+struct IndexCodeSection
+{
+    CString name;
+    size_t size;
+    const cxbyte* code;
+    // code ranges to analyze (to collect labels)
+    std::vector<std::pair<size_t, size_t> > analyzeRanges;
+    std::vector<IndexCodeRange> ranges;
+    std::vector<std::pair<size_t, CString> > namedLabels;
+    std::vector<CString> relSymbols;
+    std::vector<DisasmIndexReloc> relocations;
+};
+
+};
+
+static void addCL2TextRelocs(IndexCodeSection& section,
+            const std::vector<AmdCL2RelaEntry>& textRelocs)
+{
+    section.relSymbols.push_back(".gdata");
+    section.relSymbols.push_back(".ddata"); // rw data
+    section.relSymbols.push_back(".bdata"); // .bss data
+    for (const AmdCL2RelaEntry& entry: textRelocs)
+        section.relocations.push_back({ entry.offset, entry.type,
+                    entry.symbol, entry.addend });
+}
+
+// prepare code section by AMDHSA code layout (like in disassembleAMDHSACode)
+static void prepareAMDHSACodeSection(IndexCodeSection& section,
+            const std::vector<ROCmDisasmRegionInput>& regions, bool wave32,
+            bool llvm10BinFormat = false,
+            const std::vector<ROCmDisasmKernelDescInfo>& kernelDescs =
+                std::vector<ROCmDisasmKernelDescInfo>())
+{
+    AMDHSACodeLayout layout;
+    prepareAMDHSACodeLayout(regions, section.size, true, wave32, llvm10BinFormat,
+                kernelDescs, layout);
+    section.analyzeRanges = std::move(layout.analyzeRanges);
+    for (const auto& entry: layout.sorted)
+        section.namedLabels.push_back(std::make_pair(entry.first,
+                    regions[entry.second].regionName));
+    for (const AMDHSACodeRange& range: layout.codeRanges)
+        section.ranges.push_back({ range.sortedIndex != SIZE_MAX ?
+                regions[layout.sorted[range.sortedIndex].second].regionName : CString(),
+                range.offset, range.size, range.wave32 });
+}
+
+static void collectAmdCodeSections(const AmdDisasmInput* amdInput, bool wave32,
+            std::vector<IndexCodeSection>& sections)
+{
+    for (const AmdDisasmKernelInput& kinput: amdInput->kernels)
+        if (kinput.code != nullptr && kinput.codeSize != 0)
+        {
+            IndexCodeSection section{ kinput.kernelName, kinput.codeSize, kinput.code };
+            section.analyzeRanges.push_back(std::make_pair(0, kinput.codeSize));
+            section.ranges.push_back({ kinput.kernelName, 0, kinput.codeSize, wave32 });
+            sections.push_back(std::move(section));
+        }
+}
+
+static void collectAmdCL2CodeSections(const AmdCL2DisasmInput* amdCL2Input,
+            Flags flags, std::vector<IndexCodeSection>& sections)
+{
+    const bool wave32 = (flags & DISASM_WAVE32) != 0;
+    const bool doHSALayout = ((flags & DISASM_HSALAYOUT) != 0) &&
+                (amdCL2Input->driverVersion >= 191205);
+    if (!doHSALayout)
+    {
+        for (size_t i = 0; i < amdCL2Input->kernels.size(); i++)
+        {
+            const AmdCL2DisasmKernelInput& kinput = amdCL2Input->getKernel(i);
+            if (kinput.code != nullptr && kinput.codeSize != 0)
+            {
+                IndexCodeSection section{ kinput.kernelName, kinput.codeSize,
+                            kinput.code };
+                section.analyzeRanges.push_back(std::make_pair(0, kinput.codeSize));
+                section.ranges.push_back({ kinput.kernelName, 0, kinput.codeSize,
+                            wave32 });
+                addCL2TextRelocs(section, kinput.textRelocs);
+                sections.push_back(std::move(section));
+            }
+        }
+        return;
+    }
+    if (amdCL2Input->code == nullptr || amdCL2Input->codeSize == 0)
+        return;
+
+    std::vector<ROCmDisasmRegionInput> regions;
+    getAmdCL2HSARegions(amdCL2Input, regions);
+    IndexCodeSection section{ CString(), amdCL2Input->codeSize, amdCL2Input->code };
+    prepareAMDHSACodeSection(section, regions, wave32);
+    addCL2TextRelocs(section, amdCL2Input->textRelocs);
+    sections.push_back(std::move(section));
+}
+
+static void collectGalliumCodeSections(const GalliumDisasmInput* galliumInput,
+            bool wave32, std::vector<IndexCodeSection>& sections)
+{
+    if (galliumInput->code == nullptr || galliumInput->codeSize == 0)
+        return;
+    const size_t codeSize = galliumInput->codeSize;
+    IndexCodeSection section{ CString(), codeSize, galliumInput->code };
+    if (!galliumInput->scratchRelocs.empty())
+    {
+        section.relSymbols.push_back(".scratchaddr");
+        for (const GalliumScratchReloc& entry: galliumInput->scratchRelocs)
+            section.relocations.push_back({ entry.offset, entry.type, 0, 0 });
+    }
+
+    if (!galliumInput->isAMDHSA)
+    {
+        std::vector<std::pair<size_t, CString> > kernels;
+        for (const GalliumDisasmKernelInput& kinput: galliumInput->kernels)
+            kernels.push_back(std::make_pair(size_t(kinput.offset), kinput.kernelName));
+        mapSort(kernels.begin(), kernels.end());
+        // whole code disassembled in single pass, kernels are named labels
+        section.namedLabels = kernels;
+        section.analyzeRanges.push_back(std::make_pair(0, codeSize));
+        IndexCodeRange range{ CString(), 0, codeSize, wave32 };
+        range.splits = kernels;
+        section.ranges.push_back(range);
+    }
+    else
+    {
+        std::vector<ROCmDisasmRegionInput> regions;
+        getGalliumHSARegions(galliumInput, regions);
+        prepareAMDHSACodeSection(section, regions, wave32);
+    }
+    sections.push_back(std::move(section));
+}
+
+// mark instruction starts in code
+static void markInstrStarts(const ISADisassembler* isaDisassembler, size_t codeSize,
+            const cxbyte* code, std::vector<uint32_t>& instrStarts)
+{
+    instrStarts.assign(((codeSize>>2) + 31)>>5, 0U);
+    size_t pos = 0;
+    while (pos+4 <= codeSize)
+    {
+        instrStarts[pos>>7] |= 1U<<((pos>>2)&31);
+        pos += isaDisassembler->getInstructionSize(codeSize-pos, code+pos);
+    }
+}
+
+void Disassembler::buildIndex(DisasmIndex& index)
+{
+    index.clear();
+    index.deviceType = getDeviceType();
+    const bool wave32 = (flags & DISASM_WAVE32) != 0;
+
+    std::vector<IndexCodeSection> codeSections;
+    switch(binaryFormat)
+    {
+        case BinaryFormat::AMD:
+            collectAmdCodeSections(amdInput, wave32, codeSections);
+            break;
+        case BinaryFormat::AMDCL2:
+            collectAmdCL2CodeSections(amdCL2Input, flags, codeSections);
+            break;
+        case BinaryFormat::ROCM:
+            if (rocmInput->code != nullptr && rocmInput->codeSize != 0)
+            {
+                IndexCodeSection section{ CString(), rocmInput->codeSize,
+                            rocmInput->code };
+                prepareAMDHSACodeSection(section, rocmInput->regions, wave32,
+                            rocmInput->llvm10BinFormat, rocmInput->kernelDescs);
+                codeSections.push_back(std::move(section));
+            }
+            break;
+        case BinaryFormat::GALLIUM:
+            collectGalliumCodeSections(galliumInput, wave32, codeSections);
+            break;
+        default:
+            if (rawInput->code != nullptr && rawInput->codeSize != 0)
+            {
+                IndexCodeSection section{ CString(), rawInput->codeSize,
+                            rawInput->code };
+                section.analyzeRanges.push_back(std::make_pair(0, rawInput->codeSize));
+                section.ranges.push_back({ CString(), 0, rawInput->codeSize, wave32 });
+                codeSections.push_back(std::move(section));
+            }
+            break;
+    }
+
+    // separate ISA disassembler used only to collect labels and instruction sizes
+    std::unique_ptr<ISADisassembler> indexer(new GCNDisassembler(*this));
+    for (IndexCodeSection& codeSection: codeSections)
+    {
+        const size_t sectionIndex = index.sections.size();
+        index.sections.push_back(DisasmIndexSection());
+        DisasmIndexSection& section = index.sections.back();
+        section.name = codeSection.name;
+        section.size = codeSection.size;
+
+        indexer->clearNumberedLabels();
+        for (const auto& range: codeSection.analyzeRanges)
+        {
+            indexer->setInput(range.second, codeSection.code + range.first, range.first);
+            indexer->analyzeBeforeDisassemble();
+        }
+        indexer->prepareLabelsAndRelocations();
+        const DisasmLabelSet& labels = indexer->getLabels();
+        section.labels.assign(labels.begin(), labels.end());
+
+        section.namedLabels = std::move(codeSection.namedLabels);
+        mapSort(section.namedLabels.begin(), section.namedLabels.end());
+        section.relSymbols = std::move(codeSection.relSymbols);
+        section.relocations = std::move(codeSection.relocations);
+        std::stable_sort(section.relocations.begin(), section.relocations.end(),
+            [](const DisasmIndexReloc& a, const DisasmIndexReloc& b)
+            { return a.offset < b.offset; });
+
+        for (const IndexCodeRange& range: codeSection.ranges)
+        {
+            std::vector<uint32_t> instrStarts;
+            markInstrStarts(indexer.get(), range.size, codeSection.code + range.offset,
+                        instrStarts);
+            // split range at kernel offsets that are instruction starts
+            std::vector<std::pair<size_t, CString> > splits;
+            splits.push_back(std::make_pair(0, range.name));
+            for (const auto& split: range.splits)
+            {
+                const size_t splitPos = split.first - range.offset;
+                if (split.first < range.offset || splitPos >= range.size ||
+                    (splitPos&3) != 0 ||
+                    (instrStarts[splitPos>>7] & (1U<<((splitPos>>2)&31))) == 0)
+                    continue;
+                if (splitPos == splits.back().first)
+                    splits.back().second = split.second;
+                else
+                    splits.push_back(std::make_pair(splitPos, split.second));
+            }
+
+            for (size_t i = 0; i < splits.size(); i++)
+            {
+                const size_t start = splits[i].first;
+                const size_t end = (i+1 < splits.size()) ? splits[i+1].first : range.size;
+                DisasmIndexRegion region{ splits[i].second, sectionIndex,
+                        range.offset + start, end-start, range.wave32 };
+                if (splits.size() == 1)
+                    region.instrStarts = std::move(instrStarts);
+                else
+                {
+                    // copy part of bitmap (start is aligned to dword)
+                    const size_t startDword = start>>2;
+                    const size_t dwordsNum = (end-start)>>2;
+                    region.instrStarts.assign((dwordsNum+31)>>5, 0U);
+                    for (size_t k = 0; k < dwordsNum; k++)
+                    {
+                        const size_t d = startDword + k;
+                        if ((instrStarts[d>>5] & (1U<<(d&31))) != 0)
+                            region.instrStarts[k>>5] |= 1U<<(k&31);
+                    }
+                }
+                computeInstrRanks(region);
+                index.regions.push_back(std::move(region));
+            }
+        }
+    }
+}
+
+const cxbyte* Disassembler::getIndexSectionCode(const DisasmIndex& index,
+            size_t sectionIndex) const
+{
+    if (index.deviceType != getDeviceType() || sectionIndex >= index.sections.size())
+        throw DisasmException("Disassembly index doesn't match to input");
+    // find code of code section
+    const cxbyte* code = nullptr;
+    size_t codeSize = 0;
+    const AmdCL2DisasmInput* cl2Input = amdCL2Input;
+    switch(binaryFormat)
+    {
+        case BinaryFormat::AMD:
+        case BinaryFormat::AMDCL2:
+            if (binaryFormat == BinaryFormat::AMDCL2 &&
+                (flags & DISASM_HSALAYOUT) != 0 && cl2Input->driverVersion >= 191205)
+            {
+                code = cl2Input->code;
+                codeSize = cl2Input->codeSize;
+                break;
+            }
+            else
+            {
+                // per kernel code sections
+                size_t curSection = 0;
+                const size_t kernelsNum = (binaryFormat == BinaryFormat::AMD) ?
+                        amdInput->kernels.size() : cl2Input->kernels.size();
+                for (size_t i = 0; i < kernelsNum; i++)
+                {
+                    const cxbyte* kcode = (binaryFormat == BinaryFormat::AMD) ?
+                            amdInput->kernels[i].code : cl2Input->getKernel(i).code;
+                    const size_t kcodeSize = (binaryFormat == BinaryFormat::AMD) ?
+                            amdInput->kernels[i].codeSize : cl2Input->getKernel(i).codeSize;
+                    if (kcode == nullptr || kcodeSize == 0)
+                        continue;
+                    if (curSection++ == sectionIndex)
+                    {
+                        code = kcode;
+                        codeSize = kcodeSize;
+                        break;
+                    }
+                }
+            }
+            break;
+        case BinaryFormat::ROCM:
+            code = rocmInput->code;
+            codeSize = rocmInput->codeSize;
+            break;
+        case BinaryFormat::GALLIUM:
+            code = galliumInput->code;
+            codeSize = galliumInput->codeSize;
+            break;
+        default:
+            code = rawInput->code;
+            codeSize = rawInput->codeSize;
+            break;
+    }
+    if (code == nullptr || codeSize != index.sections[sectionIndex].size)
+        throw DisasmException("Disassembly index doesn't match to input");
+    return code;
+}
+
+void Disassembler::disassembleWindow(const DisasmIndex& index, size_t regionIndex,
+            size_t offset, size_t instrsBefore, size_t instrsAfter)
+{
+    if (regionIndex >= index.regions.size())
+        throw DisasmException("Region index out of range");
+    const DisasmIndexRegion& region = index.regions[regionIndex];
+    const size_t instrsNum = index.getInstrsNum(regionIndex);
+    if (instrsNum == 0)
+        return;
+    // instruction that contains offset
+    const size_t instrIndex = (offset < region.size) ?
+            index.getInstrIndex(regionIndex, offset+1)-1 : instrsNum-1;
+    const size_t first = (instrIndex >= instrsBefore) ? instrIndex-instrsBefore : 0;
+    const size_t last = std::min(instrIndex + 1 + std::min(instrsAfter, instrsNum),
+                instrsNum);
+    disassembleRange(index, regionIndex, index.getInstrOffset(regionIndex, first),
+            (last < instrsNum) ? index.getInstrOffset(regionIndex, last) : region.size);
+}
+
+void Disassembler::disassembleRange(const DisasmIndex& index, size_t regionIndex,
+            size_t startOffset, size_t endOffset)
+{
+    if (regionIndex >= index.regions.size())
+        throw DisasmException("Region index out of range");
+    const DisasmIndexRegion& region = index.regions[regionIndex];
+    const DisasmIndexSection& section = index.sections[region.section];
+    const cxbyte* code = getIndexSectionCode(index, region.section);
+    if (startOffset >= endOffset || endOffset > region.size)
+        return;
+    
+    const size_t start = region.offset + startOffset;
+    const size_t end = region.offset + endOffset;
+    const size_t first = index.getInstrIndex(regionIndex, startOffset);
+    // labels after previous instruction are printed before first instruction
+    const size_t labelStart = (first != 0) ? region.offset +
+                index.getInstrOffset(regionIndex, first-1) + 1 : start;
+
+    GCNDisassembler isaDisasm(*this);
+    isaDisasm.setInput(end-start, code + start, start, labelStart);
+    for (auto it = std::lower_bound(section.labels.begin(), section.labels.end(),
+                labelStart); it != section.labels.end() && *it <= end; ++it)
+        isaDisasm.addLabel(*it);
+    // named labels in window and named labels used by jumps in window
+    auto namedLabelLess = [](const std::pair<size_t, CString>& label, size_t pos)
+            { return label.first < pos; };
+    auto namedIt = std::lower_bound(section.namedLabels.begin(),
+                section.namedLabels.end(), labelStart, namedLabelLess);
+    for (; namedIt != section.namedLabels.end() && namedIt->first <= end; ++namedIt)
+        isaDisasm.addNamedLabel(namedIt->first, namedIt->second);
+    std::vector<size_t> jumpTargets;
+    isaDisasm.getJumpTargets(jumpTargets);
+    std::sort(jumpTargets.begin(), jumpTargets.end());
+    jumpTargets.resize(std::unique(jumpTargets.begin(), jumpTargets.end()) -
+                jumpTargets.begin());
+    for (size_t target: jumpTargets)
+    {
+        if (target >= labelStart && target <= end)
+            continue; // already added
+        namedIt = std::lower_bound(section.namedLabels.begin(),
+                    section.namedLabels.end(), target, namedLabelLess);
+        // all named labels at this position
+        for (; namedIt != section.namedLabels.end() && namedIt->first == target;
+                    ++namedIt)
+            isaDisasm.addNamedLabel(namedIt->first, namedIt->second);
+    }
+    for (const CString& symName: section.relSymbols)
+        isaDisasm.addRelSymbol(symName);
+    for (auto it = std::lower_bound(section.relocations.begin(),
+            section.relocations.end(), start,
+            [](const DisasmIndexReloc& reloc, size_t pos)
+            { return reloc.offset < pos; });
+            it != section.relocations.end() && it->offset < end; ++it)
+        isaDisasm.addRelocation(it->offset, it->type, it->symbol, it->addend);
+    isaDisasm.prepareLabelsAndRelocations();
+
+    const Flags oldFlags = flags;
+    const size_t oldSectionCount = sectionCount;
+    flags = (flags & ~(DISASM_ESTIMATE|DISASM_WAVE32)) |
+            (region.wave32 ? DISASM_WAVE32 : 0);
+    sectionCount = region.section;
+    try
+    {
+        isaDisasm.setDontPrintLabels(true);
+        isaDisasm.disassemble();
+    }
+    catch(...)
+    {
+        flags = oldFlags;
+        sectionCount = oldSectionCount;
+        throw;
+    }
+    flags = oldFlags;
+    sectionCount = oldSectionCount;
+}
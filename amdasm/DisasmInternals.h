@@ -35,6 +35,11 @@
 namespace CLRX
 {
 
+// append value to key of code cache
+template<typename T>
+static inline void putCodeCacheKeyValue(std::string& key, T value)
+{ key.append(reinterpret_cast<const char*>(&value), sizeof(T)); }
+
 // print data in bytes in assembler format (secondAlign add extra align)
 extern CLRX_INTERNAL void printDisasmData(size_t size, const cxbyte* data,
               std::ostream& output, bool secondAlign = false);
@@ -52,6 +57,10 @@ extern CLRX_INTERNAL void disassembleAmd(std::ostream& output,
        const AmdDisasmInput* amdInput, ISADisassembler* isaDisassembler,
        size_t& sectionCount, Flags flags);
 
+// prepare regions of kernels from AmdCL2 binary input (for AMDHSA layout)
+extern CLRX_INTERNAL void getAmdCL2HSARegions(const AmdCL2DisasmInput* amdCL2Input,
+            std::vector<ROCmDisasmRegionInput>& regions);
+
 // disassemble Amd OpenCL 2.0 binary input
 extern CLRX_INTERNAL void disassembleAmdCL2(std::ostream& output,
         const AmdCL2DisasmInput* amdCL2Input, ISADisassembler* isaDisassembler,
@@ -67,6 +76,30 @@ extern CLRX_INTERNAL void disassembleROCm(std::ostream& output,
 extern CLRX_INTERNAL void dumpAMDHSAConfig(std::ostream& output, cxuint maxSgprsNum,
              GPUArchitecture arch, const ROCmKernelConfig& config,
              bool amdhsaPrefix = false);
+// code range in AMDHSA layout (code before first region or code of region)
+struct CLRX_INTERNAL AMDHSACodeRange
+{
+    size_t sortedIndex; // index in sorted regions (SIZE_MAX - code before first region)
+    size_t offset;  // offset of code
+    size_t size;    // size of code (to next region)
+    bool wave32;    // wave32 mode (can be changed by kernel descriptor)
+};
+
+// layout of code in AMDHSA form
+struct CLRX_INTERNAL AMDHSACodeLayout
+{
+    std::vector<std::pair<size_t, size_t> > sorted; // regions sorted by (offset, index)
+    std::vector<std::pair<size_t, size_t> > analyzeRanges; // (offset, size) to analyze
+    std::vector<AMDHSACodeRange> codeRanges;  // code ranges to disassemble
+};
+
+// prepare layout of code in AMDHSA form (if withCode is false, only sorts regions)
+extern CLRX_INTERNAL void prepareAMDHSACodeLayout(
+            const std::vector<ROCmDisasmRegionInput>& regions, size_t codeSize,
+            bool withCode, bool wave32, bool llvm10BinFormat,
+            const std::vector<ROCmDisasmKernelDescInfo>& kernelDescs,
+            AMDHSACodeLayout& layout);
+
 // disassemble code in AMDHSA layout (kernel config and kernel codes)
 extern CLRX_INTERNAL void disassembleAMDHSACode(std::ostream& output,
             const std::vector<ROCmDisasmRegionInput>& regions,
@@ -75,6 +108,10 @@ extern CLRX_INTERNAL void disassembleAMDHSACode(std::ostream& output,
             const std::vector<ROCmDisasmKernelDescInfo>& kdescs =
                 std::vector<ROCmDisasmKernelDescInfo>());
 
+// prepare regions of kernels from Gallium binary input (for AMDHSA layout)
+extern CLRX_INTERNAL void getGalliumHSARegions(const GalliumDisasmInput* galliumInput,
+            std::vector<ROCmDisasmRegionInput>& regions);
+
 // disassemble Gallium binary input
 extern CLRX_INTERNAL void disassembleGallium(std::ostream& output,
        const GalliumDisasmInput* galliumInput, ISADisassembler* isaDisassembler,
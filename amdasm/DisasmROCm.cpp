@@ -30,12 +30,44 @@
 #include <CLRX/utils/Utilities.h>
 #include <CLRX/utils/MemAccess.h>
 #include <CLRX/amdbin/ROCmBinaries.h>
+#include <CLRX/amdbin/Amd3Binaries.h>
 #include <CLRX/amdasm/Disassembler.h>
 #include <CLRX/utils/GPUId.h>
 #include "DisasmInternals.h"
 
 using namespace CLRX;
 
+// setup GOT symbols of disassembler input (for ROCm and AMD3 binaries)
+template<typename Binary>
+static void setDisasmGotSymbols(const Binary& binary, ROCmDisasmInput& input)
+{
+    const size_t gotSymbolsNum = binary.getGotSymbolsNum();
+    input.gotSymbols.resize(gotSymbolsNum);
+    
+    // get rodata index and offset
+    cxuint rodataIndex = SHN_UNDEF;
+    size_t rodataOffset = 0;
+    try
+    {
+        rodataIndex = binary.getSectionIndex(".rodata");
+        rodataOffset = ULEV(binary.getSectionHeader(rodataIndex).sh_offset);
+    }
+    catch(Exception& ex)
+    { }
+    
+    // setup got symbols
+    for (size_t i = 0; i < gotSymbolsNum; i++)
+    {
+        const size_t gotSymIndex = binary.getGotSymbol(i);
+        const Elf64_Sym& sym = binary.getDynSymbol(gotSymIndex);
+        size_t offset = SIZE_MAX;
+        // set offset if symbol refer to some place in globaldata (rodata)
+        if (rodataIndex != SHN_UNDEF && ULEV(sym.st_shndx) == rodataIndex)
+            offset = ULEV(sym.st_value) - rodataOffset;
+        input.gotSymbols[i] = { binary.getDynSymbolName(gotSymIndex), offset };
+    }
+}
+
 ROCmDisasmInput* CLRX::getROCmDisasmInputFromBinary(const ROCmBinary& binary)
 {
     std::unique_ptr<ROCmDisasmInput> input(new ROCmDisasmInput);
@@ -45,7 +77,7 @@ ROCmDisasmInput* CLRX::getROCmDisasmInputFromBinary(const ROCmBinary& binary)
     const size_t regionsNum = binary.getRegionsNum();
     input->regions.resize(regionsNum);
     size_t codeOffset = binary.getCode()-binary.getBinaryCode();
-    // ger regions of code
+    // get regions of code
     for (size_t i = 0; i < regionsNum; i++)
     {
         const ROCmRegion& region = binary.getRegion(i);
@@ -63,32 +95,52 @@ ROCmDisasmInput* CLRX::getROCmDisasmInputFromBinary(const ROCmBinary& binary)
         }
     }
     
-    const size_t gotSymbolsNum = binary.getGotSymbolsNum();
-    input->gotSymbols.resize(gotSymbolsNum);
+    setDisasmGotSymbols(binary, *input);
     
-    // get rodata index and offset
-    cxuint rodataIndex = SHN_UNDEF;
-    size_t rodataOffset = 0;
-    try
-    {
-        rodataIndex = binary.getSectionIndex(".rodata");
-        rodataOffset = ULEV(binary.getSectionHeader(rodataIndex).sh_offset);
-    }
-    catch(Exception& ex)
-    { }
+    // setup code
+    input->eflags = ULEV(binary.getHeader().e_flags);
+    input->code = binary.getCode();
+    input->codeSize = binary.getCodeSize();
+    input->metadata = binary.getMetadata();
+    input->metadataSize = binary.getMetadataSize();
+    input->globalData = binary.getGlobalData();
+    input->globalDataSize = binary.getGlobalDataSize();
+    input->target = binary.getTarget();
+    input->newBinFormat = binary.isNewBinaryFormat();
+    input->llvm10BinFormat = binary.isLLVM10BinaryFormat();
+    input->metadataV3 = binary.isMetadataV3Format();
+    return input.release();
+}
+
+ROCmDisasmInput* CLRX::getAmd3DisasmInputFromBinary(const Amd3Binary& binary)
+{
+    std::unique_ptr<ROCmDisasmInput> input(new ROCmDisasmInput);
+    input->deviceType = binary.determineGPUDeviceType(input->archMinor,
+                              input->archStepping);
     
-    // setup got symbols
-    for (size_t i = 0; i < gotSymbolsNum; i++)
+    const size_t regionsNum = binary.getRegionsNum();
+    input->regions.resize(regionsNum);
+    input->kernelDescs.resize(regionsNum, ROCmDisasmKernelDescInfo{});
+    size_t codeOffset = binary.getCode()-binary.getBinaryCode();
+    // get regions of code and their kernel descriptors
+    for (size_t i = 0; i < regionsNum; i++)
     {
-        const size_t gotSymIndex = binary.getGotSymbol(i);
-        const Elf64_Sym& sym = binary.getDynSymbol(gotSymIndex);
-        size_t offset = SIZE_MAX;
-        // set offset if symbol refer to some place in globaldata (rodata)
-        if (rodataIndex != SHN_UNDEF && ULEV(sym.st_shndx) == rodataIndex)
-            offset = ULEV(sym.st_value) - rodataOffset;
-        input->gotSymbols[i] = { binary.getDynSymbolName(gotSymIndex), offset };
+        const Amd3Region& region = binary.getRegion(i);
+        input->regions[i] = { region.regionName, size_t(region.size),
+            size_t(region.offset - codeOffset),
+            region.type == Amd3RegionType::KERNEL ?
+                    ROCmRegionType::KERNEL : ROCmRegionType::DATA };
+        if (region.kernelDesc == SIZE_MAX)
+            continue;
+        // kernel descriptor is read directly from binary (same layout as in ROCm)
+        input->kernelDescs[i].sectionOffset = binary.getKernelDescOffset(
+                region.kernelDesc) - (binary.getGlobalData()-binary.getBinaryCode());
+        input->kernelDescs[i].desc = reinterpret_cast<const ROCmKernelDescriptor*>(
+                &binary.getKernelDesc(region.kernelDesc));
     }
     
+    setDisasmGotSymbols(binary, *input);
+    
     // setup code
     input->eflags = ULEV(binary.getHeader().e_flags);
     input->code = binary.getCode();
@@ -98,9 +150,9 @@ ROCmDisasmInput* CLRX::getROCmDisasmInputFromBinary(const ROCmBinary& binary)
     input->globalData = binary.getGlobalData();
     input->globalDataSize = binary.getGlobalDataSize();
     input->target = binary.getTarget();
-    input->newBinFormat = binary.isNewBinaryFormat();
-    input->llvm10BinFormat = binary.isLLVM10BinaryFormat();
-    input->metadataV3 = binary.isMetadataV3Format();
+    input->newBinFormat = true;
+    input->llvm10BinFormat = true;
+    input->metadataV3 = (binary.getMetadata() != nullptr);
     return input.release();
 }
 
@@ -573,7 +625,61 @@ static void dumpKernelConfig(std::ostream& output, cxuint maxSgprsNum,
 }
 
 // routine to disassembly code in AMD HSA form (kernel with HSA config)
-void CLRX::disassembleAMDHSACode(std::ostream& output,
+void CLRX::prepareAMDHSACodeLayout(const std::vector<ROCmDisasmRegionInput>& regions,
+            size_t codeSize, bool withCode, bool wave32, bool llvm10BinFormat,
+            const std::vector<ROCmDisasmKernelDescInfo>& kernelDescs,
+            AMDHSACodeLayout& layout)
+{
+    const size_t regionsNum = regions.size();
+    std::vector<std::pair<size_t, size_t> >& sorted = layout.sorted;
+    sorted.resize(regionsNum);
+    for (size_t i = 0; i < regionsNum; i++)
+        sorted[i] = std::make_pair(regions[i].offset, i);
+    mapSort(sorted.begin(), sorted.end());
+    layout.analyzeRanges.clear();
+    layout.codeRanges.clear();
+    if (!withCode)
+        return;
+    
+    // before first kernel
+    if (regionsNum == 0 || sorted[0].first > 0)
+    {
+        const size_t regionSize = (regionsNum!=0 ? sorted[0].first : codeSize);
+        layout.analyzeRanges.push_back(std::make_pair(0, regionSize));
+        layout.codeRanges.push_back({ SIZE_MAX, 0, regionSize, wave32 });
+    }
+    
+    const size_t kconfigSize = llvm10BinFormat ? 0 : 256;
+    for (size_t i = 0; i < regionsNum; i++)
+    {
+        const ROCmDisasmRegionInput& region = regions[sorted[i].second];
+        if (region.type==ROCmRegionType::KERNEL || region.type==ROCmRegionType::FKERNEL)
+        {
+            if (region.offset+kconfigSize > codeSize)
+                throw DisasmException("Region Offset out of range");
+            // kernel code begin after HSA config
+            if (region.size >= kconfigSize)
+                layout.analyzeRanges.push_back(std::make_pair(region.offset+kconfigSize,
+                            region.size-kconfigSize));
+        }
+        if (region.type==ROCmRegionType::DATA)
+            continue;
+        const size_t dataSize = ((i+1<regionsNum) ?
+                    regions[sorted[i+1].second].offset : codeSize) - region.offset;
+        if (llvm10BinFormat)
+        {
+            // wave32 mode from kernel descriptor (kept for next regions)
+            const ROCmKernelDescriptor* kdesc = kernelDescs[sorted[i].second].desc;
+            if (kdesc!=nullptr)
+                wave32 = (ULEV(kdesc->initialKernelExecState) & ROCMFLAG_USE_WAVE32) != 0;
+        }
+        if (dataSize >= kconfigSize)
+            layout.codeRanges.push_back({ i, region.offset+kconfigSize,
+                        dataSize-kconfigSize, wave32 });
+    }
+}
+
+static void disassembleAMDHSACodeText(std::ostream& output,
             const std::vector<ROCmDisasmRegionInput>& regions,
             size_t codeSize, const cxbyte* code, ISADisassembler* isaDisassembler,
             Flags flags, bool llvm10BinFormat,
@@ -585,49 +691,57 @@ void CLRX::disassembleAMDHSACode(std::ostream& output,
     const bool doDumpConfig = ((flags & DISASM_CONFIG) != 0);
     
     const size_t regionsNum = regions.size();
-    typedef std::pair<size_t, size_t> SortEntry;
-    std::unique_ptr<SortEntry[]> sorted(new SortEntry[regionsNum]);
-    for (size_t i = 0; i < regionsNum; i++)
-        sorted[i] = std::make_pair(regions[i].offset, i);
-    mapSort(sorted.get(), sorted.get() + regionsNum);
+    AMDHSACodeLayout layout;
+    prepareAMDHSACodeLayout(regions, codeSize, doDumpCode,
+                (isaDisassembler->getFlags() & DISASM_WAVE32) != 0, llvm10BinFormat,
+                kernelDescs, layout);
+    const std::vector<std::pair<size_t, size_t> >& sorted = layout.sorted;
+    const size_t kconfigSize = llvm10BinFormat ? 0 : 256;
     
     output.write(".text\n", 6);
     // clear labels
     isaDisassembler->clearNumberedLabels();
     
     /// analyze code with collecting labels
-    // before first kernel
-    if (doDumpCode && (regionsNum == 0 || sorted[0].first > 0))
+    for (const auto& range: layout.analyzeRanges)
     {
-        const size_t regionSize = (regionsNum!=0 ? sorted[0].first : codeSize);
-        isaDisassembler->setInput(regionSize, code, 0);
+        isaDisassembler->setInput(range.second, code + range.first, range.first);
         isaDisassembler->analyzeBeforeDisassemble();
     }
-    
-    const size_t kconfigSize = llvm10BinFormat ? 0 : 256;
-    
     for (size_t i = 0; i < regionsNum; i++)
+        isaDisassembler->addNamedLabel(sorted[i].first, regions[sorted[i].second].regionName);
+    isaDisassembler->prepareLabelsAndRelocations();
+    
+    /* kernels code can be disassembled by many threads before writing output.
+     * texts are written later in order of regions */
+    std::vector<DisasmCachedText> kernelTexts;
+    std::vector<size_t> kernelTextIndices; // text index for every sorted region
+    const cxuint threadsNum = isaDisassembler->getDisassembler().getThreadsNum();
+    if (doDumpCode && threadsNum != 1)
     {
-        const ROCmDisasmRegionInput& region = regions[sorted[i].second];
-        if ((region.type==ROCmRegionType::KERNEL ||
-             region.type==ROCmRegionType::FKERNEL) && doDumpCode)
+        std::vector<DisasmCodePiece> pieces;
+        kernelTextIndices.assign(regionsNum, SIZE_MAX);
+        // flags changed by kernel descriptors like in real disassemble
+        const Flags curFlags = isaDisassembler->getFlags() & ~DISASM_WAVE32;
+        for (const AMDHSACodeRange& range: layout.codeRanges)
         {
-            if (region.offset+kconfigSize > codeSize)
-                throw DisasmException("Region Offset out of range");
-            // kernel code begin after HSA config
-            isaDisassembler->setInput(region.size-kconfigSize,
-                                code + region.offset+kconfigSize,
-                                region.offset+kconfigSize);
-            isaDisassembler->analyzeBeforeDisassemble();
+            if (range.sortedIndex == SIZE_MAX)
+                continue; // code before first region
+            const size_t i = range.sortedIndex;
+            kernelTextIndices[i] = pieces.size();
+            pieces.push_back({ range.size, code + range.offset, range.offset,
+                    sorted[i].first+1, i+1<regionsNum,
+                    curFlags | (range.wave32 ? DISASM_WAVE32 : 0) });
         }
-        isaDisassembler->addNamedLabel(region.offset, region.regionName);
+        if (pieces.size() > 1)
+            isaDisassembler->disassemblePieces(pieces, threadsNum, kernelTexts);
+        else
+            // no reason to use threads
+            kernelTextIndices.clear();
     }
-    isaDisassembler->prepareLabelsAndRelocations();
     
     ISADisassembler::LabelIter curLabel;
     ISADisassembler::NamedLabelIter curNamedLabel;
-    const auto& labels = isaDisassembler->getLabels();
-    const auto& namedLabels = isaDisassembler->getNamedLabels();
     
     // real disassemble
     // before first kernel
@@ -651,12 +765,8 @@ void CLRX::disassembleAMDHSACode(std::ostream& output,
         // set labelIters to previous position
         isaDisassembler->setInput(prevRegionPos, code + region.offset,
                                 region.offset, prevRegionPos);
-        curLabel = std::lower_bound(labels.begin(), labels.end(), prevRegionPos);
-        curNamedLabel = std::lower_bound(namedLabels.begin(), namedLabels.end(),
-            std::make_pair(prevRegionPos, CString()),
-                [](const std::pair<size_t,CString>& a,
-                                const std::pair<size_t, CString>& b)
-                { return a.first < b.first; });
+        curLabel = isaDisassembler->findLabel(prevRegionPos);
+        curNamedLabel = isaDisassembler->findNamedLabel(prevRegionPos);
         // write labels to current region position
         isaDisassembler->writeLabelsToPosition(0, curLabel, curNamedLabel);
         isaDisassembler->flushOutput();
@@ -696,8 +806,14 @@ void CLRX::disassembleAMDHSACode(std::ostream& output,
                         isaDisassembler->setFlags(flags);
                     }
                 }
-                isaDisassembler->setDontPrintLabels(i+1<regionsNum);
-                isaDisassembler->disassemble();
+                if (!kernelTextIndices.empty())
+                    // already disassembled by many threads
+                    isaDisassembler->writeCachedText(kernelTexts[kernelTextIndices[i]]);
+                else
+                {
+                    isaDisassembler->setDontPrintLabels(i+1<regionsNum);
+                    isaDisassembler->disassemble();
+                }
             }
             prevRegionPos = region.offset + dataSize + 1;
         }
@@ -718,12 +834,8 @@ void CLRX::disassembleAMDHSACode(std::ostream& output,
         // set labelIters to previous position
         isaDisassembler->setInput(prevRegionPos, code + region.offset+region.size,
                                 region.offset+region.size, prevRegionPos);
-        curLabel = std::lower_bound(labels.begin(), labels.end(), prevRegionPos);
-        curNamedLabel = std::lower_bound(namedLabels.begin(), namedLabels.end(),
-            std::make_pair(prevRegionPos, CString()),
-                [](const std::pair<size_t,CString>& a,
-                                const std::pair<size_t, CString>& b)
-                { return a.first < b.first; });
+        curLabel = isaDisassembler->findLabel(prevRegionPos);
+        curNamedLabel = isaDisassembler->findNamedLabel(prevRegionPos);
         // if last region is not kernel, then print labels after last region
         isaDisassembler->writeLabelsToPosition(0, curLabel, curNamedLabel);
         isaDisassembler->flushOutput();
@@ -732,6 +844,70 @@ void CLRX::disassembleAMDHSACode(std::ostream& output,
     }
 }
 
+void CLRX::disassembleAMDHSACode(std::ostream& output,
+            const std::vector<ROCmDisasmRegionInput>& regions,
+            size_t codeSize, const cxbyte* code, ISADisassembler* isaDisassembler,
+            Flags flags, bool llvm10BinFormat,
+            const std::vector<ROCmDisasmKernelDescInfo>& kernelDescs)
+{
+    DisasmCodeCache* codeCache = isaDisassembler->getDisassembler().getCodeCache();
+    if (codeCache == nullptr || (flags & DISASM_DUMPCODE) == 0 ||
+        isaDisassembler->isTextCaptured())
+    {
+        disassembleAMDHSACodeText(output, regions, codeSize, code, isaDisassembler,
+                    flags, llvm10BinFormat, kernelDescs);
+        return;
+    }
+    
+    /* whole code section is single item in code cache.
+     * key: whole code with named labels and relocations, and regions */
+    std::string key;
+    isaDisassembler->clearNumberedLabels();
+    isaDisassembler->prepareLabelsAndRelocations();
+    isaDisassembler->setInput(codeSize, code);
+    isaDisassembler->setDontPrintLabels(false);
+    isaDisassembler->makeCodeCacheKey(key);
+    putCodeCacheKeyValue(key, flags);
+    putCodeCacheKeyValue(key, cxbyte(llvm10BinFormat));
+    putCodeCacheKeyValue(key, regions.size());
+    for (size_t i = 0; i < regions.size(); i++)
+    {
+        const ROCmDisasmRegionInput& region = regions[i];
+        putCodeCacheKeyValue(key, region.offset);
+        putCodeCacheKeyValue(key, region.size);
+        putCodeCacheKeyValue(key, cxuint(region.type));
+        key.append(region.regionName.c_str(), region.regionName.size()+1);
+        // only wave32 mode from kernel descriptor affects code
+        const ROCmKernelDescriptor* kdesc = (llvm10BinFormat) ?
+                    kernelDescs[i].desc : nullptr;
+        putCodeCacheKeyValue(key, cxbyte(kdesc==nullptr ? 2 :
+                (ULEV(kdesc->initialKernelExecState) & ROCMFLAG_USE_WAVE32) != 0));
+    }
+    
+    DisasmCachedText text;
+    if (codeCache->find(key, text))
+    {
+        isaDisassembler->writeCachedText(text);
+        return;
+    }
+    isaDisassembler->beginTextCapture();
+    try
+    {
+        disassembleAMDHSACodeText(output, regions, codeSize, code, isaDisassembler,
+                    flags, llvm10BinFormat, kernelDescs);
+    }
+    catch(...)
+    {
+        // write already disassembled text
+        isaDisassembler->endTextCapture(text);
+        isaDisassembler->writeCachedText(text);
+        throw;
+    }
+    isaDisassembler->endTextCapture(text);
+    isaDisassembler->writeCachedText(text);
+    codeCache->insert(std::move(key), std::move(text));
+}
+
 // helper for checking whether value is supplied
 static inline bool hasValue(cxuint value)
 { return value!=BINGEN_NOTSUPPLIED && value!=BINGEN_DEFAULT; }
@@ -0,0 +1,409 @@
+/*
+ *  CLRadeonExtender - Unofficial OpenCL Radeon Extensions Library
+ *  Copyright (C) 2014-2018 Mateusz Szpakowski
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <CLRX/Config.h>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <CLRX/utils/Utilities.h>
+#include <CLRX/utils/GPUId.h>
+#include <CLRX/amdasm/Disassembler.h>
+#include "GCNInternals.h"
+#include "GCNDisasmInternals.h"
+
+using namespace CLRX;
+
+/*
+ * code statistics
+ */
+
+static const char* disasmStatsEncodingNames[DISASM_STATS_ENCODINGS_NUM] =
+{
+    "illegal", "sopc", "sopp", "sop1", "sop2", "sopk", "smem", "vopc", "vop1",
+    "vop2", "vop3a", "vop3b", "vintrp", "ds", "mubuf", "mtbuf", "mimg", "exp",
+    "flat", "vop3p"
+};
+
+static const char* disasmInstrGroupNames[size_t(DisasmInstrGroup::MAX_VALUE)+1] =
+{
+    "salu", "valu", "smem", "vmem", "lds", "export", "control"
+};
+
+// instruction group for GCN encoding
+static const DisasmInstrGroup gcnEncodingGroupTable[DISASM_STATS_ENCODINGS_NUM] =
+{
+    DisasmInstrGroup::CONTROL, // illegal (not counted)
+    DisasmInstrGroup::SALU, DisasmInstrGroup::CONTROL, DisasmInstrGroup::SALU,
+    DisasmInstrGroup::SALU, DisasmInstrGroup::SALU, DisasmInstrGroup::SMEM,
+    DisasmInstrGroup::VALU, DisasmInstrGroup::VALU, DisasmInstrGroup::VALU,
+    DisasmInstrGroup::VALU, DisasmInstrGroup::VALU, DisasmInstrGroup::VALU,
+    DisasmInstrGroup::LDS, DisasmInstrGroup::VMEM, DisasmInstrGroup::VMEM,
+    DisasmInstrGroup::VMEM, DisasmInstrGroup::EXPORT, DisasmInstrGroup::VMEM,
+    DisasmInstrGroup::VALU
+};
+
+const char* CLRX::getDisasmStatsEncodingName(cxuint encoding)
+{
+    if (encoding >= DISASM_STATS_ENCODINGS_NUM)
+        throw DisasmException("Encoding out of range");
+    return disasmStatsEncodingNames[encoding];
+}
+
+const char* CLRX::getDisasmInstrGroupName(DisasmInstrGroup group)
+{
+    if (group > DisasmInstrGroup::MAX_VALUE)
+        throw DisasmException("Instruction group out of range");
+    return disasmInstrGroupNames[cxuint(group)];
+}
+
+DisasmCodeStats::DisasmCodeStats()
+{
+    clear();
+}
+
+void DisasmCodeStats::clear()
+{
+    name.clear();
+    codeSize = instrsNum = illegalsNum = literalsNum = waitcntsNum = 0;
+    std::fill(groupCounts, groupCounts + size_t(DisasmInstrGroup::MAX_VALUE)+1, 0);
+    std::fill(encodingCounts, encodingCounts + DISASM_STATS_ENCODINGS_NUM, 0);
+    maxSGPR = maxVGPR = -1;
+}
+
+// register usage of single instruction
+struct CLRX_INTERNAL GCNStatsRegUsage
+{
+    cxuint maxSGPRsNum;  // number of addressable SGPRs
+    cxint maxSGPR;
+    cxint maxVGPR;
+    bool literal;
+
+    void useSGPR(cxuint reg, cxuint regsNum)
+    {
+        if (reg < maxSGPRsNum)
+            maxSGPR = std::max(maxSGPR, cxint(reg + regsNum - 1));
+    }
+    void useVGPR(cxuint reg, cxuint regsNum)
+    { maxVGPR = std::max(maxVGPR, cxint(reg + regsNum - 1)); }
+    // use operand (SGPR, constant, literal or VGPR if op>=256)
+    void useOperand(cxuint op, cxuint regsNum)
+    {
+        if (op >= 256)
+            useVGPR(op-256, regsNum);
+        else if (op == 255)
+            literal = true;
+        else
+            useSGPR(op, regsNum);
+    }
+};
+
+/* register usage of single instruction. register fields and numbers of registers
+ * are decoded by operand decoding routines shared with GCN disassembler */
+static void getGCNInstrRegUsage(GPUArchMask arch, const GCNInstruction& insn,
+            uint32_t insnCode, uint32_t insnCode2, const uint32_t* extraCodes,
+            GCNStatsRegUsage& usage)
+{
+    typedef GCNDisasmUtils DU;
+    const GCNInsnMode mode = insn.mode;
+    const GCNInsnMode mode1 = mode & GCN_MASK1;
+    const cxuint dstRegs = (mode & GCN_REG_DST_64) ? 2 : 1;
+    const cxuint src0Regs = (mode & GCN_REG_SRC0_64) ? 2 : 1;
+    const cxuint src1Regs = (mode & GCN_REG_SRC1_64) ? 2 : 1;
+    switch(insn.encoding)
+    {
+        case GCNENC_SOP1:
+            if (mode1 != GCN_DST_NONE)
+                usage.useSGPR((insnCode>>16)&0x7f, dstRegs);
+            if (mode1 != GCN_SRC_NONE)
+                usage.useOperand(insnCode&0xff, src0Regs);
+            break;
+        case GCNENC_SOP2:
+            if (mode1 != GCN_DST_NONE)
+                usage.useSGPR((insnCode>>16)&0x7f, dstRegs);
+            usage.useOperand(insnCode&0xff, src0Regs);
+            usage.useOperand((insnCode>>8)&0xff, src1Regs);
+            break;
+        case GCNENC_SOPC:
+            usage.useOperand(insnCode&0xff, src0Regs);
+            if ((mode & GCN_SRC1_IMM) == 0)
+                usage.useOperand((insnCode>>8)&0xff, src1Regs);
+            break;
+        case GCNENC_SOPK:
+            if ((mode & GCN_IMM_DST) != 0)
+                usage.literal = true;  // 32-bit immediate
+            if ((mode & GCN_SOPK_CONST) == 0 && mode1 != GCN_DST_NONE)
+                usage.useSGPR((insnCode>>16)&0x7f, dstRegs);
+            break;
+        case GCNENC_SMRD:
+        {
+            const cxuint dataRegs = 1U<<((mode & GCN_DSIZE_MASK)>>GCN_SHIFT2);
+            const cxuint sbaseRegs = (mode & GCN_SBASE4) ? 4 : 2;
+            if ((arch & ARCH_GCN_1_2_4_5) == 0)
+            {
+                // SMRD
+                if (mode1 == GCN_SMRD_ONLYDST)
+                    usage.useSGPR((insnCode>>15)&0x7f, dstRegs);
+                else if (mode1 != GCN_ARG_NONE)
+                {
+                    usage.useSGPR((insnCode>>15)&0x7f, dataRegs);
+                    usage.useSGPR((insnCode>>8)&0x7e, sbaseRegs);
+                    if ((insnCode & 0x100) == 0)
+                        usage.useOperand(insnCode&0xff, 1);
+                }
+            }
+            else
+            {
+                // SMEM
+                if (mode1 == GCN_SMRD_ONLYDST)
+                    usage.useSGPR((insnCode>>6)&0x7f, dstRegs);
+                else if (mode1 != GCN_ARG_NONE)
+                {
+                    if ((mode1 & (GCN_SMEM_SDATA_IMM|GCN_SMEM_NOSDATA)) == 0)
+                        usage.useSGPR((insnCode>>6)&0x7f, dataRegs);
+                    usage.useSGPR((insnCode<<1)&0x7e, sbaseRegs);
+                    const cxuint soffset = DU::getSMEMSOffsetReg(arch, insnCode, insnCode2);
+                    if (soffset != DU::noReg)
+                        usage.useSGPR(soffset, 1);
+                }
+            }
+            break;
+        }
+        case GCNENC_VOPC:
+        case GCNENC_VOP1:
+        case GCNENC_VOP2:
+        {
+            const cxuint src0Field = insnCode&0x1ff;
+            const VOPExtraWordOut extraFlags = DU::decodeVOPExtraWord(arch, src0Field,
+                        insnCode2);
+            const cxuint vsrc1 = ((insnCode>>9)&0xff) + (extraFlags.scalarSrc1 ? 0 : 256);
+            if (insn.encoding == GCNENC_VOPC)
+            {
+                const cxuint sdwabSDst = DU::getVOPCSDWABSDst(arch, src0Field, insnCode2);
+                if (sdwabSDst != DU::noReg)
+                    usage.useSGPR(sdwabSDst, 2);
+                usage.useOperand(extraFlags.src0, src0Regs);
+                usage.useOperand(vsrc1, src1Regs);
+                break;
+            }
+            if (insn.encoding == GCNENC_VOP1)
+            {
+                if (mode1 == GCN_VOP_ARG_NONE)
+                    break;
+                usage.useOperand(((insnCode>>17)&0xff) + (mode1 == GCN_DST_SGPR ? 0 : 256),
+                            dstRegs);
+                usage.useOperand(extraFlags.src0, src0Regs);
+                break;
+            }
+            // VOP2
+            usage.useOperand(((insnCode>>17)&0xff) + (mode1 == GCN_DS1_SGPR ? 0 : 256),
+                        dstRegs);
+            usage.useOperand(extraFlags.src0, src0Regs);
+            if (mode1 == GCN_DS1_SGPR || mode1 == GCN_SRC1_SGPR)
+                usage.useOperand((insnCode>>9)&0xff, src1Regs);
+            else
+                usage.useOperand(vsrc1, src1Regs);
+            if (mode1 == GCN_ARG1_IMM || mode1 == GCN_ARG2_IMM)
+                usage.literal = true;
+            break;
+        }
+        case GCNENC_VOP3A:
+        case GCNENC_VOP3B:
+        case GCNENC_VOP3P:
+        {
+            if (mode1 == GCN_VOP_ARG_NONE)
+                break;
+            // VOP3P decoded as VOP3A like in disassembler
+            const GCNInsnMode vmode = (insn.encoding == GCNENC_VOP3P) ?
+                        (mode | GCN_VOP3_VOP3P) : mode;
+            const GCNInsnMode vop3Mode = vmode & GCN_VOP3_MASK2;
+            const bool vop3VOPC = DU::isVOP3VOPC(arch, vmode, insnCode);
+            if ((vmode & GCN_VOP3_NODST) == 0)
+            {
+                if (vop3VOPC || (vmode & GCN_VOP3_DST_SGPR) != 0)
+                    usage.useSGPR(insnCode&0xff, (vmode & GCN_VOP3_DST_SGPR) ? 1 : 2);
+                else
+                    usage.useVGPR(insnCode&0xff, DU::getVOP3RegsNum(vmode, GCN_REG_DST_64));
+            }
+            if (insn.encoding == GCNENC_VOP3B && DU::isVOP3BSDstUsed(mode1))
+                usage.useSGPR((insnCode>>8)&0x7f, 2);
+            const cxuint src0 = insnCode2&0x1ff;
+            const cxuint src1 = (insnCode2>>9)&0x1ff;
+            const cxuint src2 = (insnCode2>>18)&0x1ff;
+            if (vop3Mode == GCN_VOP3_VINTRP)
+            {
+                // src0 is attribute
+                if (mode1 != GCN_P0_P10_P20)
+                    usage.useOperand(src1, 1);
+                if ((vmode & GCN_VOP3_MASK3) == GCN_VINTRP_SRC2)
+                    usage.useOperand(src2, 1);
+                break;
+            }
+            usage.useOperand(src0, src0Regs);
+            if (mode1 == GCN_SRC12_NONE)
+                break;
+            usage.useOperand(src1, src1Regs);
+            if (mode1 != GCN_SRC2_NONE && mode1 != GCN_DST_VCC && !vop3VOPC)
+            {
+                if (mode1 == GCN_DS2_VCC || mode1 == GCN_SRC2_VCC)
+                    usage.useSGPR(src2, 2);
+                else
+                    usage.useOperand(src2, DU::getVOP3RegsNum(vmode, GCN_REG_SRC2_64));
+            }
+            break;
+        }
+        case GCNENC_VINTRP:
+            usage.useVGPR((insnCode>>18)&0xff, 1);
+            if (mode1 != GCN_P0_P10_P20)
+                usage.useVGPR(insnCode&0xff, 1);
+            break;
+        case GCNENC_DS:
+            if (DU::isDSVDstUsed(mode))
+                usage.useVGPR(insnCode2>>24, DU::getDSRegsNum(mode, true));
+            if (DU::isDSVAddrUsed(mode))
+                usage.useVGPR(insnCode2&0xff, 1);
+            if (DU::isDSVDataUsed(mode))
+            {
+                usage.useVGPR((insnCode2>>8)&0xff, DU::getDSRegsNum(mode, false));
+                if ((mode & GCN_SRCS_MASK) == GCN_2SRCS)
+                    usage.useVGPR((insnCode2>>16)&0xff, src1Regs);
+            }
+            break;
+        case GCNENC_MUBUF:
+        case GCNENC_MTBUF:
+            if (mode1 == GCN_ARG_NONE)
+                break;
+            if (mode1 != GCN_MUBUF_NOVAD)
+            {
+                usage.useVGPR((insnCode2>>8)&0xff,
+                        DU::getMUBUFVDataRegsNum(arch, mode, insnCode2));
+                usage.useVGPR(insnCode2&0xff, DU::getMUBUFVAddrRegsNum(arch, insnCode));
+            }
+            usage.useSGPR(((insnCode2>>16)&0x1f)<<2, 4);
+            usage.useOperand(insnCode2>>24, 1);
+            break;
+        case GCNENC_MIMG:
+            usage.useVGPR((insnCode2>>8)&0xff,
+                        DU::getMIMGVDataRegsNum(arch, mode, insnCode, insnCode2));
+            if ((arch & ARCH_GCN_1_5) == 0)
+                usage.useVGPR(insnCode2&0xff, DU::getMIMGVAddrRegsNum(mode));
+            else
+            {
+                const cxuint vaddrsNum = DU::getMIMGVAddrRegsNumGFX10(mode, insnCode);
+                if (((insnCode>>1)&3) == 0)
+                    usage.useVGPR(insnCode2&0xff, vaddrsNum);
+                else
+                {
+                    // NSA: list of VADDR registers in extra dwords
+                    usage.useVGPR(insnCode2&0xff, 1);
+                    for (cxuint i = 1; i < vaddrsNum && i < 13; i++)
+                        usage.useVGPR((extraCodes[(i-1)>>2]>>(((i-1)&3)*8))&0xff, 1);
+                }
+            }
+            usage.useSGPR((insnCode2>>14)&0x7c, DU::getMIMGSRsrcRegsNum(arch, insnCode));
+            if ((mode & GCN_MIMG_SAMPLE) != 0)
+                usage.useSGPR(((insnCode2>>21)&0x1f)<<2, 4);
+            break;
+        case GCNENC_FLAT:
+        {
+            const cxuint flatMode = mode & GCN_FLAT_MODEMASK;
+            const cxuint nullCode = (arch & ARCH_GCN_1_5) != 0 ? 0x7d : 0x7f;
+            const cxuint vaddrRegs = DU::getFLATVAddrRegsNum(flatMode, insnCode2, nullCode);
+            if (vaddrRegs != 0)
+                usage.useVGPR(insnCode2&0xff, vaddrRegs);
+            const cxuint saddr = DU::getFLATSAddrReg(arch, flatMode, insnCode2);
+            if (saddr != DU::noReg)
+                usage.useSGPR(saddr, flatMode == GCN_FLAT_SCRATCH ? 1 : 2);
+            if ((mode & GCN_FLAT_ADST) == 0 || (mode & GCN_FLAT_NODST) == 0)
+                usage.useVGPR(insnCode2>>24, DU::getFLATVDstRegsNum(arch, mode, insnCode2));
+            if ((mode & GCN_FLAT_NODATA) == 0)
+                usage.useVGPR((insnCode2>>8)&0xff, ((mode&GCN_DSIZE_MASK)>>GCN_SHIFT2)+1);
+            break;
+        }
+        case GCNENC_EXP:
+        {
+            const cxuint enMask = insnCode & 15;
+            for (cxuint i = 0; i < 4; i++)
+                if ((enMask & (1U<<i)) != 0)
+                    usage.useVGPR((insnCode2>>(i*8))&0xff, 1);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+void CLRX::getGCNCodeStats(GPUDeviceType deviceType, size_t codeSize,
+            const cxbyte* code, DisasmCodeStats& stats)
+{
+    const GPUArchitecture arch = getGPUArchitectureFromDeviceType(deviceType);
+    const GPUArchMask archMask = 1U<<int(arch);
+    const uint32_t* codeWords = reinterpret_cast<const uint32_t*>(code);
+    const size_t codeWordsNum = codeSize>>2;
+    GCNStatsRegUsage usage{ getGPUMaxAddrRegsNumByArchMask(1U<<int(arch),
+                REGTYPE_SGPR), stats.maxSGPR, stats.maxVGPR, false };
+    stats.codeSize += codeSize;
+    size_t pos = 0;
+    while (pos < codeWordsNum)
+    {
+        if (codeWords[pos] == 0)
+        {
+            // zero fill is not instruction
+            pos++;
+            continue;
+        }
+        uint32_t insnCode = 0, insnCode2 = 0;
+        uint32_t extraCodes[3];
+        const GCNInstruction* insn = decodeGCNInstruction(deviceType, codeWordsNum,
+                    codeWords, pos, insnCode, insnCode2, extraCodes);
+        stats.instrsNum++;
+        if (insn == nullptr)
+        {
+            stats.illegalsNum++;
+            stats.encodingCounts[0]++;
+            continue;
+        }
+        stats.encodingCounts[insn->encoding]++;
+        stats.groupCounts[cxuint(gcnEncodingGroupTable[insn->encoding])]++;
+        if (insn->encoding == GCNENC_SOPP && ::strcmp(insn->mnemonic, "s_waitcnt") == 0)
+            stats.waitcntsNum++;
+        usage.literal = false;
+        getGCNInstrRegUsage(archMask, *insn, insnCode, insnCode2, extraCodes, usage);
+        if (usage.literal)
+            stats.literalsNum++;
+    }
+    stats.maxSGPR = usage.maxSGPR;
+    stats.maxVGPR = usage.maxVGPR;
+}
+
+void Disassembler::getCodeStats(std::vector<DisasmCodeStats>& stats)
+{
+    DisasmIndex index;
+    buildIndex(index);
+    const GPUDeviceType deviceType = getDeviceType();
+    for (size_t i = 0; i < index.getRegionsNum(); i++)
+    {
+        const DisasmIndexRegion& region = index.getRegion(i);
+        const cxbyte* code = getIndexSectionCode(index, region.section);
+        DisasmCodeStats rstats;
+        rstats.name = region.name;
+        getGCNCodeStats(deviceType, region.size, code + region.offset, rstats);
+        stats.push_back(rstats);
+    }
+}
@@ -19,6 +19,7 @@
 
 #include <CLRX/Config.h>
 #include <string>
+#include <sstream>
 #include <cstring>
 #include <ostream>
 #include <cstring>
@@ -32,19 +33,143 @@
 #include <CLRX/utils/GPUId.h>
 #include <CLRX/amdasm/Disassembler.h>
 #include "DisasmInternals.h"
+#include "DisasmDataDump.h"
 
 using namespace CLRX;
 
 DisasmException::DisasmException(const std::string& message) : Exception(message)
 { }
 
+/*
+ * label set
+ */
+
+size_t DisasmLabelSet::findNextInBitmap(size_t wordPos) const
+{
+    size_t i = wordPos>>6;
+    if (i >= bitmap.size())
+        return SIZE_MAX;
+    uint64_t word = bitmap[i] & (UINT64_MAX<<(wordPos&63));
+    while (word == 0)
+    {
+        if (++i >= bitmap.size())
+            return SIZE_MAX;
+        word = bitmap[i];
+    }
+    return (i<<6) + CTZ64(word);
+}
+
+DisasmLabelSet::ConstIterator& DisasmLabelSet::ConstIterator::operator++()
+{
+    const size_t bitmapPos = (wordPos != SIZE_MAX) ? wordPos<<2 : SIZE_MAX;
+    if (extraIndex < set->extraLabels.size() && set->extraLabels[extraIndex] < bitmapPos)
+        extraIndex++;
+    else if (wordPos != SIZE_MAX)
+        wordPos = set->findNextInBitmap(wordPos+1);
+    return *this;
+}
+
+void DisasmLabelSet::prepare()
+{
+    // move labels that fits in bitmap, sort and remove duplicates in extra labels
+    const size_t bitmapWords = bitmap.size()<<6;
+    auto newEnd = std::remove_if(extraLabels.begin(), extraLabels.end(),
+        [this, bitmapWords](size_t pos)
+        {
+            if ((pos&3) != 0 || (pos>>2) >= bitmapWords)
+                return false;
+            bitmap[pos>>8] |= 1ULL<<((pos>>2)&63);
+            return true;
+        });
+    std::sort(extraLabels.begin(), newEnd);
+    extraLabels.resize(std::unique(extraLabels.begin(), newEnd) - extraLabels.begin());
+}
+
+bool DisasmLabelSet::contains(size_t pos) const
+{
+    if ((pos&3) == 0 && (pos>>8) < bitmap.size() &&
+            (bitmap[pos>>8] & (1ULL<<((pos>>2)&63))) != 0)
+        return true;
+    return std::binary_search(extraLabels.begin(), extraLabels.end(), pos);
+}
+
+DisasmLabelSet::ConstIterator DisasmLabelSet::lowerBound(size_t pos) const
+{
+    const size_t wordPos = (pos>>2) + ((pos&3) != 0);
+    return ConstIterator(this, findNextInBitmap(wordPos),
+            std::lower_bound(extraLabels.begin(), extraLabels.end(), pos) -
+                extraLabels.begin());
+}
+
 ISADisassembler::ISADisassembler(Disassembler& _disassembler, cxuint outBufSize)
         : disassembler(_disassembler), startOffset(0), labelStartOffset(0),
           dontPrintLabelsAfterCode(false), output(outBufSize, _disassembler.getOutput())
 { }
 
+/// capture of output text
+struct ISADisassembler::TextCapture
+{
+    std::stringbuf buffer;  ///< captured text
+    std::streambuf* oldBuffer;  ///< previous buffer of output stream
+    /// places of section numbers of numbered labels (offset and length)
+    std::vector<std::pair<size_t, size_t> > sectionFixups;
+};
+
 ISADisassembler::~ISADisassembler()
-{ }
+{
+    if (textCapture)
+    {
+        // restore output buffer before flushing rest of output
+        output.flush();
+        disassembler.getOutput().rdbuf(textCapture->oldBuffer);
+    }
+}
+
+size_t ISADisassembler::writeLabelSectionCount(char* buf, size_t bufPos)
+{
+    const size_t length = itocstrCStyle(disassembler.sectionCount,
+                    buf+bufPos, 22, 10, 0, false);
+    if (textCapture)
+    {
+        // remember place of section number in captured text
+        const size_t textPos = size_t(textCapture->buffer.pubseekoff(0,
+                    std::ios_base::cur, std::ios_base::out));
+        textCapture->sectionFixups.push_back(std::make_pair(
+                    textPos + output.getBufferedSize() + bufPos, length));
+    }
+    return bufPos + length;
+}
+
+void ISADisassembler::beginTextCapture()
+{
+    output.flush();
+    textCapture.reset(new TextCapture);
+    textCapture->oldBuffer = disassembler.getOutput().rdbuf(&textCapture->buffer);
+}
+
+void ISADisassembler::endTextCapture(DisasmCachedText& text)
+{
+    output.flush();
+    disassembler.getOutput().rdbuf(textCapture->oldBuffer);
+    text.text = textCapture->buffer.str();
+    text.sectionFixups = std::move(textCapture->sectionFixups);
+    textCapture.reset();
+}
+
+void ISADisassembler::writeCachedText(const DisasmCachedText& text)
+{
+    size_t pos = 0;
+    for (const auto& fixup: text.sectionFixups)
+    {
+        output.write(fixup.first-pos, text.text.c_str()+pos);
+        // put current section number
+        char* buf = output.reserve(22);
+        output.forward(writeLabelSectionCount(buf, 0));
+        pos = fixup.first + fixup.second;
+    }
+    output.write(text.text.size()-pos, text.text.c_str()+pos);
+    output.flush();
+}
 
 void ISADisassembler::writeLabelsToPosition(size_t pos, LabelIter& labelIter,
               NamedLabelIter& namedLabelIter)
@@ -86,8 +211,7 @@ void ISADisassembler::writeLabelsToPosition(size_t pos, LabelIter& labelIter,
                 buf[bufPos++] = 'L';
                 bufPos += itocstrCStyle(*labelIter, buf+bufPos, 22, 10, 0, false);
                 buf[bufPos++] = '_';
-                bufPos += itocstrCStyle(disassembler.sectionCount,
-                                buf+bufPos, 22, 10, 0, false);
+                bufPos = writeLabelSectionCount(buf, bufPos);
                 if (curPos != pos)
                 {
                     // if label shifted back by some bytes before encoded instruction
@@ -112,8 +236,7 @@ void ISADisassembler::writeLabelsToPosition(size_t pos, LabelIter& labelIter,
             if(namedPos <= numberedPos && haveNamedLabel)
             {
                 curPos = namedLabelIter->first;
-                output.write(namedLabelIter->second.size(),
-                       namedLabelIter->second.c_str());
+                output.writeString(getNamedLabelName(*namedLabelIter));
                 char* buf = output.reserve(50);
                 size_t bufPos = 0;
                 if (curPos != pos)
@@ -173,8 +296,7 @@ void ISADisassembler::writeLabelsToEnd(size_t start, LabelIter labelIter,
             buf[bufPos++] = 'L';
             bufPos += itocstrCStyle(*labelIter, buf+bufPos, 22, 10, 0, false);
             buf[bufPos++] = '_';
-            bufPos += itocstrCStyle(disassembler.sectionCount,
-                            buf+bufPos, 22, 10, 0, false);
+            bufPos = writeLabelSectionCount(buf, bufPos);
             buf[bufPos++] = ':';
             buf[bufPos++] = '\n';
             output.forward(bufPos);
@@ -195,8 +317,7 @@ void ISADisassembler::writeLabelsToEnd(size_t start, LabelIter labelIter,
                 buf[bufPos++] = '\n';
                 output.forward(bufPos);
             }
-            output.write(namedLabelIter->second.size(),
-                        namedLabelIter->second.c_str());
+            output.writeString(getNamedLabelName(*namedLabelIter));
             pos = namedLabelIter->first;
             ++namedLabelIter;
         }
@@ -209,7 +330,7 @@ void ISADisassembler::writeLocation(size_t pos)
     if (namedLabelIt != namedLabels.end())
     {
         /* print named label */
-        output.write(namedLabelIt->second.size(), namedLabelIt->second.c_str());
+        output.writeString(getNamedLabelName(*namedLabelIt));
         return;
     }
     /* otherwise we print numbered label */
@@ -219,7 +340,7 @@ void ISADisassembler::writeLocation(size_t pos)
     buf[bufPos++] = 'L';
     bufPos += itocstrCStyle(pos, buf+bufPos, 22, 10, 0, false);
     buf[bufPos++] = '_';
-    bufPos += itocstrCStyle(disassembler.sectionCount, buf+bufPos, 22, 10, 0, false);
+    bufPos = writeLabelSectionCount(buf, bufPos);
     output.forward(bufPos);
 }
 
@@ -263,6 +384,60 @@ bool ISADisassembler::writeRelocation(size_t pos, RelocIter& relocIter)
     return true;
 }
 
+void ISADisassembler::makeCodeCacheKey(std::string& key) const
+{
+    /* key holds all things that affects text of code: state of disassembler,
+     * code, labels printed in code, named labels (used by jumps) and relocations.
+     * positions are relative to start offset. section number is not in key,
+     * because it is replaced while writing cached text. start offset is in key,
+     * because positions of labels and code are printed in text */
+    putCodeCacheKeyValue(key, cxuint(disassembler.getDeviceType()));
+    putCodeCacheKeyValue(key, disassembler.getFlags());
+    putCodeCacheKeyValue(key, startOffset);
+    putCodeCacheKeyValue(key, labelStartOffset-startOffset);
+    putCodeCacheKeyValue(key, cxbyte(dontPrintLabelsAfterCode));
+    putCodeCacheKeyValue(key, inputSize);
+    key.append(reinterpret_cast<const char*>(input), inputSize);
+    
+    // only labels printed before instructions (or after code)
+    const size_t labelsEnd = dontPrintLabelsAfterCode ?
+                startOffset + inputSize : SIZE_MAX;
+    size_t labelsNum = 0;
+    const size_t labelsNumPos = key.size();
+    putCodeCacheKeyValue(key, labelsNum);
+    for (LabelIter it = labels.lowerBound(labelStartOffset);
+            it != labels.end() && *it <= labelsEnd; ++it, labelsNum++)
+        putCodeCacheKeyValue(key, *it-startOffset);
+    key.replace(labelsNumPos, sizeof(size_t),
+                reinterpret_cast<const char*>(&labelsNum), sizeof(size_t));
+    
+    // all named labels, because they can be used by jumps outside code
+    putCodeCacheKeyValue(key, namedLabels.size());
+    for (const auto& namedLabel: namedLabels)
+    {
+        putCodeCacheKeyValue(key, namedLabel.first-startOffset);
+        key.append(getNamedLabelName(namedLabel));
+        key.push_back(0);
+    }
+    
+    // relocations in code
+    const auto relocCmp = [](const std::pair<size_t, Relocation>& a, size_t pos)
+            { return a.first < pos; };
+    auto relocIt = std::lower_bound(relocations.begin(), relocations.end(),
+                startOffset, relocCmp);
+    const auto relocEnd = std::lower_bound(relocIt, relocations.end(),
+                startOffset+inputSize, relocCmp);
+    putCodeCacheKeyValue(key, size_t(relocEnd-relocIt));
+    for (; relocIt != relocEnd; ++relocIt)
+    {
+        putCodeCacheKeyValue(key, relocIt->first-startOffset);
+        putCodeCacheKeyValue(key, cxuint(relocIt->second.type));
+        putCodeCacheKeyValue(key, relocIt->second.addend);
+        key.append(relSymbols[relocIt->second.symbol].c_str());
+        key.push_back(0);
+    }
+}
+
 void ISADisassembler::clearNumberedLabels()
 {
     labels.clear();
@@ -270,13 +445,19 @@ void ISADisassembler::clearNumberedLabels()
 
 void ISADisassembler::prepareLabelsAndRelocations()
 {
-    std::sort(labels.begin(), labels.end());
-    const auto newEnd = std::unique(labels.begin(), labels.end());
-    labels.resize(newEnd-labels.begin());
+    labels.prepare();
     mapSort(namedLabels.begin(), namedLabels.end());
     mapSort(relocations.begin(), relocations.end());
 }
 
+ISADisassembler::NamedLabelIter ISADisassembler::findNamedLabel(size_t pos) const
+{
+    return std::lower_bound(namedLabels.begin(), namedLabels.end(),
+            std::make_pair(pos, size_t(0)),
+            [](const std::pair<size_t, size_t>& a, const std::pair<size_t, size_t>& b)
+            { return a.first < b.first; });
+}
+
 void ISADisassembler::beforeDisassemble()
 {
     clearNumberedLabels();
@@ -284,9 +465,59 @@ void ISADisassembler::beforeDisassemble()
     prepareLabelsAndRelocations();
 }
 
+void ISADisassembler::copyAnalysisState(const ISADisassembler& src)
+{
+    labels = src.labels;
+    namedLabels = src.namedLabels;
+    namedLabelNames = src.namedLabelNames;
+    relSymbols = src.relSymbols;
+    relocations = src.relocations;
+    disassembler.sectionCount = src.disassembler.sectionCount;
+}
+
+void ISADisassembler::disassemblePieces(const std::vector<DisasmCodePiece>& pieces,
+            cxuint threadsNum, std::vector<DisasmCachedText>& texts) const
+{
+    texts.assign(pieces.size(), DisasmCachedText());
+    if (pieces.empty())
+        return;
+    /* pieces are divided into contiguous chunks (more chunks than threads to balance
+     * work). every chunk is disassembled by own disassembler with copy of labels */
+    const size_t chunksNum = std::min(pieces.size(),
+                size_t(threadsNum!=0 ? threadsNum : getHardwareThreadsNum())<<2);
+    parallelForEach(chunksNum, threadsNum, [&](size_t chunk)
+    {
+        std::ostringstream oss;
+        Disassembler chunkDisasm(disassembler.getDeviceType(), 0, nullptr, oss,
+                    disassembler.getFlags());
+        ISADisassembler* isaDisasm = chunkDisasm.isaDisassembler.get();
+        isaDisasm->copyAnalysisState(*this);
+        const size_t end = (chunk+1)*pieces.size() / chunksNum;
+        for (size_t i = chunk*pieces.size() / chunksNum; i < end; i++)
+        {
+            const DisasmCodePiece& piece = pieces[i];
+            chunkDisasm.setFlags(piece.flags);
+            isaDisasm->setInput(piece.inputSize, piece.input, piece.startOffset,
+                        piece.labelStartOffset);
+            isaDisasm->setDontPrintLabels(piece.dontPrintLabelsAfterCode);
+            // capture places of section numbers (can be cached with whole code)
+            isaDisasm->beginTextCapture();
+            try
+            { isaDisasm->disassemble(); }
+            catch(...)
+            {
+                isaDisasm->endTextCapture(texts[i]);
+                throw;
+            }
+            isaDisasm->endTextCapture(texts[i]);
+        }
+    });
+}
+
 Disassembler::Disassembler(const AmdMainGPUBinary32& binary, std::ostream& _output,
             Flags _flags) : fromBinary(true), binaryFormat(BinaryFormat::AMD),
-            amdInput(nullptr), output(_output), flags(_flags), sectionCount(0)
+            amdInput(nullptr), output(_output), flags(_flags), sectionCount(0),
+            codeCache(nullptr), threadsNum(1)
 {
     isaDisassembler.reset(new GCNDisassembler(*this));
     amdInput = getAmdDisasmInputFromBinary32(binary, flags);
@@ -294,7 +525,8 @@ Disassembler::Disassembler(const AmdMainGPUBinary32& binary, std::ostream& _outp
 
 Disassembler::Disassembler(const AmdMainGPUBinary64& binary, std::ostream& _output,
             Flags _flags) : fromBinary(true), binaryFormat(BinaryFormat::AMD),
-            amdInput(nullptr), output(_output), flags(_flags), sectionCount(0)
+            amdInput(nullptr), output(_output), flags(_flags), sectionCount(0),
+            codeCache(nullptr), threadsNum(1)
 {
     isaDisassembler.reset(new GCNDisassembler(*this));
     amdInput = getAmdDisasmInputFromBinary64(binary, flags);
@@ -303,7 +535,7 @@ Disassembler::Disassembler(const AmdMainGPUBinary64& binary, std::ostream& _outp
 Disassembler::Disassembler(const AmdCL2MainGPUBinary32& binary, std::ostream& _output,
            Flags _flags, cxuint driverVersion) : fromBinary(true),
             binaryFormat(BinaryFormat::AMDCL2), amdCL2Input(nullptr), output(_output),
-            flags(_flags), sectionCount(0)
+            flags(_flags), sectionCount(0), codeCache(nullptr), threadsNum(1)
 {
     isaDisassembler.reset(new GCNDisassembler(*this));
     amdCL2Input = getAmdCL2DisasmInputFromBinary32(binary, driverVersion,
@@ -313,7 +545,7 @@ Disassembler::Disassembler(const AmdCL2MainGPUBinary32& binary, std::ostream& _o
 Disassembler::Disassembler(const AmdCL2MainGPUBinary64& binary, std::ostream& _output,
            Flags _flags, cxuint driverVersion) : fromBinary(true),
             binaryFormat(BinaryFormat::AMDCL2), amdCL2Input(nullptr), output(_output),
-            flags(_flags), sectionCount(0)
+            flags(_flags), sectionCount(0), codeCache(nullptr), threadsNum(1)
 {
     isaDisassembler.reset(new GCNDisassembler(*this));
     amdCL2Input = getAmdCL2DisasmInputFromBinary64(binary, driverVersion,
@@ -322,7 +554,8 @@ Disassembler::Disassembler(const AmdCL2MainGPUBinary64& binary, std::ostream& _o
 
 Disassembler::Disassembler(const ROCmBinary& binary, std::ostream& _output, Flags _flags)
          : fromBinary(true), binaryFormat(BinaryFormat::ROCM),
-           rocmInput(nullptr), output(_output), flags(_flags), sectionCount(0)
+           rocmInput(nullptr), output(_output), flags(_flags), sectionCount(0),
+           codeCache(nullptr), threadsNum(1)
 {
     isaDisassembler.reset(new GCNDisassembler(*this));
     rocmInput = getROCmDisasmInputFromBinary(binary);
@@ -331,7 +564,8 @@ Disassembler::Disassembler(const ROCmBinary& binary, std::ostream& _output, Flag
 Disassembler::Disassembler(const ROCmBinary& binary, std::ostream& _output,
                 bool hasGPUDeviceType, GPUDeviceType deviceType, Flags _flags)
          : fromBinary(true), binaryFormat(BinaryFormat::ROCM),
-           rocmInput(nullptr), output(_output), flags(_flags), sectionCount(0)
+           rocmInput(nullptr), output(_output), flags(_flags), sectionCount(0),
+           codeCache(nullptr), threadsNum(1)
 {
     isaDisassembler.reset(new GCNDisassembler(*this));
     ROCmDisasmInput* _rocmInput = getROCmDisasmInputFromBinary(binary);
@@ -344,23 +578,52 @@ Disassembler::Disassembler(const ROCmBinary& binary, std::ostream& _output,
     rocmInput = _rocmInput;
 }
 
+Disassembler::Disassembler(const Amd3Binary& binary, std::ostream& _output, Flags _flags)
+         : fromBinary(true), binaryFormat(BinaryFormat::ROCM),
+           rocmInput(nullptr), output(_output), flags(_flags), sectionCount(0),
+           codeCache(nullptr), threadsNum(1)
+{
+    isaDisassembler.reset(new GCNDisassembler(*this));
+    rocmInput = getAmd3DisasmInputFromBinary(binary);
+}
+
+Disassembler::Disassembler(const Amd3Binary& binary, std::ostream& _output,
+                bool hasGPUDeviceType, GPUDeviceType deviceType, Flags _flags)
+         : fromBinary(true), binaryFormat(BinaryFormat::ROCM),
+           rocmInput(nullptr), output(_output), flags(_flags), sectionCount(0),
+           codeCache(nullptr), threadsNum(1)
+{
+    isaDisassembler.reset(new GCNDisassembler(*this));
+    ROCmDisasmInput* _rocmInput = getAmd3DisasmInputFromBinary(binary);
+    if (hasGPUDeviceType)
+    {
+        _rocmInput->deviceType = deviceType;
+        _rocmInput->archMinor = 0;
+        _rocmInput->archStepping = 0;
+    }
+    rocmInput = _rocmInput;
+}
+
 Disassembler::Disassembler(const AmdDisasmInput* disasmInput, std::ostream& _output,
             Flags _flags) : fromBinary(false), binaryFormat(BinaryFormat::AMD),
-            amdInput(disasmInput), output(_output), flags(_flags), sectionCount(0)
+            amdInput(disasmInput), output(_output), flags(_flags), sectionCount(0),
+            codeCache(nullptr), threadsNum(1)
 {
     isaDisassembler.reset(new GCNDisassembler(*this));
 }
 
 Disassembler::Disassembler(const AmdCL2DisasmInput* disasmInput, std::ostream& _output,
             Flags _flags) : fromBinary(false), binaryFormat(BinaryFormat::AMDCL2),
-            amdCL2Input(disasmInput), output(_output), flags(_flags), sectionCount(0)
+            amdCL2Input(disasmInput), output(_output), flags(_flags), sectionCount(0),
+            codeCache(nullptr), threadsNum(1)
 {
     isaDisassembler.reset(new GCNDisassembler(*this));
 }
 
 Disassembler::Disassembler(const ROCmDisasmInput* disasmInput, std::ostream& _output,
                  Flags _flags) : fromBinary(false), binaryFormat(BinaryFormat::ROCM),
-            rocmInput(disasmInput), output(_output), flags(_flags), sectionCount(0)
+            rocmInput(disasmInput), output(_output), flags(_flags), sectionCount(0),
+            codeCache(nullptr), threadsNum(1)
 {
     isaDisassembler.reset(new GCNDisassembler(*this));
 }
@@ -368,7 +631,8 @@ Disassembler::Disassembler(const ROCmDisasmInput* disasmInput, std::ostream& _ou
 Disassembler::Disassembler(GPUDeviceType deviceType, const GalliumBinary& binary,
            std::ostream& _output, Flags _flags, cxuint llvmVersion) :
            fromBinary(true), binaryFormat(BinaryFormat::GALLIUM),
-           galliumInput(nullptr), output(_output), flags(_flags), sectionCount(0)
+           galliumInput(nullptr), output(_output), flags(_flags), sectionCount(0),
+           codeCache(nullptr), threadsNum(1)
 {
     isaDisassembler.reset(new GCNDisassembler(*this));
     galliumInput = getGalliumDisasmInputFromBinary(deviceType, binary, llvmVersion);
@@ -376,7 +640,8 @@ Disassembler::Disassembler(GPUDeviceType deviceType, const GalliumBinary& binary
 
 Disassembler::Disassembler(const GalliumDisasmInput* disasmInput, std::ostream& _output,
              Flags _flags) : fromBinary(false), binaryFormat(BinaryFormat::GALLIUM),
-            galliumInput(disasmInput), output(_output), flags(_flags), sectionCount(0)
+            galliumInput(disasmInput), output(_output), flags(_flags), sectionCount(0),
+            codeCache(nullptr), threadsNum(1)
 {
     isaDisassembler.reset(new GCNDisassembler(*this));
 }
@@ -384,7 +649,7 @@ Disassembler::Disassembler(const GalliumDisasmInput* disasmInput, std::ostream&
 Disassembler::Disassembler(GPUDeviceType deviceType, size_t rawCodeSize,
            const cxbyte* rawCode, std::ostream& _output, Flags _flags)
        : fromBinary(true), binaryFormat(BinaryFormat::RAWCODE),
-         output(_output), flags(_flags), sectionCount(0)
+         output(_output), flags(_flags), sectionCount(0), codeCache(nullptr), threadsNum(1)
 {
     isaDisassembler.reset(new GCNDisassembler(*this));
     rawInput = new RawCodeInput{ deviceType, rawCodeSize, rawCode };
@@ -435,131 +700,13 @@ GPUDeviceType Disassembler::getDeviceType() const
 void CLRX::printDisasmData(size_t size, const cxbyte* data, std::ostream& output,
                 bool secondAlign)
 {
-    char buf[68];
-    /// const strings for .byte and fill pseudo-ops
-    const char* linePrefix = "    .byte ";
-    const char* fillPrefix = "    .fill ";
-    size_t prefixSize = 10;
-    if (secondAlign)
-    {
-        // const string for double alignment
-        linePrefix = "        .byte ";
-        fillPrefix = "        .fill ";
-        prefixSize += 4;
-    }
-    ::memcpy(buf, linePrefix, prefixSize);
-    for (size_t p = 0; p < size;)
-    {
-        size_t fillEnd;
-        // find max repetition of this element
-        for (fillEnd = p+1; fillEnd < size && data[fillEnd]==data[p]; fillEnd++);
-        if (fillEnd >= p+8)
-        {
-            // if element repeated for least 1 line
-            // print .fill pseudo-op: .fill SIZE, 1, VALUE
-            ::memcpy(buf, fillPrefix, prefixSize);
-            const size_t oldP = p;
-            p = (fillEnd != size) ? fillEnd&~size_t(7) : fillEnd;
-            size_t bufPos = prefixSize;
-            bufPos += itocstrCStyle(p-oldP, buf+bufPos, 22, 10);
-            memcpy(buf+bufPos, ", 1, ", 5);
-            bufPos += 5;
-            // value to fill
-            bufPos += itocstrCStyle(data[oldP], buf+bufPos, 6, 16, 2);
-            buf[bufPos++] = '\n';
-            output.write(buf, bufPos);
-            ::memcpy(buf, linePrefix, prefixSize);
-            continue;
-        }
-        
-        const size_t lineEnd = std::min(p+8, size);
-        size_t bufPos = prefixSize;
-        // print 8 or less (if end of data) bytes
-        for (; p < lineEnd; p++)
-        {
-            buf[bufPos++] = '0';
-            buf[bufPos++] = 'x';
-            {
-                // inline byte in hexadecimal
-                cxuint digit = data[p]>>4;
-                if (digit < 10)
-                    buf[bufPos++] = '0'+digit;
-                else
-                    buf[bufPos++] = 'a'+digit-10;
-                digit = data[p]&0xf;
-                if (digit < 10)
-                    buf[bufPos++] = '0'+digit;
-                else
-                    buf[bufPos++] = 'a'+digit-10;
-            }
-            if (p+1 < lineEnd)
-            {
-                buf[bufPos++] = ',';
-                buf[bufPos++] = ' ';
-            }
-        }
-        buf[bufPos++] = '\n';
-        output.write(buf, bufPos);
-    }
+    printDisasmDataT<disasmDumpVectorized>(size, data, output, secondAlign);
 }
 
 void CLRX::printDisasmDataU32(size_t size, const uint32_t* data, std::ostream& output,
                 bool secondAlign)
 {
-    char buf[68];
-    /// const strings for .byte and fill pseudo-ops
-    const char* linePrefix = "    .int ";
-    const char* fillPrefix = "    .fill ";
-    size_t fillPrefixSize = 10;
-    if (secondAlign)
-    {
-        // const string for double alignment
-        linePrefix = "        .int ";
-        fillPrefix = "        .fill ";
-        fillPrefixSize += 4;
-    }
-    const size_t intPrefixSize = fillPrefixSize-1;
-    ::memcpy(buf, linePrefix, intPrefixSize);
-    for (size_t p = 0; p < size;)
-    {
-        size_t fillEnd;
-        // find max repetition of this char
-        for (fillEnd = p+1; fillEnd < size && ULEV(data[fillEnd])==ULEV(data[p]);
-             fillEnd++);
-        if (fillEnd >= p+4)
-        {
-            // if element repeated for least 1 line
-            // print .fill pseudo-op
-            ::memcpy(buf, fillPrefix, fillPrefixSize);
-            const size_t oldP = p;
-            p = (fillEnd != size) ? fillEnd&~size_t(3) : fillEnd;
-            size_t bufPos = fillPrefixSize;
-            bufPos += itocstrCStyle(p-oldP, buf+bufPos, 22, 10);
-            memcpy(buf+bufPos, ", 4, ", 5);
-            bufPos += 5;
-            // print fill value
-            bufPos += itocstrCStyle(ULEV(data[oldP]), buf+bufPos, 12, 16, 8);
-            buf[bufPos++] = '\n';
-            output.write(buf, bufPos);
-            ::memcpy(buf, linePrefix, fillPrefixSize);
-            continue;
-        }
-        
-        const size_t lineEnd = std::min(p+4, size);
-        size_t bufPos = intPrefixSize;
-        // print four or less (if end of data) dwords
-        for (; p < lineEnd; p++)
-        {
-            bufPos += itocstrCStyle(ULEV(data[p]), buf+bufPos, 12, 16, 8);
-            if (p+1 < lineEnd)
-            {
-                buf[bufPos++] = ',';
-                buf[bufPos++] = ' ';
-            }
-        }
-        buf[bufPos++] = '\n';
-        output.write(buf, bufPos);
-    }
+    printDisasmDataU32T<disasmDumpVectorized>(size, data, output, secondAlign);
 }
 
 void CLRX::printDisasmLongString(size_t size, const char* data, std::ostream& output,
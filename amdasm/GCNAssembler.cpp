@@ -334,8 +334,9 @@ void GCNAssembler::assemble(const CString& inMnemonic, const char* mnemPlace,
         default:
             break;
     }
-    // register RegVarUsage in tests, do not apply normal usage
-    if (good && (assembler.getFlags() & ASM_TESTRUN) != 0)
+    // register RegVarUsage in tests or to check or sink waits, do not apply normal usage
+    if (good && (assembler.getFlags() &
+                (ASM_TESTRUN|ASM_CHECKWAITS|ASM_SINKWAITS)) != 0)
     {
         flushInstrRVUs(usageHandler);
         flushWaitInstrs(waitHandler);
@@ -606,192 +607,15 @@ bool GCNAssembler::parseRegisterType(const char*& linePtr, const char* end, cxui
     return false;
 }
 
-enum : cxbyte
-{
-    GCNENCSCH_1DWORD = 0,
-    GCNENCSCH_2DWORD,
-    GCNENCSCH_MIMG_DWORDS
-};
-
-// gcn encoding sizes table: true - if 8 byte encoding, false - 4 byte encoding
-// for GCN1.0/1.1
-static const cxbyte gcnSize11Table[16] =
-{
-    GCNENCSCH_1DWORD, // GCNENC_SMRD, // 0000
-    GCNENCSCH_1DWORD, // GCNENC_SMRD, // 0001
-    GCNENCSCH_1DWORD, // GCNENC_VINTRP, // 0010
-    GCNENCSCH_1DWORD, // GCNENC_NONE, // 0011 - illegal
-    GCNENCSCH_2DWORD,  // GCNENC_VOP3A, // 0100
-    GCNENCSCH_1DWORD, // GCNENC_NONE, // 0101 - illegal
-    GCNENCSCH_2DWORD,  // GCNENC_DS,   // 0110
-    GCNENCSCH_2DWORD,  // GCNENC_FLAT, // 0111
-    GCNENCSCH_2DWORD,  // GCNENC_MUBUF, // 1000
-    GCNENCSCH_1DWORD, // GCNENC_NONE,  // 1001 - illegal
-    GCNENCSCH_2DWORD,  // GCNENC_MTBUF, // 1010
-    GCNENCSCH_1DWORD, // GCNENC_NONE,  // 1011 - illegal
-    GCNENCSCH_2DWORD,  // GCNENC_MIMG,  // 1100
-    GCNENCSCH_1DWORD, // GCNENC_NONE,  // 1101 - illegal
-    GCNENCSCH_2DWORD,  // GCNENC_EXP,   // 1110
-    GCNENCSCH_1DWORD // GCNENC_NONE   // 1111 - illegal
-};
-
-// for GCN1.2/1.4
-static const cxbyte gcnSize12Table[16] =
-{
-    GCNENCSCH_2DWORD,  // GCNENC_SMEM, // 0000
-    GCNENCSCH_2DWORD,  // GCNENC_EXP, // 0001
-    GCNENCSCH_1DWORD, // GCNENC_NONE, // 0010 - illegal
-    GCNENCSCH_1DWORD, // GCNENC_NONE, // 0011 - illegal
-    GCNENCSCH_2DWORD,  // GCNENC_VOP3A, // 0100
-    GCNENCSCH_1DWORD, // GCNENC_VINTRP, // 0101
-    GCNENCSCH_2DWORD,  // GCNENC_DS,   // 0110
-    GCNENCSCH_2DWORD,  // GCNENC_FLAT, // 0111
-    GCNENCSCH_2DWORD,  // GCNENC_MUBUF, // 1000
-    GCNENCSCH_1DWORD, // GCNENC_NONE,  // 1001 - illegal
-    GCNENCSCH_2DWORD,  // GCNENC_MTBUF, // 1010
-    GCNENCSCH_1DWORD, // GCNENC_NONE,  // 1011 - illegal
-    GCNENCSCH_2DWORD,  // GCNENC_MIMG,  // 1100
-    GCNENCSCH_1DWORD, // GCNENC_NONE,  // 1101 - illegal
-    GCNENCSCH_1DWORD, // GCNENC_NONE,  // 1110 - illegal
-    GCNENCSCH_1DWORD // GCNENC_NONE   // 1111 - illegal
-};
-
-static const cxbyte gcnSize15Table[16] =
-{
-    GCNENCSCH_1DWORD, // GCNENC_NONE, // 0000
-    GCNENCSCH_1DWORD, // GCNENC_NONE, // 0001
-    GCNENCSCH_1DWORD, // CNENC_VINTRP, // 0010
-    GCNENCSCH_2DWORD,  // GCNENC_VOP3P, // 0011
-    GCNENCSCH_1DWORD, // GCNENC_NONE, // 0100
-    GCNENCSCH_2DWORD,  // GCNENC_VOP3A, // 0101
-    GCNENCSCH_2DWORD,  // GCNENC_DS,   // 0110
-    GCNENCSCH_2DWORD,  // GCNENC_FLAT, // 0111
-    GCNENCSCH_2DWORD,  // GCNENC_MUBUF, // 1000
-    GCNENCSCH_1DWORD, // GCNENC_NONE, // 1001 - illegal
-    GCNENCSCH_2DWORD,  // GCNENC_MTBUF, // 1010
-    GCNENCSCH_1DWORD, // GCNENC_NONE,  // 1011 - illegal
-    GCNENCSCH_MIMG_DWORDS,  // GCNENC_MIMG,  // 1100
-    GCNENCSCH_2DWORD,  // GCNENC_SMEM,  // 1101
-    GCNENCSCH_2DWORD,  // GCNENC_EXP,   // 1110
-    GCNENCSCH_1DWORD // GCNENC_NONE   // 1111 - illegal
-};
-
 // get instruction size, used by register allocation to skip instruction
 size_t GCNAssembler::getInstructionSize(size_t codeSize, const cxbyte* code) const
 {
     if (codeSize < 4)
         return 0; // no instruction
-    bool isGCN11 = (curArchMask & ARCH_RX2X0)!=0;
-    bool isGCN12 = (curArchMask & ARCH_GCN_1_2_4)!=0;
-    bool isGCN15 = (curArchMask & ARCH_GCN_1_5)!=0;
-    const uint32_t insnCode = ULEV(*reinterpret_cast<const uint32_t*>(code));
-    uint32_t words = 1;
-    if ((insnCode & 0x80000000U) != 0)
-    {
-        if ((insnCode & 0x40000000U) == 0)
-        {
-            // SOP???
-            if  ((insnCode & 0x30000000U) == 0x30000000U)
-            {
-                // SOP1/SOPK/SOPC/SOPP
-                const uint32_t encPart = (insnCode & 0x0f800000U);
-                if (encPart == 0x0e800000U)
-                {
-                    // SOP1
-                    if ((insnCode&0xff) == 0xff) // literal
-                        words++;
-                }
-                else if (encPart == 0x0f000000U)
-                {
-                    // SOPC
-                    if ((insnCode&0xff) == 0xff ||
-                        (insnCode&0xff00) == 0xff00) // literal
-                        words++;
-                }
-                else if (encPart != 0x0f800000U)
-                {
-                    // SOPK
-                    const cxuint opcode = (insnCode>>23)&0x1f;
-                    if (((!isGCN12 || isGCN15) && opcode == 21) ||
-                        (isGCN12 && !isGCN15 && opcode == 20))
-                        words++; // additional literal
-                }
-            }
-            else
-            {
-                // SOP2
-                if ((insnCode&0xff) == 0xff || (insnCode&0xff00) == 0xff00)
-                    words++;  // literal
-            }
-        }
-        else
-        {
-            // SMRD and others
-            const uint32_t encPart = (insnCode&0x3c000000U)>>26;
-            if (isGCN15)
-            {
-                if (gcnSize15Table[encPart]==GCNENCSCH_MIMG_DWORDS)
-                    words += ((insnCode>>1)&3) + 1;
-                else if (gcnSize15Table[encPart])
-                    words++;
-            }
-            else if (isGCN11 && encPart==0 && (insnCode&0x1ff)==0xff)
-                words++;
-            else if ((!isGCN12 && gcnSize11Table[encPart] && (encPart != 7 || isGCN11)) ||
-                (isGCN12 && gcnSize12Table[encPart]))
-                words++;
-            if (isGCN15 && (encPart==3 || encPart==5))
-            {
-                // include VOP3 literal
-                const uint32_t insnCode2 = ULEV(
-                                *reinterpret_cast<const uint32_t*>(code+4));
-                if ((insnCode2 & 0x1ff) == 0xff || ((insnCode2>>9) & 0x1ff) == 0xff ||
-                    ((insnCode2>>18) & 0x1ff) == 0xff)
-                    words++;
-            }
-        }
-    }
-    else
-    {
-        uint32_t src0 = (insnCode&0x1ff);
-        // some vector instructions
-        if ((insnCode & 0x7e000000U) == 0x7c000000U)
-        {
-            // VOPC
-            if (src0 == 0xff || // literal
-                // SDWA, DDP
-                (isGCN12 && (src0 == 0xf9 || src0 == 0xfa)) ||
-                (isGCN15 && (src0 == 0xe9 || src0 == 0xea)))
-                words++;
-        }
-        else if ((insnCode & 0x7e000000U) == 0x7e000000U)
-        {
-            // VOP1
-            if (src0 == 0xff || // literal
-                // SDWA, DDP
-                (isGCN12 && (src0 == 0xf9 || src0 == 0xfa)) ||
-                (isGCN15 && (src0 == 0xe9 || src0 == 0xea)))
-                words++;
-        }
-        else
-        {
-            // VOP2
-            const cxuint opcode = (insnCode >> 25)&0x3f;
-            if ((!isGCN12 && (opcode == 32 || opcode == 33)) ||
-                (isGCN12 && !isGCN15 && (opcode == 23 || opcode == 24 ||
-                opcode == 36 || opcode == 37)) ||
-                    (isGCN15 && (opcode == 32 || opcode == 33 || // V_MADMK and V_MADAK
-                        opcode == 44 || opcode == 45 || // V_FMAMK_F32, V_FMAAK_F32
-                        opcode == 55 || opcode == 56))) // V_MADMK and V_MADAK
-                words++;  // inline 32-bit constant
-            else if (src0 == 0xff || // literal
-                // SDWA, DDP
-                (isGCN12 && (src0 == 0xf9 || src0 == 0xfa)) ||
-                (isGCN15 && (src0 == 0xe9 || src0 == 0xea)))
-                words++;  // literal
-        }
-    }
-    return words<<2;
+    const GCNEncodingClassTable& encTable = getGCNEncodingClassTable(
+                getGPUArchitectureFromDeviceType(assembler.getDeviceType()));
+    return getGCNInstructionWords(encTable, reinterpret_cast<const uint32_t*>(code),
+                codeSize>>2)<<2;
 }
 
 // for GCN 1.0
@@ -26,6 +26,7 @@
 #include <CLRX/utils/Utilities.h>
 #include <CLRX/utils/GPUId.h>
 #include <CLRX/amdasm/Disassembler.h>
+#include <CLRX/amdasm/Assembler.h>
 #include <CLRX/utils/MemAccess.h>
 #include "GCNInternals.h"
 #include "GCNDisasmInternals.h"
@@ -34,6 +35,8 @@ using namespace CLRX;
 
 static OnceFlag clrxGCNDisasmOnceFlag;
 static std::unique_ptr<GCNInstruction[]> gcnInstrTableByCode = nullptr;
+// encoding class tables for GPU architectures
+static GCNEncodingClassTable gcnEncodingClassTables[cxuint(GPUArchitecture::GPUARCH_MAX)+1];
 
 // GCN encoding space
 struct CLRX_INTERNAL GCNEncodingSpace
@@ -144,6 +147,8 @@ enum: cxuint {
     GCN_GFX10_ENCSPACE_IDX = 44
 };
 
+static void initializeGCNEncodingClasses();
+
 // create main instruction table
 static void initializeGCNDisassembler()
 {
@@ -230,6 +235,7 @@ static void initializeGCNDisassembler()
             }
         }
     }
+    initializeGCNEncodingClasses();
 }
 
 GCNDisassembler::GCNDisassembler(Disassembler& disassembler)
@@ -311,149 +317,89 @@ static const cxbyte gcnSize15Table[16] =
     GCNENCSCH_1DWORD // GCNENC_NONE   // 1111 - illegal
 };
 
-void GCNDisassembler::analyzeBeforeDisassemble()
+// scan all instructions, call jumpFunc for every jump target, return end of scan
+template<typename JumpFunc>
+static size_t scanGCNJumps(const GCNEncodingClassTable& encTable, GPUArchitecture arch,
+            const uint32_t* codeWords, size_t codeWordsNum, size_t startOffset,
+            JumpFunc jumpFunc)
 {
-    const uint32_t* codeWords = reinterpret_cast<const uint32_t*>(input);
-    const size_t codeWordsNum = (inputSize>>2);
-
-    const GPUArchitecture arch = getGPUArchitectureFromDeviceType(
-                disassembler.getDeviceType());
     const bool isGCN11 = (arch == GPUArchitecture::GCN1_1);
     const bool isGCN12 = (arch >= GPUArchitecture::GCN1_2);
-    const bool isGCN14 = (arch == GPUArchitecture::GCN1_4 || arch == GPUArchitecture::GCN1_4_1);
-    const bool isGCN15 = (arch >= GPUArchitecture::GCN1_5 || arch == GPUArchitecture::GCN1_5_1);
     size_t pos;
-    for (pos = 0; pos < codeWordsNum; pos++)
+    for (pos = 0; pos < codeWordsNum;)
     {
         /* scan all instructions and get jump addresses */
         const uint32_t insnCode = ULEV(codeWords[pos]);
-        if ((insnCode & 0x80000000U) != 0)
-        {
-            if ((insnCode & 0x40000000U) == 0)
-            {
-                // SOP???
-                if  ((insnCode & 0x30000000U) == 0x30000000U)
-                {
-                    // SOP1/SOPK/SOPC/SOPP
-                    const uint32_t encPart = (insnCode & 0x0f800000U);
-                    if (encPart == 0x0e800000U)
-                    {
-                        // SOP1
-                        if ((insnCode&0xff) == 0xff) // literal
-                            pos++;
-                    }
-                    else if (encPart == 0x0f000000U)
-                    {
-                        // SOPC
-                        if ((insnCode&0xff) == 0xff ||
-                            (insnCode&0xff00) == 0xff00) // literal
-                            pos++;
-                    }
-                    else if (encPart == 0x0f800000U)
-                    {
-                        // SOPP
-                        const cxuint opcode = (insnCode>>16)&0x7f;
-                        if (opcode == 2 || (opcode >= 4 && opcode <= 9) ||
-                            // GCN1.1 and GCN1.2 opcodes
-                            ((isGCN11 || isGCN12) &&
-                                    (opcode >= 23 && opcode <= 26))) // if jump
-                            labels.push_back(startOffset +
-                                    ((pos+int16_t(insnCode&0xffff)+1)<<2));
-                    }
-                    else
-                    {
-                        // SOPK
-                        const cxuint opcode = (insnCode>>23)&0x1f;
-                        if ((!isGCN12 && opcode == 17) ||
-                            (isGCN12 && opcode == 16) || // if branch fork
-                            (isGCN14 && opcode == 21) || // if s_call_b64
-                            (isGCN15 && (opcode == 22 ||
-                                opcode == 27 || opcode == 28))) // if s_subvector_loop_*
-                            labels.push_back(startOffset +
-                                    ((pos+int16_t(insnCode&0xffff)+1)<<2));
-                        else if (((!isGCN12 || isGCN15) && opcode == 21) ||
-                            (isGCN12 && !isGCN15 && opcode == 20))
-                            pos++; // additional literal
-                    }
-                }
-                else
-                {
-                    // SOP2
-                    if ((insnCode&0xff) == 0xff || (insnCode&0xff00) == 0xff00)
-                        pos++;  // literal
-                }
-            }
-            else
-            {
-                // SMRD and others
-                const uint32_t encPart = (insnCode&0x3c000000U)>>26;
-                if (isGCN15)
-                {
-                    if (gcnSize15Table[encPart]==GCNENCSCH_MIMG_DWORDS)
-                        pos += ((insnCode>>1)&3) + 1;
-                    else if (gcnSize15Table[encPart])
-                        pos++;
-                }
-                else if (isGCN11 && encPart==0 && (insnCode&0x1ff)==0xff)
-                    pos++;
-                else if ((!isGCN12 && gcnSize11Table[encPart] && (encPart != 7 || isGCN11)) ||
-                    (isGCN12 && gcnSize12Table[encPart]))
-                    pos++;
-                if (isGCN15 && (encPart==3 || encPart==5))
-                {
-                    // include VOP3 literal
-                    const uint32_t insnCode2 = ULEV(codeWords[pos]);
-                    if ((insnCode2 & 0x1ff) == 0xff || ((insnCode2>>9) & 0x1ff) == 0xff ||
-                        ((insnCode2>>18) & 0x1ff) == 0xff)
-                        pos++;
-                }
-            }
-        }
-        else
+        const GCNEncodingClass& encClass = encTable.classes[insnCode>>23];
+        if (encClass.encoding == GCNENC_SOPP)
         {
-            uint32_t src0 = (insnCode&0x1ff);
-            // some vector instructions
-            if ((insnCode & 0x7e000000U) == 0x7c000000U)
-            {
-                // VOPC
-                if (src0 == 0xff || // literal
-                    // SDWA, DPP
-                    (isGCN12 && (src0 == 0xf9 || src0 == 0xfa)) ||
-                    (isGCN15 && (src0 == 0xe9 || src0 == 0xea)))
-                    pos++;
-            }
-            else if ((insnCode & 0x7e000000U) == 0x7e000000U)
-            {
-                // VOP1
-                if (src0 == 0xff || // literal
-                    // SDWA, DPP
-                    (isGCN12 && (src0 == 0xf9 || src0 == 0xfa)) ||
-                    (isGCN15 && (src0 == 0xe9 || src0 == 0xea)))
-                    pos++;
-            }
-            else
-            {
-                // VOP2
-                const cxuint opcode = (insnCode >> 25)&0x3f;
-                if ((!isGCN12 && (opcode == 32 || opcode == 33)) ||
-                    (isGCN12 && !isGCN15 && (opcode == 23 || opcode == 24 ||
-                    opcode == 36 || opcode == 37)) ||
-                    (isGCN15 && (opcode == 32 || opcode == 33 || // V_MADMK and V_MADAK
-                        opcode == 44 || opcode == 45 || // V_FMAMK_F32, V_FMAAK_F32
-                        opcode == 55 || opcode == 56))) // V_FMAMK_F16, V_FMAAK_F16
-                    pos++;  // inline 32-bit constant
-                else if (src0 == 0xff || // literal
-                    // SDWA, DPP
-                    (isGCN12 && (src0 == 0xf9 || src0 == 0xfa)) ||
-                    (isGCN15 && (src0 == 0xe9 || src0 == 0xea)))
-                    pos++;  // literal
-            }
+            const cxuint opcode = (insnCode>>16)&0x7f;
+            if (opcode == 2 || (opcode >= 4 && opcode <= 9) ||
+                // GCN1.1 and GCN1.2 opcodes
+                ((isGCN11 || isGCN12) &&
+                        (opcode >= 23 && opcode <= 26))) // if jump
+                jumpFunc(startOffset + ((pos+int16_t(insnCode&0xffff)+1)<<2));
         }
+        else if ((encClass.flags & GCNLEN_SOPK_JUMP) != 0)
+            jumpFunc(startOffset + ((pos+int16_t(insnCode&0xffff)+1)<<2));
+        pos += getGCNInstructionWords(encTable, codeWords+pos, codeWordsNum-pos);
     }
-    
+    return pos;
+}
+
+void GCNDisassembler::analyzeBeforeDisassemble()
+{
+    const GPUArchitecture arch = getGPUArchitectureFromDeviceType(
+                disassembler.getDeviceType());
+    const size_t codeWordsNum = (inputSize>>2);
+    const size_t pos = scanGCNJumps(gcnEncodingClassTables[cxuint(arch)], arch,
+                reinterpret_cast<const uint32_t*>(input), codeWordsNum, startOffset,
+                [this](size_t target) { labels.insert(target); });
     instrOutOfCode = (pos != codeWordsNum);
 }
 
+void GCNDisassembler::getJumpTargets(std::vector<size_t>& targets) const
+{
+    const GPUArchitecture arch = getGPUArchitectureFromDeviceType(
+                disassembler.getDeviceType());
+    scanGCNJumps(gcnEncodingClassTables[cxuint(arch)], arch,
+                reinterpret_cast<const uint32_t*>(input), inputSize>>2, startOffset,
+                [&targets](size_t target) { targets.push_back(target); });
+}
+
+void GCNDisassembler::copyAnalysisState(const ISADisassembler& src)
+{
+    ISADisassembler::copyAnalysisState(src);
+    instrOutOfCode = static_cast<const GCNDisassembler&>(src).instrOutOfCode;
+}
+
+size_t GCNDisassembler::getInstructionSize(size_t codeSize, const cxbyte* code) const
+{
+    const uint32_t* codeWords = reinterpret_cast<const uint32_t*>(code);
+    const size_t codeWordsNum = (codeSize>>2);
+    if (codeWordsNum == 0)
+        return codeSize;
+    
+    const uint32_t insnCode = ULEV(codeWords[0]);
+    if (insnCode == 0)
+    {
+        // run of zero words is printed as single '.fill'
+        size_t count;
+        for (count = 1; count < codeWordsNum && codeWords[count]==0; count++);
+        return count<<2;
+    }
+    const GPUArchitecture arch = getGPUArchitectureFromDeviceType(
+                disassembler.getDeviceType());
+    const GCNEncodingClassTable& encTable = gcnEncodingClassTables[cxuint(arch)];
+    size_t words = std::min(size_t(getGCNInstructionWords(encTable, codeWords,
+                    codeWordsNum)), codeWordsNum);
+    if ((arch == GPUArchitecture::GCN1_5 || arch >= GPUArchitecture::GCN1_5_1) &&
+        encTable.classes[insnCode>>23].encoding == GCNENC_VOP3P &&
+        (insnCode & 0x3000000U)!=0 && words > 1)
+        words--; // unknown encoding, disassembler skips last word
+    return words<<2;
+}
+
 static const cxbyte gcnEncoding11Table[16] =
 {
     GCNENC_SMRD, // 0000
@@ -514,6 +460,147 @@ static const cxbyte gcnEncoding15Table[16] =
     GCNENC_NONE   // 1111 - illegal
 };
 
+// fill up encoding class tables for all GPU architectures
+static void initializeGCNEncodingClasses()
+{
+    for (cxuint ai = 0; ai <= cxuint(GPUArchitecture::GPUARCH_MAX); ai++)
+    {
+        const GPUArchitecture arch = GPUArchitecture(ai);
+        const bool isGCN11 = (arch == GPUArchitecture::GCN1_1);
+        const bool isGCN12 = (arch >= GPUArchitecture::GCN1_2);
+        const bool isGCN14 = (arch == GPUArchitecture::GCN1_4 ||
+                    arch == GPUArchitecture::GCN1_4_1);
+        const bool isGCN15 = (arch >= GPUArchitecture::GCN1_5);
+        GCNEncodingClassTable& encTable = gcnEncodingClassTables[ai];
+        
+        std::fill(encTable.vsrc0Extra, encTable.vsrc0Extra+16, 0U);
+        encTable.vsrc0Extra[0xff>>5] |= 1U<<(0xff&31); // literal
+        if (isGCN12)
+            // SDWA, DPP
+            encTable.vsrc0Extra[0xf9>>5] |= (1U<<(0xf9&31)) | (1U<<(0xfa&31));
+        if (isGCN15)
+            // SDWA, DPP (GCN 1.5)
+            encTable.vsrc0Extra[0xe9>>5] |= (1U<<(0xe9&31)) | (1U<<(0xea&31));
+        
+        for (cxuint i = 0; i < 512; i++)
+        {
+            // i - bits 23-31 of first dword
+            GCNEncodingClass& encClass = encTable.classes[i];
+            encClass.encoding = GCNENC_NONE;
+            encClass.words = 1;
+            encClass.flags = 0;
+            if ((i & 0x100) == 0)
+            {
+                // some vector instructions
+                const cxuint encPart = (i>>2)&0x3f;
+                if (encPart == 0x3e)
+                {
+                    encClass.encoding = GCNENC_VOPC;
+                    encClass.flags = GCNLEN_LIT_VSRC0;
+                }
+                else if (encPart == 0x3f)
+                {
+                    encClass.encoding = GCNENC_VOP1;
+                    encClass.flags = GCNLEN_LIT_VSRC0;
+                }
+                else
+                {
+                    // VOP2
+                    const cxuint opcode = encPart;
+                    encClass.encoding = GCNENC_VOP2;
+                    if ((!isGCN12 && (opcode == 32 || opcode == 33)) ||
+                        (isGCN12 && !isGCN15 && (opcode == 23 || opcode == 24 ||
+                        opcode == 36 || opcode == 37)) ||
+                        (isGCN15 && (opcode == 32 || opcode == 33 || // V_MADMK and V_MADAK
+                            opcode == 44 || opcode == 45 || // V_FMAMK_F32, V_FMAAK_F32
+                            opcode == 55 || opcode == 56))) // V_FMAMK_F16, V_FMAAK_F16
+                        encClass.words = 2; // inline 32-bit constant
+                    else
+                        encClass.flags = GCNLEN_LIT_VSRC0;
+                }
+            }
+            else if ((i & 0x80) == 0)
+            {
+                // SOP???
+                if ((i & 0x60) == 0x60)
+                {
+                    // SOP1/SOPK/SOPC/SOPP
+                    const cxuint encPart = i&0x1f;
+                    if (encPart == 0x1d)
+                    {
+                        encClass.encoding = GCNENC_SOP1;
+                        encClass.flags = GCNLEN_LIT_SSRC0;
+                    }
+                    else if (encPart == 0x1e)
+                    {
+                        encClass.encoding = GCNENC_SOPC;
+                        encClass.flags = GCNLEN_LIT_SSRC0|GCNLEN_LIT_SSRC1;
+                    }
+                    else if (encPart == 0x1f)
+                        encClass.encoding = GCNENC_SOPP;
+                    else
+                    {
+                        // SOPK
+                        const cxuint opcode = encPart;
+                        encClass.encoding = GCNENC_SOPK;
+                        if ((!isGCN12 && opcode == 17) ||
+                            (isGCN12 && opcode == 16) || // if branch fork
+                            (isGCN14 && opcode == 21) || // if s_call_b64
+                            (isGCN15 && (opcode == 22 ||
+                                opcode == 27 || opcode == 28))) // if s_subvector_loop_*
+                            encClass.flags = GCNLEN_SOPK_JUMP;
+                        else if (((!isGCN12 || isGCN15) && opcode == 21) ||
+                            (isGCN12 && !isGCN15 && opcode == 20))
+                            encClass.words = 2; // additional literal
+                    }
+                }
+                else
+                {
+                    encClass.encoding = GCNENC_SOP2;
+                    encClass.flags = GCNLEN_LIT_SSRC0|GCNLEN_LIT_SSRC1;
+                }
+            }
+            else
+            {
+                // SMRD and others
+                const cxuint encPart = (i>>3)&15;
+                if (isGCN15)
+                {
+                    if (gcnSize15Table[encPart]==GCNENCSCH_MIMG_DWORDS)
+                        encClass.flags = GCNLEN_MIMG_NSA;
+                    if (gcnSize15Table[encPart])
+                        encClass.words = 2;
+                    if (encPart==3 || encPart==5)
+                        encClass.flags = GCNLEN_LIT_VOP3; // include VOP3 literal
+                    encClass.encoding = gcnEncoding15Table[encPart];
+                }
+                else if (isGCN12)
+                {
+                    if (gcnSize12Table[encPart])
+                        encClass.words = 2;
+                    encClass.encoding = gcnEncoding12Table[encPart];
+                }
+                else
+                {
+                    if (isGCN11 && encPart==0)
+                        encClass.flags = GCNLEN_LIT_SMRD;
+                    else if (gcnSize11Table[encPart] && (encPart != 7 || isGCN11))
+                        encClass.words = 2;
+                    encClass.encoding = gcnEncoding11Table[encPart];
+                    if (encClass.encoding == GCNENC_FLAT && !isGCN11)
+                        encClass.encoding = GCNENC_NONE; // illegal if not GCN1.1
+                }
+            }
+        }
+    }
+}
+
+const GCNEncodingClassTable& CLRX::getGCNEncodingClassTable(GPUArchitecture arch)
+{
+    callOnce(clrxGCNDisasmOnceFlag, initializeGCNDisassembler);
+    return gcnEncodingClassTables[cxuint(arch)];
+}
+
 
 struct CLRX_INTERNAL GCNEncodingOpcodeBits
 {
@@ -596,33 +683,192 @@ static const GCNEncodingOpcodeBits gcnEncodingOpcode15Table[GCNENC_MAXVAL+2] =
     { 16, 7 } /* GCNENC_VOP3P, opcode = (7bit)<<16 */
 };
 
+// determine GCN encoding of instruction, read next words of instruction
+// and move position after instruction
+static cxbyte decodeGCNEncoding(const GCNEncodingClassTable& encTable,
+            const uint32_t* codeWords, size_t codeWordsNum, size_t& pos, uint32_t insnCode,
+            uint32_t& insnCode2, uint32_t& insnCode3, uint32_t& insnCode4,
+            uint32_t& insnCode5)
+{
+    // pos points to second dword of instruction
+    const cxuint words = getGCNInstructionWords(encTable, codeWords+pos-1,
+                codeWordsNum-pos+1);
+    const size_t endPos = std::min(pos-1+words, codeWordsNum);
+    if (pos < endPos)
+        insnCode2 = ULEV(codeWords[pos++]);
+    if (pos < endPos)
+    {
+        // VOP3 literal or MIMG NSA address dwords
+        insnCode3 = ULEV(codeWords[pos++]);
+        if (pos < endPos)
+            insnCode4 = ULEV(codeWords[pos++]);
+        if (pos < endPos)
+            insnCode5 = ULEV(codeWords[pos++]);
+    }
+    return encTable.classes[insnCode>>23].encoding;
+}
+
+// find instruction in instruction table by encoding and opcode,
+// return null if instruction is illegal
+static const GCNInstruction* findGCNInstruction(cxbyte gcnEncoding, uint32_t insnCode,
+            uint32_t insnCode2, GPUArchMask curArchMask, bool isGCN124, bool isGCN14,
+            bool isGCN15, cxuint& opcode, cxbyte& defaultEncoding)
+{
+    const GCNEncodingOpcodeBits* encodingOpcodeTable =
+            (isGCN15) ? gcnEncodingOpcode15Table :
+            ((isGCN124) ? gcnEncodingOpcode12Table : gcnEncodingOpcodeTable);
+    opcode =
+            (insnCode>>encodingOpcodeTable[gcnEncoding].bitPos) & 
+            ((1U<<encodingOpcodeTable[gcnEncoding].bits)-1U);
+    if (encodingOpcodeTable[gcnEncoding].bitPos2!=0)
+    {
+        // next bits in opcode
+        cxuint val = 0;
+        if (encodingOpcodeTable[gcnEncoding].bitPos2>=32)
+            val = (insnCode2>>(encodingOpcodeTable[gcnEncoding].bitPos2-32));
+        else
+            val = insnCode2>>(encodingOpcodeTable[gcnEncoding].bitPos2);
+        opcode |= (val&((1U<<encodingOpcodeTable[gcnEncoding].bits2)-1U)) <<
+                    encodingOpcodeTable[gcnEncoding].bits;
+    }
+    
+    /* find instruction in table */
+    const GCNEncodingSpace& encSpace =
+        (isGCN15) ? gcnInstrTableByCodeSpaces[GCN_GFX10_ENCSPACE_IDX + gcnEncoding] :
+        ((isGCN124) ? gcnInstrTableByCodeSpaces[GCNENC_MAXVAL+3 + gcnEncoding] :
+          gcnInstrTableByCodeSpaces[gcnEncoding]);
+    const GCNInstruction* gcnInsn = gcnInstrTableByCode.get() +
+            encSpace.offset + opcode;
+    defaultEncoding = gcnInsn->encoding;
+    
+    // try to replace by FMA_MIX for VEGA20
+    if ((curArchMask&ARCH_VEGA20) != 0 && gcnInsn->code>=928 && gcnInsn->code<=930)
+    {
+        const GCNEncodingSpace& encSpace4 =
+            gcnInstrTableByCodeSpaces[2*GCNENC_MAXVAL+4 + 1];
+        const GCNInstruction* thisGCNInstr =
+                gcnInstrTableByCode.get() + encSpace4.offset + opcode;
+        if (thisGCNInstr->mnemonic != nullptr)
+            // replace
+            gcnInsn = thisGCNInstr;
+    }
+    
+    bool isIllegal = false;
+    if (!isGCN124 && gcnInsn->mnemonic != nullptr &&
+        (curArchMask & gcnInsn->archMask) == 0 &&
+        gcnEncoding == GCNENC_VOP3A)
+    {    /* new overrides (VOP3A) */
+        const GCNEncodingSpace& encSpace2 =
+                gcnInstrTableByCodeSpaces[GCNENC_MAXVAL+1];
+        gcnInsn = gcnInstrTableByCode.get() + encSpace2.offset + opcode;
+        if (gcnInsn->mnemonic == nullptr ||
+                (curArchMask & gcnInsn->archMask) == 0)
+            isIllegal = true; // illegal
+    }
+    else if (isGCN14 && gcnInsn->mnemonic != nullptr &&
+        (curArchMask & gcnInsn->archMask) == 0 &&
+        (gcnEncoding == GCNENC_VOP3A || gcnEncoding == GCNENC_VOP2 ||
+            gcnEncoding == GCNENC_VOP1))
+    {
+        /* new overrides (VOP1/VOP3A/VOP2 for GCN 1.4) */
+        const GCNEncodingSpace& encSpace4 =
+                gcnInstrTableByCodeSpaces[2*GCNENC_MAXVAL+4 +
+                        (gcnEncoding != GCNENC_VOP2) +
+                        (gcnEncoding == GCNENC_VOP1)];
+        gcnInsn = gcnInstrTableByCode.get() + encSpace4.offset + opcode;
+        if (gcnInsn->mnemonic == nullptr ||
+                (curArchMask & gcnInsn->archMask) == 0)
+            isIllegal = true; // illegal
+    }
+    else if (isGCN14 && gcnEncoding == GCNENC_FLAT && ((insnCode>>14)&3)!=0)
+    {
+        // GLOBAL_/SCRATCH_* instructions
+        const GCNEncodingSpace& encSpace4 =
+            gcnInstrTableByCodeSpaces[2*(GCNENC_MAXVAL+1)+2+3 +
+                ((insnCode>>14)&3)-1];
+        gcnInsn = gcnInstrTableByCode.get() + encSpace4.offset + opcode;
+        if (gcnInsn->mnemonic == nullptr ||
+                (curArchMask & gcnInsn->archMask) == 0)
+            isIllegal = true; // illegal
+    }
+    else if (isGCN15 && gcnEncoding == GCNENC_FLAT && ((insnCode>>14)&3)!=0)
+    {
+        // GLOBAL_/SCRATCH_* instructions
+        const GCNEncodingSpace& encSpace4 =
+            gcnInstrTableByCodeSpaces[GCN_GFX10_ENCSPACE_IDX + GCNENC_VOP3P +
+                ((insnCode>>14)&3)];
+        gcnInsn = gcnInstrTableByCode.get() + encSpace4.offset + opcode;
+        if (gcnInsn->mnemonic == nullptr ||
+                (curArchMask & gcnInsn->archMask) == 0)
+            isIllegal = true; // illegal
+    }
+    else if (gcnInsn->mnemonic == nullptr ||
+        (curArchMask & gcnInsn->archMask) == 0)
+        isIllegal = true;
+    return (!isIllegal) ? gcnInsn : nullptr;
+}
+
+const GCNInstruction* CLRX::decodeGCNInstruction(GPUDeviceType deviceType,
+            size_t codeWordsNum, const uint32_t* codeWords, size_t& pos,
+            uint32_t& insnCode, uint32_t& insnCode2, uint32_t* extraCodes)
+{
+    callOnce(clrxGCNDisasmOnceFlag, initializeGCNDisassembler);
+    const GPUArchitecture arch = getGPUArchitectureFromDeviceType(deviceType);
+    const bool isGCN124 = (arch >= GPUArchitecture::GCN1_2);
+    const bool isGCN14 = (arch == GPUArchitecture::GCN1_4 || arch == GPUArchitecture::GCN1_4_1);
+    const bool isGCN15 = (arch == GPUArchitecture::GCN1_5 || arch >= GPUArchitecture::GCN1_5_1);
+    const GPUArchMask curArchMask = 1U<<int(arch);
+    
+    insnCode = ULEV(codeWords[pos++]);
+    insnCode2 = 0;
+    uint32_t insnCode3 = 0, insnCode4 = 0, insnCode5 = 0;
+    cxbyte gcnEncoding = decodeGCNEncoding(gcnEncodingClassTables[cxuint(arch)],
+                codeWords, codeWordsNum, pos, insnCode, insnCode2, insnCode3,
+                insnCode4, insnCode5);
+    if (extraCodes != nullptr)
+    {
+        extraCodes[0] = insnCode3;
+        extraCodes[1] = insnCode4;
+        extraCodes[2] = insnCode5;
+    }
+    if (isGCN15 && gcnEncoding == GCNENC_VOP3P && (insnCode & 0x3000000U)!=0)
+    {
+        // unknown encoding
+        gcnEncoding = GCNENC_NONE;
+        pos--;
+    }
+    if (gcnEncoding == GCNENC_NONE)
+        return nullptr;
+    cxuint opcode = 0;
+    cxbyte defaultEncoding = GCNENC_NONE;
+    return findGCNInstruction(gcnEncoding, insnCode, insnCode2, curArchMask,
+                isGCN124, isGCN14, isGCN15, opcode, defaultEncoding);
+}
+
 /* main routine */
 
-void GCNDisassembler::disassemble()
+void GCNDisassembler::disassembleCode()
 {
     // select current label and reloc to first
-    LabelIter curLabel = std::lower_bound(labels.begin(), labels.end(), labelStartOffset);
+    LabelIter curLabel = labels.lowerBound(labelStartOffset);
     RelocIter curReloc = std::lower_bound(relocations.begin(), relocations.end(),
         std::make_pair(startOffset, Relocation()),
           [](const std::pair<size_t,Relocation>& a, const std::pair<size_t, Relocation>& b)
           { return a.first < b.first; });
-    NamedLabelIter curNamedLabel = std::lower_bound(namedLabels.begin(), namedLabels.end(),
-        std::make_pair(labelStartOffset, CString()),
-          [](const std::pair<size_t,CString>& a, const std::pair<size_t, CString>& b)
-          { return a.first < b.first; });
+    NamedLabelIter curNamedLabel = findNamedLabel(labelStartOffset);
     
     const uint32_t* codeWords = reinterpret_cast<const uint32_t*>(input);
 
     const GPUArchitecture arch = getGPUArchitectureFromDeviceType(
                 disassembler.getDeviceType());
     // set up GCN indicators
-    const bool isGCN11 = (arch == GPUArchitecture::GCN1_1);
     const bool isGCN124 = (arch >= GPUArchitecture::GCN1_2);
     const bool isGCN14 = (arch == GPUArchitecture::GCN1_4 || arch == GPUArchitecture::GCN1_4_1);
     const bool isGCN15 = (arch == GPUArchitecture::GCN1_5 || arch >= GPUArchitecture::GCN1_5_1);
     const GPUArchMask curArchMask = 
             1U<<int(getGPUArchitectureFromDeviceType(disassembler.getDeviceType()));
     const size_t codeWordsNum = (inputSize>>2);
+    const GCNEncodingClassTable& encTable = gcnEncodingClassTables[cxuint(arch)];
     
     if ((inputSize&3) != 0)
         output.write(64,
@@ -665,170 +911,8 @@ void GCNDisassembler::disassemble()
         uint32_t insnCode5 = 0;
         
         /* determine GCN encoding */
-        if ((insnCode & 0x80000000U) != 0)
-        {
-            if ((insnCode & 0x40000000U) == 0)
-            {
-                // SOP???
-                if  ((insnCode & 0x30000000U) == 0x30000000U)
-                {
-                    // SOP1/SOPK/SOPC/SOPP
-                    const uint32_t encPart = (insnCode & 0x0f800000U);
-                    if (encPart == 0x0e800000U)
-                    {
-                        // SOP1
-                        if ((insnCode&0xff) == 0xff) // literal
-                        {
-                            if (pos < codeWordsNum)
-                                insnCode2 = ULEV(codeWords[pos++]);
-                        }
-                        gcnEncoding = GCNENC_SOP1;
-                    }
-                    else if (encPart == 0x0f000000U)
-                    {
-                        // SOPC
-                        if ((insnCode&0xff) == 0xff ||
-                            (insnCode&0xff00) == 0xff00) // literal
-                        {
-                            if (pos < codeWordsNum)
-                                insnCode2 = ULEV(codeWords[pos++]);
-                        }
-                        gcnEncoding = GCNENC_SOPC;
-                    }
-                    else if (encPart == 0x0f800000U) // SOPP
-                        gcnEncoding = GCNENC_SOPP;
-                    else // SOPK
-                    {
-                        gcnEncoding = GCNENC_SOPK;
-                        const uint32_t opcode = ((insnCode>>23)&0x1f);
-                        if (((!isGCN124 || isGCN15) && opcode == 21) ||
-                            (isGCN124 && !isGCN15 && opcode == 20))
-                        {
-                            if (pos < codeWordsNum)
-                                insnCode2 = ULEV(codeWords[pos++]);
-                        }
-                    }
-                }
-                else
-                {
-                    // SOP2
-                    if ((insnCode&0xff) == 0xff || (insnCode&0xff00) == 0xff00)
-                    {
-                        // literal
-                        if (pos < codeWordsNum)
-                            insnCode2 = ULEV(codeWords[pos++]);
-                    }
-                    gcnEncoding = GCNENC_SOP2;
-                }
-            }
-            else
-            {
-                // SMRD and others
-                const uint32_t encPart = (insnCode&0x3c000000U)>>26;
-                if (isGCN15)
-                {
-                    if (gcnSize15Table[encPart]==GCNENCSCH_MIMG_DWORDS)
-                    {
-                        cxuint extraDwords = ((insnCode>>1)&3) + 1;
-                        if (pos+extraDwords <= codeWordsNum)
-                        {
-                            if (extraDwords>=1)
-                                insnCode2 = ULEV(codeWords[pos]);
-                            if (extraDwords>=2)
-                                insnCode3 = ULEV(codeWords[pos+1]);
-                            if (extraDwords>=3)
-                                insnCode4 = ULEV(codeWords[pos+2]);
-                            if (extraDwords>=4)
-                                insnCode5 = ULEV(codeWords[pos+3]);
-                            pos += extraDwords;
-                        }
-                    }
-                    if (gcnSize15Table[encPart] && pos < codeWordsNum)
-                        insnCode2 = ULEV(codeWords[pos++]);
-                    if (isGCN15 && (encPart==3 || encPart==5))
-                    {
-                        // include VOP3 literal
-                        if ((insnCode2 & 0x1ff) == 0xff || ((insnCode2>>9) & 0x1ff) == 0xff ||
-                            ((insnCode2>>18) & 0x1ff) == 0xff)
-                            insnCode3 = ULEV(codeWords[pos++]);
-                    }
-                }
-                else if (isGCN11 && encPart==0 && (insnCode&0x1ff)==0xff)
-                {
-                    if (pos < codeWordsNum)
-                        insnCode2 = ULEV(codeWords[pos++]);
-                }
-                else if ((!isGCN124 && gcnSize11Table[encPart] && (encPart != 7 || isGCN11)) ||
-                    (isGCN124 && gcnSize12Table[encPart]))
-                {
-                    if (pos < codeWordsNum)
-                        insnCode2 = ULEV(codeWords[pos++]);
-                }
-                if (isGCN15)
-                    gcnEncoding = gcnEncoding15Table[encPart];
-                else if (isGCN124)
-                    gcnEncoding = gcnEncoding12Table[encPart];
-                else
-                    gcnEncoding = gcnEncoding11Table[encPart];
-                if (gcnEncoding == GCNENC_FLAT && !isGCN11 && !isGCN124)
-                    gcnEncoding = GCNENC_NONE; // illegal if not GCN1.1
-            }
-        }
-        else
-        {
-            // some vector instructions
-            const uint32_t src0 = (insnCode&0x1ff);
-            if ((insnCode & 0x7e000000U) == 0x7c000000U)
-            {
-                // VOPC
-                if (src0 == 0xff || // literal
-                    // SDWA, DPP
-                    (isGCN124 && (src0 == 0xf9 || src0 == 0xfa)) ||
-                    (isGCN15 && (src0 == 0xe9 || src0 == 0xea)))
-                {
-                    if (pos < codeWordsNum)
-                        insnCode2 = ULEV(codeWords[pos++]);
-                }
-                gcnEncoding = GCNENC_VOPC;
-            }
-            else if ((insnCode & 0x7e000000U) == 0x7e000000U)
-            {
-                // VOP1
-                if (src0 == 0xff || // literal
-                    // SDWA, DPP
-                    (isGCN124 && (src0 == 0xf9 || src0 == 0xfa)) ||
-                    (isGCN15 && (src0 == 0xe9 || src0 == 0xea)))
-                {
-                    if (pos < codeWordsNum)
-                        insnCode2 = ULEV(codeWords[pos++]);
-                }
-                gcnEncoding = GCNENC_VOP1;
-            }
-            else
-            {
-                // VOP2
-                const cxuint opcode = (insnCode >> 25)&0x3f;
-                if ((!isGCN124 && (opcode == 32 || opcode == 33)) ||
-                    (isGCN124 && !isGCN15 && (opcode == 23 || opcode == 24 ||
-                    opcode == 36 || opcode == 37)) ||
-                    (isGCN15 && (opcode == 32 || opcode == 33 || // V_MADMK and V_MADAK
-                        opcode == 44 || opcode == 45 || // V_FMAMK_F32, V_FMAAK_F32
-                        opcode == 55 || opcode == 56))) // V_MADMK and V_MADAK
-                {
-                    if (pos < codeWordsNum)
-                        insnCode2 = ULEV(codeWords[pos++]);
-                }
-                else if (src0 == 0xff || // literal
-                    // SDWA, DDP
-                    (isGCN124 && (src0 == 0xf9 || src0 == 0xfa)) ||
-                    (isGCN15 && (src0 == 0xe9 || src0 == 0xea)))
-                {
-                    if (pos < codeWordsNum)
-                        insnCode2 = ULEV(codeWords[pos++]);
-                }
-                gcnEncoding = GCNENC_VOP2;
-            }
-        }
+        gcnEncoding = decodeGCNEncoding(encTable, codeWords, codeWordsNum, pos,
+                    insnCode, insnCode2, insnCode3, insnCode4, insnCode5);
         
         prevIsTwoWord = (oldPos+2 == pos);
         
@@ -904,100 +988,18 @@ void GCNDisassembler::disassemble()
         }
         else
         {
-            const GCNEncodingOpcodeBits* encodingOpcodeTable =
-                    (isGCN15) ? gcnEncodingOpcode15Table :
-                    ((isGCN124) ? gcnEncodingOpcode12Table : gcnEncodingOpcodeTable);
-            cxuint opcode =
-                    (insnCode>>encodingOpcodeTable[gcnEncoding].bitPos) & 
-                    ((1U<<encodingOpcodeTable[gcnEncoding].bits)-1U);
-            if (encodingOpcodeTable[gcnEncoding].bitPos2!=0)
-            {
-                // next bits in opcode
-                cxuint val = 0;
-                if (encodingOpcodeTable[gcnEncoding].bitPos2>=32)
-                    val = (insnCode2>>(encodingOpcodeTable[gcnEncoding].bitPos2-32));
-                else
-                    val = insnCode2>>(encodingOpcodeTable[gcnEncoding].bitPos2);
-                opcode |= (val&((1U<<encodingOpcodeTable[gcnEncoding].bits2)-1U)) <<
-                            encodingOpcodeTable[gcnEncoding].bits;
-            }
-            
+            cxuint opcode = 0;
+            cxbyte defaultEncoding = GCNENC_NONE;
             /* decode instruction and put to output */
-            const GCNEncodingSpace& encSpace =
-                (isGCN15) ? gcnInstrTableByCodeSpaces[GCN_GFX10_ENCSPACE_IDX + gcnEncoding] :
-                ((isGCN124) ? gcnInstrTableByCodeSpaces[GCNENC_MAXVAL+3 + gcnEncoding] :
-                  gcnInstrTableByCodeSpaces[gcnEncoding]);
-            const GCNInstruction* gcnInsn = gcnInstrTableByCode.get() +
-                    encSpace.offset + opcode;
+            const GCNInstruction* gcnInsn = findGCNInstruction(gcnEncoding, insnCode,
+                        insnCode2, curArchMask, isGCN124, isGCN14, isGCN15,
+                        opcode, defaultEncoding);
             
-            const GCNInstruction defaultInsn = { nullptr, gcnInsn->encoding, GCN_STDMODE,
+            const GCNInstruction defaultInsn = { nullptr, defaultEncoding, GCN_STDMODE,
                         0, 0 };
             
-            // try to replace by FMA_MIX for VEGA20
-            if ((curArchMask&ARCH_VEGA20) != 0 && gcnInsn->code>=928 && gcnInsn->code<=930)
-            {
-                const GCNEncodingSpace& encSpace4 =
-                    gcnInstrTableByCodeSpaces[2*GCNENC_MAXVAL+4 + 1];
-                const GCNInstruction* thisGCNInstr =
-                        gcnInstrTableByCode.get() + encSpace4.offset + opcode;
-                if (thisGCNInstr->mnemonic != nullptr)
-                    // replace
-                    gcnInsn = thisGCNInstr;
-            }
-            
             cxuint spacesToAdd = 16;
-            bool isIllegal = false;
-            if (!isGCN124 && gcnInsn->mnemonic != nullptr &&
-                (curArchMask & gcnInsn->archMask) == 0 &&
-                gcnEncoding == GCNENC_VOP3A)
-            {    /* new overrides (VOP3A) */
-                const GCNEncodingSpace& encSpace2 =
-                        gcnInstrTableByCodeSpaces[GCNENC_MAXVAL+1];
-                gcnInsn = gcnInstrTableByCode.get() + encSpace2.offset + opcode;
-                if (gcnInsn->mnemonic == nullptr ||
-                        (curArchMask & gcnInsn->archMask) == 0)
-                    isIllegal = true; // illegal
-            }
-            else if (isGCN14 && gcnInsn->mnemonic != nullptr &&
-                (curArchMask & gcnInsn->archMask) == 0 &&
-                (gcnEncoding == GCNENC_VOP3A || gcnEncoding == GCNENC_VOP2 ||
-                    gcnEncoding == GCNENC_VOP1))
-            {
-                /* new overrides (VOP1/VOP3A/VOP2 for GCN 1.4) */
-                const GCNEncodingSpace& encSpace4 =
-                        gcnInstrTableByCodeSpaces[2*GCNENC_MAXVAL+4 +
-                                (gcnEncoding != GCNENC_VOP2) +
-                                (gcnEncoding == GCNENC_VOP1)];
-                gcnInsn = gcnInstrTableByCode.get() + encSpace4.offset + opcode;
-                if (gcnInsn->mnemonic == nullptr ||
-                        (curArchMask & gcnInsn->archMask) == 0)
-                    isIllegal = true; // illegal
-            }
-            else if (isGCN14 && gcnEncoding == GCNENC_FLAT && ((insnCode>>14)&3)!=0)
-            {
-                // GLOBAL_/SCRATCH_* instructions
-                const GCNEncodingSpace& encSpace4 =
-                    gcnInstrTableByCodeSpaces[2*(GCNENC_MAXVAL+1)+2+3 +
-                        ((insnCode>>14)&3)-1];
-                gcnInsn = gcnInstrTableByCode.get() + encSpace4.offset + opcode;
-                if (gcnInsn->mnemonic == nullptr ||
-                        (curArchMask & gcnInsn->archMask) == 0)
-                    isIllegal = true; // illegal
-            }
-            else if (isGCN15 && gcnEncoding == GCNENC_FLAT && ((insnCode>>14)&3)!=0)
-            {
-                // GLOBAL_/SCRATCH_* instructions
-                const GCNEncodingSpace& encSpace4 =
-                    gcnInstrTableByCodeSpaces[GCN_GFX10_ENCSPACE_IDX + GCNENC_VOP3P +
-                        ((insnCode>>14)&3)];
-                gcnInsn = gcnInstrTableByCode.get() + encSpace4.offset + opcode;
-                if (gcnInsn->mnemonic == nullptr ||
-                        (curArchMask & gcnInsn->archMask) == 0)
-                    isIllegal = true; // illegal
-            }
-            else if (gcnInsn->mnemonic == nullptr ||
-                (curArchMask & gcnInsn->archMask) == 0)
-                isIllegal = true;
+            const bool isIllegal = (gcnInsn == nullptr);
             
             if (!isIllegal)
             {
@@ -1132,6 +1134,52 @@ void GCNDisassembler::disassemble()
     }
     if (!dontPrintLabelsAfterCode)
         writeLabelsToEnd(codeWordsNum<<2, curLabel, curNamedLabel);
+}
+
+void GCNDisassembler::makeCodeCacheKey(std::string& key) const
+{
+    key.push_back(instrOutOfCode);
+    ISADisassembler::makeCodeCacheKey(key);
+}
+
+void GCNDisassembler::disassemble()
+{
+    DisasmCodeCache* codeCache = disassembler.getCodeCache();
+    if (codeCache == nullptr || isTextCaptured())
+        // no cache or whole text (with this code) will be single item in cache
+        disassembleCode();
+    else
+    {
+        std::string key;
+        makeCodeCacheKey(key);
+        DisasmCachedText text;
+        if (codeCache->find(key, text))
+            writeCachedText(text);
+        else
+        {
+            // capture text of disassembled code
+            beginTextCapture();
+            try
+            { disassembleCode(); }
+            catch(...)
+            {
+                // write already disassembled text
+                endTextCapture(text);
+                writeCachedText(text);
+                throw;
+            }
+            endTextCapture(text);
+            writeCachedText(text);
+            codeCache->insert(std::move(key), std::move(text));
+        }
+    }
     output.flush();
+    if ((disassembler.getFlags() & DISASM_ESTIMATE) != 0)
+    {
+        // print estimated cycles as comments
+        AsmCycleEstimator estimator(disassembler.getDeviceType());
+        estimator.estimate(inputSize, input);
+        estimator.printReport(disassembler.getOutput(), "        # ", startOffset);
+    }
     disassembler.getOutput().flush();
 }
@@ -882,28 +882,19 @@ void GCNDisasmUtils::decodeSMEMEncoding(GCNDisassembler& dasm, cxuint spacesToAd
         decodeGCNOperandNoLit(dasm, (insnCode<<1)&0x7e, (gcnInsn.mode&GCN_SBASE4)?4:2,
                           bufPtr, arch);
         putCommaSpace(bufPtr);
-        if ((!isGCN15 && (insnCode&0x20000)) ||
-            (isGCN15 && (insnCode2>>25)==0x7d)) // immediate value
+        const cxuint soffset = getSMEMSOffsetReg(arch, insnCode, insnCode2);
+        if (soffset != noReg)
         {
-            if (!isGCN15 && isGCN14 && (insnCode & 0x4000) != 0)
-            {
-                // last 8-bit in second dword
-                decodeGCNOperandNoLit(dasm, (insnCode2>>25), 1, bufPtr , arch);
-                printOffset = true;
-            }
-            else
-            {
-                // print SOFFSET
-                uint32_t immMask =  isGCN14 ? 0x1fffff : 0xfffff;
-                bufPtr += itocstrCStyle(insnCode2 & immMask, bufPtr, 11, 16);
-            }
+            // print SOFFSET register
+            decodeGCNOperandNoLit(dasm, soffset, 1, bufPtr, arch);
+            // GCN 1.4: immediate offset with SOFFSET (last 7 bits in second dword)
+            printOffset = !isGCN15 && (insnCode&0x20000) != 0;
         }
-        else // SOFFSET register
+        else
         {
-            if (isGCN15 || (isGCN14 && (insnCode & 0x4000) != 0))
-                decodeGCNOperandNoLit(dasm, insnCode2>>25, 1, bufPtr, arch);
-            else
-                decodeGCNOperandNoLit(dasm, insnCode2&0xff, 1, bufPtr, arch);
+            // print immediate offset
+            uint32_t immMask =  isGCN14 ? 0x1fffff : 0xfffff;
+            bufPtr += itocstrCStyle(insnCode2 & immMask, bufPtr, 11, 16);
         }
         useOthers = true;
         spacesAdded = true;
@@ -983,19 +974,6 @@ void GCNDisasmUtils::decodeSMEMEncoding(GCNDisassembler& dasm, cxuint spacesToAd
     output.forward(bufPtr-bufStart);
 }
 
-// temporary structure to store operand modifiers and operand SRC0
-struct CLRX_INTERNAL VOPExtraWordOut
-{
-    uint16_t src0;
-    bool sextSrc0;
-    bool negSrc0;
-    bool absSrc0;
-    bool sextSrc1;
-    bool negSrc1;
-    bool absSrc1;
-    bool scalarSrc1;
-};
-
 // SDWA SEL field value names
 static const char* sdwaSelChoicesTbl[] =
 {
@@ -1133,6 +1111,28 @@ static inline VOPExtraWordOut decodeVOPDPPFlags(uint32_t insnCode2)
         false, (insnCode2&(1U<<22))!=0, (insnCode2&(1U<<23))!=0, false };
 }
 
+VOPExtraWordOut GCNDisasmUtils::decodeVOPExtraWord(GPUArchMask arch, cxuint src0Field,
+            uint32_t extraWord)
+{
+    // extra flags are zeroed by default
+    VOPExtraWordOut extraFlags = { 0, 0, 0, 0, 0, 0, 0 };
+    if ((arch&ARCH_GCN_1_2_4_5)!=0)
+    {
+        // return extra flags from SDWA/DPP encoding
+        if (src0Field == 0xf9)
+            extraFlags = decodeVOPSDWAFlags(extraWord, arch);
+        else if (src0Field == 0xfa)
+            extraFlags = decodeVOPDPPFlags(extraWord);
+        else if ((arch&ARCH_GCN_1_5)!=0 && (src0Field == 0xe9 || src0Field == 0xea))
+            extraFlags.src0 = uint16_t((extraWord&0xff)+256);
+        else
+            extraFlags.src0 = src0Field;
+    }
+    else
+        extraFlags.src0 = src0Field;
+    return extraFlags;
+}
+
 static void decodeVOPDPP(FastOutputBuffer& output, GPUArchMask arch, uint32_t insnCode2,
         bool src0Used, bool src1Used)
 {
@@ -1245,14 +1245,12 @@ void GCNDisasmUtils::decodeVOPCEncoding(GCNDisassembler& dasm, size_t codePos,
     addSpaces(bufPtr, spacesToAdd);
     
     const cxuint src0Field = (insnCode&0x1ff);
-    // extra flags are zeroed by default
-    VOPExtraWordOut extraFlags = { 0, 0, 0, 0, 0, 0, 0 };
-    if ((arch & ARCH_GCN_1_4_5) != 0 && src0Field==0xf9 && (literal & 0x8000) != 0)
+    const cxuint sdwabSDst = getVOPCSDWABSDst(arch, src0Field, literal);
+    if (sdwabSDst != noReg)
     {
         // SDWAB replacement of SDST
         output.forward(bufPtr-bufStart);
-        bufPtr = bufStart = decodeGCNOperand(dasm, codePos, relocIter,
-                            (literal>>8)&0x7f, 2, arch);
+        bufPtr = bufStart = decodeGCNOperand(dasm, codePos, relocIter, sdwabSDst, 2, arch);
         putCommaSpace(bufPtr);
     }
     else if ((gcnInsn.mode & GCN_VOPC_NOVCC) == 0) // just vcc
@@ -1263,20 +1261,8 @@ void GCNDisasmUtils::decodeVOPCEncoding(GCNDisassembler& dasm, size_t codePos,
             putChars(bufPtr, "vcc_lo, ", 8);
     }
     
-    if (isGCN12)
-    {
-        // return VOP SDWA/DPP flags for operands
-        if (src0Field == 0xf9)
-            extraFlags = decodeVOPSDWAFlags(literal, arch);
-        else if (src0Field == 0xfa)
-            extraFlags = decodeVOPDPPFlags(literal);
-        else if (isGCN15 && (src0Field == 0xe9 || src0Field == 0xea))
-            extraFlags.src0 = uint16_t((literal&0xff)+256);
-        else
-            extraFlags.src0 = src0Field;
-    }
-    else
-        extraFlags.src0 = src0Field;
+    // return VOP SDWA/DPP flags for operands
+    const VOPExtraWordOut extraFlags = decodeVOPExtraWord(arch, src0Field, literal);
     
     // apply sext(), negation and abs() if applied
     if (extraFlags.sextSrc0)
@@ -1345,23 +1331,8 @@ void GCNDisasmUtils::decodeVOP1Encoding(GCNDisassembler& dasm, size_t codePos,
     char* bufPtr = bufStart;
     
     const cxuint src0Field = (insnCode&0x1ff);
-    // extra flags are zeroed by default
-    VOPExtraWordOut extraFlags = { 0, 0, 0, 0, 0, 0, 0 };
-    
-    if (isGCN12)
-    {
-        // return extra flags from SDWA/DPP encoding
-        if (src0Field == 0xf9)
-            extraFlags = decodeVOPSDWAFlags(literal, arch);
-        else if (src0Field == 0xfa)
-            extraFlags = decodeVOPDPPFlags(literal);
-        else if (isGCN15 && (src0Field == 0xe9 || src0Field == 0xea))
-            extraFlags.src0 = uint16_t((literal&0xff)+256);
-        else
-            extraFlags.src0 = src0Field;
-    }
-    else
-        extraFlags.src0 = src0Field;
+    // return extra flags from SDWA/DPP encoding
+    const VOPExtraWordOut extraFlags = decodeVOPExtraWord(arch, src0Field, literal);
     
     bool argsUsed = true;
     if ((gcnInsn.mode & GCN_MASK1) != GCN_VOP_ARG_NONE)
@@ -1445,23 +1416,8 @@ void GCNDisasmUtils::decodeVOP2Encoding(GCNDisassembler& dasm, size_t codePos,
     const GCNInsnMode mode1 = (gcnInsn.mode & GCN_MASK1);
     
     const cxuint src0Field = (insnCode&0x1ff);
-    // extra flags are zeroed by default
-    VOPExtraWordOut extraFlags = { 0, 0, 0, 0, 0, 0, 0 };
-    
-    if (isGCN12)
-    {
-        // return extra flags from SDWA/DPP encoding
-        if (src0Field == 0xf9)
-            extraFlags = decodeVOPSDWAFlags(literal, arch);
-        else if (src0Field == 0xfa)
-            extraFlags = decodeVOPDPPFlags(literal);
-        else if (isGCN15 && (src0Field == 0xe9 || src0Field == 0xea))
-            extraFlags.src0 = uint16_t((literal&0xff)+256);
-        else
-            extraFlags.src0 = src0Field;
-    }
-    else
-        extraFlags.src0 = src0Field;
+    // return extra flags from SDWA/DPP encoding
+    const VOPExtraWordOut extraFlags = decodeVOPExtraWord(arch, src0Field, literal);
     
     if (mode1 != GCN_DS1_SGPR)
         // print DST as SGPR
@@ -1590,8 +1546,6 @@ void GCNDisasmUtils::decodeVOP3Encoding(GCNDisassembler& dasm, size_t codePos,
     const bool isGCN12 = ((arch&ARCH_GCN_1_2_4_5)!=0);
     const bool isGCN14 = ((arch&ARCH_GCN_1_4_5)!=0);
     const bool isGCN15 = ((arch&ARCH_GCN_1_5)!=0);
-    const cxuint opcode = (isGCN12) ? ((insnCode>>16)&0x3ff) : ((insnCode>>17)&0x1ff);
-    
     const cxuint vdst = insnCode&0xff;
     const cxuint vsrc0 = insnCode2&0x1ff;
     const cxuint vsrc1 = (insnCode2>>9)&0x1ff;
@@ -1614,8 +1568,7 @@ void GCNDisasmUtils::decodeVOP3Encoding(GCNDisassembler& dasm, size_t codePos,
     if (vop3Mode != GCN_VOP3_VOP3P)
         negFlags = (insnCode2>>29)&7;
     
-    const bool is128Ops = (gcnInsn.mode&0x7000)==GCN_VOP3_DS2_128;
-    const bool vop3VOPC = (vop3Mode != GCN_VOP3_VOP3P && opcode < 256);
+    const bool vop3VOPC = isVOP3VOPC(arch, gcnInsn.mode, insnCode);
     
     const cxuint wvSize = (!isGCN15 || (flags&DISASM_WAVE32)==0 ||
                     (gcnInsn.mode&GCN_VOP_NOWVSZ)!=0) ? 2 : 1;
@@ -1632,18 +1585,15 @@ void GCNDisasmUtils::decodeVOP3Encoding(GCNDisassembler& dasm, size_t codePos,
                 decodeGCNOperandNoLit(dasm, vdst, ((gcnInsn.mode&GCN_VOP3_DST_SGPR)==0) ?
                                         wvSize:1, bufPtr, arch);
             else /* regular instruction */
-                // for V_MQSAD_U32 SRC2 is 128-bit
-                decodeGCNVRegOperand(vdst, (is128Ops) ? 4 :
-                                    ((gcnInsn.mode&GCN_REG_DST_64)?2:1), bufPtr);
+                decodeGCNVRegOperand(vdst, getVOP3RegsNum(gcnInsn.mode, GCN_REG_DST_64),
+                                    bufPtr);
         }
         else
             vdstUsed = false;
         
         if (vdstUsed)
             putCommaSpace(bufPtr);
-        if (gcnInsn.encoding == GCNENC_VOP3B &&
-            (mode1 == GCN_DS2_VCC || mode1 == GCN_DST_VCC || mode1 == GCN_DST_VCC_VSRC2 ||
-             mode1 == GCN_S0EQS12)) /* VOP3b */
+        if (gcnInsn.encoding == GCNENC_VOP3B && isVOP3BSDstUsed(mode1)) /* VOP3b */
         {
             // print SDST operand (VOP3B)
             decodeGCNOperandNoLit(dasm, ((insnCode>>8)&0x7f), wvSize, bufPtr, arch);
@@ -1767,17 +1717,16 @@ void GCNDisasmUtils::decodeVOP3Encoding(GCNDisassembler& dasm, size_t codePos,
                         *bufPtr++ = '-';
                     if (absFlags & 4)
                         putChars(bufPtr, "abs(", 4);
-                    // for V_MQSAD_U32 SRC2 is 128-bit
                     // print VSRC2
                     if (!isGCN15)
-                        decodeGCNOperandNoLit(dasm, vsrc2, is128Ops ? 4 :
-                                    (gcnInsn.mode&GCN_REG_SRC2_64)?2:1,
+                        decodeGCNOperandNoLit(dasm, vsrc2,
+                                    getVOP3RegsNum(gcnInsn.mode, GCN_REG_SRC2_64),
                                     bufPtr, arch, displayFloatLits);
                     else
                     {
                         output.forward(bufPtr-bufStart);
                         bufStart = bufPtr = decodeGCNOperand(dasm, codePos, relocIter,
-                                vsrc2, is128Ops ? 4 : (gcnInsn.mode&GCN_REG_SRC2_64)?2:1,
+                                vsrc2, getVOP3RegsNum(gcnInsn.mode, GCN_REG_SRC2_64),
                                 arch, literal, displayFloatLits);
                     }
                     if (absFlags & 4)
@@ -2059,20 +2008,14 @@ void GCNDisasmUtils::decodeDSEncoding(GCNDisassembler& dasm, cxuint spacesToAdd,
     const cxuint vdata1 = (insnCode2>>16)&0xff;
     const cxuint vdst = insnCode2>>24;
     
-    if (((gcnInsn.mode & GCN_ADDR_SRC) != 0 || (gcnInsn.mode & GCN_ONLYDST) != 0) &&
-            (gcnInsn.mode & GCN_ONLY_SRC) == 0)
+    if (isDSVDstUsed(gcnInsn.mode))
     {
         /* vdst is dst */
-        cxuint regsNum = (gcnInsn.mode&GCN_REG_DST_64)?2:1;
-        if ((gcnInsn.mode&GCN_DS_96) != 0)
-            regsNum = 3;
-        if ((gcnInsn.mode&GCN_DS_128) != 0 || (gcnInsn.mode&GCN_DST128) != 0)
-            regsNum = 4;
         // print VDST
-        decodeGCNVRegOperand(vdst, regsNum, bufPtr);
+        decodeGCNVRegOperand(vdst, getDSRegsNum(gcnInsn.mode, true), bufPtr);
         vdstUsed = true;
     }
-    if ((gcnInsn.mode & GCN_ONLYDST) == 0 && (gcnInsn.mode & GCN_ONLY_SRC) == 0)
+    if (isDSVAddrUsed(gcnInsn.mode))
     {
         /// print VADDR
         if (vdstUsed)
@@ -2083,21 +2026,14 @@ void GCNDisasmUtils::decodeDSEncoding(GCNDisassembler& dasm, cxuint spacesToAdd,
     
     const uint16_t srcMode = (gcnInsn.mode & GCN_SRCS_MASK);
     
-    if ((gcnInsn.mode & GCN_ONLYDST) == 0 &&
-        (gcnInsn.mode & (GCN_ADDR_DST|GCN_ADDR_SRC)) != 0 && srcMode != GCN_NOSRC)
+    if (isDSVDataUsed(gcnInsn.mode))
     {
         /* print two vdata */
         if (vaddrUsed || vdstUsed)
             // comma after previous argument (VDST, VADDR)
             putCommaSpace(bufPtr);
-        // determine number of register for VDATA0
-        cxuint regsNum = (gcnInsn.mode&GCN_REG_SRC0_64)?2:1;
-        if ((gcnInsn.mode&GCN_DS_96) != 0)
-            regsNum = 3;
-        if ((gcnInsn.mode&GCN_DS_128) != 0)
-            regsNum = 4;
         // print VDATA0
-        decodeGCNVRegOperand(vdata0, regsNum, bufPtr);
+        decodeGCNVRegOperand(vdata0, getDSRegsNum(gcnInsn.mode, false), bufPtr);
         vdata0Used = true;
         if (srcMode == GCN_2SRCS)
         {
@@ -2183,7 +2119,6 @@ void GCNDisasmUtils::decodeMUBUFEncoding(GCNDisassembler& dasm, cxuint spacesToA
     char* bufStart = output.reserve(170);
     char* bufPtr = bufStart;
     const bool isGCN12 = ((arch&ARCH_GCN_1_2_4_5)!=0);
-    const bool isGCN14 = ((arch&ARCH_GCN_1_4_5)!=0);
     const bool isGCN15 = ((arch&ARCH_GCN_1_5)!=0);
     const cxuint vaddr = insnCode2&0xff;
     const cxuint vdata = (insnCode2>>8)&0xff;
@@ -2195,23 +2130,12 @@ void GCNDisasmUtils::decodeMUBUFEncoding(GCNDisassembler& dasm, cxuint spacesToA
         addSpaces(bufPtr, spacesToAdd);
         if (mode1 != GCN_MUBUF_NOVAD)
         {
-            // determine number of regs in VDATA
-            cxuint dregsNum = ((gcnInsn.mode&GCN_DSIZE_MASK)>>GCN_SHIFT2)+1;
-            if ((gcnInsn.mode & GCN_MUBUF_D16)!=0 && isGCN14)
-                // 16-bit values packed into half of number of registers
-                dregsNum = (dregsNum+1)>>1;
-            if (insnCode2 & 0x800000U)
-                dregsNum++; // tfe
             // print VDATA
-            decodeGCNVRegOperand(vdata, dregsNum, bufPtr);
+            decodeGCNVRegOperand(vdata, getMUBUFVDataRegsNum(arch, gcnInsn.mode, insnCode2),
+                        bufPtr);
             putCommaSpace(bufPtr);
-            // determine number of vaddr registers
-            /* for addr32 - idxen+offen or 1, for addr64 - 2 (idxen and offen is illegal) */
-            const cxuint aregsNum = ((insnCode & 0x3000U)==0x3000U ||
-                    /* addr64 only for older GCN than 1.2 */
-                    (!isGCN12 && (insnCode & 0x8000U)))? 2 : 1;
             // print VADDR
-            decodeGCNVRegOperand(vaddr, aregsNum, bufPtr);
+            decodeGCNVRegOperand(vaddr, getMUBUFVAddrRegsNum(arch, insnCode), bufPtr);
             putCommaSpace(bufPtr);
         }
         // print SRSRC
@@ -2336,28 +2260,16 @@ void GCNDisasmUtils::decodeMIMGEncoding(GCNDisassembler& dasm, cxuint spacesToAd
     addSpaces(bufPtr, spacesToAdd);
     
     const cxuint dmask = (insnCode>>8)&15;
-    cxuint dregsNum = 4;
-    // determine register number for VDATA
-    if ((gcnInsn.mode & GCN_MIMG_VDATA4) == 0)
-        dregsNum = ((dmask & 1)?1:0) + ((dmask & 2)?1:0) + ((dmask & 4)?1:0) +
-                ((dmask & 8)?1:0);
-    
-    dregsNum = (dregsNum == 0) ? 1 : dregsNum;
-    if (isGCN14 && (insnCode2 & (1U<<31))!=0)
-        dregsNum = (dregsNum+1)>>1;
-    if (insnCode & 0x10000)
-        dregsNum++; // tfe
-    
     // print VDATA
-    decodeGCNVRegOperand((insnCode2>>8)&0xff, dregsNum, bufPtr);
+    decodeGCNVRegOperand((insnCode2>>8)&0xff,
+                getMIMGVDataRegsNum(arch, gcnInsn.mode, insnCode, insnCode2), bufPtr);
     putCommaSpace(bufPtr);
     // print VADDR
-    decodeGCNVRegOperand(insnCode2&0xff,
-                 std::max(GCNInsnMode(4), (gcnInsn.mode&GCN_MIMG_VA_MASK)+1), bufPtr);
+    decodeGCNVRegOperand(insnCode2&0xff, getMIMGVAddrRegsNum(gcnInsn.mode), bufPtr);
     putCommaSpace(bufPtr);
     // print SRSRC
     decodeGCNOperandNoLit(dasm, ((insnCode2>>14)&0x7c),
-                (((insnCode & 0x8000)!=0) && !isGCN14) ? 4: 8, bufPtr, arch);
+                getMIMGSRsrcRegsNum(arch, insnCode), bufPtr, arch);
     
     const cxuint ssamp = (insnCode2>>21)&0x1f;
     if ((gcnInsn.mode & GCN_MIMG_SAMPLE) != 0)
@@ -2426,6 +2338,22 @@ static const GFX10MIMGDimEntry gfx10MImgDimEntryTbl[8] =
     { "2d_msaa_array", 4, 4 }
 };
 
+cxuint GCNDisasmUtils::getMIMGVAddrRegsNumGFX10(GCNInsnMode mode, uint32_t insnCode)
+{
+    const cxuint dim = (insnCode>>3)&7;
+    cxuint daddrsNum = gfx10MImgDimEntryTbl[dim].dwordsNum;
+    if ((mode & GCN_MIMG_VADERIV)!=0)
+        daddrsNum += gfx10MImgDimEntryTbl[dim].derivsNum;
+    daddrsNum += ((mode & GCN_MIMG_VA_MIP)!=0) + ((mode & GCN_MIMG_VA_C)!=0) +
+                ((mode & GCN_MIMG_VA_CL)!=0) + ((mode & GCN_MIMG_VA_L)!=0) +
+                ((mode & GCN_MIMG_VA_B)!=0) + ((mode & GCN_MIMG_VA_O)!=0);
+    // NSA encoding: VADDR list limited by number of extra dwords
+    const cxuint extraCodes = ((insnCode>>1)&3);
+    if (extraCodes != 0)
+        daddrsNum = std::min(daddrsNum, (extraCodes)*4 + 1);
+    return daddrsNum;
+}
+
 void GCNDisasmUtils::decodeMIMGEncodingGFX10(GCNDisassembler& dasm, cxuint spacesToAdd,
         GPUArchMask arch, const GCNInstruction& gcnInsn, uint32_t insnCode,
         uint32_t insnCode2, uint32_t insnCode3, uint32_t insnCode4, uint32_t insnCode5)
@@ -2437,40 +2365,20 @@ void GCNDisasmUtils::decodeMIMGEncodingGFX10(GCNDisassembler& dasm, cxuint space
     
     const cxuint dim = (insnCode>>3)&7;
     const cxuint dmask = (insnCode>>8)&15;
-    cxuint dregsNum = 4;
-    // determine register number for VDATA
-    if ((gcnInsn.mode & GCN_MIMG_VDATA4) == 0)
-        dregsNum = ((dmask & 1)?1:0) + ((dmask & 2)?1:0) + ((dmask & 4)?1:0) +
-                ((dmask & 8)?1:0);
-    
-    if (insnCode2 & (1U<<31))
-        dregsNum = (dregsNum+1)>>1;
-    dregsNum = (dregsNum == 0) ? 1 : dregsNum;
-    if (insnCode & 0x10000)
-        dregsNum++; // tfe
-    
     const cxuint extraCodes = ((insnCode>>1)&3);
     // print VDATA
-    decodeGCNVRegOperand((insnCode2>>8)&0xff, dregsNum, bufPtr);
+    decodeGCNVRegOperand((insnCode2>>8)&0xff,
+                getMIMGVDataRegsNum(arch, gcnInsn.mode, insnCode, insnCode2), bufPtr);
     putCommaSpace(bufPtr);
     
     // calculate VADDR registers number
-    cxuint daddrsNum = gfx10MImgDimEntryTbl[dim].dwordsNum;
-    if ((gcnInsn.mode & GCN_MIMG_VADERIV)!=0)
-        daddrsNum += gfx10MImgDimEntryTbl[dim].derivsNum;
-    daddrsNum += ((gcnInsn.mode & GCN_MIMG_VA_MIP)!=0) +
-                ((gcnInsn.mode & GCN_MIMG_VA_C)!=0) +
-                ((gcnInsn.mode & GCN_MIMG_VA_CL)!=0) +
-                ((gcnInsn.mode & GCN_MIMG_VA_L)!=0) +
-                ((gcnInsn.mode & GCN_MIMG_VA_B)!=0) +
-                ((gcnInsn.mode & GCN_MIMG_VA_O)!=0);
+    cxuint daddrsNum = getMIMGVAddrRegsNumGFX10(gcnInsn.mode, insnCode);
     // print VADDR
     if (extraCodes==0)
         decodeGCNVRegOperand(insnCode2&0xff, daddrsNum, bufPtr);
     else
     {
         // list of VADDR VGPRs
-        daddrsNum = std::min(daddrsNum, (extraCodes)*4 + 1);
         *bufPtr++ = '[';
         decodeGCNVRegOperand(insnCode2&0xff, 1, bufPtr);
         *bufPtr++ = ',';
@@ -2633,20 +2541,11 @@ void GCNDisasmUtils::decodeEXPEncoding(GCNDisassembler& dasm, cxuint spacesToAdd
 void GCNDisasmUtils::printFLATAddr(cxuint flatMode, char*& bufPtr, uint32_t insnCode2,
                                    cxuint nullCode)
 {
-    const cxuint vaddr = insnCode2&0xff;
-    if (flatMode == 0)
-        decodeGCNVRegOperand(vaddr, 2 , bufPtr); // addr
-    else if (flatMode == GCN_FLAT_GLOBAL)
-        decodeGCNVRegOperand(vaddr,
-                // if off in SADDR, then single VGPR offset
-                ((insnCode2>>16)&0x7f) == nullCode ? 2 : 1, bufPtr); // addr
-    else if (flatMode == GCN_FLAT_SCRATCH)
-    {
-        if (((insnCode2>>16)&0x7f) == nullCode)
-            decodeGCNVRegOperand(vaddr, 1, bufPtr); // addr
-        else // no vaddr
-            putChars(bufPtr, "off", 3);
-    }
+    const cxuint vaddrRegsNum = getFLATVAddrRegsNum(flatMode, insnCode2, nullCode);
+    if (vaddrRegsNum != 0)
+        decodeGCNVRegOperand(insnCode2&0xff, vaddrRegsNum, bufPtr); // addr
+    else if (flatMode == GCN_FLAT_SCRATCH) // no vaddr
+        putChars(bufPtr, "off", 3);
 }
 
 void GCNDisasmUtils::decodeFLATEncoding(GCNDisassembler& dasm, cxuint spacesToAdd,
@@ -2663,12 +2562,8 @@ void GCNDisasmUtils::decodeFLATEncoding(GCNDisassembler& dasm, cxuint spacesToAd
     bool vdataUsed = false;
     bool saddrUsed = false;
     const cxuint dregsNum = ((gcnInsn.mode&GCN_DSIZE_MASK)>>GCN_SHIFT2)+1;
-    /// cmpswap store only to half of number of data registers
-    cxuint dstRegsNum = ((gcnInsn.mode & GCN_CMPSWAP)!=0) ? (dregsNum>>1) :  dregsNum;
+    const cxuint dstRegsNum = getFLATVDstRegsNum(arch, gcnInsn.mode, insnCode2);
     const cxuint flatMode = gcnInsn.mode & GCN_FLAT_MODEMASK;
-    // add tfe extra register if needed
-    dstRegsNum = (!isGCN14 && !isGCN15 && (insnCode2 & 0x800000U)) ?
-                        dstRegsNum+1 : dstRegsNum;
     
     const cxuint nullCode = isGCN15 ? 0x7d : 0x7f;
     bool printAddr = false;
@@ -2707,8 +2602,8 @@ void GCNDisasmUtils::decodeFLATEncoding(GCNDisassembler& dasm, cxuint spacesToAd
     {
         // if GLOBAL_ or SCRATCH_
         putCommaSpace(bufPtr);
-        cxuint saddr = (insnCode2>>16)&0x7f;
-        if ((isGCN14 && (saddr&0x7f) != 0x7f) || (isGCN15 && (saddr&0x7f) != 0x7d))
+        const cxuint saddr = getFLATSAddrReg(arch, flatMode, insnCode2);
+        if (saddr != noReg)
             // print SADDR (GCN 1.4)
             decodeGCNOperandNoLit(dasm, saddr, flatMode == GCN_FLAT_SCRATCH ? 1 : 2,
                         bufPtr, arch, FLTLIT_NONE);
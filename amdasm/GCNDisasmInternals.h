@@ -21,6 +21,8 @@
 #define __CLRX_GCNDISASMINTERNALS_H__
 
 #include <CLRX/Config.h>
+#include <algorithm>
+#include <climits>
 #include <CLRX/utils/Utilities.h>
 #include <CLRX/utils/GPUId.h>
 #include <CLRX/amdasm/Disassembler.h>
@@ -37,11 +39,192 @@ enum FloatLitType: cxbyte
     FLTLIT_F16      // half precision
 };
 
+// temporary structure to store operand modifiers and operand SRC0
+struct CLRX_INTERNAL VOPExtraWordOut
+{
+    uint16_t src0;
+    bool sextSrc0;
+    bool negSrc0;
+    bool absSrc0;
+    bool sextSrc1;
+    bool negSrc1;
+    bool absSrc1;
+    bool scalarSrc1;
+};
+
 // GCN disassembler code in structure (this allow to access private code of
 // GCNDisassembler by these routines
 struct CLRX_INTERNAL GCNDisasmUtils
 {
     typedef GCNDisassembler::RelocIter RelocIter;
+    
+    /* operand decoding (registers and their numbers) shared by decoding routines
+     * and by register usage in code statistics */
+    
+    // no register in operand
+    static const cxuint noReg = UINT_MAX;
+    
+    // decode SRC0 and modifiers of VOP1/VOP2/VOPC (SDWA, DPP or DPP8 in extra word)
+    static VOPExtraWordOut decodeVOPExtraWord(GPUArchMask arch, cxuint src0Field,
+              uint32_t extraWord);
+    
+    // SDST replaced by SDWAB (VOPC) or noReg
+    static cxuint getVOPCSDWABSDst(GPUArchMask arch, cxuint src0Field, uint32_t extraWord)
+    {
+        return ((arch & ARCH_GCN_1_4_5) != 0 && src0Field==0xf9 &&
+                (extraWord & 0x8000) != 0) ? ((extraWord>>8)&0x7f) : noReg;
+    }
+    
+    // SOFFSET register of SMEM (noReg if immediate offset)
+    static cxuint getSMEMSOffsetReg(GPUArchMask arch, uint32_t insnCode,
+              uint32_t insnCode2)
+    {
+        const bool isGCN14 = ((arch&ARCH_GCN_1_4) != 0);
+        const bool isGCN15 = ((arch&ARCH_GCN_1_5) != 0);
+        if ((!isGCN15 && (insnCode&0x20000)) || (isGCN15 && (insnCode2>>25)==0x7d))
+            // immediate offset, GCN 1.4 can have SOFFSET in last 7 bits
+            return (!isGCN15 && isGCN14 && (insnCode & 0x4000) != 0) ?
+                    (insnCode2>>25) : noReg;
+        if (isGCN15 || (isGCN14 && (insnCode & 0x4000) != 0))
+            return insnCode2>>25;
+        return insnCode2&0xff;
+    }
+    
+    // number of registers in destination or VDATA0 of DS instruction
+    static cxuint getDSRegsNum(GCNInsnMode mode, bool dst)
+    {
+        cxuint regsNum = (mode&(dst ? GCN_REG_DST_64 : GCN_REG_SRC0_64))?2:1;
+        if ((mode&GCN_DS_96) != 0)
+            regsNum = 3;
+        if ((mode&GCN_DS_128) != 0 || (dst && (mode&GCN_DST128) != 0))
+            regsNum = 4;
+        return regsNum;
+    }
+    static bool isDSVDstUsed(GCNInsnMode mode)
+    {
+        return ((mode & GCN_ADDR_SRC) != 0 || (mode & GCN_ONLYDST) != 0) &&
+                (mode & GCN_ONLY_SRC) == 0;
+    }
+    static bool isDSVAddrUsed(GCNInsnMode mode)
+    { return (mode & GCN_ONLYDST) == 0 && (mode & GCN_ONLY_SRC) == 0; }
+    static bool isDSVDataUsed(GCNInsnMode mode)
+    {
+        return (mode & GCN_ONLYDST) == 0 && (mode & (GCN_ADDR_DST|GCN_ADDR_SRC)) != 0 &&
+                (mode & GCN_SRCS_MASK) != GCN_NOSRC;
+    }
+    
+    // number of VDATA registers of MUBUF/MTBUF instruction
+    static cxuint getMUBUFVDataRegsNum(GPUArchMask arch, GCNInsnMode mode,
+              uint32_t insnCode2)
+    {
+        cxuint dregsNum = ((mode&GCN_DSIZE_MASK)>>GCN_SHIFT2)+1;
+        if ((mode & GCN_MUBUF_D16)!=0 && (arch&ARCH_GCN_1_4_5)!=0)
+            // 16-bit values packed into half of number of registers
+            dregsNum = (dregsNum+1)>>1;
+        if (insnCode2 & 0x800000U)
+            dregsNum++; // tfe
+        return dregsNum;
+    }
+    // number of VADDR registers of MUBUF/MTBUF instruction
+    static cxuint getMUBUFVAddrRegsNum(GPUArchMask arch, uint32_t insnCode)
+    {
+        /* for addr32 - idxen+offen or 1, for addr64 - 2 (idxen and offen is illegal) */
+        return ((insnCode & 0x3000U)==0x3000U ||
+                /* addr64 only for older GCN than 1.2 */
+                ((arch&ARCH_GCN_1_2_4_5)==0 && (insnCode & 0x8000U)))? 2 : 1;
+    }
+    
+    // number of VDATA registers of MIMG instruction
+    static cxuint getMIMGVDataRegsNum(GPUArchMask arch, GCNInsnMode mode,
+              uint32_t insnCode, uint32_t insnCode2)
+    {
+        const cxuint dmask = (insnCode>>8)&15;
+        cxuint dregsNum = 4;
+        if ((mode & GCN_MIMG_VDATA4) == 0)
+            dregsNum = ((dmask & 1)?1:0) + ((dmask & 2)?1:0) + ((dmask & 4)?1:0) +
+                    ((dmask & 8)?1:0);
+        if ((arch&ARCH_GCN_1_5)!=0)
+        {
+            // GFX10: d16 packing before correction of empty dmask
+            if (insnCode2 & (1U<<31))
+                dregsNum = (dregsNum+1)>>1;
+            dregsNum = (dregsNum == 0) ? 1 : dregsNum;
+        }
+        else
+        {
+            dregsNum = (dregsNum == 0) ? 1 : dregsNum;
+            if ((arch&ARCH_GCN_1_4)!=0 && (insnCode2 & (1U<<31))!=0)
+                dregsNum = (dregsNum+1)>>1;
+        }
+        if (insnCode & 0x10000)
+            dregsNum++; // tfe
+        return dregsNum;
+    }
+    // number of VADDR registers of MIMG instruction (before GFX10)
+    static cxuint getMIMGVAddrRegsNum(GCNInsnMode mode)
+    { return std::max(GCNInsnMode(4), (mode&GCN_MIMG_VA_MASK)+1); }
+    // number of VADDR registers of MIMG instruction (GFX10)
+    static cxuint getMIMGVAddrRegsNumGFX10(GCNInsnMode mode, uint32_t insnCode);
+    // number of SRSRC registers of MIMG instruction
+    static cxuint getMIMGSRsrcRegsNum(GPUArchMask arch, uint32_t insnCode)
+    {
+        return (((insnCode & 0x8000)!=0) && (arch&ARCH_GCN_1_4)==0) ? 4 : 8;
+    }
+    
+    // number of VDST registers of FLAT instruction
+    static cxuint getFLATVDstRegsNum(GPUArchMask arch, GCNInsnMode mode,
+              uint32_t insnCode2)
+    {
+        const cxuint dregsNum = ((mode&GCN_DSIZE_MASK)>>GCN_SHIFT2)+1;
+        /// cmpswap store only to half of number of data registers
+        const cxuint dstRegsNum = ((mode & GCN_CMPSWAP)!=0) ? (dregsNum>>1) :  dregsNum;
+        // add tfe extra register if needed
+        return ((arch&ARCH_GCN_1_4_5)==0 && (insnCode2 & 0x800000U)) ?
+                        dstRegsNum+1 : dstRegsNum;
+    }
+    // number of VADDR registers of FLAT instruction (0 if no VADDR)
+    static cxuint getFLATVAddrRegsNum(cxuint flatMode, uint32_t insnCode2,
+              cxuint nullCode)
+    {
+        if (flatMode == 0)
+            return 2;
+        // if off in SADDR, then single VGPR offset
+        if (flatMode == GCN_FLAT_GLOBAL)
+            return ((insnCode2>>16)&0x7f) == nullCode ? 2 : 1;
+        if (flatMode == GCN_FLAT_SCRATCH)
+            return ((insnCode2>>16)&0x7f) == nullCode ? 1 : 0;
+        return 0;
+    }
+    // SADDR register of FLAT instruction or noReg if off or not used
+    static cxuint getFLATSAddrReg(GPUArchMask arch, cxuint flatMode, uint32_t insnCode2)
+    {
+        const cxuint saddr = (insnCode2>>16)&0x7f;
+        if (flatMode != 0 && (((arch&ARCH_GCN_1_4)!=0 && saddr != 0x7f) ||
+                ((arch&ARCH_GCN_1_5)!=0 && saddr != 0x7d)))
+            return saddr;
+        return noReg;
+    }
+    
+    // true if VOP3 encoded VOPC instruction
+    static bool isVOP3VOPC(GPUArchMask arch, GCNInsnMode mode, uint32_t insnCode)
+    {
+        const cxuint opcode = ((arch&ARCH_GCN_1_2_4_5)!=0) ? ((insnCode>>16)&0x3ff) :
+                    ((insnCode>>17)&0x1ff);
+        return (mode&GCN_VOP3_MASK2) != GCN_VOP3_VOP3P && opcode < 256;
+    }
+    // true if VOP3B instruction has SDST operand
+    static bool isVOP3BSDstUsed(GCNInsnMode mode1)
+    {
+        return mode1 == GCN_DS2_VCC || mode1 == GCN_DST_VCC ||
+                mode1 == GCN_DST_VCC_VSRC2 || mode1 == GCN_S0EQS12;
+    }
+    // number of registers in VDST or VSRC2 of VOP3 instruction
+    static cxuint getVOP3RegsNum(GCNInsnMode mode, GCNInsnMode reg64Flag)
+    {
+        // for V_MQSAD_U32 SRC2 is 128-bit
+        return ((mode&0x7000)==GCN_VOP3_DS2_128) ? 4 : ((mode&reg64Flag)?2:1);
+    }
+    
     static void printLiteral(GCNDisassembler& dasm, size_t codePos, RelocIter& relocIter,
               uint32_t literal, FloatLitType floatLit, bool optional,
               bool useSRMDLit = false);
@@ -135,6 +318,14 @@ struct CLRX_INTERNAL GCNDisasmUtils
              uint32_t insnCode2);
 };
 
+/* decode GCN instruction at position pos (in words) and move position after it.
+ * returns instruction entry or null if instruction is illegal.
+ * extraCodes (if not null) receives three next words (literal in GCN 1.5 VOP3,
+ * or VADDR list of GFX10 MIMG) */
+extern CLRX_INTERNAL const GCNInstruction* decodeGCNInstruction(GPUDeviceType deviceType,
+            size_t codeWordsNum, const uint32_t* codeWords, size_t& pos,
+            uint32_t& insnCode, uint32_t& insnCode2, uint32_t* extraCodes = nullptr);
+
 };
 
 #endif
@@ -25,6 +25,7 @@
 #include <string>
 #include <CLRX/utils/Utilities.h>
 #include <CLRX/utils/GPUId.h>
+#include <CLRX/utils/MemAccess.h>
 
 namespace CLRX
 {
@@ -259,6 +260,68 @@ struct CLRX_INTERNAL GCNAsmInstruction
 
 CLRX_INTERNAL extern const GCNInstruction gcnInstrsTable[];
 
+// flags for instruction length decoding (in GCNEncodingClass)
+enum : cxbyte
+{
+    GCNLEN_LIT_SSRC0 = 1,   // literal if SSRC0 is 0xff (SOP1, SOP2, SOPC)
+    GCNLEN_LIT_SSRC1 = 2,   // literal if SSRC1 is 0xff (SOP2, SOPC)
+    GCNLEN_LIT_VSRC0 = 4,   // literal, SDWA or DPP dword choosen by VOP SRC0
+    GCNLEN_LIT_VOP3 = 8,    // literal if any VOP3 source is 0xff (GCN 1.5)
+    GCNLEN_LIT_SMRD = 16,   // literal if SMRD offset is 0xff (GCN 1.1)
+    GCNLEN_MIMG_NSA = 32,   // NSA address dwords given in bits 1-2 (GCN 1.5)
+    GCNLEN_SOPK_JUMP = 64   // SOPK instruction with relative jump target
+};
+
+// encoding class of instruction, choosen by 9 highest bits of first dword
+struct CLRX_INTERNAL GCNEncodingClass
+{
+    cxbyte encoding;    // GCN encoding (GCNENC_NONE if illegal)
+    cxbyte words;       // base length in dwords (with fixed 32-bit constant)
+    cxbyte flags;       // length flags (GCNLEN_*)
+};
+
+// encoding class table for single GPU architecture
+struct CLRX_INTERNAL GCNEncodingClassTable
+{
+    GCNEncodingClass classes[512];  // indexed by bits 23-31 of first dword
+    uint32_t vsrc0Extra[16];    // bitmap of VOP SRC0 values that adds dword
+};
+
+// get encoding class table for architecture (built with disassembler tables)
+CLRX_INTERNAL extern const GCNEncodingClassTable& getGCNEncodingClassTable(
+            GPUArchitecture arch);
+
+// get instruction length in dwords. codeWords points to first dword of instruction,
+// wordsNum is number of available dwords (can be less than returned length)
+static inline cxuint getGCNInstructionWords(const GCNEncodingClassTable& encTable,
+            const uint32_t* codeWords, size_t wordsNum)
+{
+    const uint32_t insnCode = ULEV(codeWords[0]);
+    const GCNEncodingClass& encClass = encTable.classes[insnCode>>23];
+    cxuint words = encClass.words;
+    const cxuint flags = encClass.flags;
+    if (flags == 0)
+        return words; // fast path: no length dependent fields
+    if (((flags & GCNLEN_LIT_SSRC0) != 0 && (insnCode&0xff) == 0xff) ||
+        ((flags & GCNLEN_LIT_SSRC1) != 0 && (insnCode&0xff00) == 0xff00))
+        words++;
+    else if ((flags & GCNLEN_LIT_VSRC0) != 0 &&
+        (encTable.vsrc0Extra[(insnCode&0x1ff)>>5] & (1U<<(insnCode&31))) != 0)
+        words++;
+    else if ((flags & GCNLEN_LIT_SMRD) != 0 && (insnCode&0x1ff) == 0xff)
+        words++;
+    else if ((flags & GCNLEN_MIMG_NSA) != 0)
+        words += (insnCode>>1)&3;
+    else if ((flags & GCNLEN_LIT_VOP3) != 0 && wordsNum >= 2)
+    {
+        const uint32_t insnCode2 = ULEV(codeWords[1]);
+        if ((insnCode2 & 0x1ff) == 0xff || ((insnCode2>>9) & 0x1ff) == 0xff ||
+            ((insnCode2>>18) & 0x1ff) == 0xff)
+            words++;
+    }
+    return words;
+}
+
 };
 
 #endif
@@ -20,6 +20,10 @@
 #include <CLRX/Config.h>
 #include <cassert>
 #include <cstring>
+#include <cstdint>
+#include <algorithm>
+#include <utility>
+#include <vector>
 #include <unordered_set>
 #include <CLRX/amdbin/ElfBinaries.h>
 #include <CLRX/utils/Utilities.h>
@@ -27,5 +31,182 @@
 #include <CLRX/utils/InputOutput.h>
 #include <CLRX/utils/Containers.h>
 #include <CLRX/amdbin/Amd3Binaries.h>
+#include "ROCmBinLoader.h"
 
 using namespace CLRX;
+
+/*
+ * AMD3 (AMDGPU HSA code object V3) binary reader
+ */
+
+Amd3Binary::Amd3Binary(size_t binaryCodeSize, cxbyte* binaryCode, Flags creationFlags,
+            uint64_t expectedChecksum)
+        : ElfBinary64(binaryCodeSize, binaryCode, creationFlags, expectedChecksum),
+          regionsNum(0), codeSize(0), code(nullptr),
+          globalDataSize(0), globalData(nullptr), metadataSize(0), metadata(nullptr),
+          kernelDescData(binaryCode)
+{
+    // skip bound checks for trusted binary
+    const bool trusted = (creationFlags & BINARY_CREATE_TRUSTED) != 0;
+    // find '.text' section
+    const cxuint textIndex = findROCmSectionIndex(*this, ".text");
+    if (textIndex!=SHN_UNDEF)
+    {
+        code = getSectionContent(textIndex);
+        codeSize = ULEV(getSectionHeader(textIndex).sh_size);
+    }
+    
+    const cxuint rodataIndex = findROCmSectionIndex(*this, ".rodata");
+    uint64_t rodataOffset = 0;
+    uint64_t rodataAddr = 0;
+    // find '.rodata' section (holds kernel descriptors)
+    if (rodataIndex!=SHN_UNDEF)
+    {
+        globalData = getSectionContent(rodataIndex);
+        const Elf64_Shdr& rodataShdr = getSectionHeader(rodataIndex);
+        globalDataSize = ULEV(rodataShdr.sh_size);
+        rodataOffset = ULEV(rodataShdr.sh_offset);
+        rodataAddr = ULEV(rodataShdr.sh_addr);
+    }
+    
+    // get kernel descriptors
+    std::vector<std::pair<CString, uint64_t> > tmpKernelDescs;
+    getROCmKernelDescSymbols(*this, rodataIndex, tmpKernelDescs);
+    kernelDescOffsets.resize(tmpKernelDescs.size());
+    for (size_t i = 0; i < tmpKernelDescs.size(); i++)
+    {
+        const uint64_t value = tmpKernelDescs[i].second;
+        if (!trusted && (value < rodataAddr ||
+            usumGt(value-rodataAddr, uint64_t(sizeof(Amd3KernelDescriptor)),
+                   uint64_t(globalDataSize))))
+            throw BinException("Kernel descriptor out of range");
+        // kernel descriptor is not copied, only its offset in binary is stored
+        kernelDescOffsets[i] = value - rodataAddr + rodataOffset;
+    }
+    if (hasKernelDescMap())
+    {
+        kernelDescMap.resize(tmpKernelDescs.size());
+        for (size_t i = 0; i < tmpKernelDescs.size(); i++)
+            kernelDescMap[i] = std::make_pair(tmpKernelDescs[i].first, i);
+        mapSort(kernelDescMap.begin(), kernelDescMap.end());
+        if ((creationFlags & BINARY_CREATE_NAMEHASHINDEX) != 0)
+            kernelDescIndex.build(kernelDescMap.begin(), kernelDescMap.end());
+    }
+    // replace offsets by indices to find kernel descriptors of regions
+    for (size_t i = 0; i < tmpKernelDescs.size(); i++)
+        tmpKernelDescs[i].second = i;
+    mapSort(tmpKernelDescs.begin(), tmpKernelDescs.end());
+    
+    // get regions (symbols or kernels), kernel code starts at symbol
+    std::vector<ROCmCodeRegion> codeRegions;
+    getROCmCodeRegions(*this, textIndex, true, 0, false, trusted, codeRegions);
+    regionsNum = codeRegions.size();
+    regions.reset(new Amd3Region[regionsNum]);
+    for (size_t i = 0; i < regionsNum; i++)
+    {
+        const ROCmCodeRegion& codeRegion = codeRegions[i];
+        const Amd3RegionType type = (codeRegion.symType==STT_OBJECT) ?
+                    Amd3RegionType::DATA : Amd3RegionType::KERNEL;
+        const char* symName = getSymbolName(codeRegion.symIndex);
+        size_t kernelDesc = SIZE_MAX;
+        if (type == Amd3RegionType::KERNEL)
+        {
+            auto it = binaryMapFind(tmpKernelDescs.begin(), tmpKernelDescs.end(),
+                                    CString(symName));
+            if (it != tmpKernelDescs.end())
+                kernelDesc = it->second;
+        }
+        regions[i] = { symName, codeRegion.size, codeRegion.offset, type, kernelDesc };
+    }
+    
+    if (hasRegionMap())
+    {
+        // create region map
+        regionsMap.resize(regionsNum);
+        for (size_t i = 0; i < regionsNum; i++)
+            regionsMap[i] = std::make_pair(regions[i].regionName, i);
+        // sort region map
+        mapSort(regionsMap.begin(), regionsMap.end());
+        if ((creationFlags & BINARY_CREATE_NAMEHASHINDEX) != 0)
+            regionsIndex.build(regionsMap.begin(), regionsMap.end());
+    }
+    
+    // load got symbols
+    loadROCmGotSymbols(*this, trusted, gotSymbols);
+    // get metadata (MsgPack) and target
+    bool metadataV3Format = false;
+    getROCmNotes(*this, trusted, false, metadata, metadataSize, metadataV3Format, target);
+    
+    if ((creationFlags & AMD3BIN_CREATE_METADATAINFO) != 0 &&
+        metadata != nullptr && metadataSize != 0)
+    {
+        metadataInfo.reset(new Amd3Metadata());
+        parseROCmMetadataMsgPack(metadataSize,
+                reinterpret_cast<const cxbyte*>(metadata), *metadataInfo);
+        
+        if (hasKernelInfoMap())
+        {
+            const std::vector<Amd3KernelMetadata>& kernels = metadataInfo->kernels;
+            kernelInfosMap.resize(kernels.size());
+            for (size_t i = 0; i < kernelInfosMap.size(); i++)
+                kernelInfosMap[i] = std::make_pair(kernels[i].name, i);
+            // sort kernel info map
+            mapSort(kernelInfosMap.begin(), kernelInfosMap.end());
+            if ((creationFlags & BINARY_CREATE_NAMEHASHINDEX) != 0)
+                kernelInfosIndex.build(kernelInfosMap.begin(), kernelInfosMap.end());
+        }
+    }
+}
+
+/// determine GPU device from AMD notes (default is Navi)
+GPUDeviceType Amd3Binary::determineGPUDeviceType(uint32_t& archMinor,
+                     uint32_t& archStepping) const
+{
+    return determineROCmGPUDeviceType(*this, true, archMinor, archStepping);
+}
+
+const Amd3Region& Amd3Binary::getRegion(const char* name) const
+{
+    RegionMap::const_iterator it = regionsIndex.empty() ?
+            binaryMapFind(regionsMap.begin(), regionsMap.end(), name) :
+            regionsIndex.find(regionsMap.begin(), regionsMap.end(), name);
+    if (it == regionsMap.end())
+        throw BinException("Can't find region name");
+    return regions[it->second];
+}
+
+const Amd3KernelMetadata& Amd3Binary::getKernelInfo(const char* name) const
+{
+    if (!hasMetadataInfo())
+        throw BinException("Can't find kernel info name");
+    RegionMap::const_iterator it = kernelInfosIndex.empty() ?
+            binaryMapFind(kernelInfosMap.begin(), kernelInfosMap.end(), name) :
+            kernelInfosIndex.find(kernelInfosMap.begin(), kernelInfosMap.end(), name);
+    if (it == kernelInfosMap.end())
+        throw BinException("Can't find kernel info name");
+    return metadataInfo->kernels[it->second];
+}
+
+const Amd3KernelDescriptor& Amd3Binary::getKernelDesc(const char* name) const
+{
+    KernelDescMap::const_iterator it = kernelDescIndex.empty() ?
+            binaryMapFind(kernelDescMap.begin(), kernelDescMap.end(), name) :
+            kernelDescIndex.find(kernelDescMap.begin(), kernelDescMap.end(), name);
+    if (it == kernelDescMap.end())
+        throw BinException("Can't find kernel descriptor name");
+    return getKernelDesc(it->second);
+}
+
+// if AMDGPU HSA code object V3
+bool CLRX::isAmd3Binary(size_t binarySize, const cxbyte* binary)
+{
+    if (!isElfBinary(binarySize, binary))
+        return false;
+    if (binary[EI_CLASS] != ELFCLASS64)
+        return false;
+    const Elf64_Ehdr* ehdr = reinterpret_cast<const Elf64_Ehdr*>(binary);
+    if (ULEV(ehdr->e_machine) != 0xe0)
+        return false;
+    // HSA OS ABI and ABI version for code object V3
+    return binary[EI_OSABI] == 64 && binary[EI_ABIVERSION] == 1;
+}
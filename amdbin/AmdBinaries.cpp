@@ -22,6 +22,7 @@
 #include <cstring>
 #include <climits>
 #include <cstdint>
+#include <algorithm>
 #include <map>
 #include <mutex>
 #include <utility>
@@ -30,6 +31,7 @@
 #include <CLRX/utils/Utilities.h>
 #include <CLRX/utils/MemAccess.h>
 #include <CLRX/amdbin/AmdBinaries.h>
+#include <CLRX/amdbin/BinaryIndex.h>
 #include <CLRX/utils/GPUId.h>
 
 /* INFO: in this file is used ULEV function for conversion
@@ -165,8 +167,10 @@ static size_t unfinishedRegionOfStringTable(const cxbyte* table, size_t size)
 /* AMD inner GPU binary */
 
 AmdInnerGPUBinary32::AmdInnerGPUBinary32(const CString& _kernelName,
-         size_t binaryCodeSize, cxbyte* binaryCode, Flags creationFlags)
-        : ElfBinary32(binaryCodeSize, binaryCode, creationFlags), kernelName(_kernelName),
+         size_t binaryCodeSize, cxbyte* binaryCode, Flags creationFlags,
+         bool checksumVerified)
+        : ElfBinary32(binaryCodeSize, binaryCode, creationFlags, 0, checksumVerified),
+          kernelName(_kernelName),
           encodingEntriesNum(0), encodingEntries(nullptr)
 {
     if (getProgramHeadersNum() >= 1)
@@ -292,12 +296,13 @@ static const GPUDeviceInnerCodeEntry gpuDeviceInnerCodeTable[19] =
 static const cxuint gpuDeviceInnerCodeTableSize = sizeof(gpuDeviceInnerCodeTable)/
             sizeof(GPUDeviceInnerCodeEntry);
 
-cxuint AmdInnerGPUBinary32::findCALEncodingEntryIndex(GPUDeviceType deviceType) const
+cxuint CLRX::findAmdCALEncodingEntryIndex(cxuint entriesNum,
+            const CALEncodingEntry* entries, GPUDeviceType deviceType)
 {
     cxuint encEntryIndex = 0;
-    for (encEntryIndex = 0; encEntryIndex < encodingEntriesNum; encEntryIndex++)
+    for (encEntryIndex = 0; encEntryIndex < entriesNum; encEntryIndex++)
     {
-        const CALEncodingEntry& encEntry = encodingEntries[encEntryIndex];
+        const CALEncodingEntry& encEntry = entries[encEntryIndex];
         /* check gpuDeviceType */
         const uint32_t dMachine = ULEV(encEntry.machine);
         // detect GPU device from machine field from CAL encoding entry
@@ -309,11 +314,16 @@ cxuint AmdInnerGPUBinary32::findCALEncodingEntryIndex(GPUDeviceType deviceType)
             gpuDeviceInnerCodeTable[index].deviceType == deviceType)
             break; // if found
     }
-    if (encEntryIndex == encodingEntriesNum)
+    if (encEntryIndex == entriesNum)
         throw BinException("Can't find suitable CALEncodingEntry!");
     return encEntryIndex;
 }
 
+cxuint AmdInnerGPUBinary32::findCALEncodingEntryIndex(GPUDeviceType deviceType) const
+{
+    return findAmdCALEncodingEntryIndex(encodingEntriesNum, encodingEntries, deviceType);
+}
+
 template<typename ArgSym>
 static size_t skipStructureArgX86(const ArgSym* argDescTable,
             size_t argDescsNum, size_t startPos)
@@ -616,13 +626,33 @@ AmdMainBinaryBase::AmdMainBinaryBase(AmdMainType _type) : type(_type)
 AmdMainBinaryBase::~AmdMainBinaryBase()
 { }
 
+void AmdMainBinaryBase::initKernelInfo(size_t index) const
+{ }
+
+const KernelInfo* AmdMainBinaryBase::getKernelInfos() const
+{
+    if (kernelInfoOnceFlags)
+        for (size_t i = 0; i < kernelInfos.size(); i++)
+            callOnce(kernelInfoOnceFlags[i], [this, i]() { initKernelInfo(i); });
+    return kernelInfos.data();
+}
+
+const KernelInfo& AmdMainBinaryBase::getKernelInfo(size_t index) const
+{
+    if (kernelInfoOnceFlags)
+        callOnce(kernelInfoOnceFlags[index], [this, index]()
+                { initKernelInfo(index); });
+    return kernelInfos[index];
+}
+
 const KernelInfo& AmdMainBinaryBase::getKernelInfo(const char* name) const
 {
-    KernelInfoMap::const_iterator it = binaryMapFind(
-        kernelInfosMap.begin(), kernelInfosMap.end(), name);
+    KernelInfoMap::const_iterator it = kernelInfosIndex.empty() ?
+        binaryMapFind(kernelInfosMap.begin(), kernelInfosMap.end(), name) :
+        kernelInfosIndex.find(kernelInfosMap.begin(), kernelInfosMap.end(), name);
     if (it == kernelInfosMap.end())
         throw BinException("Can't find kernel name");
-    return kernelInfos[it->second];
+    return getKernelInfo(it->second);
 }
 
 static const cxuint vectorIdTable[17] =
@@ -684,8 +714,8 @@ static inline CString stringFromCStringDelim(const char* c1, size_t maxSize, cha
 
 /* metadata string that stored in rodata section in main GPU binary holds needed kernel
  * argument info (arg type and arg name). this function just retrieve that data */
-static void parseAmdGpuKernelMetadata(const char* symName, size_t metadataSize,
-          const char* kernelDesc, KernelInfo& kernelInfo)
+static void parseAmdGpuKernelMetadata(size_t metadataSize, const char* kernelDesc,
+          KernelInfo& kernelInfo)
 {
     // internal structure to hold kernel arguments info in map
     struct InitKernelArgMapEntry
@@ -1025,7 +1055,6 @@ static void parseAmdGpuKernelMetadata(const char* symName, size_t metadataSize,
         kptr++; // skip newline
     }
     
-    kernelInfo.kernelName.assign(symName+9, ::strlen(symName)-18);
     kernelInfo.argInfos.resize(argIndex);
     
     for (const auto& e: initKernelArgs)
@@ -1110,12 +1139,16 @@ struct CLRX_INTERNAL AmdGPU64Types: Elf64Types
 };
 
 AmdMainGPUBinaryBase::AmdMainGPUBinaryBase(AmdMainType type)
-        : AmdMainBinaryBase(type), metadatas(nullptr), globalDataSize(0), globalData(0)
+        : AmdMainBinaryBase(type), innerCreationFlags(0), metadatas(nullptr),
+          globalDataSize(0), globalData(0)
 { }
 
 template<typename Types>
-void AmdMainGPUBinaryBase::initMainGPUBinary(typename Types::ElfBinary& mainElf)
+void AmdMainGPUBinaryBase::initMainGPUBinary(typename Types::ElfBinary& mainElf,
+            const BinaryIndex* index)
 {
+    if (index != nullptr && index->getFormat() != BinaryProbeFormat::AMD)
+        throw BinException("Binary index is not for AMD Catalyst binary");
     cxuint textIndex = SHN_UNDEF;
     try
     { textIndex = mainElf.getSectionIndex(".text"); }
@@ -1205,14 +1238,21 @@ void AmdMainGPUBinaryBase::initMainGPUBinary(typename Types::ElfBinary& mainElf)
         }
     }
     
+    /* inner binaries are created at first access,
+     * here only their places in binary are checked and stored */
+    innerCreationFlags = ((creationFlags >> AMDBIN_INNER_SHIFT) &
+                AMDBIN_INNER_INT_CREATE_ALL) | (creationFlags & BINARY_CREATE_TRUSTED);
     innerBinaries.resize(choosenSyms.size());
+    innerBinaryEntries.resize(choosenSyms.size());
+    std::fill(innerBinaryEntries.begin(), innerBinaryEntries.end(), InnerBinaryEntry());
+    innerBinaryOnceFlags.reset(new OnceFlag[choosenSyms.size()]);
     
     if (textIndex != SHN_UNDEF) /* if have ".text" */
     {
         const typename Types::Shdr& textHdr = mainElf.getSectionHeader(textIndex);
         cxbyte* textContent = mainElf.getBinaryCode() + ULEV(textHdr.sh_offset);
         
-        /* create table of innerBinaries */
+        /* create table of places of innerBinaries */
         size_t ki = 0;
         for (auto it: choosenSyms)
         {
@@ -1227,23 +1267,37 @@ void AmdMainGPUBinaryBase::initMainGPUBinary(typename Types::ElfBinary& mainElf)
             if (usumGt(symvalue, symsize, ULEV(textHdr.sh_size)))
                 throw BinException("Inner binary offset+size out of range!");
             
-            innerBinaries[ki++] = AmdInnerGPUBinary32(CString(symName+9, len-16),
-                symsize, textContent+symvalue,
-                (creationFlags >> AMDBIN_INNER_SHIFT) & AMDBIN_INNER_INT_CREATE_ALL);
+            innerBinaryEntries[ki++] = { CString(symName+9, len-16), symsize,
+                        textContent+symvalue };
         }
         if ((creationFlags & AMDBIN_CREATE_INNERBINMAP) != 0)
         {
-            innerBinaryMap.resize(innerBinaries.size());
-            for (size_t i = 0; i < innerBinaries.size(); i++)
-                innerBinaryMap[i] = std::make_pair(innerBinaries[i].getKernelName(), i);
-            mapSort(innerBinaryMap.begin(), innerBinaryMap.end());
+            if (index != nullptr)
+            {
+                // kernels in index are in order of inner binaries
+                if (index->getKernelsNum() != innerBinaries.size())
+                    throw BinException("Binary index doesn't match inner binaries");
+                innerBinaryMap = index->getKernelMap();
+            }
+            else
+            {
+                innerBinaryMap.resize(innerBinaries.size());
+                for (size_t i = 0; i < innerBinaries.size(); i++)
+                    innerBinaryMap[i] = std::make_pair(
+                                innerBinaryEntries[i].kernelName, i);
+                mapSort(innerBinaryMap.begin(), innerBinaryMap.end());
+            }
+            if ((creationFlags & BINARY_CREATE_NAMEHASHINDEX) != 0)
+                innerBinaryIndex.build(innerBinaryMap.begin(), innerBinaryMap.end());
         }
     }
     
     if ((creationFlags & AMDBIN_CREATE_KERNELINFO) != 0)
     {
+        /* kernel metadatas are parsed at first access to kernel info */
         kernelInfos.resize(choosenSymsMetadata.size());
         metadatas.reset(new AmdGPUKernelMetadata[kernelInfos.size()]);
+        kernelInfoOnceFlags.reset(new OnceFlag[kernelInfos.size()]);
         
         typename Types::Size ki = 0;
         for (typename Types::Size it: choosenSymsMetadata)
@@ -1265,10 +1319,8 @@ void AmdMainGPUBinaryBase::initMainGPUBinary(typename Types::ElfBinary& mainElf)
             if (usumGt(symvalue, symsize, ULEV(rodataHdr.sh_size)))
                 throw BinException("Metadata offset+size out of range");
             
-            // parse AMDGPU kernel metadata
-            parseAmdGpuKernelMetadata(symName, symsize,
-                  reinterpret_cast<const char*>(secContent + symvalue),
-                  kernelInfos[ki]);
+            // kernel name preceded by '__OpenCL_' and precedes '_metadata'
+            kernelInfos[ki].kernelName.assign(symName+9, ::strlen(symName)-18);
             metadatas[ki].size = symsize;
             metadatas[ki].data = reinterpret_cast<char*>(secContent + symvalue);
             ki++;
@@ -1280,6 +1332,8 @@ void AmdMainGPUBinaryBase::initMainGPUBinary(typename Types::ElfBinary& mainElf)
             for (size_t i = 0; i < kernelInfos.size(); i++)
                 kernelInfosMap[i] = std::make_pair(kernelInfos[i].kernelName, i);
             mapSort(kernelInfosMap.begin(), kernelInfosMap.end());
+            if ((creationFlags & BINARY_CREATE_NAMEHASHINDEX) != 0)
+                kernelInfosIndex.build(kernelInfosMap.begin(), kernelInfosMap.end());
         }
     }
     if ((creationFlags & AMDBIN_CREATE_KERNELHEADERS) != 0)
@@ -1320,24 +1374,43 @@ void AmdMainGPUBinaryBase::initMainGPUBinary(typename Types::ElfBinary& mainElf)
             for (size_t i = 0; i < kernelHeaders.size(); i++)
                 kernelHeaderMap[i] = std::make_pair(kernelHeaders[i].kernelName, i);
             mapSort(kernelHeaderMap.begin(), kernelHeaderMap.end());
+            if ((creationFlags & BINARY_CREATE_NAMEHASHINDEX) != 0)
+                kernelHeaderIndex.build(kernelHeaderMap.begin(), kernelHeaderMap.end());
         }
     }
 }
 
+void AmdMainGPUBinaryBase::initInnerBinary(size_t index) const
+{
+    const InnerBinaryEntry& entry = innerBinaryEntries[index];
+    if (entry.code != nullptr) // if binary has no '.text' then inner binary is empty
+        innerBinaries[index] = AmdInnerGPUBinary32(entry.kernelName, entry.size,
+                    entry.code, innerCreationFlags, true);
+}
+
+void AmdMainGPUBinaryBase::initKernelInfo(size_t index) const
+{
+    // parse AMDGPU kernel metadata
+    parseAmdGpuKernelMetadata(metadatas[index].size, metadatas[index].data,
+                kernelInfos[index]);
+}
+
 const AmdInnerGPUBinary32& AmdMainGPUBinaryBase::getInnerBinary(const char* name) const
 {
-    InnerBinaryMap::const_iterator it = binaryMapFind(innerBinaryMap.begin(),
-                  innerBinaryMap.end(), name);
+    InnerBinaryMap::const_iterator it = innerBinaryIndex.empty() ?
+        binaryMapFind(innerBinaryMap.begin(), innerBinaryMap.end(), name) :
+        innerBinaryIndex.find(innerBinaryMap.begin(), innerBinaryMap.end(), name);
     if (it == innerBinaryMap.end())
         throw BinException("Can't find inner binary");
-    return innerBinaries[it->second];
+    return getInnerBinary(it->second);
 }
 
 const AmdGPUKernelHeader& AmdMainGPUBinaryBase::getKernelHeaderEntry(
             const char* name) const
 {
-    KernelHeaderMap::const_iterator it = binaryMapFind(kernelHeaderMap.begin(),
-                   kernelHeaderMap.end(), name);
+    KernelHeaderMap::const_iterator it = kernelHeaderIndex.empty() ?
+        binaryMapFind(kernelHeaderMap.begin(), kernelHeaderMap.end(), name) :
+        kernelHeaderIndex.find(kernelHeaderMap.begin(), kernelHeaderMap.end(), name);
     if (it == kernelHeaderMap.end())
         throw BinException("Can't find kernel header");
     return kernelHeaders[it->second];
@@ -1346,10 +1419,12 @@ const AmdGPUKernelHeader& AmdMainGPUBinaryBase::getKernelHeaderEntry(
 /* AmdMainGPUBinary32 */
 
 AmdMainGPUBinary32::AmdMainGPUBinary32(size_t binaryCodeSize, cxbyte* binaryCode,
-       Flags creationFlags) : AmdMainGPUBinaryBase(AmdMainType::GPU_BINARY),
-          ElfBinary32(binaryCodeSize, binaryCode, creationFlags)
+       Flags creationFlags, uint64_t expectedChecksum, const BinaryIndex* index)
+       : AmdMainGPUBinaryBase(AmdMainType::GPU_BINARY),
+          ElfBinary32(binaryCodeSize, binaryCode, creationFlags, expectedChecksum,
+                  false, index)
 {
-    initMainGPUBinary<AmdGPU32Types>(*this);
+    initMainGPUBinary<AmdGPU32Types>(*this, index);
 }
 
 struct CLRX_INTERNAL GPUDeviceCodeEntry
@@ -1385,7 +1460,7 @@ static const GPUDeviceCodeEntry gpuDeviceCodeTable[19] =
 static const cxuint gpuDeviceCodeTableSize =
             sizeof(gpuDeviceCodeTable)/sizeof(GPUDeviceCodeEntry);
 
-static GPUDeviceType findGPUDeviceType(uint16_t elfMachine)
+GPUDeviceType CLRX::getAmdGPUDeviceTypeFromElfMachine(uint16_t elfMachine)
 {
     cxuint index = binaryFind(gpuDeviceCodeTable,
         gpuDeviceCodeTable+gpuDeviceCodeTableSize, { elfMachine },
@@ -1398,21 +1473,23 @@ static GPUDeviceType findGPUDeviceType(uint16_t elfMachine)
 
 GPUDeviceType AmdMainGPUBinary32::determineGPUDeviceType() const
 {
-    return findGPUDeviceType(ULEV(getHeader().e_machine));
+    return getAmdGPUDeviceTypeFromElfMachine(ULEV(getHeader().e_machine));
 }
 
 /* AmdMainGPUBinary64 */
 
 AmdMainGPUBinary64::AmdMainGPUBinary64(size_t binaryCodeSize, cxbyte* binaryCode,
-       Flags creationFlags) : AmdMainGPUBinaryBase(AmdMainType::GPU_64_BINARY),
-          ElfBinary64(binaryCodeSize, binaryCode, creationFlags)
+       Flags creationFlags, uint64_t expectedChecksum, const BinaryIndex* index)
+       : AmdMainGPUBinaryBase(AmdMainType::GPU_64_BINARY),
+          ElfBinary64(binaryCodeSize, binaryCode, creationFlags, expectedChecksum,
+                  false, index)
 {
-    initMainGPUBinary<AmdGPU64Types>(*this);
+    initMainGPUBinary<AmdGPU64Types>(*this, index);
 }
 
 GPUDeviceType AmdMainGPUBinary64::determineGPUDeviceType() const
 {
-    return findGPUDeviceType(ULEV(getHeader().e_machine));
+    return getAmdGPUDeviceTypeFromElfMachine(ULEV(getHeader().e_machine));
 }
 
 /* AmdMainX86Binary32 */
@@ -1426,12 +1503,15 @@ void AmdMainX86Binary32::initKernelInfos(Flags creationFlags)
         for (size_t i = 0; i < kernelInfos.size(); i++)
             kernelInfosMap[i] = std::make_pair(kernelInfos[i].kernelName, i);
         mapSort(kernelInfosMap.begin(), kernelInfosMap.end());
+        if ((creationFlags & BINARY_CREATE_NAMEHASHINDEX) != 0)
+            kernelInfosIndex.build(kernelInfosMap.begin(), kernelInfosMap.end());
     }
 }
 
 AmdMainX86Binary32::AmdMainX86Binary32(size_t binaryCodeSize, cxbyte* binaryCode,
-       Flags creationFlags) : AmdMainBinaryBase(AmdMainType::X86_BINARY),
-       ElfBinary32(binaryCodeSize, binaryCode, creationFlags)
+       Flags creationFlags, uint64_t expectedChecksum)
+       : AmdMainBinaryBase(AmdMainType::X86_BINARY),
+       ElfBinary32(binaryCodeSize, binaryCode, creationFlags, expectedChecksum)
 {
     cxuint textIndex = SHN_UNDEF;
     try
@@ -1511,12 +1591,15 @@ void AmdMainX86Binary64::initKernelInfos(Flags creationFlags)
         for (size_t i = 0; i < kernelInfos.size(); i++)
             kernelInfosMap[i] = std::make_pair(kernelInfos[i].kernelName, i);
         mapSort(kernelInfosMap.begin(), kernelInfosMap.end());
+        if ((creationFlags & BINARY_CREATE_NAMEHASHINDEX) != 0)
+            kernelInfosIndex.build(kernelInfosMap.begin(), kernelInfosMap.end());
     }
 }
 
 AmdMainX86Binary64::AmdMainX86Binary64(size_t binaryCodeSize, cxbyte* binaryCode,
-       Flags creationFlags) : AmdMainBinaryBase(AmdMainType::X86_64_BINARY),
-       ElfBinary64(binaryCodeSize, binaryCode, creationFlags)
+       Flags creationFlags, uint64_t expectedChecksum)
+       : AmdMainBinaryBase(AmdMainType::X86_64_BINARY),
+       ElfBinary64(binaryCodeSize, binaryCode, creationFlags, expectedChecksum)
 {
     cxuint textIndex = SHN_UNDEF;
     try
@@ -1611,7 +1694,7 @@ bool CLRX::isAmdBinary(size_t binarySize, const cxbyte* binary)
 /* create amd binary */
 
 AmdMainBinaryBase* CLRX::createAmdBinaryFromCode(size_t binaryCodeSize, cxbyte* binaryCode,
-        Flags creationFlags)
+        Flags creationFlags, uint64_t expectedChecksum)
 {
     // checking whether is AMDOCL binary (little endian and ELF magic)
     if (binaryCodeSize < sizeof(Elf32_Ehdr) ||
@@ -1625,15 +1708,19 @@ AmdMainBinaryBase* CLRX::createAmdBinaryFromCode(size_t binaryCodeSize, cxbyte*
     {
         const Elf32_Ehdr* ehdr = reinterpret_cast<const Elf32_Ehdr*>(binaryCode);
         if (ULEV(ehdr->e_machine) != ELF_M_X86) //if gpu
-            return new AmdMainGPUBinary32(binaryCodeSize, binaryCode, creationFlags);
-        return new AmdMainX86Binary32(binaryCodeSize, binaryCode, creationFlags);
+            return new AmdMainGPUBinary32(binaryCodeSize, binaryCode, creationFlags,
+                        expectedChecksum);
+        return new AmdMainX86Binary32(binaryCodeSize, binaryCode, creationFlags,
+                        expectedChecksum);
     }
     else if (binaryCode[EI_CLASS] == ELFCLASS64)
     {
         const Elf64_Ehdr* ehdr = reinterpret_cast<const Elf64_Ehdr*>(binaryCode);
         if (ULEV(ehdr->e_machine) != ELF_M_X86)
-            return new AmdMainGPUBinary64(binaryCodeSize, binaryCode, creationFlags);
-        return new AmdMainX86Binary64(binaryCodeSize, binaryCode, creationFlags);
+            return new AmdMainGPUBinary64(binaryCodeSize, binaryCode, creationFlags,
+                        expectedChecksum);
+        return new AmdMainX86Binary64(binaryCodeSize, binaryCode, creationFlags,
+                        expectedChecksum);
     }
     else // fatal error
         throw BinException("Unsupported ELF class");
@@ -29,6 +29,7 @@
 #include <CLRX/utils/MemAccess.h>
 #include <CLRX/utils/GPUId.h>
 #include <CLRX/amdbin/AmdCL2Binaries.h>
+#include <CLRX/amdbin/BinaryIndex.h>
 
 using namespace CLRX;
 
@@ -37,13 +38,46 @@ using namespace CLRX;
 AmdCL2InnerGPUBinaryBase::~AmdCL2InnerGPUBinaryBase()
 { }
 
-const AmdCL2GPUKernel& AmdCL2InnerGPUBinaryBase::getKernelData(const char* name) const
+void AmdCL2InnerGPUBinaryBase::initKernelEntries(size_t kernelsNum, bool createMap,
+                bool createIndex)
+{
+    kernelEntries.resize(kernelsNum);
+    kernelOnceFlags.reset(new OnceFlag[kernelsNum]);
+    if (createMap)
+        kernelDataMapOnceFlag.reset(new OnceFlag());
+    kernelDataIndexCreated = createIndex;
+}
+
+void AmdCL2InnerGPUBinaryBase::initKernelData(size_t index) const
+{ }
+
+void AmdCL2InnerGPUBinaryBase::initKernelDataMap() const
+{
+    kernelDataMap.resize(kernelEntries.size());
+    for (size_t i = 0; i < kernelEntries.size(); i++)
+        kernelDataMap[i] = std::make_pair(CString(kernelEntries[i].name,
+                    kernelEntries[i].nameLength), i);
+    mapSort(kernelDataMap.begin(), kernelDataMap.end());
+    if (kernelDataIndexCreated)
+        kernelDataIndex.build(kernelDataMap.begin(), kernelDataMap.end());
+}
+
+size_t AmdCL2InnerGPUBinaryBase::findKernel(const char* name) const
 {
-    KernelDataMap::const_iterator it = binaryMapFind(
-            kernelDataMap.begin(), kernelDataMap.end(), name);
+    // kernel data map is created at first access
+    if (kernelDataMapOnceFlag)
+        callOnce(*kernelDataMapOnceFlag, [this]() { initKernelDataMap(); });
+    KernelDataMap::const_iterator it = kernelDataIndex.empty() ?
+            binaryMapFind(kernelDataMap.begin(), kernelDataMap.end(), name) :
+            kernelDataIndex.find(kernelDataMap.begin(), kernelDataMap.end(), name);
     if (it == kernelDataMap.end())
         throw BinException("Can't find kernel name");
-    return kernels[it->second];
+    return it->second;
+}
+
+const AmdCL2GPUKernel& AmdCL2InnerGPUBinaryBase::getKernelData(const char* name) const
+{
+    return getKernelData(findKernel(name));
 }
 
 /* AmdCL2OldInnerGPUBinary */
@@ -72,81 +106,80 @@ AmdCL2OldInnerGPUBinary::AmdCL2OldInnerGPUBinary(ElfBinaryTemplate<Types>* mainB
             continue;
         choosenSyms.push_back(i);
     }
-    // allocate structures
+    // allocate structures (kernel datas and stubs are created at first access)
     if (hasKernelData())
         kernels.resize(choosenSyms.size());
     if (hasKernelStubs())
         kernelStubs.reset(new AmdCL2GPUKernelStub[choosenSyms.size()]);
-    if (hasKernelDataMap())
-        kernelDataMap.resize(choosenSyms.size());
+    initKernelEntries(choosenSyms.size(), hasKernelDataMap(),
+                (creationFlags & BINARY_CREATE_NAMEHASHINDEX) != 0);
     
     size_t ki = 0;
-    // main loop for kernel data and stub getting
+    // main loop to check places of kernels
     for (size_t index: choosenSyms)
     {
         const typename Types::Sym& sym = mainBinary->getSymbol(index);
         const char* symName = mainBinary->getSymbolName(index);
         const size_t binOffset = ULEV(sym.st_value);
         const size_t binSize = ULEV(sym.st_size);
-        /// check conditions for symbol
-        if (textIndex != ULEV(sym.st_shndx))
-            throw BinException("Kernel symbol outside text section");
-        if (binOffset >= binaryCodeSize)
-            throw BinException("Kernel binary code offset out of range");
-        if (usumGt(binOffset, binSize, binaryCodeSize))
-            throw BinException("Kernel binary code offset and size out of range");
-        if (binSize < 256+192)
-            throw BinException("Kernel binary code size is too short");
+        /// check conditions for symbol (skipped for trusted binary)
+        if ((creationFlags & BINARY_CREATE_TRUSTED) == 0)
+        {
+            if (textIndex != ULEV(sym.st_shndx))
+                throw BinException("Kernel symbol outside text section");
+            if (binOffset >= binaryCodeSize)
+                throw BinException("Kernel binary code offset out of range");
+            if (usumGt(binOffset, binSize, binaryCodeSize))
+                throw BinException("Kernel binary code offset and size out of range");
+            if (binSize < 256+192)
+                throw BinException("Kernel binary code size is too short");
+        }
         
-        AmdCL2GPUKernelStub kernelStub;
-        AmdCL2GPUKernel kernelData;
-        // set data for stub
-        kernelStub.data = binaryCode + binOffset;
-        const size_t setupOffset = ULEV(*reinterpret_cast<uint32_t*>(kernelStub.data));
-        if (setupOffset >= binSize)
-            throw BinException("Kernel setup offset out of range");
-        // get size of setup (offset 16 of setup)
-        kernelStub.size = setupOffset;
-        kernelData.setup = kernelStub.data + setupOffset;
-        // get text (code) offset after setup (HSA config)
-        const size_t textOffset = ULEV(*reinterpret_cast<uint32_t*>(kernelData.setup+16));
-        if (usumGe(textOffset, setupOffset, binSize))
-            throw BinException("Kernel text offset out of range");
-        kernelData.setupSize = textOffset;
-        kernelData.code = kernelData.setup + textOffset;
-        kernelData.codeSize = binSize - (kernelData.code - kernelStub.data);
+        // kernel name in symbol name: '__ISA_&__OpenCL_XXXX_kernel_binary'
         const size_t len = ::strlen(symName);
-        const CString kernelName = CString(symName+16, symName+len-14);
-        kernelData.kernelName = kernelName;
-        // fill kernel data map and kernel stup info
-        if (hasKernelDataMap()) // kernel data map
-            kernelDataMap[ki] = std::make_pair(kernelName, ki);
-        
-        if (hasKernelStubs())
-            kernelStubs[ki] = kernelStub;
-        // put to kernels table
-        if (hasKernelData())
-            kernels[ki] = kernelData;
-        ki++;
+        kernelEntries[ki++] = { symName+16, len-30, binaryCode + binOffset, binSize };
     }
-    // sort kernel data map array
-    if (hasKernelDataMap())
-        mapSort(kernelDataMap.begin(), kernelDataMap.end());
+}
+
+void AmdCL2OldInnerGPUBinary::initKernelData(size_t index) const
+{
+    const KernelEntry& entry = kernelEntries[index];
+    AmdCL2GPUKernelStub kernelStub;
+    AmdCL2GPUKernel kernelData;
+    // set data for stub
+    kernelStub.data = entry.data;
+    const size_t setupOffset = ULEV(*reinterpret_cast<uint32_t*>(kernelStub.data));
+    if (setupOffset >= entry.size)
+        throw BinException("Kernel setup offset out of range");
+    // get size of setup (offset 16 of setup)
+    kernelStub.size = setupOffset;
+    kernelData.setup = kernelStub.data + setupOffset;
+    // get text (code) offset after setup (HSA config)
+    const size_t textOffset = ULEV(*reinterpret_cast<uint32_t*>(kernelData.setup+16));
+    if (usumGe(textOffset, setupOffset, entry.size))
+        throw BinException("Kernel text offset out of range");
+    kernelData.setupSize = textOffset;
+    kernelData.code = kernelData.setup + textOffset;
+    kernelData.codeSize = entry.size - (kernelData.code - kernelStub.data);
+    kernelData.kernelName.assign(entry.name, entry.nameLength);
+    
+    if (hasKernelStubs())
+        kernelStubs[index] = kernelStub;
+    // put to kernels table
+    if (hasKernelData())
+        kernels[index] = kernelData;
 }
 
 const AmdCL2GPUKernelStub& AmdCL2OldInnerGPUBinary::getKernelStub(const char* name) const
 {
-    KernelDataMap::const_iterator it = binaryMapFind(
-            kernelDataMap.begin(), kernelDataMap.end(), name);
-    if (it == kernelDataMap.end())
-        throw BinException("Can't find kernel name");
-    return kernelStubs[it->second];
+    return getKernelStub(findKernel(name));
 }
 
 /* AmdCL2InnerGPUBinary */
 
 AmdCL2InnerGPUBinary::AmdCL2InnerGPUBinary(size_t binaryCodeSize, cxbyte* binaryCode,
-            Flags creationFlags): ElfBinary64(binaryCodeSize, binaryCode, creationFlags),
+            Flags creationFlags, bool checksumVerified)
+            : ElfBinary64(binaryCodeSize, binaryCode, creationFlags, 0, checksumVerified),
             globalDataSize(0), globalData(nullptr), rwDataSize(0), rwData(nullptr),
             bssAlignment(0), bssSize(0), samplerInitSize(0), samplerInit(nullptr),
             textRelsNum(0), textRelEntrySize(0), textRela(nullptr),
@@ -169,48 +202,37 @@ AmdCL2InnerGPUBinary::AmdCL2InnerGPUBinary(size_t binaryCodeSize, cxbyte* binary
         }
         
         size_t ki = 0;
+        // kernel datas are created at first access
         kernels.resize(choosenSyms.size());
-        if (hasKernelDataMap())
-            kernelDataMap.resize(choosenSyms.size());
+        initKernelEntries(choosenSyms.size(), hasKernelDataMap(),
+                (creationFlags & BINARY_CREATE_NAMEHASHINDEX) != 0);
         
-        // main loop for kernel data getting
+        // main loop to check places of kernels
         for (size_t index: choosenSyms)
         {
             const Elf64_Sym& sym = getSymbol(index);
             const Elf64_Shdr& dataShdr = getSectionHeader(ULEV(sym.st_shndx));
-            if (ULEV(sym.st_shndx) >= getSectionHeadersNum())
-                throw BinException("Kernel section index out of range");
             const char* symName = getSymbolName(index);
             const size_t binOffset = ULEV(sym.st_value);
             const size_t binSize = ULEV(sym.st_size);
-            /// check conditions for symbol
-            if (binOffset >= ULEV(dataShdr.sh_size))
-                throw BinException("Kernel binary code offset out of range");
-            if (usumGt(binOffset, binSize, ULEV(dataShdr.sh_size)))
-                throw BinException("Kernel binary code offset and size out of range");
-            if (binSize < 192)
-                throw BinException("Kernel binary code size is too short");
-            
-            kernels[ki].setup = binaryCode + ULEV(dataShdr.sh_offset) + binOffset;
-            // get size of setup (offset 16 of setup) and code offset
-            const size_t textOffset = ULEV(*reinterpret_cast<uint32_t*>(
-                            kernels[ki].setup+16));
+            /// check conditions for symbol (skipped for trusted binary)
+            if ((creationFlags & BINARY_CREATE_TRUSTED) == 0)
+            {
+                if (ULEV(sym.st_shndx) >= getSectionHeadersNum())
+                    throw BinException("Kernel section index out of range");
+                if (binOffset >= ULEV(dataShdr.sh_size))
+                    throw BinException("Kernel binary code offset out of range");
+                if (usumGt(binOffset, binSize, ULEV(dataShdr.sh_size)))
+                    throw BinException("Kernel binary code offset and size out of range");
+                if (binSize < 192)
+                    throw BinException("Kernel binary code size is too short");
+            }
             
-            if (textOffset >= binSize)
-                throw BinException("Kernel text offset out of range");
-            kernels[ki].setupSize = textOffset;
-            kernels[ki].code = kernels[ki].setup + textOffset;
-            kernels[ki].codeSize = binSize-textOffset;
             const size_t len = ::strlen(symName);
-            // kernel name in string in form: '__OpenCL_XXXX_kernel', get name
-            kernels[ki].kernelName = CString(symName+10, symName+len-7);
-            if (hasKernelDataMap()) // kernel data map
-                kernelDataMap[ki] = std::make_pair(kernels[ki].kernelName, ki);
-            ki++;
+            // kernel name in string in form: '&__OpenCL_XXXX_kernel', get name
+            kernelEntries[ki++] = { symName+10, len-17,
+                    binaryCode + ULEV(dataShdr.sh_offset) + binOffset, binSize };
         }
-        // sort kernel data map
-        if (hasKernelDataMap())
-            mapSort(kernelDataMap.begin(), kernelDataMap.end());
     }
     // get global data - from section
     try
@@ -278,6 +300,22 @@ AmdCL2InnerGPUBinary::AmdCL2InnerGPUBinary(size_t binaryCodeSize, cxbyte* binary
     { }
 }
 
+void AmdCL2InnerGPUBinary::initKernelData(size_t index) const
+{
+    const KernelEntry& entry = kernelEntries[index];
+    AmdCL2GPUKernel& kernel = kernels[index];
+    kernel.setup = entry.data;
+    // get size of setup (offset 16 of setup) and code offset
+    const size_t textOffset = ULEV(*reinterpret_cast<uint32_t*>(kernel.setup+16));
+    
+    if (textOffset >= entry.size)
+        throw BinException("Kernel text offset out of range");
+    kernel.setupSize = textOffset;
+    kernel.code = kernel.setup + textOffset;
+    kernel.codeSize = entry.size-textOffset;
+    kernel.kernelName.assign(entry.name, entry.nameLength);
+}
+
 /* AmdCL2MainGPUBinary64 */
 
 /// argument type vector table for OpenCL 2.0 binary format
@@ -332,9 +370,10 @@ static const cxuint vectorIdTable[17] =
 { UINT_MAX, 0, 1, 2, 3, UINT_MAX, UINT_MAX, UINT_MAX, 4,
   UINT_MAX, UINT_MAX, UINT_MAX, UINT_MAX, UINT_MAX, UINT_MAX, UINT_MAX, 5 };
 
+// get kernel header from metadata, returns offset of kernel argument entries
 template<typename Types>
-static void getCL2KernelInfo(size_t metadataSize, cxbyte* metadata,
-             KernelInfo& kernelInfo, AmdGPUKernelHeader& kernelHeader, bool& crimson16)
+static size_t getCL2KernelHeader(size_t metadataSize, cxbyte* metadata,
+             AmdGPUKernelHeader& kernelHeader, bool& crimson16)
 {
     crimson16 = false;
     if (metadataSize < 8+32+32)
@@ -349,7 +388,6 @@ static void getCL2KernelInfo(size_t metadataSize, cxbyte* metadata,
     if (kernelHeader.size < sizeof(typename Types::MetadataHeader))
         throw BinException("Metadata header is too short");
     kernelHeader.data = metadata;
-    const uint32_t argsNum = ULEV(hdrStruc->argsNum);
     size_t vecTypeHintLength = 0;
     if (kernelHeader.size >= Types::newMetadataHeaderSize)
     {
@@ -373,6 +411,20 @@ static void getCL2KernelInfo(size_t metadataSize, cxbyte* metadata,
         crimson16 = true;
         argOffset += vecTypeHintLength + 1;
     }
+    return argOffset;
+}
+
+// get kernel arguments from metadata
+template<typename Types>
+static void getCL2KernelInfo(size_t metadataSize, cxbyte* metadata, KernelInfo& kernelInfo)
+{
+    AmdGPUKernelHeader kernelHeader;
+    bool crimson16;
+    const size_t argOffset = getCL2KernelHeader<Types>(metadataSize, metadata,
+                kernelHeader, crimson16);
+    const typename Types::MetadataHeader* hdrStruc =
+            reinterpret_cast<const typename Types::MetadataHeader*>(metadata);
+    const uint32_t argsNum = ULEV(hdrStruc->argsNum);
     const typename Types::KernelArgEntry* argPtr = reinterpret_cast<
             const typename Types::KernelArgEntry*>(metadata + argOffset);
     
@@ -541,7 +593,9 @@ AmdCL2MainGPUBinaryBase::AmdCL2MainGPUBinaryBase(AmdMainType mainType)
 const AmdCL2GPUKernelMetadata& AmdCL2MainGPUBinaryBase::getMetadataEntry(
                     const char* name) const
 {
-    auto it = binaryMapFind(kernelInfosMap.begin(), kernelInfosMap.end(), name);
+    auto it = kernelInfosIndex.empty() ?
+        binaryMapFind(kernelInfosMap.begin(), kernelInfosMap.end(), name) :
+        kernelInfosIndex.find(kernelInfosMap.begin(), kernelInfosMap.end(), name);
     if (it == kernelInfosMap.end())
         throw BinException("Can't find kernel metadata by name");
     return metadatas[it->second];
@@ -550,21 +604,48 @@ const AmdCL2GPUKernelMetadata& AmdCL2MainGPUBinaryBase::getMetadataEntry(
 const AmdCL2GPUKernelMetadata& AmdCL2MainGPUBinaryBase::getISAMetadataEntry(
                     const char* name) const
 {
-    auto it = binaryMapFind(isaMetadataMap.begin(), isaMetadataMap.end(), name);
+    auto it = isaMetadataIndex.empty() ?
+        binaryMapFind(isaMetadataMap.begin(), isaMetadataMap.end(), name) :
+        isaMetadataIndex.find(isaMetadataMap.begin(), isaMetadataMap.end(), name);
     if (it == isaMetadataMap.end())
         throw BinException("Can't find kernel ISA metadata by name");
     return isaMetadatas[it->second];
 }
 
+// detect driver version from new inner binary
+static cxuint getNewInnerBinaryDriverVersion(const ElfBinary64& innerBin)
+{
+    // detect new format from Crimson 16.4
+    cxuint driverVersion = (innerBin.getSymbolsNum()!=0 &&
+            innerBin.getSymbolName(0)[0]==0) ? 200406 : 191205;
+    try
+    {
+        // special detection for first AMDGPU-PRO driver (may be bug in driver)
+        const Elf64_Shdr& noteShdr = innerBin.getSectionHeader(".note");
+        const cxbyte* noteContent = innerBin.getSectionContent(".note");
+        const size_t noteSize = ULEV(noteShdr.sh_size);
+        if (noteSize == 200 && noteContent[197]!=0)
+            driverVersion = 203603;
+    }
+    catch(const Exception& ex)
+    { }
+    return driverVersion;
+}
+
 template<typename Types>
-void AmdCL2MainGPUBinaryBase::initMainGPUBinary(typename Types::ElfBinary& elfBin)
+void AmdCL2MainGPUBinaryBase::initMainGPUBinary(typename Types::ElfBinary& elfBin,
+            const BinaryIndex* binIndex)
 {
+    if (binIndex != nullptr && binIndex->getFormat() != BinaryProbeFormat::AMDCL2)
+        throw BinException("Binary index is not for AMD OpenCL 2.0 binary");
     std::vector<size_t> choosenMetadataSyms;
     std::vector<size_t> choosenISAMetadataSyms;
     std::vector<size_t> choosenBinSyms;
     
     Flags creationFlags = elfBin.getCreationFlags();
     cxbyte* binaryCode = elfBin.getBinaryCode();
+    // skip bound checks for trusted binary
+    const bool trusted = (creationFlags & BINARY_CREATE_TRUSTED) != 0;
     
     const size_t symbolsNum = elfBin.getSymbolsNum();
     
@@ -577,17 +658,20 @@ void AmdCL2MainGPUBinaryBase::initMainGPUBinary(typename Types::ElfBinary& elfBi
             {
                 // compile options
                 const typename Types::Sym& sym = elfBin.getSymbol(i);
-                if (ULEV(sym.st_shndx) >= elfBin.getSectionHeadersNum())
+                if (!trusted && ULEV(sym.st_shndx) >= elfBin.getSectionHeadersNum())
                     throw BinException("Compiler options section header out of range");
                 const typename Types::Shdr& shdr =
                             elfBin.getSectionHeader(ULEV(sym.st_shndx));
                 const size_t coOffset = ULEV(sym.st_value);
                 const size_t coSize = ULEV(sym.st_size);
                 // checking compile options offset and size
-                if (coOffset >= ULEV(shdr.sh_size))
-                    throw BinException("Compiler options offset out of range");
-                if (usumGt(coOffset, coSize, ULEV(shdr.sh_size)))
-                    throw BinException("Compiler options offset and size out of range");
+                if (!trusted)
+                {
+                    if (coOffset >= ULEV(shdr.sh_size))
+                        throw BinException("Compiler options offset out of range");
+                    if (usumGt(coOffset, coSize, ULEV(shdr.sh_size)))
+                        throw BinException("Compiler options offset and size out of range");
+                }
                 
                 const char* coData = reinterpret_cast<const char*>(binaryCode) +
                             ULEV(shdr.sh_offset) + coOffset;
@@ -597,17 +681,20 @@ void AmdCL2MainGPUBinaryBase::initMainGPUBinary(typename Types::ElfBinary& elfBi
             {
                 // acl version string
                 const typename Types::Sym& sym = elfBin.getSymbol(i);
-                if (ULEV(sym.st_shndx) >= elfBin.getSectionHeadersNum())
+                if (!trusted && ULEV(sym.st_shndx) >= elfBin.getSectionHeadersNum())
                     throw BinException("AclVersionString section header out of range");
                 const typename Types::Shdr& shdr =
                         elfBin.getSectionHeader(ULEV(sym.st_shndx));
                 const size_t aclOffset = ULEV(sym.st_value);
                 const size_t aclSize = ULEV(sym.st_size);
                 // checking acl offset and acl size
-                if (aclOffset >= ULEV(shdr.sh_size))
-                    throw BinException("AclVersionString offset out of range");
-                if (usumGt(aclOffset, aclSize, ULEV(shdr.sh_size)))
-                    throw BinException("AclVersionString offset and size out of range");
+                if (!trusted)
+                {
+                    if (aclOffset >= ULEV(shdr.sh_size))
+                        throw BinException("AclVersionString offset out of range");
+                    if (usumGt(aclOffset, aclSize, ULEV(shdr.sh_size)))
+                        throw BinException("AclVersionString offset and size out of range");
+                }
                 
                 const char* aclVersionData = reinterpret_cast<const char*>(binaryCode) +
                             ULEV(shdr.sh_offset) + aclOffset;
@@ -651,33 +738,23 @@ void AmdCL2MainGPUBinaryBase::initMainGPUBinary(typename Types::ElfBinary& elfBi
         {
             innerBinary.reset(new AmdCL2InnerGPUBinary(ULEV(textShdr.sh_size),
                            binaryCode + ULEV(textShdr.sh_offset),
-                           creationFlags >> AMDBIN_INNER_SHIFT));
-            // detect new format from Crimson 16.4
-            const auto& innerBin = getInnerBinary();
-            driverVersion = (innerBin.getSymbolsNum()!=0 &&
-                    innerBin.getSymbolName(0)[0]==0) ? 200406 : 191205;
-            try
-            {
-                // special detection for first AMDGPU-PRO driver (may be bug in driver)
-                const Elf64_Shdr& noteShdr = innerBin.getSectionHeader(".note");
-                const cxbyte* noteContent = innerBin.getSectionContent(".note");
-                const size_t noteSize = ULEV(noteShdr.sh_size);
-                if (noteSize == 200 && noteContent[197]!=0)
-                    driverVersion = 203603;
-            }
-            catch(const Exception& ex)
-            { }
+                           (creationFlags >> AMDBIN_INNER_SHIFT) |
+                           (creationFlags & BINARY_CREATE_COMMON), true));
+            driverVersion = getNewInnerBinaryDriverVersion(getInnerBinary());
         }
         else // old driver
             innerBinary.reset(new AmdCL2OldInnerGPUBinary(&elfBin, ULEV(textShdr.sh_size),
                            binaryCode + ULEV(textShdr.sh_offset),
-                           creationFlags >> AMDBIN_INNER_SHIFT));
+                           (creationFlags >> AMDBIN_INNER_SHIFT) |
+                           (creationFlags & BINARY_CREATE_COMMON)));
     }
     
     // get metadata
     if ((creationFlags & AMDBIN_CREATE_KERNELINFO) != 0)
     {
+        // kernel arguments are parsed at first access to kernel info
         kernelInfos.resize(choosenMetadataSyms.size());
+        kernelInfoOnceFlags.reset(new OnceFlag[choosenMetadataSyms.size()]);
         kernelHeaders.reset(new AmdGPUKernelHeader[choosenMetadataSyms.size()]);
         if ((creationFlags & AMDBIN_CREATE_KERNELINFOMAP) != 0)
         {
@@ -692,27 +769,29 @@ void AmdCL2MainGPUBinaryBase::initMainGPUBinary(typename Types::ElfBinary& elfBi
         {
             const typename Types::Sym& mtsym = elfBin.getSymbol(index);
             const char* mtName = elfBin.getSymbolName(index);
-            if (ULEV(mtsym.st_shndx) >= elfBin.getSectionHeadersNum())
+            if (!trusted && ULEV(mtsym.st_shndx) >= elfBin.getSectionHeadersNum())
                 throw BinException("Kernel Metadata section header out of range");
             const typename Types::Shdr& shdr =
                     elfBin.getSectionHeader(ULEV(mtsym.st_shndx));
             const size_t mtOffset = ULEV(mtsym.st_value);
             const size_t mtSize = ULEV(mtsym.st_size);
             /// offset and size verifying
-            if (mtOffset >= ULEV(shdr.sh_size))
-                throw BinException("Kernel Metadata offset out of range");
-            if (usumGt(mtOffset, mtSize, ULEV(shdr.sh_size)))
-                throw BinException("Kernel Metadata offset and size out of range");
+            if (!trusted)
+            {
+                if (mtOffset >= ULEV(shdr.sh_size))
+                    throw BinException("Kernel Metadata offset out of range");
+                if (usumGt(mtOffset, mtSize, ULEV(shdr.sh_size)))
+                    throw BinException("Kernel Metadata offset and size out of range");
+            }
             
             cxbyte* metadata = binaryCode + ULEV(shdr.sh_offset) + mtOffset;
             bool crimson16 = false;
-            getCL2KernelInfo<Types>(mtSize, metadata, kernelInfos[ki],
-                                        kernelHeaders[ki], crimson16);
+            getCL2KernelHeader<Types>(mtSize, metadata, kernelHeaders[ki], crimson16);
             size_t len = ::strlen(mtName);
             // set kernel name from symbol name (__OpenCL_&__OpenCL_[name]_kernel_metadata)
             kernelHeaders[ki].kernelName = kernelInfos[ki].kernelName =
                         CString(mtName+19, mtName+len-16);
-            if ((creationFlags & AMDBIN_CREATE_KERNELINFOMAP) != 0)
+            if ((creationFlags & AMDBIN_CREATE_KERNELINFOMAP) != 0 && binIndex == nullptr)
                 kernelInfosMap[ki] = std::make_pair(kernelInfos[ki].kernelName, ki);
             metadatas[ki] = { kernelInfos[ki].kernelName, mtSize, metadata };
             ki++;
@@ -726,17 +805,20 @@ void AmdCL2MainGPUBinaryBase::initMainGPUBinary(typename Types::ElfBinary& elfBi
         {
             const typename Types::Sym& mtsym = elfBin.getSymbol(index);
             const char* mtName = elfBin.getSymbolName(index);
-            if (ULEV(mtsym.st_shndx) >= elfBin.getSectionHeadersNum())
+            if (!trusted && ULEV(mtsym.st_shndx) >= elfBin.getSectionHeadersNum())
                 throw BinException("Kernel ISAMetadata section header out of range");
             const typename Types::Shdr& shdr =
                         elfBin.getSectionHeader(ULEV(mtsym.st_shndx));
             const size_t mtOffset = ULEV(mtsym.st_value);
             const size_t mtSize = ULEV(mtsym.st_size);
             /// offset and size verifying
-            if (mtOffset >= ULEV(shdr.sh_size))
-                throw BinException("Kernel ISAMetadata offset out of range");
-            if (usumGt(mtOffset, mtSize, ULEV(shdr.sh_size)))
-                throw BinException("Kernel ISAMetadata offset and size out of range");
+            if (!trusted)
+            {
+                if (mtOffset >= ULEV(shdr.sh_size))
+                    throw BinException("Kernel ISAMetadata offset out of range");
+                if (usumGt(mtOffset, mtSize, ULEV(shdr.sh_size)))
+                    throw BinException("Kernel ISAMetadata offset and size out of range");
+            }
             
             cxbyte* metadata = binaryCode + ULEV(shdr.sh_offset) + mtOffset;
             size_t len = ::strlen(mtName);
@@ -749,12 +831,105 @@ void AmdCL2MainGPUBinaryBase::initMainGPUBinary(typename Types::ElfBinary& elfBi
         // sort kernel info map and isa metadata map (are arrays)
         if ((creationFlags & AMDBIN_CREATE_KERNELINFOMAP) != 0)
         {
-            mapSort(kernelInfosMap.begin(), kernelInfosMap.end());
+            if (binIndex != nullptr)
+            {
+                // kernels in index are in order of kernel infos
+                if (binIndex->getKernelsNum() != kernelInfos.size())
+                    throw BinException("Binary index doesn't match kernel infos");
+                kernelInfosMap = binIndex->getKernelMap();
+            }
+            else
+                mapSort(kernelInfosMap.begin(), kernelInfosMap.end());
             mapSort(isaMetadataMap.begin(), isaMetadataMap.end());
+            if ((creationFlags & BINARY_CREATE_NAMEHASHINDEX) != 0)
+            {
+                kernelInfosIndex.build(kernelInfosMap.begin(), kernelInfosMap.end());
+                isaMetadataIndex.build(isaMetadataMap.begin(), isaMetadataMap.end());
+            }
         }
     }
 }
 
+template<typename Types>
+static cxuint detectAmdCL2DriverVersionInt(const typename Types::ElfBinary& elfBin)
+{
+    // skip bound checks for trusted binary
+    const bool trusted = (elfBin.getCreationFlags() & BINARY_CREATE_TRUSTED) != 0;
+    bool newInnerBinary = true;
+    bool crimson16 = false;
+    const size_t symbolsNum = elfBin.getSymbolsNum();
+    for (size_t i = 0; i < symbolsNum; i++)
+    {
+        const char* symName = elfBin.getSymbolName(i);
+        const size_t len = ::strlen(symName);
+        if (len >= 30 && ::strncmp(symName, "__ISA_&__OpenCL_", 16) == 0 &&
+                ::strcmp(symName+len-14, "_kernel_binary") == 0)
+            newInnerBinary = false; // old inner binary
+        else if (len >= 35 && ::strncmp(symName, "__OpenCL_&__OpenCL_", 19) == 0 &&
+                ::strcmp(symName+len-16, "_kernel_metadata") == 0)
+        {
+            // check kernel metadata header (whether from AMD Crimson 16)
+            const typename Types::Sym& mtsym = elfBin.getSymbol(i);
+            if (!trusted && ULEV(mtsym.st_shndx) >= elfBin.getSectionHeadersNum())
+                throw BinException("Kernel Metadata section header out of range");
+            const typename Types::Shdr& shdr =
+                    elfBin.getSectionHeader(ULEV(mtsym.st_shndx));
+            const size_t mtOffset = ULEV(mtsym.st_value);
+            const size_t mtSize = ULEV(mtsym.st_size);
+            if (!trusted)
+            {
+                if (mtOffset >= ULEV(shdr.sh_size))
+                    throw BinException("Kernel Metadata offset out of range");
+                if (usumGt(mtOffset, mtSize, ULEV(shdr.sh_size)))
+                    throw BinException("Kernel Metadata offset and size out of range");
+            }
+            AmdGPUKernelHeader kernelHeader;
+            bool kernelCrimson16 = false;
+            getCL2KernelHeader<Types>(mtSize, const_cast<cxbyte*>(elfBin.getBinaryCode()) +
+                    ULEV(shdr.sh_offset) + mtOffset, kernelHeader, kernelCrimson16);
+            crimson16 |= kernelCrimson16;
+        }
+    }
+    
+    cxuint driverVersion = 180005;
+    uint16_t textIndex = SHN_UNDEF;
+    try
+    { textIndex = elfBin.getSectionIndex(".text"); }
+    catch(const Exception& ex)
+    { }
+    if (textIndex != SHN_UNDEF && newInnerBinary)
+    {
+        const typename Types::Shdr& textShdr = elfBin.getSectionHeader(textIndex);
+        // only headers and symbol table of inner binary
+        const ElfBinary64 innerBin(ULEV(textShdr.sh_size),
+                const_cast<cxbyte*>(elfBin.getBinaryCode()) + ULEV(textShdr.sh_offset),
+                elfBin.getCreationFlags() & BINARY_CREATE_TRUSTED, 0, true);
+        driverVersion = getNewInnerBinaryDriverVersion(innerBin);
+    }
+    if (crimson16 && driverVersion < 200406) // if AMD Crimson 16
+        driverVersion = 200406;
+    return driverVersion;
+}
+
+cxuint CLRX::detectAmdCL2DriverVersion(const ElfBinary32& elfBin)
+{
+    return detectAmdCL2DriverVersionInt<AmdCL2Types32>(elfBin);
+}
+
+cxuint CLRX::detectAmdCL2DriverVersion(const ElfBinary64& elfBin)
+{
+    return detectAmdCL2DriverVersionInt<AmdCL2Types64>(elfBin);
+}
+
+void AmdCL2MainGPUBinaryBase::initKernelInfo(size_t index) const
+{
+    const AmdCL2GPUKernelMetadata& metadata = metadatas[index];
+    if (type == AmdMainType::GPU_CL2_BINARY)
+        getCL2KernelInfo<AmdCL2Types32>(metadata.size, metadata.data, kernelInfos[index]);
+    else
+        getCL2KernelInfo<AmdCL2Types64>(metadata.size, metadata.data, kernelInfos[index]);
+}
+
 /* helpers for determing gpu device type */
 
 struct CLRX_INTERNAL CL2GPUDeviceCodeEntry
@@ -1029,21 +1204,13 @@ static const GPUDeviceType gpuGFX9SteppingTable[] =
     GPUDeviceType::GFX907
 };
 
-template<typename Types>
-GPUDeviceType AmdCL2MainGPUBinaryBase::determineGPUDeviceTypeInt(
-        const typename Types::ElfBinary& binary, uint32_t& outArchMinor,
-        uint32_t& outArchStepping, cxuint inDriverVersion) const
+GPUDeviceType CLRX::determineAmdCL2GPUDeviceType(uint32_t elfFlags,
+        cxuint inputDriverVersion, const ElfBinary64* innerBin,
+        uint32_t& outArchMinor, uint32_t& outArchStepping)
 {
-    const uint32_t elfFlags = ULEV(binary.getHeader().e_flags);
-    
     // detect GPU device from elfMachine field from ELF header
     cxuint entriesNum = 0;
     const CL2GPUDeviceCodeEntry* gpuCodeTable = nullptr;
-    cxuint inputDriverVersion = 0;
-    if (inDriverVersion == 0)
-        inputDriverVersion = this->driverVersion;
-    else
-        inputDriverVersion = inDriverVersion;
     
     const size_t codeTablesNum = sizeof(cl2CodeTables)/sizeof(CL2GPUCodeTable);
     // ctit - iterator to GPU device code table entry for this driver version
@@ -1072,31 +1239,28 @@ GPUDeviceType AmdCL2MainGPUBinaryBase::determineGPUDeviceTypeInt(
     uint32_t archMinor = 0;
     uint32_t archStepping = 0;
     
-    bool isInnerNewBinary = hasInnerBinary() && this->driverVersion>=191205;
-    if (isInnerNewBinary)
+    if (innerBin != nullptr)
     {
-        const AmdCL2InnerGPUBinary& innerBin = getInnerBinary();
-        
-        const cxbyte* noteContent = (const cxbyte*)innerBin.getNotes();
+        const cxbyte* noteContent = (const cxbyte*)innerBin->getNotes();
         if (noteContent==nullptr)
             throw BinException("Missing notes in inner binary!");
-        size_t notesSize = innerBin.getNotesSize();
+        size_t notesSize = innerBin->getNotesSize();
         // find note about AMDGPU
         for (size_t offset = 0; offset < notesSize; )
         {
-            const typename Types::Nhdr* nhdr =
-                        (const typename Types::Nhdr*)(noteContent + offset);
+            const Elf64_Nhdr* nhdr =
+                        (const Elf64_Nhdr*)(noteContent + offset);
             size_t namesz = ULEV(nhdr->n_namesz);
             size_t descsz = ULEV(nhdr->n_descsz);
             if (usumGt(offset, namesz+descsz, notesSize))
                 throw BinException("Note offset+size out of range");
             if (ULEV(nhdr->n_type) == 0x3 && namesz==4 && descsz>=0x1a &&
                 ::strcmp((const char*)noteContent+offset+
-                            sizeof(typename Types::Nhdr), "AMD")==0)
+                            sizeof(Elf64_Nhdr), "AMD")==0)
             {
                 // get AMDGPU type and detect GPU device
                 const uint32_t* content = (const uint32_t*)
-                        (noteContent+offset+sizeof(typename Types::Nhdr) + 4);
+                        (noteContent+offset+sizeof(Elf64_Nhdr) + 4);
                 uint32_t major = ULEV(content[1]);
                 if (knownGPUType)
                 {
@@ -1132,7 +1296,7 @@ GPUDeviceType AmdCL2MainGPUBinaryBase::determineGPUDeviceTypeInt(
                 }
             }
             size_t align = (((namesz+descsz)&3)!=0) ? 4-((namesz+descsz)&3) : 0;
-            offset += sizeof(typename Types::Nhdr) + namesz + descsz + align;
+            offset += sizeof(Elf64_Nhdr) + namesz + descsz + align;
         }
     }
     
@@ -1144,6 +1308,17 @@ GPUDeviceType AmdCL2MainGPUBinaryBase::determineGPUDeviceTypeInt(
     return deviceType;
 }
 
+template<typename Types>
+GPUDeviceType AmdCL2MainGPUBinaryBase::determineGPUDeviceTypeInt(
+        const typename Types::ElfBinary& binary, uint32_t& outArchMinor,
+        uint32_t& outArchStepping, cxuint inDriverVersion) const
+{
+    const bool isInnerNewBinary = hasInnerBinary() && this->driverVersion>=191205;
+    return determineAmdCL2GPUDeviceType(ULEV(binary.getHeader().e_flags),
+            (inDriverVersion == 0) ? this->driverVersion : inDriverVersion,
+            isInnerNewBinary ? &getInnerBinary() : nullptr, outArchMinor, outArchStepping);
+}
+
 static const cxuint cl2GPUDeviceTypeMinDriverVersion[] =
 {
     UINT_MAX, // CAPE_VERDE = 0, ///< Radeon HD7700
@@ -1192,10 +1367,12 @@ cxuint AmdCL2MainGPUBinaryBase::determineMinDriverVersionForGPUDeviceType(
 /* AMD CL2 32-bit */
 
 AmdCL2MainGPUBinary32::AmdCL2MainGPUBinary32(size_t binaryCodeSize, cxbyte* binaryCode,
-            Flags creationFlags) : AmdCL2MainGPUBinaryBase(AmdMainType::GPU_CL2_BINARY),
-            ElfBinary32(binaryCodeSize, binaryCode, creationFlags)
+            Flags creationFlags, uint64_t expectedChecksum, const BinaryIndex* index)
+            : AmdCL2MainGPUBinaryBase(AmdMainType::GPU_CL2_BINARY),
+            ElfBinary32(binaryCodeSize, binaryCode, creationFlags, expectedChecksum,
+                    false, index)
 {
-    initMainGPUBinary<AmdCL2Types32>(*this);
+    initMainGPUBinary<AmdCL2Types32>(*this, index);
 }
 
 GPUDeviceType AmdCL2MainGPUBinary32::determineGPUDeviceType(uint32_t& archMinor,
@@ -1208,10 +1385,12 @@ GPUDeviceType AmdCL2MainGPUBinary32::determineGPUDeviceType(uint32_t& archMinor,
 /* AMD CL2 64-bit */
 
 AmdCL2MainGPUBinary64::AmdCL2MainGPUBinary64(size_t binaryCodeSize, cxbyte* binaryCode,
-            Flags creationFlags) : AmdCL2MainGPUBinaryBase(AmdMainType::GPU_CL2_64_BINARY),
-            ElfBinary64(binaryCodeSize, binaryCode, creationFlags)
+            Flags creationFlags, uint64_t expectedChecksum, const BinaryIndex* index)
+            : AmdCL2MainGPUBinaryBase(AmdMainType::GPU_CL2_64_BINARY),
+            ElfBinary64(binaryCodeSize, binaryCode, creationFlags, expectedChecksum,
+                    false, index)
 {
-    initMainGPUBinary<AmdCL2Types64>(*this);
+    initMainGPUBinary<AmdCL2Types64>(*this, index);
 }
 
 GPUDeviceType AmdCL2MainGPUBinary64::determineGPUDeviceType(uint32_t& archMinor,
@@ -1223,12 +1402,15 @@ GPUDeviceType AmdCL2MainGPUBinary64::determineGPUDeviceType(uint32_t& archMinor,
 
 
 AmdCL2MainGPUBinaryBase* CLRX::createAmdCL2BinaryFromCode(
-            size_t binaryCodeSize, cxbyte* binaryCode, Flags creationFlags)
+            size_t binaryCodeSize, cxbyte* binaryCode, Flags creationFlags,
+            uint64_t expectedChecksum)
 {
     if (binaryCode[EI_CLASS] == ELFCLASS32)
-        return new AmdCL2MainGPUBinary32(binaryCodeSize, binaryCode, creationFlags);
+        return new AmdCL2MainGPUBinary32(binaryCodeSize, binaryCode, creationFlags,
+                    expectedChecksum);
     else
-        return new AmdCL2MainGPUBinary64(binaryCodeSize, binaryCode, creationFlags);
+        return new AmdCL2MainGPUBinary64(binaryCodeSize, binaryCode, creationFlags,
+                    expectedChecksum);
 }
 
 bool CLRX::isAmdCL2Binary(size_t binarySize, const cxbyte* binary)
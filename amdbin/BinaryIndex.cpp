@@ -0,0 +1,668 @@
+/*
+ *  CLRadeonExtender - Unofficial OpenCL Radeon Extensions Library
+ *  Copyright (C) 2014-2018 Mateusz Szpakowski
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <CLRX/Config.h>
+#include <cstring>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <CLRX/utils/Utilities.h>
+#include <CLRX/utils/MemAccess.h>
+#include <CLRX/utils/Containers.h>
+#include <CLRX/amdbin/ElfBinaries.h>
+#include <CLRX/amdbin/AmdBinaries.h>
+#include <CLRX/amdbin/AmdCL2Binaries.h>
+#include <CLRX/amdbin/ROCmBinaries.h>
+#include <CLRX/amdbin/GalliumBinaries.h>
+#include <CLRX/amdbin/BinaryIndex.h>
+
+using namespace CLRX;
+
+BinaryIndex::BinaryIndex() : format(BinaryProbeFormat::AMD), is64Bit(false),
+        hasDeviceType(false), deviceType(GPUDeviceType::CAPE_VERDE),
+        binarySize(0), checksum(0), metadataOffset(SIZE_MAX), metadataSize(0)
+{ }
+
+void BinaryIndex::clear()
+{
+    format = BinaryProbeFormat::AMD;
+    is64Bit = false;
+    hasDeviceType = false;
+    deviceType = GPUDeviceType::CAPE_VERDE;
+    binarySize = 0;
+    checksum = 0;
+    metadataOffset = SIZE_MAX;
+    metadataSize = 0;
+    sections.clear();
+    symbols.clear();
+    kernels.clear();
+    sectionMap.clear();
+    symbolMap.clear();
+    kernelMap.clear();
+}
+
+void BinaryIndex::initIndex(BinaryProbeFormat newFormat, bool newIs64Bit,
+            size_t newBinarySize, const cxbyte* binary)
+{
+    clear();
+    format = newFormat;
+    is64Bit = newIs64Bit;
+    binarySize = newBinarySize;
+    checksum = calculateBinaryChecksum(binarySize, binary);
+}
+
+template<typename Types>
+void BinaryIndex::addElfBinary(const ElfBinaryTemplate<Types>& elfBin, size_t elfOffset)
+{
+    const cxuint sectionsNum = elfBin.getSectionHeadersNum();
+    sections.resize(sectionsNum);
+    for (cxuint i = 0; i < sectionsNum; i++)
+    {
+        const typename Types::Shdr& shdr = elfBin.getSectionHeader(i);
+        sections[i] = { elfBin.getSectionName(i), elfOffset + size_t(ULEV(shdr.sh_offset)),
+                size_t(ULEV(shdr.sh_size)), uint32_t(ULEV(shdr.sh_type)) };
+    }
+    const size_t symbolsNum = elfBin.getSymbolsNum();
+    symbols.resize(symbolsNum);
+    for (size_t i = 0; i < symbolsNum; i++)
+    {
+        const typename Types::Sym& sym = elfBin.getSymbol(i);
+        symbols[i] = { elfBin.getSymbolName(i), uint64_t(ULEV(sym.st_value)),
+                uint64_t(ULEV(sym.st_size)), uint16_t(ULEV(sym.st_shndx)), sym.st_info };
+    }
+}
+
+// sort indices of entries by name (and by index for same names)
+template<typename T>
+static void sortIndicesByName(const std::vector<T>& entries, std::vector<uint32_t>& map)
+{
+    map.resize(entries.size());
+    for (size_t i = 0; i < entries.size(); i++)
+        map[i] = i;
+    std::sort(map.begin(), map.end(), [&entries](uint32_t a, uint32_t b)
+    {
+        const int r = ::strcmp(entries[a].name.c_str(), entries[b].name.c_str());
+        return r < 0 || (r == 0 && a < b);
+    });
+}
+
+void BinaryIndex::buildMaps()
+{
+    sortIndicesByName(sections, sectionMap);
+    sortIndicesByName(symbols, symbolMap);
+    kernelMap.resize(kernels.size());
+    for (size_t i = 0; i < kernels.size(); i++)
+        kernelMap[i] = std::make_pair(kernels[i].name, i);
+    mapSort(kernelMap.begin(), kernelMap.end());
+}
+
+static inline size_t getBinaryOffset(const cxbyte* binary, const void* data)
+{
+    return (data != nullptr) ? size_t(reinterpret_cast<const cxbyte*>(data) - binary) :
+            SIZE_MAX;
+}
+
+/*
+ * building index
+ */
+
+template<typename AmdBin>
+void BinaryIndex::buildAmd(const AmdBin& binary)
+{
+    const cxbyte* binaryCode = binary.getBinaryCode();
+    initIndex(BinaryProbeFormat::AMD, (binaryCode[EI_CLASS] == ELFCLASS64),
+              binary.getSize(), binaryCode);
+    addElfBinary(binary, 0);
+    hasDeviceType = true;
+    deviceType = binary.determineGPUDeviceType();
+    
+    const size_t kernelsNum = binary.getInnerBinariesNum();
+    kernels.resize(kernelsNum);
+    for (size_t i = 0; i < kernelsNum; i++)
+    {
+        BinaryIndexKernel& kernel = kernels[i];
+        kernel = { binary.getInnerBinaryName(i), SIZE_MAX, 0, SIZE_MAX, 0,
+                SIZE_MAX, 0, SIZE_MAX, 0 };
+        const AmdInnerGPUBinary32& innerBin = binary.getInnerBinary(i);
+        if (innerBin.getBinaryCode() == nullptr)
+            continue; // empty inner binary
+        kernel.offset = getBinaryOffset(binaryCode, innerBin.getBinaryCode());
+        kernel.size = innerBin.getSize();
+        // kernel code is first '.text' in choosen encoding
+        const CALEncodingEntry& encEntry = innerBin.getCALEncodingEntry(
+                    innerBin.findCALEncodingEntryIndex(deviceType));
+        const size_t encEntryOffset = ULEV(encEntry.offset);
+        const size_t encEntrySize = ULEV(encEntry.size);
+        for (cxuint j = 0; j < innerBin.getSectionHeadersNum(); j++)
+        {
+            const Elf32_Shdr& shdr = innerBin.getSectionHeader(j);
+            const size_t secOffset = ULEV(shdr.sh_offset);
+            const size_t secSize = ULEV(shdr.sh_size);
+            if (secOffset < encEntryOffset ||
+                    usumGt(secOffset, secSize, encEntryOffset+encEntrySize))
+                continue; // not in choosen encoding
+            if (::strcmp(innerBin.getSectionName(j), ".text") == 0)
+            {
+                kernel.codeOffset = kernel.offset + secOffset;
+                kernel.codeSize = secSize;
+                break;
+            }
+        }
+    }
+    buildMaps();
+    
+    // metadatas are pointed by '__OpenCL_KERNEL_metadata' symbols
+    for (const BinaryIndexSymbol& sym: symbols)
+    {
+        const size_t len = sym.name.size();
+        if (len < 18 || ::strncmp(sym.name.c_str(), "__OpenCL_", 9) != 0 ||
+            ::strcmp(sym.name.c_str()+len-9, "_metadata") != 0 ||
+            sym.sectionIndex >= sections.size())
+            continue;
+        const BinaryIndexSection& section = sections[sym.sectionIndex];
+        if (sym.value > section.size || usumGt(sym.value, sym.size, section.size))
+            continue;
+        const CString kernelName(sym.name.c_str()+9, sym.name.c_str()+len-9);
+        const size_t kernelIndex = findKernel(kernelName.c_str());
+        if (kernelIndex == SIZE_MAX)
+            continue;
+        kernels[kernelIndex].metadataOffset = section.offset + sym.value;
+        kernels[kernelIndex].metadataSize = sym.size;
+    }
+}
+
+void BinaryIndex::build(const AmdMainGPUBinary32& binary)
+{ buildAmd(binary); }
+
+void BinaryIndex::build(const AmdMainGPUBinary64& binary)
+{ buildAmd(binary); }
+
+template<typename AmdCL2Bin>
+void BinaryIndex::buildAmdCL2(const AmdCL2Bin& binary)
+{
+    // without kernel infos index would not have kernels
+    if (!binary.hasKernelInfo())
+        throw BinException("Binary index requires kernel infos of AMD OpenCL 2.0 binary");
+    const cxbyte* binaryCode = binary.getBinaryCode();
+    initIndex(BinaryProbeFormat::AMDCL2, (binaryCode[EI_CLASS] == ELFCLASS64),
+              binary.getSize(), binaryCode);
+    addElfBinary(binary, 0);
+    uint32_t archMinor, archStepping;
+    hasDeviceType = true;
+    deviceType = binary.determineGPUDeviceType(archMinor, archStepping);
+    
+    const size_t kernelsNum = binary.getKernelInfosNum();
+    kernels.resize(kernelsNum);
+    for (size_t i = 0; i < kernelsNum; i++)
+    {
+        BinaryIndexKernel& kernel = kernels[i];
+        const AmdCL2GPUKernelMetadata& metadata = binary.getMetadataEntry(i);
+        kernel = { metadata.kernelName, SIZE_MAX, 0, SIZE_MAX, 0, SIZE_MAX, 0,
+                getBinaryOffset(binaryCode, metadata.data), metadata.size };
+        if (metadata.data == nullptr)
+            kernel.metadataSize = 0;
+        if (!binary.hasInnerBinary())
+            continue;
+        const AmdCL2InnerGPUBinaryBase& innerBin = binary.getInnerBinaryBase();
+        const AmdCL2GPUKernel* kernelData = nullptr;
+        if (i < innerBin.getKernelsNum() &&
+            innerBin.getKernelData(i).kernelName == kernel.name)
+            kernelData = &innerBin.getKernelData(i);
+        else
+            // kernel datas can be in other order than metadatas
+            for (size_t j = 0; j < innerBin.getKernelsNum(); j++)
+                if (innerBin.getKernelData(j).kernelName == kernel.name)
+                {
+                    kernelData = &innerBin.getKernelData(j);
+                    break;
+                }
+        if (kernelData == nullptr)
+            continue;
+        if (kernelData->setup != nullptr)
+        {
+            kernel.setupOffset = getBinaryOffset(binaryCode, kernelData->setup);
+            kernel.setupSize = kernelData->setupSize;
+        }
+        if (kernelData->code != nullptr)
+        {
+            kernel.codeOffset = getBinaryOffset(binaryCode, kernelData->code);
+            kernel.codeSize = kernelData->codeSize;
+        }
+        // kernel region: setup followed by code
+        if (kernel.setupOffset != SIZE_MAX && kernel.codeOffset != SIZE_MAX)
+        {
+            kernel.offset = std::min(kernel.setupOffset, kernel.codeOffset);
+            kernel.size = std::max(kernel.setupOffset + kernel.setupSize,
+                        kernel.codeOffset + kernel.codeSize) - kernel.offset;
+        }
+        else if (kernel.codeOffset != SIZE_MAX)
+        {
+            kernel.offset = kernel.codeOffset;
+            kernel.size = kernel.codeSize;
+        }
+    }
+    buildMaps();
+}
+
+void BinaryIndex::build(const AmdCL2MainGPUBinary32& binary)
+{ buildAmdCL2(binary); }
+
+void BinaryIndex::build(const AmdCL2MainGPUBinary64& binary)
+{ buildAmdCL2(binary); }
+
+void BinaryIndex::build(const ROCmBinary& binary)
+{
+    const cxbyte* binaryCode = binary.getBinaryCode();
+    initIndex(BinaryProbeFormat::ROCM, true, binary.getSize(), binaryCode);
+    addElfBinary(binary, 0);
+    uint32_t archMinor, archStepping;
+    hasDeviceType = true;
+    deviceType = binary.determineGPUDeviceType(archMinor, archStepping);
+    if (binary.getMetadata() != nullptr)
+    {
+        metadataOffset = getBinaryOffset(binaryCode, binary.getMetadata());
+        metadataSize = binary.getMetadataSize();
+    }
+    
+    const bool llvm10BinFormat = binary.isLLVM10BinaryFormat();
+    for (size_t i = 0; i < binary.getRegionsNum(); i++)
+    {
+        const ROCmRegion& region = binary.getRegion(i);
+        if (region.type != ROCmRegionType::KERNEL &&
+            region.type != ROCmRegionType::FKERNEL)
+            continue;
+        BinaryIndexKernel kernel = { region.regionName, size_t(region.offset),
+                size_t(region.size), size_t(region.offset), size_t(region.size),
+                SIZE_MAX, 0, SIZE_MAX, 0 };
+        if (!llvm10BinFormat)
+        {
+            // kernel code follows kernel config (256 bytes)
+            const size_t kconfigSize = std::min(size_t(region.size), size_t(256));
+            kernel.setupOffset = region.offset;
+            kernel.setupSize = kconfigSize;
+            kernel.codeOffset += kconfigSize;
+            kernel.codeSize -= kconfigSize;
+        }
+        else if (binary.getKernelDescriptor(i) != nullptr)
+        {
+            // kernel descriptor in rodata
+            kernel.setupOffset = getBinaryOffset(binaryCode, binary.getKernelDescriptor(i));
+            kernel.setupSize = sizeof(ROCmKernelDescriptor);
+        }
+        kernels.push_back(kernel);
+    }
+    buildMaps();
+}
+
+void BinaryIndex::build(const GalliumBinary& binary)
+{
+    const cxbyte* binaryCode = binary.getBinaryCode();
+    initIndex(BinaryProbeFormat::GALLIUM, binary.is64BitElfBinary(),
+              binary.getSize(), binaryCode);
+    if (!is64Bit)
+    {
+        const GalliumElfBinary32& elfBin = binary.getElfBinary32();
+        addElfBinary(elfBin, getBinaryOffset(binaryCode, elfBin.getBinaryCode()));
+    }
+    else
+    {
+        const GalliumElfBinary64& elfBin = binary.getElfBinary64();
+        addElfBinary(elfBin, getBinaryOffset(binaryCode, elfBin.getBinaryCode()));
+    }
+    size_t textOffset = SIZE_MAX;
+    size_t codeSize = 0;
+    for (const BinaryIndexSection& section: sections)
+        if (section.name == ".text")
+        {
+            textOffset = section.offset;
+            codeSize = section.size;
+            break;
+        }
+    if (textOffset == SIZE_MAX)
+        throw BinException("No '.text' section in Gallium binary");
+    
+    // kernel code ends at next kernel or at end of code
+    const size_t kernelsNum = binary.getKernelsNum();
+    std::vector<size_t> offsets(kernelsNum);
+    for (size_t i = 0; i < kernelsNum; i++)
+        offsets[i] = binary.getKernel(i).offset;
+    std::sort(offsets.begin(), offsets.end());
+    kernels.resize(kernelsNum);
+    for (size_t i = 0; i < kernelsNum; i++)
+    {
+        const GalliumKernel& galliumKernel = binary.getKernel(i);
+        auto next = std::upper_bound(offsets.begin(), offsets.end(),
+                    size_t(galliumKernel.offset));
+        const size_t end = (next != offsets.end()) ? *next : codeSize;
+        const size_t offset = textOffset + galliumKernel.offset;
+        const size_t size = end >= galliumKernel.offset ? end - galliumKernel.offset : 0;
+        kernels[i] = { galliumKernel.kernelName, offset, size, offset, size,
+                SIZE_MAX, 0, SIZE_MAX, 0 };
+    }
+    buildMaps();
+}
+
+bool BinaryIndex::matches(size_t inBinarySize, const cxbyte* binary) const
+{
+    return binarySize == inBinarySize &&
+            checksum == calculateBinaryChecksum(inBinarySize, binary);
+}
+
+size_t BinaryIndex::findKernel(const char* name) const
+{
+    auto it = binaryMapFind(kernelMap.begin(), kernelMap.end(), CString(name));
+    return (it != kernelMap.end()) ? it->second : SIZE_MAX;
+}
+
+/* binary form of index: header (BinaryIndexFileHeader), section table,
+ * symbol table, kernel table, map table (32-bit indices of sections, symbols and kernels
+ * sorted by name), string table. */
+
+static const char binaryIndexMagic[8] = { 'C', 'L', 'R', 'X', 'B', 'I', 'D', 'X' };
+static const uint32_t binaryIndexVersion = 1;
+
+static inline uint64_t writeIndexOffset(size_t offset)
+{ return (offset != SIZE_MAX) ? uint64_t(offset) : UINT64_MAX; }
+
+// add name to string table and return its offset
+static uint64_t addIndexString(std::vector<char>& strings, const CString& str)
+{
+    const uint64_t offset = strings.size();
+    strings.insert(strings.end(), str.c_str(), str.c_str() + str.size() + 1);
+    return offset;
+}
+
+static inline size_t alignIndexOffset(size_t offset)
+{ return (offset + 7) & ~size_t(7); }
+
+void BinaryIndex::write(std::ostream& os) const
+{
+    const size_t sectionsOffset = sizeof(BinaryIndexFileHeader);
+    const size_t symbolsOffset = sectionsOffset +
+            sizeof(BinaryIndexFileSection)*sections.size();
+    const size_t kernelsOffset = symbolsOffset +
+            sizeof(BinaryIndexFileSymbol)*symbols.size();
+    const size_t mapsOffset = kernelsOffset +
+            sizeof(BinaryIndexFileKernel)*kernels.size();
+    const size_t stringsOffset = alignIndexOffset(mapsOffset +
+            4*(sections.size() + symbols.size() + kernels.size()));
+    
+    std::vector<cxbyte> data(stringsOffset);
+    std::vector<char> strings;
+    BinaryIndexFileHeader& header = *reinterpret_cast<BinaryIndexFileHeader*>(
+                data.data());
+    ::memcpy(header.magic, binaryIndexMagic, 8);
+    SLEV(header.version, binaryIndexVersion);
+    SLEV(header.format, cxuint(format));
+    SLEV(header.flags, (is64Bit ? 1U : 0U) | (hasDeviceType ? 2U : 0U));
+    SLEV(header.deviceType, cxuint(deviceType));
+    SLEV(header.binarySize, binarySize);
+    SLEV(header.checksum, checksum);
+    SLEV(header.metadataOffset, writeIndexOffset(metadataOffset));
+    SLEV(header.metadataSize, metadataSize);
+    SLEV(header.sectionsNum, sections.size());
+    SLEV(header.symbolsNum, symbols.size());
+    SLEV(header.kernelsNum, kernels.size());
+    SLEV(header.sectionsOffset, sectionsOffset);
+    SLEV(header.symbolsOffset, symbolsOffset);
+    SLEV(header.kernelsOffset, kernelsOffset);
+    SLEV(header.mapsOffset, mapsOffset);
+    SLEV(header.stringsOffset, stringsOffset);
+    
+    BinaryIndexFileSection* fileSections = reinterpret_cast<BinaryIndexFileSection*>(
+                data.data() + sectionsOffset);
+    for (size_t i = 0; i < sections.size(); i++)
+    {
+        const BinaryIndexSection& section = sections[i];
+        BinaryIndexFileSection& fileSection = fileSections[i];
+        SLEV(fileSection.nameOffset, addIndexString(strings, section.name));
+        SLEV(fileSection.offset, section.offset);
+        SLEV(fileSection.size, section.size);
+        SLEV(fileSection.nameSize, section.name.size());
+        SLEV(fileSection.type, section.type);
+    }
+    BinaryIndexFileSymbol* fileSymbols = reinterpret_cast<BinaryIndexFileSymbol*>(
+                data.data() + symbolsOffset);
+    for (size_t i = 0; i < symbols.size(); i++)
+    {
+        const BinaryIndexSymbol& symbol = symbols[i];
+        BinaryIndexFileSymbol& fileSymbol = fileSymbols[i];
+        SLEV(fileSymbol.nameOffset, addIndexString(strings, symbol.name));
+        SLEV(fileSymbol.value, symbol.value);
+        SLEV(fileSymbol.size, symbol.size);
+        SLEV(fileSymbol.nameSize, symbol.name.size());
+        SLEV(fileSymbol.sectionIndex, symbol.sectionIndex);
+        fileSymbol.info = symbol.info;
+    }
+    BinaryIndexFileKernel* fileKernels = reinterpret_cast<BinaryIndexFileKernel*>(
+                data.data() + kernelsOffset);
+    for (size_t i = 0; i < kernels.size(); i++)
+    {
+        const BinaryIndexKernel& kernel = kernels[i];
+        BinaryIndexFileKernel& fileKernel = fileKernels[i];
+        SLEV(fileKernel.nameOffset, addIndexString(strings, kernel.name));
+        SLEV(fileKernel.nameSize, kernel.name.size());
+        SLEV(fileKernel.offset, writeIndexOffset(kernel.offset));
+        SLEV(fileKernel.size, kernel.size);
+        SLEV(fileKernel.codeOffset, writeIndexOffset(kernel.codeOffset));
+        SLEV(fileKernel.codeSize, kernel.codeSize);
+        SLEV(fileKernel.setupOffset, writeIndexOffset(kernel.setupOffset));
+        SLEV(fileKernel.setupSize, kernel.setupSize);
+        SLEV(fileKernel.metadataOffset, writeIndexOffset(kernel.metadataOffset));
+        SLEV(fileKernel.metadataSize, kernel.metadataSize);
+    }
+    uint32_t* maps = reinterpret_cast<uint32_t*>(data.data() + mapsOffset);
+    for (uint32_t index: sectionMap)
+        SLEV(*maps++, index);
+    for (uint32_t index: symbolMap)
+        SLEV(*maps++, index);
+    for (const auto& entry: kernelMap)
+        SLEV(*maps++, entry.second);
+    SLEV(header.stringsSize, strings.size());
+    
+    os.write(reinterpret_cast<const char*>(data.data()), data.size());
+    os.write(strings.data(), strings.size());
+}
+
+void BinaryIndex::read(std::istream& is)
+{
+    // read whole index and load it from memory
+    std::vector<char> data;
+    char buf[4096];
+    while (is.read(buf, sizeof buf) || is.gcount() != 0)
+        data.insert(data.end(), buf, buf + is.gcount());
+    load(data.size(), reinterpret_cast<const cxbyte*>(data.data()));
+}
+
+// check offset and size of data in binary index file
+static void checkIndexTable(size_t indexSize, uint64_t offset, uint64_t num,
+            size_t entrySize)
+{
+    if (offset > indexSize || (offset & 7) != 0 || num > (indexSize - offset)/entrySize)
+        throw BinException("Binary index is truncated");
+}
+
+// get name from string table of binary index file
+static CString getIndexString(const char* strings, size_t stringsSize,
+            uint64_t nameOffset, uint32_t nameSize)
+{
+    if (nameOffset >= stringsSize || nameSize >= stringsSize - nameOffset ||
+        strings[nameOffset + nameSize] != 0)
+        throw BinException("Wrong name in binary index");
+    return CString(strings + nameOffset, nameSize);
+}
+
+// get offset and size of data and check whether data is in binary
+static void getIndexRange(uint64_t inOffset, uint64_t inSize, size_t binarySize,
+            size_t& offset, size_t& size)
+{
+    inOffset = ULEV(inOffset);
+    inSize = ULEV(inSize);
+    if (inOffset == UINT64_MAX)
+    {
+        if (inSize != 0)
+            throw BinException("Wrong range in binary index");
+        offset = SIZE_MAX;
+        size = 0;
+        return;
+    }
+    if (inOffset > binarySize || inSize > binarySize - inOffset)
+        throw BinException("Range out of binary in binary index");
+    offset = inOffset;
+    size = inSize;
+}
+
+// get map (indices sorted by name) and check whether map is permutation
+template<typename T>
+static void getIndexMap(const uint32_t* inMap, const std::vector<T>& entries,
+            std::vector<uint32_t>& map)
+{
+    const size_t num = entries.size();
+    map.resize(num);
+    std::vector<bool> visited(num, false);
+    for (size_t i = 0; i < num; i++)
+    {
+        const uint32_t index = ULEV(inMap[i]);
+        if (index >= num || visited[index])
+            throw BinException("Wrong map in binary index");
+        visited[index] = true;
+        map[i] = index;
+        if (i != 0 && ::strcmp(entries[map[i-1]].name.c_str(),
+                    entries[index].name.c_str()) > 0)
+            throw BinException("Unsorted map in binary index");
+    }
+}
+
+void BinaryIndex::load(size_t indexSize, const cxbyte* indexData)
+{
+    clear();
+    if (indexSize < sizeof(BinaryIndexFileHeader))
+        throw BinException("Binary index is truncated");
+    const BinaryIndexFileHeader& header =
+            *reinterpret_cast<const BinaryIndexFileHeader*>(indexData);
+    if (::memcmp(header.magic, binaryIndexMagic, 8) != 0)
+        throw BinException("This is not binary index");
+    if (ULEV(header.version) != binaryIndexVersion)
+        throw BinException("Unsupported binary index version");
+    const uint32_t inFormat = ULEV(header.format);
+    if (inFormat > cxuint(BinaryProbeFormat::GALLIUM))
+        throw BinException("Wrong binary format in binary index");
+    format = BinaryProbeFormat(inFormat);
+    const uint32_t inFlags = ULEV(header.flags);
+    is64Bit = (inFlags & 1) != 0;
+    hasDeviceType = (inFlags & 2) != 0;
+    const uint32_t devType = ULEV(header.deviceType);
+    if (devType > cxuint(GPUDeviceType::GPUDEVICE_MAX))
+        throw BinException("Wrong GPU device type in binary index");
+    deviceType = GPUDeviceType(devType);
+    const uint64_t inBinarySize = ULEV(header.binarySize);
+    if (inBinarySize > SIZE_MAX)
+        throw BinException("Binary size in binary index is too big");
+    binarySize = inBinarySize;
+    checksum = ULEV(header.checksum);
+    getIndexRange(header.metadataOffset, header.metadataSize, binarySize,
+                metadataOffset, metadataSize);
+    
+    // check tables
+    const size_t sectionsNum = ULEV(header.sectionsNum);
+    const size_t symbolsNum = ULEV(header.symbolsNum);
+    const size_t kernelsNum = ULEV(header.kernelsNum);
+    checkIndexTable(indexSize, ULEV(header.sectionsOffset), sectionsNum,
+                sizeof(BinaryIndexFileSection));
+    checkIndexTable(indexSize, ULEV(header.symbolsOffset), symbolsNum,
+                sizeof(BinaryIndexFileSymbol));
+    checkIndexTable(indexSize, ULEV(header.kernelsOffset), kernelsNum,
+                sizeof(BinaryIndexFileKernel));
+    checkIndexTable(indexSize, ULEV(header.mapsOffset),
+                uint64_t(sectionsNum) + symbolsNum + kernelsNum, 4);
+    const uint64_t stringsOffset = ULEV(header.stringsOffset);
+    const uint64_t stringsSize = ULEV(header.stringsSize);
+    if (stringsOffset > indexSize || stringsSize > indexSize - stringsOffset)
+        throw BinException("Binary index is truncated");
+    const char* strings = reinterpret_cast<const char*>(indexData + stringsOffset);
+    
+    const BinaryIndexFileSection* fileSections =
+            reinterpret_cast<const BinaryIndexFileSection*>(
+                    indexData + ULEV(header.sectionsOffset));
+    sections.resize(sectionsNum);
+    for (size_t i = 0; i < sectionsNum; i++)
+    {
+        const BinaryIndexFileSection& fileSection = fileSections[i];
+        BinaryIndexSection& section = sections[i];
+        section.name = getIndexString(strings, stringsSize,
+                    ULEV(fileSection.nameOffset), ULEV(fileSection.nameSize));
+        section.type = ULEV(fileSection.type);
+        const uint64_t offset = ULEV(fileSection.offset);
+        const uint64_t size = ULEV(fileSection.size);
+        // content of NOBITS section is not in binary
+        if (section.type != SHT_NOBITS && section.type != SHT_NULL &&
+            (offset > binarySize || size > binarySize - offset))
+            throw BinException("Section out of binary in binary index");
+        section.offset = offset;
+        section.size = size;
+    }
+    const BinaryIndexFileSymbol* fileSymbols =
+            reinterpret_cast<const BinaryIndexFileSymbol*>(
+                    indexData + ULEV(header.symbolsOffset));
+    symbols.resize(symbolsNum);
+    for (size_t i = 0; i < symbolsNum; i++)
+    {
+        const BinaryIndexFileSymbol& fileSymbol = fileSymbols[i];
+        BinaryIndexSymbol& symbol = symbols[i];
+        symbol.name = getIndexString(strings, stringsSize,
+                    ULEV(fileSymbol.nameOffset), ULEV(fileSymbol.nameSize));
+        symbol.value = ULEV(fileSymbol.value);
+        symbol.size = ULEV(fileSymbol.size);
+        symbol.sectionIndex = ULEV(fileSymbol.sectionIndex);
+        symbol.info = fileSymbol.info;
+    }
+    const BinaryIndexFileKernel* fileKernels =
+            reinterpret_cast<const BinaryIndexFileKernel*>(
+                    indexData + ULEV(header.kernelsOffset));
+    kernels.resize(kernelsNum);
+    for (size_t i = 0; i < kernelsNum; i++)
+    {
+        const BinaryIndexFileKernel& fileKernel = fileKernels[i];
+        BinaryIndexKernel& kernel = kernels[i];
+        kernel.name = getIndexString(strings, stringsSize,
+                    ULEV(fileKernel.nameOffset), ULEV(fileKernel.nameSize));
+        getIndexRange(fileKernel.offset, fileKernel.size, binarySize,
+                    kernel.offset, kernel.size);
+        getIndexRange(fileKernel.codeOffset, fileKernel.codeSize, binarySize,
+                    kernel.codeOffset, kernel.codeSize);
+        getIndexRange(fileKernel.setupOffset, fileKernel.setupSize, binarySize,
+                    kernel.setupOffset, kernel.setupSize);
+        getIndexRange(fileKernel.metadataOffset, fileKernel.metadataSize, binarySize,
+                    kernel.metadataOffset, kernel.metadataSize);
+    }
+    
+    // maps are stored sorted, only check them
+    const uint32_t* maps = reinterpret_cast<const uint32_t*>(
+                indexData + ULEV(header.mapsOffset));
+    getIndexMap(maps, sections, sectionMap);
+    getIndexMap(maps + sectionsNum, symbols, symbolMap);
+    std::vector<uint32_t> kernelOrder;
+    getIndexMap(maps + sectionsNum + symbolsNum, kernels, kernelOrder);
+    kernelMap.resize(kernelsNum);
+    for (size_t i = 0; i < kernelsNum; i++)
+        kernelMap[i] = std::make_pair(kernels[kernelOrder[i]].name, kernelOrder[i]);
+}
@@ -0,0 +1,436 @@
+/*
+ *  CLRadeonExtender - Unofficial OpenCL Radeon Extensions Library
+ *  Copyright (C) 2014-2018 Mateusz Szpakowski
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <CLRX/Config.h>
+#include <cstring>
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <memory>
+#include <CLRX/utils/Utilities.h>
+#include <CLRX/utils/MemAccess.h>
+#include <CLRX/amdbin/ElfBinaries.h>
+#include <CLRX/amdbin/AmdBinaries.h>
+#include <CLRX/amdbin/AmdCL2Binaries.h>
+#include <CLRX/amdbin/ROCmBinaries.h>
+#include <CLRX/amdbin/GalliumBinaries.h>
+#include <CLRX/amdbin/BinaryProbe.h>
+#include "ROCmBinLoader.h"
+
+using namespace CLRX;
+
+BinaryProbeFormat CLRX::detectBinaryFormat(size_t binarySize, const cxbyte* binary)
+{
+    // same order as in disassembler
+    if (isAmdBinary(binarySize, binary))
+        return BinaryProbeFormat::AMD;
+    if (isAmdCL2Binary(binarySize, binary))
+        return BinaryProbeFormat::AMDCL2;
+    if (isROCmBinary(binarySize, binary))
+        return BinaryProbeFormat::ROCM;
+    return BinaryProbeFormat::GALLIUM;
+}
+
+static const char* binaryProbeFormatNamesTbl[] =
+{ "amd", "amdcl2", "rocm", "gallium" };
+
+const char* CLRX::getBinaryProbeFormatName(BinaryProbeFormat format)
+{
+    return binaryProbeFormatNamesTbl[cxuint(format)];
+}
+
+// get section index, returns SHN_UNDEF if section not found
+template<typename Types>
+static uint16_t findProbeSectionIndex(const ElfBinaryTemplate<Types>& elfBin,
+            const char* name)
+{
+    try
+    { return elfBin.getSectionIndex(name); }
+    catch(const Exception& ex)
+    { return SHN_UNDEF; }
+}
+
+typedef std::pair<CString, size_t> ProbeKernelCodeEntry;
+
+/*
+ * AMD Catalyst binaries
+ */
+
+// get code size of kernel from AMD inner binary (first '.text' in choosen encoding)
+static size_t getAmdInnerCodeSize(size_t innerSize, cxbyte* innerCode,
+            GPUDeviceType deviceType, Flags creationFlags)
+{
+    const ElfBinary32 innerBin(innerSize, innerCode, creationFlags, 0, true);
+    const CALEncodingEntry* encEntries = nullptr;
+    cxuint encEntriesNum = 0;
+    if (innerBin.getProgramHeadersNum() >= 1)
+    {
+        // encodings table in first program header
+        const Elf32_Phdr& ephdr = innerBin.getProgramHeader(0);
+        const size_t encTableOffset = ULEV(ephdr.p_offset);
+        const size_t encTableSize = ULEV(ephdr.p_filesz);
+        if (ULEV(ephdr.p_type) != 0x70000002)
+            throw BinException("Missing encodings table");
+        if (encTableSize%sizeof(CALEncodingEntry) != 0)
+            throw BinException("Wrong size of encodings table");
+        if (usumGt(encTableOffset, encTableSize, innerSize))
+            throw BinException("Offset+Size of encodings table out of range");
+        encEntriesNum = encTableSize/sizeof(CALEncodingEntry);
+        encEntries = reinterpret_cast<const CALEncodingEntry*>(innerCode + encTableOffset);
+    }
+    const CALEncodingEntry& encEntry = encEntries[findAmdCALEncodingEntryIndex(
+                encEntriesNum, encEntries, deviceType)];
+    const size_t encEntryOffset = ULEV(encEntry.offset);
+    const size_t encEntrySize = ULEV(encEntry.size);
+    for (cxuint j = 0; j < innerBin.getSectionHeadersNum(); j++)
+    {
+        const Elf32_Shdr& shdr = innerBin.getSectionHeader(j);
+        const size_t secOffset = ULEV(shdr.sh_offset);
+        const size_t secSize = ULEV(shdr.sh_size);
+        if (secOffset < encEntryOffset ||
+                usumGt(secOffset, secSize, encEntryOffset+encEntrySize))
+            continue; // not in choosen encoding
+        if (::strcmp(innerBin.getSectionName(j), ".text") == 0)
+            return secSize;
+    }
+    return 0;
+}
+
+template<typename Types>
+static void probeAmdGPUBinary(const ElfBinaryTemplate<Types>& elfBin, BinaryProbe& probe)
+{
+    probe.deviceType = getAmdGPUDeviceTypeFromElfMachine(
+                ULEV(elfBin.getHeader().e_machine));
+    probe.hasDeviceType = true;
+    const uint16_t textIndex = findProbeSectionIndex(elfBin, ".text");
+    const Flags innerFlags = elfBin.getCreationFlags() & BINARY_CREATE_TRUSTED;
+    // inner binaries in '.text' pointed by '__OpenCL_XXX_kernel' symbols
+    for (size_t i = 0; i < elfBin.getSymbolsNum(); i++)
+    {
+        const char* symName = elfBin.getSymbolName(i);
+        const size_t len = ::strlen(symName);
+        if (len < 16 || ::strncmp(symName, "__OpenCL_", 9) != 0 ||
+            ::strcmp(symName+len-7, "_kernel") != 0)
+            continue;
+        size_t codeSize = 0;
+        // binary without '.text' has empty inner binaries
+        if (textIndex != SHN_UNDEF)
+        {
+            const typename Types::Shdr& textHdr = elfBin.getSectionHeader(textIndex);
+            const typename Types::Sym& sym = elfBin.getSymbol(i);
+            const size_t symvalue = ULEV(sym.st_value);
+            const size_t symsize = ULEV(sym.st_size);
+            if (symvalue > ULEV(textHdr.sh_size))
+                throw BinException("Inner binary offset out of range!");
+            if (usumGt(symvalue, symsize, ULEV(textHdr.sh_size)))
+                throw BinException("Inner binary offset+size out of range!");
+            codeSize = getAmdInnerCodeSize(symsize, const_cast<cxbyte*>(
+                    elfBin.getBinaryCode()) + ULEV(textHdr.sh_offset) + symvalue,
+                    probe.deviceType, innerFlags);
+        }
+        probe.kernels.push_back({ CString(symName+9, len-16), codeSize });
+    }
+}
+
+/*
+ * AMD OpenCL 2.0 binaries
+ */
+
+// get kernel code sizes from symbols '&__OpenCL_XXX_kernel' of new inner binary
+static void getAmdCL2InnerCodeSizes(const ElfBinary64& innerBin,
+            std::vector<ProbeKernelCodeEntry>& codeSizes)
+{
+    const bool trusted = (innerBin.getCreationFlags() & BINARY_CREATE_TRUSTED) != 0;
+    for (size_t i = 0; i < innerBin.getSymbolsNum(); i++)
+    {
+        const char* symName = innerBin.getSymbolName(i);
+        const size_t len = ::strlen(symName);
+        if (len < 17 || ::strncmp(symName, "&__OpenCL_", 10) != 0 ||
+            ::strcmp(symName+len-7, "_kernel") != 0) // not binary, skip
+            continue;
+        const Elf64_Sym& sym = innerBin.getSymbol(i);
+        const size_t binOffset = ULEV(sym.st_value);
+        const size_t binSize = ULEV(sym.st_size);
+        if (!trusted)
+        {
+            if (ULEV(sym.st_shndx) >= innerBin.getSectionHeadersNum())
+                throw BinException("Kernel section index out of range");
+            const Elf64_Shdr& dataShdr = innerBin.getSectionHeader(ULEV(sym.st_shndx));
+            if (binOffset >= ULEV(dataShdr.sh_size))
+                throw BinException("Kernel binary code offset out of range");
+            if (usumGt(binOffset, binSize, ULEV(dataShdr.sh_size)))
+                throw BinException("Kernel binary code offset and size out of range");
+            if (binSize < 192)
+                throw BinException("Kernel binary code size is too short");
+        }
+        // text (code) offset at offset 16 of setup
+        const cxbyte* setup = innerBin.getSectionContent(ULEV(sym.st_shndx)) + binOffset;
+        const size_t textOffset = ULEV(*reinterpret_cast<const uint32_t*>(setup+16));
+        if (textOffset >= binSize)
+            throw BinException("Kernel text offset out of range");
+        codeSizes.push_back({ CString(symName+10, len-17), binSize-textOffset });
+    }
+}
+
+// get kernel code size from stub of kernel in old inner binary
+static size_t getAmdCL2OldKernelCodeSize(size_t binSize, const cxbyte* stub)
+{
+    const size_t setupOffset = ULEV(*reinterpret_cast<const uint32_t*>(stub));
+    if (setupOffset >= binSize)
+        throw BinException("Kernel setup offset out of range");
+    const size_t textOffset = ULEV(*reinterpret_cast<const uint32_t*>(
+                stub+setupOffset+16));
+    if (usumGe(textOffset, setupOffset, binSize))
+        throw BinException("Kernel text offset out of range");
+    return binSize - setupOffset - textOffset;
+}
+
+template<typename Types>
+static void probeAmdCL2Binary(const ElfBinaryTemplate<Types>& elfBin, BinaryProbe& probe)
+{
+    const bool trusted = (elfBin.getCreationFlags() & BINARY_CREATE_TRUSTED) != 0;
+    const uint16_t textIndex = findProbeSectionIndex(elfBin, ".text");
+    const typename Types::Shdr* textShdr = (textIndex != SHN_UNDEF) ?
+            &elfBin.getSectionHeader(textIndex) : nullptr;
+    std::vector<ProbeKernelCodeEntry> codeSizes;
+    bool newInnerBinary = true;
+    // kernel names from symbols of metadata, kernels of old inner binary
+    for (size_t i = 0; i < elfBin.getSymbolsNum(); i++)
+    {
+        const char* symName = elfBin.getSymbolName(i);
+        const size_t len = ::strlen(symName);
+        if (len >= 35 && ::strncmp(symName, "__OpenCL_&__OpenCL_", 19) == 0 &&
+                ::strcmp(symName+len-16, "_kernel_metadata") == 0)
+            probe.kernels.push_back({ CString(symName+19, symName+len-16), 0 });
+        else if (len >= 30 && ::strncmp(symName, "__ISA_&__OpenCL_", 16) == 0 &&
+                ::strcmp(symName+len-14, "_kernel_binary") == 0)
+        {
+            newInnerBinary = false;
+            if (textShdr == nullptr)
+                continue;
+            const typename Types::Sym& sym = elfBin.getSymbol(i);
+            const size_t binOffset = ULEV(sym.st_value);
+            const size_t binSize = ULEV(sym.st_size);
+            if (!trusted)
+            {
+                if (textIndex != ULEV(sym.st_shndx))
+                    throw BinException("Kernel symbol outside text section");
+                if (binOffset >= ULEV(textShdr->sh_size))
+                    throw BinException("Kernel binary code offset out of range");
+                if (usumGt(binOffset, binSize, ULEV(textShdr->sh_size)))
+                    throw BinException("Kernel binary code offset and size out of range");
+                if (binSize < 256+192)
+                    throw BinException("Kernel binary code size is too short");
+            }
+            codeSizes.push_back({ CString(symName+16, len-30),
+                    getAmdCL2OldKernelCodeSize(binSize, elfBin.getBinaryCode() +
+                            ULEV(textShdr->sh_offset) + binOffset) });
+        }
+    }
+    
+    // only headers and symbol table of new inner binary
+    std::unique_ptr<ElfBinary64> innerBin;
+    if (newInnerBinary && textShdr != nullptr)
+    {
+        innerBin.reset(new ElfBinary64(ULEV(textShdr->sh_size),
+                const_cast<cxbyte*>(elfBin.getBinaryCode()) + ULEV(textShdr->sh_offset),
+                elfBin.getCreationFlags() & BINARY_CREATE_TRUSTED, 0, true));
+        getAmdCL2InnerCodeSizes(*innerBin, codeSizes);
+    }
+    
+    const cxuint driverVersion = detectAmdCL2DriverVersion(elfBin);
+    uint32_t archMinor, archStepping;
+    probe.deviceType = determineAmdCL2GPUDeviceType(ULEV(elfBin.getHeader().e_flags),
+            driverVersion, (driverVersion >= 191205) ? innerBin.get() : nullptr,
+            archMinor, archStepping);
+    probe.hasDeviceType = true;
+    
+    if (textShdr == nullptr)
+        return; // no inner binary (no code)
+    mapSort(codeSizes.begin(), codeSizes.end());
+    for (BinaryProbeKernel& kernel: probe.kernels)
+    {
+        auto it = binaryMapFind(codeSizes.begin(), codeSizes.end(), kernel.name);
+        if (it == codeSizes.end())
+            throw BinException("Can't find kernel name");
+        kernel.codeSize = it->second;
+    }
+}
+
+/*
+ * ROCm binaries
+ */
+
+static void probeROCmBinary(const ElfBinary64& elfBin, BinaryProbe& probe)
+{
+    const bool llvm10BinFormat = (elfBin.getHeader().e_ident[EI_ABIVERSION] == 1);
+    uint32_t archMinor, archStepping;
+    probe.deviceType = determineROCmGPUDeviceType(elfBin, llvm10BinFormat,
+                archMinor, archStepping);
+    probe.hasDeviceType = true;
+    
+    const cxuint textIndex = findROCmSectionIndex(elfBin, ".text");
+    if (textIndex == SHN_UNDEF)
+        return; // no code
+    const bool newBinFormat =
+            (findROCmSectionIndex(elfBin, ".AMDGPU.config") == SHN_UNDEF);
+    // regions (kernels and data) from symbols of '.text' section (without checking)
+    std::vector<ROCmCodeRegion> regions;
+    getROCmCodeRegions(elfBin, textIndex, !newBinFormat || llvm10BinFormat, 0, false,
+                true, regions);
+    // kernel code follows kernel descriptor (before LLVM 10 format)
+    const size_t kconfigSize = llvm10BinFormat ? 0 : 256;
+    for (const ROCmCodeRegion& region: regions)
+        if (region.symType != STT_OBJECT)
+            probe.kernels.push_back({ elfBin.getSymbolName(region.symIndex),
+                    region.size >= kconfigSize ? region.size - kconfigSize : 0 });
+}
+
+/*
+ * Gallium binaries
+ */
+
+template<typename Types>
+static size_t getGalliumCodeSize(size_t elfSize, cxbyte* elfCode)
+{
+    const ElfBinaryTemplate<Types> elfBin(elfSize, elfCode, 0);
+    return ULEV(elfBin.getSectionHeader(".text").sh_size);
+}
+
+static void probeGalliumBinary(size_t binarySize, cxbyte* binary, BinaryProbe& probe)
+{
+    if (binarySize < 4)
+        throw BinException("GalliumBinary is too small!!!");
+    const cxuint kernelsNum = ULEV(*reinterpret_cast<const uint32_t*>(binary));
+    if (binarySize < uint64_t(kernelsNum)*16U)
+        throw BinException("Kernels number is too big!");
+    std::vector<size_t> kernelOffsets(kernelsNum);
+    probe.kernels.resize(kernelsNum);
+    size_t pos = 4;
+    // kernel names and offsets (kernel arguments are skipped)
+    for (cxuint i = 0; i < kernelsNum; i++)
+    {
+        if (usumGt(pos, size_t(4U), binarySize))
+            throw BinException("GalliumBinary is too small!!!");
+        const size_t symNameLen = ULEV(*reinterpret_cast<const uint32_t*>(binary+pos));
+        pos += 4;
+        if (usumGt(pos, symNameLen, binarySize))
+            throw BinException("Kernel name length is too long!");
+        probe.kernels[i].name.assign((const char*)binary+pos, symNameLen);
+        pos += symNameLen;
+        if (usumGt(pos, size_t(12U), binarySize))
+            throw BinException("GalliumBinary is too small!!!");
+        const uint32_t* data32 = reinterpret_cast<const uint32_t*>(binary+pos);
+        kernelOffsets[i] = ULEV(data32[1]);
+        const uint32_t argsNum = ULEV(data32[2]);
+        pos += 12;
+        if (UINT32_MAX/24U < argsNum)
+            throw BinException("Number of arguments number is too high!");
+        if (usumGt(pos, size_t(24U*argsNum), binarySize))
+            throw BinException("GalliumBinary is too small!!!");
+        pos += 24U*argsNum;
+    }
+    
+    if (usumGt(pos, size_t(4U), binarySize))
+        throw BinException("GalliumBinary is too small!!!");
+    const uint32_t sectionsNum = ULEV(*reinterpret_cast<const uint32_t*>(binary+pos));
+    pos += 4;
+    size_t codeSize = 0;
+    bool elfFound = false;
+    // find first text section (inner ELF binary)
+    for (uint32_t i = 0; i < sectionsNum && !elfFound; i++)
+    {
+        if (usumGt(pos, size_t(20U), binarySize))
+            throw BinException("GalliumBinary is too small!!!");
+        const uint32_t* data32 = reinterpret_cast<const uint32_t*>(binary+pos);
+        const uint32_t secType = ULEV(data32[1]);
+        const size_t secSize = ULEV(data32[2]);
+        pos += 20;
+        if (usumGt(pos, secSize, binarySize))
+            throw BinException("Section size is too big!!!");
+        if (secType == cxuint(GalliumSectionType::TEXT) ||
+            secType == cxuint(GalliumSectionType::TEXT_EXECUTABLE_170))
+        {
+            if (secSize < sizeof(Elf32_Ehdr))
+                throw BinException("Wrong GalliumElfBinary size");
+            probe.is64Bit = (binary[pos+EI_CLASS] == ELFCLASS64);
+            if (binary[pos+EI_CLASS] == ELFCLASS32)
+                codeSize = getGalliumCodeSize<Elf32Types>(secSize, binary+pos);
+            else if (probe.is64Bit)
+                codeSize = getGalliumCodeSize<Elf64Types>(secSize, binary+pos);
+            else // wrong class
+                throw BinException("Wrong GalliumElfBinary class");
+            elfFound = true;
+        }
+        pos += secSize;
+    }
+    if (!elfFound)
+        throw BinException("Gallium Elf binary not found!");
+    
+    // kernel code ends at next kernel or at end of code
+    std::vector<size_t> offsets(kernelOffsets);
+    std::sort(offsets.begin(), offsets.end());
+    for (cxuint i = 0; i < kernelsNum; i++)
+    {
+        auto next = std::upper_bound(offsets.begin(), offsets.end(), kernelOffsets[i]);
+        const size_t end = (next != offsets.end()) ? *next : codeSize;
+        probe.kernels[i].codeSize = end >= kernelOffsets[i] ? end - kernelOffsets[i] : 0;
+    }
+}
+
+void CLRX::probeBinary(size_t binarySize, cxbyte* binary, BinaryProbe& probe)
+{
+    probe.format = detectBinaryFormat(binarySize, binary);
+    probe.is64Bit = false;
+    probe.hasDeviceType = false;
+    probe.deviceType = GPUDeviceType::CAPE_VERDE;
+    probe.kernels.clear();
+    
+    switch (probe.format)
+    {
+        case BinaryProbeFormat::AMD:
+        {
+            probe.is64Bit = (binary[EI_CLASS] == ELFCLASS64);
+            const Elf32_Ehdr* ehdr = reinterpret_cast<const Elf32_Ehdr*>(binary);
+            // e_machine at same place in 32-bit and 64-bit header
+            if (ULEV(ehdr->e_machine) == ELF_M_X86)
+                break; // X86 binary has no GPU kernels
+            if (!probe.is64Bit)
+                probeAmdGPUBinary(ElfBinary32(binarySize, binary, 0), probe);
+            else
+                probeAmdGPUBinary(ElfBinary64(binarySize, binary, 0), probe);
+            break;
+        }
+        case BinaryProbeFormat::AMDCL2:
+            probe.is64Bit = (binary[EI_CLASS] == ELFCLASS64);
+            if (!probe.is64Bit)
+                probeAmdCL2Binary(ElfBinary32(binarySize, binary, 0), probe);
+            else
+                probeAmdCL2Binary(ElfBinary64(binarySize, binary, 0), probe);
+            break;
+        case BinaryProbeFormat::ROCM:
+            probe.is64Bit = true;
+            probeROCmBinary(ElfBinary64(binarySize, binary, 0), probe);
+            break;
+        default:
+            probeGalliumBinary(binarySize, binary, probe);
+            break;
+    }
+}
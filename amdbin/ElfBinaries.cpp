@@ -30,6 +30,7 @@
 #include <CLRX/utils/Utilities.h>
 #include <CLRX/utils/MemAccess.h>
 #include <CLRX/amdbin/AmdBinaries.h>
+#include <CLRX/amdbin/BinaryIndex.h>
 
 static const uint32_t elfMagicValue = 0x464c457fU;
 
@@ -87,9 +88,25 @@ template<typename Types>
 ElfBinaryTemplate<Types>::~ElfBinaryTemplate()
 { }
 
+/* fill map (sorted array of names and indices) by order from binary index.
+ * if not trusted, check whether names are sorted */
+template<typename GetName>
+static void fillMapFromIndex(Array<std::pair<const char*, size_t> >& map,
+            const std::vector<uint32_t>& indexMap, bool trusted, GetName getName)
+{
+    for (size_t i = 0; i < map.size(); i++)
+    {
+        map[i] = std::make_pair(getName(indexMap[i]), indexMap[i]);
+        if (!trusted && i != 0 && ::strcmp(map[i-1].first, map[i].first) > 0)
+            throw BinException("Binary index doesn't match names");
+    }
+}
+
 template<typename Types>
 ElfBinaryTemplate<Types>::ElfBinaryTemplate(size_t _binaryCodeSize, cxbyte* _binaryCode,
-             Flags _creationFlags) : creationFlags(_creationFlags),
+             Flags _creationFlags, uint64_t expectedChecksum, bool checksumVerified,
+             const BinaryIndex* index)
+        : creationFlags(_creationFlags),
         binaryCodeSize(_binaryCodeSize), binaryCode(_binaryCode),
         sectionStringTable(nullptr), symbolStringTable(nullptr),
         symbolTable(nullptr), dynSymStringTable(nullptr), dynSymTable(nullptr),
@@ -111,6 +128,20 @@ ElfBinaryTemplate<Types>::ElfBinaryTemplate(size_t _binaryCodeSize, cxbyte* _bin
     if (ehdr->e_ident[EI_DATA] != ELFDATA2LSB)
         throw BinException("Other than little-endian binaries are not supported!");
     
+    // trusted binary: only header and tables of headers are checked
+    // (inner binary is verified with containing binary)
+    if (index != nullptr)
+    {
+        // index must be built from this binary
+        if (!checksumVerified && !index->matches(binaryCodeSize, binaryCode))
+            throw BinException("Binary index doesn't match binary");
+        if (index->is64BitBinary() != (Types::ELFCLASS == ELFCLASS64))
+            throw BinException("Binary index doesn't match ELF class");
+    }
+    else if (!checksumVerified)
+        verifyTrustedBinary(binaryCodeSize, binaryCode, creationFlags, expectedChecksum);
+    const bool trusted = (creationFlags & BINARY_CREATE_TRUSTED) != 0;
+    
     if ((ULEV(ehdr->e_phoff) == 0 && ULEV(ehdr->e_phnum) != 0))
         throw BinException("Elf invalid phoff and phnum combination");
     if (ULEV(ehdr->e_phoff) != 0)
@@ -123,7 +154,7 @@ ElfBinaryTemplate<Types>::ElfBinaryTemplate(size_t _binaryCodeSize, cxbyte* _bin
                    binaryCodeSize))
             throw BinException("ProgramHeaders offset+size out of range!");
         
-        cxuint phnum = ULEV(ehdr->e_phnum);
+        cxuint phnum = trusted ? 0 : ULEV(ehdr->e_phnum);
         // checking program header segment offset ranges
         for (cxuint i = 0; i < phnum; i++)
         {
@@ -151,8 +182,8 @@ ElfBinaryTemplate<Types>::ElfBinaryTemplate(size_t _binaryCodeSize, cxbyte* _bin
         
         typename Types::Shdr& shstrShdr = getSectionHeader(ULEV(ehdr->e_shstrndx));
         sectionStringTable = binaryCode + ULEV(shstrShdr.sh_offset);
-        const size_t unfinishedShstrPos = unfinishedRegionOfStringTable(
-                    sectionStringTable, ULEV(shstrShdr.sh_size));
+        const size_t unfinishedShstrPos = trusted ? SIZE_MAX :
+                unfinishedRegionOfStringTable(sectionStringTable, ULEV(shstrShdr.sh_size));
         
         const typename Types::Shdr* symTableHdr = nullptr;
         const typename Types::Shdr* dynSymTableHdr = nullptr;
@@ -160,31 +191,40 @@ ElfBinaryTemplate<Types>::ElfBinaryTemplate(size_t _binaryCodeSize, cxbyte* _bin
         const typename Types::Shdr* dynamicTableHdr = nullptr;
         
         cxuint shnum = ULEV(ehdr->e_shnum);
+        // section and symbol maps from binary index are already sorted
+        const bool sectionMapFromIndex = index != nullptr &&
+                (creationFlags & ELF_CREATE_SECTIONMAP) != 0;
+        const bool symbolMapFromIndex = index != nullptr &&
+                (creationFlags & ELF_CREATE_SYMBOLMAP) != 0;
+        if (sectionMapFromIndex && index->getSectionMap().size() != shnum)
+            throw BinException("Binary index doesn't match sections");
         if ((creationFlags & ELF_CREATE_SECTIONMAP) != 0)
             sectionIndexMap.resize(shnum);
         for (cxuint i = 0; i < shnum; i++)
         {
             const typename Types::Shdr& shdr = getSectionHeader(i);
-            /// checking section offset ranges
-            if (ULEV(shdr.sh_offset) > binaryCodeSize)
-                throw BinException("Section offset out of range!");
-            if (ULEV(shdr.sh_type) != SHT_NOBITS)
-                if (usumGt(ULEV(shdr.sh_offset), ULEV(shdr.sh_size), binaryCodeSize))
-                    throw BinException("Section offset+size out of range!");
-            if (ULEV(shdr.sh_link) >= ULEV(ehdr->e_shnum))
-                throw BinException("Section link out of range!");
-            
             const typename Types::Size sh_nameindx = ULEV(shdr.sh_name);
-            if (sh_nameindx >= ULEV(shstrShdr.sh_size))
-                throw BinException("Section name index out of range!");
-            
-            if (sh_nameindx >= unfinishedShstrPos)
-                throw BinException("Unfinished section name!");
+            if (!trusted)
+            {
+                /// checking section offset ranges
+                if (ULEV(shdr.sh_offset) > binaryCodeSize)
+                    throw BinException("Section offset out of range!");
+                if (ULEV(shdr.sh_type) != SHT_NOBITS)
+                    if (usumGt(ULEV(shdr.sh_offset), ULEV(shdr.sh_size), binaryCodeSize))
+                        throw BinException("Section offset+size out of range!");
+                if (ULEV(shdr.sh_link) >= ULEV(ehdr->e_shnum))
+                    throw BinException("Section link out of range!");
+                
+                if (sh_nameindx >= ULEV(shstrShdr.sh_size))
+                    throw BinException("Section name index out of range!");
+                if (sh_nameindx >= unfinishedShstrPos)
+                    throw BinException("Unfinished section name!");
+            }
             
             const char* shname =
                 reinterpret_cast<const char*>(sectionStringTable + sh_nameindx);
             
-            if ((creationFlags & ELF_CREATE_SECTIONMAP) != 0)
+            if ((creationFlags & ELF_CREATE_SECTIONMAP) != 0 && !sectionMapFromIndex)
                 sectionIndexMap[i] = std::make_pair(shname, i);
             // set symbol table and dynamic symbol table pointers
             if (ULEV(shdr.sh_type) == SHT_SYMTAB)
@@ -196,8 +236,12 @@ ElfBinaryTemplate<Types>::ElfBinaryTemplate(size_t _binaryCodeSize, cxbyte* _bin
             if (ULEV(shdr.sh_type) == SHT_DYNAMIC)
                 dynamicTableHdr = &shdr;
         }
-        // sort section's map (really is array of sections)
-        if ((creationFlags & ELF_CREATE_SECTIONMAP) != 0)
+        // sort section's map (really is array of sections) or take it from index
+        if (sectionMapFromIndex)
+            fillMapFromIndex(sectionIndexMap, index->getSectionMap(), trusted,
+                [this](size_t i)
+                { return getSectionName(i); });
+        else if ((creationFlags & ELF_CREATE_SECTIONMAP) != 0)
             mapSort(sectionIndexMap.begin(), sectionIndexMap.end(), CStringLess());
         
         if (symTableHdr != nullptr)
@@ -214,9 +258,11 @@ ElfBinaryTemplate<Types>::ElfBinaryTemplate(size_t _binaryCodeSize, cxbyte* _bin
             typename Types::Shdr& symstrShdr = getSectionHeader(ULEV(symTableHdr->sh_link));
             symbolStringTable = binaryCode + ULEV(symstrShdr.sh_offset);
             
-            const size_t unfinishedSymstrPos = unfinishedRegionOfStringTable(
-                    symbolStringTable, ULEV(symstrShdr.sh_size));
+            const size_t unfinishedSymstrPos = trusted ? SIZE_MAX :
+                    unfinishedRegionOfStringTable(symbolStringTable, ULEV(symstrShdr.sh_size));
             symbolsNum = ULEV(symTableHdr->sh_size)/ULEV(symTableHdr->sh_entsize);
+            if (symbolMapFromIndex && index->getSymbolMap().size() != symbolsNum)
+                throw BinException("Binary index doesn't match symbols");
             if ((creationFlags & ELF_CREATE_SYMBOLMAP) != 0)
                 symbolIndexMap.resize(symbolsNum);
             
@@ -225,7 +271,7 @@ ElfBinaryTemplate<Types>::ElfBinaryTemplate(size_t _binaryCodeSize, cxbyte* _bin
                 /* verify symbol names */
                 const typename Types::Sym& sym = getSymbol(i);
                 const typename Types::Size symnameindx = ULEV(sym.st_name);
-                if (symnameindx >= ULEV(symstrShdr.sh_size))
+                if (!trusted && symnameindx >= ULEV(symstrShdr.sh_size))
                     throw BinException("Symbol name index out of range!");
                 // check whether name is finished in string section content
                 if (symnameindx >= unfinishedSymstrPos)
@@ -234,11 +280,15 @@ ElfBinaryTemplate<Types>::ElfBinaryTemplate(size_t _binaryCodeSize, cxbyte* _bin
                 const char* symname =
                     reinterpret_cast<const char*>(symbolStringTable + symnameindx);
                 // add to symbol map
-                if ((creationFlags & ELF_CREATE_SYMBOLMAP) != 0)
+                if ((creationFlags & ELF_CREATE_SYMBOLMAP) != 0 && !symbolMapFromIndex)
                     symbolIndexMap[i] = std::make_pair(symname, i);
             }
-            // sort symbol's map (really is array of symbols)
-            if ((creationFlags & ELF_CREATE_SYMBOLMAP) != 0)
+            // sort symbol's map (really is array of symbols) or take it from index
+            if (symbolMapFromIndex)
+                fillMapFromIndex(symbolIndexMap, index->getSymbolMap(), trusted,
+                    [this](size_t i)
+                    { return getSymbolName(i); });
+            else if ((creationFlags & ELF_CREATE_SYMBOLMAP) != 0)
                 mapSort(symbolIndexMap.begin(), symbolIndexMap.end(), CStringLess());
         }
         if (dynSymTableHdr != nullptr)
@@ -257,8 +307,8 @@ ElfBinaryTemplate<Types>::ElfBinaryTemplate(size_t _binaryCodeSize, cxbyte* _bin
             dynSymbolsNum = ULEV(dynSymTableHdr->sh_size)/ULEV(dynSymTableHdr->sh_entsize);
             
             dynSymStringTable = binaryCode + ULEV(dynSymstrShdr.sh_offset);
-            const size_t unfinishedSymstrPos = unfinishedRegionOfStringTable(
-                    dynSymStringTable, ULEV(dynSymstrShdr.sh_size));
+            const size_t unfinishedSymstrPos = trusted ? SIZE_MAX :
+                    unfinishedRegionOfStringTable(dynSymStringTable, ULEV(dynSymstrShdr.sh_size));
             
             if ((creationFlags & ELF_CREATE_DYNSYMMAP) != 0)
                 dynSymIndexMap.resize(dynSymbolsNum);
@@ -268,7 +318,7 @@ ElfBinaryTemplate<Types>::ElfBinaryTemplate(size_t _binaryCodeSize, cxbyte* _bin
                 /* verify symbol names */
                 const typename Types::Sym& sym = getDynSymbol(i);
                 const typename Types::Size symnameindx = ULEV(sym.st_name);
-                if (symnameindx >= ULEV(dynSymstrShdr.sh_size))
+                if (!trusted && symnameindx >= ULEV(dynSymstrShdr.sh_size))
                     throw BinException("DynSymbol name index out of range!");
                 // check whether name is finished in string section content
                 if (symnameindx >= unfinishedSymstrPos)
@@ -369,6 +419,41 @@ bool CLRX::isElfBinary(size_t binarySize, const cxbyte* binary)
     return true;
 }
 
+uint64_t CLRX::calculateBinaryChecksum(size_t binarySize, const cxbyte* binary)
+{
+    /* four independent lanes of multiply-xor-rotate (over little-endian 8-byte words),
+     * every step is bijection, hence change of single word always changes checksum */
+    const uint64_t prime = 0x9e3779b97f4a7c15ULL;
+    uint64_t lanes[4] = { prime, prime^1, prime^2, prime^3 };
+    size_t pos = 0;
+    for (; pos+32 <= binarySize; pos += 32)
+        for (cxuint k = 0; k < 4; k++)
+        {
+            uint64_t word;
+            ::memcpy(&word, binary + pos + (k<<3), 8);
+            const uint64_t v = (lanes[k] ^ ULEV(word)) * prime;
+            lanes[k] = (v<<31) | (v>>33);
+        }
+    // remaining bytes
+    uint64_t hash = uint64_t(binarySize) * prime;
+    for (; pos < binarySize; pos++)
+        hash = (hash ^ binary[pos]) * 0x100000001b3ULL;
+    for (cxuint k = 0; k < 4; k++)
+    {
+        hash = (hash ^ lanes[k]) * prime;
+        hash ^= hash>>29;
+    }
+    return hash;
+}
+
+void CLRX::verifyTrustedBinary(size_t binarySize, const cxbyte* binary,
+                Flags creationFlags, uint64_t expectedChecksum)
+{
+    if ((creationFlags & BINARY_CREATE_TRUSTED) != 0 &&
+        calculateBinaryChecksum(binarySize, binary) != expectedChecksum)
+        throw BinException("Checksum of trusted binary doesn't match");
+}
+
 /*
  * Elf binary generator
  */
@@ -31,6 +31,7 @@
 #include <CLRX/utils/InputOutput.h>
 #include <CLRX/utils/Containers.h>
 #include <CLRX/amdbin/GalliumBinaries.h>
+#include <CLRX/amdbin/BinaryIndex.h>
 
 using namespace CLRX;
 
@@ -118,6 +119,8 @@ void GalliumElfBinaryBase::loadFromElf(ElfBinary& elfBinary, size_t kernelsNum)
     {
         progInfoEntryMap.resize(progInfosNum);
         mapSort(progInfoEntryMap.begin(), progInfoEntryMap.end(), CStringLess());
+        if ((elfBinary.getCreationFlags() & BINARY_CREATE_NAMEHASHINDEX) != 0)
+            progInfoEntryIndex.build(progInfoEntryMap.begin(), progInfoEntryMap.end());
     }
 }
 
@@ -167,8 +170,10 @@ GalliumElfBinary32::~GalliumElfBinary32()
 { }
 
 GalliumElfBinary32::GalliumElfBinary32(size_t binaryCodeSize, cxbyte* binaryCode,
-           Flags creationFlags, size_t kernelsNum) :
-           ElfBinary32(binaryCodeSize, binaryCode, creationFlags|ELF_CREATE_SYMBOLMAP),
+           Flags creationFlags, size_t kernelsNum, bool checksumVerified,
+           const BinaryIndex* index) :
+           ElfBinary32(binaryCodeSize, binaryCode, creationFlags|ELF_CREATE_SYMBOLMAP,
+                   0, checksumVerified, index),
            textRelsNum(0), textRelEntrySize(0), textRel(nullptr)
 {
     loadFromElf(static_cast<const ElfBinary32&>(*this), kernelsNum);
@@ -197,8 +202,10 @@ GalliumElfBinary64::~GalliumElfBinary64()
 { }
 
 GalliumElfBinary64::GalliumElfBinary64(size_t binaryCodeSize, cxbyte* binaryCode,
-           Flags creationFlags, size_t kernelsNum) :
-           ElfBinary64(binaryCodeSize, binaryCode, creationFlags|ELF_CREATE_SYMBOLMAP),
+           Flags creationFlags, size_t kernelsNum, bool checksumVerified,
+           const BinaryIndex* index) :
+           ElfBinary64(binaryCodeSize, binaryCode, creationFlags|ELF_CREATE_SYMBOLMAP,
+                   0, checksumVerified, index),
            textRelsNum(0), textRelEntrySize(0), textRel(nullptr)
 {
     loadFromElf(static_cast<const ElfBinary64&>(*this), kernelsNum);
@@ -223,8 +230,10 @@ uint32_t GalliumElfBinaryBase::getProgramInfoEntriesNum(uint32_t index) const
 
 uint32_t GalliumElfBinaryBase::getProgramInfoEntryIndex(const char* name) const
 {
-    ProgInfoEntryIndexMap::const_iterator it = binaryMapFind(progInfoEntryMap.begin(),
-                         progInfoEntryMap.end(), name, CStringLess());
+    ProgInfoEntryIndexMap::const_iterator it = progInfoEntryIndex.empty() ?
+            binaryMapFind(progInfoEntryMap.begin(), progInfoEntryMap.end(), name,
+                    CStringLess()) :
+            progInfoEntryIndex.find(progInfoEntryMap.begin(), progInfoEntryMap.end(), name);
     if (it == progInfoEntryMap.end())
         throw BinException("Can't find GalliumElf ProgInfoEntry");
     return it->second;
@@ -274,11 +283,22 @@ static void verifyKernelSymbols(size_t kernelsNum, const GalliumKernel* kernels,
 }
 
 GalliumBinary::GalliumBinary(size_t _binaryCodeSize, cxbyte* _binaryCode,
-                 Flags _creationFlags) : creationFlags(_creationFlags),
+                 Flags _creationFlags, uint64_t expectedChecksum, const BinaryIndex* index)
+         : creationFlags(_creationFlags),
          binaryCodeSize(_binaryCodeSize), binaryCode(_binaryCode),
          kernelsNum(0), sectionsNum(0), kernels(nullptr), sections(nullptr),
          elf64BitBinary(false), mesa170(false)
 {
+    // inner ELF binary doesn't verify checksum again
+    if (index != nullptr)
+    {
+        if (index->getFormat() != BinaryProbeFormat::GALLIUM)
+            throw BinException("Binary index is not for Gallium binary");
+        if (!index->matches(binaryCodeSize, binaryCode))
+            throw BinException("Binary index doesn't match binary");
+    }
+    else
+        verifyTrustedBinary(binaryCodeSize, binaryCode, creationFlags, expectedChecksum);
     if (binaryCodeSize < 4)
         throw BinException("GalliumBinary is too small!!!");
     uint32_t* data32 = reinterpret_cast<uint32_t*>(binaryCode);
@@ -388,7 +408,9 @@ GalliumBinary::GalliumBinary(size_t _binaryCodeSize, cxbyte* _binaryCode,
             {
                 // 32-bit
                 elfBinary.reset(new GalliumElfBinary32(section.size, data,
-                                 creationFlags>>GALLIUM_INNER_SHIFT, kernelsNum));
+                        (creationFlags>>GALLIUM_INNER_SHIFT) |
+                        (creationFlags & BINARY_CREATE_COMMON), kernelsNum, true,
+                        index));
                 elf64BitBinary = false;
             }
             else if (ehdr.e_ident[EI_CLASS] == ELFCLASS64)
@@ -396,7 +418,9 @@ GalliumBinary::GalliumBinary(size_t _binaryCodeSize, cxbyte* _binaryCode,
                 // 64-bit
                 elfSectionId = section.sectionId;
                 elfBinary.reset(new GalliumElfBinary64(section.size, data,
-                                 creationFlags>>GALLIUM_INNER_SHIFT, kernelsNum));
+                        (creationFlags>>GALLIUM_INNER_SHIFT) |
+                        (creationFlags & BINARY_CREATE_COMMON), kernelsNum, true,
+                        index));
                 elf64BitBinary = true;
             }
             else // wrong class
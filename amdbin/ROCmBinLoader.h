@@ -0,0 +1,74 @@
+/*
+ *  CLRadeonExtender - Unofficial OpenCL Radeon Extensions Library
+ *  Copyright (C) 2014-2018 Mateusz Szpakowski
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef __CLRX_ROCMBINLOADER_H__
+#define __CLRX_ROCMBINLOADER_H__
+
+#include <CLRX/Config.h>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include <CLRX/amdbin/ElfBinaries.h>
+#include <CLRX/utils/Containers.h>
+#include <CLRX/utils/CString.h>
+
+/* loading parts common for ROCm binaries and AMD3 binaries (code object V3):
+ * regions of code, kernel descriptor symbols, GOT symbols and notes */
+
+namespace CLRX
+{
+
+// region of code (kernel or data) given by symbol of '.text' section
+struct CLRX_INTERNAL ROCmCodeRegion
+{
+    size_t symIndex;    // symbol index
+    size_t offset;      // offset in binary
+    size_t size;        // size limited by next region or by end of code
+    cxbyte symType;     // symbol type (STT_OBJECT for data)
+};
+
+// return section index or SHN_UNDEF if section not found
+CLRX_INTERNAL cxuint findROCmSectionIndex(const ElfBinary64& elfBin, const char* name);
+
+/* get regions from symbols of '.text' section (in symbol order).
+ * funcRegions - function symbols are regions (else only STT_GNU_IFUNC and data),
+ * kernelConfigSize - size of kernel config before kernel code,
+ * checkKernelSizes - check whether kernel (STT_GNU_IFUNC) holds kernel config */
+CLRX_INTERNAL void getROCmCodeRegions(const ElfBinary64& elfBin, cxuint textIndex,
+            bool funcRegions, size_t kernelConfigSize, bool checkKernelSizes,
+            bool trusted, std::vector<ROCmCodeRegion>& regions);
+
+// get kernel descriptor symbols (name without '.kd' and symbol value)
+CLRX_INTERNAL void getROCmKernelDescSymbols(const ElfBinary64& elfBin,
+            cxuint rodataIndex, std::vector<std::pair<CString, uint64_t> >& kernelDescs);
+
+// load GOT symbols (symbol indices of '.rela.dyn' entries)
+CLRX_INTERNAL void loadROCmGotSymbols(const ElfBinary64& elfBin, bool trusted,
+            Array<size_t>& gotSymbols);
+
+/* get metadata and target from notes. if acceptMetadataV2 is false, then
+ * only MetadataV3 (MsgPack) is accepted */
+CLRX_INTERNAL void getROCmNotes(const ElfBinary64& elfBin, bool trusted,
+            bool acceptMetadataV2, char*& metadata, size_t& metadataSize,
+            bool& metadataV3Format, CString& target);
+
+};
+
+#endif
@@ -34,6 +34,8 @@
 #include <CLRX/utils/InputOutput.h>
 #include <CLRX/utils/Containers.h>
 #include <CLRX/amdbin/ROCmBinaries.h>
+#include <CLRX/amdbin/BinaryIndex.h>
+#include "ROCmBinLoader.h"
 
 using namespace CLRX;
 
@@ -42,243 +44,273 @@ using namespace CLRX;
  * ROCm binary reader and generator
  */
 
-/* TODO: add support for various kernel code offset (now only 256 is supported) */
-
-ROCmBinary::ROCmBinary(size_t binaryCodeSize, cxbyte* binaryCode, Flags creationFlags)
-        : ElfBinary64(binaryCodeSize, binaryCode, creationFlags),
-          regionsNum(0), codeSize(0), code(nullptr),
-          globalDataSize(0), globalData(nullptr), metadataSize(0), metadata(nullptr),
-          newBinFormat(false), llvm10BinFormat(false), metadataV3Format(false)
+cxuint CLRX::findROCmSectionIndex(const ElfBinary64& elfBin, const char* name)
 {
-    cxuint textIndex = SHN_UNDEF;
     try
-    { textIndex = getSectionIndex(".text"); }
+    { return elfBin.getSectionIndex(name); }
     catch(const Exception& ex)
-    { } // ignore failed
+    { return SHN_UNDEF; } // ignore failed
+}
+
+void CLRX::getROCmCodeRegions(const ElfBinary64& elfBin, cxuint textIndex,
+            bool funcRegions, size_t kernelConfigSize, bool checkKernelSizes,
+            bool trusted, std::vector<ROCmCodeRegion>& regions)
+{
     uint64_t codeOffset = 0;
-    // find '.text' section
-    if (textIndex!=SHN_UNDEF)
+    size_t codeSize = 0;
+    if (textIndex != SHN_UNDEF)
     {
-        code = getSectionContent(textIndex);
-        const Elf64_Shdr& textShdr = getSectionHeader(textIndex);
+        const Elf64_Shdr& textShdr = elfBin.getSectionHeader(textIndex);
         codeSize = ULEV(textShdr.sh_size);
         codeOffset = ULEV(textShdr.sh_offset);
     }
+    const size_t codeEnd = codeOffset + codeSize;
     
-    if (getHeader().e_ident[EI_ABIVERSION] == 1)
-        llvm10BinFormat = true; // likely llvm10 bin format
-    
-    cxuint rodataIndex = SHN_UNDEF;
-    const cxbyte* rodataContent = nullptr;
-    try
-    { rodataIndex = getSectionIndex(".rodata"); }
-    catch(const Exception& ex)
-    { } // ignore failed
-    // find '.text' section
-    if (rodataIndex!=SHN_UNDEF)
-    {
-        rodataContent = globalData = getSectionContent(rodataIndex);
-        const Elf64_Shdr& rodataShdr = getSectionHeader(rodataIndex);
-        globalDataSize = ULEV(rodataShdr.sh_size);
-    }
-    
-    cxuint gpuConfigIndex = SHN_UNDEF;
-    try
-    { gpuConfigIndex = getSectionIndex(".AMDGPU.config"); }
-    catch(const Exception& ex)
-    { } // ignore failed
-    newBinFormat = (gpuConfigIndex == SHN_UNDEF);
-    
-    cxuint relaDynIndex = SHN_UNDEF;
-    try
-    { relaDynIndex = getSectionIndex(".rela.dyn"); }
-    catch(const Exception& ex)
-    { } // ignore failed
-    
-    cxuint gotIndex = SHN_UNDEF;
-    try
-    { gotIndex = getSectionIndex(".got"); }
-    catch(const Exception& ex)
-    { } // ignore failed
-    
-    // counts regions (symbol or kernel)
-    std::vector<std::pair<CString, size_t> > tmpKernelDescs;
-    regionsNum = 0;
-    const size_t symbolsNum = getSymbolsNum();
+    regions.clear();
+    const size_t symbolsNum = elfBin.getSymbolsNum();
     for (size_t i = 0; i < symbolsNum; i++)
     {
-        // count regions number
-        const Elf64_Sym& sym = getSymbol(i);
-        const cxbyte symType = ELF64_ST_TYPE(sym.st_info);
-        const cxbyte bind = ELF64_ST_BIND(sym.st_info);
-        Elf64_Half shndx = ULEV(sym.st_shndx);
-        if (shndx==textIndex &&
-            (symType==STT_GNU_IFUNC ||
-                (symType==STT_FUNC && (!newBinFormat || llvm10BinFormat)) ||
-                (bind==STB_GLOBAL && symType==STT_OBJECT)))
-            regionsNum++;
-        if (llvm10BinFormat && shndx==rodataIndex && symType==STT_OBJECT)
-        {
-            const char* symName = getSymbolName(i);
-            size_t symNameLen = ::strlen(symName);
-            // if symname have '.kd' at end
-            if (symNameLen > 3 && symName[symNameLen-3]=='.' &&
-                symName[symNameLen-2]=='k' && symName[symNameLen-1]=='d')
-                tmpKernelDescs.push_back({ CString(symName, symName+symNameLen-3),
-                            size_t(ULEV(sym.st_value)) });
-        }
-    }
-    if (llvm10BinFormat)
-    {
-        if (rodataContent==nullptr)
-            throw BinException("No rodata section in ROCm LLVM10Bin format");
-        mapSort(tmpKernelDescs.begin(), tmpKernelDescs.end());
-        kernelDescs.resize(regionsNum);
-        std::fill(kernelDescs.begin(), kernelDescs.end(), nullptr);
-    }
-    
-    if (code==nullptr && regionsNum!=0)
-        throw BinException("No code if regions number is not zero");
-    regions.reset(new ROCmRegion[regionsNum]);
-    size_t j = 0;
-    typedef std::pair<uint64_t, size_t> RegionOffsetEntry;
-    std::unique_ptr<RegionOffsetEntry[]> symOffsets(new RegionOffsetEntry[regionsNum]);
-    
-    // get regions info
-    for (size_t i = 0; i < symbolsNum; i++)
-    {
-        const Elf64_Sym& sym = getSymbol(i);
+        const Elf64_Sym& sym = elfBin.getSymbol(i);
         if (ULEV(sym.st_shndx)!=textIndex)
             continue;   // if not in '.text' section
-        const size_t value = ULEV(sym.st_value);
-        if (value < codeOffset)
-            throw BinException("Region offset is too small!");
-        const size_t size = ULEV(sym.st_size);
-        
         const cxbyte symType = ELF64_ST_TYPE(sym.st_info);
         const cxbyte bind = ELF64_ST_BIND(sym.st_info);
-        if (symType==STT_GNU_IFUNC || symType==STT_FUNC ||
-                (bind==STB_GLOBAL && symType==STT_OBJECT))
+        if (!(symType==STT_GNU_IFUNC || (symType==STT_FUNC && funcRegions) ||
+                (bind==STB_GLOBAL && symType==STT_OBJECT)))
+            continue;
+        if (textIndex == SHN_UNDEF)
+            throw BinException("No code if regions number is not zero");
+        
+        const size_t value = ULEV(sym.st_value);
+        if (!trusted)
         {
-            ROCmRegionType type = ROCmRegionType::DATA;
-            // if kernel
-            if (symType==STT_GNU_IFUNC) 
-                type = ROCmRegionType::KERNEL;
-            // if function kernel
-            else if (symType==STT_FUNC)
-            {
-                if (newBinFormat && !llvm10BinFormat)
-                    continue;
-                type = llvm10BinFormat ? ROCmRegionType::KERNEL : ROCmRegionType::FKERNEL;
-            }
-            symOffsets[j] = std::make_pair(value, j);
-            if (type!=ROCmRegionType::DATA && value+0x100 > codeOffset+codeSize)
+            if (value < codeOffset)
+                throw BinException("Region offset is too small!");
+            if (symType==STT_OBJECT && value > codeEnd)
+                throw BinException("Region offset is too big!");
+            if (symType!=STT_OBJECT && value+kernelConfigSize > codeEnd)
                 throw BinException("Kernel or code offset is too big!");
-            const char* symName = getSymbolName(i);
-            regions[j] = { symName, size, value, type };
-            if (llvm10BinFormat)
-            {
-                auto it = binaryMapFind(tmpKernelDescs.begin(), tmpKernelDescs.end(),
-                                        CString(symName));
-                if (it != tmpKernelDescs.end())
-                    kernelDescs[j] = reinterpret_cast<const ROCmKernelDescriptor*>(
-                                binaryCode + it->second);
-                else
-                    kernelDescs[j] = nullptr;
-            }
-            j++;
         }
+        regions.push_back({ i, value, size_t(ULEV(sym.st_size)), symType });
     }
+    
     // sort regions by offset
-    std::sort(symOffsets.get(), symOffsets.get()+regionsNum,
+    typedef std::pair<uint64_t, size_t> RegionOffsetEntry;
+    std::vector<RegionOffsetEntry> symOffsets(regions.size());
+    for (size_t i = 0; i < regions.size(); i++)
+        symOffsets[i] = std::make_pair(regions[i].offset, i);
+    std::sort(symOffsets.begin(), symOffsets.end(),
             [](const RegionOffsetEntry& a, const RegionOffsetEntry& b)
             { return a.first < b.first; });
     // checking distance between regions
-    for (size_t i = 1; i <= regionsNum; i++)
+    for (size_t i = 1; i <= symOffsets.size(); i++)
     {
-        size_t end = (i<regionsNum) ? symOffsets[i].first : codeOffset+codeSize;
-        ROCmRegion& region = regions[symOffsets[i-1].second];
-        if (!llvm10BinFormat)
-            if (region.type==ROCmRegionType::KERNEL && symOffsets[i-1].first+0x100 > end)
+        size_t end = (i<symOffsets.size()) ? symOffsets[i].first : codeEnd;
+        ROCmCodeRegion& region = regions[symOffsets[i-1].second];
+        if (checkKernelSizes && !trusted)
+            if (region.symType==STT_GNU_IFUNC &&
+                symOffsets[i-1].first+kernelConfigSize > end)
                 throw BinException("Kernel size is too small!");
         
-        const size_t regSize = end - symOffsets[i-1].first;
+        const size_t regSize = (end >= region.offset) ? end - region.offset : 0;
         if (region.size==0)
             region.size = regSize;
         else
             region.size = std::min(regSize, region.size);
     }
+}
+
+void CLRX::getROCmKernelDescSymbols(const ElfBinary64& elfBin, cxuint rodataIndex,
+            std::vector<std::pair<CString, uint64_t> >& kernelDescs)
+{
+    kernelDescs.clear();
+    if (rodataIndex == SHN_UNDEF)
+        return;
+    const size_t symbolsNum = elfBin.getSymbolsNum();
+    for (size_t i = 0; i < symbolsNum; i++)
+    {
+        const Elf64_Sym& sym = elfBin.getSymbol(i);
+        if (ULEV(sym.st_shndx)!=rodataIndex || ELF64_ST_TYPE(sym.st_info)!=STT_OBJECT)
+            continue;
+        const char* symName = elfBin.getSymbolName(i);
+        size_t symNameLen = ::strlen(symName);
+        // if symname have '.kd' at end
+        if (symNameLen > 3 && symName[symNameLen-3]=='.' &&
+            symName[symNameLen-2]=='k' && symName[symNameLen-1]=='d')
+            kernelDescs.push_back({ CString(symName, symName+symNameLen-3),
+                        uint64_t(ULEV(sym.st_value)) });
+    }
+}
+
+void CLRX::loadROCmGotSymbols(const ElfBinary64& elfBin, bool trusted,
+            Array<size_t>& gotSymbols)
+{
+    const cxuint relaDynIndex = findROCmSectionIndex(elfBin, ".rela.dyn");
+    const cxuint gotIndex = findROCmSectionIndex(elfBin, ".got");
+    if (relaDynIndex == SHN_UNDEF || gotIndex == SHN_UNDEF)
+        return;
     
-    // load got symbols
-    if (relaDynIndex != SHN_UNDEF && gotIndex != SHN_UNDEF)
+    const Elf64_Shdr& relaShdr = elfBin.getSectionHeader(relaDynIndex);
+    const Elf64_Shdr& gotShdr = elfBin.getSectionHeader(gotIndex);
+    
+    size_t relaEntrySize = ULEV(relaShdr.sh_entsize);
+    if (relaEntrySize==0)
+        relaEntrySize = sizeof(Elf64_Rela);
+    const size_t relaEntriesNum = ULEV(relaShdr.sh_size)/relaEntrySize;
+    const size_t gotEntriesNum = ULEV(gotShdr.sh_size) >> 3;
+    if (gotEntriesNum != relaEntriesNum)
+        throw BinException("RelaDyn entries number and GOT entries "
+                    "number doesn't match!");
+    
+    // initialize GOT symbols table
+    gotSymbols.resize(gotEntriesNum);
+    const cxbyte* relaDyn = elfBin.getSectionContent(relaDynIndex);
+    for (size_t i = 0; i < relaEntriesNum; i++)
     {
-        const Elf64_Shdr& relaShdr = getSectionHeader(relaDynIndex);
-        const Elf64_Shdr& gotShdr = getSectionHeader(gotIndex);
-        
-        size_t relaEntrySize = ULEV(relaShdr.sh_entsize);
-        if (relaEntrySize==0)
-            relaEntrySize = sizeof(Elf64_Rela);
-        const size_t relaEntriesNum = ULEV(relaShdr.sh_size)/relaEntrySize;
-        const size_t gotEntriesNum = ULEV(gotShdr.sh_size) >> 3;
-        if (gotEntriesNum != relaEntriesNum)
-            throw BinException("RelaDyn entries number and GOT entries "
-                        "number doesn't match!");
-        
-        // initialize GOT symbols table
-        gotSymbols.resize(gotEntriesNum);
-        const cxbyte* relaDyn = getSectionContent(relaDynIndex);
-        for (size_t i = 0; i < relaEntriesNum; i++)
+        const Elf64_Rela& rela = *reinterpret_cast<const Elf64_Rela*>(
+                        relaDyn + relaEntrySize*i);
+        size_t symIndex = ELF64_R_SYM(ULEV(rela.r_info));
+        if (!trusted)
         {
-            const Elf64_Rela& rela = *reinterpret_cast<const Elf64_Rela*>(
-                            relaDyn + relaEntrySize*i);
             // check rela entry fields
             if (ULEV(rela.r_offset) != ULEV(gotShdr.sh_offset) + i*8)
                 throw BinException("Wrong dyn relocation offset");
             if (ULEV(rela.r_addend) != 0ULL)
                 throw BinException("Wrong dyn relocation addend");
-            size_t symIndex = ELF64_R_SYM(ULEV(rela.r_info));
-            if (symIndex >= getDynSymbolsNum())
+            if (symIndex >= elfBin.getDynSymbolsNum())
                 throw BinException("Dyn relocation symbol index out of range");
-            // just set in gotSymbols
-            gotSymbols[i] = symIndex;
         }
+        // just set in gotSymbols
+        gotSymbols[i] = symIndex;
     }
-    
-    // get metadata
-    const size_t notesSize = getNotesSize();
-    const cxbyte* noteContent = (const cxbyte*)getNotes();
+}
+
+void CLRX::getROCmNotes(const ElfBinary64& elfBin, bool trusted, bool acceptMetadataV2,
+            char*& metadata, size_t& metadataSize, bool& metadataV3Format,
+            CString& target)
+{
+    const size_t notesSize = elfBin.getNotesSize();
+    cxbyte* noteContent = (cxbyte*)elfBin.getNotes();
     
     for (size_t offset = 0; offset < notesSize; )
     {
         const Elf64_Nhdr* nhdr = (const Elf64_Nhdr*)(noteContent + offset);
         size_t namesz = ULEV(nhdr->n_namesz);
         size_t descsz = ULEV(nhdr->n_descsz);
-        if (usumGt(offset, namesz+descsz, notesSize))
+        if (!trusted && usumGt(offset, namesz+descsz, notesSize))
             throw BinException("Note offset+size out of range");
         
         const size_t alignedNamesz = ((namesz+3)&~size_t(3));
-        if ((namesz==4 &&
-            ::strcmp((const char*)noteContent+offset+ sizeof(Elf64_Nhdr), "AMD")==0) ||
-            (namesz==7 &&
-            ::strcmp((const char*)noteContent+offset+ sizeof(Elf64_Nhdr), "AMDGPU")==0))
+        const char* noteName = (const char*)noteContent+offset+sizeof(Elf64_Nhdr);
+        char* desc = (char*)(noteContent+offset+sizeof(Elf64_Nhdr) + alignedNamesz);
+        const uint32_t noteType = ULEV(nhdr->n_type);
+        if (namesz==7 && noteType == 0x20 && ::strcmp(noteName, "AMDGPU")==0)
+        {
+            // MetadataV3 (MsgPack)
+            metadataV3Format = true;
+            metadata = desc;
+            metadataSize = descsz;
+        }
+        else if (namesz==4 && ::strcmp(noteName, "AMD")==0)
         {
-            const uint32_t noteType = ULEV(nhdr->n_type);
-            if ((noteType == 0xa && namesz==4) || (noteType == 0x20 && namesz==7))
+            if (noteType == 0xa && acceptMetadataV2)
             {
-                if (namesz==7)
-                    metadataV3Format = true;
-                if (namesz==4 && metadataV3Format)
+                if (metadataV3Format)
                     throw Exception("MetadataV2 in MetadataV3 compliant binary!");
-                metadata = (char*)(noteContent+offset+sizeof(Elf64_Nhdr) + alignedNamesz);
+                metadata = desc;
                 metadataSize = descsz;
             }
-            else if (noteType == 0xb && namesz==4)
-                target.assign((char*)(noteContent+offset+sizeof(Elf64_Nhdr) +
-                                        alignedNamesz), descsz);
+            else if (noteType == 0xb)
+                target.assign(desc, descsz);
         }
         size_t align = (((alignedNamesz+descsz)&3)!=0) ? 4-((alignedNamesz+descsz)&3) : 0;
         offset += sizeof(Elf64_Nhdr) + alignedNamesz + descsz + align;
     }
+}
+
+/*
+ * ROCm binary reader and generator
+ */
+
+/* TODO: add support for various kernel code offset (now only 256 is supported) */
+
+ROCmBinary::ROCmBinary(size_t binaryCodeSize, cxbyte* binaryCode, Flags creationFlags,
+            uint64_t expectedChecksum, const BinaryIndex* index)
+        : ElfBinary64(binaryCodeSize, binaryCode, creationFlags, expectedChecksum,
+                false, index),
+          regionsNum(0), codeSize(0), code(nullptr),
+          globalDataSize(0), globalData(nullptr), metadataSize(0), metadata(nullptr),
+          newBinFormat(false), llvm10BinFormat(false), metadataV3Format(false)
+{
+    if (index != nullptr && index->getFormat() != BinaryProbeFormat::ROCM)
+        throw BinException("Binary index is not for ROCm binary");
+    // skip bound checks for trusted binary
+    const bool trusted = (creationFlags & BINARY_CREATE_TRUSTED) != 0;
+    // find '.text' section
+    const cxuint textIndex = findROCmSectionIndex(*this, ".text");
+    if (textIndex!=SHN_UNDEF)
+    {
+        code = getSectionContent(textIndex);
+        codeSize = ULEV(getSectionHeader(textIndex).sh_size);
+    }
+    
+    if (getHeader().e_ident[EI_ABIVERSION] == 1)
+        llvm10BinFormat = true; // likely llvm10 bin format
+    
+    // find '.rodata' section
+    const cxuint rodataIndex = findROCmSectionIndex(*this, ".rodata");
+    if (rodataIndex!=SHN_UNDEF)
+    {
+        globalData = getSectionContent(rodataIndex);
+        globalDataSize = ULEV(getSectionHeader(rodataIndex).sh_size);
+    }
+    
+    newBinFormat = (findROCmSectionIndex(*this, ".AMDGPU.config") == SHN_UNDEF);
+    
+    // get regions (symbols or kernels), kernel config (256 bytes) precedes kernel code
+    std::vector<ROCmCodeRegion> codeRegions;
+    getROCmCodeRegions(*this, textIndex, !newBinFormat || llvm10BinFormat, 0x100,
+                !llvm10BinFormat, trusted, codeRegions);
+    regionsNum = codeRegions.size();
+    regions.reset(new ROCmRegion[regionsNum]);
+    
+    std::vector<std::pair<CString, uint64_t> > tmpKernelDescs;
+    if (llvm10BinFormat)
+    {
+        if (globalData==nullptr)
+            throw BinException("No rodata section in ROCm LLVM10Bin format");
+        getROCmKernelDescSymbols(*this, rodataIndex, tmpKernelDescs);
+        mapSort(tmpKernelDescs.begin(), tmpKernelDescs.end());
+        kernelDescs.resize(regionsNum);
+        std::fill(kernelDescs.begin(), kernelDescs.end(), nullptr);
+    }
+    
+    for (size_t i = 0; i < regionsNum; i++)
+    {
+        const ROCmCodeRegion& codeRegion = codeRegions[i];
+        ROCmRegionType type = ROCmRegionType::DATA;
+        // if kernel
+        if (codeRegion.symType==STT_GNU_IFUNC)
+            type = ROCmRegionType::KERNEL;
+        // if function kernel
+        else if (codeRegion.symType==STT_FUNC)
+            type = llvm10BinFormat ? ROCmRegionType::KERNEL : ROCmRegionType::FKERNEL;
+        const char* symName = getSymbolName(codeRegion.symIndex);
+        regions[i] = { symName, codeRegion.size, codeRegion.offset, type };
+        if (llvm10BinFormat)
+        {
+            auto it = binaryMapFind(tmpKernelDescs.begin(), tmpKernelDescs.end(),
+                                    CString(symName));
+            if (it != tmpKernelDescs.end())
+                kernelDescs[i] = reinterpret_cast<const ROCmKernelDescriptor*>(
+                            binaryCode + it->second);
+        }
+    }
+    
+    // load got symbols
+    loadROCmGotSymbols(*this, trusted, gotSymbols);
+    // get metadata
+    getROCmNotes(*this, trusted, true, metadata, metadataSize, metadataV3Format, target);
     
     if (hasRegionMap())
     {
@@ -288,17 +320,23 @@ ROCmBinary::ROCmBinary(size_t binaryCodeSize, cxbyte* binaryCode, Flags creation
             regionsMap[i] = std::make_pair(regions[i].regionName, i);
         // sort region map
         mapSort(regionsMap.begin(), regionsMap.end());
+        if ((creationFlags & BINARY_CREATE_NAMEHASHINDEX) != 0)
+            regionsIndex.build(regionsMap.begin(), regionsMap.end());
     }
     
     if ((creationFlags & ROCMBIN_CREATE_METADATAINFO) != 0 &&
         metadata != nullptr && metadataSize != 0)
     {
         metadataInfo.reset(new ROCmMetadata());
+        // parse kernels by all hardware threads if parallel parsing enabled
+        const cxuint threadsNum =
+                ((creationFlags & ROCMBIN_PARALLEL_METADATAINFO) != 0) ? 0 : 1;
         if (!metadataV3Format)
-            parseROCmMetadata(metadataSize, metadata, *metadataInfo);
+            parseROCmMetadata(metadataSize, metadata, *metadataInfo, threadsNum);
         else
             parseROCmMetadataMsgPack(metadataSize,
-                    reinterpret_cast<const cxbyte*>(metadata), *metadataInfo);
+                    reinterpret_cast<const cxbyte*>(metadata), *metadataInfo,
+                    threadsNum);
         
         if (hasKernelInfoMap())
         {
@@ -308,23 +346,41 @@ ROCmBinary::ROCmBinary(size_t binaryCodeSize, cxbyte* binaryCode, Flags creation
                 kernelInfosMap[i] = std::make_pair(kernels[i].name, i);
             // sort region map
             mapSort(kernelInfosMap.begin(), kernelInfosMap.end());
+            if ((creationFlags & BINARY_CREATE_NAMEHASHINDEX) != 0)
+                kernelInfosIndex.build(kernelInfosMap.begin(), kernelInfosMap.end());
         }
     }
+    
+    if ((creationFlags & ROCMBIN_CREATE_METADATAVIEW) != 0 &&
+        metadata != nullptr && metadataSize != 0)
+    {
+        // strings of metadata view points to metadata of this binary
+        metadataView.reset(new ROCmMetadataView());
+        const cxuint threadsNum =
+                ((creationFlags & ROCMBIN_PARALLEL_METADATAINFO) != 0) ? 0 : 1;
+        if (!metadataV3Format)
+            parseROCmMetadata(metadataSize, metadata, *metadataView, threadsNum);
+        else
+            parseROCmMetadataMsgPack(metadataSize,
+                    reinterpret_cast<const cxbyte*>(metadata), *metadataView,
+                    threadsNum);
+    }
 }
 
 /// determint GPU device from ROCm notes
-GPUDeviceType ROCmBinary::determineGPUDeviceType(uint32_t& outArchMinor,
-                     uint32_t& outArchStepping) const
+GPUDeviceType CLRX::determineROCmGPUDeviceType(const ElfBinary64& elfBin,
+            bool llvm10BinFormat, uint32_t& outArchMinor, uint32_t& outArchStepping)
 {
     uint32_t archMajor = 0;
     uint32_t archMinor = 0;
     uint32_t archStepping = 0;
     
     {
-        const cxbyte* noteContent = (const cxbyte*)getNotes();
-        if (noteContent==nullptr)
+        const cxbyte* noteContent = (const cxbyte*)elfBin.getNotes();
+        // LLVM10 binary (or code object V3) without notes is Navi binary
+        if (noteContent==nullptr && !llvm10BinFormat)
             throw BinException("Missing notes in inner binary!");
-        size_t notesSize = getNotesSize();
+        size_t notesSize = elfBin.getNotesSize();
         // find note about AMDGPU
         for (size_t offset = 0; offset < notesSize; )
         {
@@ -346,7 +402,7 @@ GPUDeviceType ROCmBinary::determineGPUDeviceType(uint32_t& outArchMinor,
             offset += sizeof(Elf64_Nhdr) + namesz + descsz + align;
         }
     }
-    if (llvm10BinFormat && archMajor==0 && archMajor==0 && archStepping==0)
+    if (llvm10BinFormat && archMajor==0 && archMinor==0 && archStepping==0)
     {
         // default is Navi
         outArchMinor = 1;
@@ -361,10 +417,17 @@ GPUDeviceType ROCmBinary::determineGPUDeviceType(uint32_t& outArchMinor,
     return deviceType;
 }
 
+GPUDeviceType ROCmBinary::determineGPUDeviceType(uint32_t& archMinor,
+                     uint32_t& archStepping) const
+{
+    return determineROCmGPUDeviceType(*this, llvm10BinFormat, archMinor, archStepping);
+}
+
 const ROCmRegion& ROCmBinary::getRegion(const char* name) const
 {
-    RegionMap::const_iterator it = binaryMapFind(regionsMap.begin(),
-                             regionsMap.end(), name);
+    RegionMap::const_iterator it = regionsIndex.empty() ?
+            binaryMapFind(regionsMap.begin(), regionsMap.end(), name) :
+            regionsIndex.find(regionsMap.begin(), regionsMap.end(), name);
     if (it == regionsMap.end())
         throw BinException("Can't find region name");
     return regions[it->second];
@@ -374,8 +437,9 @@ const ROCmKernelMetadata& ROCmBinary::getKernelInfo(const char* name) const
 {
     if (!hasMetadataInfo())
         throw BinException("Can't find kernel info name");
-    RegionMap::const_iterator it = binaryMapFind(kernelInfosMap.begin(),
-                             kernelInfosMap.end(), name);
+    RegionMap::const_iterator it = kernelInfosIndex.empty() ?
+            binaryMapFind(kernelInfosMap.begin(), kernelInfosMap.end(), name) :
+            kernelInfosIndex.find(kernelInfosMap.begin(), kernelInfosMap.end(), name);
     if (it == kernelInfosMap.end())
         throw BinException("Can't find kernel info name");
     return metadataInfo->kernels[it->second];
@@ -383,8 +447,9 @@ const ROCmKernelMetadata& ROCmBinary::getKernelInfo(const char* name) const
 
 const ROCmKernelDescriptor* ROCmBinary::getKernelDescriptor(const char* name) const
 {
-    RegionMap::const_iterator it = binaryMapFind(regionsMap.begin(),
-                             regionsMap.end(), name);
+    RegionMap::const_iterator it = regionsIndex.empty() ?
+            binaryMapFind(regionsMap.begin(), regionsMap.end(), name) :
+            regionsIndex.find(regionsMap.begin(), regionsMap.end(), name);
     if (it == regionsMap.end())
         throw BinException("Can't find kernel descriptor name");
     return kernelDescs[it->second];
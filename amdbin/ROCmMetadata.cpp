@@ -28,14 +28,12 @@
 #include <CLRX/utils/InputOutput.h>
 #include <CLRX/utils/Containers.h>
 #include <CLRX/amdbin/ROCmBinaries.h>
+#include "ROCmMetadataOutput.h"
 
-
-namespace CLRX
-{
-void parsePrintfInfoString(const char* ptr2, const char* end2, size_t oldLineNo,
-                size_t lineNo, ROCmPrintfInfo& printfInfo,
-                std::unordered_set<cxuint>& printfIds);
-};
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define CLRX_ROCMMD_SSE2 1
+#endif
 
 using namespace CLRX;
 /*
@@ -66,6 +64,182 @@ void ROCmMetadata::initialize()
     version[1] = 0;
 }
 
+void ROCmKernelMetadataView::initialize()
+{
+    langVersion[0] = langVersion[1] = BINGEN_NOTSUPPLIED;
+    reqdWorkGroupSize[0] = reqdWorkGroupSize[1] = reqdWorkGroupSize[2] = 0;
+    workGroupSizeHint[0] = workGroupSizeHint[1] = workGroupSizeHint[2] = 0;
+    kernargSegmentSize = BINGEN64_NOTSUPPLIED;
+    groupSegmentFixedSize = BINGEN64_NOTSUPPLIED;
+    privateSegmentFixedSize = BINGEN64_NOTSUPPLIED;
+    kernargSegmentAlign = BINGEN64_NOTSUPPLIED;
+    wavefrontSize = BINGEN_NOTSUPPLIED;
+    sgprsNum = BINGEN_NOTSUPPLIED;
+    vgprsNum = BINGEN_NOTSUPPLIED;
+    maxFlatWorkGroupSize = BINGEN64_NOTSUPPLIED;
+    fixedWorkGroupSize[0] = fixedWorkGroupSize[1] = fixedWorkGroupSize[2] = 0;
+    spilledSgprs = BINGEN_NOTSUPPLIED;
+    spilledVgprs = BINGEN_NOTSUPPLIED;
+}
+
+void ROCmMetadataView::initialize()
+{
+    version[0] = 1;
+    version[1] = 0;
+}
+
+ROCmMetadataArena::ROCmMetadataArena(ROCmMetadataArena&& arena) noexcept
+    : chunks(std::move(arena.chunks)), chunkPtr(arena.chunkPtr),
+      chunkLeft(arena.chunkLeft), lastChunkSize(arena.lastChunkSize)
+{
+    arena.chunkPtr = nullptr;
+    arena.chunkLeft = arena.lastChunkSize = 0;
+}
+
+ROCmMetadataArena& ROCmMetadataArena::operator=(ROCmMetadataArena&& arena) noexcept
+{
+    chunks = std::move(arena.chunks);
+    chunkPtr = arena.chunkPtr;
+    chunkLeft = arena.chunkLeft;
+    lastChunkSize = arena.lastChunkSize;
+    arena.chunkPtr = nullptr;
+    arena.chunkLeft = arena.lastChunkSize = 0;
+    return *this;
+}
+
+void ROCmMetadataArena::reset(size_t firstChunkSize)
+{
+    chunks.clear();
+    chunkPtr = nullptr;
+    chunkLeft = lastChunkSize = 0;
+    if (firstChunkSize != 0)
+    {
+        firstChunkSize = (firstChunkSize+7) & ~size_t(7);
+        chunks.push_back(std::unique_ptr<char[]>(new char[firstChunkSize]));
+        chunkPtr = chunks.back().get();
+        chunkLeft = lastChunkSize = firstChunkSize;
+    }
+}
+
+void* ROCmMetadataArena::allocate(size_t size)
+{
+    size = (size+7) & ~size_t(7);
+    if (size > chunkLeft)
+    {
+        // next chunk is twice greater than previous
+        const size_t chunkSize = std::max(std::max(size, lastChunkSize<<1), size_t(4096));
+        chunks.push_back(std::unique_ptr<char[]>(new char[chunkSize]));
+        chunkPtr = chunks.back().get();
+        chunkLeft = lastChunkSize = chunkSize;
+    }
+    void* ptr = chunkPtr;
+    chunkPtr += size;
+    chunkLeft -= size;
+    return ptr;
+}
+
+// trim spaces (remove spaces from start and end)
+static ROCmStringRef trimStrSpaces(ROCmStringRef str)
+{
+    size_t i = 0;
+    const size_t sz = str.size;
+    while (i!=sz && isSpace(str.ptr[i])) i++;
+    if (i == sz) return { str.ptr, 0 };
+    size_t j = sz-1;
+    while (j>i && isSpace(str.ptr[j])) j--;
+    return { str.ptr+i, j-i+1 };
+}
+
+// null-terminated copy of string reference (to find string in name tables)
+class CLRX_INTERNAL ROCmStringRefCStr
+{
+private:
+    char buf[64];
+    std::string longStr;
+    const char* cstr;
+public:
+    explicit ROCmStringRefCStr(ROCmStringRef str)
+    {
+        if (str.size < sizeof(buf))
+        {
+            std::copy(str.ptr, str.ptr+str.size, buf);
+            buf[str.size] = 0;
+            cstr = buf;
+        }
+        else
+        {
+            longStr.assign(str.ptr, str.size);
+            cstr = longStr.c_str();
+        }
+    }
+    
+    const char* c_str() const
+    { return cstr; }
+};
+
+/*
+ * fast scanning of YAML text: spaces and special characters are found
+ * 16 bytes at once (with SSE2) instead of checking character by character
+ */
+
+// find first character c0, c1 or c2 (or end). characters can be repeated
+static inline const char* findYAMLChar3(const char* ptr, const char* end,
+            char c0, char c1, char c2)
+{
+#ifdef CLRX_ROCMMD_SSE2
+    const __m128i c0vec = _mm_set1_epi8(c0);
+    const __m128i c1vec = _mm_set1_epi8(c1);
+    const __m128i c2vec = _mm_set1_epi8(c2);
+    for (; end-ptr >= 16; ptr += 16)
+    {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+        const cxuint mask = _mm_movemask_epi8(_mm_or_si128(_mm_or_si128(
+                _mm_cmpeq_epi8(v, c0vec), _mm_cmpeq_epi8(v, c1vec)),
+                _mm_cmpeq_epi8(v, c2vec)));
+        if (mask != 0)
+            return ptr + CTZ32(mask);
+    }
+#endif
+    for (; ptr != end; ptr++)
+        if (*ptr == c0 || *ptr == c1 || *ptr == c2)
+            return ptr;
+    return end;
+}
+
+// find end of line (newline or end)
+static inline const char* findYAMLLineEnd(const char* ptr, const char* end)
+{
+    const char* lineEnd = reinterpret_cast<const char*>(::memchr(ptr, '\n', end-ptr));
+    return lineEnd != nullptr ? lineEnd : end;
+}
+
+static inline void skipSpacesToLineEnd(const char*& ptr, const char* end)
+{
+#ifdef CLRX_ROCMMD_SSE2
+    // space or tab, vertical tab, form feed, carriage return (9-13 without newline)
+    const __m128i spaceVec = _mm_set1_epi8(' ');
+    const __m128i nineVec = _mm_set1_epi8(9);
+    const __m128i fourVec = _mm_set1_epi8(4);
+    const __m128i nlVec = _mm_set1_epi8('\n');
+    for (; end-ptr >= 16; ptr += 16)
+    {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+        const __m128i v9 = _mm_sub_epi8(v, nineVec);
+        // (c-9) <= 4 (unsigned)
+        const __m128i ctrlSpace = _mm_cmpeq_epi8(_mm_min_epu8(v9, fourVec), v9);
+        const __m128i space = _mm_or_si128(_mm_cmpeq_epi8(v, spaceVec),
+                _mm_andnot_si128(_mm_cmpeq_epi8(v, nlVec), ctrlSpace));
+        const cxuint mask = _mm_movemask_epi8(space);
+        if (mask != 0xffffU)
+        {
+            ptr += CTZ32(~mask);
+            return;
+        }
+    }
+#endif
+    while (ptr != end && *ptr!='\n' && isSpace(*ptr)) ptr++;
+}
+
 // return trailing spaces
 static size_t skipSpacesAndComments(const char*& ptr, const char* end, size_t& lineNo)
 {
@@ -73,13 +247,13 @@ static size_t skipSpacesAndComments(const char*& ptr, const char* end, size_t& l
     while (ptr != end)
     {
         lineStart = ptr;
-        while (ptr != end && *ptr!='\n' && isSpace(*ptr)) ptr++;
+        skipSpacesToLineEnd(ptr, end);
         if (ptr == end)
             break; // end of stream
         if (*ptr=='#')
         {
             // skip comment
-            while (ptr != end && *ptr!='\n') ptr++;
+            ptr = findYAMLLineEnd(ptr, end);
             if (ptr == end)
                 return 0; // no trailing spaces and end
         }
@@ -94,11 +268,6 @@ static size_t skipSpacesAndComments(const char*& ptr, const char* end, size_t& l
     return ptr - lineStart;
 }
 
-static inline void skipSpacesToLineEnd(const char*& ptr, const char* end)
-{
-    while (ptr != end && *ptr!='\n' && isSpace(*ptr)) ptr++;
-}
-
 static void skipSpacesToNextLine(const char*& ptr, const char* end, size_t& lineNo)
 {
     skipSpacesToLineEnd(ptr, end);
@@ -106,7 +275,7 @@ static void skipSpacesToNextLine(const char*& ptr, const char* end, size_t& line
         throw ParseException(lineNo, "Garbages at line");
     if (ptr != end && *ptr == '#')
         // skip comment at end of line
-        while (ptr!=end && *ptr!='\n') ptr++;
+        ptr = findYAMLLineEnd(ptr, end);
     if (ptr!=end)
     {   // newline
         ptr++;
@@ -180,7 +349,7 @@ static size_t parseYAMLKey(const char*& ptr, const char* end, size_t lineNo,
     if (afterColon == ptr && ptr != end && *ptr!='\n')
         // only if not immediate newline
         throw ParseException(lineNo, "After key and colon must be space");
-    CString keyword(keyPtr, keyEnd);
+    const ROCmStringRefCStr keyword({ keyPtr, size_t(keyEnd-keyPtr) });
     const size_t index = binaryFind(keywords, keywords+keywordsNum,
                         keyword.c_str(), CStringLess()) - keywords;
     return index;
@@ -238,7 +407,7 @@ static bool parseYAMLBoolValue(const char*& ptr, const char* end, size_t& lineNo
     
     const char* wordPtr = ptr;
     while(ptr != end && isAlnum(*ptr)) ptr++;
-    CString word(wordPtr, ptr);
+    const ROCmStringRefCStr word({ wordPtr, size_t(ptr-wordPtr) });
     
     bool value = false;
     bool isSet = false;
@@ -265,35 +434,42 @@ static bool parseYAMLBoolValue(const char*& ptr, const char* end, size_t& lineNo
     return value;
 }
 
-// trim spaces (remove spaces from start and end)
-static std::string trimStrSpaces(const std::string& str)
+/* pool for decoded strings: decoded string is stored at same offset as
+ * its source in metadata. Decoded string is never longer than its source,
+ * hence strings never overlap and pool can be filled by many threads */
+struct CLRX_INTERNAL YAMLStringPool
 {
-    size_t i = 0;
-    const size_t sz = str.size();
-    while (i!=sz && isSpace(str[i])) i++;
-    if (i == sz) return "";
-    size_t j = sz-1;
-    while (j>i && isSpace(str[j])) j--;
-    return str.substr(i, j-i+1);
-}
+    const char* metadata;
+    char* pool;
+    
+    char* at(const char* srcPtr) const
+    { return pool + (srcPtr - metadata); }
+};
 
-static std::string parseYAMLString(const char*& linePtr, const char* end,
-            size_t& lineNo)
+/* string without escapes points to metadata, otherwise string is decoded
+ * to string pool */
+static ROCmStringRef parseYAMLString(const char*& linePtr, const char* end,
+            size_t& lineNo, const YAMLStringPool& strPool)
 {
-    std::string strarray;
     if (linePtr == end || (*linePtr != '"' && *linePtr != '\''))
     {
         while (linePtr != end && !isSpace(*linePtr) && *linePtr != ',') linePtr++;
         throw ParseException(lineNo, "Expected string");
     }
     const char termChar = *linePtr;
+    char* const outStart = strPool.at(linePtr);
+    char* out = nullptr; // set if string has escapes
     linePtr++;
+    const char* strStart = linePtr;
     
     // main loop, where is character parsing
     while (linePtr != end && *linePtr != termChar)
     {
         if (*linePtr == '\\')
         {
+            if (out == nullptr)
+                // copy string before first escape
+                out = std::copy(strStart, linePtr, outStart);
             // escape
             linePtr++;
             uint16_t value;
@@ -378,27 +554,40 @@ static std::string parseYAMLString(const char*& linePtr, const char* end,
                         value = c;
                 }
             }
-            strarray.push_back(value);
+            *out++ = value;
         }
-        else // regular character
+        else if (*linePtr=='\n')
         {
-            if (*linePtr=='\n')
-                lineNo++;
-            strarray.push_back(*linePtr++);
+            lineNo++;
+            if (out != nullptr)
+                *out++ = *linePtr;
+            linePtr++;
+        }
+        else
+        {
+            // regular characters (to next special character)
+            const char* runEnd = findYAMLChar3(linePtr, end, termChar, '\\', '\n');
+            if (out != nullptr)
+                out = std::copy(linePtr, runEnd, out);
+            linePtr = runEnd;
         }
     }
     if (linePtr == end)
         throw ParseException(lineNo, "Unterminated string");
+    const char* strEnd = linePtr;
     linePtr++;
-    return strarray;
+    if (out == nullptr)
+        return { strStart, size_t(strEnd-strStart) };
+    return { outStart, size_t(out-outStart) };
 }
 
-static std::string parseYAMLStringValue(const char*& ptr, const char* end, size_t& lineNo,
-                    cxuint prevIndent, bool singleValue = false, bool blockAccept = true)
+static ROCmStringRef parseYAMLStringValue(const char*& ptr, const char* end,
+            size_t& lineNo, const YAMLStringPool& strPool, cxuint prevIndent,
+            bool singleValue = false, bool blockAccept = true)
 {
     skipSpacesToLineEnd(ptr, end);
     if (ptr == end)
-        return "";
+        return { ptr, 0 };
     
     // skip !!str
     YAMLValType valType = parseYAMLType(ptr, end, lineNo);
@@ -406,14 +595,14 @@ static std::string parseYAMLStringValue(const char*& ptr, const char* end, size_
     {   // if 
         skipSpacesToLineEnd(ptr, end);
         if (ptr == end)
-            return "";
+            return { ptr, 0 };
     }
     else if (valType != YAMLValType::NONE)
         throw ParseException(lineNo, "Expected value of string type");
     
-    std::string buf;
+    ROCmStringRef buf;
     if (*ptr=='"' || *ptr== '\'')
-        buf = parseYAMLString(ptr, end, lineNo);
+        buf = parseYAMLString(ptr, end, lineNo, strPool);
     // otherwise parse stream
     else if (*ptr == '|' || *ptr == '>')
     {
@@ -421,12 +610,14 @@ static std::string parseYAMLStringValue(const char*& ptr, const char* end, size_
             throw ParseException(lineNo, "Illegal block string start");
         // multiline
         bool newLineFold = *ptr=='>';
+        char* const outStart = strPool.at(ptr);
+        char* out = outStart;
         ptr++;
         skipSpacesToLineEnd(ptr, end);
         if (ptr!=end && *ptr!='\n')
             throw ParseException(lineNo, "Garbages at string block");
         if (ptr == end)
-            return ""; // end
+            return { ptr, 0 }; // end
         lineNo++;
         ptr++; // skip newline
         const char* lineStart = ptr;
@@ -435,12 +626,11 @@ static std::string parseYAMLStringValue(const char*& ptr, const char* end, size_
         if (indent <= prevIndent)
             throw ParseException(lineNo, "Unindented string block");
         
-        std::string buf;
         while(ptr != end)
         {
             const char* strStart = ptr;
-            while (ptr != end && *ptr!='\n') ptr++;
-            buf.append(strStart, ptr);
+            ptr = findYAMLLineEnd(ptr, end);
+            out = std::copy(strStart, ptr, out);
             
             if (ptr != end) // if new line
             {
@@ -458,7 +648,7 @@ static std::string parseYAMLStringValue(const char*& ptr, const char* end, size_
                 if (ptr != end && *ptr=='\n')
                 {
                     // empty line
-                    buf.append("\n");
+                    *out++ = '\n';
                     ptr++;
                     lineNo++;
                     lineStart = ptr;
@@ -469,10 +659,10 @@ static std::string parseYAMLStringValue(const char*& ptr, const char* end, size_
                 // if smaller indent
                 if (size_t(ptr - lineStart) < indent)
                 {
-                    buf.append("\n"); // always add newline at last line
+                    *out++ = '\n'; // always add newline at last line
                     if (ptr != end)
                         ptr = lineStart;
-                    return buf;
+                    return { outStart, size_t(out-outStart) };
                 }
                 else // if this same and not end of line
                     break;
@@ -481,28 +671,26 @@ static std::string parseYAMLStringValue(const char*& ptr, const char* end, size_
             if (!emptyLines || !newLineFold)
                 // add missing newline after line with text
                 // only if no emptyLines or no newLineFold
-                buf.append(newLineFold ? " " : "\n");
+                *out++ = newLineFold ? ' ' : '\n';
             // to indent
             ptr = lineStart + indent;
         }
-        return buf;
+        return { outStart, size_t(out-outStart) };
     }
     else
     {
         // single line string (unquoted)
         const char* strStart = ptr;
+        ptr = findYAMLChar3(ptr, end, '\n', '#', '\n');
         // automatically trim spaces at ends
         const char* strEnd = ptr;
-        while (ptr != end && *ptr!='\n' && *ptr!='#')
-        {
-            if (!isSpace(*ptr))
-                strEnd = ptr; // to trim at end
-            ptr++;
-        }
+        while (strEnd != strStart && isSpace(strEnd[-1])) strEnd--;
+        if (strEnd != strStart)
+            strEnd--; // last non-space character
         if (strEnd != end && !isSpace(*strEnd))
             strEnd++;
         
-        buf.assign(strStart, strEnd);
+        buf = { strStart, size_t(strEnd-strStart) };
     }
     
     if (singleValue)
@@ -625,17 +813,17 @@ public:
 };
 
 void CLRX::parsePrintfInfoString(const char* ptr2, const char* end2, size_t oldLineNo,
-                size_t lineNo, ROCmPrintfInfo& printfInfo,
-                std::unordered_set<cxuint>& printfIds)
+                size_t lineNo, uint32_t& printfId, std::vector<uint32_t>& argSizes,
+                ROCmStringRef& format, std::unordered_set<cxuint>& printfIds)
 {
     skipSpacesToLineEnd(ptr2, end2);
     try
-    { printfInfo.id = cstrtovCStyle<uint32_t>(ptr2, end2, ptr2); }
+    { printfId = cstrtovCStyle<uint32_t>(ptr2, end2, ptr2); }
     catch(const ParseException& ex)
     { throw ParseException(oldLineNo, ex.what()); }
     
     // check printf id uniqueness
-    if (!printfIds.insert(printfInfo.id).second)
+    if (!printfIds.insert(printfId).second)
         throw ParseException(oldLineNo, "Duplicate of printf id");
     
     skipSpacesToLineEnd(ptr2, end2);
@@ -649,49 +837,53 @@ void CLRX::parsePrintfInfoString(const char* ptr2, const char* end2, size_t oldL
         throw ParseException(oldLineNo, "No colon after printf argsNum");
     ptr2++;
     
-    printfInfo.argSizes.resize(argsNum);
+    argSizes.resize(argsNum);
     
     // parse arg sizes
     for (size_t i = 0; i < argsNum; i++)
     {
         skipSpacesToLineEnd(ptr2, end2);
-        printfInfo.argSizes[i] = cstrtovCStyle<uint32_t>(ptr2, end2, ptr2);
+        argSizes[i] = cstrtovCStyle<uint32_t>(ptr2, end2, ptr2);
         skipSpacesToLineEnd(ptr2, end2);
         if (ptr2==end2 || *ptr2!=':')
             throw ParseException(lineNo, "No colon after printf argsNum");
         ptr2++;
     }
     // format
-    printfInfo.format.assign(ptr2, end2);
+    format = { ptr2, size_t(end2-ptr2) };
     
 }
 
 // printf info string consumer
+template<typename Output>
 class CLRX_INTERNAL YAMLPrintfVectorConsumer: public YAMLElemConsumer
 {
 private:
     std::unordered_set<cxuint> printfIds;
+    std::vector<uint32_t> argSizes;
+    const YAMLStringPool& strPool;
+    Output& output;
 public:
-    std::vector<ROCmPrintfInfo>& printfInfos;
-    
-    YAMLPrintfVectorConsumer(std::vector<ROCmPrintfInfo>& _printInfos)
-        : printfInfos(_printInfos)
+    YAMLPrintfVectorConsumer(Output& _output, const YAMLStringPool& _strPool)
+        : strPool(_strPool), output(_output)
     { }
     
     virtual void consume(const char*& ptr, const char* end, size_t& lineNo,
                 cxuint prevIndent, bool singleValue, bool blockAccept)
     {
         const size_t oldLineNo = lineNo;
-        std::string str = parseYAMLStringValue(ptr, end, lineNo, prevIndent,
-                                singleValue, blockAccept);
+        const ROCmStringRef str = parseYAMLStringValue(ptr, end, lineNo, strPool,
+                                prevIndent, singleValue, blockAccept);
         // parse printf string
-        ROCmPrintfInfo printfInfo{};
+        uint32_t printfId = 0;
+        ROCmStringRef format;
         
-        const char* ptr2 = str.c_str();
-        const char* end2 = str.c_str() + str.size();
-        parsePrintfInfoString(ptr2, end2, oldLineNo, lineNo, printfInfo, printfIds);
+        const char* ptr2 = str.ptr;
+        const char* end2 = str.ptr + str.size;
+        parsePrintfInfoString(ptr2, end2, oldLineNo, lineNo, printfId, argSizes,
+                    format, printfIds);
         
-        printfInfos.push_back(printfInfo);
+        output.addPrintfInfo(printfId, argSizes, format);
     }
 };
 
@@ -710,7 +902,7 @@ static void skipYAMLValue(const char*& ptr, const char* end, size_t& lineNo,
     if (ptr==end || (*ptr!='\'' && *ptr!='"' && *ptr!='|' && *ptr!='>' && *ptr !='[' &&
                 *ptr!='#' && *ptr!='\n'))
     {
-        while (ptr!=end && *ptr!='\n') ptr++;
+        ptr = findYAMLLineEnd(ptr, end);
         skipSpacesToNextLine(ptr, end, lineNo);
         return;
     }
@@ -718,13 +910,18 @@ static void skipYAMLValue(const char*& ptr, const char* end, size_t& lineNo,
     if (*ptr=='\'' || *ptr=='"')
     {
         const char delim = *ptr++;
-        bool escape = false;
-        while(ptr!=end && (escape || *ptr!=delim))
+        while (true)
         {
-            if (!escape && *ptr=='\\')
-                escape = true;
-            else if (escape)
-                escape = false;
+            ptr = findYAMLChar3(ptr, end, delim, '\\', '\n');
+            if (ptr==end || *ptr==delim)
+                break;
+            if (*ptr=='\\')
+            {
+                // skip escaped character
+                ptr++;
+                if (ptr==end)
+                    break;
+            }
             if (*ptr=='\n') lineNo++;
             ptr++;
         }
@@ -771,7 +968,7 @@ static void skipYAMLValue(const char*& ptr, const char* end, size_t& lineNo,
             blockValue = true;
         }
         if (ptr!=end && *ptr=='#')
-            while (ptr!=end && *ptr!='\n') ptr++;
+            ptr = findYAMLLineEnd(ptr, end);
         else
             skipSpacesToLineEnd(ptr, end);
         if (ptr!=end && *ptr!='\n')
@@ -798,7 +995,7 @@ static void skipYAMLValue(const char*& ptr, const char* end, size_t& lineNo,
                 break;
             }
             
-            while (ptr!=end && *ptr!='\n') ptr++;
+            ptr = findYAMLLineEnd(ptr, end);
             if (ptr!=end)
             {
                 lineNo++;
@@ -932,18 +1129,131 @@ static const char* rocmAddrSpaceTypesTbl[] =
 static const char* rocmAccessQualifierTbl[] =
 { "Default", "ReadOnly", "WriteOnly", "ReadWrite" };
 
-void CLRX::parseROCmMetadata(size_t metadataSize, const char* metadata,
-                ROCmMetadata& metadataInfo)
+// place of kernel record in YAML metadata (found by pre-scan)
+struct CLRX_INTERNAL YAMLKernelRecord
+{
+    const char* start;  // start of line with '-'
+    const char* end;    // start of next line with content or end of last line
+    size_t lineNo;      // line number at start
+    size_t endLineNo;   // line number at end
+    cxuint levels[2];   // indentation of main level and kernels level
+};
+
+/* cheap pre-scan of YAML metadata: find places of kernel records
+ * (lines begins with '-' at kernels level in 'Kernels' block) only by checking
+ * indentation and first characters of lines. Returns false if metadata can not be
+ * split (if it will be failed in normal parsing) */
+static bool findYAMLKernelRecords(const char* ptr, const char* end,
+            std::vector<YAMLKernelRecord>& records)
 {
-    const char* ptr = metadata;
-    const char* end = metadata + metadataSize;
     size_t lineNo = 1;
-    // init metadata info object
-    metadataInfo.kernels.clear();
-    metadataInfo.printfInfos.clear();
-    metadataInfo.version[0] = metadataInfo.version[1] = 0;
+    cxuint mainLevel = UINT_MAX;
+    cxuint kernelsLevel = UINT_MAX;
+    bool inKernels = false;
+    // end of last line with content
+    const char* contentEnd = ptr;
+    size_t contentEndLineNo = 1;
+    while (ptr != end)
+    {
+        const char* lineStart = ptr;
+        skipSpacesToLineEnd(ptr, end);
+        const cxuint level = ptr - lineStart;
+        const char* lineEnd = findYAMLLineEnd(ptr, end);
+        const char* nextLine = (lineEnd != end) ? lineEnd+1 : end;
+        if (ptr == lineEnd || *ptr == '#')
+        {
+            // skip empty line or comment
+            ptr = nextLine;
+            lineNo++;
+            continue;
+        }
+        
+        if (mainLevel == UINT_MAX)
+            mainLevel = level;
+        if (inKernels && level <= mainLevel)
+        {
+            // end of kernels block
+            if (!records.empty() && records.back().end == nullptr)
+            {
+                records.back().end = lineStart;
+                records.back().endLineNo = lineNo;
+            }
+            inKernels = false;
+        }
+        
+        if (inKernels)
+        {
+            if (kernelsLevel == UINT_MAX)
+            {
+                if (*ptr != '-')
+                    return false;
+                kernelsLevel = level;
+            }
+            if (level < kernelsLevel)
+                return false;
+            if (level == kernelsLevel && *ptr == '-')
+            {
+                // new kernel record
+                if (!records.empty() && records.back().end == nullptr)
+                {
+                    records.back().end = lineStart;
+                    records.back().endLineNo = lineNo;
+                }
+                records.push_back({ lineStart, nullptr, lineNo, 0,
+                            { mainLevel, kernelsLevel } });
+            }
+        }
+        else if (level == mainLevel)
+        {
+            if (lineEnd-ptr == 3 && ::memcmp(ptr, "...", 3) == 0)
+                break; // end of the document
+            const char* keyEnd = ptr;
+            while (keyEnd != lineEnd && (isAlnum(*keyEnd) || *keyEnd=='_')) keyEnd++;
+            if (keyEnd-ptr == 7 && ::memcmp(ptr, "Kernels", 7) == 0)
+            {
+                // only spaces and comment can be after colon
+                const char* p = keyEnd;
+                while (p != lineEnd && isSpace(*p)) p++;
+                if (p == lineEnd || *p != ':')
+                    return false;
+                p++;
+                while (p != lineEnd && isSpace(*p)) p++;
+                if (p != lineEnd && *p != '#')
+                    return false;
+                inKernels = true;
+                kernelsLevel = UINT_MAX;
+            }
+        }
+        ptr = nextLine;
+        lineNo++;
+        contentEnd = ptr;
+        contentEndLineNo = lineNo;
+    }
+    if (!records.empty() && records.back().end == nullptr)
+    {
+        records.back().end = contentEnd;
+        records.back().endLineNo = contentEndLineNo;
+    }
+    return true;
+}
+
+/* parse YAML metadata. if records given, then kernel records are skipped
+ * (only placeholders are added to kernels). if kernelRecord given, then only
+ * single kernel record is parsed */
+template<typename Output>
+static void parseROCmMetadataInt(const char* ptr, const char* end, size_t lineNo,
+            Output& out, const YAMLStringPool& strPool,
+            const std::vector<YAMLKernelRecord>* records,
+            const YAMLKernelRecord* kernelRecord)
+{
+    // init metadata info object (kernel record parsing fills only kernel)
+    out.clear();
+    if (kernelRecord == nullptr)
+        out.metadata.version[0] = out.metadata.version[1] = 0;
     
-    std::vector<ROCmKernelMetadata>& kernels = metadataInfo.kernels;
+    typedef typename Output::Kernel Kernel;
+    typedef typename Output::KernelArg KernelArg;
+    std::vector<Kernel>& kernels = out.kernels;
     
     cxuint levels[6] = { UINT_MAX, UINT_MAX, UINT_MAX, UINT_MAX, UINT_MAX, UINT_MAX };
     cxuint curLevel = 0;
@@ -954,11 +1264,21 @@ void CLRX::parseROCmMetadata(size_t metadataSize, const char* metadata,
     bool inKernelCodeProps = false;
     bool inKernelAttrs = false;
     bool canToNextLevel = false;
+    if (kernelRecord != nullptr)
+    {
+        // start at kernel record in kernels block
+        levels[0] = kernelRecord->levels[0];
+        levels[1] = kernelRecord->levels[1];
+        curLevel = 1;
+        inKernels = true;
+    }
     
     size_t oldLineNo = 0;
     while (ptr != end)
     {
         cxuint level = skipSpacesAndComments(ptr, end, lineNo);
+        if (ptr == end && kernelRecord != nullptr)
+            break; // empty lines at end of kernel record
         if (ptr == end || lineNo == oldLineNo)
             throw ParseException(lineNo, "Expected new line");
         
@@ -1005,6 +1325,8 @@ void CLRX::parseROCmMetadata(size_t metadataSize, const char* metadata,
         }
         
         oldLineNo = lineNo;
+        if (curLevel == 0 && kernelRecord != nullptr)
+            throw ParseException(lineNo, "Unexpected end of kernel record");
         if (curLevel == 0)
         {
             if (lineNo==1 && ptr+3 <= end && *ptr=='-' && ptr[1]=='-' && ptr[2]=='-' &&
@@ -1034,13 +1356,13 @@ void CLRX::parseROCmMetadata(size_t metadataSize, const char* metadata,
                     break;
                 case ROCMMT_MAIN_PRINTF:
                 {
-                    YAMLPrintfVectorConsumer consumer(metadataInfo.printfInfos);
+                    YAMLPrintfVectorConsumer<Output> consumer(out, strPool);
                     parseYAMLValArray(ptr, end, lineNo, levels[curLevel], &consumer, true);
                     break;
                 }
                 case ROCMMT_MAIN_VERSION:
                 {
-                    YAMLIntArrayConsumer<uint32_t> consumer(2, metadataInfo.version);
+                    YAMLIntArrayConsumer<uint32_t> consumer(2, out.metadata.version);
                     parseYAMLValArray(ptr, end, lineNo, levels[curLevel], &consumer, true);
                     break;
                 }
@@ -1050,11 +1372,27 @@ void CLRX::parseROCmMetadata(size_t metadataSize, const char* metadata,
             }
         }
         
+        if (curLevel==1 && inKernels && records != nullptr)
+        {
+            // skip kernel record (it will be parsed separately)
+            const size_t ki = kernels.size();
+            if (ki >= records->size() || (*records)[ki].start != ptr-level)
+                throw ParseException(lineNo, "Kernel record not found by pre-scan");
+            kernels.push_back(Kernel());
+            ptr = (*records)[ki].end;
+            lineNo = (*records)[ki].endLineNo;
+            levels[++curLevel] = level + 1;
+            inKernel = true;
+            continue;
+        }
+        
         if (curLevel==1 && inKernels)
         {
             // enter to kernel level
             if (ptr == end || *ptr != '-')
                 throw ParseException(lineNo, "No '-' before kernel object");
+            if (kernelRecord != nullptr && !kernels.empty())
+                throw ParseException(lineNo, "Unexpected next kernel record");
             ptr++;
             const char* afterMinus = ptr;
             skipSpacesToLineEnd(ptr, end);
@@ -1062,7 +1400,10 @@ void CLRX::parseROCmMetadata(size_t metadataSize, const char* metadata,
             level = levels[curLevel];
             inKernel = true;
             
-            kernels.push_back(ROCmKernelMetadata());
+            if (!kernels.empty())
+                // put arguments of previous kernel
+                out.setKernelArgs(kernels.back());
+            kernels.push_back(Kernel());
             kernels.back().initialize();
         }
         
@@ -1072,13 +1413,13 @@ void CLRX::parseROCmMetadata(size_t metadataSize, const char* metadata,
             const size_t keyIndex = parseYAMLKey(ptr, end, lineNo,
                         kernelMetadataKeywordsNum, kernelMetadataKeywords);
             
-            ROCmKernelMetadata& kernel = kernels.back();
+            Kernel& kernel = kernels.back();
             switch(keyIndex)
             {
                 case ROCMMT_KERNEL_ARGS:
                     inKernelArgs = true;
                     canToNextLevel = true;
-                    kernel.argInfos.clear();
+                    out.kernelArgs.clear();
                     break;
                 case ROCMMT_KERNEL_ATTRS:
                     inKernelAttrs = true;
@@ -1112,7 +1453,8 @@ void CLRX::parseROCmMetadata(size_t metadataSize, const char* metadata,
                     canToNextLevel = true;
                     break;
                 case ROCMMT_KERNEL_LANGUAGE:
-                    kernel.language = parseYAMLStringValue(ptr, end, lineNo, level, true);
+                    setROCmMetadataString(kernel.language, parseYAMLStringValue(
+                                ptr, end, lineNo, strPool, level, true));
                     break;
                 case ROCMMT_KERNEL_LANGUAGE_VERSION:
                 {
@@ -1121,10 +1463,12 @@ void CLRX::parseROCmMetadata(size_t metadataSize, const char* metadata,
                     break;
                 }
                 case ROCMMT_KERNEL_NAME:
-                    kernel.name = parseYAMLStringValue(ptr, end, lineNo, level, true);
+                    setROCmMetadataString(kernel.name, parseYAMLStringValue(
+                                ptr, end, lineNo, strPool, level, true));
                     break;
                 case ROCMMT_KERNEL_SYMBOLNAME:
-                    kernel.symbolName = parseYAMLStringValue(ptr, end, lineNo, level, true);
+                    setROCmMetadataString(kernel.symbolName, parseYAMLStringValue(
+                                ptr, end, lineNo, strPool, level, true));
                     break;
                 default:
                     skipYAMLValue(ptr, end, lineNo, level);
@@ -1138,7 +1482,7 @@ void CLRX::parseROCmMetadata(size_t metadataSize, const char* metadata,
             const size_t keyIndex = parseYAMLKey(ptr, end, lineNo,
                         kernelAttrMetadataKeywordsNum, kernelAttrMetadataKeywords);
             
-            ROCmKernelMetadata& kernel = kernels.back();
+            Kernel& kernel = kernels.back();
             switch(keyIndex)
             {
                 case ROCMMT_ATTRS_REQD_WORK_GROUP_SIZE:
@@ -1148,12 +1492,12 @@ void CLRX::parseROCmMetadata(size_t metadataSize, const char* metadata,
                     break;
                 }
                 case ROCMMT_ATTRS_RUNTIME_HANDLE:
-                    kernel.runtimeHandle = parseYAMLStringValue(
-                                ptr, end, lineNo, level, true);
+                    setROCmMetadataString(kernel.runtimeHandle, parseYAMLStringValue(
+                                ptr, end, lineNo, strPool, level, true));
                     break;
                 case ROCMMT_ATTRS_VECTYPEHINT:
-                    kernel.vecTypeHint = parseYAMLStringValue(
-                                ptr, end, lineNo, level, true);
+                    setROCmMetadataString(kernel.vecTypeHint, parseYAMLStringValue(
+                                ptr, end, lineNo, strPool, level, true));
                     break;
                 case ROCMMT_ATTRS_WORK_GROUP_SIZE_HINT:
                 {
@@ -1173,7 +1517,7 @@ void CLRX::parseROCmMetadata(size_t metadataSize, const char* metadata,
             const size_t keyIndex = parseYAMLKey(ptr, end, lineNo,
                         kernelCodePropsKeywordsNum, kernelCodePropsKeywords);
             
-            ROCmKernelMetadata& kernel = kernels.back();
+            Kernel& kernel = kernels.back();
             switch(keyIndex)
             {
                 case ROCMMT_CODEPROPS_FIXED_WORK_GROUP_SIZE:
@@ -1238,7 +1582,7 @@ void CLRX::parseROCmMetadata(size_t metadataSize, const char* metadata,
             level = levels[curLevel];
             inKernelArg = true;
             
-            kernels.back().argInfos.push_back(ROCmKernelArgInfo{});
+            out.kernelArgs.push_back(KernelArg{});
         }
         
         if (curLevel==4 && inKernelArg)
@@ -1247,7 +1591,7 @@ void CLRX::parseROCmMetadata(size_t metadataSize, const char* metadata,
             const size_t keyIndex = parseYAMLKey(ptr, end, lineNo,
                         kernelArgInfosKeywordsNum, kernelArgInfosKeywords);
             
-            ROCmKernelArgInfo& kernelArg = kernels.back().argInfos.back();
+            KernelArg& kernelArg = out.kernelArgs.back();
             
             size_t valLineNo = lineNo;
             switch(keyIndex)
@@ -1255,8 +1599,8 @@ void CLRX::parseROCmMetadata(size_t metadataSize, const char* metadata,
                 case ROCMMT_ARGS_ACCQUAL:
                 case ROCMMT_ARGS_ACTUALACCQUAL:
                 {
-                    const std::string acc = trimStrSpaces(parseYAMLStringValue(
-                                    ptr, end, lineNo, level, true));
+                    const ROCmStringRefCStr acc(trimStrSpaces(parseYAMLStringValue(
+                                    ptr, end, lineNo, strPool, level, true)));
                     size_t accIndex = 0;
                     for (; accIndex < 4; accIndex++)
                         if (::strcmp(rocmAccessQualifierTbl[accIndex], acc.c_str())==0)
@@ -1271,8 +1615,8 @@ void CLRX::parseROCmMetadata(size_t metadataSize, const char* metadata,
                 }
                 case ROCMMT_ARGS_ADDRSPACEQUAL:
                 {
-                    const std::string aspace = trimStrSpaces(parseYAMLStringValue(
-                                    ptr, end, lineNo, level, true));
+                    const ROCmStringRefCStr aspace(trimStrSpaces(parseYAMLStringValue(
+                                    ptr, end, lineNo, strPool, level, true)));
                     size_t aspaceIndex = 0;
                     for (; aspaceIndex < 6; aspaceIndex++)
                         if (::strcasecmp(rocmAddrSpaceTypesTbl[aspaceIndex],
@@ -1299,7 +1643,8 @@ void CLRX::parseROCmMetadata(size_t metadataSize, const char* metadata,
                     kernelArg.isVolatile = parseYAMLBoolValue(ptr, end, lineNo, true);
                     break;
                 case ROCMMT_ARGS_NAME:
-                    kernelArg.name = parseYAMLStringValue(ptr, end, lineNo, level, true);
+                    setROCmMetadataString(kernelArg.name, parseYAMLStringValue(
+                                ptr, end, lineNo, strPool, level, true));
                     break;
                 case ROCMMT_ARGS_POINTEE_ALIGN:
                     kernelArg.pointeeAlign =
@@ -1309,13 +1654,13 @@ void CLRX::parseROCmMetadata(size_t metadataSize, const char* metadata,
                     kernelArg.size = parseYAMLIntValue<uint64_t>(ptr, end, lineNo);
                     break;
                 case ROCMMT_ARGS_TYPENAME:
-                    kernelArg.typeName =
-                                parseYAMLStringValue(ptr, end, lineNo, level, true);
+                    setROCmMetadataString(kernelArg.typeName, parseYAMLStringValue(
+                                ptr, end, lineNo, strPool, level, true));
                     break;
                 case ROCMMT_ARGS_VALUEKIND:
                 {
-                    const std::string vkind = trimStrSpaces(parseYAMLStringValue(
-                                ptr, end, lineNo, level, true));
+                    const ROCmStringRefCStr vkind(trimStrSpaces(parseYAMLStringValue(
+                                ptr, end, lineNo, strPool, level, true)));
                     const size_t vkindIndex = binaryMapFind(rocmValueKindNamesMap,
                             rocmValueKindNamesMap + rocmValueKindNamesNum, vkind.c_str(),
                             CStringLess()) - rocmValueKindNamesMap;
@@ -1327,8 +1672,8 @@ void CLRX::parseROCmMetadata(size_t metadataSize, const char* metadata,
                 }
                 case ROCMMT_ARGS_VALUETYPE:
                 {
-                    const std::string vtype = trimStrSpaces(parseYAMLStringValue(
-                                    ptr, end, lineNo, level, true));
+                    const ROCmStringRefCStr vtype(trimStrSpaces(parseYAMLStringValue(
+                                    ptr, end, lineNo, strPool, level, true)));
                     const size_t vtypeIndex = binaryMapFind(rocmValueTypeNamesMap,
                             rocmValueTypeNamesMap + rocmValueTypeNamesNum, vtype.c_str(),
                             CStringLess()) - rocmValueTypeNamesMap;
@@ -1344,11 +1689,81 @@ void CLRX::parseROCmMetadata(size_t metadataSize, const char* metadata,
             }
         }
     }
+    if (!kernels.empty())
+        // put arguments of last kernel
+        out.setKernelArgs(kernels.back());
+    if (records != nullptr && kernels.size() != records->size())
+        throw ParseException(lineNo, "Kernel records mismatch");
+}
+
+template<typename Output>
+static void parseROCmMetadataT(size_t metadataSize, const char* metadata,
+                Output& out, cxuint threadsNum)
+{
+    typedef typename Output::Kernel Kernel;
+    typedef typename Output::Metadata Metadata;
+    const char* end = metadata + metadataSize;
+    // first chunk of arena holds string pool and (usually) all arrays
+    out.initialize(metadataSize<<1);
+    // string pool allocated once for all decoded strings
+    const YAMLStringPool strPool = { metadata, out.allocateStringPool(metadataSize) };
+    std::vector<YAMLKernelRecord> records;
+    if (threadsNum != 1 && findYAMLKernelRecords(metadata, end, records) &&
+        records.size() >= 2)
+    {
+        /* parse metadata without kernels, and parse kernel records by many threads.
+         * if anything failed, then parse metadata in single pass
+         * to get same result and same error */
+        try
+        {
+            parseROCmMetadataInt(metadata, end, 1, out, strPool, &records, nullptr);
+            std::vector<Kernel>& kernels = out.kernels;
+            Metadata& metadataInfo = out.metadata;
+            std::mutex arenaMutex;
+            parallelForEach(records.size(), threadsNum,
+                        [&records, &kernels, &strPool, &metadataInfo, &arenaMutex](size_t i)
+            {
+                const YAMLKernelRecord& record = records[i];
+                Output kernelOut(metadataInfo, &arenaMutex);
+                parseROCmMetadataInt(record.start, record.end, record.lineNo,
+                            kernelOut, strPool, nullptr, &record);
+                if (kernelOut.kernels.size() != 1)
+                    throw ParseException(record.lineNo, "Wrong kernel record");
+                kernels[i] = std::move(kernelOut.kernels[0]);
+            });
+            out.finish();
+            return;
+        }
+        catch(const Exception& ex)
+        { }
+    }
+    parseROCmMetadataInt(metadata, end, 1, out, strPool, nullptr, nullptr);
+    out.finish();
+}
+
+void CLRX::parseROCmMetadata(size_t metadataSize, const char* metadata,
+                ROCmMetadataView& metadataInfo, cxuint threadsNum)
+{
+    ROCmMetadataViewOutput out(metadataInfo);
+    parseROCmMetadataT(metadataSize, metadata, out, threadsNum);
+}
+
+void CLRX::parseROCmMetadata(size_t metadataSize, const char* metadata,
+                ROCmMetadata& metadataInfo, cxuint threadsNum)
+{
+    ROCmMetadataOutput out(metadataInfo);
+    parseROCmMetadataT(metadataSize, metadata, out, threadsNum);
+}
+
+void ROCmMetadata::parse(size_t metadataSize, const char* metadata, cxuint threadsNum)
+{
+    parseROCmMetadata(metadataSize, metadata, *this, threadsNum);
 }
 
-void ROCmMetadata::parse(size_t metadataSize, const char* metadata)
+void ROCmMetadataView::parse(size_t metadataSize, const char* metadata,
+                cxuint threadsNum)
 {
-    parseROCmMetadata(metadataSize, metadata, *this);
+    parseROCmMetadata(metadataSize, metadata, *this, threadsNum);
 }
 
 /*
@@ -28,28 +28,49 @@
 #include <CLRX/utils/InputOutput.h>
 #include <CLRX/utils/Containers.h>
 #include <CLRX/amdbin/ROCmBinaries.h>
-
-namespace CLRX
-{
-void parsePrintfInfoString(const char* ptr2, const char* end2, size_t oldLineNo,
-                size_t lineNo, ROCmPrintfInfo& printfInfo,
-                std::unordered_set<cxuint>& printfIds);
-};
+#include "ROCmMetadataOutput.h"
 
 using namespace CLRX;
 
 // trim spaces (remove spaces from start and end)
-static std::string trimStrSpaces(const std::string& str)
+static ROCmStringRef trimStrSpaces(ROCmStringRef str)
 {
     size_t i = 0;
-    const size_t sz = str.size();
-    while (i!=sz && isSpace(str[i])) i++;
-    if (i == sz) return "";
+    const size_t sz = str.size;
+    while (i!=sz && isSpace(str.ptr[i])) i++;
+    if (i == sz) return { str.ptr, 0 };
     size_t j = sz-1;
-    while (j>i && isSpace(str[j])) j--;
-    return str.substr(i, j-i+1);
+    while (j>i && isSpace(str.ptr[j])) j--;
+    return { str.ptr+i, j-i+1 };
 }
 
+// null-terminated copy of string reference (to find string in name tables)
+class CLRX_INTERNAL ROCmStringRefCStr
+{
+private:
+    char buf[64];
+    std::string longStr;
+    const char* cstr;
+public:
+    explicit ROCmStringRefCStr(ROCmStringRef str)
+    {
+        if (str.size < sizeof(buf))
+        {
+            std::copy(str.ptr, str.ptr+str.size, buf);
+            buf[str.size] = 0;
+            cstr = buf;
+        }
+        else
+        {
+            longStr.assign(str.ptr, str.size);
+            cstr = longStr.c_str();
+        }
+    }
+    
+    const char* c_str() const
+    { return cstr; }
+};
+
 /*
  * ROCm metadata MsgPack parser
  */
@@ -170,7 +191,8 @@ static double parseMsgPackFloat(const cxbyte*& dataPtr, const cxbyte* dataEnd)
         throw ParseException("MsgPack: Can't parse float value");
 }
 
-static std::string parseMsgPackString(const cxbyte*& dataPtr, const cxbyte* dataEnd)
+// string points to parsed data
+static ROCmStringRef parseMsgPackStringRef(const cxbyte*& dataPtr, const cxbyte* dataEnd)
 {
     if (dataPtr>=dataEnd)
         throw ParseException("MsgPack: Can't parse string");
@@ -208,9 +230,14 @@ static std::string parseMsgPackString(const cxbyte*& dataPtr, const cxbyte* data
     if (dataPtr+size > dataEnd)
         throw ParseException("MsgPack: Can't parse string");
     const char* strData = reinterpret_cast<const char*>(dataPtr);
-    std::string out(strData, strData + size);
     dataPtr += size;
-    return out;
+    return { strData, size };
+}
+
+static std::string parseMsgPackString(const cxbyte*& dataPtr, const cxbyte* dataEnd)
+{
+    const ROCmStringRef str = parseMsgPackStringRef(dataPtr, dataEnd);
+    return std::string(str.ptr, str.ptr + str.size);
 }
 
 static Array<cxbyte> parseMsgPackData(const cxbyte*& dataPtr, const cxbyte* dataEnd)
@@ -434,6 +461,14 @@ std::string MsgPackArrayParser::parseString()
     return v;
 }
 
+ROCmStringRef MsgPackArrayParser::parseStringRef()
+{
+    handleErrors();
+    auto v = parseMsgPackStringRef(dataPtr, dataEnd);
+    count--;
+    return v;
+}
+
 Array<cxbyte> MsgPackArrayParser::parseData()
 {
     handleErrors();
@@ -537,6 +572,14 @@ std::string MsgPackMapParser::parseKeyString()
     return v;
 }
 
+ROCmStringRef MsgPackMapParser::parseKeyStringRef()
+{
+    handleErrors(true);
+    auto v = parseMsgPackStringRef(dataPtr, dataEnd);
+    keyLeft = false;
+    return v;
+}
+
 Array<cxbyte> MsgPackMapParser::parseKeyData()
 {
     handleErrors(true);
@@ -596,6 +639,15 @@ std::string MsgPackMapParser::parseValueString()
     return v;
 }
 
+ROCmStringRef MsgPackMapParser::parseValueStringRef()
+{
+    handleErrors(false);
+    auto v = parseMsgPackStringRef(dataPtr, dataEnd);
+    keyLeft = true;
+    count--;
+    return v;
+}
+
 Array<cxbyte> MsgPackMapParser::parseValueData()
 {
     handleErrors(false);
@@ -718,13 +770,14 @@ static const size_t rocmValueTypeNamesNum =
 static const char* rocmMPAddrSpaceTypesTbl[] =
 { "private", "global", "constant", "local", "generic", "region" };
 
+template<typename KernelArg>
 static void parseROCmMetadataKernelArgMsgPack(MsgPackArrayParser& argsParser,
-                        ROCmKernelArgInfo& argInfo)
+                        KernelArg& argInfo)
 {
     MsgPackMapParser aParser = argsParser.parseMap();
     while (aParser.haveElements())
     {
-        const std::string name = aParser.parseKeyString();
+        const ROCmStringRefCStr name(aParser.parseKeyStringRef());
         const size_t index = binaryFind(rocmMetadataMPKernelArgNames,
                     rocmMetadataMPKernelArgNames + rocmMetadataMPKernelArgNamesSize,
                     name.c_str(), CStringLess()) - rocmMetadataMPKernelArgNames;
@@ -733,7 +786,7 @@ static void parseROCmMetadataKernelArgMsgPack(MsgPackArrayParser& argsParser,
             case ROCMMP_ARG_ACCESS:
             case ROCMMP_ARG_ACTUAL_ACCESS:
             {
-                const std::string acc = trimStrSpaces(aParser.parseValueString());
+                const ROCmStringRefCStr acc(trimStrSpaces(aParser.parseValueStringRef()));
                 size_t accIndex = 0;
                 for (; accIndex < 3; accIndex++)
                     if (::strcmp(rocmMPAccessQualifierTbl[accIndex], acc.c_str())==0)
@@ -748,7 +801,7 @@ static void parseROCmMetadataKernelArgMsgPack(MsgPackArrayParser& argsParser,
             }
             case ROCMMP_ARG_ADDRESS_SPACE:
             {
-                const std::string aspace = trimStrSpaces(aParser.parseValueString());
+                const ROCmStringRefCStr aspace(trimStrSpaces(aParser.parseValueStringRef()));
                 size_t aspaceIndex = 0;
                 for (; aspaceIndex < 6; aspaceIndex++)
                     if (::strcasecmp(rocmMPAddrSpaceTypesTbl[aspaceIndex],
@@ -772,7 +825,7 @@ static void parseROCmMetadataKernelArgMsgPack(MsgPackArrayParser& argsParser,
                 argInfo.isVolatile = aParser.parseValueBool();
                 break;
             case ROCMMP_ARG_NAME:
-                argInfo.name = aParser.parseValueString();
+                setROCmMetadataString(argInfo.name, aParser.parseValueStringRef());
                 break;
             case ROCMMP_ARG_OFFSET:
                 argInfo.offset = aParser.parseValueInteger(MSGPACK_WS_UNSIGNED);
@@ -784,11 +837,11 @@ static void parseROCmMetadataKernelArgMsgPack(MsgPackArrayParser& argsParser,
                 argInfo.size = aParser.parseValueInteger(MSGPACK_WS_UNSIGNED);
                 break;
             case ROCMMP_ARG_TYPE_NAME:
-                argInfo.typeName = aParser.parseValueString();
+                setROCmMetadataString(argInfo.typeName, aParser.parseValueStringRef());
                 break;
             case ROCMMP_ARG_VALUE_KIND:
             {
-                const std::string vkind = trimStrSpaces(aParser.parseValueString());
+                const ROCmStringRefCStr vkind(trimStrSpaces(aParser.parseValueStringRef()));
                 const size_t vkindIndex = binaryMapFind(rocmMPValueKindNamesMap,
                             rocmMPValueKindNamesMap + rocmMPValueKindNamesNum, vkind.c_str(),
                             CStringLess()) - rocmMPValueKindNamesMap;
@@ -800,7 +853,7 @@ static void parseROCmMetadataKernelArgMsgPack(MsgPackArrayParser& argsParser,
             }
             case ROCMMP_ARG_VALUE_TYPE:
             {
-                const std::string vtype = trimStrSpaces(aParser.parseValueString());
+                const ROCmStringRefCStr vtype(trimStrSpaces(aParser.parseValueStringRef()));
                 const size_t vtypeIndex = binaryMapFind(rocmValueTypeNamesMap,
                         rocmValueTypeNamesMap + rocmValueTypeNamesNum, vtype.c_str(),
                         CStringCaseLess()) - rocmValueTypeNamesMap;
@@ -842,13 +895,15 @@ static const char* rocmMetadataMPKernelNames[] =
 static const size_t rocmMetadataMPKernelNamesSize = sizeof(rocmMetadataMPKernelNames) /
                     sizeof(const char*);
 
-static void parseROCmMetadataKernelMsgPack(MsgPackArrayParser& kernelsParser,
-                        ROCmKernelMetadata& kernel)
+template<typename Output>
+static void parseROCmMetadataKernelMsgPack(MsgPackMapParser& kParser, Output& out,
+                        typename Output::Kernel& kernel)
 {
-    MsgPackMapParser kParser = kernelsParser.parseMap();
+    typedef typename Output::KernelArg KernelArg;
+    out.kernelArgs.clear();
     while (kParser.haveElements())
     {
-        const std::string name = kParser.parseKeyString();
+        const ROCmStringRefCStr name(kParser.parseKeyStringRef());
         const size_t index = binaryFind(rocmMetadataMPKernelNames,
                     rocmMetadataMPKernelNames + rocmMetadataMPKernelNamesSize,
                     name.c_str(), CStringLess()) - rocmMetadataMPKernelNames;
@@ -860,14 +915,13 @@ static void parseROCmMetadataKernelMsgPack(MsgPackArrayParser& kernelsParser,
                 MsgPackArrayParser argsParser = kParser.parseValueArray();
                 while (argsParser.haveElements())
                 {
-                    ROCmKernelArgInfo arg{};
-                    parseROCmMetadataKernelArgMsgPack(argsParser, arg);
-                    kernel.argInfos.push_back(arg);
+                    out.kernelArgs.push_back(KernelArg{});
+                    parseROCmMetadataKernelArgMsgPack(argsParser, out.kernelArgs.back());
                 }
                 break;
             }
             case ROCMMP_KERNEL_DEVICE_ENQUEUE_SYMBOL:
-                kernel.deviceEnqueueSymbol = kParser.parseValueString();
+                setROCmMetadataString(kernel.deviceEnqueueSymbol, kParser.parseValueStringRef());
                 break;
             case ROCMMP_KERNEL_GROUP_SEGMENT_FIXED_SIZE:
                 kernel.groupSegmentFixedSize = kParser.
@@ -882,7 +936,7 @@ static void parseROCmMetadataKernelMsgPack(MsgPackArrayParser& kernelsParser,
                                     parseValueInteger(MSGPACK_WS_UNSIGNED);
                 break;
             case ROCMMP_KERNEL_LANGUAGE:
-                kernel.language = kParser.parseValueString();
+                setROCmMetadataString(kernel.language, kParser.parseValueStringRef());
                 break;
             case ROCMMP_KERNEL_LANGUAGE_VERSION:
                 parseMsgPackValueTypedArrayForMap(kParser, kernel.langVersion,
@@ -893,7 +947,7 @@ static void parseROCmMetadataKernelMsgPack(MsgPackArrayParser& kernelsParser,
                                     parseValueInteger(MSGPACK_WS_UNSIGNED);
                 break;
             case ROCMMP_KERNEL_NAME:
-                kernel.name = kParser.parseValueString();
+                setROCmMetadataString(kernel.name, kParser.parseValueStringRef());
                 break;
             case ROCMMP_KERNEL_PRIVATE_SEGMENT_FIXED_SIZE:
                 kernel.privateSegmentFixedSize = kParser.
@@ -910,10 +964,10 @@ static void parseROCmMetadataKernelMsgPack(MsgPackArrayParser& kernelsParser,
                 kernel.spilledSgprs = kParser.parseValueInteger(MSGPACK_WS_UNSIGNED);
                 break;
             case ROCMMP_KERNEL_SYMBOL:
-                kernel.symbolName = kParser.parseValueString();
+                setROCmMetadataString(kernel.symbolName, kParser.parseValueStringRef());
                 break;
             case ROCMMP_KERNEL_VEC_TYPE_HINT:
-                kernel.vecTypeHint = kParser.parseValueString();
+                setROCmMetadataString(kernel.vecTypeHint, kParser.parseValueStringRef());
                 break;
             case ROCMMP_KERNEL_VGPR_COUNT:
                 kernel.vgprsNum = kParser.parseValueInteger(MSGPACK_WS_UNSIGNED);
@@ -933,47 +987,65 @@ static void parseROCmMetadataKernelMsgPack(MsgPackArrayParser& kernelsParser,
                 break;
         }
     }
+    out.setKernelArgs(kernel);
 }
 
-void CLRX::parseROCmMetadataMsgPack(size_t metadataSize, const cxbyte* metadata,
-                ROCmMetadata& metadataInfo)
+/* parse MsgPack metadata. if kernelPlaces is not null, then kernels are only
+ * skipped (only placeholders are added) and their places are stored */
+template<typename Output>
+static void parseROCmMetadataMsgPackInt(size_t metadataSize, const cxbyte* metadata,
+                Output& out, std::vector<const cxbyte*>* kernelPlaces)
 {
     // init metadata info object
-    metadataInfo.kernels.clear();
-    metadataInfo.printfInfos.clear();
-    metadataInfo.version[0] = metadataInfo.version[1] = 0;
+    out.clear();
+    out.metadata.version[0] = out.metadata.version[1] = 0;
     
-    std::vector<ROCmKernelMetadata>& kernels = metadataInfo.kernels;
+    typedef typename Output::Kernel Kernel;
+    std::vector<Kernel>& kernels = out.kernels;
     
     MsgPackMapParser mainMap(metadata, metadata+metadataSize);
     while (mainMap.haveElements())
     {
-        const CString name = mainMap.parseKeyString();
-        if (name == "amdhsa.version")
-            parseMsgPackValueTypedArrayForMap(mainMap, metadataInfo.version,
+        const ROCmStringRefCStr name(mainMap.parseKeyStringRef());
+        if (::strcmp(name.c_str(), "amdhsa.version") == 0)
+            parseMsgPackValueTypedArrayForMap(mainMap, out.metadata.version,
                                         2, MSGPACK_WS_UNSIGNED);
-        else if (name == "amdhsa.kernels")
+        else if (::strcmp(name.c_str(), "amdhsa.kernels") == 0)
         {
             MsgPackArrayParser kernelsParser = mainMap.parseValueArray();
             while (kernelsParser.haveElements())
             {
-                ROCmKernelMetadata kernel{};
+                if (kernelPlaces != nullptr)
+                {
+                    // only skip kernel (kernel will be parsed separately)
+                    kernelPlaces->push_back(metadata);
+                    kernelsParser.parseMap().end();
+                    kernels.push_back(Kernel());
+                    continue;
+                }
+                kernels.push_back(Kernel());
+                Kernel& kernel = kernels.back();
                 kernel.initialize();
-                parseROCmMetadataKernelMsgPack(kernelsParser, kernel);
-                kernels.push_back(kernel);
+                MsgPackMapParser kParser = kernelsParser.parseMap();
+                parseROCmMetadataKernelMsgPack(kParser, out, kernel);
             }
+            if (kernelPlaces != nullptr)
+                // end of last kernel
+                kernelPlaces->push_back(metadata);
         }
-        else if (name == "amdhsa.printf")
+        else if (::strcmp(name.c_str(), "amdhsa.printf") == 0)
         {
             std::unordered_set<cxuint> printfIds;
+            std::vector<uint32_t> argSizes;
             MsgPackArrayParser printfsParser = mainMap.parseValueArray();
             while (printfsParser.haveElements())
             {
-                ROCmPrintfInfo printfInfo{};
-                std::string pistr = printfsParser.parseString();
-                parsePrintfInfoString(pistr.c_str(), pistr.c_str() + pistr.size(),
-                                0, 0, printfInfo, printfIds);
-                metadataInfo.printfInfos.push_back(printfInfo);
+                uint32_t printfId = 0;
+                ROCmStringRef format;
+                const ROCmStringRef pistr = printfsParser.parseStringRef();
+                parsePrintfInfoString(pistr.ptr, pistr.ptr + pistr.size,
+                                0, 0, printfId, argSizes, format, printfIds);
+                out.addPrintfInfo(printfId, argSizes, format);
             }
         }
         else
@@ -981,9 +1053,73 @@ void CLRX::parseROCmMetadataMsgPack(size_t metadataSize, const cxbyte* metadata,
     }
 }
 
-void ROCmMetadata::parseMsgPack(size_t metadataSize, const cxbyte* metadata)
+template<typename Output>
+static void parseROCmMetadataMsgPackT(size_t metadataSize, const cxbyte* metadata,
+                Output& out, cxuint threadsNum)
+{
+    typedef typename Output::Kernel Kernel;
+    typedef typename Output::Metadata Metadata;
+    // all strings points to metadata, arena holds only arrays
+    out.initialize(metadataSize<<1);
+    if (threadsNum != 1)
+    {
+        /* parse metadata with skipping kernels, and parse kernels by many threads.
+         * if anything failed, then parse metadata in single pass
+         * to get same result and same error */
+        try
+        {
+            std::vector<const cxbyte*> kernelPlaces;
+            parseROCmMetadataMsgPackInt(metadataSize, metadata, out, &kernelPlaces);
+            std::vector<Kernel>& kernels = out.kernels;
+            // kernel places holds also end of kernels
+            if (kernels.size() < 2 || kernelPlaces.size() != kernels.size()+1)
+                throw ParseException("MsgPack: Parallel parsing is not used");
+            Metadata& metadataInfo = out.metadata;
+            std::mutex arenaMutex;
+            parallelForEach(kernels.size(), threadsNum,
+                        [&kernelPlaces, &kernels, &metadataInfo, &arenaMutex](size_t i)
+            {
+                const cxbyte* dataPtr = kernelPlaces[i];
+                Output kernelOut(metadataInfo, &arenaMutex);
+                Kernel& kernel = kernels[i];
+                kernel.initialize();
+                MsgPackMapParser kParser(dataPtr, kernelPlaces[i+1]);
+                parseROCmMetadataKernelMsgPack(kParser, kernelOut, kernel);
+            });
+            out.finish();
+            return;
+        }
+        catch(const Exception& ex)
+        { }
+    }
+    parseROCmMetadataMsgPackInt(metadataSize, metadata, out, nullptr);
+    out.finish();
+}
+
+void CLRX::parseROCmMetadataMsgPack(size_t metadataSize, const cxbyte* metadata,
+                ROCmMetadataView& metadataInfo, cxuint threadsNum)
+{
+    ROCmMetadataViewOutput out(metadataInfo);
+    parseROCmMetadataMsgPackT(metadataSize, metadata, out, threadsNum);
+}
+
+void CLRX::parseROCmMetadataMsgPack(size_t metadataSize, const cxbyte* metadata,
+                ROCmMetadata& metadataInfo, cxuint threadsNum)
+{
+    ROCmMetadataOutput out(metadataInfo);
+    parseROCmMetadataMsgPackT(metadataSize, metadata, out, threadsNum);
+}
+
+void ROCmMetadata::parseMsgPack(size_t metadataSize, const cxbyte* metadata,
+                cxuint threadsNum)
+{
+    parseROCmMetadataMsgPack(metadataSize, metadata, *this, threadsNum);
+}
+
+void ROCmMetadataView::parseMsgPack(size_t metadataSize, const cxbyte* metadata,
+                cxuint threadsNum)
 {
-    parseROCmMetadataMsgPack(metadataSize, metadata, *this);
+    parseROCmMetadataMsgPack(metadataSize, metadata, *this, threadsNum);
 }
 
 static void msgPackWriteString(const char* str, std::vector<cxbyte>& output)
@@ -0,0 +1,179 @@
+/*
+ *  CLRadeonExtender - Unofficial OpenCL Radeon Extensions Library
+ *  Copyright (C) 2014-2018 Mateusz Szpakowski
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef __CLRX_ROCMMETADATAOUTPUT_H__
+#define __CLRX_ROCMMETADATAOUTPUT_H__
+
+#include <CLRX/Config.h>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <unordered_set>
+#include <CLRX/utils/Utilities.h>
+#include <CLRX/utils/Containers.h>
+#include <CLRX/amdbin/ROCmBinaries.h>
+
+/* ROCm metadata parsers (YAML and MsgPack) are templates parametrized by output:
+ * owning metadata (ROCmMetadata) or metadata view (ROCmMetadataView).
+ * Parser puts kernels, kernel arguments and printf infos to vectors of output,
+ * output moves them to metadata (or copies them to arena of metadata view).
+ * Outputs of kernels parsed by many threads share arena guarded by mutex */
+
+namespace CLRX
+{
+
+void parsePrintfInfoString(const char* ptr2, const char* end2, size_t oldLineNo,
+                size_t lineNo, uint32_t& printfId, std::vector<uint32_t>& argSizes,
+                ROCmStringRef& format, std::unordered_set<cxuint>& printfIds);
+
+static inline void setROCmMetadataString(CString& dest, ROCmStringRef str)
+{ dest.assign(str.ptr, str.size); }
+
+static inline void setROCmMetadataString(ROCmStringRef& dest, ROCmStringRef str)
+{ dest = str; }
+
+// output to owning metadata
+class CLRX_INTERNAL ROCmMetadataOutput
+{
+public:
+    typedef ROCmMetadata Metadata;
+    typedef ROCmKernelMetadata Kernel;
+    typedef ROCmKernelArgInfo KernelArg;
+
+    Metadata& metadata;
+    std::vector<Kernel> kernels;
+    std::vector<KernelArg> kernelArgs;  // arguments of current kernel
+private:
+    std::vector<ROCmPrintfInfo> printfInfos;
+    std::unique_ptr<char[]> stringPool;
+public:
+    explicit ROCmMetadataOutput(Metadata& _metadata, std::mutex* arenaMutex = nullptr)
+        : metadata(_metadata)
+    { }
+
+    void initialize(size_t arenaSize)
+    {
+        metadata.kernels.clear();
+        metadata.printfInfos.clear();
+    }
+
+    // pool for decoded strings (used only while parsing)
+    char* allocateStringPool(size_t size)
+    {
+        stringPool.reset(new char[size]);
+        return stringPool.get();
+    }
+
+    void clear()
+    {
+        kernels.clear();
+        kernelArgs.clear();
+        printfInfos.clear();
+    }
+
+    void setKernelArgs(Kernel& kernel)
+    {
+        kernel.argInfos = std::move(kernelArgs);
+        kernelArgs.clear();
+    }
+
+    void addPrintfInfo(uint32_t id, const std::vector<uint32_t>& argSizes,
+                ROCmStringRef format)
+    {
+        printfInfos.push_back({ id, Array<uint32_t>(argSizes.begin(), argSizes.end()),
+                    format.toCString() });
+    }
+
+    void finish()
+    {
+        metadata.kernels = std::move(kernels);
+        metadata.printfInfos = std::move(printfInfos);
+    }
+};
+
+// output to metadata view (arrays are copied to arena)
+class CLRX_INTERNAL ROCmMetadataViewOutput
+{
+public:
+    typedef ROCmMetadataView Metadata;
+    typedef ROCmKernelMetadataView Kernel;
+    typedef ROCmKernelArgInfoView KernelArg;
+
+    Metadata& metadata;
+    std::vector<Kernel> kernels;
+    std::vector<KernelArg> kernelArgs;  // arguments of current kernel
+private:
+    std::vector<ROCmPrintfInfoView> printfInfos;
+    std::mutex* arenaMutex;
+public:
+    explicit ROCmMetadataViewOutput(Metadata& _metadata, std::mutex* _arenaMutex = nullptr)
+        : metadata(_metadata), arenaMutex(_arenaMutex)
+    { }
+
+    void initialize(size_t arenaSize)
+    {
+        metadata.kernels = { nullptr, 0 };
+        metadata.printfInfos = { nullptr, 0 };
+        metadata.arena.reset(arenaSize);
+    }
+
+    // decoded strings are kept in arena
+    char* allocateStringPool(size_t size)
+    { return reinterpret_cast<char*>(metadata.arena.allocate(size)); }
+
+    void clear()
+    {
+        kernels.clear();
+        kernelArgs.clear();
+        printfInfos.clear();
+    }
+
+    void setKernelArgs(Kernel& kernel)
+    {
+        if (arenaMutex != nullptr)
+        {
+            std::lock_guard<std::mutex> lock(*arenaMutex);
+            kernel.argInfos = metadata.arena.copyArray(kernelArgs.size(),
+                        kernelArgs.data());
+        }
+        else
+            kernel.argInfos = metadata.arena.copyArray(kernelArgs.size(),
+                        kernelArgs.data());
+        kernelArgs.clear();
+    }
+
+    void addPrintfInfo(uint32_t id, const std::vector<uint32_t>& argSizes,
+                ROCmStringRef format)
+    {
+        printfInfos.push_back({ id, metadata.arena.copyArray(argSizes.size(),
+                    argSizes.data()), format });
+    }
+
+    void finish()
+    {
+        metadata.kernels = metadata.arena.copyArray(kernels.size(), kernels.data());
+        metadata.printfInfos = metadata.arena.copyArray(printfInfos.size(),
+                    printfInfos.data());
+    }
+};
+
+};
+
+#endif
@@ -21,6 +21,9 @@
 #include <iostream>
 #include <memory>
 #include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
 #include <cstring>
 #include <CLRX/utils/Utilities.h>
 #include <CLRX/utils/CLIParser.h>
@@ -66,6 +69,12 @@ static const CLIOption programOptions[] =
     { "policy", 0, CLIArgType::UINT, false, false,
         "set policy version", "VERSION" },
     { "noWarnings", 'w', CLIArgType::NONE, false, false, "disable warnings", nullptr },
+    { "estimate", 0, CLIArgType::NONE, false, false,
+        "print estimated cycles of code sections", nullptr },
+    { "checkWaits", 0, CLIArgType::NONE, false, false,
+        "check whether wait instructions are sufficient", nullptr },
+    { "sinkWaits", 0, CLIArgType::NONE, false, false,
+        "place wait instructions just before first use of registers", nullptr },
     CLRX_CLI_AUTOHELP
     { nullptr, 0 }
 };
@@ -141,6 +150,9 @@ try
         flags |= ASM_OLDMODPARAM;
     if (cli.hasShortOption('3'))
         flags |= ASM_WAVE32;
+    if (cli.hasLongOption("checkWaits"))
+        flags |= ASM_CHECKWAITS;
+    const bool sinkWaits = cli.hasLongOption("sinkWaits");
     if (cli.hasLongOption("newROCmBinFormat"))
         newROCmBinFormat = true;
     if (cli.hasLongOption("policy"))
@@ -154,18 +166,6 @@ try
     for (cxuint i = 0; i < argsNum; i++)
         filenames[i] = cli.getArgs()[i];
     
-    std::unique_ptr<Assembler> assembler;
-    if (!filenames.empty())
-        assembler.reset(new Assembler(filenames, flags, binFormat, deviceType));
-    else // if from stdin
-        assembler.reset(new Assembler(nullptr, std::cin, flags, binFormat, deviceType));
-    assembler->set64Bit(is64Bit);
-    assembler->setDriverVersion(driverVersion);
-    assembler->setLLVMVersion(llvmVersion);
-    assembler->setNewROCmBinFormat(newROCmBinFormat);
-    if (havePolicy)
-        assembler->setPolicyVersion(policyVersion);
-    
     size_t defSymsNum = 0;
     const char* const* defSyms = nullptr;
     size_t includePathsNum = 0;
@@ -175,8 +175,7 @@ try
     if (cli.hasShortOption('I'))
         includePaths = cli.getShortOptArgArray<const char*>('I', includePathsNum);
     
-    for (size_t i = 0; i < includePathsNum; i++)
-        assembler->addIncludeDir(includePaths[i]);
+    std::vector<std::pair<CString, uint64_t> > initialDefSyms;
     for (size_t i = 0; i < defSymsNum; i++)
     {
         const char* eqPlace = ::strchr(defSyms[i], '=');
@@ -214,7 +213,7 @@ try
         else
             symName = defSyms[i];
         if (verifySymbolName(symName))
-            assembler->addInitialDefSym(symName, value);
+            initialDefSyms.push_back(std::make_pair(symName, value));
         else
         {
             std::cerr << "Invalid symbol name '" << symName << "'" << std::endl;
@@ -224,14 +223,104 @@ try
     // exit if errors occurred
     if (ret!=0)
         return ret;
-    /// run assembling
-    if (!assembler->assemble())
-        return 1;
+    
+    // source from stdin must be kept, if it will be assembled again
+    std::string stdinSource;
+    if (filenames.empty() && sinkWaits)
+    {
+        std::ostringstream oss;
+        oss << std::cin.rdbuf();
+        stdinSource = oss.str();
+    }
+    std::unique_ptr<std::istringstream> stdinInput;
+    
+    auto createAssembler = [&](Flags asmFlags, std::ostream& msgStream,
+                std::ostream& printStream) -> Assembler*
+    {
+        std::unique_ptr<Assembler> assembler;
+        if (!filenames.empty())
+            assembler.reset(new Assembler(filenames, asmFlags, binFormat, deviceType,
+                        msgStream, printStream));
+        else if (sinkWaits)
+        {
+            stdinInput.reset(new std::istringstream(stdinSource));
+            assembler.reset(new Assembler(nullptr, *stdinInput, asmFlags, binFormat,
+                        deviceType, msgStream, printStream));
+        }
+        else // if from stdin
+            assembler.reset(new Assembler(nullptr, std::cin, asmFlags, binFormat,
+                        deviceType, msgStream, printStream));
+        assembler->set64Bit(is64Bit);
+        assembler->setDriverVersion(driverVersion);
+        assembler->setLLVMVersion(llvmVersion);
+        assembler->setNewROCmBinFormat(newROCmBinFormat);
+        if (havePolicy)
+            assembler->setPolicyVersion(policyVersion);
+        for (size_t i = 0; i < includePathsNum; i++)
+            assembler->addIncludeDir(includePaths[i]);
+        for (const auto& defSym: initialDefSyms)
+            assembler->addInitialDefSym(defSym.first, defSym.second);
+        return assembler.release();
+    };
+    
+    std::unique_ptr<Assembler> assembler;
+    if (!sinkWaits)
+    {
+        assembler.reset(createAssembler(flags, std::cerr, std::cout));
+        /// run assembling
+        if (!assembler->assemble())
+            return 1;
+    }
+    else
+    {
+        /* first pass: find wait places by wait scheduler. messages are printed
+         * only if code will not be assembled again */
+        std::ostringstream msgStream, printStream;
+        assembler.reset(createAssembler(flags | ASM_SINKWAITS, msgStream, printStream));
+        const bool good = assembler->assemble();
+        if (!good || assembler->getWaitPlaces().empty())
+        {
+            std::cerr << msgStream.str();
+            std::cerr.flush();
+            std::cout << printStream.str();
+            std::cout.flush();
+            if (!good)
+                return 1;
+        }
+        else
+        {
+            // second pass: assemble code with placed wait instructions
+            const std::vector<AsmWaitPlace> waitPlaces = assembler->getWaitPlaces();
+            assembler.reset(createAssembler(flags, std::cerr, std::cout));
+            assembler->setWaitPlaces(waitPlaces);
+            if (!assembler->assemble())
+                return 1;
+        }
+    }
     /// write output to file
     const char* outputName = "a.out";
     if (cli.hasShortOption('o'))
         outputName = cli.getShortOptArg<const char*>('o');
     assembler->writeBinary(outputName);
+    if (cli.hasLongOption("estimate"))
+    {
+        // print estimated cycles for all code sections
+        const std::vector<AsmKernel>& kernels = assembler->getKernels();
+        for (const AsmSection& section: assembler->getSections())
+        {
+            if (section.type != AsmSectionType::CODE || section.content.empty())
+                continue;
+            std::cout << "Section " << section.name;
+            if (section.kernelId != ASMKERN_GLOBAL)
+                std::cout << " (kernel " << kernels[section.kernelId].name << ")";
+            std::cout << ":\n";
+            AsmCycleEstimator estimator(assembler->getDeviceType());
+            estimator.estimate(*assembler, section.codeFlow, section.content.size(),
+                        section.content.data());
+            estimator.printReport(std::cout, "  ");
+        }
+        std::cout.flush();
+    }
     return 0;
 }
 catch(const Exception& ex)
@@ -19,13 +19,24 @@
 
 #include <CLRX/Config.h>
 #include <iostream>
+#include <fstream>
+#include <cstring>
+#include <string>
 #include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
 #include <CLRX/utils/Utilities.h>
 #include <CLRX/utils/CLIParser.h>
+#include <CLRX/utils/InputOutput.h>
 #include <CLRX/amdbin/AmdBinaries.h>
 #include <CLRX/amdbin/AmdCL2Binaries.h>
 #include <CLRX/amdbin/ROCmBinaries.h>
+#include <CLRX/amdbin/Amd3Binaries.h>
 #include <CLRX/amdbin/GalliumBinaries.h>
+#include <CLRX/amdbin/BinaryProbe.h>
 #include <CLRX/amdasm/Disassembler.h>
 
 using namespace CLRX;
@@ -57,12 +68,361 @@ static const CLIOption programOptions[] =
         "set driver version (for AmdCL2)", "VERSION" },
     { "llvmVersion", 0, CLIArgType::UINT, false, false,
         "set LLVM version (for Gallium)", "VERSION" },
+    { "amd3", 0, CLIArgType::NONE, false, false,
+        "treat AMDGPU code object V3 binaries as AMD3 binaries", nullptr },
     { "buggyFPLit", 0, CLIArgType::NONE, false, false,
         "use old and buggy fplit rules", nullptr },
+    { "estimate", 0, CLIArgType::NONE, false, false,
+        "print estimated cycles of code", nullptr },
+    { "output", 'o', CLIArgType::TRIMMED_STRING, false, false,
+        "write output to file", "FILE" },
+    { "outBufSize", 0, CLIArgType::SIZE, false, false,
+        "set output buffer size in bytes", "SIZE" },
+    { "asyncOutput", 0, CLIArgType::NONE, false, false,
+        "write output in background thread (double buffering)", nullptr },
+    { "jobs", 'j', CLIArgType::UINT, false, false,
+        "disassemble files by N threads (0 - all hardware threads)", "N" },
+    { "kernelThreads", 0, CLIArgType::UINT, false, false,
+        "disassemble kernels of file by N threads (0 - all hardware threads)", "N" },
+    { "outputDir", 0, CLIArgType::TRIMMED_STRING, false, false,
+        "write output of every file to DIR/FILENAME.s", "DIR" },
+    { "diff", 0, CLIArgType::NONE, false, false,
+        "print code and config differences between two binaries", nullptr },
+    { "stats", 0, CLIArgType::NONE, false, false,
+        "print code statistics of kernels in CSV format", nullptr },
+    { "probe", 0, CLIArgType::NONE, false, false,
+        "print format, device and kernels of binaries in CSV format", nullptr },
+    { "codeCache", 0, CLIArgType::SIZE, false, false,
+        "reuse disassembled text of identical code (cache up to SIZE bytes)", "SIZE" },
+    { "writeIndex", 0, CLIArgType::TRIMMED_STRING, false, false,
+        "write disassembly index to file instead of disassembly", "FILE" },
+    { "readIndex", 0, CLIArgType::TRIMMED_STRING, false, false,
+        "read disassembly index from file (for window)", "FILE" },
+    { "window", 0, CLIArgType::TRIMMED_STRING, false, false,
+        "disassemble only instructions around offset", "[KERNEL:]OFFSET[,COUNT]" },
     CLRX_CLI_AUTOHELP
     { nullptr, 0 }
 };
 
+// disassembly index options
+struct DisasmIndexMode
+{
+    const char* writeIndexFile;
+    const char* readIndexFile;
+    bool window;
+    CString windowKernel;
+    size_t windowOffset;
+    size_t windowCount;
+    
+    DisasmIndexMode() : writeIndexFile(nullptr), readIndexFile(nullptr), window(false),
+            windowOffset(0), windowCount(25)
+    { }
+};
+
+// parse window in form [KERNEL:]OFFSET[,COUNT]
+static void parseDisasmWindow(const char* str, DisasmIndexMode& mode)
+{
+    const char* offsetStr = str;
+    const char* colon = ::strrchr(str, ':');
+    if (colon != nullptr)
+    {
+        mode.windowKernel.assign(str, colon);
+        offsetStr = colon+1;
+    }
+    const char* end;
+    mode.windowOffset = cstrtovCStyle<size_t>(offsetStr, nullptr, end);
+    if (*end == ',')
+        mode.windowCount = cstrtovCStyle<size_t>(end+1, nullptr, end);
+    if (*end != 0)
+        throw Exception("Garbages at window definition");
+}
+
+// disassemble whole input, or write index, or disassemble window of code
+static void runDisassembler(Disassembler& disasm, const DisasmIndexMode& mode)
+{
+    if (mode.writeIndexFile == nullptr && !mode.window)
+    {
+        disasm.disassemble();
+        return;
+    }
+    DisasmIndex index;
+    if (mode.readIndexFile != nullptr && mode.writeIndexFile == nullptr)
+    {
+        std::ifstream ifs(mode.readIndexFile, std::ios::binary);
+        if (!ifs)
+            throw Exception("Can't open disassembly index file");
+        index.read(ifs);
+    }
+    else
+        disasm.buildIndex(index);
+    
+    if (mode.writeIndexFile != nullptr)
+    {
+        std::ofstream ofs(mode.writeIndexFile, std::ios::binary);
+        index.write(ofs);
+        ofs.flush();
+        if (!ofs)
+            throw Exception("Can't write disassembly index file");
+        return;
+    }
+    
+    size_t region;
+    size_t offset = mode.windowOffset;
+    if (!mode.windowKernel.empty())
+    {
+        region = index.findRegion(mode.windowKernel.c_str());
+        if (region == SIZE_MAX)
+            throw Exception("Kernel code not found in disassembly index");
+    }
+    else
+    {
+        // offset in first code section
+        region = index.findRegion(0, offset);
+        if (region == SIZE_MAX)
+            throw Exception("Offset is not in code");
+        offset -= index.getRegion(region).offset;
+    }
+    disasm.disassembleWindow(index, region, offset, mode.windowCount, mode.windowCount);
+}
+
+// disassembler options common for all input files
+struct DisasmOptions
+{
+    Flags disasmFlags;
+    bool fromRawCode;
+    bool hasGPUDeviceType;
+    GPUDeviceType gpuDeviceType;
+    cxuint driverVersion;
+    cxuint llvmVersion;
+    DisasmIndexMode indexMode;
+    bool statsMode;
+    bool probeMode;
+    DisasmCodeCache* codeCache;
+    bool amd3Mode;
+    cxuint kernelThreads;
+};
+
+// loaded input file with disassembler
+struct DisasmFile
+{
+    Array<cxbyte> binaryData;
+    std::unique_ptr<AmdMainBinaryBase> amdBase;
+    std::unique_ptr<ROCmBinary> rocmBin;
+    std::unique_ptr<Amd3Binary> amd3Bin;
+    std::unique_ptr<GalliumBinary> galliumBin;
+    std::unique_ptr<Disassembler> disasm;
+};
+
+// load file and create disassembler for it
+static void openDisasmFile(const char* filename, const DisasmOptions& opts,
+            std::ostream& output, DisasmFile& file)
+{
+    file.binaryData = loadDataFromFile(filename);
+    const size_t binarySize = file.binaryData.size();
+    cxbyte* binaryCode = file.binaryData.data();
+    
+    if (!opts.fromRawCode)
+    {
+        // standard flags for binary format creators,
+        // needed by disassemblers to correctly getting all datas to dump
+        Flags binFlags = AMDBIN_CREATE_KERNELINFO | AMDBIN_CREATE_KERNELINFOMAP |
+                AMDBIN_CREATE_INNERBINMAP | AMDBIN_CREATE_KERNELHEADERS |
+                AMDBIN_CREATE_KERNELHEADERMAP;
+        // supply additional flags for CALNotes and info strings
+        if ((opts.disasmFlags & (DISASM_CALNOTES|DISASM_CONFIG)) != 0)
+            binFlags |= AMDBIN_INNER_CREATE_CALNOTES;
+        if ((opts.disasmFlags & (DISASM_METADATA|DISASM_CONFIG)) != 0)
+            binFlags |= AMDBIN_CREATE_INFOSTRINGS;
+        
+        const BinaryProbeFormat format = detectBinaryFormat(binarySize, binaryCode);
+        if (format == BinaryProbeFormat::AMD)
+        {
+            // if amd binary
+            file.amdBase.reset(createAmdBinaryFromCode(binarySize, binaryCode, binFlags));
+            if (file.amdBase->getType() == AmdMainType::GPU_BINARY)
+                file.disasm.reset(new Disassembler(
+                        *static_cast<AmdMainGPUBinary32*>(file.amdBase.get()),
+                        output, opts.disasmFlags));
+            else if (file.amdBase->getType() == AmdMainType::GPU_64_BINARY)
+                file.disasm.reset(new Disassembler(
+                        *static_cast<AmdMainGPUBinary64*>(file.amdBase.get()),
+                        output, opts.disasmFlags));
+            else
+                throw Exception("This is not AMDGPU binary file!");
+        }
+        else if (format == BinaryProbeFormat::AMDCL2)
+        {   // AMD OpenCL 2.0 binary
+            // extra (extra data) flags for OpenCL 2.0 disassembler
+            binFlags |= AMDCL2BIN_INNER_CREATE_KERNELDATA |
+                        AMDCL2BIN_INNER_CREATE_KERNELDATAMAP |
+                        AMDCL2BIN_INNER_CREATE_KERNELSTUBS;
+            file.amdBase.reset(createAmdCL2BinaryFromCode(binarySize, binaryCode,
+                        binFlags));
+            if (file.amdBase->getType() == AmdMainType::GPU_CL2_BINARY)
+                file.disasm.reset(new Disassembler(
+                        *static_cast<AmdCL2MainGPUBinary32*>(file.amdBase.get()),
+                        output, opts.disasmFlags, opts.driverVersion));
+            else if (file.amdBase->getType() == AmdMainType::GPU_CL2_64_BINARY)
+                file.disasm.reset(new Disassembler(
+                        *static_cast<AmdCL2MainGPUBinary64*>(file.amdBase.get()),
+                        output, opts.disasmFlags, opts.driverVersion));
+            else
+                throw Exception("This is not AMDGPU binary file!");
+        }
+        else if (format == BinaryProbeFormat::ROCM && opts.amd3Mode &&
+                isAmd3Binary(binarySize, binaryCode))
+        {
+            // AMD3 binary (AMDGPU code object V3)
+            file.amd3Bin.reset(new Amd3Binary(binarySize, binaryCode, 0));
+            file.disasm.reset(new Disassembler(*file.amd3Bin, output,
+                    opts.hasGPUDeviceType, opts.gpuDeviceType, opts.disasmFlags));
+        }
+        else if (format == BinaryProbeFormat::ROCM)
+        {
+            // ROCm binary
+            file.rocmBin.reset(new ROCmBinary(binarySize, binaryCode, 0));
+            file.disasm.reset(new Disassembler(*file.rocmBin, output,
+                    opts.hasGPUDeviceType, opts.gpuDeviceType, opts.disasmFlags));
+        }
+        else
+        {
+            // if gallium binary
+            file.galliumBin.reset(new GalliumBinary(binarySize, binaryCode, 0));
+            file.disasm.reset(new Disassembler(opts.gpuDeviceType, *file.galliumBin,
+                    output, opts.disasmFlags, opts.llvmVersion));
+        }
+    }
+    else
+        /* raw binaries */
+        file.disasm.reset(new Disassembler(opts.gpuDeviceType, binarySize, binaryCode,
+                output, opts.disasmFlags));
+    // code cache shared by all input files
+    file.disasm->setCodeCache(opts.codeCache);
+    file.disasm->setThreadsNum(opts.kernelThreads);
+}
+
+// escape CSV field: quote field if it has separator, quote or newline
+static std::string escapeCSVField(const char* field)
+{
+    if (::strpbrk(field, ",\"\r\n") == nullptr)
+        return field;
+    std::string out = "\"";
+    for (const char* p = field; *p != 0; p++)
+    {
+        if (*p == '"')
+            out.push_back('"'); // double quote
+        out.push_back(*p);
+    }
+    out.push_back('"');
+    return out;
+}
+
+// print CSV header of code statistics
+static void printCodeStatsHeader(std::ostream& output)
+{
+    output << "file,kernel,codesize,instrs,illegal,literals,waitcnts,maxsgpr,maxvgpr";
+    for (cxuint i = 0; i <= cxuint(DisasmInstrGroup::MAX_VALUE); i++)
+        output << ",group_" << getDisasmInstrGroupName(DisasmInstrGroup(i));
+    for (cxuint i = 0; i < DISASM_STATS_ENCODINGS_NUM; i++)
+        output << ",enc_" << getDisasmStatsEncodingName(i);
+    output << '\n';
+}
+
+// print code statistics of file as CSV rows (one row per kernel)
+static void printCodeStats(const char* filename, Disassembler& disasm,
+            std::ostream& output)
+{
+    std::vector<DisasmCodeStats> statsList;
+    disasm.getCodeStats(statsList);
+    for (const DisasmCodeStats& stats: statsList)
+    {
+        output << escapeCSVField(filename) << ',' <<
+                escapeCSVField(stats.name.c_str()) << ',' << stats.codeSize << ',' <<
+                stats.instrsNum << ',' << stats.illegalsNum << ',' <<
+                stats.literalsNum << ',' << stats.waitcntsNum << ',' <<
+                stats.maxSGPR << ',' << stats.maxVGPR;
+        for (size_t count: stats.groupCounts)
+            output << ',' << count;
+        for (size_t count: stats.encodingCounts)
+            output << ',' << count;
+        output << '\n';
+    }
+}
+
+// print CSV header of binary probes
+static void printProbeHeader(std::ostream& output)
+{
+    output << "file,format,bits,device,kernel,codesize\n";
+}
+
+// probe file and print CSV rows (one row per kernel or one row if no kernels)
+static void probeFile(const char* filename, std::ostream& output)
+{
+    Array<cxbyte> binaryData = loadDataFromFile(filename);
+    BinaryProbe probe;
+    probeBinary(binaryData.size(), binaryData.data(), probe);
+    std::string prefix = escapeCSVField(filename) + ',' +
+            getBinaryProbeFormatName(probe.format) + ',' +
+            (probe.is64Bit ? "64," : "32,") +
+            (probe.hasDeviceType ? getGPUDeviceTypeName(probe.deviceType) : "") + ',';
+    if (probe.kernels.empty())
+        output << prefix << ",\n";
+    for (const BinaryProbeKernel& kernel: probe.kernels)
+        output << prefix << escapeCSVField(kernel.name.c_str()) << ',' <<
+                kernel.codeSize << '\n';
+}
+
+// print CSV header if output is CSV (statistics or probe)
+static void printCSVHeader(const DisasmOptions& opts, std::ostream& output)
+{
+    if (opts.statsMode)
+        printCodeStatsHeader(output);
+    else if (opts.probeMode)
+        printProbeHeader(output);
+}
+
+// get file name without directories (both '/' and '\\' are separators)
+static const char* getFileBaseName(const char* path)
+{
+    const char* baseName = path;
+    for (const char* p = path; *p != 0; p++)
+        if (*p == '/' || *p == '\\')
+            baseName = p+1;
+    return baseName;
+}
+
+// disassemble single file, returns false if error encountered
+static bool disassembleFile(const char* filename, const DisasmOptions& opts,
+            std::ostream& output, std::ostream& errOutput)
+{
+    const bool csvMode = opts.statsMode || opts.probeMode;
+    if (!csvMode)
+        output << "/* Disassembling '" << filename << "\' */\n";
+    try
+    {
+        if (opts.probeMode)
+        {
+            probeFile(filename, output);
+            return true;
+        }
+        DisasmFile file;
+        openDisasmFile(filename, opts, output, file);
+        if (opts.statsMode)
+            printCodeStats(filename, *file.disasm, output);
+        else
+            runDisassembler(*file.disasm, opts.indexMode);
+    }
+    catch(const std::exception& ex)
+    {
+        if (!csvMode)
+            output << "/* ERROR for '" << filename << "\' */\n";
+        errOutput << "Error during disassemblying '" << filename << "': " <<
+                ex.what() << '\n';
+        return false;
+    }
+    return true;
+}
+
 int main(int argc, const char** argv)
 try
 {
@@ -91,136 +451,224 @@ try
              (cli.hasLongOption("buggyFPLit")?DISASM_BUGGYFPLIT:0) |
              (cli.hasShortOption('H')?DISASM_HSACONFIG:0) |
              (cli.hasShortOption('L')?DISASM_HSALAYOUT:0) |
-             (cli.hasShortOption('3')?DISASM_WAVE32:0);
+             (cli.hasShortOption('3')?DISASM_WAVE32:0) |
+             (cli.hasLongOption("estimate")?DISASM_ESTIMATE:0);
     
-    bool hasGPUDeviceType = false;
-    GPUDeviceType gpuDeviceType = GPUDeviceType::CAPE_VERDE;
-    const bool fromRawCode = cli.hasShortOption('r');
+    DisasmOptions opts{ disasmFlags, cli.hasShortOption('r'), false,
+            GPUDeviceType::CAPE_VERDE, 0, 0, DisasmIndexMode(),
+            cli.hasLongOption("stats"), cli.hasLongOption("probe"), nullptr,
+            cli.hasLongOption("amd3"), 1 };
     if (cli.hasShortOption('g'))
     {
-        gpuDeviceType = getGPUDeviceTypeFromName(cli.getShortOptArg<const char*>('g'));
-        hasGPUDeviceType = true;
+        opts.gpuDeviceType = getGPUDeviceTypeFromName(
+                    cli.getShortOptArg<const char*>('g'));
+        opts.hasGPUDeviceType = true;
     }
     else if (cli.hasShortOption('A'))
     {
-        gpuDeviceType = getLowestGPUDeviceTypeFromArchitecture(
+        opts.gpuDeviceType = getLowestGPUDeviceTypeFromArchitecture(
                     getGPUArchitectureFromName(cli.getShortOptArg<const char*>('A')));
-        hasGPUDeviceType = true;
+        opts.hasGPUDeviceType = true;
     }
     
-    cxuint driverVersion = 0;
     if (cli.hasShortOption('t'))
-        driverVersion = cli.getShortOptArg<cxuint>('t');
-    cxuint llvmVersion = 0;
+        opts.driverVersion = cli.getShortOptArg<cxuint>('t');
     if (cli.hasLongOption("llvmVersion"))
-        llvmVersion = cli.getLongOptArg<cxuint>("llvmVersion");
+        opts.llvmVersion = cli.getLongOptArg<cxuint>("llvmVersion");
+    if (cli.hasLongOption("kernelThreads"))
+        opts.kernelThreads = cli.getLongOptArg<cxuint>("kernelThreads");
+    
+    DisasmIndexMode& indexMode = opts.indexMode;
+    if (cli.hasLongOption("writeIndex"))
+        indexMode.writeIndexFile = cli.getLongOptArg<const char*>("writeIndex");
+    if (cli.hasLongOption("readIndex"))
+        indexMode.readIndexFile = cli.getLongOptArg<const char*>("readIndex");
+    if (cli.hasLongOption("window"))
+    {
+        indexMode.window = true;
+        parseDisasmWindow(cli.getLongOptArg<const char*>("window"), indexMode);
+    }
+    
+    std::unique_ptr<DisasmCodeCache> codeCache;
+    if (cli.hasLongOption("codeCache"))
+    {
+        codeCache.reset(new DisasmCodeCache(cli.getLongOptArg<size_t>("codeCache")));
+        opts.codeCache = codeCache.get();
+    }
+    
+    const bool diffMode = cli.hasLongOption("diff");
+    if ((diffMode?1:0) + (opts.statsMode?1:0) + (opts.probeMode?1:0) > 1)
+    {
+        std::cerr << "Only one of diff, statistics and probe modes can be used." <<
+                std::endl;
+        return 1;
+    }
+    if (diffMode)
+    {
+        if (cli.getArgsNum() != 2)
+        {
+            std::cerr << "Diff requires two input files." << std::endl;
+            return 1;
+        }
+        // configuration is compared too
+        opts.disasmFlags |= DISASM_CONFIG;
+    }
+    
+    cxuint jobsNum = 1;
+    if (cli.hasShortOption('j'))
+        jobsNum = cli.getShortOptArg<cxuint>('j');
+    const char* outputDir = nullptr;
+    if (cli.hasLongOption("outputDir"))
+        outputDir = cli.getLongOptArg<const char*>("outputDir");
+    // index of every file would be written to same index file
+    if (indexMode.writeIndexFile != nullptr && (jobsNum > 1 || cli.getArgsNum() > 1))
+    {
+        std::cerr << "Option '--writeIndex' can not be used with many input files "
+                "or with '--jobs' greater than 1." << std::endl;
+        return 1;
+    }
+    
+    // output stream: write directly to file descriptor with large buffer
+    size_t outBufSize = 1U<<20;
+    if (cli.hasLongOption("outBufSize"))
+        outBufSize = cli.getLongOptArg<size_t>("outBufSize");
+    const bool asyncOutput = cli.hasLongOption("asyncOutput");
+    std::unique_ptr<FDOStream> outStream;
+    // if output directory given, then every file has own output
+    if (diffMode)
+        outputDir = nullptr;
+    if (outputDir == nullptr && cli.hasShortOption('o'))
+        outStream.reset(new FDOStream(cli.getShortOptArg<const char*>('o'),
+                    outBufSize, asyncOutput));
+    else if (outputDir == nullptr)
+    {
+        std::cout.flush();
+        outStream.reset(new FDOStream(1, outBufSize, asyncOutput));
+    }
     
+    const char* const* args = cli.getArgs();
+    const size_t filesNum = cli.getArgsNum();
     int ret = 0;
-    for (const char* const* args = cli.getArgs();*args != nullptr; args++)
+    // output files in output directory: DIR/FILENAME.s
+    std::vector<std::string> outFilenames;
+    if (outputDir != nullptr)
     {
-        std::cout << "/* Disassembling '" << *args << "\' */" << std::endl;
-        Array<cxbyte> binaryData;
-        std::unique_ptr<AmdMainBinaryBase> base = nullptr;
-        try
+        std::unordered_map<std::string, size_t> outNames;
+        for (size_t i = 0; i < filesNum; i++)
         {
-            binaryData = loadDataFromFile(*args);
-            
-            if (!fromRawCode)
+            const std::string outName = std::string(getFileBaseName(args[i])) +
+                    ((opts.statsMode || opts.probeMode) ? ".csv" : ".s");
+            auto res = outNames.insert(std::make_pair(outName, i));
+            if (!res.second)
             {
-                // standard flags for binary format creators,
-                // needed by disassemblers to correctly getting all datas to dump
-                Flags binFlags = AMDBIN_CREATE_KERNELINFO | AMDBIN_CREATE_KERNELINFOMAP |
-                        AMDBIN_CREATE_INNERBINMAP | AMDBIN_CREATE_KERNELHEADERS |
-                        AMDBIN_CREATE_KERNELHEADERMAP;
-                // supply additional flags for CALNotes and info strings
-                if ((disasmFlags & (DISASM_CALNOTES|DISASM_CONFIG)) != 0)
-                    binFlags |= AMDBIN_INNER_CREATE_CALNOTES;
-                if ((disasmFlags & (DISASM_METADATA|DISASM_CONFIG)) != 0)
-                    binFlags |= AMDBIN_CREATE_INFOSTRINGS;
-                
-                if (isAmdBinary(binaryData.size(), binaryData.data()))
-                {
-                    // if amd binary
-                    base.reset(createAmdBinaryFromCode(binaryData.size(),
-                            binaryData.data(), binFlags));
-                    if (base->getType() == AmdMainType::GPU_BINARY)
-                    {
-                        AmdMainGPUBinary32* amdGpuBin =
-                                static_cast<AmdMainGPUBinary32*>(base.get());
-                        Disassembler disasm(*amdGpuBin, std::cout, disasmFlags);
-                        disasm.disassemble();
-                    }
-                    else if (base->getType() == AmdMainType::GPU_64_BINARY)
-                    {
-                        AmdMainGPUBinary64* amdGpuBin =
-                                static_cast<AmdMainGPUBinary64*>(base.get());
-                        Disassembler disasm(*amdGpuBin, std::cout, disasmFlags);
-                        disasm.disassemble();
-                    }
-                    else
-                        throw Exception("This is not AMDGPU binary file!");
-                }
-                else if (isAmdCL2Binary(binaryData.size(), binaryData.data()))
-                {   // AMD OpenCL 2.0 binary
-                    // extra (extra data) flags for OpenCL 2.0 disassembler
-                    binFlags |= AMDCL2BIN_INNER_CREATE_KERNELDATA |
-                                AMDCL2BIN_INNER_CREATE_KERNELDATAMAP |
-                                AMDCL2BIN_INNER_CREATE_KERNELSTUBS;
-                    base.reset(createAmdCL2BinaryFromCode(binaryData.size(),
-                                           binaryData.data(), binFlags));
-                    if (base->getType() == AmdMainType::GPU_CL2_BINARY)
-                    {
-                        AmdCL2MainGPUBinary32* amdGpuBin =
-                                static_cast<AmdCL2MainGPUBinary32*>(base.get());
-                        Disassembler disasm(*amdGpuBin, std::cout, disasmFlags,
-                                            driverVersion);
-                        disasm.disassemble();
-                    }
-                    else if (base->getType() == AmdMainType::GPU_CL2_64_BINARY)
-                    {
-                        AmdCL2MainGPUBinary64* amdGpuBin =
-                                static_cast<AmdCL2MainGPUBinary64*>(base.get());
-                        Disassembler disasm(*amdGpuBin, std::cout, disasmFlags,
-                                            driverVersion);
-                        disasm.disassemble();
-                    }
-                    else
-                        throw Exception("This is not AMDGPU binary file!");
-                }
-                else if (isROCmBinary(binaryData.size(), binaryData.data()))
+                std::cerr << "Output files for '" << args[res.first->second] <<
+                        "' and '" << args[i] << "' have the same name '" << outName <<
+                        "' in output directory." << std::endl;
+                return 1;
+            }
+            outFilenames.push_back(joinPaths(outputDir, outName));
+        }
+    }
+    if (outStream)
+        printCSVHeader(opts, *outStream);
+    if (diffMode)
+    {
+        // differences between two binaries
+        DisasmFile fileA, fileB;
+        openDisasmFile(args[0], opts, *outStream, fileA);
+        openDisasmFile(args[1], opts, *outStream, fileB);
+        *outStream << "--- " << args[0] << "\n+++ " << args[1] << "\n";
+        if (diffDisassemblers(*fileA.disasm, *fileB.disasm, *outStream) != 0)
+            ret = 1;
+    }
+    else if (outputDir == nullptr && jobsNum == 1)
+    {
+        // sequential disassembling to single output
+        for (size_t i = 0; i < filesNum; i++)
+            if (!disassembleFile(args[i], opts, *outStream, std::cerr))
+                ret = 1;
+    }
+    else
+    {
+        /* files are disassembled by many threads. outputs (or error messages if
+         * output is written to own file) are buffered and emitted in argument order
+         * by thread that finished first not emitted file. Files are fetched
+         * in argument order, and file is started only if it is not too far from
+         * first not emitted file, hence number of buffered outputs is bounded */
+        std::unique_ptr<std::string[]> outBuffers(new std::string[filesNum]);
+        std::unique_ptr<std::string[]> errBuffers(new std::string[filesNum]);
+        std::unique_ptr<bool[]> filesDone(new bool[filesNum]);
+        std::fill(filesDone.get(), filesDone.get()+filesNum, false);
+        size_t nextToEmit = 0;
+        std::mutex emitMutex;
+        std::condition_variable emitCond;
+        const size_t maxBufferedFiles = 2*size_t((jobsNum != 0) ? jobsNum :
+                    getHardwareThreadsNum());
+        
+        parallelForEach(filesNum, jobsNum, [&](size_t i)
+        {
+            if (outputDir == nullptr)
+            {
+                // wait until output of this file can be buffered
+                std::unique_lock<std::mutex> lock(emitMutex);
+                emitCond.wait(lock, [&]() { return i < nextToEmit + maxBufferedFiles; });
+            }
+            bool good = true;
+            StringOStream errOss(errBuffers[i]);
+            if (outputDir != nullptr)
+            {
+                // write output to DIR/FILENAME.s
+                const char* filename = args[i];
+                const std::string& outFilename = outFilenames[i];
+                try
                 {
-                    // ROCm binary
-                    ROCmBinary rocmBin(binaryData.size(), binaryData.data(), 0);
-                    Disassembler disasm(rocmBin, std::cout, hasGPUDeviceType, gpuDeviceType,
-                                        disasmFlags);
-                    disasm.disassemble();
+                    FDOStream fileOutput(outFilename.c_str(), outBufSize, asyncOutput);
+                    printCSVHeader(opts, fileOutput);
+                    good = disassembleFile(filename, opts, fileOutput, errOss);
+                    fileOutput.flush();
+                    if (!fileOutput)
+                        throw Exception("Can't write output");
                 }
-                else
+                catch(const std::exception& ex)
                 {
-                    // if gallium binary
-                    GalliumBinary galliumBin(binaryData.size(),binaryData.data(), 0);
-                    Disassembler disasm(gpuDeviceType, galliumBin, std::cout,
-                            disasmFlags, llvmVersion);
-                    disasm.disassemble();
+                    errOss << "Error for output '" << outFilename << "': " <<
+                            ex.what() << std::endl;
+                    good = false;
                 }
             }
             else
             {
-                /* raw binaries */
-                Disassembler disasm(gpuDeviceType, binaryData.size(), binaryData.data(),
-                        std::cout, disasmFlags);
-                disasm.disassemble();
+                StringOStream outOss(outBuffers[i]);
+                good = disassembleFile(args[i], opts, outOss, errOss);
             }
-        }
-        catch(const std::exception& ex)
-        {
-            ret = 1;
-            std::cout << "/* ERROR for '" << *args << "\' */" << std::endl;
-            std::cerr << "Error during disassemblying '" << *args << "': " <<
-                    ex.what() << std::endl;
-        }
+            
+            std::lock_guard<std::mutex> lock(emitMutex);
+            if (!good)
+                ret = 1;
+            filesDone[i] = true;
+            for (; nextToEmit < filesNum && filesDone[nextToEmit]; nextToEmit++)
+            {
+                // emit outputs of finished files in order
+                if (outStream)
+                    outStream->write(outBuffers[nextToEmit].data(),
+                            outBuffers[nextToEmit].size());
+                std::cerr << errBuffers[nextToEmit];
+                std::string().swap(outBuffers[nextToEmit]);
+                std::string().swap(errBuffers[nextToEmit]);
+            }
+            emitCond.notify_all();
+        });
     }
     
+    if (!outStream)
+        return ret;
+    std::ostream& output = *outStream;
+    output.flush();
+    if (!output)
+    {
+        std::cerr << "Can't write output" << std::endl;
+        return 1;
+    }
     return ret;
 }
 catch(const Exception& ex)
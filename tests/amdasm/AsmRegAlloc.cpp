@@ -123,7 +123,8 @@ static TestSingleVReg getTestSingleVReg(const AsmSingleVReg& vr,
     return { it->second, vr.index };
 }
 
-static void testCreateSSAData(cxuint testSuiteId, cxuint i, const AsmSSADataCase& testCase)
+static void testCreateSSAData(cxuint testSuiteId, cxuint i, const AsmSSADataCase& testCase,
+            cxuint threadsNum = 1)
 {
     std::cout << "-----------------------------------------------\n"
     "           Test " << testSuiteId << " " << i << "\n"
@@ -144,6 +145,7 @@ static void testCreateSSAData(cxuint testSuiteId, cxuint i, const AsmSSADataCase
     const AsmSection& section = assembler.getSections()[0];
     
     AsmRegAllocator regAlloc(assembler);
+    regAlloc.setThreadsNum(threadsNum);
     
     regAlloc.createCodeStructure(section.codeFlow, section.getSize(),
                             section.content.data());
@@ -322,5 +324,14 @@ int main(int argc, const char** argv)
             std::cerr << ex.what() << std::endl;
             retVal = 1;
         }
+    // check whether result does not depend on number of threads
+    for (size_t i = 0; ssaDataTestCases1Tbl[i].input!=nullptr; i++)
+        try
+        { testCreateSSAData(3, i, ssaDataTestCases1Tbl[i], 4); }
+        catch(const std::exception& ex)
+        {
+            std::cerr << ex.what() << std::endl;
+            retVal = 1;
+        }
     return retVal;
 }
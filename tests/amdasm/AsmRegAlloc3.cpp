@@ -2931,6 +2931,115 @@ b1:     .rvlin_once va[3:6]
         { },  // vidxCallMap
         true, ""
     },
+    {   // 45 - nested loops
+        R"ffDXD(.regvar sa:s:8, va:v:8
+        s_mov_b32 sa[0], 0              # 0
+        v_mov_b32 va[0], v0             # 4
+outer:
+        s_mov_b32 sa[1], 0              # 8
+inner:
+        v_add_f32 va[0], va[1], va[0]   # 12
+        s_add_u32 sa[1], sa[1], 1       # 16
+        s_cmp_lt_u32 sa[1], s5          # 20
+        s_cbranch_scc1 inner            # 24
+        s_add_u32 sa[0], sa[0], 1       # 28
+        s_cmp_lt_u32 sa[0], s4          # 32
+        s_cbranch_scc1 outer            # 36
+        v_mov_b32 va[2], va[0]          # 40
+        s_endpgm                        # 44
+)ffDXD",
+        {   // livenesses
+            {   // for SGPRs
+                { { 0, 40 } }, // 0: S4
+                { { 0, 40 } }, // 1: S5
+                { { 1, 40 } }, // 2: sa[0]'0
+                { { 9, 28 } }  // 3: sa[1]'0
+            },
+            {   // for VGPRs
+                { { 0, 5 } }, // 0: V0
+                { { 5, 41 } }, // 1: va[0]'0
+                { { 0, 40 } }, // 2: va[1]'0
+                { { 41, 42 } }  // 3: va[2]'0
+            },
+            { },
+            { }
+        },
+        { },  // linearDepMaps
+        { },  // vidxRoutineMap
+        { },  // vidxCallMap
+        true, ""
+    },
+    {   // 46 - nested loops with fork in inner loop
+        R"ffDXD(.regvar sa:s:8, va:v:8
+        s_mov_b32 sa[0], s4             # 0
+outer:
+        v_mov_b32 va[0], sa[0]          # 4
+inner:
+        s_cbranch_scc0 skip             # 8
+        v_add_f32 va[1], va[0], va[1]   # 12
+        s_branch innerend               # 16
+skip:   v_add_f32 va[2], va[0], va[2]   # 20
+innerend:
+        s_cbranch_scc1 inner            # 24
+        s_add_u32 sa[0], sa[0], -1      # 28
+        s_cbranch_scc1 outer            # 32
+        v_mov_b32 va[3], va[1]          # 36
+        v_mov_b32 va[3], va[2]          # 40
+        s_endpgm                        # 44
+)ffDXD",
+        {   // livenesses
+            {   // for SGPRs
+                { { 0, 1 } }, // 0: S4
+                { { 1, 36 } }  // 1: sa[0]'0
+            },
+            {   // for VGPRs
+                { { 5, 28 } }, // 0: va[0]'0
+                { { 0, 37 } }, // 1: va[1]'0
+                { { 0, 41 } }, // 2: va[2]'0
+                { { 37, 38 } }, // 3: va[3]'0
+                { { 41, 42 } }  // 4: va[3]'1
+            },
+            { },
+            { }
+        },
+        { },  // linearDepMaps
+        { },  // vidxRoutineMap
+        { },  // vidxCallMap
+        true, ""
+    },
+    {   // 47 - two kernels (independent code regions)
+        R"ffDXD(.regvar sa:s:8
+        s_mov_b32 sa[2], s4             # 0
+        s_add_u32 sa[2], sa[2], sa[3]   # 4
+        s_endpgm                        # 8
+        .cf_start
+kernel2:
+        s_mov_b32 sa[2], s5             # 12
+        s_cbranch_scc0 k2end            # 16
+        s_add_u32 sa[2], sa[2], sa[3]   # 20
+k2end:  s_mov_b32 sa[3], sa[2]          # 24
+        s_endpgm                        # 28
+)ffDXD",
+        {   // livenesses
+            {   // for SGPRs
+                { { 0, 1 } }, // 0: S4
+                { { 12, 13 } }, // 1: S5
+                { { 1, 5 } }, // 2: sa[2]'1
+                { { 5, 6 } }, // 3: sa[2]'2
+                { { 13, 25 } }, // 4: sa[2]'4
+                { { 0, 5 } }, // 5: sa[3]'0
+                { { 12, 21 } }, // 6: sa[3]'1
+                { { 25, 26 } }  // 7: sa[3]'2
+            },
+            { },
+            { },
+            { }
+        },
+        { },  // linearDepMaps
+        { },  // vidxRoutineMap
+        { },  // vidxCallMap
+        true, ""
+    },
 };
 
 static TestSingleVReg getTestSingleVReg(const AsmSingleVReg& vr,
@@ -3167,6 +3276,81 @@ static void testCreateLivenessesCase(cxuint i, const AsmLivenessesCase& testCase
                 regAlloc.getVIdxCallMap(), revLvIndexCvtTables);
 }
 
+struct RegAllocResult
+{
+    std::vector<std::vector<std::pair<size_t, size_t> > > livenesses[MAX_REGTYPES_NUM];
+    std::vector<std::vector<size_t> > interGraphs[MAX_REGTYPES_NUM];
+    std::vector<cxuint> colorMaps[MAX_REGTYPES_NUM];
+};
+
+static void runRegAllocator(Assembler& assembler, cxuint threadsNum,
+            RegAllocResult& result)
+{
+    const AsmSection& section = assembler.getSections()[0];
+    AsmRegAllocator regAlloc(assembler);
+    regAlloc.setThreadsNum(threadsNum);
+    regAlloc.createCodeStructure(section.codeFlow, section.getSize(),
+                            section.content.data());
+    regAlloc.createSSAData(*section.usageHandler, *section.linearDepHandler);
+    regAlloc.applySSAReplaces();
+    regAlloc.createLivenesses(*section.usageHandler, *section.linearDepHandler);
+    for (size_t r = 0; r < MAX_REGTYPES_NUM; r++)
+        for (const auto& lv: regAlloc.getOutLivenesses()[r])
+            result.livenesses[r].push_back(std::vector<std::pair<size_t, size_t> >(
+                        lv.begin(), lv.end()));
+    regAlloc.createInterferenceGraph();
+    regAlloc.colorInterferenceGraph();
+    for (size_t r = 0; r < MAX_REGTYPES_NUM; r++)
+    {
+        for (const auto& node: regAlloc.getInterGraphs()[r])
+            result.interGraphs[r].push_back(std::vector<size_t>(
+                        node.begin(), node.end()));
+        const Array<cxuint>& colorMap = regAlloc.getGraphColorMaps()[r];
+        result.colorMaps[r].assign(colorMap.begin(), colorMap.end());
+    }
+}
+
+// livenesses, interference graphs and colors must not depend on threads number
+static void testRegAllocThreads(cxuint i, const AsmLivenessesCase& testCase)
+{
+    std::ostringstream oss;
+    oss << " testRegAllocThreads case#" << i;
+    const std::string testCaseName = oss.str();
+    // same assembler for all runs: var index maps depend on addresses of regvars
+    std::istringstream input(testCase.input);
+    std::ostringstream errorStream;
+    Assembler assembler("test.s", input,
+                    (ASM_ALL&~ASM_ALTMACRO) | ASM_TESTRUN | ASM_TESTRESOLVE,
+                    BinaryFormat::RAWCODE, GPUDeviceType::CAPE_VERDE, errorStream);
+    assembler.assemble();
+    RegAllocResult expected;
+    runRegAllocator(assembler, 1, expected);
+    // check coloring: every node colored and differs from its neighbors
+    for (size_t r = 0; r < MAX_REGTYPES_NUM; r++)
+        for (size_t node = 0; node < expected.colorMaps[r].size(); node++)
+        {
+            const cxuint color = expected.colorMaps[r][node];
+            assertTrue("testRegAllocThreads", testCaseName+".colored", color != UINT_MAX);
+            for (size_t nb: expected.interGraphs[r][node])
+                assertTrue("testRegAllocThreads", testCaseName+".coloring",
+                           color != expected.colorMaps[r][nb]);
+        }
+    for (cxuint threadsNum: { 0U, 3U })
+    {
+        RegAllocResult result;
+        runRegAllocator(assembler, threadsNum, result);
+        for (size_t r = 0; r < MAX_REGTYPES_NUM; r++)
+        {
+            assertTrue("testRegAllocThreads", testCaseName+".livenesses",
+                       expected.livenesses[r] == result.livenesses[r]);
+            assertTrue("testRegAllocThreads", testCaseName+".interGraphs",
+                       expected.interGraphs[r] == result.interGraphs[r]);
+            assertTrue("testRegAllocThreads", testCaseName+".colorMaps",
+                       expected.colorMaps[r] == result.colorMaps[r]);
+        }
+    }
+}
+
 int main(int argc, const char** argv)
 {
     int retVal = 0;
@@ -3178,5 +3362,14 @@ int main(int argc, const char** argv)
             std::cerr << ex.what() << std::endl;
             retVal = 1;
         }
+    for (size_t i = 0; i < sizeof(createLivenessesCasesTbl)/sizeof(AsmLivenessesCase); i++)
+        if (createLivenessesCasesTbl[i].good)
+            try
+            { testRegAllocThreads(i, createLivenessesCasesTbl[i]); }
+            catch(const std::exception& ex)
+            {
+                std::cerr << ex.what() << std::endl;
+                retVal = 1;
+            }
     return retVal;
 }
@@ -3275,5 +3275,54 @@ loopend:
         },
         true, ""
     },
+    {   // 28 - two kernels (independent code regions)
+        R"ffDXD(.regvar sa:s:8
+        s_mov_b32 sa[2], s4
+        s_add_u32 sa[2], sa[2], sa[3]
+        s_endpgm
+        .cf_start
+kernel2:
+        s_mov_b32 sa[2], s5
+        s_cbranch_scc0 k2end
+        s_add_u32 sa[2], sa[2], sa[3]
+k2end:  s_mov_b32 sa[3], sa[2]
+        s_endpgm
+)ffDXD",
+        {
+            {   // block 0 - kernel 1
+                0, 12,
+                { },
+                {
+                    { { "", 4 }, SSAInfo(0, 0, 0, 0, 0, true) },
+                    { { "sa", 2 }, SSAInfo(0, 1, 1, 2, 2, false) },
+                    { { "sa", 3 }, SSAInfo(0, SIZE_MAX, 1, SIZE_MAX, 0, true) }
+                }, false, false, true },
+            {   // block 1 - kernel 2 (SSA ids follow SSA ids of kernel 1)
+                12, 20,
+                { { 2, false }, { 3, false } },
+                {
+                    { { "", 5 }, SSAInfo(0, 0, 0, 0, 0, true) },
+                    { { "sa", 2 }, SSAInfo(3, 4, 4, 4, 1, false) }
+                }, false, false, false },
+            {   // block 2
+                20, 24,
+                { },
+                {
+                    { { "sa", 2 }, SSAInfo(4, 5, 5, 5, 1, true) },
+                    { { "sa", 3 }, SSAInfo(1, SIZE_MAX, 2, SIZE_MAX, 0, true) }
+                }, false, false, false },
+            {   // block 3 - k2end
+                24, 32,
+                { },
+                {
+                    { { "sa", 2 }, SSAInfo(5, SIZE_MAX, 6, SIZE_MAX, 0, true) },
+                    { { "sa", 3 }, SSAInfo(1, 2, 2, 2, 1, false) }
+                }, false, false, true }
+        },
+        {   // SSA replaces
+            { { "sa", 2 }, { { 5, 4 } } }
+        },
+        true, ""
+    },
     { nullptr }
 };
@@ -0,0 +1,143 @@
+/*
+ *  CLRadeonExtender - Unofficial OpenCL Radeon Extensions Library
+ *  Copyright (C) 2014-2018 Mateusz Szpakowski
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <CLRX/Config.h>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <cstring>
+#include <CLRX/utils/Utilities.h>
+#include <CLRX/utils/Containers.h>
+#include <CLRX/amdbin/ROCmBinaries.h>
+#include <CLRX/amdbin/Amd3Binaries.h>
+#include <CLRX/amdasm/Disassembler.h>
+
+using namespace CLRX;
+
+static const char* llvm10File = CLRX_SOURCE_DIR
+        "/tests/amdasm/amdbins/two_kernels-rocm-llvm10.clo";
+
+static const char* rocmFiles[] =
+{
+    CLRX_SOURCE_DIR "/tests/amdasm/amdbins/rocm-fiji.hsaco",
+    CLRX_SOURCE_DIR "/tests/amdasm/amdbins/rocm-fiji-diffdims.hsaco",
+    CLRX_SOURCE_DIR "/tests/amdasm/amdbins/two_kernels-rocm-llvm10.clo"
+};
+
+static std::string disassembleROCm(const ROCmBinary& binary, Flags flags,
+            cxuint threadsNum)
+{
+    std::ostringstream disOss;
+    Disassembler disasm(binary, disOss, flags);
+    disasm.setThreadsNum(threadsNum);
+    disasm.disassemble();
+    return disOss.str();
+}
+
+static std::string disassembleAmd3(const Amd3Binary& binary, Flags flags,
+            cxuint threadsNum)
+{
+    std::ostringstream disOss;
+    Disassembler disasm(binary, disOss, flags);
+    disasm.setThreadsNum(threadsNum);
+    disasm.disassemble();
+    return disOss.str();
+}
+
+static void testAmd3Binary(Flags creationFlags)
+{
+    Array<cxbyte> rocmData = loadDataFromFile(llvm10File);
+    Array<cxbyte> amd3Data = loadDataFromFile(llvm10File);
+    if (!isAmd3Binary(amd3Data.size(), amd3Data.data()))
+        throw Exception("FAILED amd3Binary: binary is not detected");
+    ROCmBinary rocmBin(rocmData.size(), rocmData.data(), ROCMBIN_CREATE_ALL);
+    Amd3Binary amd3Bin(amd3Data.size(), amd3Data.data(), creationFlags);
+
+    if (amd3Bin.getRegionsNum() != rocmBin.getRegionsNum() ||
+        amd3Bin.getKernelDescsNum() != 2 || amd3Bin.getKernelInfosNum() != 2 ||
+        amd3Bin.getCodeSize() != rocmBin.getCodeSize())
+        throw Exception("FAILED amd3Binary: wrong number of regions or kernels");
+    for (size_t i = 0; i < rocmBin.getRegionsNum(); i++)
+    {
+        const ROCmRegion& rocmRegion = rocmBin.getRegion(i);
+        const Amd3Region& region = amd3Bin.getRegion(rocmRegion.regionName.c_str());
+        if (region.offset != rocmRegion.offset || region.size != rocmRegion.size)
+            throw Exception(std::string("FAILED amd3Binary: wrong region ")+
+                        rocmRegion.regionName.c_str());
+        if (region.type != Amd3RegionType::KERNEL)
+            continue;
+        // kernel descriptor must point to same data as in ROCm binary
+        const ROCmKernelDescriptor* rocmDesc =
+                rocmBin.getKernelDescriptor(rocmRegion.regionName.c_str());
+        const Amd3KernelDescriptor& desc =
+                amd3Bin.getKernelDesc(rocmRegion.regionName.c_str());
+        if (region.kernelDesc == SIZE_MAX || rocmDesc == nullptr ||
+            &amd3Bin.getKernelDesc(region.kernelDesc) != &desc ||
+            ::memcmp(&desc, rocmDesc, sizeof(Amd3KernelDescriptor)) != 0)
+            throw Exception(std::string("FAILED amd3Binary: wrong kernel descriptor ")+
+                        rocmRegion.regionName.c_str());
+        if (amd3Bin.getKernelInfo(rocmRegion.regionName.c_str()).name !=
+                    rocmRegion.regionName)
+            throw Exception(std::string("FAILED amd3Binary: wrong kernel info ")+
+                        rocmRegion.regionName.c_str());
+    }
+
+    // disassembly must be same as for ROCm binary (in many threads too)
+    const std::string expected = disassembleROCm(rocmBin, DISASM_ALL, 1);
+    for (cxuint threadsNum: { 1U, 0U, 3U })
+        if (disassembleAmd3(amd3Bin, DISASM_ALL, threadsNum) != expected)
+            throw Exception("FAILED amd3Binary: disassembly mismatch");
+}
+
+static void testKernelThreads(const char* filename)
+{
+    Array<cxbyte> data = loadDataFromFile(filename);
+    ROCmBinary rocmBin(data.size(), data.data(), 0);
+    for (Flags flags: { Flags(DISASM_ALL), Flags(DISASM_DUMPCODE|DISASM_HSALAYOUT),
+                Flags(DISASM_DUMPCODE|DISASM_CODEPOS|DISASM_HEXCODE) })
+    {
+        const std::string expected = disassembleROCm(rocmBin, flags, 1);
+        for (cxuint threadsNum: { 0U, 2U, 4U })
+            if (disassembleROCm(rocmBin, flags, threadsNum) != expected)
+                throw Exception(std::string("FAILED kernelThreads: ")+filename);
+    }
+}
+
+int main(int argc, const char** argv)
+{
+    int retVal = 0;
+    for (Flags flags: { Flags(AMD3BIN_CREATE_ALL),
+                Flags(AMD3BIN_CREATE_ALL|BINARY_CREATE_NAMEHASHINDEX) })
+        try
+        { testAmd3Binary(flags); }
+        catch(const std::exception& ex)
+        {
+            std::cerr << ex.what() << std::endl;
+            retVal = 1;
+        }
+    for (const char* filename: rocmFiles)
+        try
+        { testKernelThreads(filename); }
+        catch(const std::exception& ex)
+        {
+            std::cerr << ex.what() << std::endl;
+            retVal = 1;
+        }
+    return retVal;
+}
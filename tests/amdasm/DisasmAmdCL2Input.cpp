@@ -0,0 +1,158 @@
+/*
+ *  CLRadeonExtender - Unofficial OpenCL Radeon Extensions Library
+ *  Copyright (C) 2014-2018 Mateusz Szpakowski
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <CLRX/Config.h>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <memory>
+#include <CLRX/utils/Utilities.h>
+#include <CLRX/utils/Containers.h>
+#include <CLRX/utils/MemAccess.h>
+#include <CLRX/amdbin/AmdCL2Binaries.h>
+#include <CLRX/amdasm/Assembler.h>
+#include <CLRX/amdasm/Disassembler.h>
+
+using namespace CLRX;
+
+static const char* cl2SourceFormat = R"ffDXD(.amdcl2
+.64bit
+.gpu Bonaire
+.driver_version %u
+.kernel kernelA
+    .config
+        .dims x
+        .setupargs
+        .arg n,uint
+    .text
+        s_and_b32 s9,s5,44
+        s_endpgm
+.kernel kernelB
+    .config
+        .dims x
+        .setupargs
+        .arg n,uint
+    .text
+        s_and_b32 s10,s5,5
+        s_endpgm
+)ffDXD";
+
+static Array<cxbyte> assembleAmdCL2(cxuint driverVersion)
+{
+    char source[1024];
+    snprintf(source, sizeof source, cl2SourceFormat, driverVersion);
+    std::istringstream input(source);
+    std::ostringstream errorStream;
+    Assembler assembler("test.s", input, ASM_ALL&~ASM_ALTMACRO,
+            BinaryFormat::AMDCL2, GPUDeviceType::BONAIRE, errorStream);
+    if (!assembler.assemble())
+        throw Exception("Can't assemble AMDCL2 binary: "+errorStream.str());
+    Array<cxbyte> binary;
+    assembler.writeBinary(binary);
+    return binary;
+}
+
+// disassemble binary, returns exception message or empty string
+static std::string disassembleAmdCL2(Array<cxbyte>& binaryCode, std::string& text)
+{
+    AmdCL2MainGPUBinary64 binary(binaryCode.size(), binaryCode.data(),
+                AMDBIN_CREATE_ALL|AMDCL2BIN_INNER_CREATE_KERNELDATA|
+                AMDCL2BIN_INNER_CREATE_KERNELDATAMAP|AMDCL2BIN_INNER_CREATE_KERNELSTUBS);
+    std::ostringstream disOss;
+    // kernel datas are not loaded while creating disassembler
+    Disassembler disasm(binary, disOss, DISASM_DUMPCODE);
+    std::string error;
+    try
+    { disasm.disassemble(); }
+    catch(const Exception& ex)
+    { error = ex.what(); }
+    text = disOss.str();
+    return error;
+}
+
+static void testDeferredErrors(cxuint driverVersion)
+{
+    std::ostringstream nameOss;
+    nameOss << "deferredErrors" << driverVersion;
+    const std::string testName = nameOss.str();
+    const Array<cxbyte> code = assembleAmdCL2(driverVersion);
+
+    Array<cxbyte> binaryCode = code;
+    std::string expected;
+    std::string error = disassembleAmdCL2(binaryCode, expected);
+    if (!error.empty())
+        throw Exception("FAILED "+testName+": disassembly of good binary: "+error);
+
+    // find place of setup and stub of second kernel
+    size_t setupOffset = 0, stubOffset = 0;
+    {
+        binaryCode = code;
+        AmdCL2MainGPUBinary64 binary(binaryCode.size(), binaryCode.data(),
+                AMDBIN_CREATE_ALL|AMDCL2BIN_INNER_CREATE_KERNELDATA|
+                AMDCL2BIN_INNER_CREATE_KERNELSTUBS);
+        const AmdCL2GPUKernel& kernel = binary.getInnerBinaryBase().getKernelData(1);
+        if (kernel.kernelName != "kernelB")
+            throw Exception("FAILED "+testName+": wrong kernel order");
+        setupOffset = kernel.setup - binaryCode.data();
+        if (driverVersion < 191205)
+            stubOffset = binary.getOldInnerBinary().getKernelStub(1).data -
+                        binaryCode.data();
+    }
+
+    const size_t kernelBPos = expected.find(".kernel kernelB");
+    if (kernelBPos == std::string::npos)
+        throw Exception("FAILED "+testName+": no second kernel");
+    // malformed text offset in setup of second kernel
+    binaryCode = code;
+    SULEV(*reinterpret_cast<uint32_t*>(binaryCode.data() + setupOffset + 16),
+                0x7fffffffU);
+    std::string text;
+    error = disassembleAmdCL2(binaryCode, text);
+    if (error != "Kernel text offset out of range")
+        throw Exception("FAILED "+testName+": text offset: wrong error: "+error);
+    // first kernel is disassembled before error
+    if (text.compare(0, kernelBPos, expected, 0, kernelBPos) != 0)
+        throw Exception("FAILED "+testName+": text offset: first kernel: "+text);
+
+    if (driverVersion < 191205)
+    {
+        // malformed setup offset in stub of second kernel
+        binaryCode = code;
+        SULEV(*reinterpret_cast<uint32_t*>(binaryCode.data() + stubOffset), 0x7fffffffU);
+        error = disassembleAmdCL2(binaryCode, text);
+        if (error != "Kernel setup offset out of range")
+            throw Exception("FAILED "+testName+": setup offset: wrong error: "+error);
+        if (text.compare(0, kernelBPos, expected, 0, kernelBPos) != 0)
+            throw Exception("FAILED "+testName+": setup offset: first kernel: "+text);
+    }
+}
+
+int main(int argc, const char** argv)
+{
+    int retVal = 0;
+    for (cxuint driverVersion: { 180005U, 191205U })
+        try
+        { testDeferredErrors(driverVersion); }
+        catch(const std::exception& ex)
+        {
+            std::cerr << ex.what() << std::endl;
+            retVal = 1;
+        }
+    return retVal;
+}
@@ -0,0 +1,355 @@
+/*
+ *  CLRadeonExtender - Unofficial OpenCL Radeon Extensions Library
+ *  Copyright (C) 2014-2018 Mateusz Szpakowski
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <CLRX/Config.h>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <algorithm>
+#include <CLRX/utils/Utilities.h>
+#include <CLRX/utils/Containers.h>
+#include <CLRX/utils/MemAccess.h>
+#include <CLRX/amdasm/Disassembler.h>
+
+using namespace CLRX;
+
+static const uint32_t rawCodeWords[] =
+{
+    0xd8dc2625U, 0x37000006U, 0xbf82fffeU, 0xbf820002U,
+    0xea88f7d4U, 0x23f43d12U, 0xd25a0037U, 0x4002b41bU,
+    0, 0, 0, 0xbf810000U
+};
+
+static std::string disassembleRawCode(const Array<uint32_t>& code, Flags flags,
+            DisasmCodeCache* codeCache)
+{
+    std::ostringstream disOss;
+    Disassembler disasm(GPUDeviceType::PITCAIRN, code.size()<<2,
+                reinterpret_cast<const cxbyte*>(code.data()), disOss, flags);
+    disasm.setCodeCache(codeCache);
+    disasm.disassemble();
+    return disOss.str();
+}
+
+static void testRawCodeCache()
+{
+    Array<uint32_t> code(sizeof(rawCodeWords)>>2);
+    for (size_t i = 0; i < code.size(); i++)
+        code[i] = LEV(rawCodeWords[i]);
+    const Flags flags = DISASM_DUMPCODE;
+    const std::string expected = disassembleRawCode(code, flags, nullptr);
+    
+    DisasmCodeCache codeCache;
+    std::string result = disassembleRawCode(code, flags, &codeCache);
+    if (result != expected)
+        throw Exception("FAILED rawCodeCache: first disassembly: "+result);
+    if (codeCache.getHitsNum() != 0 || codeCache.getMissesNum() != 1 ||
+        codeCache.getSize() == 0)
+        throw Exception("FAILED rawCodeCache: text is not cached");
+    // same code again - text from cache
+    result = disassembleRawCode(code, flags, &codeCache);
+    if (result != expected)
+        throw Exception("FAILED rawCodeCache: cached disassembly: "+result);
+    if (codeCache.getHitsNum() != 1 || codeCache.getMissesNum() != 1)
+        throw Exception("FAILED rawCodeCache: cache is not hit");
+    
+    // other flags - other text
+    const std::string expectedHex = disassembleRawCode(code, flags|DISASM_HEXCODE,
+                    nullptr);
+    result = disassembleRawCode(code, flags|DISASM_HEXCODE, &codeCache);
+    if (result != expectedHex || codeCache.getHitsNum() != 1)
+        throw Exception("FAILED rawCodeCache: other flags: "+result);
+    // other branch target - other label
+    code[3] = LEV(0xbf820001U);
+    const std::string expectedBranch = disassembleRawCode(code, flags, nullptr);
+    result = disassembleRawCode(code, flags, &codeCache);
+    if (result != expectedBranch || codeCache.getHitsNum() != 1 ||
+        codeCache.getMissesNum() != 3)
+        throw Exception("FAILED rawCodeCache: other code: "+result);
+    
+    // too small cache - nothing is inserted
+    DisasmCodeCache smallCache(16);
+    disassembleRawCode(code, flags, &smallCache);
+    result = disassembleRawCode(code, flags, &smallCache);
+    if (result != expectedBranch || smallCache.getSize() != 0 ||
+        smallCache.getHitsNum() != 0)
+        throw Exception("FAILED rawCodeCache: full cache: "+result);
+}
+
+static const uint32_t galliumCodeWords[] =
+{
+    0xbe8003ffU, 0x00000000U, 0xbf820000U, 0xbf810000U,
+    0xbe8003ffU, 0x00000000U, 0xbf820000U, 0xbf810000U
+};
+
+static void testGalliumCodeCache()
+{
+    Array<uint32_t> code(sizeof(galliumCodeWords)>>2);
+    for (size_t i = 0; i < code.size(); i++)
+        code[i] = LEV(galliumCodeWords[i]);
+    GalliumDisasmInput input;
+    input.deviceType = GPUDeviceType::PITCAIRN;
+    input.is64BitMode = false;
+    input.isLLVM390 = false;
+    input.isMesa170 = false;
+    input.isAMDHSA = false;
+    input.globalDataSize = 0;
+    input.globalData = nullptr;
+    input.code = reinterpret_cast<const cxbyte*>(code.data());
+    input.codeSize = code.size()<<2;
+    input.kernels.resize(2);
+    input.kernels[0].kernelName = "kernelA";
+    input.kernels[0].offset = 0;
+    input.kernels[1].kernelName = "kernelB";
+    input.kernels[1].offset = 16;
+    input.scratchRelocs.push_back({ 4, RELTYPE_LOW_32BIT });
+    
+    std::ostringstream expectedOss;
+    {
+        Disassembler disasm(&input, expectedOss, DISASM_DUMPCODE);
+        disasm.disassemble();
+    }
+    DisasmCodeCache codeCache;
+    for (cxuint k = 0; k < 2; k++)
+    {
+        std::ostringstream disOss;
+        Disassembler disasm(&input, disOss, DISASM_DUMPCODE);
+        disasm.setCodeCache(&codeCache);
+        disasm.disassemble();
+        if (disOss.str() != expectedOss.str())
+            throw Exception("FAILED galliumCodeCache: disassembly: "+disOss.str());
+    }
+    // whole code is single item in cache (disassembled once)
+    if (codeCache.getHitsNum() != 1 || codeCache.getMissesNum() != 1)
+        throw Exception("FAILED galliumCodeCache: wrong hits or misses");
+    
+    // other relocation - text is not from cache
+    input.scratchRelocs[0].offset = 20;
+    std::ostringstream relocOss;
+    {
+        Disassembler disasm(&input, relocOss, DISASM_DUMPCODE);
+        disasm.disassemble();
+    }
+    std::ostringstream disOss;
+    Disassembler disasm(&input, disOss, DISASM_DUMPCODE);
+    disasm.setCodeCache(&codeCache);
+    disasm.disassemble();
+    if (disOss.str() != relocOss.str() || codeCache.getHitsNum() != 1)
+        throw Exception("FAILED galliumCodeCache: other relocation: "+disOss.str());
+}
+
+// disassemble input with and without cache, returns text with cache
+template<typename DisasmInput>
+static std::string disassembleInputWithCache(const char* testName,
+            const DisasmInput* input, Flags flags, DisasmCodeCache& codeCache,
+            cxuint threadsNum = 1)
+{
+    std::ostringstream expectedOss;
+    {
+        Disassembler disasm(input, expectedOss, flags);
+        disasm.disassemble();
+    }
+    std::ostringstream disOss;
+    Disassembler disasm(input, disOss, flags);
+    disasm.setCodeCache(&codeCache);
+    disasm.setThreadsNum(threadsNum);
+    disasm.disassemble();
+    if (disOss.str() != expectedOss.str())
+        throw Exception(std::string("FAILED ")+testName+": disassembly: "+disOss.str());
+    return disOss.str();
+}
+
+static void testAmdCodeCache()
+{
+    Array<uint32_t> code(sizeof(rawCodeWords)>>2);
+    for (size_t i = 0; i < code.size(); i++)
+        code[i] = LEV(rawCodeWords[i]);
+    AmdDisasmInput input;
+    input.deviceType = GPUDeviceType::PITCAIRN;
+    input.is64BitMode = false;
+    input.globalDataSize = 0;
+    input.globalData = nullptr;
+    input.kernels.resize(2);
+    for (cxuint k = 0; k < 2; k++)
+    {
+        AmdDisasmKernelInput& kinput = input.kernels[k];
+        kinput.kernelName = (k==0) ? "kernelA" : "kernelB";
+        kinput.metadataSize = 0;
+        kinput.metadata = nullptr;
+        kinput.headerSize = 0;
+        kinput.header = nullptr;
+        kinput.dataSize = 0;
+        kinput.data = nullptr;
+        kinput.codeSize = code.size()<<2;
+        kinput.code = reinterpret_cast<const cxbyte*>(code.data());
+    }
+    DisasmCodeCache codeCache;
+    const std::string result = disassembleInputWithCache("amdCodeCache", &input,
+                DISASM_DUMPCODE, codeCache);
+    // same code in second kernel (other section) - from cache with other labels
+    if (codeCache.getHitsNum() != 1 || codeCache.getMissesNum() != 1)
+        throw Exception("FAILED amdCodeCache: wrong hits or misses");
+    if (result.find(".L24_0:") == std::string::npos ||
+        result.find(".L24_1:") == std::string::npos ||
+        result.find("s_branch        .L24_1") == std::string::npos)
+        throw Exception("FAILED amdCodeCache: wrong labels: "+result);
+    // next binary - all kernels from cache
+    disassembleInputWithCache("amdCodeCache", &input, DISASM_DUMPCODE, codeCache);
+    if (codeCache.getHitsNum() != 3 || codeCache.getMissesNum() != 1)
+        throw Exception("FAILED amdCodeCache: wrong hits or misses (second binary)");
+}
+
+static void testAmdCL2CodeCache()
+{
+    Array<uint32_t> code(sizeof(rawCodeWords)>>2);
+    for (size_t i = 0; i < code.size(); i++)
+        code[i] = LEV(rawCodeWords[i]);
+    AmdCL2DisasmInput input;
+    input.deviceType = GPUDeviceType::BONAIRE;
+    input.archMinor = 0;
+    input.archStepping = 0;
+    input.is64BitMode = true;
+    input.driverVersion = 180005;
+    input.globalDataSize = 0;
+    input.globalData = nullptr;
+    input.rwDataSize = 0;
+    input.rwData = nullptr;
+    input.bssAlignment = 0;
+    input.bssSize = 0;
+    input.samplerInitSize = 0;
+    input.samplerInit = nullptr;
+    input.codeSize = 0;
+    input.code = nullptr;
+    input.kernels.resize(3);
+    for (cxuint k = 0; k < 3; k++)
+    {
+        AmdCL2DisasmKernelInput& kinput = input.kernels[k];
+        kinput.kernelName = (k==0) ? "kernelA" : ((k==1) ? "kernelB" : "kernelC");
+        kinput.metadataSize = 0;
+        kinput.metadata = nullptr;
+        kinput.isaMetadataSize = 0;
+        kinput.isaMetadata = nullptr;
+        kinput.setupSize = 0;
+        kinput.setup = nullptr;
+        kinput.stubSize = 0;
+        kinput.stub = nullptr;
+        kinput.codeSize = code.size()<<2;
+        kinput.code = reinterpret_cast<const cxbyte*>(code.data());
+    }
+    // relocation in last kernel - other text
+    input.kernels[2].textRelocs.push_back({ 28, RELTYPE_LOW_32BIT, 0, 4 });
+    
+    DisasmCodeCache codeCache;
+    const std::string result = disassembleInputWithCache("amdCL2CodeCache", &input,
+                DISASM_DUMPCODE, codeCache);
+    if (codeCache.getHitsNum() != 1 || codeCache.getMissesNum() != 2)
+        throw Exception("FAILED amdCL2CodeCache: wrong hits or misses");
+    if (result.find(".L24_1:") == std::string::npos ||
+        result.find(".L24_2:") == std::string::npos)
+        throw Exception("FAILED amdCL2CodeCache: wrong labels: "+result);
+}
+
+static void testROCmCodeCache()
+{
+    // two kernels (kernel config and code)
+    const size_t kernelCodeSize = sizeof(rawCodeWords);
+    Array<cxbyte> code(2*(256 + kernelCodeSize));
+    std::fill(code.begin(), code.end(), cxbyte(0));
+    for (cxuint k = 0; k < 2; k++)
+        for (size_t i = 0; i < kernelCodeSize>>2; i++)
+            SULEV(*reinterpret_cast<uint32_t*>(code.data() +
+                    k*(256+kernelCodeSize) + 256 + (i<<2)), rawCodeWords[i]);
+    ROCmDisasmInput input;
+    input.deviceType = GPUDeviceType::FIJI;
+    input.archMinor = 0;
+    input.archStepping = 3;
+    input.eflags = 0;
+    input.newBinFormat = false;
+    input.llvm10BinFormat = false;
+    input.metadataV3 = false;
+    input.regions.push_back({ "kernelA", 256+kernelCodeSize, 0, ROCmRegionType::KERNEL });
+    input.regions.push_back({ "kernelB", 256+kernelCodeSize, 256+kernelCodeSize,
+                ROCmRegionType::KERNEL });
+    input.codeSize = code.size();
+    input.code = code.data();
+    input.globalDataSize = 0;
+    input.globalData = nullptr;
+    input.metadataSize = 0;
+    input.metadata = nullptr;
+    
+    DisasmCodeCache codeCache;
+    for (cxuint k = 0; k < 2; k++)
+        disassembleInputWithCache("rocmCodeCache", &input, DISASM_DUMPCODE, codeCache);
+    // whole code section is single item in cache
+    if (codeCache.getHitsNum() != 1 || codeCache.getMissesNum() != 1)
+        throw Exception("FAILED rocmCodeCache: wrong hits or misses");
+    // disassembled by many threads
+    DisasmCodeCache threadsCodeCache;
+    for (cxuint k = 0; k < 2; k++)
+        disassembleInputWithCache("rocmCodeCache", &input, DISASM_DUMPCODE,
+                    threadsCodeCache, 2);
+    if (threadsCodeCache.getHitsNum() != 1 || threadsCodeCache.getMissesNum() != 1)
+        throw Exception("FAILED rocmCodeCache: wrong hits or misses (threads)");
+    // other region - other text
+    input.regions[1].regionName = "kernelC";
+    disassembleInputWithCache("rocmCodeCache", &input, DISASM_DUMPCODE, codeCache);
+    if (codeCache.getHitsNum() != 1 || codeCache.getMissesNum() != 2)
+        throw Exception("FAILED rocmCodeCache: other region");
+}
+
+int main(int argc, const char** argv)
+{
+    int retVal = 0;
+    try
+    { testRawCodeCache(); }
+    catch(const std::exception& ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        retVal = 1;
+    }
+    try
+    { testGalliumCodeCache(); }
+    catch(const std::exception& ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        retVal = 1;
+    }
+    try
+    { testAmdCodeCache(); }
+    catch(const std::exception& ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        retVal = 1;
+    }
+    try
+    { testAmdCL2CodeCache(); }
+    catch(const std::exception& ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        retVal = 1;
+    }
+    try
+    { testROCmCodeCache(); }
+    catch(const std::exception& ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        retVal = 1;
+    }
+    return retVal;
+}
@@ -0,0 +1,117 @@
+/*
+ *  CLRadeonExtender - Unofficial OpenCL Radeon Extensions Library
+ *  Copyright (C) 2014-2018 Mateusz Szpakowski
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <CLRX/Config.h>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <CLRX/utils/Utilities.h>
+#include "../../amdasm/DisasmDataDump.h"
+#include "../TestUtils.h"
+
+using namespace CLRX;
+
+// generate data with random runs of repeated values
+template<typename T>
+static void generateRunData(std::mt19937& rng, size_t size, std::vector<T>& data)
+{
+    data.resize(size);
+    std::uniform_int_distribution<uint32_t> valueDist(0, 0xffffffffU);
+    std::uniform_int_distribution<cxuint> runDist(1, 40);
+    std::uniform_int_distribution<cxuint> kindDist(0, 3);
+    for (size_t i = 0; i < size; )
+    {
+        // zeros, small values or random values
+        const cxuint kind = kindDist(rng);
+        const T value = (kind == 0) ? T(0) : ((kind == 1) ? T(valueDist(rng) & 3) :
+                T(valueDist(rng)));
+        // single element or run
+        const size_t runSize = (kind == 3) ? 1 : runDist(rng);
+        for (size_t j = 0; j < runSize && i < size; j++, i++)
+            data[i] = value;
+    }
+}
+
+static void testDataDump(std::mt19937& rng, size_t size, bool secondAlign)
+{
+    std::ostringstream nameOss;
+    nameOss << "size=" << size << ",secondAlign=" << secondAlign;
+    const std::string testName = nameOss.str();
+
+    std::vector<cxbyte> bytes;
+    generateRunData(rng, size, bytes);
+    std::ostringstream vecOss, scalarOss;
+    printDisasmDataT<true>(bytes.size(), bytes.data(), vecOss, secondAlign);
+    printDisasmDataT<false>(bytes.size(), bytes.data(), scalarOss, secondAlign);
+    assertString("DisasmDataDump", testName+".bytes", scalarOss.str().c_str(),
+                 vecOss.str());
+
+    std::vector<uint32_t> dwords;
+    generateRunData(rng, size, dwords);
+    vecOss.str("");
+    scalarOss.str("");
+    printDisasmDataU32T<true>(dwords.size(), dwords.data(), vecOss, secondAlign);
+    printDisasmDataU32T<false>(dwords.size(), dwords.data(), scalarOss, secondAlign);
+    assertString("DisasmDataDump", testName+".dwords", scalarOss.str().c_str(),
+                 vecOss.str());
+}
+
+static void testDataDumpFormat()
+{
+    // check scalar output (reference for vectorized output)
+    static const cxbyte bytes[21] = { 0x12, 0xab, 0x00, 0xff, 0x7f, 0x80, 0x3c, 0xc3,
+        5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 0xde, 0xad, 0x01 };
+    std::ostringstream oss;
+    printDisasmDataT<false>(21, bytes, oss, false);
+    assertString("DisasmDataDump", "format.bytes",
+        "    .byte 0x12, 0xab, 0x00, 0xff, 0x7f, 0x80, 0x3c, 0xc3\n"
+        "    .fill 8, 1, 0x05\n"
+        "    .byte 0x05, 0x05, 0xde, 0xad, 0x01\n", oss.str());
+    static const uint32_t dwords[7] = { 0x12345678U, 0, 0, 0, 0, 0, 0xdeadbeefU };
+    oss.str("");
+    printDisasmDataU32T<false>(7, dwords, oss, true);
+    assertString("DisasmDataDump", "format.dwords",
+        "        .int 0x12345678, 0x00000000, 0x00000000, 0x00000000\n"
+        "        .int 0x00000000, 0x00000000, 0xdeadbeef\n", oss.str());
+}
+
+int main(int argc, const char** argv)
+{
+    int retVal = 0;
+    try
+    {
+        testDataDumpFormat();
+        std::mt19937 rng(42);
+        // small sizes (tails) and sizes greater than dump buffer
+        for (size_t size = 0; size < 70; size++)
+            for (bool secondAlign: { false, true })
+                testDataDump(rng, size, secondAlign);
+        for (size_t size: { size_t(4095), size_t(16384), size_t(100003) })
+            for (bool secondAlign: { false, true })
+                testDataDump(rng, size, secondAlign);
+    }
+    catch(const std::exception& ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        retVal = 1;
+    }
+    return retVal;
+}
@@ -0,0 +1,178 @@
+/*
+ *  CLRadeonExtender - Unofficial OpenCL Radeon Extensions Library
+ *  Copyright (C) 2014-2018 Mateusz Szpakowski
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <CLRX/Config.h>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <CLRX/utils/Utilities.h>
+#include <CLRX/utils/Containers.h>
+#include <CLRX/utils/MemAccess.h>
+#include <CLRX/amdasm/Disassembler.h>
+
+using namespace CLRX;
+
+static Array<uint32_t> getCodeWords(const uint32_t* words, size_t wordsNum)
+{
+    Array<uint32_t> code(wordsNum);
+    for (size_t i = 0; i < wordsNum; i++)
+        code[i] = LEV(words[i]);
+    return code;
+}
+
+static const uint32_t rawCodeWordsA[] =
+{
+    0xbf820002U, 0x7e000280U, 0x7e020280U, 0xbf810000U
+};
+
+// inserted instruction and jump over it
+static const uint32_t rawCodeWordsB[] =
+{
+    0xbf820003U, 0x7e000280U, 0x7e040280U, 0x7e020280U, 0xbf810000U
+};
+
+static void testRawCodeDiff()
+{
+    Array<uint32_t> codeA = getCodeWords(rawCodeWordsA, sizeof(rawCodeWordsA)>>2);
+    Array<uint32_t> codeB = getCodeWords(rawCodeWordsB, sizeof(rawCodeWordsB)>>2);
+    std::ostringstream disOss;
+    Disassembler disasmA(GPUDeviceType::PITCAIRN, codeA.size()<<2,
+                reinterpret_cast<const cxbyte*>(codeA.data()), disOss);
+    Disassembler disasmB(GPUDeviceType::PITCAIRN, codeB.size()<<2,
+                reinterpret_cast<const cxbyte*>(codeB.data()), disOss);
+    std::ostringstream diffOss;
+    size_t diffsNum = diffDisassemblers(disasmA, disasmB, diffOss);
+    if (diffsNum != 1 || diffOss.str() !=
+        "/* code */\n"
+        "@@ -0x8,0 +0x8,1 @@\n"
+        "+        v_mov_b32       v2, 0\n")
+        throw Exception("FAILED rawCodeDiff: "+diffOss.str());
+    // same code
+    diffOss.str("");
+    diffsNum = diffDisassemblers(disasmA, disasmA, diffOss);
+    if (diffsNum != 0 || !diffOss.str().empty())
+        throw Exception("FAILED rawCodeDiff: same code: "+diffOss.str());
+    // jump target changed
+    codeB[0] = LEV(0xbf820001U);
+    diffOss.str("");
+    diffsNum = diffDisassemblers(disasmA, disasmB, diffOss);
+    if (diffsNum != 2 || diffOss.str() !=
+        "/* code */\n"
+        "@@ -0x0,1 +0x0,1 @@\n"
+        "-        s_branch        .L12_0\n"
+        "+        s_branch        .L8_0\n"
+        "@@ -0x8,0 +0x8,1 @@\n"
+        "+.L8_0:\n"
+        "+        v_mov_b32       v2, 0\n")
+        throw Exception("FAILED rawCodeDiff: jump changed: "+diffOss.str());
+}
+
+static const uint32_t galliumCodeWordsA[] =
+{
+    0xbf820001U, 0x7e000280U, 0xbf810000U, 0x7e020280U, 0xbf810000U
+};
+
+static const uint32_t galliumCodeWordsB[] =
+{
+    0xbf820002U, 0x7e000280U, 0x7e000281U, 0xbf810000U, 0x7e020280U, 0xbf810000U
+};
+
+static void setGalliumDiffInput(GalliumDisasmInput& input, const Array<uint32_t>& code)
+{
+    input.deviceType = GPUDeviceType::PITCAIRN;
+    input.is64BitMode = false;
+    input.isLLVM390 = false;
+    input.isMesa170 = false;
+    input.isAMDHSA = false;
+    input.globalDataSize = 0;
+    input.globalData = nullptr;
+    input.code = reinterpret_cast<const cxbyte*>(code.data());
+    input.codeSize = code.size()<<2;
+}
+
+static void setGalliumDiffKernel(GalliumDisasmKernelInput& kernel, const char* name,
+            uint32_t offset, uint32_t pgmRsrc1)
+{
+    kernel.kernelName = name;
+    kernel.offset = offset;
+    kernel.progInfo[0] = { 0xb848U, pgmRsrc1 };
+    kernel.progInfo[1] = { 0xb84cU, 0x90U };
+    kernel.progInfo[2] = { 0xb860U, 0 };
+    kernel.progInfo[3] = { 0x4U, 0 };
+    kernel.progInfo[4] = { 0x8U, 0 };
+}
+
+static void testGalliumDiff()
+{
+    Array<uint32_t> codeA = getCodeWords(galliumCodeWordsA,
+                sizeof(galliumCodeWordsA)>>2);
+    Array<uint32_t> codeB = getCodeWords(galliumCodeWordsB,
+                sizeof(galliumCodeWordsB)>>2);
+    GalliumDisasmInput inputA, inputB;
+    setGalliumDiffInput(inputA, codeA);
+    inputA.kernels.resize(2);
+    setGalliumDiffKernel(inputA.kernels[0], "kernelA", 0, 0x002c0041U);
+    setGalliumDiffKernel(inputA.kernels[1], "kernelB", 12, 0x002c0041U);
+    setGalliumDiffInput(inputB, codeB);
+    inputB.kernels.resize(2);
+    // more VGPRs in kernelA, kernelB is replaced by kernelC
+    setGalliumDiffKernel(inputB.kernels[0], "kernelA", 0, 0x002c0042U);
+    setGalliumDiffKernel(inputB.kernels[1], "kernelC", 16, 0x002c0041U);
+
+    std::ostringstream disOss;
+    Disassembler disasmA(&inputA, disOss, DISASM_CODEPOS);
+    Disassembler disasmB(&inputB, disOss, DISASM_CODEPOS);
+    std::ostringstream diffOss;
+    size_t diffsNum = diffDisassemblers(disasmA, disasmB, diffOss);
+    if (diffsNum != 5 || diffOss.str() !=
+        "/* kernel: kernelA */\n"
+        "@@ config @@\n"
+        "-        .vgprsnum 8\n"
+        "+        .vgprsnum 12\n"
+        "@@ config @@\n"
+        "-        .pgmrsrc1 0x002c0041\n"
+        "+        .pgmrsrc1 0x002c0042\n"
+        "@@ -0x8,0 +0x8,1 @@\n"
+        "+/*000000000008*/ v_mov_b32       v0, 1\n"
+        "/* kernel: kernelB */\n"
+        "/* only in first binary */\n"
+        "/* kernel: kernelC */\n"
+        "/* only in second binary */\n")
+        throw Exception("FAILED galliumDiff: "+diffOss.str());
+}
+
+int main(int argc, const char** argv)
+{
+    int retVal = 0;
+    try
+    { testRawCodeDiff(); }
+    catch(const std::exception& ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        retVal = 1;
+    }
+    try
+    { testGalliumDiff(); }
+    catch(const std::exception& ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        retVal = 1;
+    }
+    return retVal;
+}
@@ -0,0 +1,260 @@
+/*
+ *  CLRadeonExtender - Unofficial OpenCL Radeon Extensions Library
+ *  Copyright (C) 2014-2018 Mateusz Szpakowski
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <CLRX/Config.h>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <CLRX/utils/Utilities.h>
+#include <CLRX/utils/Containers.h>
+#include <CLRX/utils/MemAccess.h>
+#include <CLRX/amdasm/Disassembler.h>
+
+using namespace CLRX;
+
+static const uint32_t rawCodeWords[] =
+{
+    0xd8dc2625U, 0x37000006U, 0xbf82fffeU, 0xbf820002U,
+    0xea88f7d4U, 0x23f43d12U, 0xd25a0037U, 0x4002b41bU,
+    0, 0, 0, 0xbf810000U
+};
+
+static const char* rawCodeText =
+    "        ds_read2_b32    v[55:56], v6 offset0:37 offset1:38\n"
+    ".L4_0=.-4\n        s_branch        .L4_0\n"
+    "        s_branch        .L24_0\n"
+    "        tbuffer_load_format_x v[61:62], v[18:19], s[80:83], s35"
+    " offen idxen offset:2004 glc slc addr64 tfe format:[sint]\n"
+    ".L24_0:\n        v_cvt_pknorm_i16_f32 v55, s27, -v90\n"
+    ".fill 3, 4, 0\n"
+    "        s_endpgm\n";
+
+static const size_t rawInstrOffsets[] = { 0, 8, 12, 16, 24, 32, 44 };
+
+static std::string disassembleWindow(Disassembler& disasm, std::ostringstream& oss,
+            const DisasmIndex& index, size_t region, size_t offset,
+            size_t before, size_t after)
+{
+    oss.str("");
+    disasm.disassembleWindow(index, region, offset, before, after);
+    return oss.str();
+}
+
+static void testRawCodeIndex()
+{
+    Array<uint32_t> code(sizeof(rawCodeWords)>>2);
+    for (size_t i = 0; i < code.size(); i++)
+        code[i] = LEV(rawCodeWords[i]);
+    std::ostringstream disOss;
+    Disassembler disasm(GPUDeviceType::PITCAIRN, code.size()<<2,
+                reinterpret_cast<const cxbyte*>(code.data()), disOss);
+    DisasmIndex index;
+    disasm.buildIndex(index);
+
+    if (index.getSectionsNum() != 1 || index.getRegionsNum() != 1)
+        throw Exception("FAILED rawCodeIndex: wrong sections or regions number");
+    const DisasmIndexSection& section = index.getSection(0);
+    if (section.labels.size() != 2 || section.labels[0] != 4 || section.labels[1] != 24)
+        throw Exception("FAILED rawCodeIndex: wrong labels");
+    const size_t instrsNum = sizeof(rawInstrOffsets)/sizeof(size_t);
+    if (index.getInstrsNum(0) != instrsNum)
+        throw Exception("FAILED rawCodeIndex: wrong instructions number");
+    for (size_t i = 0; i < instrsNum; i++)
+    {
+        if (index.getInstrOffset(0, i) != rawInstrOffsets[i])
+            throw Exception("FAILED rawCodeIndex: wrong instruction offset");
+        if (index.getInstrIndex(0, rawInstrOffsets[i]) != i)
+            throw Exception("FAILED rawCodeIndex: wrong instruction index");
+        if (!index.isInstrStart(0, rawInstrOffsets[i]) ||
+            index.isInstrStart(0, rawInstrOffsets[i]+4) !=
+                (i+1 < instrsNum && rawInstrOffsets[i+1] == rawInstrOffsets[i]+4))
+            throw Exception("FAILED rawCodeIndex: wrong instruction start");
+    }
+
+    // whole code
+    std::string result = disassembleWindow(disasm, disOss, index, 0, 20, 100, 100);
+    if (result != rawCodeText)
+        throw Exception("FAILED rawCodeIndex: whole window: "+result);
+    // window around offset in middle of instruction
+    result = disassembleWindow(disasm, disOss, index, 0, 20, 1, 0);
+    if (result !=
+        "        s_branch        .L24_0\n"
+        "        tbuffer_load_format_x v[61:62], v[18:19], s[80:83], s35"
+        " offen idxen offset:2004 glc slc addr64 tfe format:[sint]\n"
+        ".L24_0:\n")
+        throw Exception("FAILED rawCodeIndex: window at 20: "+result);
+    // every window must be part of whole disassembly
+    for (size_t i = 0; i < code.size()<<2; i++)
+        for (size_t before = 0; before < 3; before++)
+            for (size_t after = 0; after < 3; after++)
+            {
+                result = disassembleWindow(disasm, disOss, index, 0, i, before, after);
+                if (std::string(rawCodeText).find(result) == std::string::npos)
+                    throw Exception("FAILED rawCodeIndex: window: "+result);
+            }
+
+    // serialization
+    std::ostringstream indexOss;
+    index.write(indexOss);
+    std::istringstream indexIss(indexOss.str());
+    DisasmIndex index2;
+    index2.read(indexIss);
+    std::ostringstream indexOss2;
+    index2.write(indexOss2);
+    if (indexOss.str() != indexOss2.str())
+        throw Exception("FAILED rawCodeIndex: serialized index mismatch");
+    result = disassembleWindow(disasm, disOss, index2, 0, 32, 2, 1);
+    if (result !=
+        "        tbuffer_load_format_x v[61:62], v[18:19], s[80:83], s35"
+        " offen idxen offset:2004 glc slc addr64 tfe format:[sint]\n"
+        ".L24_0:\n        v_cvt_pknorm_i16_f32 v55, s27, -v90\n"
+        ".fill 3, 4, 0\n"
+        "        s_endpgm\n")
+        throw Exception("FAILED rawCodeIndex: window from read index: "+result);
+
+    // truncated index
+    std::istringstream truncIss(indexOss.str().substr(0, indexOss.str().size()-2));
+    bool failed = false;
+    try
+    { index2.read(truncIss); }
+    catch(const DisasmException& ex)
+    { failed = true; }
+    if (!failed)
+        throw Exception("FAILED rawCodeIndex: truncated index is not detected");
+}
+
+static const uint32_t galliumCodeWords[] =
+{
+    0xbe8003ffU, 0x00000000U, 0xbf820001U, 0x7e000280U,
+    0xbf810000U, 0xbe8103ffU, 0x00000000U, 0xbf810000U
+};
+
+static void testGalliumCodeIndex()
+{
+    Array<uint32_t> code(sizeof(galliumCodeWords)>>2);
+    for (size_t i = 0; i < code.size(); i++)
+        code[i] = LEV(galliumCodeWords[i]);
+    GalliumDisasmInput input;
+    input.deviceType = GPUDeviceType::PITCAIRN;
+    input.is64BitMode = false;
+    input.isLLVM390 = false;
+    input.isMesa170 = false;
+    input.isAMDHSA = false;
+    input.globalDataSize = 0;
+    input.globalData = nullptr;
+    input.code = reinterpret_cast<const cxbyte*>(code.data());
+    input.codeSize = code.size()<<2;
+    input.kernels.resize(2);
+    input.kernels[0].kernelName = "kernelA";
+    input.kernels[0].offset = 0;
+    input.kernels[1].kernelName = "kernelB";
+    input.kernels[1].offset = 20;
+    input.scratchRelocs.push_back({ 4, RELTYPE_LOW_32BIT });
+    input.scratchRelocs.push_back({ 24, RELTYPE_HIGH_32BIT });
+
+    std::ostringstream disOss;
+    Disassembler disasm(&input, disOss);
+    DisasmIndex index;
+    disasm.buildIndex(index);
+
+    if (index.getRegionsNum() != 2)
+        throw Exception("FAILED galliumCodeIndex: wrong regions number");
+    const size_t regionB = index.findRegion("kernelB");
+    if (regionB != 1 || index.getRegion(regionB).offset != 20 ||
+        index.getRegion(regionB).size != 12 || index.findRegion("kernelC") != SIZE_MAX ||
+        index.findRegion(0, 24) != regionB)
+        throw Exception("FAILED galliumCodeIndex: wrong region");
+
+    std::string result = disassembleWindow(disasm, disOss, index, regionB, 0, 0, 5);
+    if (result != "kernelB:\n"
+        "        s_mov_b32       s1, .scratchaddr>>32\n"
+        "        s_endpgm\n")
+        throw Exception("FAILED galliumCodeIndex: kernelB: "+result);
+    result = disassembleWindow(disasm, disOss, index, 0, 8, 1, 1);
+    if (result != "kernelA:\n"
+        "        s_mov_b32       s0, .scratchaddr&0xffffffff\n"
+        "        s_branch        .L16_0\n"
+        "        v_mov_b32       v0, 0\n"
+        ".L16_0:\n")
+        throw Exception("FAILED galliumCodeIndex: kernelA: "+result);
+}
+
+static const uint32_t galliumJumpCodeWords[] =
+{
+    0xbf820002U, 0xbf810000U, 0x7e000280U, 0xbf810000U
+};
+
+// named label of other kernel used by jump in window
+static void testGalliumJumpToKernel()
+{
+    Array<uint32_t> code(sizeof(galliumJumpCodeWords)>>2);
+    for (size_t i = 0; i < code.size(); i++)
+        code[i] = LEV(galliumJumpCodeWords[i]);
+    GalliumDisasmInput input;
+    input.deviceType = GPUDeviceType::PITCAIRN;
+    input.is64BitMode = false;
+    input.isLLVM390 = false;
+    input.isMesa170 = false;
+    input.isAMDHSA = false;
+    input.globalDataSize = 0;
+    input.globalData = nullptr;
+    input.code = reinterpret_cast<const cxbyte*>(code.data());
+    input.codeSize = code.size()<<2;
+    input.kernels.resize(2);
+    input.kernels[0].kernelName = "kernelA";
+    input.kernels[0].offset = 0;
+    input.kernels[1].kernelName = "kernelB";
+    input.kernels[1].offset = 12;
+
+    std::ostringstream disOss;
+    Disassembler disasm(&input, disOss);
+    DisasmIndex index;
+    disasm.buildIndex(index);
+    std::string result = disassembleWindow(disasm, disOss, index, 0, 0, 0, 0);
+    if (result != "kernelA:\n"
+        "        s_branch        kernelB\n")
+        throw Exception("FAILED galliumJumpToKernel: "+result);
+}
+
+int main(int argc, const char** argv)
+{
+    int retVal = 0;
+    try
+    { testRawCodeIndex(); }
+    catch(const std::exception& ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        retVal = 1;
+    }
+    try
+    { testGalliumCodeIndex(); }
+    catch(const std::exception& ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        retVal = 1;
+    }
+    try
+    { testGalliumJumpToKernel(); }
+    catch(const std::exception& ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        retVal = 1;
+    }
+    return retVal;
+}
@@ -0,0 +1,192 @@
+/*
+ *  CLRadeonExtender - Unofficial OpenCL Radeon Extensions Library
+ *  Copyright (C) 2014-2018 Mateusz Szpakowski
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <CLRX/Config.h>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <CLRX/utils/Utilities.h>
+#include <CLRX/utils/Containers.h>
+#include <CLRX/utils/MemAccess.h>
+#include <CLRX/amdasm/Disassembler.h>
+
+using namespace CLRX;
+
+static size_t getGroupCount(const DisasmCodeStats& stats, DisasmInstrGroup group)
+{ return stats.groupCounts[cxuint(group)]; }
+
+static size_t getEncodingCount(const DisasmCodeStats& stats, const char* name)
+{
+    for (cxuint i = 0; i < DISASM_STATS_ENCODINGS_NUM; i++)
+        if (::strcmp(getDisasmStatsEncodingName(i), name) == 0)
+            return stats.encodingCounts[i];
+    throw Exception(std::string("Unknown encoding ")+name);
+}
+
+static const uint32_t rawCodeWords[] =
+{
+    0xd8dc2625U, 0x37000006U, /* ds_read2_b32 v[55:56], v6 */
+    0xbf82fffeU, 0xbf820002U, /* s_branch, s_branch */
+    /* tbuffer_load_format_x v[61:62], v[18:19], s[80:83], s35 addr64 tfe */
+    0xea88f7d4U, 0x23f43d12U,
+    0xd25a0037U, 0x4002b41bU, /* v_cvt_pknorm_i16_f32 v55, s27, -v90 */
+    0, 0, 0,
+    0xbe8003ffU, 0x00001234U, /* s_mov_b32 s0, 0x1234 */
+    0xbf8c007fU, /* s_waitcnt lgkmcnt(0) */
+    0x7e060301U, /* v_mov_b32 v3, v1 */
+    0xbf810000U /* s_endpgm */
+};
+
+static void testRawCodeStats()
+{
+    Array<uint32_t> code(sizeof(rawCodeWords)>>2);
+    for (size_t i = 0; i < code.size(); i++)
+        code[i] = LEV(rawCodeWords[i]);
+    DisasmCodeStats stats;
+    getGCNCodeStats(GPUDeviceType::PITCAIRN, code.size()<<2,
+                reinterpret_cast<const cxbyte*>(code.data()), stats);
+    
+    if (stats.codeSize != 64 || stats.instrsNum != 9 || stats.illegalsNum != 0 ||
+        stats.literalsNum != 1 || stats.waitcntsNum != 1)
+        throw Exception("FAILED rawCodeStats: wrong counts");
+    if (stats.maxSGPR != 83 || stats.maxVGPR != 90)
+        throw Exception("FAILED rawCodeStats: wrong register usage");
+    if (getGroupCount(stats, DisasmInstrGroup::SALU) != 1 ||
+        getGroupCount(stats, DisasmInstrGroup::VALU) != 2 ||
+        getGroupCount(stats, DisasmInstrGroup::SMEM) != 0 ||
+        getGroupCount(stats, DisasmInstrGroup::VMEM) != 1 ||
+        getGroupCount(stats, DisasmInstrGroup::LDS) != 1 ||
+        getGroupCount(stats, DisasmInstrGroup::EXPORT) != 0 ||
+        getGroupCount(stats, DisasmInstrGroup::CONTROL) != 4)
+        throw Exception("FAILED rawCodeStats: wrong group counts");
+    if (getEncodingCount(stats, "ds") != 1 || getEncodingCount(stats, "sopp") != 4 ||
+        getEncodingCount(stats, "mtbuf") != 1 || getEncodingCount(stats, "vop3a") != 1 ||
+        getEncodingCount(stats, "sop1") != 1 || getEncodingCount(stats, "vop1") != 1 ||
+        getEncodingCount(stats, "illegal") != 0)
+        throw Exception("FAILED rawCodeStats: wrong encoding counts");
+    
+    // statistics are accumulated
+    getGCNCodeStats(GPUDeviceType::PITCAIRN, 8,
+                reinterpret_cast<const cxbyte*>(code.data()), stats);
+    if (stats.codeSize != 72 || stats.instrsNum != 10 ||
+        getGroupCount(stats, DisasmInstrGroup::LDS) != 2)
+        throw Exception("FAILED rawCodeStats: wrong accumulated counts");
+    stats.clear();
+    if (stats.codeSize != 0 || stats.instrsNum != 0 || stats.maxSGPR != -1 ||
+        stats.maxVGPR != -1 || getEncodingCount(stats, "ds") != 0)
+        throw Exception("FAILED rawCodeStats: stats not cleared");
+}
+
+static const uint32_t vegaCodeWords[] =
+{
+    0x7e0602f9U, 0x00860625U, /* v_mov_b32_sdwa v3, s37 (SGPR in SDWA word) */
+    0xd81a0000U, 0x0000140aU, /* ds_write_b32 v10, v20 */
+    0xbf810000U /* s_endpgm */
+};
+
+static void testVegaCodeStats()
+{
+    Array<uint32_t> code(sizeof(vegaCodeWords)>>2);
+    for (size_t i = 0; i < code.size(); i++)
+        code[i] = LEV(vegaCodeWords[i]);
+    DisasmCodeStats stats;
+    getGCNCodeStats(GPUDeviceType::GFX900, code.size()<<2,
+                reinterpret_cast<const cxbyte*>(code.data()), stats);
+    if (stats.instrsNum != 3 || stats.literalsNum != 0)
+        throw Exception("FAILED vegaCodeStats: wrong counts");
+    // register usage like in disassembler: SDWA source is SGPR
+    if (stats.maxSGPR != 37 || stats.maxVGPR != 20)
+        throw Exception("FAILED vegaCodeStats: wrong register usage");
+}
+
+static const uint32_t galliumCodeWords[] =
+{
+    0xbe8003ffU, 0x00000000U, 0xbf820001U, 0x7e000280U,
+    0xbf810000U, 0xbe8103ffU, 0x00000000U, 0xbf810000U
+};
+
+static void testGalliumCodeStats()
+{
+    Array<uint32_t> code(sizeof(galliumCodeWords)>>2);
+    for (size_t i = 0; i < code.size(); i++)
+        code[i] = LEV(galliumCodeWords[i]);
+    GalliumDisasmInput input;
+    input.deviceType = GPUDeviceType::PITCAIRN;
+    input.is64BitMode = false;
+    input.isLLVM390 = false;
+    input.isMesa170 = false;
+    input.isAMDHSA = false;
+    input.globalDataSize = 0;
+    input.globalData = nullptr;
+    input.code = reinterpret_cast<const cxbyte*>(code.data());
+    input.codeSize = code.size()<<2;
+    input.kernels.resize(2);
+    input.kernels[0].kernelName = "kernelA";
+    input.kernels[0].offset = 0;
+    input.kernels[1].kernelName = "kernelB";
+    input.kernels[1].offset = 20;
+    
+    std::ostringstream disOss;
+    Disassembler disasm(&input, disOss);
+    std::vector<DisasmCodeStats> statsList;
+    disasm.getCodeStats(statsList);
+    if (!disOss.str().empty())
+        throw Exception("FAILED galliumCodeStats: disassembler output is not empty");
+    if (statsList.size() != 2)
+        throw Exception("FAILED galliumCodeStats: wrong kernels number");
+    const DisasmCodeStats& statsA = statsList[0];
+    if (statsA.name != "kernelA" || statsA.codeSize != 20 || statsA.instrsNum != 4 ||
+        statsA.literalsNum != 1 || statsA.maxSGPR != 0 || statsA.maxVGPR != 0 ||
+        getGroupCount(statsA, DisasmInstrGroup::CONTROL) != 2)
+        throw Exception("FAILED galliumCodeStats: wrong kernelA stats");
+    const DisasmCodeStats& statsB = statsList[1];
+    if (statsB.name != "kernelB" || statsB.codeSize != 12 || statsB.instrsNum != 2 ||
+        statsB.literalsNum != 1 || statsB.maxSGPR != 1 || statsB.maxVGPR != -1 ||
+        getGroupCount(statsB, DisasmInstrGroup::VALU) != 0)
+        throw Exception("FAILED galliumCodeStats: wrong kernelB stats");
+}
+
+int main(int argc, const char** argv)
+{
+    int retVal = 0;
+    try
+    { testRawCodeStats(); }
+    catch(const std::exception& ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        retVal = 1;
+    }
+    try
+    { testVegaCodeStats(); }
+    catch(const std::exception& ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        retVal = 1;
+    }
+    try
+    { testGalliumCodeStats(); }
+    catch(const std::exception& ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        retVal = 1;
+    }
+    return retVal;
+}
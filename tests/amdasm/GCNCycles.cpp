@@ -0,0 +1,237 @@
+/*
+ *  CLRadeonExtender - Unofficial OpenCL Radeon Extensions Library
+ *  Copyright (C) 2014-2018 Mateusz Szpakowski
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <CLRX/Config.h>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <CLRX/utils/Utilities.h>
+#include <CLRX/amdasm/Assembler.h>
+#include <CLRX/utils/Containers.h>
+#include "../TestUtils.h"
+
+using namespace CLRX;
+
+struct GCNCyclesTestCase
+{
+    const char* input;
+    GPUDeviceType deviceType;
+    Array<AsmCodeBlockTiming> blockTimings;
+    Array<AsmStallPoint> stallPoints;
+    Array<size_t> criticalPath;
+    uint64_t criticalPathCycles;
+};
+
+static const GCNCyclesTestCase gcnCyclesTestCases[] =
+{
+    {   /* 0 - waits and conditional jump */
+        R"ffDXD(
+            s_load_dword s2, s[10:11], 4
+            buffer_load_dword v4, v1, s[12:15], 0 offen
+            s_waitcnt vmcnt(0) & lgkmcnt(0)
+            v_add_f32 v5, v4, v4
+            s_cbranch_scc1 aa0
+            v_mul_f64 v[6:7], v[6:7], v[6:7]
+            v_rcp_f32 v8, v5
+aa0:        ds_read_b32 v9, v1
+            s_waitcnt lgkmcnt(0)
+            v_mov_b32 v10, v9
+            s_endpgm
+)ffDXD",
+        GPUDeviceType::PITCAIRN,
+        {
+            { 0, 24, 5, 24, 400, 424, SIZE_MAX },
+            { 24, 36, 2, 80, 0, 504, 0 },
+            { 36, 56, 4, 16, 64, 584, 1 }
+        },
+        { { 12, 400, 0 }, { 44, 64, 1 } },
+        { 0, 1, 2 }, 584
+    },
+    {   /* 1 - double precision factor */
+        R"ffDXD(
+            v_mul_f64 v[0:1], v[0:1], v[0:1]
+            v_fma_f64 v[0:1], v[0:1], v[0:1], v[0:1]
+            v_add_f64 v[0:1], v[0:1], v[0:1]
+            s_endpgm
+)ffDXD",
+        GPUDeviceType::TAHITI,
+        { { 0, 28, 4, 44, 0, 44, SIZE_MAX } },
+        { },
+        { 0 }, 44
+    },
+    {   /* 2 - ordered queue */
+        R"ffDXD(
+            buffer_load_dword v4, v1, s[12:15], 0 offen
+            buffer_load_dword v5, v1, s[12:15], 0 offen offset:4
+            s_waitcnt vmcnt(1)
+            s_waitcnt vmcnt(0)
+            s_endpgm
+)ffDXD",
+        GPUDeviceType::CAPE_VERDE,
+        { { 0, 28, 5, 28, 396, 424, SIZE_MAX } },
+        { { 16, 392, 0 }, { 20, 4, 0 } },
+        { 0 }, 424
+    },
+    {   /* 3 - loop (backward jump is ignored) */
+        R"ffDXD(
+            s_mov_b32 s5, 0
+loop:       s_add_u32 s5, s5, 1
+            s_cmp_lt_u32 s5, 10
+            s_cbranch_scc1 loop
+            s_endpgm
+)ffDXD",
+        GPUDeviceType::CAPE_VERDE,
+        {
+            { 0, 4, 1, 4, 0, 4, SIZE_MAX },
+            { 4, 16, 3, 12, 0, 16, 0 },
+            { 16, 20, 1, 4, 0, 20, 1 }
+        },
+        { },
+        { 0, 1, 2 }, 20
+    },
+    {   /* 4 - pending operations from previous blocks */
+        R"ffDXD(
+            buffer_load_dword v4, v1, s[12:15], 0 offen
+            s_cbranch_scc1 aa0
+            v_mov_b32 v2, v3
+aa0:        s_waitcnt vmcnt(0)
+            s_endpgm
+)ffDXD",
+        GPUDeviceType::CAPE_VERDE,
+        {
+            { 0, 12, 2, 12, 0, 12, SIZE_MAX },
+            { 12, 16, 1, 4, 0, 16, 0 },
+            { 16, 24, 2, 8, 396, 432, 0 }
+        },
+        { { 16, 396, 0 } },
+        { 0, 2 }, 432
+    },
+    {   /* 5 - no fall-through after return */
+        R"ffDXD(
+            buffer_load_dword v4, v1, s[12:15], 0 offen
+            s_cbranch_scc1 aa0
+            v_mul_f64 v[6:7], v[6:7], v[6:7]
+            .cf_ret
+            s_setpc_b64 s[0:1]
+aa0:        s_waitcnt vmcnt(0)
+            s_endpgm
+)ffDXD",
+        GPUDeviceType::CAPE_VERDE,
+        {
+            { 0, 12, 2, 12, 0, 12, SIZE_MAX },
+            { 12, 24, 2, 68, 0, 80, 0 },
+            { 24, 32, 2, 8, 396, 432, 0 }
+        },
+        { { 24, 396, 0 } },
+        { 0, 2 }, 432
+    }
+};
+
+static void checkCycleEstimator(const std::string& testCaseName,
+            const GCNCyclesTestCase& testCase, const AsmCycleEstimator& estimator)
+{
+    const std::vector<AsmCodeBlockTiming>& resTimings = estimator.getBlockTimings();
+    assertValue("testGCNCycles", testCaseName + ".blockTimingsSize",
+                testCase.blockTimings.size(), resTimings.size());
+    for (size_t j = 0; j < resTimings.size(); j++)
+    {
+        std::ostringstream boss;
+        boss << ".block#" << j;
+        const std::string bName = testCaseName + boss.str();
+        const AsmCodeBlockTiming& expTiming = testCase.blockTimings[j];
+        const AsmCodeBlockTiming& resTiming = resTimings[j];
+        assertValue("testGCNCycles", bName + ".start", expTiming.start, resTiming.start);
+        assertValue("testGCNCycles", bName + ".end", expTiming.end, resTiming.end);
+        assertValue("testGCNCycles", bName + ".instrsNum",
+                    expTiming.instrsNum, resTiming.instrsNum);
+        assertValue("testGCNCycles", bName + ".issueCycles",
+                    expTiming.issueCycles, resTiming.issueCycles);
+        assertValue("testGCNCycles", bName + ".stallCycles",
+                    expTiming.stallCycles, resTiming.stallCycles);
+        assertValue("testGCNCycles", bName + ".pathCycles",
+                    expTiming.pathCycles, resTiming.pathCycles);
+        assertValue("testGCNCycles", bName + ".pathPrev",
+                    expTiming.pathPrev, resTiming.pathPrev);
+    }
+    const std::vector<AsmStallPoint>& resStalls = estimator.getStallPoints();
+    assertValue("testGCNCycles", testCaseName + ".stallPointsSize",
+                testCase.stallPoints.size(), resStalls.size());
+    for (size_t j = 0; j < resStalls.size(); j++)
+    {
+        std::ostringstream soss;
+        soss << ".stall#" << j;
+        const std::string sName = testCaseName + soss.str();
+        assertValue("testGCNCycles", sName + ".offset",
+                    testCase.stallPoints[j].offset, resStalls[j].offset);
+        assertValue("testGCNCycles", sName + ".cycles",
+                    testCase.stallPoints[j].cycles, resStalls[j].cycles);
+        assertValue("testGCNCycles", sName + ".queue",
+                    testCase.stallPoints[j].queue, resStalls[j].queue);
+    }
+    assertArray("testGCNCycles", testCaseName + ".criticalPath",
+                testCase.criticalPath, estimator.getCriticalPath());
+    assertValue("testGCNCycles", testCaseName + ".criticalPathCycles",
+                testCase.criticalPathCycles, estimator.getCriticalPathCycles());
+}
+
+static void testGCNCyclesCase(cxuint i, const GCNCyclesTestCase& testCase)
+{
+    std::istringstream input(testCase.input);
+    std::ostringstream errorStream;
+
+    Assembler assembler("test.s", input, (ASM_ALL&~ASM_ALTMACRO) | ASM_TESTRUN,
+                    BinaryFormat::RAWCODE, testCase.deviceType, errorStream);
+    bool good = assembler.assemble();
+    std::ostringstream oss;
+    oss << " testGCNCyclesCase#" << i;
+    const std::string testCaseName = oss.str();
+    if (!good)
+    {
+        std::cerr << errorStream.str();
+        throw Exception(testCaseName+". Can't assemble");
+    }
+    if (assembler.getSections().size()<1)
+        throw Exception(testCaseName+". No sections");
+    const AsmSection& section = assembler.getSections()[0];
+
+    // estimate with code flow from assembler
+    AsmCycleEstimator estimator(testCase.deviceType);
+    estimator.estimate(assembler, section.codeFlow, section.getSize(),
+                section.content.data());
+    checkCycleEstimator(testCaseName + ".asm", testCase, estimator);
+    // estimate with code flow found from binary code
+    AsmCycleEstimator estimator2(testCase.deviceType);
+    estimator2.estimate(section.getSize(), section.content.data());
+    checkCycleEstimator(testCaseName + ".code", testCase, estimator2);
+}
+
+int main(int argc, const char** argv)
+{
+    int retVal = 0;
+    for (size_t i = 0; i < sizeof(gcnCyclesTestCases)/sizeof(GCNCyclesTestCase); i++)
+        try
+        { testGCNCyclesCase(i, gcnCyclesTestCases[i]); }
+        catch(const std::exception& ex)
+        {
+            std::cerr << ex.what() << std::endl;
+            retVal = 1;
+        }
+    return retVal;
+}
@@ -220,11 +220,11 @@ static const GCNDisasmLabelCase decGCN12LabelCases[] =
       ".L12_0:\n        s_branch        .L4_0\n" },
     { { 0xbf820002U, 0x4934d715U, 0x3d4cU, 0xbf82fffdU },  /* VOP2 : V_VMADAK_F16 */
       "        s_branch        .L12_0\n.L4_0:\n        v_madmk_f16     "
-      "v154, v21, 0x3d4c /* 1.3242h */, v107\n"
+      "v154, v21, 0x3d4c /* 1.324h */, v107\n"
       ".L12_0:\n        s_branch        .L4_0\n" },
     { { 0xbf820002U, 0x4b34d715U, 0x3d4cU, 0xbf82fffdU },  /* VOP2 : V_VMADAK_F16 */
       "        s_branch        .L12_0\n.L4_0:\n        v_madak_f16     "
-      "v154, v21, v107, 0x3d4c /* 1.3242h */\n"
+      "v154, v21, v107, 0x3d4c /* 1.324h */\n"
       ".L12_0:\n        s_branch        .L4_0\n" },
     { { 0xbf820001U, 0x7f3c0d4fU, 0xbf82fffeU },  /* VOP1 */
       "        s_branch        .L8_0\n.L4_0:\n        v_cvt_f32_u32   v158, v79\n"
@@ -237,7 +237,7 @@ static const GCNDisasmLabelCase decGCN12LabelCases[] =
       ".L8_0:\n        s_branch        .L4_0\n" },
     { { 0xbf820002U, 0x7c4192ffU, 0x3d4cU, 0xbf82fffdU },  /* VOPC with literal */
       "        s_branch        .L12_0\n.L4_0:\n        v_cmp_f_f16     "
-      "vcc, 0x3d4c /* 1.3242h */, v201\n.L12_0:\n        s_branch        .L4_0\n" },
+      "vcc, 0x3d4c /* 1.324h */, v201\n.L12_0:\n        s_branch        .L4_0\n" },
     { { 0xbf820002U, 0xd1d10037U, 0x07974d4fU, 0xbf82fffdU },  /* VOP3 */
       "        s_branch        .L12_0\n.L4_0:\n        v_min3_i32      v55, v79, v166, v229\n"
       ".L12_0:\n        s_branch        .L4_0\n" },
@@ -334,7 +334,7 @@ static void testDecGCNNamedLabels()
         "testLabel1=.-1\n"
         ".L4_0:\n"
         "nextInstr:\n"
-        "        v_sub_f32       v154, 0x11110000 /* 1.14384831e-28f */, v107\n"
+        "        v_sub_f32       v154, 0x11110000 /* 1.1438483e-28f */, v107\n"
         "        s_lshr_b32      s21, s2, s61\n"
         "        s_branch        nextInstr\n")
         throw Exception("FAILED namedLabelsTest: result: "+disOss.str());
@@ -468,6 +468,38 @@ static void testDecGCNRelocations()
         throw Exception("FAILED relocationTest: result: "+disOss.str());
 }
 
+// testing label set (bitmap with extra labels)
+static void testDisasmLabelSet()
+{
+    // unsorted labels with duplicates, unaligned and far labels
+    const size_t labelsIn[] = { 64, 8, 13, 8, 0, SIZE_MAX-3, 4000000000U,
+            12, 13, 1U<<24, 2, 64, 100000 };
+    const size_t labelsOut[] = { 0, 2, 8, 12, 13, 64, 100000, 1U<<24, 4000000000U,
+            SIZE_MAX-3 };
+    const size_t labelsOutNum = sizeof(labelsOut)/sizeof(size_t);
+    DisasmLabelSet labels;
+    if (!labels.empty() || labels.begin() != labels.end())
+        throw Exception("FAILED labelSet: set is not empty");
+    for (size_t label: labelsIn)
+        labels.insert(label);
+    labels.prepare();
+    std::vector<size_t> result(labels.begin(), labels.end());
+    if (result != std::vector<size_t>(labelsOut, labelsOut+labelsOutNum))
+        throw Exception("FAILED labelSet: wrong labels");
+    for (size_t i = 0; i < labelsOutNum; i++)
+        if (!labels.contains(labelsOut[i]) || *labels.lowerBound(labelsOut[i]) != labelsOut[i] ||
+            (i+1 < labelsOutNum && *labels.lowerBound(labelsOut[i]+1) != labelsOut[i+1]))
+            throw Exception("FAILED labelSet: wrong lookup");
+    if (labels.contains(1) || labels.contains(4) || labels.contains(100004) ||
+        labels.contains(4000000001U))
+        throw Exception("FAILED labelSet: label found that is not in set");
+    if (labels.lowerBound(SIZE_MAX-2) != labels.end())
+        throw Exception("FAILED labelSet: wrong lowerBound at end");
+    labels.clear();
+    if (!labels.empty())
+        throw Exception("FAILED labelSet: set not cleared");
+}
+
 int main(int argc, const char** argv)
 {
     int retVal = 0;
@@ -500,6 +532,7 @@ int main(int argc, const char** argv)
     {
         testDecGCNNamedLabels();
         testDecGCNRelocations();
+        testDisasmLabelSet();
     }
     catch(const std::exception& ex)
     {
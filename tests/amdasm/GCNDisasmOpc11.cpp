@@ -403,14 +403,14 @@ const GCNDisasmOpcodeCase decGCNOpcodeCases[] =
     { 0x4134d715U, 0x567d0700U, true, "        v_madmk_f32     "
             "v154, v21, 0x567d0700 /* 6.9551627e+13f */, v107\n" }, /* check floatLits */
     { 0x4134d715U, 0x11U, true, "        v_madmk_f32     "
-            "v154, v21, 0x11 /* 2.38e-44f */, v107\n" }, /* check floatLits */
+            "v154, v21, 0x11 /* 2.4e-44f */, v107\n" }, /* check floatLits */
     { 0x4134d6ffU, 0x567d0700U, true, "        v_madmk_f32     "
             "v154, 0x567d0700 /* 6.9551627e+13f */, "
             "0x567d0700 /* 6.9551627e+13f */, v107\n" }, /* check floatLits */
     { 0x4334d715U, 0x567d0700U, true, "        v_madak_f32     "
             "v154, v21, v107, 0x567d0700 /* 6.9551627e+13f */\n" },  /* check floatLits */
     { 0x4334d715U, 0x11U, true, "        v_madak_f32     "
-            "v154, v21, v107, 0x11 /* 2.38e-44f */\n" },  /* check floatLits */
+            "v154, v21, v107, 0x11 /* 2.4e-44f */\n" },  /* check floatLits */
     { 0x4334d6ffU, 0x567d0700U, true, "        v_madak_f32     "
             "v154, 0x567d0700 /* 6.9551627e+13f */, "
             "v107, 0x567d0700 /* 6.9551627e+13f */\n" },  /* check floatLits */
@@ -462,7 +462,7 @@ const GCNDisasmOpcodeCase decGCNOpcodeCases[] =
     { 0x7f3c14ffU, 0x40000000U, true, "        v_cvt_f16_f32   v158, "
                 "0x40000000 /* 2f */\n" },
     { 0x7f3c174fU, 0, false, "        v_cvt_f32_f16   v158, v79\n" },
-    { 0x7f3c16ffU, 0x3d4cU, true, "        v_cvt_f32_f16   v158, 0x3d4c /* 1.3242h */\n" },
+    { 0x7f3c16ffU, 0x3d4cU, true, "        v_cvt_f32_f16   v158, 0x3d4c /* 1.324h */\n" },
     { 0x7f3c194fU, 0, false, "        v_cvt_rpi_i32_f32 v158, v79\n" },
     { 0x7f3c18ffU, 0x40000000U, true, "        v_cvt_rpi_i32_f32 v158, "
                 "0x40000000 /* 2f */\n" },
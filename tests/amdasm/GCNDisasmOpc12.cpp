@@ -617,23 +617,23 @@ const GCNDisasmOpcodeCase decGCNOpcodeGCN12Cases[] =
     { 0x3d34d715U, 0, false, "        v_subbrev_u32   v154, vcc, v21, v107, vcc\n" },
     { 0x3f34d715U, 0, false, "        v_add_f16       v154, v21, v107\n" },
     { 0x3f34d6ffU, 0x3d4c, true,
-        "        v_add_f16       v154, 0x3d4c /* 1.3242h */, v107\n" },
+        "        v_add_f16       v154, 0x3d4c /* 1.324h */, v107\n" },
     { 0x4134d715U, 0, false, "        v_sub_f16       v154, v21, v107\n" },
     { 0x4134d6ffU, 0x3d4c, true,
-        "        v_sub_f16       v154, 0x3d4c /* 1.3242h */, v107\n" },
+        "        v_sub_f16       v154, 0x3d4c /* 1.324h */, v107\n" },
     { 0x4334d715U, 0, false, "        v_subrev_f16    v154, v21, v107\n" },
     { 0x4334d6ffU, 0x3d4c, true,
-        "        v_subrev_f16    v154, 0x3d4c /* 1.3242h */, v107\n" },
+        "        v_subrev_f16    v154, 0x3d4c /* 1.324h */, v107\n" },
     { 0x4534d715U, 0, false, "        v_mul_f16       v154, v21, v107\n" },
     { 0x4534d6ffU, 0x3d4c, true,
-        "        v_mul_f16       v154, 0x3d4c /* 1.3242h */, v107\n" },
+        "        v_mul_f16       v154, 0x3d4c /* 1.324h */, v107\n" },
     { 0x4734d715U, 0, false, "        v_mac_f16       v154, v21, v107\n" },
     { 0x4734d6ffU, 0x3d4c, true,
-        "        v_mac_f16       v154, 0x3d4c /* 1.3242h */, v107\n" },
+        "        v_mac_f16       v154, 0x3d4c /* 1.324h */, v107\n" },
     { 0x4934d715U, 0x3d4c, true,
-        "        v_madmk_f16     v154, v21, 0x3d4c /* 1.3242h */, v107\n" },
+        "        v_madmk_f16     v154, v21, 0x3d4c /* 1.324h */, v107\n" },
     { 0x4b34d715U, 0x3d4c, true,
-        "        v_madak_f16     v154, v21, v107, 0x3d4c /* 1.3242h */\n" },
+        "        v_madak_f16     v154, v21, v107, 0x3d4c /* 1.324h */\n" },
     { 0x4d34d715U, 0, false, "        v_add_u16       v154, v21, v107\n" },
     { 0x4f34d715U, 0, false, "        v_sub_u16       v154, v21, v107\n" },
     { 0x5134d715U, 0, false, "        v_subrev_u16    v154, v21, v107\n" },
@@ -643,16 +643,16 @@ const GCNDisasmOpcodeCase decGCNOpcodeGCN12Cases[] =
     { 0x5934d715U, 0, false, "        v_ashrrev_i16   v154, v21, v107\n" },
     { 0x5b34d715U, 0, false, "        v_max_f16       v154, v21, v107\n" },
     { 0x5b34d6ffU, 0x3d4c, true,
-        "        v_max_f16       v154, 0x3d4c /* 1.3242h */, v107\n" },
+        "        v_max_f16       v154, 0x3d4c /* 1.324h */, v107\n" },
     { 0x5d34d715U, 0, false, "        v_min_f16       v154, v21, v107\n" },
     { 0x5d34d6ffU, 0x3d4c, true,
-        "        v_min_f16       v154, 0x3d4c /* 1.3242h */, v107\n" },
+        "        v_min_f16       v154, 0x3d4c /* 1.324h */, v107\n" },
     { 0x5f34d715U, 0, false, "        v_max_u16       v154, v21, v107\n" },
     { 0x6134d715U, 0, false, "        v_max_i16       v154, v21, v107\n" },
     { 0x6334d715U, 0, false, "        v_min_u16       v154, v21, v107\n" },
     { 0x6534d715U, 0, false, "        v_min_i16       v154, v21, v107\n" },
     { 0x6734d6ffU, 0x3d4c, true,
-        "        v_ldexp_f16     v154, 0x3d4c /* 1.3242h */, v107\n" },
+        "        v_ldexp_f16     v154, 0x3d4c /* 1.324h */, v107\n" },
     { 0x6934d715U, 0, false, "        VOP2_ill_52     v154, v21, v107\n" },
     { 0x6b34d715U, 0, false, "        VOP2_ill_53     v154, v21, v107\n" },
     { 0x6d34d715U, 0, false, "        VOP2_ill_54     v154, v21, v107\n" },
@@ -692,7 +692,7 @@ const GCNDisasmOpcodeCase decGCNOpcodeGCN12Cases[] =
     { 0x7f3c14ffU, 0x40000000U, true, "        v_cvt_f16_f32   v158, "
                 "0x40000000 /* 2f */\n" },
     { 0x7f3c174fU, 0, false, "        v_cvt_f32_f16   v158, v79\n" },
-    { 0x7f3c16ffU, 0x3d4cU, true, "        v_cvt_f32_f16   v158, 0x3d4c /* 1.3242h */\n" },
+    { 0x7f3c16ffU, 0x3d4cU, true, "        v_cvt_f32_f16   v158, 0x3d4c /* 1.324h */\n" },
     { 0x7f3c194fU, 0, false, "        v_cvt_rpi_i32_f32 v158, v79\n" },
     { 0x7f3c18ffU, 0x40000000U, true, "        v_cvt_rpi_i32_f32 v158, "
                 "0x40000000 /* 2f */\n" },
@@ -773,38 +773,38 @@ const GCNDisasmOpcodeCase decGCNOpcodeGCN12Cases[] =
     { 0x7f3c734fU, 0, false, "        v_cvt_f16_u16   v158, v79\n" },
     { 0x7f3c754fU, 0, false, "        v_cvt_f16_i16   v158, v79\n" },
     { 0x7f3c774fU, 0, false, "        v_cvt_u16_f16   v158, v79\n" },
-    { 0x7f3c76ffU, 0x3d4c, true, "        v_cvt_u16_f16   v158, 0x3d4c /* 1.3242h */\n" },
+    { 0x7f3c76ffU, 0x3d4c, true, "        v_cvt_u16_f16   v158, 0x3d4c /* 1.324h */\n" },
     { 0x7f3c794fU, 0, false, "        v_cvt_i16_f16   v158, v79\n" },
-    { 0x7f3c78ffU, 0x3d4c, true, "        v_cvt_i16_f16   v158, 0x3d4c /* 1.3242h */\n" },
+    { 0x7f3c78ffU, 0x3d4c, true, "        v_cvt_i16_f16   v158, 0x3d4c /* 1.324h */\n" },
     { 0x7f3c7b4fU, 0, false, "        v_rcp_f16       v158, v79\n" },
-    { 0x7f3c7affU, 0x3d4c, true, "        v_rcp_f16       v158, 0x3d4c /* 1.3242h */\n" },
+    { 0x7f3c7affU, 0x3d4c, true, "        v_rcp_f16       v158, 0x3d4c /* 1.324h */\n" },
     { 0x7f3c7d4fU, 0, false, "        v_sqrt_f16      v158, v79\n" },
-    { 0x7f3c7cffU, 0x3d4c, true, "        v_sqrt_f16      v158, 0x3d4c /* 1.3242h */\n" },
+    { 0x7f3c7cffU, 0x3d4c, true, "        v_sqrt_f16      v158, 0x3d4c /* 1.324h */\n" },
     { 0x7f3c7f4fU, 0, false, "        v_rsq_f16       v158, v79\n" },
-    { 0x7f3c7effU, 0x3d4c, true, "        v_rsq_f16       v158, 0x3d4c /* 1.3242h */\n" },
+    { 0x7f3c7effU, 0x3d4c, true, "        v_rsq_f16       v158, 0x3d4c /* 1.324h */\n" },
     { 0x7f3c814fU, 0, false, "        v_log_f16       v158, v79\n" },
-    { 0x7f3c80ffU, 0x3d4c, true, "        v_log_f16       v158, 0x3d4c /* 1.3242h */\n" },
+    { 0x7f3c80ffU, 0x3d4c, true, "        v_log_f16       v158, 0x3d4c /* 1.324h */\n" },
     { 0x7f3c834fU, 0, false, "        v_exp_f16       v158, v79\n" },
-    { 0x7f3c82ffU, 0x3d4c, true, "        v_exp_f16       v158, 0x3d4c /* 1.3242h */\n" },
+    { 0x7f3c82ffU, 0x3d4c, true, "        v_exp_f16       v158, 0x3d4c /* 1.324h */\n" },
     { 0x7f3c854fU, 0, false, "        v_frexp_mant_f16 v158, v79\n" },
-    { 0x7f3c84ffU, 0x3d4c, true, "        v_frexp_mant_f16 v158, 0x3d4c /* 1.3242h */\n" },
+    { 0x7f3c84ffU, 0x3d4c, true, "        v_frexp_mant_f16 v158, 0x3d4c /* 1.324h */\n" },
     { 0x7f3c874fU, 0, false, "        v_frexp_exp_i16_f16 v158, v79\n" },
     { 0x7f3c86ffU, 0x3d4c, true, "        v_frexp_exp_i16_f16 "
-        "v158, 0x3d4c /* 1.3242h */\n" },
+        "v158, 0x3d4c /* 1.324h */\n" },
     { 0x7f3c894fU, 0, false, "        v_floor_f16     v158, v79\n" },
-    { 0x7f3c88ffU, 0x3d4c, true, "        v_floor_f16     v158, 0x3d4c /* 1.3242h */\n" },
+    { 0x7f3c88ffU, 0x3d4c, true, "        v_floor_f16     v158, 0x3d4c /* 1.324h */\n" },
     { 0x7f3c8b4fU, 0, false, "        v_ceil_f16      v158, v79\n" },
-    { 0x7f3c8affU, 0x3d4c, true, "        v_ceil_f16      v158, 0x3d4c /* 1.3242h */\n" },
+    { 0x7f3c8affU, 0x3d4c, true, "        v_ceil_f16      v158, 0x3d4c /* 1.324h */\n" },
     { 0x7f3c8d4fU, 0, false, "        v_trunc_f16     v158, v79\n" },
-    { 0x7f3c8cffU, 0x3d4c, true, "        v_trunc_f16     v158, 0x3d4c /* 1.3242h */\n" },
+    { 0x7f3c8cffU, 0x3d4c, true, "        v_trunc_f16     v158, 0x3d4c /* 1.324h */\n" },
     { 0x7f3c8f4fU, 0, false, "        v_rndne_f16     v158, v79\n" },
-    { 0x7f3c8effU, 0x3d4c, true, "        v_rndne_f16     v158, 0x3d4c /* 1.3242h */\n" },
+    { 0x7f3c8effU, 0x3d4c, true, "        v_rndne_f16     v158, 0x3d4c /* 1.324h */\n" },
     { 0x7f3c914fU, 0, false, "        v_fract_f16     v158, v79\n" },
-    { 0x7f3c90ffU, 0x3d4c, true, "        v_fract_f16     v158, 0x3d4c /* 1.3242h */\n" },
+    { 0x7f3c90ffU, 0x3d4c, true, "        v_fract_f16     v158, 0x3d4c /* 1.324h */\n" },
     { 0x7f3c934fU, 0, false, "        v_sin_f16       v158, v79\n" },
-    { 0x7f3c92ffU, 0x3d4c, true, "        v_sin_f16       v158, 0x3d4c /* 1.3242h */\n" },
+    { 0x7f3c92ffU, 0x3d4c, true, "        v_sin_f16       v158, 0x3d4c /* 1.324h */\n" },
     { 0x7f3c954fU, 0, false, "        v_cos_f16       v158, v79\n" },
-    { 0x7f3c94ffU, 0x3d4c, true, "        v_cos_f16       v158, 0x3d4c /* 1.3242h */\n" },
+    { 0x7f3c94ffU, 0x3d4c, true, "        v_cos_f16       v158, 0x3d4c /* 1.324h */\n" },
     { 0x7f3c974fU, 0, false, "        v_exp_legacy_f32 v158, v79\n" },
     { 0x7f3c96ffU, 0x40000000U, true, "        v_exp_legacy_f32 v158, "
                 "0x40000000 /* 2f */\n" },
@@ -845,10 +845,10 @@ const GCNDisasmOpcodeCase decGCNOpcodeGCN12Cases[] =
                 "vcc, 0x40000000, v[201:202]\n" },
     { 0x7c29934fU, 0, false, "        v_cmp_class_f16 vcc, v79, v201\n" },
     { 0x7c2992ffU, 0x3d4c, true, "        v_cmp_class_f16 "
-                "vcc, 0x3d4c /* 1.3242h */, v201\n" },
+                "vcc, 0x3d4c /* 1.324h */, v201\n" },
     { 0x7c2b934fU, 0, false, "        v_cmpx_class_f16 vcc, v79, v201\n" },
     { 0x7c2b92ffU, 0x3d4c, true, "        v_cmpx_class_f16 "
-                "vcc, 0x3d4c /* 1.3242h */, v201\n" },
+                "vcc, 0x3d4c /* 1.324h */, v201\n" },
     { 0x7c2d934fU, 0, false, "        VOPC_ill_22     vcc, v79, v201\n" },
     { 0x7c2f934fU, 0, false, "        VOPC_ill_23     vcc, v79, v201\n" },
     { 0x7c31934fU, 0, false, "        VOPC_ill_24     vcc, v79, v201\n" },
@@ -861,101 +861,101 @@ const GCNDisasmOpcodeCase decGCNOpcodeGCN12Cases[] =
     { 0x7c3f934fU, 0, false, "        VOPC_ill_31     vcc, v79, v201\n" },
     { 0x7c41934fU, 0, false, "        v_cmp_f_f16     vcc, v79, v201\n" },
     { 0x7c4192ffU, 0x3d4cU, true, "        v_cmp_f_f16     "
-                "vcc, 0x3d4c /* 1.3242h */, v201\n" },
+                "vcc, 0x3d4c /* 1.324h */, v201\n" },
     { 0x7c43934fU, 0, false, "        v_cmp_lt_f16    vcc, v79, v201\n" },
     { 0x7c4392ffU, 0x3d4cU, true, "        v_cmp_lt_f16    "
-                "vcc, 0x3d4c /* 1.3242h */, v201\n" },
+                "vcc, 0x3d4c /* 1.324h */, v201\n" },
     { 0x7c45934fU, 0, false, "        v_cmp_eq_f16    vcc, v79, v201\n" },
     { 0x7c4592ffU, 0x3d4cU, true, "        v_cmp_eq_f16    "
-                "vcc, 0x3d4c /* 1.3242h */, v201\n" },
+                "vcc, 0x3d4c /* 1.324h */, v201\n" },
     { 0x7c47934fU, 0, false, "        v_cmp_le_f16    vcc, v79, v201\n" },
     { 0x7c4792ffU, 0x3d4cU, true, "        v_cmp_le_f16    "
-                "vcc, 0x3d4c /* 1.3242h */, v201\n" },
+                "vcc, 0x3d4c /* 1.324h */, v201\n" },
     { 0x7c49934fU, 0, false, "        v_cmp_gt_f16    vcc, v79, v201\n" },
     { 0x7c4992ffU, 0x3d4cU, true, "        v_cmp_gt_f16    "
-                "vcc, 0x3d4c /* 1.3242h */, v201\n" },
+                "vcc, 0x3d4c /* 1.324h */, v201\n" },
     { 0x7c4b934fU, 0, false, "        v_cmp_lg_f16    vcc, v79, v201\n" },
     { 0x7c4b92ffU, 0x3d4cU, true, "        v_cmp_lg_f16    "
-                "vcc, 0x3d4c /* 1.3242h */, v201\n" },
+                "vcc, 0x3d4c /* 1.324h */, v201\n" },
     { 0x7c4d934fU, 0, false, "        v_cmp_ge_f16    vcc, v79, v201\n" },
     { 0x7c4d92ffU, 0x3d4cU, true, "        v_cmp_ge_f16    "
-                "vcc, 0x3d4c /* 1.3242h */, v201\n" },
+                "vcc, 0x3d4c /* 1.324h */, v201\n" },
     { 0x7c4f934fU, 0, false, "        v_cmp_o_f16     vcc, v79, v201\n" },
     { 0x7c4f92ffU, 0x3d4cU, true, "        v_cmp_o_f16     "
-                "vcc, 0x3d4c /* 1.3242h */, v201\n" },
+                "vcc, 0x3d4c /* 1.324h */, v201\n" },
     { 0x7c51934fU, 0, false, "        v_cmp_u_f16     vcc, v79, v201\n" },
     { 0x7c5192ffU, 0x3d4cU, true, "        v_cmp_u_f16     "
-                "vcc, 0x3d4c /* 1.3242h */, v201\n" },
+                "vcc, 0x3d4c /* 1.324h */, v201\n" },
     { 0x7c53934fU, 0, false, "        v_cmp_nge_f16   vcc, v79, v201\n" },
     { 0x7c5392ffU, 0x3d4cU, true, "        v_cmp_nge_f16   "
-                "vcc, 0x3d4c /* 1.3242h */, v201\n" },
+                "vcc, 0x3d4c /* 1.324h */, v201\n" },
     { 0x7c55934fU, 0, false, "        v_cmp_nlg_f16   vcc, v79, v201\n" },
     { 0x7c5592ffU, 0x3d4cU, true, "        v_cmp_nlg_f16   "
-                "vcc, 0x3d4c /* 1.3242h */, v201\n" },
+                "vcc, 0x3d4c /* 1.324h */, v201\n" },
     { 0x7c57934fU, 0, false, "        v_cmp_ngt_f16   vcc, v79, v201\n" },
     { 0x7c5792ffU, 0x3d4cU, true, "        v_cmp_ngt_f16   "
-                "vcc, 0x3d4c /* 1.3242h */, v201\n" },
+                "vcc, 0x3d4c /* 1.324h */, v201\n" },
     { 0x7c59934fU, 0, false, "        v_cmp_nle_f16   vcc, v79, v201\n" },
     { 0x7c5992ffU, 0x3d4cU, true, "        v_cmp_nle_f16   "
-                "vcc, 0x3d4c /* 1.3242h */, v201\n" },
+                "vcc, 0x3d4c /* 1.324h */, v201\n" },
     { 0x7c5b934fU, 0, false, "        v_cmp_neq_f16   vcc, v79, v201\n" },
     { 0x7c5b92ffU, 0x3d4cU, true, "        v_cmp_neq_f16   "
-                "vcc, 0x3d4c /* 1.3242h */, v201\n" },
+                "vcc, 0x3d4c /* 1.324h */, v201\n" },
     { 0x7c5d934fU, 0, false, "        v_cmp_nlt_f16   vcc, v79, v201\n" },
     { 0x7c5d92ffU, 0x3d4cU, true, "        v_cmp_nlt_f16   "
-                "vcc, 0x3d4c /* 1.3242h */, v201\n" },
+                "vcc, 0x3d4c /* 1.324h */, v201\n" },
     { 0x7c5f934fU, 0, false, "        v_cmp_tru_f16   vcc, v79, v201\n" },
     { 0x7c5f92ffU, 0x3d4cU, true, "        v_cmp_tru_f16   "
-                "vcc, 0x3d4c /* 1.3242h */, v201\n" },
+                "vcc, 0x3d4c /* 1.324h */, v201\n" },
     
     { 0x7c61934fU, 0, false, "        v_cmpx_f_f16    vcc, v79, v201\n" },
     { 0x7c6192ffU, 0x3d4cU, true, "        v_cmpx_f_f16    "
-                "vcc, 0x3d4c /* 1.3242h */, v201\n" },
+                "vcc, 0x3d4c /* 1.324h */, v201\n" },
     { 0x7c63934fU, 0, false, "        v_cmpx_lt_f16   vcc, v79, v201\n" },
     { 0x7c6392ffU, 0x3d4cU, true, "        v_cmpx_lt_f16   "
-                "vcc, 0x3d4c /* 1.3242h */, v201\n" },
+                "vcc, 0x3d4c /* 1.324h */, v201\n" },
     { 0x7c65934fU, 0, false, "        v_cmpx_eq_f16   vcc, v79, v201\n" },
     { 0x7c6592ffU, 0x3d4cU, true, "        v_cmpx_eq_f16   "
-                "vcc, 0x3d4c /* 1.3242h */, v201\n" },
+                "vcc, 0x3d4c /* 1.324h */, v201\n" },
     { 0x7c67934fU, 0, false, "        v_cmpx_le_f16   vcc, v79, v201\n" },
     { 0x7c6792ffU, 0x3d4cU, true, "        v_cmpx_le_f16   "
-                "vcc, 0x3d4c /* 1.3242h */, v201\n" },
+                "vcc, 0x3d4c /* 1.324h */, v201\n" },
     { 0x7c69934fU, 0, false, "        v_cmpx_gt_f16   vcc, v79, v201\n" },
     { 0x7c6992ffU, 0x3d4cU, true, "        v_cmpx_gt_f16   "
-                "vcc, 0x3d4c /* 1.3242h */, v201\n" },
+                "vcc, 0x3d4c /* 1.324h */, v201\n" },
     { 0x7c6b934fU, 0, false, "        v_cmpx_lg_f16   vcc, v79, v201\n" },
     { 0x7c6b92ffU, 0x3d4cU, true, "        v_cmpx_lg_f16   "
-                "vcc, 0x3d4c /* 1.3242h */, v201\n" },
+                "vcc, 0x3d4c /* 1.324h */, v201\n" },
     { 0x7c6d934fU, 0, false, "        v_cmpx_ge_f16   vcc, v79, v201\n" },
     { 0x7c6d92ffU, 0x3d4cU, true, "        v_cmpx_ge_f16   "
-                "vcc, 0x3d4c /* 1.3242h */, v201\n" },
+                "vcc, 0x3d4c /* 1.324h */, v201\n" },
     { 0x7c6f934fU, 0, false, "        v_cmpx_o_f16    vcc, v79, v201\n" },
     { 0x7c6f92ffU, 0x3d4cU, true, "        v_cmpx_o_f16    "
-                "vcc, 0x3d4c /* 1.3242h */, v201\n" },
+                "vcc, 0x3d4c /* 1.324h */, v201\n" },
     { 0x7c71934fU, 0, false, "        v_cmpx_u_f16    vcc, v79, v201\n" },
     { 0x7c7192ffU, 0x3d4cU, true, "        v_cmpx_u_f16    "
-                "vcc, 0x3d4c /* 1.3242h */, v201\n" },
+                "vcc, 0x3d4c /* 1.324h */, v201\n" },
     { 0x7c73934fU, 0, false, "        v_cmpx_nge_f16  vcc, v79, v201\n" },
     { 0x7c7392ffU, 0x3d4cU, true, "        v_cmpx_nge_f16  "
-                "vcc, 0x3d4c /* 1.3242h */, v201\n" },
+                "vcc, 0x3d4c /* 1.324h */, v201\n" },
     { 0x7c75934fU, 0, false, "        v_cmpx_nlg_f16  vcc, v79, v201\n" },
     { 0x7c7592ffU, 0x3d4cU, true, "        v_cmpx_nlg_f16  "
-                "vcc, 0x3d4c /* 1.3242h */, v201\n" },
+                "vcc, 0x3d4c /* 1.324h */, v201\n" },
     { 0x7c77934fU, 0, false, "        v_cmpx_ngt_f16  vcc, v79, v201\n" },
     { 0x7c7792ffU, 0x3d4cU, true, "        v_cmpx_ngt_f16  "
-                "vcc, 0x3d4c /* 1.3242h */, v201\n" },
+                "vcc, 0x3d4c /* 1.324h */, v201\n" },
     { 0x7c79934fU, 0, false, "        v_cmpx_nle_f16  vcc, v79, v201\n" },
     { 0x7c7992ffU, 0x3d4cU, true, "        v_cmpx_nle_f16  "
-                "vcc, 0x3d4c /* 1.3242h */, v201\n" },
+                "vcc, 0x3d4c /* 1.324h */, v201\n" },
     { 0x7c7b934fU, 0, false, "        v_cmpx_neq_f16  vcc, v79, v201\n" },
     { 0x7c7b92ffU, 0x3d4cU, true, "        v_cmpx_neq_f16  "
-                "vcc, 0x3d4c /* 1.3242h */, v201\n" },
+                "vcc, 0x3d4c /* 1.324h */, v201\n" },
     { 0x7c7d934fU, 0, false, "        v_cmpx_nlt_f16  vcc, v79, v201\n" },
     { 0x7c7d92ffU, 0x3d4cU, true, "        v_cmpx_nlt_f16  "
-                "vcc, 0x3d4c /* 1.3242h */, v201\n" },
+                "vcc, 0x3d4c /* 1.324h */, v201\n" },
     { 0x7c7f934fU, 0, false, "        v_cmpx_tru_f16  vcc, v79, v201\n" },
     { 0x7c7f92ffU, 0x3d4cU, true, "        v_cmpx_tru_f16  "
-                "vcc, 0x3d4c /* 1.3242h */, v201\n" },
+                "vcc, 0x3d4c /* 1.324h */, v201\n" },
     
     { 0x7c81934fU, 0, false, "        v_cmp_f_f32     vcc, v79, v201\n" },
     { 0x7c8192ffU, 0x40000000U, true, "        v_cmp_f_f32     "
@@ -246,10 +246,10 @@ const GCNDisasmOpcodeCase decGCNOpcodeGCN14Cases[] =
     { 0xd1780037U, 0x0000011bU, true, "        VOP3A_ill_376   v55, v27, s0, s0\n" },
     { 0x7f3c9b4fU, 0, false, "        v_cvt_norm_i16_f16 v158, v79\n" },
     { 0x7f3c9affU, 0x3d4c, true, "        v_cvt_norm_i16_f16 "
-            "v158, 0x3d4c /* 1.3242h */\n" },
+            "v158, 0x3d4c /* 1.324h */\n" },
     { 0x7f3c9d4fU, 0, false, "        v_cvt_norm_u16_f16 v158, v79\n" },
     { 0x7f3c9cffU, 0x3d4c, true, "        v_cvt_norm_u16_f16 "
-            "v158, 0x3d4c /* 1.3242h */\n" },
+            "v158, 0x3d4c /* 1.324h */\n" },
     { 0x7f3c9f4fU, 0, false, "        v_sat_pk_u8_i16 v158, v79\n" },
     { 0x7f3c9effU, 0x3d4c, true, "        v_sat_pk_u8_i16 v158, 0x3d4c\n" },
     { 0x7f3ca14fU, 0, false, "        v_writelane_regwr_b32 v158, v79\n" },
@@ -780,7 +780,7 @@ const GCNDisasmOpcodeCase decGCNOpcodeGCN14Cases[] =
         "v[47:48], v187, v[65:66], s[49:50] glc slc\n" },
     // VOP3 CMP
     { 0x7c7f92ffU, 0x3d4cU, true, "        v_cmpx_tru_f16  "
-                "vcc, 0x3d4c /* 1.3242h */, v201\n" },
+                "vcc, 0x3d4c /* 1.324h */, v201\n" },
     { 0, 0, false, nullptr }
 };
 
@@ -817,7 +817,7 @@ const GCNDisasmOpcodeCase decGCNOpcodeGCN141Cases[] =
     // test for other opcodes (mapping of RX VEGA VOP3 code table
     // VOP3 CMP
     { 0x7c7f92ffU, 0x3d4cU, true, "        v_cmpx_tru_f16  "
-                "vcc, 0x3d4c /* 1.3242h */, v201\n" },
+                "vcc, 0x3d4c /* 1.324h */, v201\n" },
     { 0xd1760037U, 0x0000011bU, true, "        v_mov_prsv_b32  v55, v27 vop3\n" },
     { 0xd1770037U, 0x0000011bU, true,
         "        v_screen_partition_4se_b32 v55, v27 vop3\n" },
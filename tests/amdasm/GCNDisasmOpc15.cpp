@@ -609,14 +609,14 @@ const GCNDisasmOpcodeCase decGCNOpcodeGCN15Cases[] =
     { 0x4134d715U, 0x567d0700U, true, "        v_madmk_f32     "
             "v154, v21, 0x567d0700 /* 6.9551627e+13f */, v107\n" }, /* check floatLits */
     { 0x4134d715U, 0x11U, true, "        v_madmk_f32     "
-            "v154, v21, 0x11 /* 2.38e-44f */, v107\n" }, /* check floatLits */
+            "v154, v21, 0x11 /* 2.4e-44f */, v107\n" }, /* check floatLits */
     { 0x4134d6ffU, 0x567d0700U, true, "        v_madmk_f32     "
             "v154, 0x567d0700 /* 6.9551627e+13f */, "
             "0x567d0700 /* 6.9551627e+13f */, v107\n" }, /* check floatLits */
     { 0x4334d715U, 0x567d0700U, true, "        v_madak_f32     "
             "v154, v21, v107, 0x567d0700 /* 6.9551627e+13f */\n" },  /* check floatLits */
     { 0x4334d715U, 0x11U, true, "        v_madak_f32     "
-            "v154, v21, v107, 0x11 /* 2.38e-44f */\n" },  /* check floatLits */
+            "v154, v21, v107, 0x11 /* 2.4e-44f */\n" },  /* check floatLits */
     { 0x4334d6ffU, 0x567d0700U, true, "        v_madak_f32     "
             "v154, 0x567d0700 /* 6.9551627e+13f */, "
             "v107, 0x567d0700 /* 6.9551627e+13f */\n" },  /* check floatLits */
@@ -633,14 +633,14 @@ const GCNDisasmOpcodeCase decGCNOpcodeGCN15Cases[] =
     { 0x5934d715U, 0x567d0700U, true, "        v_fmamk_f32     "
             "v154, v21, 0x567d0700 /* 6.9551627e+13f */, v107\n" }, /* check floatLits */
     { 0x5934d715U, 0x11U, true, "        v_fmamk_f32     "
-            "v154, v21, 0x11 /* 2.38e-44f */, v107\n" }, /* check floatLits */
+            "v154, v21, 0x11 /* 2.4e-44f */, v107\n" }, /* check floatLits */
     { 0x5934d6ffU, 0x567d0700U, true, "        v_fmamk_f32     "
             "v154, 0x567d0700 /* 6.9551627e+13f */, "
             "0x567d0700 /* 6.9551627e+13f */, v107\n" }, /* check floatLits */
     { 0x5b34d715U, 0x567d0700U, true, "        v_fmaak_f32     "
             "v154, v21, v107, 0x567d0700 /* 6.9551627e+13f */\n" },  /* check floatLits */
     { 0x5b34d715U, 0x11U, true, "        v_fmaak_f32     "
-            "v154, v21, v107, 0x11 /* 2.38e-44f */\n" },  /* check floatLits */
+            "v154, v21, v107, 0x11 /* 2.4e-44f */\n" },  /* check floatLits */
     { 0x5b34d6ffU, 0x567d0700U, true, "        v_fmaak_f32     "
             "v154, 0x567d0700 /* 6.9551627e+13f */, "
             "v107, 0x567d0700 /* 6.9551627e+13f */\n" },  /* check floatLits */
@@ -650,39 +650,39 @@ const GCNDisasmOpcodeCase decGCNOpcodeGCN15Cases[] =
     { 0x6334d715U, 0, false, "        VOP2_ill_49     v154, v21, v107\n" },
     { 0x6534d715U, 0, false, "        v_add_f16       v154, v21, v107\n" },
     { 0x6534d6ffU, 0x3d4c, true,
-        "        v_add_f16       v154, 0x3d4c /* 1.3242h */, v107\n" },
+        "        v_add_f16       v154, 0x3d4c /* 1.324h */, v107\n" },
     { 0x6734d715U, 0, false, "        v_sub_f16       v154, v21, v107\n" },
     { 0x6734d6ffU, 0x3d4c, true,
-        "        v_sub_f16       v154, 0x3d4c /* 1.3242h */, v107\n" },
+        "        v_sub_f16       v154, 0x3d4c /* 1.324h */, v107\n" },
     { 0x6934d715U, 0, false, "        v_subrev_f16    v154, v21, v107\n" },
     { 0x6934d6ffU, 0x3d4c, true,
-        "        v_subrev_f16    v154, 0x3d4c /* 1.3242h */, v107\n" },
+        "        v_subrev_f16    v154, 0x3d4c /* 1.324h */, v107\n" },
     { 0x6b34d715U, 0, false, "        v_mul_f16       v154, v21, v107\n" },
     { 0x6b34d6ffU, 0x3d4c, true,
-        "        v_mul_f16       v154, 0x3d4c /* 1.3242h */, v107\n" },
+        "        v_mul_f16       v154, 0x3d4c /* 1.324h */, v107\n" },
     { 0x6d34d715U, 0, false, "        v_fmac_f16      v154, v21, v107\n" },
     { 0x6d34d6ffU, 0x3d4c, true,
-        "        v_fmac_f16      v154, 0x3d4c /* 1.3242h */, v107\n" },
+        "        v_fmac_f16      v154, 0x3d4c /* 1.324h */, v107\n" },
     { 0x6f34d715U, 0x3d4c, true,
-        "        v_fmamk_f16     v154, v21, 0x3d4c /* 1.3242h */, v107\n" },
+        "        v_fmamk_f16     v154, v21, 0x3d4c /* 1.324h */, v107\n" },
     { 0x6f34d6ffU, 0x3d4c, true, "        v_fmamk_f16     "
-        "v154, 0x3d4c /* 1.3242h */, 0x3d4c /* 1.3242h */, v107\n" },
+        "v154, 0x3d4c /* 1.324h */, 0x3d4c /* 1.324h */, v107\n" },
     { 0x7134d715U, 0x3d4c, true,
-        "        v_fmaak_f16     v154, v21, v107, 0x3d4c /* 1.3242h */\n" },
+        "        v_fmaak_f16     v154, v21, v107, 0x3d4c /* 1.324h */\n" },
     { 0x7134d6ffU, 0x3d4c, true, "        v_fmaak_f16     "
-        "v154, 0x3d4c /* 1.3242h */, v107, 0x3d4c /* 1.3242h */\n" },
+        "v154, 0x3d4c /* 1.324h */, v107, 0x3d4c /* 1.324h */\n" },
     { 0x7334d715U, 0, false, "        v_max_f16       v154, v21, v107\n" },
     { 0x7334d6ffU, 0x3d4c, true,
-        "        v_max_f16       v154, 0x3d4c /* 1.3242h */, v107\n" },
+        "        v_max_f16       v154, 0x3d4c /* 1.324h */, v107\n" },
     { 0x7534d715U, 0, false, "        v_min_f16       v154, v21, v107\n" },
     { 0x7534d6ffU, 0x3d4c, true,
-        "        v_min_f16       v154, 0x3d4c /* 1.3242h */, v107\n" },
+        "        v_min_f16       v154, 0x3d4c /* 1.324h */, v107\n" },
     { 0x7734d715U, 0, false, "        v_ldexp_f16     v154, v21, v107\n" },
     { 0x7734d6ffU, 0x3d4c, true,
-        "        v_ldexp_f16     v154, 0x3d4c /* 1.3242h */, v107\n" },
+        "        v_ldexp_f16     v154, 0x3d4c /* 1.324h */, v107\n" },
     { 0x7934d715U, 0, false, "        v_pk_fmac_f16   v154, v21, v107\n" },
     { 0x7934d6ffU, 0x3d4c, true,
-        "        v_pk_fmac_f16   v154, 0x3d4c /* 1.3242h */, v107\n" },
+        "        v_pk_fmac_f16   v154, 0x3d4c /* 1.324h */, v107\n" },
     /* VOP1 encoding */
     { 0x7f3c004fU, 0, false, "        v_nop           vdst=0x9e src0=0x4f\n" },
     { 0x7f3c0000U, 0, false, "        v_nop           vdst=0x9e\n" },
@@ -710,7 +710,7 @@ const GCNDisasmOpcodeCase decGCNOpcodeGCN15Cases[] =
     { 0x7f3c14ffU, 0x40000000U, true, "        v_cvt_f16_f32   v158, "
                 "0x40000000 /* 2f */\n" },
     { 0x7f3c174fU, 0, false, "        v_cvt_f32_f16   v158, v79\n" },
-    { 0x7f3c16ffU, 0x3d4cU, true, "        v_cvt_f32_f16   v158, 0x3d4c /* 1.3242h */\n" },
+    { 0x7f3c16ffU, 0x3d4cU, true, "        v_cvt_f32_f16   v158, 0x3d4c /* 1.324h */\n" },
     { 0x7f3c194fU, 0, false, "        v_cvt_rpi_i32_f32 v158, v79\n" },
     { 0x7f3c18ffU, 0x40000000U, true, "        v_cvt_rpi_i32_f32 v158, "
                 "0x40000000 /* 2f */\n" },
@@ -818,34 +818,34 @@ const GCNDisasmOpcodeCase decGCNOpcodeGCN15Cases[] =
     { 0x7f3ca54fU, 0, false, "        v_cvt_u16_f16   v158, v79\n" },
     { 0x7f3ca74fU, 0, false, "        v_cvt_i16_f16   v158, v79\n" },
     { 0x7f3ca94fU, 0, false, "        v_rcp_f16       v158, v79\n" },
-    { 0x7f3ca8ffU, 0x3d4cU, true, "        v_rcp_f16       v158, 0x3d4c /* 1.3242h */\n" },
+    { 0x7f3ca8ffU, 0x3d4cU, true, "        v_rcp_f16       v158, 0x3d4c /* 1.324h */\n" },
     { 0x7f3cab4fU, 0, false, "        v_sqrt_f16      v158, v79\n" },
-    { 0x7f3caaffU, 0x3d4cU, true, "        v_sqrt_f16      v158, 0x3d4c /* 1.3242h */\n" },
+    { 0x7f3caaffU, 0x3d4cU, true, "        v_sqrt_f16      v158, 0x3d4c /* 1.324h */\n" },
     { 0x7f3cad4fU, 0, false, "        v_rsq_f16       v158, v79\n" },
-    { 0x7f3cacffU, 0x3d4cU, true, "        v_rsq_f16       v158, 0x3d4c /* 1.3242h */\n" },
+    { 0x7f3cacffU, 0x3d4cU, true, "        v_rsq_f16       v158, 0x3d4c /* 1.324h */\n" },
     { 0x7f3caf4fU, 0, false, "        v_log_f16       v158, v79\n" },
-    { 0x7f3caeffU, 0x3d4cU, true, "        v_log_f16       v158, 0x3d4c /* 1.3242h */\n" },
+    { 0x7f3caeffU, 0x3d4cU, true, "        v_log_f16       v158, 0x3d4c /* 1.324h */\n" },
     { 0x7f3cb14fU, 0, false, "        v_exp_f16       v158, v79\n" },
-    { 0x7f3cb0ffU, 0x3d4cU, true, "        v_exp_f16       v158, 0x3d4c /* 1.3242h */\n" },
+    { 0x7f3cb0ffU, 0x3d4cU, true, "        v_exp_f16       v158, 0x3d4c /* 1.324h */\n" },
     { 0x7f3cb34fU, 0, false, "        v_frexp_mant_f16 v158, v79\n" },
-    { 0x7f3cb2ffU, 0x3d4cU, true, "        v_frexp_mant_f16 v158, 0x3d4c /* 1.3242h */\n" },
+    { 0x7f3cb2ffU, 0x3d4cU, true, "        v_frexp_mant_f16 v158, 0x3d4c /* 1.324h */\n" },
     { 0x7f3cb54fU, 0, false, "        v_frexp_exp_i16_f16 v158, v79\n" },
     { 0x7f3cb4ffU, 0x3d4cU, true,
-        "        v_frexp_exp_i16_f16 v158, 0x3d4c /* 1.3242h */\n" },
+        "        v_frexp_exp_i16_f16 v158, 0x3d4c /* 1.324h */\n" },
     { 0x7f3cb74fU, 0, false, "        v_floor_f16     v158, v79\n" },
-    { 0x7f3cb6ffU, 0x3d4cU, true, "        v_floor_f16     v158, 0x3d4c /* 1.3242h */\n" },
+    { 0x7f3cb6ffU, 0x3d4cU, true, "        v_floor_f16     v158, 0x3d4c /* 1.324h */\n" },
     { 0x7f3cb94fU, 0, false, "        v_ceil_f16      v158, v79\n" },
-    { 0x7f3cb8ffU, 0x3d4cU, true, "        v_ceil_f16      v158, 0x3d4c /* 1.3242h */\n" },
+    { 0x7f3cb8ffU, 0x3d4cU, true, "        v_ceil_f16      v158, 0x3d4c /* 1.324h */\n" },
     { 0x7f3cbb4fU, 0, false, "        v_trunc_f16     v158, v79\n" },
-    { 0x7f3cbaffU, 0x3d4cU, true, "        v_trunc_f16     v158, 0x3d4c /* 1.3242h */\n" },
+    { 0x7f3cbaffU, 0x3d4cU, true, "        v_trunc_f16     v158, 0x3d4c /* 1.324h */\n" },
     { 0x7f3cbd4fU, 0, false, "        v_rndne_f16     v158, v79\n" },
-    { 0x7f3cbcffU, 0x3d4cU, true, "        v_rndne_f16     v158, 0x3d4c /* 1.3242h */\n" },
+    { 0x7f3cbcffU, 0x3d4cU, true, "        v_rndne_f16     v158, 0x3d4c /* 1.324h */\n" },
     { 0x7f3cbf4fU, 0, false, "        v_fract_f16     v158, v79\n" },
-    { 0x7f3cbeffU, 0x3d4cU, true, "        v_fract_f16     v158, 0x3d4c /* 1.3242h */\n" },
+    { 0x7f3cbeffU, 0x3d4cU, true, "        v_fract_f16     v158, 0x3d4c /* 1.324h */\n" },
     { 0x7f3cc14fU, 0, false, "        v_sin_f16       v158, v79\n" },
-    { 0x7f3cc0ffU, 0x3d4cU, true, "        v_sin_f16       v158, 0x3d4c /* 1.3242h */\n" },
+    { 0x7f3cc0ffU, 0x3d4cU, true, "        v_sin_f16       v158, 0x3d4c /* 1.324h */\n" },
     { 0x7f3cc34fU, 0, false, "        v_cos_f16       v158, v79\n" },
-    { 0x7f3cc2ffU, 0x3d4cU, true, "        v_cos_f16       v158, 0x3d4c /* 1.3242h */\n" },
+    { 0x7f3cc2ffU, 0x3d4cU, true, "        v_cos_f16       v158, 0x3d4c /* 1.324h */\n" },
     { 0x7f3cc54fU, 0, false, "        v_sat_pk_u8_i16 v158, v79\n" },
     { 0x7f3cc74fU, 0, false, "        v_cvt_norm_i16_f16 v158, v79\n" },
     { 0x7f3cc94fU, 0, false, "        v_cvt_norm_u16_f16 v158, v79\n" },
@@ -1079,7 +1079,7 @@ const GCNDisasmOpcodeCase decGCNOpcodeGCN15Cases[] =
     { 0x7d1d92ffU, 0x40000000U, true, "        v_cmp_ge_i16    vcc, 0x40000000, v201\n" },
     { 0x7d1f934fU, 0, false, "        v_cmp_class_f16 vcc, v79, v201\n" },
     { 0x7d1f92ffU, 0x3d4cU, true, "        v_cmp_class_f16 "
-                "vcc, 0x3d4c /* 1.3242h */, v201\n" },
+                "vcc, 0x3d4c /* 1.324h */, v201\n" },
     { 0x7d21934fU, 0, false, "        v_cmpx_f_i32    v79, v201\n" },
     { 0x7d2192ffU, 0x40000000U, true, "        v_cmpx_f_i32    0x40000000, v201\n" },
     { 0x7d23934fU, 0, false, "        v_cmpx_lt_i32   v79, v201\n" },
@@ -1112,7 +1112,7 @@ const GCNDisasmOpcodeCase decGCNOpcodeGCN15Cases[] =
     { 0x7d3d934fU, 0, false, "        v_cmpx_ge_i16   v79, v201\n" },
     { 0x7d3d92ffU, 0x40000000U, true, "        v_cmpx_ge_i16   0x40000000, v201\n" },
     { 0x7d3f934fU, 0, false, "        v_cmpx_class_f16 v79, v201\n" },
-    { 0x7d3f92ffU, 0x3d4cU, true, "        v_cmpx_class_f16 0x3d4c /* 1.3242h */, v201\n" },
+    { 0x7d3f92ffU, 0x3d4cU, true, "        v_cmpx_class_f16 0x3d4c /* 1.324h */, v201\n" },
     { 0x7d41934fU, 0, false, "        v_cmp_f_i64     vcc, v[79:80], v[201:202]\n" },
     { 0x7d4192ffU, 0x40000000U, true, "        v_cmp_f_i64     "
                 "vcc, 0x40000000, v[201:202]\n" },
@@ -1203,28 +1203,28 @@ const GCNDisasmOpcodeCase decGCNOpcodeGCN15Cases[] =
     { 0x7d8f92ffU, 0x40000000U, true, "        v_cmp_tru_u32   vcc, 0x40000000, v201\n" },
     { 0x7d91934fU, 0, false, "        v_cmp_f_f16     vcc, v79, v201\n" },
     { 0x7d9192ffU, 0x3d4cU, true, "        v_cmp_f_f16     "
-                "vcc, 0x3d4c /* 1.3242h */, v201\n" },
+                "vcc, 0x3d4c /* 1.324h */, v201\n" },
     { 0x7d93934fU, 0, false, "        v_cmp_lt_f16    vcc, v79, v201\n" },
     { 0x7d9392ffU, 0x3d4cU, true, "        v_cmp_lt_f16    "
-                "vcc, 0x3d4c /* 1.3242h */, v201\n" },
+                "vcc, 0x3d4c /* 1.324h */, v201\n" },
     { 0x7d95934fU, 0, false, "        v_cmp_eq_f16    vcc, v79, v201\n" },
     { 0x7d9592ffU, 0x3d4cU, true, "        v_cmp_eq_f16    "
-                "vcc, 0x3d4c /* 1.3242h */, v201\n" },
+                "vcc, 0x3d4c /* 1.324h */, v201\n" },
     { 0x7d97934fU, 0, false, "        v_cmp_le_f16    vcc, v79, v201\n" },
     { 0x7d9792ffU, 0x3d4cU, true, "        v_cmp_le_f16    "
-                "vcc, 0x3d4c /* 1.3242h */, v201\n" },
+                "vcc, 0x3d4c /* 1.324h */, v201\n" },
     { 0x7d99934fU, 0, false, "        v_cmp_gt_f16    vcc, v79, v201\n" },
     { 0x7d9992ffU, 0x3d4cU, true, "        v_cmp_gt_f16    "
-                "vcc, 0x3d4c /* 1.3242h */, v201\n" },
+                "vcc, 0x3d4c /* 1.324h */, v201\n" },
     { 0x7d9b934fU, 0, false, "        v_cmp_lg_f16    vcc, v79, v201\n" },
     { 0x7d9b92ffU, 0x3d4cU, true, "        v_cmp_lg_f16    "
-                "vcc, 0x3d4c /* 1.3242h */, v201\n" },
+                "vcc, 0x3d4c /* 1.324h */, v201\n" },
     { 0x7d9d934fU, 0, false, "        v_cmp_ge_f16    vcc, v79, v201\n" },
     { 0x7d9d92ffU, 0x3d4cU, true, "        v_cmp_ge_f16    "
-                "vcc, 0x3d4c /* 1.3242h */, v201\n" },
+                "vcc, 0x3d4c /* 1.324h */, v201\n" },
     { 0x7d9f934fU, 0, false, "        v_cmp_o_f16     vcc, v79, v201\n" },
     { 0x7d9f92ffU, 0x3d4cU, true, "        v_cmp_o_f16     "
-                "vcc, 0x3d4c /* 1.3242h */, v201\n" },
+                "vcc, 0x3d4c /* 1.324h */, v201\n" },
     { 0x7da1934fU, 0, false, "        v_cmpx_f_u32    v79, v201\n" },
     { 0x7da192ffU, 0x40000000U, true, "        v_cmpx_f_u32    0x40000000, v201\n" },
     { 0x7da3934fU, 0, false, "        v_cmpx_lt_u32   v79, v201\n" },
@@ -1242,21 +1242,21 @@ const GCNDisasmOpcodeCase decGCNOpcodeGCN15Cases[] =
     { 0x7daf934fU, 0, false, "        v_cmpx_tru_u32  v79, v201\n" },
     { 0x7daf92ffU, 0x40000000U, true, "        v_cmpx_tru_u32  0x40000000, v201\n" },
     { 0x7db1934fU, 0, false, "        v_cmpx_f_f16    v79, v201\n" },
-    { 0x7db192ffU, 0x3d4cU, true, "        v_cmpx_f_f16    0x3d4c /* 1.3242h */, v201\n" },
+    { 0x7db192ffU, 0x3d4cU, true, "        v_cmpx_f_f16    0x3d4c /* 1.324h */, v201\n" },
     { 0x7db3934fU, 0, false, "        v_cmpx_lt_f16   v79, v201\n" },
-    { 0x7db392ffU, 0x3d4cU, true, "        v_cmpx_lt_f16   0x3d4c /* 1.3242h */, v201\n" },
+    { 0x7db392ffU, 0x3d4cU, true, "        v_cmpx_lt_f16   0x3d4c /* 1.324h */, v201\n" },
     { 0x7db5934fU, 0, false, "        v_cmpx_eq_f16   v79, v201\n" },
-    { 0x7db592ffU, 0x3d4cU, true, "        v_cmpx_eq_f16   0x3d4c /* 1.3242h */, v201\n" },
+    { 0x7db592ffU, 0x3d4cU, true, "        v_cmpx_eq_f16   0x3d4c /* 1.324h */, v201\n" },
     { 0x7db7934fU, 0, false, "        v_cmpx_le_f16   v79, v201\n" },
-    { 0x7db792ffU, 0x3d4cU, true, "        v_cmpx_le_f16   0x3d4c /* 1.3242h */, v201\n" },
+    { 0x7db792ffU, 0x3d4cU, true, "        v_cmpx_le_f16   0x3d4c /* 1.324h */, v201\n" },
     { 0x7db9934fU, 0, false, "        v_cmpx_gt_f16   v79, v201\n" },
-    { 0x7db992ffU, 0x3d4cU, true, "        v_cmpx_gt_f16   0x3d4c /* 1.3242h */, v201\n" },
+    { 0x7db992ffU, 0x3d4cU, true, "        v_cmpx_gt_f16   0x3d4c /* 1.324h */, v201\n" },
     { 0x7dbb934fU, 0, false, "        v_cmpx_lg_f16   v79, v201\n" },
-    { 0x7dbb92ffU, 0x3d4cU, true, "        v_cmpx_lg_f16   0x3d4c /* 1.3242h */, v201\n" },
+    { 0x7dbb92ffU, 0x3d4cU, true, "        v_cmpx_lg_f16   0x3d4c /* 1.324h */, v201\n" },
     { 0x7dbd934fU, 0, false, "        v_cmpx_ge_f16   v79, v201\n" },
-    { 0x7dbd92ffU, 0x3d4cU, true, "        v_cmpx_ge_f16   0x3d4c /* 1.3242h */, v201\n" },
+    { 0x7dbd92ffU, 0x3d4cU, true, "        v_cmpx_ge_f16   0x3d4c /* 1.324h */, v201\n" },
     { 0x7dbf934fU, 0, false, "        v_cmpx_o_f16    v79, v201\n" },
-    { 0x7dbf92ffU, 0x3d4cU, true, "        v_cmpx_o_f16    0x3d4c /* 1.3242h */, v201\n" },
+    { 0x7dbf92ffU, 0x3d4cU, true, "        v_cmpx_o_f16    0x3d4c /* 1.324h */, v201\n" },
     { 0x7dc1934fU, 0, false, "        v_cmp_f_u64     vcc, v[79:80], v[201:202]\n" },
     { 0x7dc192ffU, 0x40000000U, true, "        v_cmp_f_u64     "
                 "vcc, 0x40000000, v[201:202]\n" },
@@ -1283,28 +1283,28 @@ const GCNDisasmOpcodeCase decGCNOpcodeGCN15Cases[] =
                 "vcc, 0x40000000, v[201:202]\n" },
     { 0x7dd1934fU, 0, false, "        v_cmp_u_f16     vcc, v79, v201\n" },
     { 0x7dd192ffU, 0x3d4cU, true, "        v_cmp_u_f16     "
-                "vcc, 0x3d4c /* 1.3242h */, v201\n" },
+                "vcc, 0x3d4c /* 1.324h */, v201\n" },
     { 0x7dd3934fU, 0, false, "        v_cmp_nge_f16   vcc, v79, v201\n" },
     { 0x7dd392ffU, 0x3d4cU, true, "        v_cmp_nge_f16   "
-                "vcc, 0x3d4c /* 1.3242h */, v201\n" },
+                "vcc, 0x3d4c /* 1.324h */, v201\n" },
     { 0x7dd5934fU, 0, false, "        v_cmp_nlg_f16   vcc, v79, v201\n" },
     { 0x7dd592ffU, 0x3d4cU, true, "        v_cmp_nlg_f16   "
-                "vcc, 0x3d4c /* 1.3242h */, v201\n" },
+                "vcc, 0x3d4c /* 1.324h */, v201\n" },
     { 0x7dd7934fU, 0, false, "        v_cmp_ngt_f16   vcc, v79, v201\n" },
     { 0x7dd792ffU, 0x3d4cU, true, "        v_cmp_ngt_f16   "
-                "vcc, 0x3d4c /* 1.3242h */, v201\n" },
+                "vcc, 0x3d4c /* 1.324h */, v201\n" },
     { 0x7dd9934fU, 0, false, "        v_cmp_nle_f16   vcc, v79, v201\n" },
     { 0x7dd992ffU, 0x3d4cU, true, "        v_cmp_nle_f16   "
-                "vcc, 0x3d4c /* 1.3242h */, v201\n" },
+                "vcc, 0x3d4c /* 1.324h */, v201\n" },
     { 0x7ddb934fU, 0, false, "        v_cmp_neq_f16   vcc, v79, v201\n" },
     { 0x7ddb92ffU, 0x3d4cU, true, "        v_cmp_neq_f16   "
-                "vcc, 0x3d4c /* 1.3242h */, v201\n" },
+                "vcc, 0x3d4c /* 1.324h */, v201\n" },
     { 0x7ddd934fU, 0, false, "        v_cmp_nlt_f16   vcc, v79, v201\n" },
     { 0x7ddd92ffU, 0x3d4cU, true, "        v_cmp_nlt_f16   "
-                "vcc, 0x3d4c /* 1.3242h */, v201\n" },
+                "vcc, 0x3d4c /* 1.324h */, v201\n" },
     { 0x7ddf934fU, 0, false, "        v_cmp_tru_f16   vcc, v79, v201\n" },
     { 0x7ddf92ffU, 0x3d4cU, true, "        v_cmp_tru_f16   "
-                "vcc, 0x3d4c /* 1.3242h */, v201\n" },
+                "vcc, 0x3d4c /* 1.324h */, v201\n" },
     { 0x7de1934fU, 0, false, "        v_cmpx_f_u64    v[79:80], v[201:202]\n" },
     { 0x7de192ffU, 0x40000000U, true, "        v_cmpx_f_u64    "
                 "0x40000000, v[201:202]\n" },
@@ -1330,21 +1330,21 @@ const GCNDisasmOpcodeCase decGCNOpcodeGCN15Cases[] =
     { 0x7def92ffU, 0x40000000U, true, "        v_cmpx_tru_u64  "
                 "0x40000000, v[201:202]\n" },
     { 0x7df1934fU, 0, false, "        v_cmpx_u_f16    v79, v201\n" },
-    { 0x7df192ffU, 0x3d4cU, true, "        v_cmpx_u_f16    0x3d4c /* 1.3242h */, v201\n" },
+    { 0x7df192ffU, 0x3d4cU, true, "        v_cmpx_u_f16    0x3d4c /* 1.324h */, v201\n" },
     { 0x7df3934fU, 0, false, "        v_cmpx_nge_f16  v79, v201\n" },
-    { 0x7df392ffU, 0x3d4cU, true, "        v_cmpx_nge_f16  0x3d4c /* 1.3242h */, v201\n" },
+    { 0x7df392ffU, 0x3d4cU, true, "        v_cmpx_nge_f16  0x3d4c /* 1.324h */, v201\n" },
     { 0x7df5934fU, 0, false, "        v_cmpx_nlg_f16  v79, v201\n" },
-    { 0x7df592ffU, 0x3d4cU, true, "        v_cmpx_nlg_f16  0x3d4c /* 1.3242h */, v201\n" },
+    { 0x7df592ffU, 0x3d4cU, true, "        v_cmpx_nlg_f16  0x3d4c /* 1.324h */, v201\n" },
     { 0x7df7934fU, 0, false, "        v_cmpx_ngt_f16  v79, v201\n" },
-    { 0x7df792ffU, 0x3d4cU, true, "        v_cmpx_ngt_f16  0x3d4c /* 1.3242h */, v201\n" },
+    { 0x7df792ffU, 0x3d4cU, true, "        v_cmpx_ngt_f16  0x3d4c /* 1.324h */, v201\n" },
     { 0x7df9934fU, 0, false, "        v_cmpx_nle_f16  v79, v201\n" },
-    { 0x7df992ffU, 0x3d4cU, true, "        v_cmpx_nle_f16  0x3d4c /* 1.3242h */, v201\n" },
+    { 0x7df992ffU, 0x3d4cU, true, "        v_cmpx_nle_f16  0x3d4c /* 1.324h */, v201\n" },
     { 0x7dfb934fU, 0, false, "        v_cmpx_neq_f16  v79, v201\n" },
-    { 0x7dfb92ffU, 0x3d4cU, true, "        v_cmpx_neq_f16  0x3d4c /* 1.3242h */, v201\n" },
+    { 0x7dfb92ffU, 0x3d4cU, true, "        v_cmpx_neq_f16  0x3d4c /* 1.324h */, v201\n" },
     { 0x7dfd934fU, 0, false, "        v_cmpx_nlt_f16  v79, v201\n" },
-    { 0x7dfd92ffU, 0x3d4cU, true, "        v_cmpx_nlt_f16  0x3d4c /* 1.3242h */, v201\n" },
+    { 0x7dfd92ffU, 0x3d4cU, true, "        v_cmpx_nlt_f16  0x3d4c /* 1.324h */, v201\n" },
     { 0x7dff934fU, 0, false, "        v_cmpx_tru_f16  v79, v201\n" },
-    { 0x7dff92ffU, 0x3d4cU, true, "        v_cmpx_tru_f16  0x3d4c /* 1.3242h */, v201\n" },
+    { 0x7dff92ffU, 0x3d4cU, true, "        v_cmpx_tru_f16  0x3d4c /* 1.324h */, v201\n" },
     /* VOP_SDWA encoding */
     { 0x0334d6f9U, 0, true, "        v_cndmask_b32   v154, v0, v107, vcc "
         "dst_sel:byte0 src0_sel:byte0 src1_sel:byte0\n" },
@@ -4018,6 +4018,13 @@ const GCNDisasmOpcodeCase2 decGCNOpcodeGCN15Cases2[] =
         "[v121,v44,v212], s[84:91] dmask:15 dim:3d unorm glc slc d16\n" },
     { { 0xf2003f14U, 0x80159d79U, 0x0000d42cU, 0 }, 4, "        image_load      v[157:158], "
         "[v121,v44,v212], s[84:91] dmask:15 dim:3d unorm glc slc d16\n" },
+    /* MIMG followed by next instruction */
+    { { 0xf2003f10U, 0x80159d79U, 0xbf800000U }, 3, "        image_load      v[157:158], "
+        "v[121:123], s[84:91] dmask:15 dim:3d unorm glc slc d16\n"
+        "        s_nop           0x0\n" },
+    { { 0xf2003f12U, 0x80159d79U, 0x0000d42cU, 0xbf800000U }, 4,
+        "        image_load      v[157:158], [v121,v44,v212], s[84:91] "
+        "dmask:15 dim:3d unorm glc slc d16\n        s_nop           0x0\n" },
     { { 0xf2903b12U, 0x02759d79U, 0x005b492cU }, 3, "        image_sample_l  v[157:159], "
         "[v121,v44,v73,v91], s[84:91], s[76:79] dmask:11 dim:3d unorm glc slc\n" },
     { { 0xf2983b12U, 0x02759d79U, 0x615b492cU }, 3, "        image_sample_b_cl v[157:159], "
@@ -4045,11 +4052,11 @@ const GCNDisasmOpcodeCase2 decGCNOpcodeGCN15Cases2[] =
     { { 0xd5510037U, 0x03ff4d7aU, 0x567d0700U }, 3, "        v_min3_f32      "
         "v55, v122, v166, 0x567d0700 /* 6.9551627e+13f */\n" },
     { { 0xd7570037U, 0x07974cffU, 0x3d4c }, 3, "        v_med3_f16      "
-        "v55, 0x3d4c /* 1.3242h */, v166, v229\n" },
+        "v55, 0x3d4c /* 1.324h */, v166, v229\n" },
     { { 0xd7570037U, 0x0795ffb4U, 0x3d4c }, 3, "        v_med3_f16      "
-        "v55, v180, 0x3d4c /* 1.3242h */, v229\n" },
+        "v55, v180, 0x3d4c /* 1.324h */, v229\n" },
     { { 0xd7570037U, 0x03ff4c47U, 0x3d4c }, 3, "        v_med3_f16      "
-        "v55, s71, v166, 0x3d4c /* 1.3242h */\n" },
+        "v55, s71, v166, 0x3d4c /* 1.324h */\n" },
     { { 0xd5480037U, 0x07974cffU, 0x38c95d9a }, 3, "        v_bfe_u32       "
         "v55, 0x38c95d9a, v166, v229\n" },
     { { 0xd5480037U, 0x0795ff1fU, 0x38c95d9a }, 3, "        v_bfe_u32       "
@@ -4059,11 +4066,11 @@ const GCNDisasmOpcodeCase2 decGCNOpcodeGCN15Cases2[] =
     { { 0xd5480037U, 0x0795ff1fU, 17 }, 3, "        v_bfe_u32       "
         "v55, v31, lit(17), v229\n" },
     { { 0xd5510037U, 0x0795ff6bU, 19 }, 3, "        v_min3_f32      "
-        "v55, v107, lit(19) /* 2.66e-44f */, v229\n" },
+        "v55, v107, lit(19) /* 2.7e-44f */, v229\n" },
     { { 0xd743002aU, 0x0075ffa7U, 0x4689dc }, 3, "        v_interp_p1lv_f16 "
-        "v42, 0x4689dc /* -0.00017881h */, attr39.z, s29 high\n" },
+        "v42, 0x4689dc /* -0.0001788h */, attr39.z, s29 high\n" },
     { { 0xd743002aU, 0x03fc03a7U, 0x4689dc }, 3, "        v_interp_p1lv_f16 "
-        "v42, s1, attr39.z, 0x4689dc /* -0.00017881h */ high\n" },
+        "v42, s1, attr39.z, 0x4689dc /* -0.0001788h */ high\n" },
     { { 0xd4c20007U, 0x00000effU, 0x105b0a1U }, 3,
         "        v_cmp_eq_u32    s[7:8], 0x105b0a1, s7\n" },
     { { 0xd400002aU, 0x0001feffU, 0x1452 }, 3, "        v_cmp_f_f32     "
@@ -4071,11 +4078,11 @@ const GCNDisasmOpcodeCase2 decGCNOpcodeGCN15Cases2[] =
     { { 0xd40000ffU, 0x0001feffU, 0x1452 }, 3, "        v_cmp_f_f32     "
         "0x0, 0x1452 /* 7.29e-42f */, 0x1452 /* 7.29e-42f */\n" },
     { { 0xcc0e0037U, 0x07974cffU, 0x3d4c }, 3, "        v_pk_fma_f16    "
-        "v55, 0x3d4c /* 1.3242h */, v166, v229 op_sel_hi:[0,0,0]\n" },
+        "v55, 0x3d4c /* 1.324h */, v166, v229 op_sel_hi:[0,0,0]\n" },
     { { 0xcc0e0037U, 0x0795ffb4U, 0x3d4c }, 3, "        v_pk_fma_f16    "
-        "v55, v180, 0x3d4c /* 1.3242h */, v229 op_sel_hi:[0,0,0]\n" },
+        "v55, v180, 0x3d4c /* 1.324h */, v229 op_sel_hi:[0,0,0]\n" },
     { { 0xcc0e0037U, 0x03ff4c47U, 0x3d4c }, 3, "        v_pk_fma_f16    "
-        "v55, s71, v166, 0x3d4c /* 1.3242h */ op_sel_hi:[0,0,0]\n" },
+        "v55, s71, v166, 0x3d4c /* 1.324h */ op_sel_hi:[0,0,0]\n" },
     { {}, 0, nullptr }
 };
 
@@ -0,0 +1,55 @@
+/*
+ *  CLRadeonExtender - Unofficial OpenCL Radeon Extensions Library
+ *  Copyright (C) 2014-2018 Mateusz Szpakowski
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef __CLRXTEST_GCNWAITHANDLE_H__
+#define __CLRXTEST_GCNWAITHANDLE_H__
+
+#include <CLRX/Config.h>
+#include <CLRX/utils/Utilities.h>
+#include <CLRX/amdasm/Assembler.h>
+#include <CLRX/utils/Containers.h>
+#include <CLRX/amdasm/GCNDefs.h>
+
+using namespace CLRX;
+
+struct AsmDelayedOpData
+{
+    size_t offset;
+    const char* regVarName;
+    uint16_t rstart;
+    uint16_t rend;
+    cxbyte count;
+    cxbyte delayedOpType;
+    cxbyte delayedOpType2;
+    cxbyte rwFlags;
+    cxbyte rwFlags2;
+};
+
+struct AsmWaitHandlerCase
+{
+    const char* input;
+    Array<AsmWaitInstr> waitInstrs;
+    Array<AsmDelayedOpData> delayedOps;
+    bool good;
+    const char* errorMessages;
+};
+
+extern const AsmWaitHandlerCase waitHandlerTestCasesTbl[];
+
+#endif
@@ -0,0 +1,663 @@
+/*
+ *  CLRadeonExtender - Unofficial OpenCL Radeon Extensions Library
+ *  Copyright (C) 2014-2018 Mateusz Szpakowski
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <CLRX/Config.h>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <CLRX/utils/Utilities.h>
+#include <CLRX/amdasm/Assembler.h>
+#include <CLRX/utils/Containers.h>
+#include "../TestUtils.h"
+#include "GCNWaitHandle.h"
+
+using namespace CLRX;
+
+struct AsmWaitScheduleCase
+{
+    const char* input;
+    bool sinkWaits;
+    Array<AsmWaitInstr> waitInstrs; // needed wait instructions
+};
+
+static const AsmWaitScheduleCase waitScheduleTestCases[] =
+{
+    {   /* 0 - sink waits to first use */
+        R"ffDXD(
+            s_load_dword s2, s[10:11], 4
+            buffer_load_dword v4, v1, s[12:15], 0 offen
+            s_waitcnt vmcnt(0) & lgkmcnt(0)
+            v_mov_b32 v2, v3
+            v_add_f32 v5, v4, v4
+            s_add_u32 s5, s2, s2
+            s_endpgm
+)ffDXD",
+        true,
+        {
+            { 20U, { 0, 7, 7, 0 } },
+            { 24U, { 15, 0, 7, 0 } }
+        }
+    },
+    {   /* 1 - keep existing waits */
+        R"ffDXD(
+            s_load_dword s2, s[10:11], 4
+            buffer_load_dword v4, v1, s[12:15], 0 offen
+            s_waitcnt vmcnt(0) & lgkmcnt(0)
+            v_mov_b32 v2, v3
+            v_add_f32 v5, v4, v4
+            s_add_u32 s5, s2, s2
+            s_endpgm
+)ffDXD",
+        false,
+        {
+            { 12U, { 0, 0, 7, 0 } }
+        }
+    },
+    {   /* 2 - merge waits for different counters */
+        R"ffDXD(
+            s_load_dword s2, s[10:11], 4
+            buffer_load_dword v4, v1, s[12:15], 0 offen
+            v_mov_b32 v2, v3
+            v_add_f32 v5, s2, v4
+            s_endpgm
+)ffDXD",
+        true,
+        {
+            { 16U, { 0, 0, 7, 0 } }
+        }
+    },
+    {   /* 3 - ordered queue - wait only for first load */
+        R"ffDXD(
+            buffer_load_dword v4, v1, s[12:15], 0 offen
+            buffer_load_dword v5, v1, s[12:15], 0 offen offset:4
+            v_mov_b32 v2, v3
+            v_add_f32 v6, v4, v4
+            v_add_f32 v7, v5, v5
+            s_endpgm
+)ffDXD",
+        true,
+        {
+            { 20U, { 1, 7, 7, 0 } },
+            { 24U, { 0, 7, 7, 0 } }
+        }
+    },
+    {   /* 4 - overwrite register of pending load */
+        R"ffDXD(
+            buffer_load_dword v4, v1, s[12:15], 0 offen
+            v_mov_b32 v2, v3
+            v_mov_b32 v4, v3
+            s_endpgm
+)ffDXD",
+        true,
+        {
+            { 12U, { 0, 7, 7, 0 } }
+        }
+    },
+    {   /* 5 - waits across code blocks and in loop */
+        R"ffDXD(
+            buffer_load_dword v4, v1, s[12:15], 0 offen
+            s_mov_b32 s5, 0
+loop:       s_add_u32 s5, s5, 1
+            v_add_f32 v6, v4, v4
+            buffer_load_dword v7, v1, s[12:15], 0 offen
+            s_cmp_lt_u32 s5, 10
+            s_cbranch_scc1 loop
+            v_mov_b32 v2, v3
+            v_mov_b32 v8, v7
+            s_endpgm
+)ffDXD",
+        true,
+        {
+            { 16U, { 0, 7, 7, 0 } },
+            { 40U, { 0, 7, 7, 0 } }
+        }
+    },
+    {   /* 6 - wait in previous block already done */
+        R"ffDXD(
+            buffer_load_dword v4, v1, s[12:15], 0 offen
+            v_add_f32 v6, v4, v4
+            s_cbranch_scc1 aa0
+            v_mov_b32 v2, v3
+aa0:        v_mov_b32 v8, v4
+            s_endpgm
+)ffDXD",
+        true,
+        {
+            { 8U, { 0, 7, 7, 0 } }
+        }
+    },
+    {   /* 7 - wait at start of loop for load from previous iteration */
+        R"ffDXD(
+            s_mov_b32 s5, 0
+            v_mov_b32 v7, 0
+loop:       v_add_f32 v6, v7, v7
+            buffer_load_dword v7, v1, s[12:15], 0 offen
+            s_add_u32 s5, s5, 1
+            s_cmp_lt_u32 s5, 10
+            s_cbranch_scc1 loop
+            s_endpgm
+)ffDXD",
+        true,
+        {
+            { 8U, { 0, 7, 7, 0 } }
+        }
+    },
+    {   /* 8 - nested loops - load in inner loop used in next outer iteration */
+        R"ffDXD(
+            s_mov_b32 s5, 0
+            v_mov_b32 v7, 0
+outer:      v_add_f32 v6, v7, v7
+            s_mov_b32 s6, 0
+inner:      buffer_load_dword v7, v1, s[12:15], 0 offen
+            buffer_load_dword v8, v1, s[12:15], 0 offen offset:4
+            s_add_u32 s6, s6, 1
+            s_cmp_lt_u32 s6, 10
+            s_cbranch_scc1 inner
+            s_add_u32 s5, s5, 1
+            s_cmp_lt_u32 s5, 10
+            s_cbranch_scc1 outer
+            v_mov_b32 v2, v8
+            s_endpgm
+)ffDXD",
+        true,
+        {
+            { 8U, { 1, 7, 7, 0 } },
+            { 16U, { 1, 7, 7, 0 } },
+            { 24U, { 1, 7, 7, 0 } },
+            { 56U, { 0, 7, 7, 0 } }
+        }
+    },
+    {   /* 9 - three nested loops - many loads in innermost loop */
+        R"ffDXD(
+            s_mov_b32 s4, 0
+            buffer_load_dword v4, v1, s[12:15], 0 offen
+loop0:      v_add_f32 v6, v4, v4
+            s_mov_b32 s5, 0
+loop1:      s_mov_b32 s6, 0
+loop2:      buffer_load_dword v7, v1, s[12:15], 0 offen
+            buffer_load_dword v8, v1, s[12:15], 0 offen offset:4
+            buffer_load_dword v9, v1, s[12:15], 0 offen offset:8
+            s_add_u32 s6, s6, 1
+            s_cmp_lt_u32 s6, 10
+            s_cbranch_scc1 loop2
+            buffer_load_dword v4, v1, s[12:15], 0 offen offset:12
+            s_add_u32 s5, s5, 1
+            s_cmp_lt_u32 s5, 10
+            s_cbranch_scc1 loop1
+            v_add_f32 v10, v7, v7
+            s_add_u32 s4, s4, 1
+            s_cmp_lt_u32 s4, 10
+            s_cbranch_scc1 loop0
+            s_endpgm
+)ffDXD",
+        true,
+        {
+            { 12U, { 0, 7, 7, 0 } },
+            { 24U, { 2, 7, 7, 0 } },
+            { 32U, { 2, 7, 7, 0 } },
+            { 40U, { 2, 7, 7, 0 } },
+            { 80U, { 3, 7, 7, 0 } }
+        }
+    },
+    {   /* 10 - nested loops - loads in inner and outer loop */
+        R"ffDXD(
+            buffer_load_dword v4, v1, s[12:15], 0 offen
+loop0:      buffer_load_dword v5, v1, s[12:15], 0 offen
+loop:       buffer_load_dword v7, v1, s[12:15], 0 offen
+            s_cbranch_scc1 loop
+            buffer_load_dword v8, v1, s[12:15], 0 offen
+            s_cbranch_scc0 loop0
+            v_add_f32 v6, v4, v4
+            v_add_f32 v6, v5, v5
+            s_endpgm
+)ffDXD",
+        true,
+        {
+            { 8U, { 2, 7, 7, 0 } },
+            { 16U, { 0, 7, 7, 0 } },
+            { 40U, { 3, 7, 7, 0 } },
+            { 44U, { 2, 7, 7, 0 } }
+        }
+    },
+    {   /* 11 - merge needed wait with user wait before instruction */
+        R"ffDXD(
+            s_load_dword s2, s[10:11], 4
+            buffer_load_dword v4, v1, s[12:15], 0 offen
+            s_waitcnt lgkmcnt(0)
+            v_add_f32 v5, s2, v4
+            s_endpgm
+)ffDXD",
+        false,
+        {
+            { 12U, { 0, 0, 7, 0 } }
+        }
+    },
+    {   /* 12 - do not merge with user wait if other instruction between */
+        R"ffDXD(
+            s_load_dword s2, s[10:11], 4
+            buffer_load_dword v4, v1, s[12:15], 0 offen
+            s_waitcnt lgkmcnt(0)
+            s_add_u32 s3, s2, s2
+            v_add_f32 v5, s2, v4
+            s_endpgm
+)ffDXD",
+        false,
+        {
+            { 12U, { 15, 0, 7, 0 } },
+            { 20U, { 0, 7, 7, 0 } }
+        }
+    }
+};
+
+static void testWaitScheduleCase(cxuint i, const AsmWaitScheduleCase& testCase)
+{
+    std::istringstream input(testCase.input);
+    std::ostringstream errorStream;
+
+    Assembler assembler("test.s", input,
+                    (ASM_ALL&~ASM_ALTMACRO) | ASM_TESTRUN | ASM_TESTRESOLVE,
+                    BinaryFormat::RAWCODE, GPUDeviceType::CAPE_VERDE, errorStream);
+    bool good = assembler.assemble();
+    std::ostringstream oss;
+    oss << " testWaitScheduleCase#" << i;
+    const std::string testCaseName = oss.str();
+    if (!good)
+    {
+        std::cerr << errorStream.str();
+        throw Exception(testCaseName+". Can't assemble");
+    }
+    if (assembler.getSections().size()<1)
+        throw Exception(testCaseName+". No sections");
+    const AsmSection& section = assembler.getSections()[0];
+
+    AsmRegAllocator regAlloc(assembler);
+    regAlloc.createCodeStructure(section.codeFlow, section.getSize(),
+                            section.content.data());
+    regAlloc.createSSAData(*section.usageHandler, *section.linearDepHandler);
+
+    AsmWaitScheduler waitScheduler(assembler.getISAAssembler()->getWaitConfig(),
+                assembler, regAlloc.getCodeBlocks(), regAlloc.getVregIndexMaps(),
+                nullptr, false);
+    waitScheduler.setSinkWaits(testCase.sinkWaits);
+    waitScheduler.schedule(*section.usageHandler, *section.waitHandler);
+
+    const std::vector<AsmWaitInstr>& resWaitInstrs = waitScheduler.getNeededWaitInstrs();
+    assertValue("testWaitSchedule", testCaseName + ".waitInstrsSize",
+                testCase.waitInstrs.size(), resWaitInstrs.size());
+    for (size_t j = 0; j < resWaitInstrs.size(); j++)
+    {
+        std::ostringstream woss;
+        woss << "waitInstr#" << j;
+        const std::string wiName = woss.str();
+        const AsmWaitInstr& expWaitInstr = testCase.waitInstrs[j];
+        const AsmWaitInstr& resWaitInstr = resWaitInstrs[j];
+        assertValue("testWaitSchedule", testCaseName + wiName + ".offset",
+                    expWaitInstr.offset, resWaitInstr.offset);
+        for (cxuint k = 0; k < 3; k++)
+        {
+            std::ostringstream kss;
+            kss << ".waits[" << k << "]";
+            assertValue("testWaitSchedule", testCaseName + wiName + kss.str(),
+                    expWaitInstr.waits[k], resWaitInstr.waits[k]);
+        }
+    }
+}
+
+/* needed wait instructions (without sink mode) for code from wait handler test cases
+ * (after register allocation) - indexed by wait handler test case */
+static const Array<AsmWaitInstr> waitHandlerScheduleResults[] =
+{
+    { },  // 0
+    {   // 1
+        { 12U, { 15, 0, 7, 0 } }
+    },
+    {   // 2
+        { 0U, { 3, 5, 4, 0 } },
+        { 4U, { 3, 5, 7, 0 } },
+        { 8U, { 3, 15, 7, 0 } },
+        { 12U, { 15, 15, 3, 0 } },
+        { 16U, { 15, 3, 7, 0 } },
+        { 20U, { 3, 15, 4, 0 } },
+        { 24U, { 15, 3, 4, 0 } },
+        { 32U, { 15, 11, 7, 0 } }
+    },
+    {   // 3
+        { 0U, { 3, 5, 4, 0 } },
+        { 4U, { 3, 5, 7, 0 } },
+        { 8U, { 3, 7, 7, 0 } },
+        { 12U, { 15, 7, 3, 0 } },
+        { 16U, { 15, 3, 7, 0 } },
+        { 20U, { 3, 7, 4, 0 } },
+        { 24U, { 15, 3, 4, 0 } }
+    },
+    {   // 4
+        { 0U, { 47, 5, 4, 0 } },
+        { 4U, { 63, 5, 7, 0 } }
+    },
+    {   // 5
+        { 4U, { 15, 0, 7, 0 } },
+        { 8U, { 15, 0, 7, 0 } },
+        { 12U, { 15, 0, 7, 0 } },
+        { 16U, { 15, 0, 7, 0 } },
+        { 20U, { 15, 0, 7, 0 } },
+        { 24U, { 15, 0, 7, 0 } },
+        { 28U, { 15, 0, 7, 0 } },
+        { 32U, { 15, 0, 7, 0 } },
+        { 36U, { 15, 0, 7, 0 } },
+        { 40U, { 15, 0, 7, 0 } }
+    },
+    {   // 6
+        { 8U, { 15, 0, 7, 0 } },
+        { 16U, { 15, 0, 7, 0 } },
+        { 24U, { 15, 0, 7, 0 } },
+        { 32U, { 15, 0, 7, 0 } },
+        { 40U, { 15, 0, 7, 0 } },
+        { 56U, { 15, 0, 7, 0 } },
+        { 72U, { 15, 0, 7, 0 } },
+        { 80U, { 15, 0, 7, 0 } },
+        { 88U, { 15, 0, 7, 0 } },
+        { 104U, { 15, 0, 7, 0 } }
+    },
+    {   // 7
+        { 64U, { 63, 0, 7, 0 } },
+        { 88U, { 63, 0, 7, 0 } },
+        { 104U, { 63, 0, 7, 0 } },
+        { 160U, { 63, 0, 7, 0 } },
+        { 184U, { 63, 0, 7, 0 } }
+    },
+    { },  // 8
+    {   // 9
+        { 16U, { 15, 1, 7, 0 } },
+        { 24U, { 15, 0, 7, 0 } },
+        { 40U, { 15, 0, 7, 0 } },
+        { 56U, { 15, 0, 7, 0 } },
+        { 72U, { 15, 0, 7, 0 } },
+        { 88U, { 15, 0, 7, 0 } },
+        { 144U, { 15, 0, 7, 0 } },
+        { 176U, { 15, 0, 7, 0 } },
+        { 192U, { 15, 1, 7, 0 } },
+        { 200U, { 15, 0, 7, 0 } },
+        { 208U, { 15, 15, 0, 0 } },
+        { 216U, { 15, 0, 7, 0 } },
+        { 232U, { 15, 0, 7, 0 } },
+        { 240U, { 15, 15, 0, 0 } },
+        { 248U, { 15, 0, 7, 0 } },
+        { 264U, { 15, 0, 7, 0 } },
+        { 280U, { 15, 15, 0, 0 } },
+        { 320U, { 15, 0, 7, 0 } },
+        { 344U, { 15, 15, 0, 0 } }
+    },
+    {   // 10
+        { 24U, { 0, 7, 7, 0 } },
+        { 64U, { 15, 7, 0, 0 } },
+        { 80U, { 0, 7, 7, 0 } },
+        { 88U, { 0, 7, 0, 0 } },
+        { 96U, { 0, 7, 7, 0 } }
+    },
+    {   // 11
+        { 32U, { 0, 15, 7, 0 } }
+    },
+    {   // 12
+        { 24U, { 0, 7, 7, 0 } },
+        { 64U, { 15, 7, 0, 0 } },
+        { 88U, { 1, 7, 0, 0 } },
+        { 96U, { 0, 7, 7, 0 } },
+        { 112U, { 0, 7, 7, 0 } },
+        { 144U, { 15, 7, 0, 0 } },
+        { 160U, { 15, 7, 0, 0 } },
+        { 176U, { 15, 7, 0, 0 } },
+        { 184U, { 0, 7, 7, 0 } },
+        { 192U, { 15, 7, 0, 0 } },
+        { 208U, { 0, 7, 0, 0 } },
+        { 216U, { 1, 7, 0, 0 } },
+        { 224U, { 0, 7, 0, 0 } }
+    },
+    {   // 13
+        { 24U, { 0, 15, 7, 0 } },
+        { 88U, { 1, 15, 7, 0 } },
+        { 96U, { 0, 15, 7, 0 } },
+        { 112U, { 0, 15, 7, 0 } },
+        { 184U, { 0, 15, 7, 0 } },
+        { 208U, { 0, 15, 7, 0 } },
+        { 216U, { 1, 15, 7, 0 } },
+        { 224U, { 0, 15, 7, 0 } }
+    },
+    {   // 14
+        { 8U, { 0, 7, 7, 0 } },
+        { 32U, { 0, 7, 0, 0 } },
+        { 40U, { 1, 7, 7, 0 } },
+        { 56U, { 15, 7, 0, 0 } },
+        { 64U, { 0, 7, 7, 0 } },
+        { 72U, { 15, 7, 0, 0 } },
+        { 88U, { 0, 7, 7, 0 } },
+        { 96U, { 0, 7, 0, 0 } }
+    },
+    {   // 15
+        { 40U, { 0, 15, 7, 0 } },
+        { 56U, { 0, 15, 7, 0 } },
+        { 64U, { 0, 15, 7, 0 } }
+    },
+    { },  // 16
+    {   // 17
+        { 8U, { 0, 0, 7, 0 } },
+        { 16U, { 0, 0, 7, 0 } },
+        { 24U, { 0, 0, 7, 0 } },
+        { 64U, { 0, 0, 7, 0 } },
+        { 80U, { 0, 0, 7, 0 } },
+        { 136U, { 0, 0, 7, 0 } }
+    },
+    { }  // 18
+};
+
+static void testWaitHandlerSchedule(cxuint i, const AsmWaitHandlerCase& handlerCase,
+                const Array<AsmWaitInstr>& expWaitInstrs)
+{
+    std::istringstream input(handlerCase.input);
+    std::ostringstream errorStream;
+
+    Assembler assembler("test.s", input,
+                    (ASM_ALL&~ASM_ALTMACRO) | ASM_TESTRUN | ASM_TESTRESOLVE,
+                    BinaryFormat::RAWCODE, GPUDeviceType::CAPE_VERDE, errorStream);
+    bool good = assembler.assemble();
+    std::ostringstream oss;
+    oss << " testWaitHandlerSchedule#" << i;
+    const std::string testCaseName = oss.str();
+    if (!good)
+    {
+        std::cerr << errorStream.str();
+        throw Exception(testCaseName+". Can't assemble");
+    }
+    if (assembler.getSections().size()<1)
+        throw Exception(testCaseName+". No sections");
+    const AsmSection& section = assembler.getSections()[0];
+
+    AsmRegAllocator regAlloc(assembler);
+    regAlloc.allocateRegisters(0);
+
+    AsmWaitScheduler waitScheduler(assembler.getISAAssembler()->getWaitConfig(),
+                assembler, regAlloc.getCodeBlocks(), regAlloc.getVregIndexMaps(),
+                regAlloc.getGraphColorMaps(), false);
+    waitScheduler.schedule(*section.usageHandler, *section.waitHandler);
+
+    const std::vector<AsmWaitInstr>& resWaitInstrs = waitScheduler.getNeededWaitInstrs();
+    assertValue("testWaitSchedule", testCaseName + ".waitInstrsSize",
+                expWaitInstrs.size(), resWaitInstrs.size());
+    for (size_t j = 0; j < resWaitInstrs.size(); j++)
+    {
+        std::ostringstream woss;
+        woss << testCaseName << ".waitInstr#" << j;
+        const std::string wiName = woss.str();
+        assertValue("testWaitSchedule", wiName + ".offset",
+                    expWaitInstrs[j].offset, resWaitInstrs[j].offset);
+        assertArray("testWaitSchedule", wiName + ".waits",
+                    Array<uint16_t>(expWaitInstrs[j].waits, expWaitInstrs[j].waits+4),
+                    4, resWaitInstrs[j].waits);
+    }
+}
+
+/* deeply nested loops - registers used at start of loop are loaded at end of loop,
+ * hence queue states go through back edges of all outer loops */
+static void testNestedLoopsSchedule(cxuint depth)
+{
+    std::ostringstream codeOss;
+    for (cxuint i = 0; i < depth; i++)
+        codeOss << "loop" << i << ":\n"
+            "    v_add_f32 v2, v" << (10+i) << ", v2\n"
+            "    s_add_u32 s2, s" << (20+i) << ", s2\n";
+    for (cxuint i = depth; i > 0; i--)
+        codeOss << "    buffer_load_dword v" << (9+i) << ", v1, s[12:15], 0 offen\n"
+            "    s_load_dword s" << (19+i) << ", s[10:11], " << (4*i) << "\n"
+            "    s_cbranch_scc1 loop" << (i-1) << "\n";
+    codeOss << "    s_endpgm\n";
+    
+    std::istringstream input(codeOss.str());
+    std::ostringstream errorStream;
+    Assembler assembler("test.s", input,
+                    (ASM_ALL&~ASM_ALTMACRO) | ASM_TESTRUN | ASM_TESTRESOLVE,
+                    BinaryFormat::RAWCODE, GPUDeviceType::CAPE_VERDE, errorStream);
+    std::ostringstream oss;
+    oss << " testNestedLoopsSchedule#" << depth;
+    const std::string testCaseName = oss.str();
+    if (!assembler.assemble())
+    {
+        std::cerr << errorStream.str();
+        throw Exception(testCaseName+". Can't assemble");
+    }
+    const AsmSection& section = assembler.getSections()[0];
+    
+    AsmRegAllocator regAlloc(assembler);
+    regAlloc.createCodeStructure(section.codeFlow, section.getSize(),
+                            section.content.data());
+    regAlloc.createSSAData(*section.usageHandler, *section.linearDepHandler);
+    
+    AsmWaitScheduler waitScheduler(assembler.getISAAssembler()->getWaitConfig(),
+                assembler, regAlloc.getCodeBlocks(), regAlloc.getVregIndexMaps(),
+                nullptr, false);
+    waitScheduler.schedule(*section.usageHandler, *section.waitHandler);
+    
+    /* number of visits must not depend on depth of loops
+     * (every code block visited at most twice) */
+    const size_t blocksNum = regAlloc.getCodeBlocks().size();
+    assertTrue("testWaitSchedule", testCaseName + ".blockVisitsNum",
+               waitScheduler.getBlockVisitsNum() <= 2*blocksNum);
+    // every use of loaded registers must have wait instruction
+    assertValue("testWaitSchedule", testCaseName + ".waitInstrsSize",
+                size_t(2*depth), waitScheduler.getNeededWaitInstrs().size());
+}
+
+struct AsmCheckWaitsCase
+{
+    const char* input;
+    const char* warnings;
+};
+
+static const AsmCheckWaitsCase checkWaitsTestCases[] =
+{
+    {   /* 0 - sufficient waits */
+        R"ffDXD(
+            s_load_dword s2, s[10:11], 4
+            buffer_load_dword v4, v1, s[12:15], 0 offen
+            s_waitcnt vmcnt(0) & lgkmcnt(0)
+            v_add_f32 v5, s2, v4
+            s_endpgm
+)ffDXD",
+        ""
+    },
+    {   /* 1 - missing and insufficient waits */
+        R"ffDXD(
+            s_load_dword s2, s[10:11], 4
+            buffer_load_dword v4, v1, s[12:15], 0 offen
+            s_waitcnt lgkmcnt(0)
+            v_add_f32 v5, s2, v4
+            buffer_load_dword v6, v1, s[12:15], 0 offen
+            s_cbranch_scc0 aa0
+            v_mov_b32 v2, v3
+aa0:        v_mov_b32 v8, v6
+            s_endpgm
+)ffDXD",
+        "test.s:4:13: Warning: Insufficient wait instruction, required: "
+        "s_waitcnt vmcnt(0) lgkmcnt(0)\n"
+        "test.s:9:13: Warning: Missing wait instruction: s_waitcnt vmcnt(0)\n"
+    },
+    {   /* 2 - register variables are not checked */
+        R"ffDXD(.regvar rv:v:2
+            buffer_load_dword rv[0], v1, s[12:15], 0 offen
+            v_mov_b32 v8, rv[0]
+            s_endpgm
+)ffDXD",
+        ""
+    }
+};
+
+static void testCheckWaitsCase(cxuint i, const AsmCheckWaitsCase& testCase)
+{
+    std::istringstream input(testCase.input);
+    std::ostringstream errorStream;
+    
+    Assembler assembler("test.s", input, ASM_WARNINGS|ASM_CHECKWAITS,
+                    BinaryFormat::RAWCODE, GPUDeviceType::CAPE_VERDE, errorStream);
+    bool good = assembler.assemble();
+    std::ostringstream oss;
+    oss << " testCheckWaitsCase#" << i;
+    const std::string testCaseName = oss.str();
+    assertValue("testCheckWaits", testCaseName + ".good", true, good);
+    assertString("testCheckWaits", testCaseName + ".warnings",
+                 testCase.warnings, errorStream.str());
+}
+
+int main(int argc, const char** argv)
+{
+    int retVal = 0;
+    for (size_t i = 0; i < sizeof(waitScheduleTestCases)/
+                sizeof(AsmWaitScheduleCase); i++)
+        try
+        { testWaitScheduleCase(i, waitScheduleTestCases[i]); }
+        catch(const std::exception& ex)
+        {
+            std::cerr << ex.what() << std::endl;
+            retVal = 1;
+        }
+    for (cxuint i = 0; waitHandlerTestCasesTbl[i].input!=nullptr; i++)
+        try
+        { testWaitHandlerSchedule(i, waitHandlerTestCasesTbl[i],
+                    waitHandlerScheduleResults[i]); }
+        catch(const std::exception& ex)
+        {
+            std::cerr << ex.what() << std::endl;
+            retVal = 1;
+        }
+    for (cxuint depth: { 1U, 2U, 4U, 8U, 16U, 32U, 64U })
+        try
+        { testNestedLoopsSchedule(depth); }
+        catch(const std::exception& ex)
+        {
+            std::cerr << ex.what() << std::endl;
+            retVal = 1;
+        }
+    for (size_t i = 0; i < sizeof(checkWaitsTestCases)/sizeof(AsmCheckWaitsCase); i++)
+        try
+        { testCheckWaitsCase(i, checkWaitsTestCases[i]); }
+        catch(const std::exception& ex)
+        {
+            std::cerr << ex.what() << std::endl;
+            retVal = 1;
+        }
+    return retVal;
+}
@@ -20,10 +20,13 @@
 #include <CLRX/Config.h>
 #include <iostream>
 #include <sstream>
+#include <memory>
+#include <vector>
 #include <CLRX/utils/Containers.h>
 #include <CLRX/utils/Utilities.h>
 #include <CLRX/amdbin/AmdBinaries.h>
 #include <CLRX/amdbin/AmdCL2Binaries.h>
+#include <CLRX/amdbin/ROCmBinaries.h>
 #include <CLRX/amdbin/AmdBinGen.h>
 #include "../TestUtils.h"
 
@@ -510,7 +513,9 @@ static AmdMainGPUBinaryBase* genAmdBinWithMetadata(const std::string& metadata)
 
 static void tryGenAmdBinWithMetadata(const std::string& metadata)
 {
-    std::unique_ptr<AmdMainGPUBinaryBase>(genAmdBinWithMetadata(metadata));
+    std::unique_ptr<AmdMainGPUBinaryBase> binary(genAmdBinWithMetadata(metadata));
+    // metadata is parsed at first access to kernel info
+    binary->getKernelInfo(size_t(0));
 }
 
 // checking parsing of AMD GPU metadata
@@ -519,6 +524,12 @@ static void testAmdGPUMetadataGen()
     const std::string testName = "testAmdGPUMetadataGen";
     assertCLRXException(testName, "aaaa", "1: This is not KernelDesc line",
                         tryGenAmdBinWithMetadata, "aaaa");
+    {
+        // wrong metadata does not break loading of binary
+        std::unique_ptr<AmdMainGPUBinaryBase> binary(genAmdBinWithMetadata("aaaa"));
+        assertString(testName, "kernelName", "myKernel0",
+                     binary->getInnerBinary(size_t(0)).getKernelName());
+    }
     // no fail
     tryGenAmdBinWithMetadata(R"blaB(;ARGSTART:__OpenCL_bitonicSort_kernel
 ;version:3:1:111
@@ -608,6 +619,291 @@ static void testBinLoadingFailCase(cxuint testCaseId, const BinLoadingFailCase&
     }
 }
 
+// find kernel entry by name, returns its index or -1 if it can't be found
+template<typename T, typename Getter>
+static ptrdiff_t findEntryIndex(const T* first, Getter getter)
+{
+    try
+    { return &getter()-first; }
+    catch(const BinException& ex)
+    { return -1; }
+}
+
+// compare finding by name with hash indices and with binary search
+static void testNameHashIndex(const char* filename)
+{
+    const std::string testName = std::string("testNameHashIndex:") + filename;
+    
+    Array<cxbyte> data = loadDataFromFile(filename);
+    Array<cxbyte> data2 = data;
+    std::unique_ptr<AmdMainBinaryBase> base, base2;
+    const bool cl2Binary = isAmdCL2Binary(data.size(), data.data());
+    if (cl2Binary)
+    {
+        base.reset(new AmdCL2MainGPUBinary64(data.size(), data.data()));
+        base2.reset(new AmdCL2MainGPUBinary64(data2.size(), data2.data(),
+                    AMDBIN_CREATE_ALL | BINARY_CREATE_NAMEHASHINDEX));
+    }
+    else
+    {
+        base.reset(createAmdBinaryFromCode(data.size(), data.data()));
+        base2.reset(createAmdBinaryFromCode(data2.size(), data2.data(),
+                    AMDBIN_CREATE_ALL | BINARY_CREATE_NAMEHASHINDEX));
+    }
+    
+    const size_t kernelsNum = base->getKernelInfosNum();
+    assertValue(testName, "kernelInfosNum", kernelsNum, base2->getKernelInfosNum());
+    std::vector<std::string> names;
+    for (size_t i = 0; i < kernelsNum; i++)
+        names.push_back(base->getKernelInfo(i).kernelName.c_str());
+    names.push_back("");
+    names.push_back("xxxNotFound");
+    
+    for (const std::string& name: names)
+    {
+        const std::string caseName = "name="+name;
+        const char* n = name.c_str();
+        assertValue(testName, caseName+" kernelInfo",
+            findEntryIndex(&base->getKernelInfo(size_t(0)),
+                [&base, n]() -> const KernelInfo& { return base->getKernelInfo(n); }),
+            findEntryIndex(&base2->getKernelInfo(size_t(0)),
+                [&base2, n]() -> const KernelInfo& { return base2->getKernelInfo(n); }));
+        if (cl2Binary)
+        {
+            const AmdCL2MainGPUBinaryBase& cl2Bin =
+                    static_cast<const AmdCL2MainGPUBinaryBase&>(*base);
+            const AmdCL2MainGPUBinaryBase& cl2Bin2 =
+                    static_cast<const AmdCL2MainGPUBinaryBase&>(*base2);
+            assertValue(testName, caseName+" metadata",
+                findEntryIndex(&cl2Bin.getMetadataEntry(size_t(0)),
+                    [&cl2Bin, n]() -> const AmdCL2GPUKernelMetadata&
+                    { return cl2Bin.getMetadataEntry(n); }),
+                findEntryIndex(&cl2Bin2.getMetadataEntry(size_t(0)),
+                    [&cl2Bin2, n]() -> const AmdCL2GPUKernelMetadata&
+                    { return cl2Bin2.getMetadataEntry(n); }));
+            const AmdCL2InnerGPUBinaryBase& inner = cl2Bin.getInnerBinaryBase();
+            const AmdCL2InnerGPUBinaryBase& inner2 = cl2Bin2.getInnerBinaryBase();
+            if (inner.getKernelsNum() != 0)
+                assertValue(testName, caseName+" kernelData",
+                    findEntryIndex(&inner.getKernelData(size_t(0)),
+                        [&inner, n]() -> const AmdCL2GPUKernel&
+                        { return inner.getKernelData(n); }),
+                    findEntryIndex(&inner2.getKernelData(size_t(0)),
+                        [&inner2, n]() -> const AmdCL2GPUKernel&
+                        { return inner2.getKernelData(n); }));
+        }
+        else if (base->getType() == AmdMainType::GPU_BINARY ||
+            base->getType() == AmdMainType::GPU_64_BINARY)
+        {
+            const AmdMainGPUBinaryBase& gpuBin =
+                    static_cast<const AmdMainGPUBinaryBase&>(*base);
+            const AmdMainGPUBinaryBase& gpuBin2 =
+                    static_cast<const AmdMainGPUBinaryBase&>(*base2);
+            assertValue(testName, caseName+" innerBinary",
+                findEntryIndex(&gpuBin.getInnerBinary(size_t(0)),
+                    [&gpuBin, n]() -> const AmdInnerGPUBinary32&
+                    { return gpuBin.getInnerBinary(n); }),
+                findEntryIndex(&gpuBin2.getInnerBinary(size_t(0)),
+                    [&gpuBin2, n]() -> const AmdInnerGPUBinary32&
+                    { return gpuBin2.getInnerBinary(n); }));
+            assertValue(testName, caseName+" kernelHeader",
+                findEntryIndex(&gpuBin.getKernelHeaderEntry(size_t(0)),
+                    [&gpuBin, n]() -> const AmdGPUKernelHeader&
+                    { return gpuBin.getKernelHeaderEntry(n); }),
+                findEntryIndex(&gpuBin2.getKernelHeaderEntry(size_t(0)),
+                    [&gpuBin2, n]() -> const AmdGPUKernelHeader&
+                    { return gpuBin2.getKernelHeaderEntry(n); }));
+        }
+    }
+}
+
+// trusted loading must give same results as loading with all checks
+static void testTrustedLoading(const char* filename)
+{
+    const std::string testName = std::string("testTrustedLoading:") + filename;
+    
+    Array<cxbyte> data = loadDataFromFile(filename);
+    Array<cxbyte> data2 = data;
+    const uint64_t checksum = calculateBinaryChecksum(data2.size(), data2.data());
+    assertValue(testName, "checksum", calculateBinaryChecksum(data.size(), data.data()),
+                checksum);
+    std::unique_ptr<AmdMainBinaryBase> base, base2;
+    const bool cl2Binary = isAmdCL2Binary(data.size(), data.data());
+    if (cl2Binary)
+    {
+        base.reset(new AmdCL2MainGPUBinary64(data.size(), data.data()));
+        base2.reset(new AmdCL2MainGPUBinary64(data2.size(), data2.data(),
+                    AMDBIN_CREATE_ALL | BINARY_CREATE_TRUSTED, checksum));
+    }
+    else
+    {
+        base.reset(createAmdBinaryFromCode(data.size(), data.data()));
+        base2.reset(createAmdBinaryFromCode(data2.size(), data2.data(),
+                    AMDBIN_CREATE_ALL | BINARY_CREATE_TRUSTED, checksum));
+    }
+    
+    assertString(testName, "compileOptions", base->getCompileOptions().c_str(),
+                 base2->getCompileOptions());
+    const size_t kernelsNum = base->getKernelInfosNum();
+    assertValue(testName, "kernelInfosNum", kernelsNum, base2->getKernelInfosNum());
+    for (size_t i = 0; i < kernelsNum; i++)
+    {
+        const KernelInfo& kinfo = base->getKernelInfo(i);
+        const KernelInfo& kinfo2 = base2->getKernelInfo(i);
+        assertString(testName, "kernelName", kinfo.kernelName.c_str(), kinfo2.kernelName);
+        assertValue(testName, "argsNum", kinfo.argInfos.size(), kinfo2.argInfos.size());
+    }
+    if (cl2Binary)
+    {
+        const AmdCL2InnerGPUBinaryBase& inner =
+            static_cast<const AmdCL2MainGPUBinaryBase&>(*base).getInnerBinaryBase();
+        const AmdCL2InnerGPUBinaryBase& inner2 =
+            static_cast<const AmdCL2MainGPUBinaryBase&>(*base2).getInnerBinaryBase();
+        assertValue(testName, "innerKernelsNum", inner.getKernelsNum(),
+                    inner2.getKernelsNum());
+        for (size_t i = 0; i < inner.getKernelsNum(); i++)
+        {
+            const AmdCL2GPUKernel& kernel = inner.getKernelData(i);
+            const AmdCL2GPUKernel& kernel2 = inner2.getKernelData(i);
+            assertString(testName, "innerKernelName", kernel.kernelName.c_str(),
+                         kernel2.kernelName);
+            assertValue(testName, "setupOffset", kernel.setup - data.data(),
+                        kernel2.setup - data2.data());
+            assertValue(testName, "codeSize", kernel.codeSize, kernel2.codeSize);
+        }
+    }
+}
+
+static void testTrustedROCmLoading(const char* filename)
+{
+    const std::string testName = std::string("testTrustedROCmLoading:") + filename;
+    
+    Array<cxbyte> data = loadDataFromFile(filename);
+    Array<cxbyte> data2 = data;
+    ROCmBinary binary(data.size(), data.data());
+    ROCmBinary binary2(data2.size(), data2.data(), ROCMBIN_CREATE_ALL |
+                BINARY_CREATE_TRUSTED, calculateBinaryChecksum(data2.size(), data2.data()));
+    assertValue(testName, "regionsNum", binary.getRegionsNum(), binary2.getRegionsNum());
+    for (size_t i = 0; i < binary.getRegionsNum(); i++)
+    {
+        const ROCmRegion& region = binary.getRegion(i);
+        const ROCmRegion& region2 = binary2.getRegion(i);
+        assertString(testName, "regionName", region.regionName.c_str(), region2.regionName);
+        assertValue(testName, "regionOffset", region.offset, region2.offset);
+        assertValue(testName, "regionSize", region.size, region2.size);
+    }
+    assertValue(testName, "metadataSize", binary.getMetadataSize(),
+                binary2.getMetadataSize());
+    assertString(testName, "target", binary.getTarget().c_str(), binary2.getTarget());
+    assertValue(testName, "gotSymbolsNum", binary.getGotSymbolsNum(),
+                binary2.getGotSymbolsNum());
+}
+
+// checksum must detect change of single byte, header is checked in trusted mode
+static void testTrustedChecksum()
+{
+    const std::string testName = "testTrustedChecksum";
+    Array<cxbyte> data = loadDataFromFile(CLRX_SOURCE_DIR
+                "/tests/amdbin/amdbins/test3-15_11.clo");
+    const uint64_t checksum = calculateBinaryChecksum(data.size(), data.data());
+    for (size_t pos: { size_t(0), size_t(17), data.size()/2, data.size()-1 })
+    {
+        data[pos] ^= 0x10;
+        if (calculateBinaryChecksum(data.size(), data.data()) == checksum)
+            throw Exception(testName+": change is not detected");
+        data[pos] ^= 0x10;
+    }
+    assertValue(testName, "checksum", checksum,
+                calculateBinaryChecksum(data.size(), data.data()));
+    if (calculateBinaryChecksum(data.size()-1, data.data()) == checksum)
+        throw Exception(testName+": size change is not detected");
+    
+    // binary with other checksum than expected must be rejected
+    for (size_t pos: { data.size()/3, data.size()/2, data.size()-1 })
+    {
+        data[pos] ^= 0x10;
+        bool failed = false;
+        try
+        { AmdCL2MainGPUBinary64 binary(data.size(), data.data(),
+                    AMDBIN_CREATE_ALL | BINARY_CREATE_TRUSTED, checksum); }
+        catch(const BinException& ex)
+        { failed = true; }
+        if (!failed)
+            throw Exception(testName+": checksum mismatch is not detected");
+        data[pos] ^= 0x10;
+    }
+    // trusted loading without expected checksum
+    bool failed = false;
+    try
+    { AmdCL2MainGPUBinary64 binary(data.size(), data.data(),
+                AMDBIN_CREATE_ALL | BINARY_CREATE_TRUSTED); }
+    catch(const BinException& ex)
+    { failed = true; }
+    if (!failed)
+        throw Exception(testName+": missing checksum is not detected");
+    // no creation flag skips checksum of trusted binary
+    for (Flags extraFlags: { Flags(0x20000000U), Flags(0x10000000U), ~Flags(0) })
+    {
+        failed = false;
+        try
+        { ElfBinary64 binary(data.size(), data.data(),
+                    extraFlags | BINARY_CREATE_TRUSTED, checksum^1); }
+        catch(const BinException& ex)
+        { failed = true; }
+        if (!failed)
+            throw Exception(testName+": checksum is skipped by creation flags");
+    }
+
+    // ELF header is always checked
+    data[0] = 0;
+    failed = false;
+    try
+    { AmdCL2MainGPUBinary64 binary(data.size(), data.data(),
+                AMDBIN_CREATE_ALL | BINARY_CREATE_TRUSTED,
+                calculateBinaryChecksum(data.size(), data.data())); }
+    catch(const BinException& ex)
+    { failed = true; }
+    if (!failed)
+        throw Exception(testName+": wrong header is not detected");
+}
+
+// hash index must return first of equal names like binaryMapFind
+static void testNameHashIndexDuplicates()
+{
+    const std::string testName = "testNameHashIndexDuplicates";
+    Array<std::pair<CString, size_t> > nameMap;
+    std::vector<std::pair<CString, size_t> > tmpMap;
+    for (size_t i = 0; i < 300; i++)
+    {
+        std::ostringstream oss;
+        oss << "kernel" << (i%113);
+        tmpMap.push_back(std::make_pair(CString(oss.str().c_str()), i));
+    }
+    tmpMap.push_back(std::make_pair(CString(), 300));
+    nameMap.assign(tmpMap.begin(), tmpMap.end());
+    mapSort(nameMap.begin(), nameMap.end());
+    NameHashIndex index;
+    assertTrue(testName, "empty", index.empty());
+    index.build(nameMap.begin(), nameMap.end());
+    assertTrue(testName, "notEmpty", !index.empty());
+    
+    for (size_t i = 0; i < 120; i++)
+    {
+        std::ostringstream oss;
+        oss << "kernel" << i;
+        const CString name = oss.str().c_str();
+        auto expected = binaryMapFind(nameMap.begin(), nameMap.end(), name);
+        auto result = index.find(nameMap.begin(), nameMap.end(), name.c_str());
+        assertValue(testName, "find "+oss.str(), expected-nameMap.begin(),
+                    result-nameMap.begin());
+    }
+    assertValue(testName, "find empty name", ptrdiff_t(0),
+            index.find(nameMap.begin(), nameMap.end(), "")-nameMap.begin());
+    
+    index.build(nameMap.begin(), nameMap.begin());
+    assertTrue(testName, "empty after build", index.empty());
+}
+
 int main(int argc, const char** argv)
 {
     int retVal = 0;
@@ -657,6 +953,26 @@ int main(int argc, const char** argv)
             "/tests/amdbin/amdbins/structkernel2_cpu64.clo", "myKernel1",
             sizeof(expectedCPUKernelArgs2)/sizeof(AmdKernelArg), expectedCPUKernelArgs2);
     retVal |= callTest(testAmdGPUMetadataGen);
+    retVal |= callTest(testNameHashIndex, CLRX_SOURCE_DIR
+            "/tests/amdbin/amdbins/structkernel2.clo");
+    retVal |= callTest(testNameHashIndex, CLRX_SOURCE_DIR
+            "/tests/amdbin/amdbins/structkernel2_cpu64.clo");
+    retVal |= callTest(testNameHashIndex, CLRX_SOURCE_DIR
+            "/tests/amdbin/amdbins/test3-15_7.clo");
+    retVal |= callTest(testNameHashIndex, CLRX_SOURCE_DIR
+            "/tests/amdbin/amdbins/test3-15_11.clo");
+    retVal |= callTest(testNameHashIndexDuplicates);
+    retVal |= callTest(testTrustedLoading, CLRX_SOURCE_DIR
+            "/tests/amdbin/amdbins/structkernel2.clo");
+    retVal |= callTest(testTrustedLoading, CLRX_SOURCE_DIR
+            "/tests/amdbin/amdbins/test3-15_7.clo");
+    retVal |= callTest(testTrustedLoading, CLRX_SOURCE_DIR
+            "/tests/amdbin/amdbins/test3-15_11.clo");
+    retVal |= callTest(testTrustedROCmLoading, CLRX_SOURCE_DIR
+            "/tests/amdasm/amdbins/rocm-fiji.hsaco");
+    retVal |= callTest(testTrustedROCmLoading, CLRX_SOURCE_DIR
+            "/tests/amdasm/amdbins/two_kernels-rocm-llvm10.clo");
+    retVal |= callTest(testTrustedChecksum);
     
     for (cxuint i = 0; i < sizeof(binLoadingTestCases)/sizeof(BinLoadingFailCase); i++)
     {
@@ -0,0 +1,407 @@
+/*
+ *  CLRadeonExtender - Unofficial OpenCL Radeon Extensions Library
+ *  Copyright (C) 2014-2018 Mateusz Szpakowski
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <CLRX/Config.h>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <cstring>
+#include <vector>
+#include <utility>
+#include <initializer_list>
+#include <CLRX/utils/Containers.h>
+#include <CLRX/utils/Utilities.h>
+#include <CLRX/amdbin/AmdBinaries.h>
+#include <CLRX/amdbin/AmdCL2Binaries.h>
+#include <CLRX/amdbin/ROCmBinaries.h>
+#include <CLRX/amdbin/GalliumBinaries.h>
+#include <CLRX/amdbin/BinaryProbe.h>
+#include <CLRX/amdbin/BinaryIndex.h>
+#include "../TestUtils.h"
+
+using namespace CLRX;
+
+struct BinaryIndexTestCase
+{
+    const char* filename;
+    bool hasKernelMetadata; ///< if all kernels have metadata
+    bool hasKernelSetup;    ///< if all kernels have setup
+    bool hasMetadata;   ///< if binary has binary metadata (ROCm)
+};
+
+static const BinaryIndexTestCase binaryIndexTestCases[] =
+{
+    { CLRX_SOURCE_DIR "/tests/amdbin/amdbins/alltypes.clo", true, false, false },
+    { CLRX_SOURCE_DIR "/tests/amdasm/amdbins/samplekernels_64.clo", true, false, false },
+    { CLRX_SOURCE_DIR "/tests/amdbin/amdbins/test3-15_7.clo", true, true, false },
+    { CLRX_SOURCE_DIR "/tests/amdasm/amdbins/amdcl2.clo", true, true, false },
+    { CLRX_SOURCE_DIR "/tests/amdasm/amdbins/rocm-fiji.hsaco", false, true, false },
+    { CLRX_SOURCE_DIR "/tests/amdasm/amdbins/two_kernels-rocm-llvm10.clo", false, true,
+        true },
+    { CLRX_SOURCE_DIR "/tests/amdasm/amdbins/gallium1.clo", false, false, false }
+};
+
+// build index (binary is loaded as trusted if checksum is given)
+static void buildBinaryIndex(size_t binarySize, cxbyte* binary, BinaryIndex& index,
+            bool trusted = false, uint64_t checksum = 0)
+{
+    const bool is64Bit = (binary[EI_CLASS] == ELFCLASS64);
+    const Flags trustedFlags = trusted ? Flags(BINARY_CREATE_TRUSTED) : Flags(0);
+    switch (detectBinaryFormat(binarySize, binary))
+    {
+        case BinaryProbeFormat::AMD:
+            if (!is64Bit)
+                index.build(AmdMainGPUBinary32(binarySize, binary, trustedFlags,
+                            checksum));
+            else
+                index.build(AmdMainGPUBinary64(binarySize, binary, trustedFlags,
+                            checksum));
+            break;
+        case BinaryProbeFormat::AMDCL2:
+        {
+            const Flags flags = AMDBIN_CREATE_KERNELINFO |
+                    AMDCL2BIN_INNER_CREATE_KERNELDATA | trustedFlags;
+            if (!is64Bit)
+                index.build(AmdCL2MainGPUBinary32(binarySize, binary, flags, checksum));
+            else
+                index.build(AmdCL2MainGPUBinary64(binarySize, binary, flags, checksum));
+            break;
+        }
+        case BinaryProbeFormat::ROCM:
+            index.build(ROCmBinary(binarySize, binary, trustedFlags, checksum));
+            break;
+        default:
+            index.build(GalliumBinary(binarySize, binary, trustedFlags, checksum));
+            break;
+    }
+}
+
+// check whether section and symbol maps find all sections and symbols
+template<typename ElfBin>
+static void checkElfMaps(const std::string& testName, const ElfBin& elfBin)
+{
+    for (cxuint i = 0; i < elfBin.getSectionHeadersNum(); i++)
+    {
+        const char* name = elfBin.getSectionName(i);
+        assertString(testName, "sectionMap", name,
+                elfBin.getSectionName(elfBin.getSectionIndex(name)));
+    }
+    for (size_t i = 0; i < elfBin.getSymbolsNum(); i++)
+    {
+        const char* name = elfBin.getSymbolName(i);
+        assertString(testName, "symbolMap", name,
+                elfBin.getSymbolName(elfBin.getSymbolIndex(name)));
+    }
+}
+
+template<typename AmdBin>
+static void checkAmdMaps(const std::string& testName, const AmdBin& binary)
+{
+    checkElfMaps(testName, binary);
+    for (size_t i = 0; i < binary.getInnerBinariesNum(); i++)
+        assertTrue(testName, "innerBinaryMap", &binary.getInnerBinary(i) ==
+                &binary.getInnerBinary(binary.getInnerBinaryName(i).c_str()));
+}
+
+template<typename AmdCL2Bin>
+static void checkAmdCL2Maps(const std::string& testName, const AmdCL2Bin& binary)
+{
+    checkElfMaps(testName, binary);
+    for (size_t i = 0; i < binary.getKernelInfosNum(); i++)
+        assertTrue(testName, "kernelInfoMap", &binary.getKernelInfo(i) ==
+                &binary.getKernelInfo(binary.getMetadataEntry(i).kernelName.c_str()));
+}
+
+// load binary with index, check its maps and build index from it
+static void loadBinaryWithIndex(const std::string& testName, size_t binarySize,
+            cxbyte* binary, const BinaryIndex& index, bool trusted, BinaryIndex& outIndex)
+{
+    const bool is64Bit = (binary[EI_CLASS] == ELFCLASS64);
+    const Flags trustedFlags = trusted ? Flags(BINARY_CREATE_TRUSTED) : Flags(0);
+    switch (index.getFormat())
+    {
+        case BinaryProbeFormat::AMD:
+            if (!is64Bit)
+            {
+                AmdMainGPUBinary32 amdBin(binarySize, binary,
+                        AMDBIN_CREATE_ALL | trustedFlags, 0, &index);
+                checkAmdMaps(testName, amdBin);
+                outIndex.build(amdBin);
+            }
+            else
+            {
+                AmdMainGPUBinary64 amdBin(binarySize, binary,
+                        AMDBIN_CREATE_ALL | trustedFlags, 0, &index);
+                checkAmdMaps(testName, amdBin);
+                outIndex.build(amdBin);
+            }
+            break;
+        case BinaryProbeFormat::AMDCL2:
+            if (!is64Bit)
+            {
+                AmdCL2MainGPUBinary32 amdBin(binarySize, binary,
+                        AMDBIN_CREATE_ALL | trustedFlags, 0, &index);
+                checkAmdCL2Maps(testName, amdBin);
+                outIndex.build(amdBin);
+            }
+            else
+            {
+                AmdCL2MainGPUBinary64 amdBin(binarySize, binary,
+                        AMDBIN_CREATE_ALL | trustedFlags, 0, &index);
+                checkAmdCL2Maps(testName, amdBin);
+                outIndex.build(amdBin);
+            }
+            break;
+        case BinaryProbeFormat::ROCM:
+        {
+            ROCmBinary rocmBin(binarySize, binary, ROCMBIN_CREATE_ALL | trustedFlags,
+                        0, &index);
+            checkElfMaps(testName, rocmBin);
+            outIndex.build(rocmBin);
+            break;
+        }
+        case BinaryProbeFormat::GALLIUM:
+        {
+            GalliumBinary galliumBin(binarySize, binary, trustedFlags, 0, &index);
+            if (!galliumBin.is64BitElfBinary())
+                checkElfMaps(testName, galliumBin.getElfBinary32());
+            else
+                checkElfMaps(testName, galliumBin.getElfBinary64());
+            outIndex.build(galliumBin);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+static void testBinaryIndex(cxuint testId, const BinaryIndexTestCase& testCase)
+{
+    std::ostringstream oss;
+    oss << "binaryIndex#" << testId;
+    const std::string testName = oss.str();
+    Array<cxbyte> binary = loadDataFromFile(testCase.filename);
+    
+    BinaryIndex index;
+    buildBinaryIndex(binary.size(), binary.data(), index);
+    BinaryProbe probe;
+    probeBinary(binary.size(), binary.data(), probe);
+    assertTrue(testName, "format", index.getFormat() == probe.format);
+    assertValue(testName, "is64Bit", probe.is64Bit, index.is64BitBinary());
+    assertValue(testName, "hasDeviceType", probe.hasDeviceType, index.hasGPUDeviceType());
+    assertTrue(testName, "deviceType", !probe.hasDeviceType ||
+                index.getDeviceType() == probe.deviceType);
+    assertTrue(testName, "matches", index.matches(binary.size(), binary.data()));
+    assertTrue(testName, "sectionsNum", index.getSectionsNum() != 0);
+    assertValue(testName, "kernelsNum", probe.kernels.size(), index.getKernelsNum());
+    
+    for (size_t i = 0; i < probe.kernels.size(); i++)
+    {
+        std::ostringstream koss;
+        koss << "kernel#" << i << ".";
+        const std::string kname = koss.str();
+        const size_t kindex = index.findKernel(probe.kernels[i].name.c_str());
+        assertTrue(testName, kname+"found", kindex != SIZE_MAX);
+        const BinaryIndexKernel& kernel = index.getKernel(kindex);
+        assertString(testName, kname+"name", probe.kernels[i].name.c_str(), kernel.name);
+        assertValue(testName, kname+"codeSize", probe.kernels[i].codeSize,
+                    kernel.codeSize);
+        // code must be in kernel region
+        assertTrue(testName, kname+"code", kernel.codeOffset != SIZE_MAX &&
+                kernel.offset <= kernel.codeOffset &&
+                kernel.codeOffset + kernel.codeSize <= kernel.offset + kernel.size &&
+                kernel.offset + kernel.size <= binary.size());
+        assertValue(testName, kname+"hasMetadata", testCase.hasKernelMetadata,
+                    kernel.metadataOffset != SIZE_MAX);
+        assertValue(testName, kname+"hasSetup", testCase.hasKernelSetup,
+                    kernel.setupOffset != SIZE_MAX);
+        if (index.getFormat() == BinaryProbeFormat::AMD)
+        {
+            // AMD metadata starts from kernel arguments header
+            const std::string metaStart = std::string(";ARGSTART:__OpenCL_") +
+                    kernel.name.c_str() + "_kernel";
+            assertTrue(testName, kname+"metadata",
+                    kernel.metadataSize >= metaStart.size() &&
+                    ::memcmp(binary.data() + kernel.metadataOffset, metaStart.c_str(),
+                             metaStart.size()) == 0);
+        }
+    }
+    assertValue(testName, "findNotExisting", size_t(SIZE_MAX),
+                index.findKernel("xxxNotExisting"));
+    assertValue(testName, "hasMetadata", testCase.hasMetadata,
+                index.getMetadataOffset() != SIZE_MAX && index.getMetadataSize() != 0);
+    
+    // write, read and write again must give same index
+    std::ostringstream indexOss;
+    index.write(indexOss);
+    const std::string indexData = indexOss.str();
+    BinaryIndex index2;
+    {
+        std::istringstream iss(indexData);
+        index2.read(iss);
+    }
+    std::ostringstream indexOss2;
+    index2.write(indexOss2);
+    assertTrue(testName, "rewrite", indexData == indexOss2.str());
+    assertTrue(testName, "readMatches", index2.matches(binary.size(), binary.data()));
+    assertValue(testName, "readKernelsNum", index.getKernelsNum(), index2.getKernelsNum());
+    for (size_t i = 0; i < index.getKernelsNum(); i++)
+        assertValue(testName, "readFindKernel", i,
+                    index2.findKernel(index.getKernel(i).name.c_str()));
+    
+    // binary loaded as trusted with checksum from read index gives same index
+    {
+        BinaryIndex index3;
+        buildBinaryIndex(binary.size(), binary.data(), index3, true,
+                    index2.getChecksum());
+        std::ostringstream indexOss3;
+        index3.write(indexOss3);
+        assertTrue(testName, "trustedRebuild", indexData == indexOss3.str());
+    }
+    
+    // index loaded from memory (mapped file) gives same index
+    {
+        // copy to aligned memory
+        std::vector<uint64_t> alignedData((indexData.size()+7)>>3);
+        ::memcpy(alignedData.data(), indexData.data(), indexData.size());
+        const cxbyte* indexPtr = reinterpret_cast<const cxbyte*>(alignedData.data());
+        BinaryIndex index3;
+        index3.load(indexData.size(), indexPtr);
+        std::ostringstream indexOss3;
+        index3.write(indexOss3);
+        assertTrue(testName, "load", indexData == indexOss3.str());
+        // kernel names are directly accessible in mapped index
+        const BinaryIndexFileHeader& header =
+                *reinterpret_cast<const BinaryIndexFileHeader*>(indexPtr);
+        assertValue(testName, "fileKernelsNum", index.getKernelsNum(),
+                    size_t(ULEV(header.kernelsNum)));
+        const BinaryIndexFileKernel* fileKernels =
+                reinterpret_cast<const BinaryIndexFileKernel*>(
+                    indexPtr + ULEV(header.kernelsOffset));
+        const char* strings = reinterpret_cast<const char*>(
+                    indexPtr + ULEV(header.stringsOffset));
+        for (size_t i = 0; i < index.getKernelsNum(); i++)
+            assertString(testName, "fileKernelName", index.getKernel(i).name.c_str(),
+                    strings + ULEV(fileKernels[i].nameOffset));
+    }
+    
+    // binary loaded with index gives same maps and index
+    for (bool trusted: { false, true })
+    {
+        BinaryIndex index3;
+        loadBinaryWithIndex(testName + (trusted ? "(trusted)" : ""), binary.size(),
+                    binary.data(), index2, trusted, index3);
+        std::ostringstream indexOss3;
+        index3.write(indexOss3);
+        assertTrue(testName, "rebuildWithIndex", indexData == indexOss3.str());
+    }
+    
+    // index with unsorted map must be rejected
+    if (index.getKernelsNum() >= 2)
+    {
+        std::string wrongIndexData = indexData;
+        BinaryIndexFileHeader& header =
+                *reinterpret_cast<BinaryIndexFileHeader*>(&wrongIndexData[0]);
+        uint32_t* kernelMap = reinterpret_cast<uint32_t*>(&wrongIndexData[0] +
+                ULEV(header.mapsOffset)) + ULEV(header.sectionsNum) +
+                ULEV(header.symbolsNum);
+        std::swap(kernelMap[0], kernelMap[1]);
+        bool failed = false;
+        try
+        {
+            std::istringstream iss(wrongIndexData);
+            BinaryIndex index3;
+            index3.read(iss);
+        }
+        catch(const BinException& ex)
+        { failed = true; }
+        assertTrue(testName, "unsortedMap", failed);
+    }
+    
+    // truncated index must be rejected
+    bool failed = false;
+    try
+    {
+        std::istringstream iss(indexData.substr(0, indexData.size()-1));
+        index2.read(iss);
+    }
+    catch(const BinException& ex)
+    { failed = true; }
+    assertTrue(testName, "truncatedIndex", failed);
+    
+    // modified binary must not match to index
+    binary[binary.size()>>1] ^= 0x10;
+    assertTrue(testName, "modifiedNotMatches",
+               !index.matches(binary.size(), binary.data()));
+    assertTrue(testName, "sizeNotMatches",
+               !index.matches(binary.size()-1, binary.data()));
+    // and must not be loaded as trusted with checksum from index
+    failed = false;
+    try
+    {
+        BinaryIndex index3;
+        buildBinaryIndex(binary.size(), binary.data(), index3, true,
+                    index.getChecksum());
+    }
+    catch(const BinException& ex)
+    { failed = true; }
+    assertTrue(testName, "modifiedTrusted", failed);
+    // and must not be loaded with index
+    failed = false;
+    try
+    {
+        BinaryIndex index3;
+        loadBinaryWithIndex(testName, binary.size(), binary.data(), index, false,
+                    index3);
+    }
+    catch(const BinException& ex)
+    { failed = true; }
+    assertTrue(testName, "modifiedWithIndex", failed);
+}
+
+// index of AMD OpenCL 2.0 binary without kernel infos must be rejected
+static void testAmdCL2WithoutKernelInfo()
+{
+    const std::string testName = "amdCL2WithoutKernelInfo";
+    Array<cxbyte> binary = loadDataFromFile(CLRX_SOURCE_DIR
+                "/tests/amdasm/amdbins/amdcl2.clo");
+    BinaryIndex index;
+    bool failed = false;
+    try
+    {
+        if (binary[EI_CLASS] == ELFCLASS32)
+            index.build(AmdCL2MainGPUBinary32(binary.size(), binary.data(),
+                        AMDCL2BIN_INNER_CREATE_KERNELDATA));
+        else
+            index.build(AmdCL2MainGPUBinary64(binary.size(), binary.data(),
+                        AMDCL2BIN_INNER_CREATE_KERNELDATA));
+    }
+    catch(const BinException& ex)
+    { failed = true; }
+    assertTrue(testName, "noKernelInfo", failed);
+}
+
+int main(int argc, const char** argv)
+{
+    int retVal = 0;
+    for (cxuint i = 0; i < sizeof(binaryIndexTestCases)/sizeof(BinaryIndexTestCase); i++)
+        retVal |= callTest(testBinaryIndex, i, binaryIndexTestCases[i]);
+    retVal |= callTest(testAmdCL2WithoutKernelInfo);
+    return retVal;
+}
@@ -0,0 +1,113 @@
+/*
+ *  CLRadeonExtender - Unofficial OpenCL Radeon Extensions Library
+ *  Copyright (C) 2014-2018 Mateusz Szpakowski
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <CLRX/Config.h>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <CLRX/utils/Containers.h>
+#include <CLRX/utils/Utilities.h>
+#include <CLRX/utils/GPUId.h>
+#include <CLRX/amdbin/AmdBinaries.h>
+#include <CLRX/amdbin/AmdCL2Binaries.h>
+#include <CLRX/amdbin/ROCmBinaries.h>
+#include <CLRX/amdbin/BinaryProbe.h>
+#include "../TestUtils.h"
+
+using namespace CLRX;
+
+struct BinaryProbeTestCase
+{
+    const char* filename;
+    BinaryProbeFormat format;
+    bool is64Bit;
+    bool hasDeviceType;
+    GPUDeviceType deviceType;
+    std::vector<BinaryProbeKernel> kernels;
+};
+
+static const BinaryProbeTestCase binaryProbeTestCases[] =
+{
+    { CLRX_SOURCE_DIR "/tests/amdbin/amdbins/alltypes.clo", BinaryProbeFormat::AMD,
+        false, true, GPUDeviceType::PITCAIRN, { { "myKernel", 4 } } },
+    { CLRX_SOURCE_DIR "/tests/amdbin/amdbins/alltypes_cpu64.clo", BinaryProbeFormat::AMD,
+        true, false, GPUDeviceType::CAPE_VERDE, { } },
+    { CLRX_SOURCE_DIR "/tests/amdasm/amdbins/samplekernels_64.clo",
+        BinaryProbeFormat::AMD, true, true, GPUDeviceType::PITCAIRN,
+        { { "add", 172 }, { "multiply", 176 } } },
+    { CLRX_SOURCE_DIR "/tests/amdbin/amdbins/test3-15_7.clo", BinaryProbeFormat::AMDCL2,
+        true, true, GPUDeviceType::BONAIRE, { { "Piper", 3956 } } },
+    { CLRX_SOURCE_DIR "/tests/amdasm/amdbins/amdcl2.clo", BinaryProbeFormat::AMDCL2,
+        true, true, GPUDeviceType::BONAIRE,
+        { { "aaa1", 16 }, { "aaa2", 8 }, { "gfd12", 12 } } },
+    { CLRX_SOURCE_DIR "/tests/amdasm/amdbins/rocm-fiji.hsaco", BinaryProbeFormat::ROCM,
+        true, true, GPUDeviceType::FIJI, { { "test1", 140 }, { "test2", 140 } } },
+    { CLRX_SOURCE_DIR "/tests/amdasm/amdbins/two_kernels-rocm-llvm10.clo",
+        BinaryProbeFormat::ROCM, true, true, GPUDeviceType::GFX1010,
+        { { "sample_kernel", 108 }, { "sample_kernel2", 124 } } },
+    { CLRX_SOURCE_DIR "/tests/amdasm/amdbins/gallium1.clo", BinaryProbeFormat::GALLIUM,
+        false, false, GPUDeviceType::CAPE_VERDE, { { "one1", 8 }, { "secondx", 256 } } }
+};
+
+static void testBinaryProbe(cxuint testId, const BinaryProbeTestCase& testCase)
+{
+    std::ostringstream oss;
+    oss << "binaryProbe#" << testId;
+    const std::string testName = oss.str();
+    Array<cxbyte> binary = loadDataFromFile(testCase.filename);
+    
+    assertTrue(testName, "detectFormat",
+               detectBinaryFormat(binary.size(), binary.data()) == testCase.format);
+    // detection must be same as in format checking functions
+    assertValue(testName, "isAmdBinary", testCase.format == BinaryProbeFormat::AMD,
+                isAmdBinary(binary.size(), binary.data()));
+    assertValue(testName, "isAmdCL2Binary", testCase.format == BinaryProbeFormat::AMDCL2,
+                isAmdCL2Binary(binary.size(), binary.data()));
+    assertValue(testName, "isROCmBinary", testCase.format == BinaryProbeFormat::ROCM,
+                isROCmBinary(binary.size(), binary.data()));
+    
+    BinaryProbe probe;
+    probeBinary(binary.size(), binary.data(), probe);
+    assertTrue(testName, "format", probe.format == testCase.format);
+    assertValue(testName, "is64Bit", testCase.is64Bit, probe.is64Bit);
+    assertValue(testName, "hasDeviceType", testCase.hasDeviceType, probe.hasDeviceType);
+    if (testCase.hasDeviceType)
+        assertValue(testName, "deviceType",
+                    std::string(getGPUDeviceTypeName(testCase.deviceType)),
+                    std::string(getGPUDeviceTypeName(probe.deviceType)));
+    assertValue(testName, "kernelsNum", testCase.kernels.size(), probe.kernels.size());
+    for (size_t i = 0; i < testCase.kernels.size(); i++)
+    {
+        std::ostringstream koss;
+        koss << "kernel#" << i << ".";
+        const std::string kname = koss.str();
+        assertString(testName, kname+"name", testCase.kernels[i].name.c_str(),
+                     probe.kernels[i].name);
+        assertValue(testName, kname+"codeSize", testCase.kernels[i].codeSize,
+                    probe.kernels[i].codeSize);
+    }
+}
+
+int main(int argc, const char** argv)
+{
+    int retVal = 0;
+    for (cxuint i = 0; i < sizeof(binaryProbeTestCases)/sizeof(BinaryProbeTestCase); i++)
+        retVal |= callTest(testBinaryProbe, i, binaryProbeTestCases[i]);
+    return retVal;
+}
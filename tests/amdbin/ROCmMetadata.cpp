@@ -1343,7 +1343,8 @@ Kernels:
     }
 };
 
-static void testROCmMetadataCase(cxuint testId, const ROCmMetadataTestCase& testCase)
+static void testROCmMetadataCase(cxuint testId, const ROCmMetadataTestCase& testCase,
+            bool parallel)
 {
     ROCmInput rocmInput{};
     rocmInput.deviceType = GPUDeviceType::FIJI;
@@ -1368,8 +1369,18 @@ static void testROCmMetadataCase(cxuint testId, const ROCmMetadataTestCase& test
     CString error;
     try
     {
-        ROCmBinary binary(output.size(), output.data(), ROCMBIN_CREATE_METADATAINFO);
+        ROCmBinary binary(output.size(), output.data(), ROCMBIN_CREATE_METADATAINFO |
+                    ROCMBIN_CREATE_METADATAVIEW |
+                    (parallel ? ROCMBIN_PARALLEL_METADATAINFO : 0));
         result = binary.getMetadataInfo();
+        // metadata view must have same kernels as owning metadata
+        const ROCmMetadataView& resultView = binary.getMetadataView();
+        if (resultView.kernels.size() != result.kernels.size())
+            throw Exception("Metadata view: kernels number mismatch");
+        for (size_t i = 0; i < result.kernels.size(); i++)
+            if (resultView.kernels[i].name.toCString() != result.kernels[i].name ||
+                resultView.kernels[i].argInfos.size() != result.kernels[i].argInfos.size())
+                throw Exception("Metadata view: kernel mismatch");
     }
     catch(const ParseException& ex)
     {
@@ -1377,8 +1388,8 @@ static void testROCmMetadataCase(cxuint testId, const ROCmMetadataTestCase& test
         error = ex.what();
     }
     
-    char testName[30];
-    snprintf(testName, 30, "Test #%u", testId);
+    char testName[40];
+    snprintf(testName, 40, "Test #%u%s", testId, parallel ? " (parallel)" : "");
     assertValue(testName, "good", testCase.good, good);
     assertString(testName, "error", testCase.error, error.c_str());
     if (!good)
@@ -1510,16 +1521,235 @@ static void testROCmMetadataCase(cxuint testId, const ROCmMetadataTestCase& test
     }
 }
 
+// generate YAML metadata with many kernels
+static std::string generateManyKernelsMetadata(cxuint kernelsNum)
+{
+    ROCmMetadata mdInfo{};
+    mdInfo.initialize();
+    mdInfo.kernels.resize(kernelsNum);
+    for (cxuint i = 0; i < kernelsNum; i++)
+    {
+        ROCmKernelMetadata& kernel = mdInfo.kernels[i];
+        kernel.initialize();
+        char buf[32];
+        snprintf(buf, 32, "kernel%u", i);
+        kernel.name = buf;
+        kernel.symbolName = std::string(buf) + "@kd";
+        kernel.language = "OpenCL C";
+        kernel.langVersion[0] = 1;
+        kernel.langVersion[1] = 2;
+        kernel.argInfos.resize(i%4);
+        for (cxuint j = 0; j < kernel.argInfos.size(); j++)
+        {
+            ROCmKernelArgInfo& arg = kernel.argInfos[j];
+            snprintf(buf, 32, "arg%u", j);
+            arg.name = buf;
+            arg.typeName = "uint";
+            arg.size = arg.align = 4;
+            arg.valueKind = ROCmValueKind::BY_VALUE;
+            arg.valueType = ROCmValueType::UINT32;
+        }
+    }
+    std::vector<ROCmKernelConfig> kconfigs(kernelsNum);
+    std::vector<const ROCmKernelConfig*> kconfigPtrs(kernelsNum);
+    for (cxuint i = 0; i < kernelsNum; i++)
+    {
+        ::memset(&kconfigs[i], 0, sizeof(ROCmKernelConfig));
+        kconfigPtrs[i] = &kconfigs[i];
+    }
+    std::string output;
+    generateROCmMetadata(mdInfo, kconfigPtrs.data(), output);
+    return output;
+}
+
+// parse metadata by one and by many threads and compare results
+static void testParallelParsingCase(const char* caseName, const std::string& input)
+{
+    ROCmMetadata serialResult, parallelResult;
+    std::string serialError, parallelError;
+    try
+    { parseROCmMetadata(input.size(), input.c_str(), serialResult, 1); }
+    catch(const ParseException& ex)
+    { serialError = ex.what(); }
+    try
+    { parseROCmMetadata(input.size(), input.c_str(), parallelResult, 4); }
+    catch(const ParseException& ex)
+    { parallelError = ex.what(); }
+    
+    assertString("parallelParsing", std::string(caseName)+".error",
+                 serialError.c_str(), parallelError.c_str());
+    if (!serialError.empty())
+        return;
+    assertValue("parallelParsing", std::string(caseName)+".kernelsNum",
+                serialResult.kernels.size(), parallelResult.kernels.size());
+    std::vector<ROCmKernelConfig> kconfigs(serialResult.kernels.size());
+    std::vector<const ROCmKernelConfig*> kconfigPtrs(serialResult.kernels.size());
+    for (cxuint i = 0; i < kconfigs.size(); i++)
+    {
+        ::memset(&kconfigs[i], 0, sizeof(ROCmKernelConfig));
+        kconfigPtrs[i] = &kconfigs[i];
+    }
+    // compare regenerated metadatas
+    std::string serialOutput, parallelOutput;
+    generateROCmMetadata(serialResult, kconfigPtrs.data(), serialOutput);
+    generateROCmMetadata(parallelResult, kconfigPtrs.data(), parallelOutput);
+    assertString("parallelParsing", std::string(caseName)+".result",
+                 serialOutput.c_str(), parallelOutput.c_str());
+}
+
+static void testParallelParsing()
+{
+    const std::string input = generateManyKernelsMetadata(50);
+    testParallelParsingCase("many", input);
+    // trailing empty lines and comments
+    testParallelParsingCase("comments", input + "# comment\n\n");
+    // error in one of kernels
+    std::string errInput = input;
+    const size_t errPos = errInput.find("ByValue", errInput.find("kernel37"));
+    errInput.replace(errPos, 7, "ByValu3");
+    testParallelParsingCase("error", errInput);
+    // quoted string with line that looks like kernel record
+    std::string quotedInput = input;
+    const size_t langPos = quotedInput.find("OpenCL C", quotedInput.find("kernel12"));
+    quotedInput.replace(langPos, 8, "'OpenCL\n  - Name: x\n      C'");
+    testParallelParsingCase("quoted", quotedInput);
+}
+
+static bool isStringInRange(const ROCmStringRef& str, const char* start, size_t size)
+{
+    return str.ptr >= start && str.ptr + str.size <= start + size;
+}
+
+static void testMetadataView()
+{
+    std::string input = generateManyKernelsMetadata(4);
+    // string with escapes and block string must be decoded
+    const size_t langPos = input.find("OpenCL C", input.find("kernel1"));
+    input.replace(langPos, 8, "\"Open\\x43L C\"");
+    const size_t typePos = input.find("uint", input.find("kernel2"));
+    input.replace(typePos, 4, "|\n          ui\n          nt");
+    
+    for (cxuint threadsNum: { 1, 4 })
+    {
+        ROCmMetadataView mdView;
+        mdView.parse(input.size(), input.c_str(), threadsNum);
+        // string pool and all arrays are in single chunk of arena
+        assertValue("metadataView", "arenaChunksNum", size_t(1),
+                mdView.arena.getChunksNum());
+        assertValue("metadataView", "kernelsNum", size_t(4), mdView.kernels.size());
+        const ROCmKernelMetadataView& kernel1 = mdView.kernels[1];
+        assertTrue("metadataView", "kernel1.name.inMetadata",
+                isStringInRange(kernel1.name, input.c_str(), input.size()));
+        assertString("metadataView", "kernel1.name", "kernel1",
+                kernel1.name.toCString().c_str());
+        assertTrue("metadataView", "kernel1.language.decoded",
+                !isStringInRange(kernel1.language, input.c_str(), input.size()));
+        assertString("metadataView", "kernel1.language", "OpenCL C",
+                kernel1.language.toCString().c_str());
+        const ROCmKernelArgInfoView& arg = mdView.kernels[2].argInfos[0];
+        assertTrue("metadataView", "kernel2.arg0.typeName.decoded",
+                !isStringInRange(arg.typeName, input.c_str(), input.size()));
+        assertString("metadataView", "kernel2.arg0.typeName", "ui\nnt\n",
+                arg.typeName.toCString().c_str());
+        
+        // owning metadata must be same as view
+        ROCmMetadata mdInfo;
+        mdInfo.parse(input.size(), input.c_str(), threadsNum);
+        assertValue("metadataView", "owning.kernelsNum", mdInfo.kernels.size(),
+                mdView.kernels.size());
+        for (size_t i = 0; i < mdInfo.kernels.size(); i++)
+        {
+            const ROCmKernelMetadata& kernel = mdInfo.kernels[i];
+            const ROCmKernelMetadataView& kview = mdView.kernels[i];
+            assertString("metadataView", "owning.name", kernel.name.c_str(),
+                    kview.name.toCString().c_str());
+            assertString("metadataView", "owning.language", kernel.language.c_str(),
+                    kview.language.toCString().c_str());
+            assertValue("metadataView", "owning.sgprsNum", kernel.sgprsNum,
+                    kview.sgprsNum);
+            assertValue("metadataView", "owning.argsNum", kernel.argInfos.size(),
+                    kview.argInfos.size());
+            for (size_t j = 0; j < kernel.argInfos.size(); j++)
+            {
+                assertString("metadataView", "owning.arg.name",
+                        kernel.argInfos[j].name.c_str(),
+                        kview.argInfos[j].name.toCString().c_str());
+                assertString("metadataView", "owning.arg.typeName",
+                        kernel.argInfos[j].typeName.c_str(),
+                        kview.argInfos[j].typeName.toCString().c_str());
+                assertValue("metadataView", "owning.arg.size",
+                        kernel.argInfos[j].size, kview.argInfos[j].size);
+                assertValue("metadataView", "owning.arg.valueKind",
+                        cxuint(kernel.argInfos[j].valueKind),
+                        cxuint(kview.argInfos[j].valueKind));
+            }
+        }
+    }
+    
+    // many kernels: all arrays in arena, no allocations per kernel
+    const std::string manyInput = generateManyKernelsMetadata(50);
+    for (cxuint threadsNum: { 1, 4 })
+    {
+        ROCmMetadataView mdView;
+        mdView.parse(manyInput.size(), manyInput.c_str(), threadsNum);
+        assertValue("metadataView", "many.kernelsNum", size_t(50), mdView.kernels.size());
+        assertValue("metadataView", "many.arenaChunksNum", size_t(1),
+                mdView.arena.getChunksNum());
+    }
+}
+
+// check strings and spaces placed at different offsets (scanning by 16 bytes)
+static void testLongLines()
+{
+    for (cxuint k = 0; k < 40; k++)
+    {
+        const std::string pad(k, ' ');
+        const std::string text(k, 'x');
+        const std::string input = std::string("---\nVersion: [ 1, 0 ]\nKernels:\n") +
+            "  - Name:" + pad + "  kernel" + text + pad + "\t# comment" + pad + "\n" +
+            "    Language: " + pad + "\"a" + text + "\\x41" + text + "\\\"c\"" + pad + "\n" +
+            "    SymbolName: '" + text + "\n  " + text + "'\n" +
+            pad + "\n" + "    # comment" + text + "\n" +
+            "    Args:" + pad + "\n" +
+            "      - Name:" + pad + "\t\t" + text + "\n" +
+            "        TypeName: |" + pad + "\n          " + text + "\n\n          z\n" +
+            "        ValueKind: " + pad + "ByValue" + pad + "\n...\n";
+        ROCmMetadata mdInfo;
+        mdInfo.parse(input.size(), input.c_str());
+        char caseName[32];
+        snprintf(caseName, 32, "longLines#%u", k);
+        assertValue(caseName, "kernelsNum", size_t(1), mdInfo.kernels.size());
+        const ROCmKernelMetadata& kernel = mdInfo.kernels[0];
+        assertString(caseName, "name", ("kernel"+text).c_str(), kernel.name.c_str());
+        assertString(caseName, "language", ("a"+text+"A"+text+"\"c").c_str(),
+                    kernel.language.c_str());
+        assertString(caseName, "symbolName", (text+"\n  "+text).c_str(),
+                    kernel.symbolName.c_str());
+        assertValue(caseName, "argsNum", size_t(1), kernel.argInfos.size());
+        assertString(caseName, "argName", text.c_str(),
+                    kernel.argInfos[0].name.c_str() != nullptr ?
+                    kernel.argInfos[0].name.c_str() : "");
+        assertString(caseName, "argTypeName", (text+"\n\nz\n").c_str(),
+                    kernel.argInfos[0].typeName.c_str());
+        assertValue(caseName, "argValueKind", cxuint(ROCmValueKind::BY_VALUE),
+                    cxuint(kernel.argInfos[0].valueKind));
+    }
+}
+
 int main(int argc, const char** argv)
 {
     int retVal = 0;
+    retVal |= callTest(testParallelParsing);
+    retVal |= callTest(testMetadataView);
+    retVal |= callTest(testLongLines);
     for (cxuint i = 0; i < sizeof(rocmMetadataTestCases)/sizeof(ROCmMetadataTestCase); i++)
-        try
-        { testROCmMetadataCase(i, rocmMetadataTestCases[i]); }
-        catch(const std::exception& ex)
-        {
-            std::cerr << ex.what() << std::endl;
-            retVal = 1;
-        }
+        for (bool parallel: { false, true })
+            try
+            { testROCmMetadataCase(i, rocmMetadataTestCases[i], parallel); }
+            catch(const std::exception& ex)
+            {
+                std::cerr << ex.what() << std::endl;
+                retVal = 1;
+            }
     return retVal;
 }
@@ -2257,7 +2257,8 @@ static const ROCmMsgPackMDTestCase rocmMsgPackMDTestCases[] =
     }
 };
 
-static void testParseROCmMsgPackMDCase(cxuint testId, const ROCmMsgPackMDTestCase& testCase)
+static void testParseROCmMsgPackMDCase(cxuint testId, const ROCmMsgPackMDTestCase& testCase,
+            cxuint threadsNum)
 {
     //
     ROCmMetadata result{};
@@ -2265,21 +2266,32 @@ static void testParseROCmMsgPackMDCase(cxuint testId, const ROCmMsgPackMDTestCas
     bool good = true;
     std::string error;
     try
-    { result.parseMsgPack(testCase.inputSize, testCase.input); }
+    { result.parseMsgPack(testCase.inputSize, testCase.input, threadsNum); }
     catch(const std::exception& ex)
     {
         good = false;
         error = ex.what();
     }
     const ROCmMetadata& expected = testCase.expected;
-    char testName[30];
-    snprintf(testName, 30, "Test #%u", testId);
+    char testName[40];
+    snprintf(testName, 40, "Test #%u (threads %u)", testId, threadsNum);
     assertValue(testName, "good", testCase.good, good);
     assertString(testName, "error", testCase.error, error.c_str());
     if (!good)
         // do not check if test failed
         return;
     
+    {
+        // strings of metadata view must point to input
+        ROCmMetadataView mdView;
+        mdView.parseMsgPack(testCase.inputSize, testCase.input, threadsNum);
+        const char* inStart = reinterpret_cast<const char*>(testCase.input);
+        for (const ROCmKernelMetadataView& kernel: mdView.kernels)
+            assertTrue(testName, "viewNameInInput", kernel.name.empty() ||
+                    (kernel.name.ptr >= inStart &&
+                     kernel.name.ptr + kernel.name.size <= inStart + testCase.inputSize));
+    }
+    
     assertValue(testName, "version[0]", expected.version[0], result.version[0]);
     assertValue(testName, "version[1]", expected.version[1], result.version[1]);
     assertValue(testName, "printfInfosNum", expected.printfInfos.size(),
@@ -2414,12 +2426,13 @@ int main(int argc, const char** argv)
     retVal |= callTest(testMsgPackSkip);
     for (cxuint i = 0; i < sizeof(rocmMsgPackMDTestCases)/
                             sizeof(ROCmMsgPackMDTestCase); i++)
-        try
-        { testParseROCmMsgPackMDCase(i, rocmMsgPackMDTestCases[i]); }
-        catch(const std::exception& ex)
-        {
-            std::cerr << ex.what() << std::endl;
-            retVal = 1;
-        }
+        for (cxuint threadsNum: { 1, 4 })
+            try
+            { testParseROCmMsgPackMDCase(i, rocmMsgPackMDTestCases[i], threadsNum); }
+            catch(const std::exception& ex)
+            {
+                std::cerr << ex.what() << std::endl;
+                retVal = 1;
+            }
     return retVal;
 }
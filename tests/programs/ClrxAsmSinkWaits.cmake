@@ -0,0 +1,87 @@
+####
+#  CLRadeonExtender - Unofficial OpenCL Radeon Extensions Library
+#  Copyright (C) 2014-2018 Mateusz Szpakowski
+#
+#  This library is free software; you can redistribute it and/or
+#  modify it under the terms of the GNU Lesser General Public
+#  License as published by the Free Software Foundation; either
+#  version 2.1 of the License, or (at your option) any later version.
+#
+#  This library is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+#  Lesser General Public License for more details.
+#
+#  You should have received a copy of the GNU Lesser General Public
+#  License along with this library; if not, write to the Free Software
+#  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+####
+
+# tests of clrxasm with placing wait instructions (--sinkWaits)
+
+FILE(REMOVE_RECURSE ${WORK_DIR})
+FILE(MAKE_DIRECTORY ${WORK_DIR})
+
+# user wait is removed, waits are placed just before first use of registers
+# (also at start of loop), wait before s_barrier is kept
+FILE(WRITE ${WORK_DIR}/test.s "
+        s_load_dword s2, s[10:11], 4
+        buffer_load_dword v4, v1, s[12:15], 0 offen
+        s_waitcnt vmcnt(0) & lgkmcnt(0)
+        v_mov_b32 v2, v3
+loop:   v_add_f32 v5, v4, v4
+        s_add_u32 s5, s2, s2
+        s_sub_u32 s6, s6, 1
+        s_cbranch_scc1 loop
+        ds_write_b32 v1, v2
+        s_waitcnt lgkmcnt(0)
+        s_barrier
+        s_endpgm
+")
+SET(EXPECTED_CODE "/*000000000000*/ s_load_dword    s2, s[10:11], 0x4
+/*000000000004*/ buffer_load_dword v4, v1, s[12:15], 0 offen
+/*00000000000c*/ v_mov_b32       v2, v3
+.L16_0:
+/*000000000010*/ s_waitcnt       vmcnt(0)
+/*000000000014*/ v_add_f32       v5, v4, v4
+/*000000000018*/ s_waitcnt       lgkmcnt(0)
+/*00000000001c*/ s_add_u32       s5, s2, s2
+/*000000000020*/ s_sub_u32       s6, s6, 1
+/*000000000024*/ s_cbranch_scc1  .L16_0
+/*000000000028*/ ds_write_b32    v1, v2
+/*000000000030*/ s_waitcnt       lgkmcnt(0)
+/*000000000034*/ s_barrier
+/*000000000038*/ s_endpgm
+")
+
+# placed waits must be sufficient for wait checker (no warnings)
+EXECUTE_PROCESS(COMMAND ${CLRXASM} -b raw -g pitcairn --sinkWaits --checkWaits
+        -o ${WORK_DIR}/test.bin ${WORK_DIR}/test.s
+        ERROR_VARIABLE ASM_ERRORS RESULT_VARIABLE ASM_RESULT)
+IF(NOT ASM_RESULT EQUAL 0 OR NOT ASM_ERRORS STREQUAL "")
+    MESSAGE(FATAL_ERROR "Assembling with sinkWaits failed: ${ASM_ERRORS}")
+ENDIF(NOT ASM_RESULT EQUAL 0 OR NOT ASM_ERRORS STREQUAL "")
+EXECUTE_PROCESS(COMMAND ${CLRXDISASM} -r -g pitcairn ${WORK_DIR}/test.bin
+        OUTPUT_VARIABLE DISASM_OUTPUT RESULT_VARIABLE DISASM_RESULT)
+STRING(FIND "${DISASM_OUTPUT}" "${EXPECTED_CODE}" CODE_POS)
+IF(NOT DISASM_RESULT EQUAL 0 OR CODE_POS EQUAL -1)
+    MESSAGE(FATAL_ERROR "Unexpected code with placed waits:\n${DISASM_OUTPUT}")
+ENDIF(NOT DISASM_RESULT EQUAL 0 OR CODE_POS EQUAL -1)
+
+# source from standard input gives same code
+EXECUTE_PROCESS(COMMAND ${CLRXASM} -b raw -g pitcairn --sinkWaits
+        -o ${WORK_DIR}/test-stdin.bin INPUT_FILE ${WORK_DIR}/test.s
+        RESULT_VARIABLE ASM_RESULT)
+FILE(READ ${WORK_DIR}/test.bin CODE HEX)
+FILE(READ ${WORK_DIR}/test-stdin.bin STDIN_CODE HEX)
+IF(NOT ASM_RESULT EQUAL 0 OR NOT CODE STREQUAL STDIN_CODE)
+    MESSAGE(FATAL_ERROR "Assembling with sinkWaits from stdin gives other code")
+ENDIF(NOT ASM_RESULT EQUAL 0 OR NOT CODE STREQUAL STDIN_CODE)
+
+# without sinkWaits code is not changed
+EXECUTE_PROCESS(COMMAND ${CLRXASM} -b raw -g pitcairn
+        -o ${WORK_DIR}/test-orig.bin ${WORK_DIR}/test.s RESULT_VARIABLE ASM_RESULT)
+FILE(SIZE ${WORK_DIR}/test-orig.bin ORIG_SIZE)
+IF(NOT ASM_RESULT EQUAL 0 OR NOT ORIG_SIZE EQUAL 56)
+    MESSAGE(FATAL_ERROR "Code without sinkWaits has been changed")
+ENDIF(NOT ASM_RESULT EQUAL 0 OR NOT ORIG_SIZE EQUAL 56)
@@ -0,0 +1,108 @@
+####
+#  CLRadeonExtender - Unofficial OpenCL Radeon Extensions Library
+#  Copyright (C) 2014-2018 Mateusz Szpakowski
+#
+#  This library is free software; you can redistribute it and/or
+#  modify it under the terms of the GNU Lesser General Public
+#  License as published by the Free Software Foundation; either
+#  version 2.1 of the License, or (at your option) any later version.
+#
+#  This library is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+#  Lesser General Public License for more details.
+#
+#  You should have received a copy of the GNU Lesser General Public
+#  License along with this library; if not, write to the Free Software
+#  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+####
+
+# tests of clrxdisasm with many jobs (--jobs and --outputDir)
+
+SET(BINS ${BINS_DIR}/amd1.clo ${BINS_DIR}/amdcl2.clo ${BINS_DIR}/gallium1.clo
+        ${BINS_DIR}/new-gallium-llvm40.clo ${BINS_DIR}/rocm-fiji.hsaco
+        ${BINS_DIR}/samplekernels.clo)
+
+FILE(REMOVE_RECURSE ${WORK_DIR})
+FILE(MAKE_DIRECTORY ${WORK_DIR})
+
+# output of many jobs must be same as sequential output
+EXECUTE_PROCESS(COMMAND ${CLRXDISASM} -dCfs ${BINS}
+        OUTPUT_VARIABLE SEQ_OUTPUT RESULT_VARIABLE SEQ_RESULT)
+IF(NOT SEQ_RESULT EQUAL 0)
+    MESSAGE(FATAL_ERROR "Sequential disassembling failed")
+ENDIF(NOT SEQ_RESULT EQUAL 0)
+FOREACH(JOBS 2 4 0)
+    EXECUTE_PROCESS(COMMAND ${CLRXDISASM} -dCfs --jobs=${JOBS} ${BINS}
+            OUTPUT_VARIABLE PAR_OUTPUT RESULT_VARIABLE PAR_RESULT)
+    IF(NOT PAR_RESULT EQUAL 0 OR NOT PAR_OUTPUT STREQUAL SEQ_OUTPUT)
+        MESSAGE(FATAL_ERROR "Output of ${JOBS} jobs differs from sequential output")
+    ENDIF(NOT PAR_RESULT EQUAL 0 OR NOT PAR_OUTPUT STREQUAL SEQ_OUTPUT)
+ENDFOREACH(JOBS)
+
+# many files than buffered outputs (files wait for emission of earlier files)
+SET(MANY_BINS ${BINS} ${BINS} ${BINS} ${BINS})
+EXECUTE_PROCESS(COMMAND ${CLRXDISASM} -dCfs ${MANY_BINS}
+        OUTPUT_VARIABLE SEQ_OUTPUT RESULT_VARIABLE SEQ_RESULT)
+EXECUTE_PROCESS(COMMAND ${CLRXDISASM} -dCfs --jobs=2 ${MANY_BINS}
+        OUTPUT_VARIABLE PAR_OUTPUT RESULT_VARIABLE PAR_RESULT)
+IF(NOT SEQ_RESULT EQUAL 0 OR NOT PAR_RESULT EQUAL 0 OR
+        NOT PAR_OUTPUT STREQUAL SEQ_OUTPUT)
+    MESSAGE(FATAL_ERROR "Output of many files differs from sequential output")
+ENDIF(NOT SEQ_RESULT EQUAL 0 OR NOT PAR_RESULT EQUAL 0 OR
+        NOT PAR_OUTPUT STREQUAL SEQ_OUTPUT)
+
+# separate output files in output directory
+FILE(MAKE_DIRECTORY ${WORK_DIR}/out)
+EXECUTE_PROCESS(COMMAND ${CLRXDISASM} -dCfs --jobs=3 --outputDir=${WORK_DIR}/out ${BINS}
+        RESULT_VARIABLE DIR_RESULT)
+IF(NOT DIR_RESULT EQUAL 0)
+    MESSAGE(FATAL_ERROR "Disassembling to output directory failed")
+ENDIF(NOT DIR_RESULT EQUAL 0)
+FOREACH(BIN ${BINS})
+    GET_FILENAME_COMPONENT(BIN_NAME ${BIN} NAME)
+    EXECUTE_PROCESS(COMMAND ${CLRXDISASM} -dCfs ${BIN} OUTPUT_VARIABLE FILE_OUTPUT)
+    IF(NOT EXISTS ${WORK_DIR}/out/${BIN_NAME}.s)
+        MESSAGE(FATAL_ERROR "No output file for ${BIN_NAME}")
+    ENDIF(NOT EXISTS ${WORK_DIR}/out/${BIN_NAME}.s)
+    FILE(READ ${WORK_DIR}/out/${BIN_NAME}.s DIR_OUTPUT)
+    IF(NOT DIR_OUTPUT STREQUAL FILE_OUTPUT)
+        MESSAGE(FATAL_ERROR "Output file for ${BIN_NAME} differs from output")
+    ENDIF(NOT DIR_OUTPUT STREQUAL FILE_OUTPUT)
+ENDFOREACH(BIN)
+
+# input files with same name must be rejected (outputs can not overwrite others)
+FILE(MAKE_DIRECTORY ${WORK_DIR}/a ${WORK_DIR}/b ${WORK_DIR}/out2)
+CONFIGURE_FILE(${BINS_DIR}/amd1.clo ${WORK_DIR}/a/x.clo COPYONLY)
+CONFIGURE_FILE(${BINS_DIR}/gallium1.clo ${WORK_DIR}/b/x.clo COPYONLY)
+EXECUTE_PROCESS(COMMAND ${CLRXDISASM} -dCfs --jobs=2 --outputDir=${WORK_DIR}/out2
+        ${WORK_DIR}/a/x.clo ${WORK_DIR}/b/x.clo
+        RESULT_VARIABLE DUP_RESULT ERROR_VARIABLE DUP_ERROR)
+IF(DUP_RESULT EQUAL 0 OR EXISTS ${WORK_DIR}/out2/x.clo.s)
+    MESSAGE(FATAL_ERROR "Input files with same name are not rejected")
+ENDIF(DUP_RESULT EQUAL 0 OR EXISTS ${WORK_DIR}/out2/x.clo.s)
+IF(NOT DUP_ERROR MATCHES "have the same name 'x.clo.s'")
+    MESSAGE(FATAL_ERROR "Wrong error for same names: ${DUP_ERROR}")
+ENDIF(NOT DUP_ERROR MATCHES "have the same name 'x.clo.s'")
+
+# index can not be written by many jobs
+EXECUTE_PROCESS(COMMAND ${CLRXDISASM} --jobs=2 --writeIndex=${WORK_DIR}/index.idx
+        ${BINS_DIR}/amd1.clo RESULT_VARIABLE INDEX_RESULT ERROR_QUIET)
+IF(INDEX_RESULT EQUAL 0 OR EXISTS ${WORK_DIR}/index.idx)
+    MESSAGE(FATAL_ERROR "Writing index with many jobs is not rejected")
+ENDIF(INDEX_RESULT EQUAL 0 OR EXISTS ${WORK_DIR}/index.idx)
+# index can not be written for many input files (same index file)
+EXECUTE_PROCESS(COMMAND ${CLRXDISASM} --writeIndex=${WORK_DIR}/index.idx
+        ${BINS_DIR}/amd1.clo ${BINS_DIR}/gallium1.clo RESULT_VARIABLE INDEX_RESULT
+        ERROR_QUIET)
+IF(INDEX_RESULT EQUAL 0 OR EXISTS ${WORK_DIR}/index.idx)
+    MESSAGE(FATAL_ERROR "Writing index for many input files is not rejected")
+ENDIF(INDEX_RESULT EQUAL 0 OR EXISTS ${WORK_DIR}/index.idx)
+
+# names with separator must be quoted in statistics (CSV)
+CONFIGURE_FILE(${BINS_DIR}/amd1.clo "${WORK_DIR}/a,b.clo" COPYONLY)
+EXECUTE_PROCESS(COMMAND ${CLRXDISASM} --stats "${WORK_DIR}/a,b.clo"
+        OUTPUT_VARIABLE STATS_OUTPUT RESULT_VARIABLE STATS_RESULT)
+IF(NOT STATS_RESULT EQUAL 0 OR NOT STATS_OUTPUT MATCHES "\n\"${WORK_DIR}/a,b.clo\",")
+    MESSAGE(FATAL_ERROR "Wrong quoting of file name in statistics: ${STATS_OUTPUT}")
+ENDIF(NOT STATS_RESULT EQUAL 0 OR NOT STATS_OUTPUT MATCHES "\n\"${WORK_DIR}/a,b.clo\",")
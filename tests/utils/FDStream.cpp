@@ -0,0 +1,108 @@
+/*
+ *  CLRadeonExtender - Unofficial OpenCL Radeon Extensions Library
+ *  Copyright (C) 2014-2018 Mateusz Szpakowski
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <CLRX/Config.h>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <cstdio>
+#include <CLRX/utils/Utilities.h>
+#include <CLRX/utils/InputOutput.h>
+#include "../TestUtils.h"
+
+using namespace CLRX;
+
+// generate content written to stream: small and big pieces
+static std::string generateFDStreamContent(cxuint seed)
+{
+    std::string content;
+    for (cxuint i = 0; i < 300; i++)
+    {
+        const cxuint len = (i%37==0) ? 5000 + (i*seed)%3000 : (i*7+seed)%50;
+        for (cxuint j = 0; j < len; j++)
+            content.push_back(char(' ' + (i*13+j*seed)%90));
+        content.push_back('\n');
+    }
+    return content;
+}
+
+static void testFDStreamCase(size_t bufSize, bool doubleBuffered)
+{
+    std::ostringstream caseOss;
+    caseOss << "bufSize=" << bufSize << ",async=" << doubleBuffered;
+    const std::string caseName = caseOss.str();
+    const std::string content = generateFDStreamContent(bufSize%11+1);
+    
+    FILE* file = std::tmpfile();
+    if (file == nullptr)
+        throw Exception("Can't create temporary file");
+    try
+    {
+        {
+            FDOStream os(fileno(file), bufSize, doubleBuffered);
+            // mix of single characters, small writes and big writes
+            size_t pos = 0;
+            for (cxuint k = 0; pos < content.size(); k++)
+            {
+                const size_t len = std::min(content.size()-pos,
+                            size_t((k%3==0) ? 1 : (k%3==1) ? 17 : 9000));
+                if (len == 1)
+                    os.put(content[pos]);
+                else
+                    os.write(content.data()+pos, len);
+                pos += len;
+                if (k == 100)
+                    os.flush();
+            }
+            assertTrue("FDStream", caseName+".good", bool(os));
+        }
+        // read back written content
+        std::fseek(file, 0, SEEK_SET);
+        std::string result;
+        char buf[4096];
+        size_t readSize;
+        while ((readSize = std::fread(buf, 1, sizeof buf, file)) != 0)
+            result.append(buf, readSize);
+        assertValue("FDStream", caseName+".size", content.size(), result.size());
+        assertTrue("FDStream", caseName+".content", content == result);
+    }
+    catch(...)
+    {
+        std::fclose(file);
+        throw;
+    }
+    std::fclose(file);
+}
+
+static void testFDStream()
+{
+    const size_t bufSizes[] = { 1, 7, 64, 4096, 1U<<20 };
+    for (size_t bufSize: bufSizes)
+    {
+        testFDStreamCase(bufSize, false);
+        testFDStreamCase(bufSize, true);
+    }
+}
+
+int main(int argc, const char** argv)
+{
+    int retVal = 0;
+    retVal |= callTest(testFDStream);
+    return retVal;
+}
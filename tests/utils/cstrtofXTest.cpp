@@ -21,6 +21,7 @@
 #include <iostream>
 #include <iomanip>
 #include <sstream>
+#include <random>
 #include <cstring>
 #include <climits>
 #include <CLRX/utils/Utilities.h>
@@ -1388,6 +1389,132 @@ static const CStrtofXTestCase cstrtofXTestCases[] =
             0x4c20000000000001ULL },
 };
 
+struct FloatToStrTestCase
+{
+    FloatType type;
+    uint64_t value;
+    const char* expected;
+    const char* expectedSci;
+};
+
+// shortest texts that give same value after parsing
+static const FloatToStrTestCase floatToStrTestCases[] =
+{
+    { FT_H, 0x3d4c, "1.324", "1.324e+0" },
+    { FT_H, 0x2000, "0.007813", "7.813e-3" },
+    { FT_H, 0x7800, "3.277e+4", "3.277e+4" },
+    { FT_H, 0x6f3f, "7420", "7.42e+3" },
+    { FT_H, 0x4900, "10", "1e+1" },
+    { FT_H, 0x0001, "6e-8", "6e-8" },
+    { FT_H, 0xb8a8, "-0.582", "-5.82e-1" },
+    { FT_F, 0x3dcccccd, "0.1", "1e-1" },
+    { FT_F, 0x3f800000, "1", "1e+0" },
+    { FT_F, 0x3f80006b, "1.0000128", "1.0000128e+0" },
+    { FT_F, 0x4b000236, "8389174", "8.389174e+6" },
+    { FT_F, 0x11110000, "1.1438483e-28", "1.1438483e-28" },
+    { FT_F, 0x00000011, "2.4e-44", "2.4e-44" },
+    { FT_F, 0x00000001, "1e-45", "1e-45" },
+    { FT_F, 0x7f7fffff, "3.4028235e+38", "3.4028235e+38" },
+    { FT_F, 0xc2f60000, "-123", "-1.23e+2" },
+    { FT_F, 0x4e6e6b28, "1e+9", "1e+9" },
+    { FT_D, 0x3fb999999999999aULL, "0.1", "1e-1" },
+    { FT_D, 0x3fd5555555555555ULL, "0.3333333333333333", "3.333333333333333e-1" },
+    { FT_D, 0x4011666666666666ULL, "4.35", "4.35e+0" },
+    { FT_D, 0x40fe240c9fbe76c9ULL, "123456.789", "1.23456789e+5" },
+    { FT_D, 0x4340000000000000ULL, "9007199254740992", "9.007199254740992e+15" },
+    { FT_D, 0x4341c37937e08000ULL, "10000000000000000", "1e+16" },
+    { FT_D, 0x44b52d02c7e14af6ULL, "1e+23", "1e+23" },
+    { FT_D, 0x3eef75104d551d69ULL, "0.000015", "1.5e-5" },
+    { FT_D, 0xc004000000000000ULL, "-2.5", "-2.5e+0" },
+    { FT_D, 0x7fefffffffffffffULL, "1.7976931348623157e+308", "1.7976931348623157e+308" },
+    { FT_D, 0x0010000000000000ULL, "2.2250738585072014e-308", "2.2250738585072014e-308" },
+    { FT_D, 0x0000000000000001ULL, "5e-324", "5e-324" }
+};
+
+static void testFloatToStr(cxuint testId, const FloatToStrTestCase& testCase)
+{
+    char buf1[64], buf2[64];
+    if (testCase.type == FT_H)
+    {
+        htocstrCStyle(testCase.value, buf1, 64, false);
+        htocstrCStyle(testCase.value, buf2, 64, true);
+    }
+    else if (testCase.type == FT_F)
+    {
+        FloatUnion valueU;
+        valueU.u = testCase.value;
+        ftocstrCStyle(valueU.f, buf1, 64, false);
+        ftocstrCStyle(valueU.f, buf2, 64, true);
+    }
+    else
+    {
+        DoubleUnion valueU;
+        valueU.u = testCase.value;
+        dtocstrCStyle(valueU.d, buf1, 64, false);
+        dtocstrCStyle(valueU.d, buf2, 64, true);
+    }
+    if (::strcmp(buf1, testCase.expected) != 0 || ::strcmp(buf2, testCase.expectedSci) != 0)
+    {
+        std::ostringstream oss;
+        oss << "Failed floatToStr for #" << testId << ": " << buf1 << "!=" <<
+                testCase.expected << " or " << buf2 << "!=" << testCase.expectedSci;
+        throw Exception(oss.str());
+    }
+}
+
+// all finite half values must be same after formatting and parsing
+static void testHalfTrippingAll()
+{
+    char buf[32];
+    for (cxuint value = 0; value < 0x10000; value++)
+    {
+        if ((value & 0x7c00) == 0x7c00)
+            continue; // skip nans and infinities
+        htocstrCStyle(value, buf, 32, false);
+        const char* end;
+        const cxushort tripped = cstrtohCStyle(buf, buf+::strlen(buf), end);
+        if (tripped != value && value != 0x8000)
+        {
+            std::ostringstream oss;
+            oss << "Failed half tripping for 0x" << std::hex << value << ": " << buf;
+            throw Exception(oss.str());
+        }
+    }
+}
+
+// random finite double values must be same after formatting and parsing
+static void testDoubleTrippingRandom()
+{
+    char buf[64];
+    std::mt19937_64 rng(1234567);
+    for (cxuint i = 0; i < 1000000; i++)
+    {
+        DoubleUnion valueU;
+        valueU.u = rng();
+        if ((valueU.u & 0x7ff0000000000000ULL) == 0x7ff0000000000000ULL)
+            continue; // skip nans and infinities
+        // also values with short mantisa and denormals
+        if ((i & 3) == 1)
+            valueU.u &= 0xffffffffff000000ULL;
+        else if ((i & 3) == 2)
+            valueU.u &= 0x800fffffffffffffULL;
+        for (bool scientific: { false, true })
+        {
+            dtocstrCStyle(valueU.d, buf, 64, scientific);
+            const char* end;
+            DoubleUnion trippedU;
+            trippedU.d = cstrtovCStyle<double>(buf, buf+::strlen(buf), end);
+            if (trippedU.u != valueU.u && valueU.u != 0x8000000000000000ULL)
+            {
+                std::ostringstream oss;
+                oss << "Failed double tripping for 0x" << std::hex << valueU.u <<
+                        ": " << buf;
+                throw Exception(oss.str());
+            }
+        }
+    }
+}
+
 int main(int argc, const char** argv)
 {
     int retVal = 0;
@@ -1407,5 +1534,27 @@ int main(int argc, const char** argv)
             std::cerr << ex.what() << std::endl;
             retVal = 1;
         }
+    for (cxuint i = 0; i < sizeof(floatToStrTestCases)/sizeof(FloatToStrTestCase); i++)
+        try
+        { testFloatToStr(i, floatToStrTestCases[i]); }
+        catch(const std::exception& ex)
+        {
+            std::cerr << ex.what() << std::endl;
+            retVal = 1;
+        }
+    try
+    { testHalfTrippingAll(); }
+    catch(const std::exception& ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        retVal = 1;
+    }
+    try
+    { testDoubleTrippingRandom(); }
+    catch(const std::exception& ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        retVal = 1;
+    }
     return retVal;
 }
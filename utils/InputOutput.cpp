@@ -18,14 +18,26 @@
  */
 
 #include <CLRX/Config.h>
+#ifdef HAVE_WINDOWS
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+#include <fcntl.h>
+#include <sys/stat.h>
 #include <algorithm>
 #include <cstring>
 #include <climits>
+#include <cerrno>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
 #include <string>
 #include <istream>
 #include <ostream>
 #include <streambuf>
 #include <vector>
+#include <CLRX/utils/Utilities.h>
 #include <CLRX/utils/InputOutput.h>
 
 using namespace CLRX;
@@ -169,6 +181,30 @@ std::streambuf::int_type StringStreamBuf::overflow(std::streambuf::int_type ch)
     return ch;
 }
 
+std::streamsize StringStreamBuf::xsputn(const std::streambuf::char_type* s,
+            std::streamsize n)
+{
+    if (n <= 0)
+        return 0;
+    const size_t readPos = gptr()-eback();
+    const size_t writePos = pptr()-pbase();
+    if (writePos + n > string.size())
+    {
+        if (string.capacity() < writePos + n) // efficient reservation
+            string.reserve(std::max(writePos + n, string.size() + (string.size()>>1)));
+        string.resize(writePos + n);
+    }
+    ::memcpy(&string[writePos], s, n);
+    
+    char* data = const_cast<char*>(string.data());
+    // updating pointers
+    const size_t size = string.size();
+    setg(data, data+readPos, data+size);
+    setp(data, data+size);
+    safePBump(writePos + n);
+    return n;
+}
+
 std::streambuf* StringStreamBuf::setbuf(std::streambuf::char_type* buffer,
            std::streamsize size)
 {
@@ -292,3 +328,237 @@ VectorIOStream::VectorIOStream(std::vector<char>& vector)
 {
     rdbuf(&buffer);
 }
+
+/*
+ * file descriptor stream buffer
+ */
+
+// write whole data to file descriptor
+static bool writeAllToFD(int fd, const char* data, size_t size)
+{
+    while (size != 0)
+    {
+#ifdef HAVE_WINDOWS
+        const int ret = ::_write(fd, data, std::min(size, size_t(INT_MAX)));
+#else
+        const ssize_t ret = ::write(fd, data, std::min(size, size_t(SSIZE_MAX)));
+#endif
+        if (ret < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        data += ret;
+        size -= ret;
+    }
+    return true;
+}
+
+// background writer for double-buffered mode
+struct FDStreamBuf::AsyncWriter
+{
+    std::unique_ptr<char[]> buffer; // buffer written by writer thread
+    size_t size;    // size of data to write
+    bool pending;   // if data to write is pending
+    bool stop;
+    bool failed;
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::thread thread;
+    
+    explicit AsyncWriter(size_t bufSize) : buffer(new char[bufSize]), size(0),
+            pending(false), stop(false), failed(false)
+    { }
+    
+    void run(int fd);
+};
+
+void FDStreamBuf::AsyncWriter::run(int fd)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        cond.wait(lock, [this]() { return pending || stop; });
+        if (!pending)
+            break; // stop if nothing to write
+        lock.unlock();
+        const bool good = writeAllToFD(fd, buffer.get(), size);
+        lock.lock();
+        if (!good)
+            failed = true;
+        pending = false;
+        cond.notify_all();
+    }
+}
+
+FDStreamBuf::FDStreamBuf(int _fd, size_t _bufSize, bool doubleBuffered)
+        : fd(_fd), ownFD(false), failed(false), bufSize(_bufSize)
+{
+    initialize(doubleBuffered);
+}
+
+FDStreamBuf::FDStreamBuf(const char* filename, size_t _bufSize, bool doubleBuffered)
+        : fd(-1), ownFD(true), failed(false), bufSize(_bufSize)
+{
+#ifdef HAVE_WINDOWS
+    fd = ::_open(filename, _O_WRONLY|_O_CREAT|_O_TRUNC|_O_BINARY,
+                 _S_IREAD|_S_IWRITE);
+#else
+    fd = ::open(filename, O_WRONLY|O_CREAT|O_TRUNC, 0666);
+#endif
+    if (fd < 0)
+        throw Exception(std::string("Can't open file '")+filename+"'");
+    try
+    { initialize(doubleBuffered); }
+    catch(...)
+    {
+#ifdef HAVE_WINDOWS
+        ::_close(fd);
+#else
+        ::close(fd);
+#endif
+        throw;
+    }
+}
+
+void FDStreamBuf::initialize(bool doubleBuffered)
+{
+    // pbump accepts only int offsets
+    bufSize = std::max(std::min(bufSize, size_t(INT_MAX)), size_t(1));
+    buffer.reset(new char[bufSize]);
+    setp(buffer.get(), buffer.get() + bufSize);
+    if (doubleBuffered)
+    {
+        asyncWriter.reset(new AsyncWriter(bufSize));
+        try
+        { asyncWriter->thread = std::thread(&AsyncWriter::run, asyncWriter.get(), fd); }
+        catch(...)
+        {
+            // if thread creation failed, then just write synchronously
+            asyncWriter.reset();
+        }
+    }
+}
+
+FDStreamBuf::~FDStreamBuf()
+{
+    sync();
+    if (asyncWriter)
+    {
+        {
+            std::lock_guard<std::mutex> lock(asyncWriter->mutex);
+            asyncWriter->stop = true;
+            asyncWriter->cond.notify_all();
+        }
+        asyncWriter->thread.join();
+    }
+    if (ownFD)
+    {
+#ifdef HAVE_WINDOWS
+        ::_close(fd);
+#else
+        ::close(fd);
+#endif
+    }
+}
+
+// write buffer content (or pass it to background writer) and reset buffer
+bool FDStreamBuf::writeBuffer()
+{
+    const size_t size = pptr()-pbase();
+    if (size == 0)
+        return !failed;
+    if (asyncWriter)
+    {
+        std::unique_lock<std::mutex> lock(asyncWriter->mutex);
+        asyncWriter->cond.wait(lock, [this]() { return !asyncWriter->pending; });
+        if (asyncWriter->failed)
+            failed = true;
+        // swap buffers: filled buffer goes to writer
+        buffer.swap(asyncWriter->buffer);
+        asyncWriter->size = size;
+        asyncWriter->pending = true;
+        asyncWriter->cond.notify_all();
+    }
+    else if (!writeAllToFD(fd, pbase(), size))
+        failed = true;
+    setp(buffer.get(), buffer.get() + bufSize);
+    return !failed;
+}
+
+// wait until background writer finishes writing
+bool FDStreamBuf::waitForWriter()
+{
+    std::unique_lock<std::mutex> lock(asyncWriter->mutex);
+    asyncWriter->cond.wait(lock, [this]() { return !asyncWriter->pending; });
+    if (asyncWriter->failed)
+        failed = true;
+    return !failed;
+}
+
+std::streambuf::int_type FDStreamBuf::overflow(std::streambuf::int_type ch)
+{
+    if (!writeBuffer())
+        return traits_type::eof();
+    if (!traits_type::eq_int_type(ch, traits_type::eof()))
+    {
+        *pptr() = traits_type::to_char_type(ch);
+        pbump(1);
+    }
+    return traits_type::not_eof(ch);
+}
+
+std::streamsize FDStreamBuf::xsputn(const std::streambuf::char_type* s,
+            std::streamsize n)
+{
+    std::streamsize written = 0;
+    while (written < n)
+    {
+        size_t avail = epptr()-pptr();
+        const size_t toWrite = n-written;
+        if (asyncWriter == nullptr && pptr() == pbase() && toWrite >= bufSize)
+        {
+            // write big data directly (empty buffer)
+            if (!writeAllToFD(fd, s+written, toWrite))
+            {
+                failed = true;
+                break;
+            }
+            written = n;
+            break;
+        }
+        if (avail == 0)
+        {
+            if (!writeBuffer())
+                break;
+            avail = bufSize;
+        }
+        const size_t toCopy = std::min(avail, toWrite);
+        ::memcpy(pptr(), s+written, toCopy);
+        pbump(toCopy);
+        written += toCopy;
+    }
+    return written;
+}
+
+int FDStreamBuf::sync()
+{
+    if (!writeBuffer())
+        return -1;
+    if (asyncWriter && !waitForWriter())
+        return -1;
+    return 0;
+}
+
+FDOStream::FDOStream(int fd, size_t bufSize, bool doubleBuffered)
+        : std::ostream(nullptr), buffer(fd, bufSize, doubleBuffered)
+{
+    rdbuf(&buffer);
+}
+
+FDOStream::FDOStream(const char* filename, size_t bufSize, bool doubleBuffered)
+        : std::ostream(nullptr), buffer(filename, bufSize, doubleBuffered)
+{
+    rdbuf(&buffer);
+}
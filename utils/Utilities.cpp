@@ -35,6 +35,8 @@
 #include <fcntl.h>
 #include <sys/stat.h>
 #include <mutex>
+#include <thread>
+#include <exception>
 #include <cerrno>
 #include <cstring>
 #include <string>
@@ -804,3 +806,64 @@ std::string CLRX::findLLVMConfig()
     }
     return "";
 }
+
+cxuint CLRX::getHardwareThreadsNum()
+{
+    const cxuint threadsNum = std::thread::hardware_concurrency();
+    return threadsNum!=0 ? threadsNum : 1;
+}
+
+void CLRX::parallelForEach(size_t count, cxuint threadsNum,
+                const std::function<void(size_t)>& func)
+{
+    if (threadsNum == 0)
+        threadsNum = getHardwareThreadsNum();
+    if (threadsNum > count)
+        threadsNum = count;
+    if (threadsNum <= 1)
+    {
+        // just call in this thread
+        for (size_t i = 0; i < count; i++)
+            func(i);
+        return;
+    }
+    
+    std::atomic<size_t> nextIndex(0);
+    std::exception_ptr firstException;
+    std::mutex exceptionMutex;
+    
+    auto threadFunc = [&]()
+    {
+        try
+        {
+            for (size_t i = nextIndex.fetch_add(1); i < count;
+                        i = nextIndex.fetch_add(1))
+                func(i);
+        }
+        catch(...)
+        {
+            std::lock_guard<std::mutex> lock(exceptionMutex);
+            if (!firstException)
+                firstException = std::current_exception();
+            // stop fetching next items by other threads
+            nextIndex.store(count);
+        }
+    };
+    
+    std::vector<std::thread> threads;
+    threads.reserve(threadsNum-1);
+    try
+    {
+        for (cxuint i = 1; i < threadsNum; i++)
+            threads.push_back(std::thread(threadFunc));
+    }
+    catch(...)
+    {
+        // if thread creation failed, then continue with already created threads
+    }
+    threadFunc();
+    for (std::thread& thread: threads)
+        thread.join();
+    if (firstException)
+        std::rethrow_exception(firstException);
+}